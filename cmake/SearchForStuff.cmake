@@ -178,6 +178,18 @@ if (PKG_CONFIG_FOUND)
     set (HAVE_DART FALSE)
   endif()
 
+  #################################################
+  # Find OpenMP, used by the parallel_quick ODE solver
+  find_package(OpenMP)
+  if (OpenMP_CXX_FOUND)
+    message (STATUS "Looking for OpenMP - found")
+    set (HAVE_PARALLEL_QUICKSTEP TRUE)
+  else()
+    message (STATUS "Looking for OpenMP - not found")
+    BUILD_WARNING ("OpenMP not found, the parallel_quick ODE solver will not be available.")
+    set (HAVE_PARALLEL_QUICKSTEP FALSE)
+  endif()
+
   #################################################
   # Find tinyxml. Only debian distributions package tinyxml with a pkg-config
   # Use pkg_check_modules and fallback to manual detection
@@ -573,6 +585,12 @@ if (PKG_CONFIG_FOUND)
     add_definitions( -DLIBBULLET_VERSION_GT_282 )
   endif()
 
+  # btDiscreteDynamicsWorldMt takes a multi-threaded constraint solver for
+  # large islands since 2.88
+  if (NOT BULLET_VERSION VERSION_LESS 2.88)
+    add_definitions( -DLIBBULLET_VERSION_GE_288 )
+  endif()
+
   ########################################
   # Find libusb
   pkg_check_modules(libusb-1.0 libusb-1.0)
@@ -298,6 +298,7 @@ ODE_API dSpaceID dGeomGetSpace (dGeomID);
  *  @li dSimpleSpaceClass
  *  @li dHashSpaceClass
  *  @li dQuadTreeSpaceClass
+ *  @li dBVHSpaceClass
  *  @li dFirstUserClass
  *  @li dLastUserClass
  *
@@ -894,7 +895,8 @@ enum {
   dHashSpaceClass,
   dSweepAndPruneSpaceClass, // SAP
   dQuadTreeSpaceClass,
-  dLastSpaceClass = dQuadTreeSpaceClass,
+  dBVHSpaceClass,
+  dLastSpaceClass = dBVHSpaceClass,
 
   dFirstUserClass,
   dLastUserClass = dFirstUserClass + dMaxUserClasses - 1,
@@ -65,6 +65,44 @@ ODE_API dSpaceID dQuadTreeSpaceCreate (dSpaceID space, const dVector3 Center, co
 
 ODE_API dSpaceID dSweepAndPruneSpaceCreate( dSpaceID space, int axisorder );
 
+/**
+ * @brief Create a space that keeps its geoms in a dynamic AABB tree.
+ *
+ * The tree holds the AABBs of the geoms grown by a margin. A geom that
+ * moves within its grown AABB costs nothing to update, and the pairs of
+ * geoms whose grown AABBs overlap are kept between calls to dSpaceCollide,
+ * so only the geoms that moved out of their grown AABBs look for new pairs.
+ * This suits worlds with many objects of very different sizes, where no
+ * set of hash space levels fits all of them.
+ *
+ * @param space the space to add the new space to, or 0
+ * @returns the new space
+ * @ingroup collide
+ * @see dBVHSpaceSetMargin
+ */
+ODE_API dSpaceID dBVHSpaceCreate (dSpaceID space);
+
+/**
+ * @brief Set the distance the AABBs in a BVH space are grown by.
+ *
+ * A larger margin means fewer tree updates for moving geoms, but more
+ * pairs handed to the near callback to be rejected by their AABBs. The
+ * new margin applies to geoms as they are reinserted. The default is 0.05.
+ *
+ * @param space a space created by dBVHSpaceCreate
+ * @param margin the margin, not negative
+ * @ingroup collide
+ */
+ODE_API void dBVHSpaceSetMargin (dSpaceID space, dReal margin);
+
+/**
+ * @brief Get the distance the AABBs in a BVH space are grown by.
+ * @param space a space created by dBVHSpaceCreate
+ * @returns the margin
+ * @ingroup collide
+ */
+ODE_API dReal dBVHSpaceGetMargin (dSpaceID space);
+
 
 
 ODE_API void dSpaceDestroy (dSpaceID);
@@ -161,6 +199,7 @@ ODE_API dGeomID dSpaceGetGeom (dSpaceID, int i);
  *  @li dHashSpaceClass
  *  @li dSweepAndPruneSpaceClass
  *  @li dQuadTreeSpaceClass
+ *  @li dBVHSpaceClass
  *  @li dFirstUserClass
  *  @li dLastUserClass
  *
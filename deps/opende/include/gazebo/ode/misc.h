@@ -41,7 +41,9 @@ ODE_API int dTestRand(void);
  */
 ODE_API unsigned long dRand(void);
 
-/* get and set the current random number seed. */
+/* get and set the current random number seed. while a world is stepped,
+ * the current seed is the seed of the world, see dWorldSetRandSeed().
+ */
 ODE_API unsigned long  dRandGetSeed(void);
 ODE_API void dRandSetSeed (unsigned long s);
 
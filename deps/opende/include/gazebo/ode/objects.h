@@ -71,6 +71,65 @@ ODE_API dWorldID dWorldCreate(void);
 ODE_API int dWorldGetBodyCount(dWorldID world);
 ODE_API dBodyID dWorldGetBody(dWorldID world, int id);
 
+/**
+ * @brief Set the random number seed of a world.
+ *
+ * While a world is stepped, dRand() and the functions built on it use the
+ * seed of the world instead of the global one, so that worlds stepped in
+ * parallel do not change each other's random sequence. A new world starts
+ * with the global seed, see dRandSetSeed().
+ * @ingroup world
+ * @param world the world.
+ * @param seed the seed.
+ */
+ODE_API void dWorldSetRandSeed (dWorldID world, unsigned long seed);
+
+/**
+ * @brief Get the random number seed of a world.
+ * @ingroup world
+ * @param world the world.
+ * @return the seed, which advances as the world is stepped.
+ */
+ODE_API unsigned long dWorldGetRandSeed (dWorldID world);
+
+/**
+ * @brief Get the size of the state of a world, in dReals.
+ *
+ * The state holds everything the bodies and joints of the world carry from
+ * one step to the next: body positions, velocities and accumulated forces,
+ * auto-disable counters, the lambdas used to warm start the quickstep
+ * solver, cumulative joint angles and joint feedback. Joints that belong
+ * to a joint group, such as contact joints, are rebuilt on every step and
+ * are not part of the state. Neither is the random number seed of the
+ * world, see dWorldGetRandSeed().
+ * @ingroup world
+ * @param world the world.
+ * @return the number of dReals dWorldGetState() writes.
+ */
+ODE_API int dWorldGetStateSize (dWorldID world);
+
+/**
+ * @brief Save the state of a world.
+ * @ingroup world
+ * @param world the world.
+ * @param state an array of dWorldGetStateSize() dReals.
+ */
+ODE_API void dWorldGetState (dWorldID world, dReal *state);
+
+/**
+ * @brief Restore a state saved from the same world by dWorldGetState().
+ *
+ * The world must have the same bodies and joints as when it was saved.
+ * The geoms of every body are marked as moved and the moved callback of
+ * every body is called, as after a step.
+ * @ingroup world
+ * @param world the world.
+ * @param state the saved state.
+ * @param size the number of dReals in the state.
+ * @return 1 on success, 0 if the state does not match the world.
+ */
+ODE_API int dWorldSetState (dWorldID world, const dReal *state, int size);
+
 
 /**
  * @brief Destroy a world and everything in it.
@@ -108,6 +167,14 @@ ODE_API int dWorldGetIslandThreads (dWorldID);
  */
 ODE_API void dWorldSetIslandThreads (dWorldID, int num_island_threads);
 
+/**
+ * @brief Get the fraction of the time the island threads spent stepping
+ * islands during the last step, between 0 and 1
+ *
+ * @ingroup world
+ */
+ODE_API dReal dWorldGetIslandThreadUtilization (dWorldID);
+
 /**
  * @brief Set the number of thread pool threads for quickstep
  *
@@ -594,6 +661,13 @@ ODE_API bool dWorldGetQuickStepThreadPositionCorrection (dWorldID);
  */
 ODE_API bool dWorldGetQuickStepExperimentalRowReordering (dWorldID);
 
+/**
+ * @brief Get the number of threads of graph colored PGS sweeps.
+ * see dWorldSetQuickStepRowColoringThreads for details.
+ * @ingroup world
+ */
+ODE_API int dWorldGetQuickStepRowColoringThreads (dWorldID);
+
 /**
  * @brief Get warm start scaling coefficient
  * @ingroup world
@@ -661,6 +735,21 @@ ODE_API void dWorldSetQuickStepThreadPositionCorrection (dWorldID, bool thread);
  */
 ODE_API void dWorldSetQuickStepExperimentalRowReordering (dWorldID, bool order);
 
+/**
+ * @brief Sweep the constraint rows of an island in parallel.
+ * The rows are colored so that rows of the same color act on different
+ * bodies, and the rows of a color are split between the threads. Rows
+ * with findex < 0 are still solved before friction rows. Colors with few
+ * rows and rows of bodies with too many constraints are swept by one
+ * thread. Not used with preconditioning, threaded position correction
+ * or the cone friction model, which keep the sequential sweep. The sweep
+ * borrows idle island threads, and the world keeps enough of them for
+ * this many threads, at most one per hardware thread.
+ * @ingroup world
+ * @param threads number of threads, 0 for the sequential sweep
+ */
+ODE_API void dWorldSetQuickStepRowColoringThreads (dWorldID, int threads);
+
 /**
  * @brief Set warm start scaling coefficient
  * @ingroup world
@@ -2131,6 +2220,29 @@ ODE_API void dJointSetFeedback (dJointID, dJointFeedback *);
  */
 ODE_API dJointFeedback *dJointGetFeedback (dJointID);
 
+/**
+ * @brief Get the constraint multipliers of the last step.
+ *
+ * The quickstep solver starts from the multipliers of the previous step,
+ * scaled by the warm start factor. Contact joints are recreated every
+ * step, so the caller has to carry them over to the new joints.
+ * @ingroup joints
+ * @param lambda receives the 6 constraint multipliers.
+ * @param lambda_erp receives the 6 multipliers of the position correction.
+ * @sa dJointSetLambda
+ */
+ODE_API void dJointGetLambda (dJointID, dReal *lambda, dReal *lambda_erp);
+
+/**
+ * @brief Set the constraint multipliers the next step starts from.
+ * @ingroup joints
+ * @param lambda 6 constraint multipliers.
+ * @param lambda_erp 6 multipliers of the position correction.
+ * @sa dJointGetLambda
+ */
+ODE_API void dJointSetLambda (dJointID, const dReal *lambda,
+                              const dReal *lambda_erp);
+
 /**
  * @brief Set the joint anchor point.
  * @ingroup joints
@@ -132,6 +132,8 @@ public:
     { return dWorldGetQuickStepThreadPositionCorrection (get_id()); }
   bool getQuickStepExperimentalRowReordering() const
     { return dWorldGetQuickStepExperimentalRowReordering (get_id()); }
+  int getQuickStepRowColoringThreads() const
+    { return dWorldGetQuickStepRowColoringThreads (get_id()); }
   dReal getQuickStepWarmStartFactor() const
     { return dWorldGetQuickStepWarmStartFactor (get_id()); }
   int getQuickStepExtraFrictionIterations() const
@@ -148,6 +150,8 @@ public:
     { dWorldSetQuickStepThreadPositionCorrection (get_id(), thread); }
   void setQuickStepExperimentalRowReordering(bool order)
     { dWorldSetQuickStepExperimentalRowReordering (get_id(), order); }
+  void setQuickStepRowColoringThreads(int threads)
+    { dWorldSetQuickStepRowColoringThreads (get_id(), threads); }
   void setQuickStepWarmStartFactor(dReal warm)
     { dWorldSetQuickStepWarmStartFactor (get_id(), warm); }
   void setQuickStepExtraFrictionIterations(int iters)
@@ -0,0 +1,811 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001-2003 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+/*
+
+dynamic AABB tree space.
+
+the geoms are the leaves of a binary tree of "fat" AABBs, their AABBs grown
+by a margin. the tree is balanced with AVL rotations as leaves are inserted
+and removed. a geom that moves within its fat AABB does not touch the tree;
+one that leaves it is reinserted and queries the tree for new neighbours.
+
+the pairs of geoms whose fat AABBs overlap are kept from one collide() to
+the next, so only the geoms that were reinserted look for new pairs. a pair
+is dropped when the fat AABBs of its geoms no longer overlap.
+
+geoms with infinite AABBs (planes) are kept out of the tree and are tested
+against every other geom.
+
+*/
+
+#include <gazebo/ode/common.h>
+#include <gazebo/ode/matrix.h>
+#include <gazebo/ode/collision_space.h>
+#include <gazebo/ode/collision.h>
+#include "config.h"
+#include "collision_kernel.h"
+#include "collision_space_internal.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#define GEOM_ENABLED(g) (((g)->gflags & GEOM_ENABLE_TEST_MASK) == GEOM_ENABLE_TEST_VALUE)
+
+// the proxy of a geom is stored in its 'tome' member, which this space does
+// not use for a linked list. 0 means no proxy.
+#define GEOM_SET_PROXY(g,idx) { (g)->tome = (dxGeom**)(size_t)((idx)+1); }
+#define GEOM_GET_PROXY(g) ((int)(size_t)(g)->tome - 1)
+
+static const int NULL_NODE = -1;
+
+static bool isInfinite (const dReal *b)
+{
+  return b[0] <= -dInfinity || b[1] >= dInfinity ||
+    b[2] <= -dInfinity || b[3] >= dInfinity ||
+    b[4] <= -dInfinity || b[5] >= dInfinity;
+}
+
+static bool overlaps (const dReal *a, const dReal *b)
+{
+  return a[0] <= b[1] && a[1] >= b[0] &&
+    a[2] <= b[3] && a[3] >= b[2] &&
+    a[4] <= b[5] && a[5] >= b[4];
+}
+
+static bool contains (const dReal *outer, const dReal *inner)
+{
+  return outer[0] <= inner[0] && outer[1] >= inner[1] &&
+    outer[2] <= inner[2] && outer[3] >= inner[3] &&
+    outer[4] <= inner[4] && outer[5] >= inner[5];
+}
+
+static void combine (dReal *out, const dReal *a, const dReal *b)
+{
+  for (int i = 0; i < 6; i += 2) {
+    out[i] = a[i] < b[i] ? a[i] : b[i];
+    out[i+1] = a[i+1] > b[i+1] ? a[i+1] : b[i+1];
+  }
+}
+
+// half the surface area, the cost of visiting a node
+static dReal area (const dReal *b)
+{
+  dReal x = b[1] - b[0];
+  dReal y = b[3] - b[2];
+  dReal z = b[5] - b[4];
+  return x*y + y*z + z*x;
+}
+
+static dReal combinedArea (const dReal *a, const dReal *b)
+{
+  dReal c[6];
+  combine (c,a,b);
+  return area (c);
+}
+
+//****************************************************************************
+// bvh space
+
+struct dxBVHSpace : public dxSpace {
+  dxBVHSpace (dSpaceID _space);
+  ~dxBVHSpace();
+
+  dxGeom *getGeom (int i);
+  void add (dxGeom *g);
+  void remove (dxGeom *g);
+  void dirty (dxGeom *g);
+  void computeAABB();
+  void cleanGeoms();
+  void collide (void *data, dNearCallback *callback);
+  void collide2 (void *data, dxGeom *geom, dNearCallback *callback);
+
+  dReal margin;		// distance the fat AABBs extend beyond the geom AABBs
+
+private:
+  struct Node {
+    dReal bounds[6];	// fat AABB of a leaf, union of the children otherwise
+    int parent;
+    int child1;		// NULL_NODE for a leaf
+    int child2;
+    int height;		// 0 for a leaf
+    int proxy;		// proxy of a leaf
+  };
+
+  struct Proxy {
+    dxGeom *geom;	// 0 if the proxy is free
+    int leaf;		// NULL_NODE if the geom is not in the tree
+    int listIndex;	// index in GeomList
+    int isDirty;	// in DirtyList
+    int isMoved;	// in MoveList
+    int isInfinite;	// in InfiniteList
+  };
+
+  struct Pair {
+    int proxy1;
+    int proxy2;
+  };
+
+  static unsigned long long pairKey (int a, int b) {
+    if (a > b) std::swap (a,b);
+    return ((unsigned long long)(unsigned)a << 32) | (unsigned)b;
+  }
+
+  int allocateNode();
+  void freeNode (int node);
+  void insertLeaf (int leaf);
+  void removeLeaf (int leaf);
+  int balance (int a);
+  void fixUpwards (int node);
+
+  // reinsert the geom of a proxy if it left its fat AABB
+  void updateProxy (int proxy);
+
+  // find the new pairs of the geoms that were reinserted
+  void updatePairs();
+
+  // call fn(proxy) for every leaf whose fat AABB overlaps bounds
+  template <class Fn> void query (const dReal *bounds, Fn fn);
+
+  std::vector<Node> nodes;
+  int root;
+  int freeNodes;	// linked through Node::parent
+
+  std::vector<Proxy> proxies;
+  std::vector<int> freeProxies;
+
+  std::vector<dxGeom*> GeomList;	// all geoms, in the order they were added
+  std::vector<int> DirtyList;		// proxies of the dirty geoms
+  std::vector<int> MoveList;		// proxies reinserted since the last collide
+  std::vector<int> InfiniteList;	// proxies of the geoms with infinite AABBs
+
+  std::vector<Pair> pairs;
+  std::unordered_set<unsigned long long> pairSet;
+
+  // GeomList indices of the pairs to call back for, reused between calls
+  std::vector<std::pair<int,int> > CollideList;
+};
+
+
+dxBVHSpace::dxBVHSpace (dSpaceID _space) : dxSpace (_space)
+{
+  type = dBVHSpaceClass;
+  margin = REAL(0.05);
+  root = NULL_NODE;
+  freeNodes = NULL_NODE;
+}
+
+
+dxBVHSpace::~dxBVHSpace()
+{
+  CHECK_NOT_LOCKED (this);
+  if (cleanup) {
+    // note that destroying each geom will call remove()
+    while (!GeomList.empty()) dGeomDestroy (GeomList[0]);
+  }
+  else {
+    while (!GeomList.empty()) remove (GeomList[0]);
+  }
+}
+
+
+dxGeom *dxBVHSpace::getGeom (int i)
+{
+  dUASSERT (i >= 0 && i < count,"index out of range");
+  return GeomList[i];
+}
+
+
+void dxBVHSpace::add (dxGeom *g)
+{
+  CHECK_NOT_LOCKED (this);
+  dAASSERT (g);
+  dUASSERT (g->parent_space == 0 && g->next == 0 && g->tome == 0,
+	    "geom is already in a space");
+
+  int proxy;
+  if (!freeProxies.empty()) {
+    proxy = freeProxies.back();
+    freeProxies.pop_back();
+  }
+  else {
+    proxy = (int)proxies.size();
+    proxies.push_back (Proxy());
+  }
+
+  Proxy &p = proxies[proxy];
+  p.geom = g;
+  p.leaf = NULL_NODE;
+  p.listIndex = (int)GeomList.size();
+  p.isDirty = 1;
+  p.isMoved = 0;
+  p.isInfinite = 0;
+  GeomList.push_back (g);
+  DirtyList.push_back (proxy);
+  GEOM_SET_PROXY (g,proxy);
+
+  g->parent_space = this;
+  g->gflags |= GEOM_DIRTY | GEOM_AABB_BAD;
+  count++;
+
+  dGeomMoved (this);
+}
+
+
+void dxBVHSpace::remove (dxGeom *g)
+{
+  CHECK_NOT_LOCKED (this);
+  dAASSERT (g);
+  dUASSERT (g->parent_space == this,"object is not in this space");
+
+  int proxy = GEOM_GET_PROXY (g);
+  dIASSERT (proxy >= 0 && proxy < (int)proxies.size() &&
+	    proxies[proxy].geom == g);
+  Proxy &p = proxies[proxy];
+
+  if (p.leaf != NULL_NODE) {
+    removeLeaf (p.leaf);
+    freeNode (p.leaf);
+  }
+  if (p.isInfinite) {
+    InfiniteList.erase (std::find (InfiniteList.begin(),InfiniteList.end(),
+				   proxy));
+  }
+
+  // move the last geom into the hole
+  dxGeom *last = GeomList.back();
+  GeomList[p.listIndex] = last;
+  proxies[GEOM_GET_PROXY (last)].listIndex = p.listIndex;
+  GeomList.pop_back();
+
+  // the dirty and move lists, and the pairs, skip free proxies. they are
+  // cleaned up lazily.
+  p.geom = 0;
+  p.leaf = NULL_NODE;
+  p.isDirty = 0;
+  p.isMoved = 0;
+  p.isInfinite = 0;
+  freeProxies.push_back (proxy);
+  count--;
+
+  // safeguard
+  g->next = 0;
+  g->tome = 0;
+  g->parent_space = 0;
+
+  // the bounding box of this space (and that of all the parents) may have
+  // changed as a consequence of the removal.
+  dGeomMoved (this);
+}
+
+
+void dxBVHSpace::dirty (dxGeom *g)
+{
+  dAASSERT (g);
+  dUASSERT (g->parent_space == this,"object is not in this space");
+  // dGeomMoved is called from the island threads, like dxSpace::dirty
+  boost::mutex::scoped_lock lock(this->mutex);
+  int proxy = GEOM_GET_PROXY (g);
+  if (!proxies[proxy].isDirty) {
+    proxies[proxy].isDirty = 1;
+    DirtyList.push_back (proxy);
+  }
+}
+
+
+void dxBVHSpace::computeAABB()
+{
+  if (GeomList.empty()) {
+    dSetZero (aabb,6);
+    return;
+  }
+  dReal a[6];
+  a[0] = dInfinity;
+  a[1] = -dInfinity;
+  a[2] = dInfinity;
+  a[3] = -dInfinity;
+  a[4] = dInfinity;
+  a[5] = -dInfinity;
+  for (size_t i = 0; i < GeomList.size(); i++) {
+    dxGeom *g = GeomList[i];
+    g->recomputeAABB();
+    combine (a,a,g->aabb);
+  }
+  memcpy (aabb,a,6*sizeof(dReal));
+}
+
+
+void dxBVHSpace::cleanGeoms()
+{
+  // compute the AABBs of all dirty geoms, clear the dirty flags and move
+  // the geoms that left their fat AABBs
+  lock_count++;
+  for (size_t i = 0; i < DirtyList.size(); i++) {
+    int proxy = DirtyList[i];
+    if (!proxies[proxy].isDirty) continue;
+    proxies[proxy].isDirty = 0;
+
+    dxGeom *g = proxies[proxy].geom;
+    if (IS_SPACE(g)) {
+      ((dxSpace*)g)->cleanGeoms();
+    }
+    g->recomputeAABB();
+    g->gflags &= (~(GEOM_DIRTY|GEOM_AABB_BAD));
+    updateProxy (proxy);
+  }
+  DirtyList.clear();
+  lock_count--;
+}
+
+
+void dxBVHSpace::updateProxy (int proxy)
+{
+  dxGeom *g = proxies[proxy].geom;
+
+  if (isInfinite (g->aabb)) {
+    if (proxies[proxy].leaf != NULL_NODE) {
+      removeLeaf (proxies[proxy].leaf);
+      freeNode (proxies[proxy].leaf);
+      proxies[proxy].leaf = NULL_NODE;
+    }
+    if (!proxies[proxy].isInfinite) {
+      proxies[proxy].isInfinite = 1;
+      InfiniteList.push_back (proxy);
+    }
+    return;
+  }
+
+  if (proxies[proxy].isInfinite) {
+    proxies[proxy].isInfinite = 0;
+    InfiniteList.erase (std::find (InfiniteList.begin(),InfiniteList.end(),
+				   proxy));
+  }
+
+  int leaf = proxies[proxy].leaf;
+  if (leaf != NULL_NODE) {
+    if (contains (nodes[leaf].bounds,g->aabb)) return;
+    removeLeaf (leaf);
+  }
+  else {
+    leaf = allocateNode();
+    proxies[proxy].leaf = leaf;
+  }
+
+  Node &node = nodes[leaf];
+  for (int i = 0; i < 6; i += 2) {
+    node.bounds[i] = g->aabb[i] - margin;
+    node.bounds[i+1] = g->aabb[i+1] + margin;
+  }
+  node.proxy = proxy;
+  insertLeaf (leaf);
+
+  if (!proxies[proxy].isMoved) {
+    proxies[proxy].isMoved = 1;
+    MoveList.push_back (proxy);
+  }
+}
+
+
+void dxBVHSpace::updatePairs()
+{
+  for (size_t i = 0; i < MoveList.size(); i++) {
+    int proxy = MoveList[i];
+    if (!proxies[proxy].isMoved) continue;
+    proxies[proxy].isMoved = 0;
+
+    int leaf = proxies[proxy].leaf;
+    if (leaf == NULL_NODE) continue;
+
+    dReal bounds[6];
+    memcpy (bounds,nodes[leaf].bounds,6*sizeof(dReal));
+    query (bounds,[this,proxy](int other) {
+	if (other == proxy) return;
+	if (pairSet.insert (pairKey (proxy,other)).second) {
+	  Pair pair = {proxy, other};
+	  pairs.push_back (pair);
+	}
+      });
+  }
+  MoveList.clear();
+}
+
+
+void dxBVHSpace::collide (void *data, dNearCallback *callback)
+{
+  dAASSERT (callback);
+
+  lock_count++;
+  cleanGeoms();
+  updatePairs();
+
+  // drop the cached pairs that no longer overlap, and collect those whose
+  // geom AABBs overlap
+  CollideList.clear();
+  size_t kept = 0;
+  for (size_t i = 0; i < pairs.size(); i++) {
+    const Pair pair = pairs[i];
+    const Proxy &p1 = proxies[pair.proxy1];
+    const Proxy &p2 = proxies[pair.proxy2];
+    if (!p1.geom || !p2.geom || p1.leaf == NULL_NODE ||
+	p2.leaf == NULL_NODE ||
+	!overlaps (nodes[p1.leaf].bounds,nodes[p2.leaf].bounds)) {
+      pairSet.erase (pairKey (pair.proxy1,pair.proxy2));
+      continue;
+    }
+    pairs[kept++] = pair;
+    if (GEOM_ENABLED(p1.geom) && GEOM_ENABLED(p2.geom) &&
+	overlaps (p1.geom->aabb,p2.geom->aabb)) {
+      CollideList.push_back (std::make_pair (
+	std::min (p1.listIndex,p2.listIndex),
+	std::max (p1.listIndex,p2.listIndex)));
+    }
+  }
+  pairs.resize (kept);
+
+  // the cached pairs depend on the history of the tree. calling back in
+  // the order of the geoms gives the same contacts for the same geoms in
+  // the same places, e.g. after restoring a saved state.
+  std::sort (CollideList.begin(),CollideList.end());
+  for (size_t i = 0; i < CollideList.size(); i++) {
+    collideAABBs (GeomList[CollideList[i].first],
+		  GeomList[CollideList[i].second],data,callback);
+  }
+
+  // collide the infinite geoms with each other and with everything else
+  for (size_t i = 0; i < InfiniteList.size(); i++) {
+    dxGeom *g1 = proxies[InfiniteList[i]].geom;
+    if (!GEOM_ENABLED(g1)) continue;
+    for (size_t j = i + 1; j < InfiniteList.size(); j++) {
+      dxGeom *g2 = proxies[InfiniteList[j]].geom;
+      if (GEOM_ENABLED(g2)) collideAABBs (g1,g2,data,callback);
+    }
+    for (size_t j = 0; j < GeomList.size(); j++) {
+      dxGeom *g2 = GeomList[j];
+      if (!proxies[GEOM_GET_PROXY (g2)].isInfinite && GEOM_ENABLED(g2))
+	collideAABBs (g1,g2,data,callback);
+    }
+  }
+
+  lock_count--;
+}
+
+
+void dxBVHSpace::collide2 (void *data, dxGeom *geom, dNearCallback *callback)
+{
+  dAASSERT (geom && callback);
+
+  lock_count++;
+  cleanGeoms();
+  geom->recomputeAABB();
+
+  if (isInfinite (geom->aabb)) {
+    for (size_t i = 0; i < GeomList.size(); i++) {
+      dxGeom *g = GeomList[i];
+      if (GEOM_ENABLED(g)) collideAABBs (g,geom,data,callback);
+    }
+  }
+  else {
+    query (geom->aabb,[this,geom,data,callback](int proxy) {
+	dxGeom *g = proxies[proxy].geom;
+	if (GEOM_ENABLED(g)) collideAABBs (g,geom,data,callback);
+      });
+    for (size_t i = 0; i < InfiniteList.size(); i++) {
+      dxGeom *g = proxies[InfiniteList[i]].geom;
+      if (GEOM_ENABLED(g)) collideAABBs (g,geom,data,callback);
+    }
+  }
+
+  lock_count--;
+}
+
+
+template <class Fn> void dxBVHSpace::query (const dReal *bounds, Fn fn)
+{
+  if (root == NULL_NODE) return;
+
+  // the tree is balanced, so the stack rarely needs to grow
+  int fixed[64];
+  std::vector<int> grown;
+  int *stack = fixed;
+  int capacity = 64;
+  int size = 0;
+  stack[size++] = root;
+
+  while (size > 0) {
+    int index = stack[--size];
+    const Node &node = nodes[index];
+    if (!overlaps (node.bounds,bounds)) continue;
+    if (node.child1 == NULL_NODE) {
+      fn (node.proxy);
+      continue;
+    }
+    if (size + 2 > capacity) {
+      capacity *= 2;
+      if (grown.empty()) grown.assign (fixed,fixed + size);
+      grown.resize (capacity);
+      stack = &grown[0];
+    }
+    stack[size++] = node.child1;
+    stack[size++] = node.child2;
+  }
+}
+
+
+int dxBVHSpace::allocateNode()
+{
+  int index;
+  if (freeNodes != NULL_NODE) {
+    index = freeNodes;
+    freeNodes = nodes[index].parent;
+  }
+  else {
+    index = (int)nodes.size();
+    nodes.push_back (Node());
+  }
+  Node &node = nodes[index];
+  node.parent = NULL_NODE;
+  node.child1 = NULL_NODE;
+  node.child2 = NULL_NODE;
+  node.height = 0;
+  node.proxy = -1;
+  return index;
+}
+
+
+void dxBVHSpace::freeNode (int index)
+{
+  nodes[index].parent = freeNodes;
+  nodes[index].height = -1;
+  freeNodes = index;
+}
+
+
+void dxBVHSpace::insertLeaf (int leaf)
+{
+  if (root == NULL_NODE) {
+    root = leaf;
+    nodes[root].parent = NULL_NODE;
+    return;
+  }
+
+  dReal leafBounds[6];
+  memcpy (leafBounds,nodes[leaf].bounds,6*sizeof(dReal));
+
+  // find the best sibling by the surface area heuristic
+  int index = root;
+  while (nodes[index].child1 != NULL_NODE) {
+    const Node &node = nodes[index];
+    const int child1 = node.child1;
+    const int child2 = node.child2;
+
+    const dReal nodeArea = area (node.bounds);
+    const dReal combined = combinedArea (node.bounds,leafBounds);
+
+    // cost of creating a new parent for this node and the new leaf
+    const dReal cost = 2 * combined;
+
+    // minimum cost of pushing the leaf further down the tree
+    const dReal inheritance = 2 * (combined - nodeArea);
+
+    dReal cost1 = combinedArea (leafBounds,nodes[child1].bounds) + inheritance;
+    if (nodes[child1].child1 != NULL_NODE)
+      cost1 -= area (nodes[child1].bounds);
+    dReal cost2 = combinedArea (leafBounds,nodes[child2].bounds) + inheritance;
+    if (nodes[child2].child1 != NULL_NODE)
+      cost2 -= area (nodes[child2].bounds);
+
+    if (cost < cost1 && cost < cost2) break;
+    index = cost1 < cost2 ? child1 : child2;
+  }
+
+  const int sibling = index;
+  const int oldParent = nodes[sibling].parent;
+  const int newParent = allocateNode();
+
+  Node &parent = nodes[newParent];
+  parent.parent = oldParent;
+  combine (parent.bounds,leafBounds,nodes[sibling].bounds);
+  parent.height = nodes[sibling].height + 1;
+  parent.child1 = sibling;
+  parent.child2 = leaf;
+
+  if (oldParent != NULL_NODE) {
+    if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+    else nodes[oldParent].child2 = newParent;
+  }
+  else {
+    root = newParent;
+  }
+  nodes[sibling].parent = newParent;
+  nodes[leaf].parent = newParent;
+
+  fixUpwards (newParent);
+}
+
+
+void dxBVHSpace::removeLeaf (int leaf)
+{
+  if (leaf == root) {
+    root = NULL_NODE;
+    return;
+  }
+
+  const int parent = nodes[leaf].parent;
+  const int grandParent = nodes[parent].parent;
+  const int sibling = nodes[parent].child1 == leaf ?
+    nodes[parent].child2 : nodes[parent].child1;
+
+  if (grandParent != NULL_NODE) {
+    if (nodes[grandParent].child1 == parent)
+      nodes[grandParent].child1 = sibling;
+    else
+      nodes[grandParent].child2 = sibling;
+    nodes[sibling].parent = grandParent;
+    freeNode (parent);
+    fixUpwards (grandParent);
+  }
+  else {
+    root = sibling;
+    nodes[sibling].parent = NULL_NODE;
+    freeNode (parent);
+  }
+  nodes[leaf].parent = NULL_NODE;
+}
+
+
+void dxBVHSpace::fixUpwards (int index)
+{
+  while (index != NULL_NODE) {
+    index = balance (index);
+    Node &node = nodes[index];
+    const Node &child1 = nodes[node.child1];
+    const Node &child2 = nodes[node.child2];
+    node.height = 1 + std::max (child1.height,child2.height);
+    combine (node.bounds,child1.bounds,child2.bounds);
+    index = node.parent;
+  }
+}
+
+
+// rotate the taller child of node a up if the tree is unbalanced at a.
+// returns the new root of the subtree.
+int dxBVHSpace::balance (int iA)
+{
+  Node *A = &nodes[iA];
+  if (A->child1 == NULL_NODE || A->height < 2) return iA;
+
+  const int iB = A->child1;
+  const int iC = A->child2;
+  Node *B = &nodes[iB];
+  Node *C = &nodes[iC];
+
+  const int diff = C->height - B->height;
+
+  // rotate C up
+  if (diff > 1) {
+    const int iF = C->child1;
+    const int iG = C->child2;
+    Node *F = &nodes[iF];
+    Node *G = &nodes[iG];
+
+    C->child1 = iA;
+    C->parent = A->parent;
+    A->parent = iC;
+
+    if (C->parent != NULL_NODE) {
+      if (nodes[C->parent].child1 == iA) nodes[C->parent].child1 = iC;
+      else nodes[C->parent].child2 = iC;
+    }
+    else {
+      root = iC;
+    }
+
+    if (F->height > G->height) {
+      C->child2 = iF;
+      A->child2 = iG;
+      G->parent = iA;
+      combine (A->bounds,B->bounds,G->bounds);
+      combine (C->bounds,A->bounds,F->bounds);
+      A->height = 1 + std::max (B->height,G->height);
+      C->height = 1 + std::max (A->height,F->height);
+    }
+    else {
+      C->child2 = iG;
+      A->child2 = iF;
+      F->parent = iA;
+      combine (A->bounds,B->bounds,F->bounds);
+      combine (C->bounds,A->bounds,G->bounds);
+      A->height = 1 + std::max (B->height,F->height);
+      C->height = 1 + std::max (A->height,G->height);
+    }
+    return iC;
+  }
+
+  // rotate B up
+  if (diff < -1) {
+    const int iD = B->child1;
+    const int iE = B->child2;
+    Node *D = &nodes[iD];
+    Node *E = &nodes[iE];
+
+    B->child1 = iA;
+    B->parent = A->parent;
+    A->parent = iB;
+
+    if (B->parent != NULL_NODE) {
+      if (nodes[B->parent].child1 == iA) nodes[B->parent].child1 = iB;
+      else nodes[B->parent].child2 = iB;
+    }
+    else {
+      root = iB;
+    }
+
+    if (D->height > E->height) {
+      B->child2 = iD;
+      A->child1 = iE;
+      E->parent = iA;
+      combine (A->bounds,C->bounds,E->bounds);
+      combine (B->bounds,A->bounds,D->bounds);
+      A->height = 1 + std::max (C->height,E->height);
+      B->height = 1 + std::max (A->height,D->height);
+    }
+    else {
+      B->child2 = iE;
+      A->child1 = iD;
+      D->parent = iA;
+      combine (A->bounds,C->bounds,D->bounds);
+      combine (B->bounds,A->bounds,E->bounds);
+      A->height = 1 + std::max (C->height,D->height);
+      B->height = 1 + std::max (A->height,E->height);
+    }
+    return iB;
+  }
+
+  return iA;
+}
+
+//****************************************************************************
+// space functions
+
+dxSpace *dBVHSpaceCreate (dxSpace *space)
+{
+  return new dxBVHSpace (space);
+}
+
+
+void dBVHSpaceSetMargin (dxSpace *space, dReal margin)
+{
+  dAASSERT (space);
+  dUASSERT (margin >= 0,"margin must not be negative");
+  dUASSERT (space->type == dBVHSpaceClass,"argument must be a bvh space");
+  ((dxBVHSpace*)space)->margin = margin;
+}
+
+
+dReal dBVHSpaceGetMargin (dxSpace *space)
+{
+  dAASSERT (space);
+  dUASSERT (space->type == dBVHSpaceClass,"argument must be a bvh space");
+  return ((dxBVHSpace*)space)->margin;
+}
@@ -351,7 +351,10 @@ struct dxQuadTreeSpace : public dxSpace{
 	void collide(void* UserData, dNearCallback* Callback);
 	void collide2(void* UserData, dxGeom* g1, dNearCallback* Callback);
 
+	int BlockCount;
+
 	// Temp data
+	int CurrentBlockIndex;	// Block of current_geom in getGeom
 	Block* CurrentBlock;	// Only used while enumerating
 	int* CurrentChild;	// Only used while enumerating
 	int CurrentLevel;	// Only used while enumerating
@@ -376,6 +379,8 @@ dxQuadTreeSpace::dxQuadTreeSpace(dSpaceID _space, const dVector3 Center, const d
 	dReal MinZ = Center[AXIS1] - Extents[AXIS1];
 	dReal MaxZ = dNextAfter((Center[AXIS1] + Extents[AXIS1]), (dReal)dInfinity);
 	this->Blocks[0].Create(MinX, MaxX, MinZ, MaxZ, 0, Depth, Blocks2);
+	this->BlockCount = BlockCount;
+	CurrentBlockIndex = 0;
 
 	CurrentBlock = 0;
 	CurrentChild = (int*)dAlloc((Depth + 1) * sizeof(int));
@@ -393,6 +398,14 @@ dxQuadTreeSpace::dxQuadTreeSpace(dSpaceID _space, const dVector3 Center, const d
 }
 
 dxQuadTreeSpace::~dxQuadTreeSpace(){
+	CHECK_NOT_LOCKED(this);
+	// note that destroying each geom will call remove()
+	while (count){
+		dxGeom* g = getGeom(0);
+		if (cleanup) dGeomDestroy(g);
+		else remove(g);
+	}
+
 	int Depth = 0;
 	Block* Current = &Blocks[0];
 	while (Current){
@@ -409,77 +422,23 @@ dxQuadTreeSpace::~dxQuadTreeSpace(){
 	dFree(CurrentChild, (Depth + 1) * sizeof(int));
 }
 
-dxGeom* dxQuadTreeSpace::getGeom(int /*Index*/){
-	//dUASSERT(Index >= 0 && Index < count, "index out of range");
-
-	//@@@
-	dDebug (0,"dxQuadTreeSpace::getGeom() not yet implemented");
+dxGeom* dxQuadTreeSpace::getGeom(int Index){
+	dUASSERT(Index >= 0 && Index < count, "index out of range");
 
-	return 0;
-
-	// This doesnt work
-
-	/*if (CurrentIndex == Index){
-		// Loop through all objects in the local list
-CHILDRECURSE:
-		if (CurrentObject){
-			dGeomID g = CurrentObject;
-			CurrentObject = CurrentObject->next;
-			CurrentIndex++;
-		
-#ifdef DRAWBLOCKS
-			DrawBlock(CurrentBlock);
-#endif	//DRAWBLOCKS
-			return g;
-		}
-		else{
-			// Now lets loop through our children. Starting at index 0.
-			if (CurrentBlock->Children){
-				CurrentChild[CurrentLevel] = 0;
-PARENTRECURSE:
-				for (int& i = CurrentChild[CurrentLevel]; i < SPLITS; i++){
-					if (CurrentBlock->Children[i].GeomCount == 0){
-						continue;
-					}
-					CurrentBlock = &CurrentBlock->Children[i];
-					CurrentObject = CurrentBlock->First;
-				
-					i++;
-				
-					CurrentLevel++;
-					goto CHILDRECURSE;
-				}
-			}
-		}
-		
-		// Now lets go back to the parent so it can continue processing its other children.
-		if (CurrentBlock->Parent){
-			CurrentBlock = CurrentBlock->Parent;
-			CurrentLevel--;
-			goto PARENTRECURSE;
-		}
+	// Walk the object lists of the blocks in array order. Enumerating the
+	// geoms in order continues from the previous call.
+	if (!current_geom || Index <= current_index){
+		CurrentBlockIndex = 0;
+		current_geom = Blocks[0].mFirst;
+		while (!current_geom) current_geom = Blocks[++CurrentBlockIndex].mFirst;
+		current_index = 0;
 	}
-	else{
-		CurrentBlock = &Blocks[0];
-		CurrentLevel = 0;
-		CurrentObject = CurrentObject;
-		CurrentIndex = 0;
-
-		// Other states are already set
-		CurrentObject = CurrentBlock->First;
-	}
-
-
-	if (current_geom && current_index == Index - 1){
-		//current_geom = current_geom->next; // next
-		current_index = Index;
-		return current_geom;
+	while (current_index < Index){
+		current_geom = current_geom->next;
+		while (!current_geom) current_geom = Blocks[++CurrentBlockIndex].mFirst;
+		current_index++;
 	}
-	else for (int i = 0; i < Index; i++){	// this will be verrrrrrry slow
-		getGeom(i);
-	}*/
-
-	return 0;
+	return current_geom;
 }
 
 void dxQuadTreeSpace::add(dxGeom* g){
@@ -555,6 +514,9 @@ void dxQuadTreeSpace::cleanGeoms(){
 	}
 	DirtyList.setSize(0);
 
+	// enumerator has been invalidated
+	current_geom = 0;
+
 	lock_count--;
 }
 
@@ -294,11 +294,13 @@ dxSAPSpace::~dxSAPSpace()
 dxGeom* dxSAPSpace::getGeom( int i )
 {
 	dUASSERT( i >= 0 && i < count, "index out of range" );
-	int dirtySize = DirtyList.size();
-	if( i < dirtySize )
-		return DirtyList[i];
+	// in the order cleanGeoms() will leave them in, so that adding the geoms
+	// again in this order restores the order of GeomList
+	int geomSize = GeomList.size();
+	if( i < geomSize )
+		return GeomList[i];
 	else
-		return GeomList[i-dirtySize];
+		return DirtyList[i-geomSize];
 }
 
 void dxSAPSpace::add( dxGeom* g )
@@ -444,7 +446,8 @@ void dxSAPSpace::collide( void *_data, dNearCallback *callback )
 		if( !GEOM_ENABLED(g) ) // skip disabled ones
 			continue;
 		const dReal& amax = g->aabb[axis0max];
-		if(_dequal(amax, dInfinity)) // HACK? probably not...
+		// _dequal(amax, dInfinity) is never true, inf - inf is NaN
+		if(amax == dInfinity)
 			TmpInfGeomList.push( g );
 		else
 			TmpGeomList.push( g );
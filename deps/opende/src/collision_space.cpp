@@ -808,15 +808,17 @@ void dSpaceCollide2 (dxGeom *g1, dxGeom *g2, void *data,
 			else {
 				// iterate through the space that has the fewest geoms, calling
 				// collide2 in the other space for each one.
+				// getGeom rather than the linked list, which only some
+				// spaces keep
 				if (s1->count < s2->count) {
 					DataCallback dc = {data, callback};
-					for (dxGeom *g = s1->first; g; g=g->next) {
-						s2->collide2 (&dc,g,swap_callback);
+					for (int i = 0; i < s1->count; i++) {
+						s2->collide2 (&dc,s1->getGeom(i),swap_callback);
 					}
 				}
 				else {
-					for (dxGeom *g = s2->first; g; g=g->next) {
-						s1->collide2 (data,g,callback);
+					for (int i = 0; i < s2->count; i++) {
+						s1->collide2 (data,s2->getGeom(i),callback);
 					}
 				}
 			}
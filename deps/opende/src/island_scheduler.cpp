@@ -0,0 +1,373 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+#include <algorithm>
+#include <chrono>
+#include "island_scheduler.h"
+
+typedef std::chrono::steady_clock dxSchedulerClock;
+
+static double SecondsSince (const dxSchedulerClock::time_point &start)
+{
+  return std::chrono::duration<double>(dxSchedulerClock::now() - start).count();
+}
+
+dxIslandScheduler::dxIslandScheduler (int threads):
+  m_iRequestedThreads(0), m_iTeamThreads(0), m_pFn(NULL), m_pData(NULL),
+  m_uiGeneration(0), m_iRemaining(0), m_iActiveWorkers(0), m_iWorkerLimit(1),
+  m_iSlots(1), m_iIdleWorkers(0), m_iReservedWorkers(0), m_dUtilization(0)
+{
+  m_vQueues.push_back(new Queue());
+  m_vQueues.back()->busy = 0;
+  SetThreadCount(threads);
+}
+
+dxIslandScheduler::~dxIslandScheduler ()
+{
+  m_iRequestedThreads = 0;
+  m_iTeamThreads = 0;
+  Resize();
+  delete m_vQueues[0];
+}
+
+void dxIslandScheduler::SetThreadCount (int threads)
+{
+  m_iRequestedThreads = std::max(threads, 0);
+  Resize();
+}
+
+void dxIslandScheduler::SetTeamThreadCount (int threads)
+{
+  // a team waits for all of its threads at each barrier, so threads
+  // beyond the hardware ones only add waiting
+  m_iTeamThreads = std::max(threads, 0);
+  const int hardware = (int)std::thread::hardware_concurrency();
+  if (hardware > 0)
+    m_iTeamThreads = std::min(m_iTeamThreads, hardware);
+  Resize();
+}
+
+void dxIslandScheduler::Resize ()
+{
+  const int slots = std::max(m_iRequestedThreads, 1);
+  const int workers = std::max(slots, m_iTeamThreads) - 1;
+  const int current = (int)m_vWorkers.size();
+
+  for (int i = GetSlotCount(); i < slots; ++i)
+  {
+    m_vQueues.push_back(new Queue());
+    m_vQueues.back()->busy = 0;
+  }
+
+  // worker i runs in m_vWorkers[i - 1]
+  if (workers < current)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_iWorkerLimit = workers + 1;
+      m_iSlots = slots;
+    }
+    m_cvWork.notify_all();
+
+    for (int i = workers; i < current; ++i)
+      m_vWorkers[i].join();
+    m_vWorkers.resize(workers);
+  }
+  else
+  {
+    unsigned generation;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_iWorkerLimit = workers + 1;
+      m_iSlots = slots;
+      generation = m_uiGeneration;
+    }
+    for (int i = current; i < workers; ++i)
+      m_vWorkers.push_back(
+        std::thread(&dxIslandScheduler::WorkerLoop, this, i + 1, generation));
+  }
+
+  // the remaining workers past the slots see the new count under the
+  // lock before their queues go, and there is no Run in progress
+  for (int i = slots; i < GetSlotCount(); ++i)
+    delete m_vQueues[i];
+  m_vQueues.resize(slots);
+}
+
+int dxIslandScheduler::ReserveTeam (int threads)
+{
+  threads = std::min(threads, m_iTeamThreads);
+  if (threads <= 1)
+    return 1;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const int helpers = std::max(
+    std::min(threads - 1, m_iIdleWorkers - m_iReservedWorkers), 0);
+  m_iReservedWorkers += helpers;
+  return helpers + 1;
+}
+
+void dxIslandScheduler::RunTeam (int threads, dxTeamFn *fn, void *data)
+{
+  if (threads <= 1)
+  {
+    fn(data, 0, 1);
+    return;
+  }
+
+  Team team;
+  team.fn = fn;
+  team.data = data;
+  team.threads = threads;
+  team.next = 1;
+  team.done = 0;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_vTeams.push_back(&team);
+  }
+  m_cvWork.notify_all();
+
+  fn(data, 0, threads);
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_cvTeam.wait(lock, [&team] { return team.done == team.threads - 1; });
+}
+
+void dxIslandScheduler::Run (int islandcount, const int *islandsizes,
+                             const size_t *islandreqs, dxIslandFn *fn, void *data)
+{
+  const int slots = GetSlotCount();
+
+  if (islandcount <= 0)
+  {
+    m_dUtilization = 0;
+    return;
+  }
+
+  // a single thread steps the islands in discovery order, which does
+  // not need any bookkeeping
+  if (slots == 1)
+  {
+    int bodyofs = 0, jointofs = 0;
+    for (int i = 0; i < islandcount; ++i)
+    {
+      const int bcount = islandsizes[2 * i];
+      const int jcount = islandsizes[2 * i + 1];
+      fn(data, 0, bodyofs, bcount, jointofs, jcount);
+      bodyofs += bcount;
+      jointofs += jcount;
+    }
+    m_dUtilization = 1;
+    return;
+  }
+
+  m_vIslands.resize(islandcount);
+  m_vOrder.resize(islandcount);
+  size_t totalcost = 0;
+  {
+    int bodyofs = 0, jointofs = 0;
+    for (int i = 0; i < islandcount; ++i)
+    {
+      Island &island = m_vIslands[i];
+      island.bodyofs = bodyofs;
+      island.bcount = islandsizes[2 * i];
+      island.jointofs = jointofs;
+      island.jcount = islandsizes[2 * i + 1];
+      island.cost = islandreqs[i];
+      bodyofs += island.bcount;
+      jointofs += island.jcount;
+      totalcost += island.cost;
+      m_vOrder[i] = i;
+    }
+  }
+
+  const std::vector<Island> &islands = m_vIslands;
+  std::stable_sort(m_vOrder.begin(), m_vOrder.end(),
+    [&islands](int a, int b) { return islands[a].cost > islands[b].cost; });
+
+  // aim for a few batches per thread so that stealing can even out
+  // a bad estimate
+  const size_t target = std::max<size_t>(totalcost / (4 * slots), 1);
+
+  m_vBatches.clear();
+  m_vLoads.assign(slots, 0);
+  for (int i = 0; i < islandcount; )
+  {
+    Batch batch;
+    batch.begin = i;
+    size_t cost = 0;
+    do {
+      cost += m_vIslands[m_vOrder[i++]].cost;
+    } while (i < islandcount && cost < target);
+    batch.end = i;
+
+    // deal to the least loaded thread
+    const int thread = (int)(std::min_element(m_vLoads.begin(), m_vLoads.end())
+                             - m_vLoads.begin());
+    m_vLoads[thread] += cost;
+
+    const int index = (int)m_vBatches.size();
+    m_vBatches.push_back(batch);
+    Queue *queue = m_vQueues[thread];
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->batches.push_back(index);
+  }
+
+  m_pFn = fn;
+  m_pData = data;
+  for (int i = 0; i < slots; ++i)
+    m_vQueues[i]->busy = 0;
+
+  const dxSchedulerClock::time_point start = dxSchedulerClock::now();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_iRemaining = (int)m_vBatches.size();
+    ++m_uiGeneration;
+  }
+  m_cvWork.notify_all();
+
+  Work(0);
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cvDone.wait(lock, [this] { return m_iRemaining == 0 && m_iActiveWorkers == 0; });
+  }
+
+  const double wall = SecondsSince(start);
+  double busy = 0;
+  for (int i = 0; i < slots; ++i)
+    busy += m_vQueues[i]->busy;
+  m_dUtilization = wall > 0 ? std::min(busy / (wall * slots), 1.0) : 1.0;
+}
+
+void dxIslandScheduler::WorkerLoop (int thread, unsigned generation)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  ++m_iIdleWorkers;
+  for (;;)
+  {
+    // a worker only joins a step while it has batches left, so no
+    // worker touches the queues once Run has returned. workers reserved
+    // for a team stay here until the team is started
+    m_cvWork.wait(lock, [&] {
+      return thread >= m_iWorkerLimit || !m_vTeams.empty() ||
+        (thread < m_iSlots && m_uiGeneration != generation &&
+         m_iRemaining > 0 && m_iIdleWorkers > m_iReservedWorkers); });
+    if (thread >= m_iWorkerLimit)
+    {
+      --m_iIdleWorkers;
+      return;
+    }
+
+    --m_iIdleWorkers;
+    if (!m_vTeams.empty())
+    {
+      Team *team = m_vTeams.front();
+      const int index = team->next++;
+      if (team->next == team->threads)
+        m_vTeams.pop_front();
+      --m_iReservedWorkers;
+      lock.unlock();
+
+      team->fn(team->data, index, team->threads);
+
+      lock.lock();
+      if (++team->done == team->threads - 1)
+        m_cvTeam.notify_all();
+      ++m_iIdleWorkers;
+      continue;
+    }
+
+    generation = m_uiGeneration;
+    ++m_iActiveWorkers;
+    lock.unlock();
+
+    Work(thread);
+
+    lock.lock();
+    ++m_iIdleWorkers;
+    if (--m_iActiveWorkers == 0 && m_iRemaining == 0)
+      m_cvDone.notify_all();
+  }
+}
+
+void dxIslandScheduler::Work (int thread)
+{
+  int batch;
+  while (PopBatch(thread, batch))
+    RunBatch(thread, batch);
+}
+
+bool dxIslandScheduler::PopBatch (int thread, int &batch)
+{
+  // own batches from the front, largest first
+  {
+    Queue *queue = m_vQueues[thread];
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->batches.empty())
+    {
+      batch = queue->batches.front();
+      queue->batches.pop_front();
+      return true;
+    }
+  }
+
+  // steal the smallest batches of the others from the back
+  const int slots = GetSlotCount();
+  for (int i = 1; i < slots; ++i)
+  {
+    Queue *queue = m_vQueues[(thread + i) % slots];
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    if (!queue->batches.empty())
+    {
+      batch = queue->batches.back();
+      queue->batches.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+void dxIslandScheduler::RunBatch (int thread, int batch)
+{
+  const dxSchedulerClock::time_point start = dxSchedulerClock::now();
+
+  const Batch &b = m_vBatches[batch];
+  for (int i = b.begin; i < b.end; ++i)
+  {
+    const Island &island = m_vIslands[m_vOrder[i]];
+    m_pFn(m_pData, thread, island.bodyofs, island.bcount,
+          island.jointofs, island.jcount);
+  }
+
+  // only this thread writes its busy time, and Run reads it after the
+  // last batch is counted down under the lock
+  m_vQueues[thread]->busy += SecondsSince(start);
+
+  bool done;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    done = --m_iRemaining == 0;
+  }
+  if (done)
+    m_cvDone.notify_all();
+}
@@ -0,0 +1,167 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+// persistent work-stealing scheduler for stepping islands in parallel.
+
+#ifndef _ODE_ISLAND_SCHEDULER_H_
+#define _ODE_ISLAND_SCHEDULER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A step is split into batches of islands. Islands are sorted by their
+// estimated cost (the stepper's memory estimate), islands at least as
+// expensive as the batch target get a batch of their own and the small
+// ones are packed together until they reach it. The batches are dealt
+// to per-thread queues, largest first, and idle threads steal from the
+// back of the other queues. The calling thread works as thread 0, so
+// with N threads only N-1 are started, and none with N <= 1. The worker
+// threads survive between steps and thread count changes only start or
+// stop the difference.
+//
+// Idle workers are also lent to teams, groups of threads that run the
+// same function at once, like the graph colored PGS sweep of a large
+// island. The scheduler keeps enough workers for the larger of the island
+// and team thread counts, and a team only gets the workers that are idle
+// when it is reserved, so teams never add threads.
+class dxIslandScheduler
+{
+public:
+  // called for each island with the index of the thread running it and
+  // the offsets of the island in the body and joint arrays.
+  typedef void dxIslandFn (void *data, int thread,
+                           int bodyofs, int bcount, int jointofs, int jcount);
+
+  // called on each thread of a team with the index of the thread and the
+  // size of the team.
+  typedef void dxTeamFn (void *data, int thread, int threads);
+
+  explicit dxIslandScheduler (int threads);
+  ~dxIslandScheduler ();
+
+  // number of threads requested, 0 if islands run on the calling thread.
+  int GetThreadCount () const { return m_iRequestedThreads; }
+  void SetThreadCount (int threads);
+
+  // number of threads stepping islands, including the calling thread.
+  int GetSlotCount () const { return (int)m_vQueues.size(); }
+
+  // step all islands and return when they are done. islandsizes holds
+  // the body and joint count of each island, islandreqs its cost.
+  void Run (int islandcount, const int *islandsizes,
+            const size_t *islandreqs, dxIslandFn *fn, void *data);
+
+  // fraction of the time the threads spent stepping islands during the
+  // last Run, between 0 and 1.
+  double GetUtilization () const { return m_dUtilization.load(); }
+
+  // largest team, including the calling thread, capped at the number of
+  // hardware threads. 0 or 1 if teams run on the calling thread only.
+  int GetTeamThreadCount () const { return m_iTeamThreads; }
+  void SetTeamThreadCount (int threads);
+
+  // reserve idle workers for a team of at most threads threads and the
+  // team thread count, including the calling thread, and return the size
+  // of the team. it must be followed by RunTeam with that size. can be
+  // called from an island.
+  int ReserveTeam (int threads);
+
+  // run fn on the calling thread as thread 0 and on the reserved workers,
+  // and return when all of them are done.
+  void RunTeam (int threads, dxTeamFn *fn, void *data);
+
+private:
+  struct Island
+  {
+    int bodyofs, bcount, jointofs, jcount;
+    size_t cost;
+  };
+
+  struct Batch
+  {
+    int begin, end;  // range in m_vOrder
+  };
+
+  struct Team
+  {
+    dxTeamFn *fn;
+    void *data;
+    int threads;
+    int next;  // index of the next worker to join
+    int done;  // number of workers done
+  };
+
+  struct Queue
+  {
+    std::mutex mutex;
+    std::deque<int> batches;
+    double busy;  // seconds spent in batches during the current Run
+  };
+
+  // start or stop workers and queues for the thread counts
+  void Resize ();
+  void WorkerLoop (int thread, unsigned generation);
+  // run batches of the current Run until there are none left
+  void Work (int thread);
+  bool PopBatch (int thread, int &batch);
+  void RunBatch (int thread, int batch);
+
+  int m_iRequestedThreads;
+  int m_iTeamThreads;
+
+  std::vector<Queue *> m_vQueues;
+  std::vector<std::thread> m_vWorkers;
+
+  // islands and batches of the current Run, reused between steps
+  std::vector<Island> m_vIslands;
+  std::vector<int> m_vOrder;
+  std::vector<Batch> m_vBatches;
+  std::vector<size_t> m_vLoads;
+  dxIslandFn *m_pFn;
+  void *m_pData;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cvWork;
+  std::condition_variable m_cvDone;
+  std::condition_variable m_cvTeam;
+  unsigned m_uiGeneration;
+  int m_iRemaining;
+  int m_iActiveWorkers;
+  int m_iWorkerLimit;
+  int m_iSlots;  // number of queues, workers from there on only join teams
+
+  // teams with workers still to join. idle workers are waiting for work,
+  // reserved ones are idle workers promised to a team, at most all of them
+  std::deque<Team *> m_vTeams;
+  int m_iIdleWorkers;
+  int m_iReservedWorkers;
+
+  // written by the thread calling Run, read from any thread
+  std::atomic<double> m_dUtilization;
+};
+
+#endif
@@ -317,3 +317,23 @@ dxJointGearbox::size() const
 {
     return sizeof( *this );
 }
+
+int
+dxJointGearbox::stateSize() const
+{
+    return 2;
+}
+
+void
+dxJointGearbox::getState( dReal *state ) const
+{
+    state[0] = cumulative_angle1;
+    state[1] = cumulative_angle2;
+}
+
+void
+dxJointGearbox::setState( const dReal *state )
+{
+    cumulative_angle1 = state[0];
+    cumulative_angle2 = state[1];
+}
@@ -423,6 +423,24 @@ dxJointHinge::size() const
     return sizeof( *this );
 }
 
+int
+dxJointHinge::stateSize() const
+{
+    return 1;
+}
+
+void
+dxJointHinge::getState( dReal *state ) const
+{
+    state[0] = cumulative_angle;
+}
+
+void
+dxJointHinge::setState( const dReal *state )
+{
+    cumulative_angle = state[0];
+}
+
 
 void
 dxJointHinge::setRelativeValues()
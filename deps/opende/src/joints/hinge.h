@@ -44,6 +44,9 @@ struct dxJointHinge : public dxJoint
     virtual void getInfo2( Info2* info );
     virtual dJointType type() const;
     virtual size_t size() const;
+    virtual int stateSize() const;
+    virtual void getState( dReal *state ) const;
+    virtual void setState( const dReal *state );
 
     virtual void setRelativeValues();
 
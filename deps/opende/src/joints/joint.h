@@ -154,6 +154,13 @@ struct dxJoint : public dObject
     /// Each dxJoint should redefine it if needed.
     virtual void setRelativeValues() {};
 
+    /// Number of dReals carried from one step to the next besides
+    /// lambda, e.g. cumulative angles. Used by dWorldGetState().
+    /// Each dxJoint with such values should redefine the three functions.
+    virtual int stateSize() const { return 0; }
+    virtual void getState( dReal * /*state*/ ) const {};
+    virtual void setState( const dReal * /*state*/ ) {};
+
 	// Test if this joint should be used in the simulation step
 	// (has the enabled flag set, and is attached to at least one dynamic body)
 	bool isEnabled() const;
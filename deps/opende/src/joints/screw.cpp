@@ -806,6 +806,24 @@ dxJointScrew::size() const
     return sizeof( *this );
 }
 
+int
+dxJointScrew::stateSize() const
+{
+    return 1;
+}
+
+void
+dxJointScrew::getState( dReal *state ) const
+{
+    state[0] = cumulative_angle;
+}
+
+void
+dxJointScrew::setState( const dReal *state )
+{
+    cumulative_angle = state[0];
+}
+
 
 void
 dxJointScrew::setRelativeValues()
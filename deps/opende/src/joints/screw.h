@@ -46,6 +46,9 @@ struct dxJointScrew : public dxJoint
     virtual void getInfo2( Info2* info );
     virtual dJointType type() const;
     virtual size_t size() const;
+    virtual int stateSize() const;
+    virtual void getState( dReal *state ) const;
+    virtual void setState( const dReal *state );
 
     virtual void setRelativeValues();
 
@@ -853,6 +853,26 @@ dxJointUniversal::size() const
     return sizeof( *this );
 }
 
+int
+dxJointUniversal::stateSize() const
+{
+    return 2;
+}
+
+void
+dxJointUniversal::getState( dReal *state ) const
+{
+    state[0] = cumulative_angle1;
+    state[1] = cumulative_angle2;
+}
+
+void
+dxJointUniversal::setState( const dReal *state )
+{
+    cumulative_angle1 = state[0];
+    cumulative_angle2 = state[1];
+}
+
 
 
 void
@@ -24,40 +24,64 @@
 #include <gazebo/ode/misc.h>
 #include <gazebo/ode/matrix.h>
 #include "config.h"
+#include "util.h"
 
 //****************************************************************************
 // random numbers
 
 static unsigned long seed = 0;
 
+// seed of the world being stepped on this thread, see dxRandSeedScope
+static thread_local unsigned long *thread_seed = 0;
+
+static unsigned long &currentSeed()
+{
+  return thread_seed ? *thread_seed : seed;
+}
+
+
+dxRandSeedScope::dxRandSeedScope(unsigned long *s)
+  : previous(thread_seed)
+{
+  thread_seed = s;
+}
+
+
+dxRandSeedScope::~dxRandSeedScope()
+{
+  thread_seed = previous;
+}
+
+
 unsigned long dRand()
 {
-  seed = (1664525UL*seed + 1013904223UL) & 0xffffffff;
-  return seed;
+  unsigned long &s = currentSeed();
+  s = (1664525UL*s + 1013904223UL) & 0xffffffff;
+  return s;
 }
 
 
 unsigned long  dRandGetSeed()
 {
-  return seed;
+  return currentSeed();
 }
 
 
 void dRandSetSeed (unsigned long s)
 {
-  seed = s;
+  currentSeed() = s;
 }
 
 
 int dTestRand()
 {
-  unsigned long oldseed = seed;
+  unsigned long oldseed = currentSeed();
   int ret = 1;
-  seed = 0;
+  currentSeed() = 0;
   if (dRand() != 0x3c6ef35f || dRand() != 0x47502932 ||
       dRand() != 0xd1ccf6e9 || dRand() != 0xaaf95334 ||
       dRand() != 0x6252e503) ret = 0;
-  seed = oldseed;
+  currentSeed() = oldseed;
   return ret;
 }
 
@@ -35,6 +35,7 @@
 #include <boost/threadpool.hpp>
 
 class dxStepWorkingMemory;
+class dxIslandScheduler;
 
 // some body flags
 
@@ -121,6 +122,7 @@ struct dxQuickStepParameters {
   dReal contact_sor_scale;  // sor scaling factor for contacts only
   bool thread_position_correction;  // threaded position correction computations
   bool row_reorder1;  // control quickstep row reordering
+  int row_coloring_threads;  // threads for graph colored PGS sweeps, 0: off
   dReal warm_start;  // warm start factor, 0: no warm start, 1: full warm start
   int friction_iterations;  // extra quickstep iterations friction.
   Friction_Model friction_model;  // friction model, enum type Friction_Model
@@ -195,14 +197,15 @@ struct dxWorld : public dBase {
   dxAutoDisable adis;    // auto-disable parameters
   int body_flags;               // flags for new bodies
   dxStepWorkingMemory *wmem; // Working memory object for dWorldStep/dWorldQuickStep
-  std::vector<dxStepWorkingMemory *> island_wmems; // Working memory object for dWorldStep/dWorldQuickStep
+  std::vector<dxStepWorkingMemory *> island_thread_wmems; // Working memory object of each island thread
 
   dxQuickStepParameters qs;
   dxRobustStepParameters rs;
   dxContactParameters contactp;
   dxDampingParameters dampingp; // damping parameters
   dReal max_angular_speed;      // limit the angular velocity to this magnitude
-  boost::threadpool::pool *threadpool;
+  unsigned long rand_seed;      // random number seed used while stepping
+  dxIslandScheduler *island_scheduler;
   boost::threadpool::pool *row_threadpool;
 };
 
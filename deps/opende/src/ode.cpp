@@ -38,6 +38,7 @@
 #include "step.h"
 #include "quickstep.h"
 #include "util.h"
+#include "island_scheduler.h"
 #include "odetls.h"
 #include "robuststep.h"
 
@@ -1542,6 +1543,21 @@ dJointFeedback *dJointGetFeedback (dxJoint *joint)
   return joint->feedback;
 }
 
+void dJointGetLambda (dxJoint *joint, dReal *lambda, dReal *lambda_erp)
+{
+  dAASSERT (joint && lambda && lambda_erp);
+  memcpy (lambda,joint->lambda,6*sizeof(dReal));
+  memcpy (lambda_erp,joint->lambda_erp,6*sizeof(dReal));
+}
+
+void dJointSetLambda (dxJoint *joint, const dReal *lambda,
+                      const dReal *lambda_erp)
+{
+  dAASSERT (joint && lambda && lambda_erp);
+  memcpy (joint->lambda,lambda,6*sizeof(dReal));
+  memcpy (joint->lambda_erp,lambda_erp,6*sizeof(dReal));
+}
+
 
 
 dJointID dConnectingJoint (dBodyID in_b1, dBodyID in_b2)
@@ -1667,6 +1683,7 @@ dxWorld * dWorldCreate()
   w->qs.contact_sor_scale = 0.25;
   w->qs.thread_position_correction = false;
   w->qs.row_reorder1 = true;
+  w->qs.row_coloring_threads = 0;
   w->qs.warm_start = 0.5;
   w->qs.friction_iterations = 10;
   w->qs.friction_model = pyramid_friction;
@@ -1680,8 +1697,9 @@ dxWorld * dWorldCreate()
   w->dampingp.linear_threshold = REAL(0.01) * REAL(0.01);
   w->dampingp.angular_threshold = REAL(0.01) * REAL(0.01);
   w->max_angular_speed = dInfinity;
+  w->rand_seed = dRandGetSeed();
 
-  w->threadpool = NULL; // new boost::threadpool::pool(0);
+  w->island_scheduler = new dxIslandScheduler(0);
   w->row_threadpool = NULL; // new boost::threadpool::pool(0);
 
   return w;
@@ -1712,6 +1730,174 @@ dBodyID dWorldGetBody(dxWorld *w, int id)
     return 0;
 }
 
+//****************************************************************************
+// world state, for saving and restoring a simulation in the same process
+
+static dReal *saveReals (dReal *state, const dReal *values, int n)
+{
+  memcpy (state,values,n*sizeof(dReal));
+  return state + n;
+}
+
+static const dReal *loadReals (const dReal *state, dReal *values, int n)
+{
+  memcpy (values,state,n*sizeof(dReal));
+  return state + n;
+}
+
+// joints in groups, i.e. contact joints, are rebuilt on every step
+static inline bool jointHasState (const dxJoint *j)
+{
+  return (j->flags & dJOINT_INGROUP) == 0;
+}
+
+static int bodyStateSize (const dxBody *b)
+{
+  // pos, R, q, lvel, avel, facc, tacc, then the disabled flag and the
+  // auto-disable counters
+  int size = 3 + 12 + 4 + 4*3 + 5;
+  if (b->average_lvel_buffer)
+    size += 2 * 4 * b->adis.average_samples;
+  return size;
+}
+
+static int jointStateSize (const dxJoint *j)
+{
+  int size = 6 + 6 + j->stateSize();
+  if (j->feedback)
+    size += sizeof(dJointFeedback) / sizeof(dReal);
+  return size;
+}
+
+void dWorldSetRandSeed (dxWorld *w, unsigned long seed)
+{
+  dAASSERT (w);
+  w->rand_seed = seed;
+}
+
+
+unsigned long dWorldGetRandSeed (dxWorld *w)
+{
+  dAASSERT (w);
+  return w->rand_seed;
+}
+
+
+int dWorldGetStateSize (dxWorld *w)
+{
+  dAASSERT (w);
+  int size = 2;
+  for (dxBody *b = w->firstbody; b; b = (dxBody*)b->next)
+    size += bodyStateSize (b);
+  for (dxJoint *j = w->firstjoint; j; j = (dxJoint*)j->next) {
+    if (jointHasState (j))
+      size += jointStateSize (j);
+  }
+  return size;
+}
+
+void dWorldGetState (dxWorld *w, dReal *state)
+{
+  dAASSERT (w && state);
+  int nj = 0;
+  for (dxJoint *j = w->firstjoint; j; j = (dxJoint*)j->next) {
+    if (jointHasState (j)) nj++;
+  }
+  *state++ = (dReal) w->nb;
+  *state++ = (dReal) nj;
+
+  for (dxBody *b = w->firstbody; b; b = (dxBody*)b->next) {
+    state = saveReals (state,b->posr.pos,3);
+    state = saveReals (state,b->posr.R,12);
+    state = saveReals (state,b->q,4);
+    state = saveReals (state,b->lvel,3);
+    state = saveReals (state,b->avel,3);
+    state = saveReals (state,b->facc,3);
+    state = saveReals (state,b->tacc,3);
+    *state++ = (b->flags & dxBodyDisabled) ? 1 : 0;
+    *state++ = b->adis_timeleft;
+    *state++ = (dReal) b->adis_stepsleft;
+    *state++ = (dReal) b->average_counter;
+    *state++ = (dReal) b->average_ready;
+    if (b->average_lvel_buffer) {
+      const int n = 4 * b->adis.average_samples;
+      state = saveReals (state,b->average_lvel_buffer[0],n);
+      state = saveReals (state,b->average_avel_buffer[0],n);
+    }
+  }
+
+  for (dxJoint *j = w->firstjoint; j; j = (dxJoint*)j->next) {
+    if (!jointHasState (j)) continue;
+    state = saveReals (state,j->lambda,6);
+    state = saveReals (state,j->lambda_erp,6);
+    j->getState (state);
+    state += j->stateSize();
+    if (j->feedback) {
+      state = saveReals (state,(const dReal*)j->feedback,
+                         sizeof(dJointFeedback) / sizeof(dReal));
+    }
+  }
+}
+
+int dWorldSetState (dxWorld *w, const dReal *state, int size)
+{
+  dAASSERT (w && state);
+
+  // the state must come from this world, with the same bodies and joints
+  int nj = 0;
+  for (dxJoint *j = w->firstjoint; j; j = (dxJoint*)j->next) {
+    if (jointHasState (j)) nj++;
+  }
+  if (size < 2 || state[0] != (dReal) w->nb || state[1] != (dReal) nj ||
+      size != dWorldGetStateSize (w))
+    return 0;
+  state += 2;
+
+  for (dxBody *b = w->firstbody; b; b = (dxBody*)b->next) {
+    state = loadReals (state,b->posr.pos,3);
+    state = loadReals (state,b->posr.R,12);
+    state = loadReals (state,b->q,4);
+    state = loadReals (state,b->lvel,3);
+    state = loadReals (state,b->avel,3);
+    state = loadReals (state,b->facc,3);
+    state = loadReals (state,b->tacc,3);
+    if (*state++ != 0)
+      b->flags |= dxBodyDisabled;
+    else
+      b->flags &= ~dxBodyDisabled;
+    b->adis_timeleft = *state++;
+    b->adis_stepsleft = (int) *state++;
+    b->average_counter = (unsigned int) *state++;
+    b->average_ready = (int) *state++;
+    if (b->average_lvel_buffer) {
+      const int n = 4 * b->adis.average_samples;
+      state = loadReals (state,b->average_lvel_buffer[0],n);
+      state = loadReals (state,b->average_avel_buffer[0],n);
+    }
+  }
+
+  for (dxJoint *j = w->firstjoint; j; j = (dxJoint*)j->next) {
+    if (!jointHasState (j)) continue;
+    state = loadReals (state,j->lambda,6);
+    state = loadReals (state,j->lambda_erp,6);
+    j->setState (state);
+    state += j->stateSize();
+    if (j->feedback) {
+      state = loadReals (state,(dReal*)j->feedback,
+                         sizeof(dJointFeedback) / sizeof(dReal));
+    }
+  }
+
+  // notify the geoms and the user, as a step does
+  for (dxBody *b = w->firstbody; b; b = (dxBody*)b->next) {
+    for (dxGeom *geom = b->geom; geom; geom = dGeomGetBodyNext (geom))
+      dGeomMoved (geom);
+    if (b->moved_callback)
+      b->moved_callback(b);
+  }
+  return 1;
+}
+
 void dWorldDestroy (dxWorld *w)
 {
   // delete all bodies and joints
@@ -1747,9 +1933,9 @@ void dWorldDestroy (dxWorld *w)
     w->wmem->Release();
   }
 
-  if (w->threadpool) {
-    w->threadpool->wait();
-    delete w->threadpool;
+  delete w->island_scheduler;
+  for (auto &m : w->island_thread_wmems) {
+    if (m) m->Release();
   }
 
   if (w->row_threadpool) {
@@ -1772,24 +1958,21 @@ void dWorldSetGravity (dWorldID w, dReal x, dReal y, dReal z)
 int dWorldGetIslandThreads (dWorldID w)
 {
   dAASSERT (w);
-  if (!w->threadpool) {
-    return 0;
-  }
-  // else
-  return w->threadpool->size();
+  return w->island_scheduler->GetThreadCount();
 }
 
 void dWorldSetIslandThreads (dWorldID w, int num_island_threads)
 {
   dAASSERT (w);
-  if (w->threadpool) {
-    w->threadpool->wait();
-    delete w->threadpool;
-    w->threadpool = NULL;
-  }
-  if (num_island_threads > 0) {
-    w->threadpool = new boost::threadpool::pool(num_island_threads);
-  }
+  // the scheduler keeps its threads, only the difference is started or
+  // stopped
+  w->island_scheduler->SetThreadCount(num_island_threads);
+}
+
+dReal dWorldGetIslandThreadUtilization (dWorldID w)
+{
+  dAASSERT (w);
+  return (dReal)w->island_scheduler->GetUtilization();
 }
 
 void dWorldSetQuickStepThreads (dWorldID w, int num_quickstep_threads)
@@ -1897,6 +2080,11 @@ void dWorldCleanupWorkingMemory(dWorldID w)
   {
     wmem->CleanupMemory();
   }
+
+  for (auto &m : w->island_thread_wmems)
+  {
+    if (m) m->CleanupMemory();
+  }
 }
 
 int dWorldSetStepMemoryReservationPolicy(dWorldID w, const dWorldStepReserveInfo *policyinfo)
@@ -2313,6 +2501,12 @@ bool  dWorldGetQuickStepExperimentalRowReordering (dWorldID w)
   return w->qs.row_reorder1;
 }
 
+int  dWorldGetQuickStepRowColoringThreads (dWorldID w)
+{
+  dAASSERT(w);
+  return w->qs.row_coloring_threads;
+}
+
 dReal  dWorldGetQuickStepWarmStartFactor (dWorldID w)
 {
   dAASSERT(w);
@@ -2367,6 +2561,13 @@ void dWorldSetQuickStepExperimentalRowReordering (dWorldID w, bool order)
   w->qs.row_reorder1 = order;
 }
 
+void dWorldSetQuickStepRowColoringThreads (dWorldID w, int threads)
+{
+  dAASSERT(w);
+  w->qs.row_coloring_threads = threads > 0 ? threads : 0;
+  w->island_scheduler->SetTeamThreadCount(w->qs.row_coloring_threads);
+}
+
 void dWorldSetQuickStepWarmStartFactor (dWorldID w, dReal warm)
 {
   dAASSERT(w);
@@ -45,6 +45,10 @@ ODE initialization/finalization code
 static unsigned int g_uiODEInitCounter = 0;
 static unsigned int g_uiODEInitModes = 0;
 
+// Guards the counters above, so that worlds living in different threads
+// can initialize and close ODE concurrently.
+static boost::mutex g_odeInitMutex;
+
 enum EODEINITMODE
 {
 	OIM__MIN,
@@ -469,6 +473,8 @@ static void gzInternalCleanupODEAllDataForThread()
 
 void dInitODE()
 {
+	boost::mutex::scoped_lock lock(g_odeInitMutex);
+
 	int bInitResult = gzInternalInitODE(0);
 	dIASSERT(bInitResult); dVARIABLEUSED(bInitResult);
 
@@ -478,6 +484,8 @@ void dInitODE()
 
 int dInitODE2(unsigned int uiInitFlags/*=0*/)
 {
+  boost::mutex::scoped_lock lock(g_odeInitMutex);
+
   bool bResult = false;
 
   bool bODEInitialized = false;
@@ -514,6 +522,8 @@ int dInitODE2(unsigned int uiInitFlags/*=0*/)
 
 int dAllocateODEDataForThread(unsigned int uiAllocateFlags)
 {
+	boost::mutex::scoped_lock lock(g_odeInitMutex);
+
 	dUASSERT(g_uiODEInitCounter != 0, "Call dInitODE2 first");
 
 	bool bResult = gzInternalAllocateODEDataForThread(uiAllocateFlags);
@@ -531,6 +541,8 @@ void dCleanupODEAllDataForThread()
 
 void dCloseODE()
 {
+	boost::mutex::scoped_lock lock(g_odeInitMutex);
+
 	dUASSERT(g_uiODEInitCounter != 0, "dCloseODE must not be called without dInitODE2 or if dInitODE2 fails"); // dCloseODE must not be called without dInitODE2 or if dInitODE2 fails
 
 	gzInternalCloseODE();
@@ -552,7 +552,7 @@ void dxQuickStepper (dxWorldProcessContext *context,
 }
 
 size_t dxEstimateQuickStepMemoryRequirements (
-  dxBody * const * /*body*/, int nb, dxJoint * const *_joint, int _nj)
+  dxBody * const *body, int nb, dxJoint * const *_joint, int _nj)
 {
   int nj, m, mfb;
 
@@ -627,7 +627,8 @@ size_t dxEstimateQuickStepMemoryRequirements (
 #endif
         {
           // for PGS_LCP
-          size_t sub3_res1 = EstimatePGS_LCPMemoryRequirements(m,nb);
+          size_t sub3_res1 = EstimatePGS_LCPMemoryRequirements(m,nb,
+            nb > 0 ? &body[0]->world->qs : NULL);
 
           size_t sub3_res2 = 0;
 #ifdef CHECK_VELOCITY_OBEYS_CONSTRAINT
@@ -0,0 +1,557 @@
+/*************************************************************************
+ *                                                                       *
+ * Open Dynamics Engine, Copyright (C) 2001,2002 Russell L. Smith.       *
+ * All rights reserved.  Email: russ@q12.org   Web: www.q12.org          *
+ *                                                                       *
+ * This library is free software; you can redistribute it and/or         *
+ * modify it under the terms of EITHER:                                  *
+ *   (1) The GNU Lesser General Public License as published by the Free  *
+ *       Software Foundation; either version 2.1 of the License, or (at  *
+ *       your option) any later version. The text of the GNU Lesser      *
+ *       General Public License is included with this library in the     *
+ *       file LICENSE.TXT.                                               *
+ *   (2) The BSD-style license that is included with this library in     *
+ *       the file LICENSE-BSD.TXT.                                       *
+ *                                                                       *
+ * This library is distributed in the hope that it will be useful,       *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the files    *
+ * LICENSE.TXT and LICENSE-BSD.TXT for more details.                     *
+ *                                                                       *
+ *************************************************************************/
+
+// graph colored PGS sweep. rows that act on different bodies do not read
+// each other's results within a sweep, so the rows of one color can be
+// solved by several threads at once without changing the answer.
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <thread>
+
+#include <gazebo/ode/common.h>
+#include <gazebo/ode/odemath.h>
+#include <gazebo/ode/objects.h>
+#include <gazebo/ode/timer.h>
+#include <gazebo/ode/error.h>
+#include "config.h"
+#include "objects.h"
+#include "joints/joint.h"
+#include "util.h"
+#include "island_scheduler.h"
+
+#include "quickstep_util.h"
+#include "quickstep_pgs_lcp.h"
+
+using namespace ode;
+
+namespace
+{
+  // fewer rows per thread are not worth starting a thread
+  const int kRowsPerThread = 64;
+
+  // colors with fewer rows are swept by one thread after the others.
+  // this does not depend on the thread count, so the result does not
+  // either.
+  const int kMinParallelRows = 32;
+
+  // colors per phase, one bit of the body masks each
+  const int kMaxColors = 64;
+
+  // everything a row update reads, packed in solving order. 256 bytes,
+  // so the 6-vectors stay aligned for dot6 and sum6.
+  struct dxColoredRow
+  {
+    dReal J[12];
+    dReal iMJ[12];
+    dReal rhs;
+    dReal rhs_erp;
+    dReal Adcfm;
+    dReal Ad2;  // 1 / Ad^2, turns dlambda into the residual
+    dReal lo;
+    dReal hi;
+    int index;
+    int findex;
+    int b1;
+    int b2;
+  };
+
+  // rows solved between two barriers
+  struct dxColorSegment
+  {
+    int begin, end;
+    bool parallel;  // split between the threads, or thread 0 only
+    bool friction;  // has rows with findex >= 0
+  };
+
+  // sums of one thread, per row type: bilateral, contact normal, friction
+  struct dxRowSums
+  {
+    dReal dlambda[3];
+    dReal error[3];
+    int count[3];
+  };
+
+  class dxRowBarrier
+  {
+  public:
+    explicit dxRowBarrier(int threads)
+      : m_threads(threads), m_count(0), m_generation(0) {}
+
+    void Wait()
+    {
+      if (m_threads == 1)
+        return;
+
+      const unsigned generation = m_generation.load(std::memory_order_acquire);
+      if (m_count.fetch_add(1, std::memory_order_acq_rel) == m_threads - 1)
+      {
+        m_count.store(0, std::memory_order_relaxed);
+        m_generation.fetch_add(1, std::memory_order_release);
+        return;
+      }
+
+      // colors are short, spin a little before giving up the core
+      for (int spins = 0;
+           m_generation.load(std::memory_order_acquire) == generation;
+           ++spins)
+      {
+        if (spins > 1000)
+          std::this_thread::yield();
+      }
+    }
+
+  private:
+    const int m_threads;
+    std::atomic<int> m_count;
+    std::atomic<unsigned> m_generation;
+  };
+
+  struct dxColoredSweep
+  {
+    const dxColoredRow *rows;
+    const dxColorSegment *segments;
+    int nsegments;
+    dRealMutablePtr lambda;
+    dRealMutablePtr lambda_erp;
+    dRealMutablePtr caccel;
+    dRealMutablePtr caccel_erp;
+    dxQuickStepParameters *qs;
+    int threads;
+    // 2 * threads, double buffered by iteration so that a fast thread
+    // does not overwrite sums another thread is still reading
+    dxRowSums *sums;
+    dxRowBarrier *barrier;
+  };
+}
+
+//***************************************************************************
+// coloring
+
+// greedily color the rows order[begin, end) so that no two rows of a color
+// share a body. rows that find no free color get kMaxColors.
+static void ColorRows (const IndexError *order, int begin, int end,
+  const int *jb, int nb, uint64_t *mask, int *color, int *count)
+{
+  memset(mask, 0, sizeof(uint64_t) * nb);
+  memset(count, 0, sizeof(int) * (kMaxColors + 1));
+
+  for (int i = begin; i < end; ++i)
+  {
+    const int index = order[i].index;
+    const int b1 = jb[index*2];
+    const int b2 = jb[index*2+1];
+
+    uint64_t used = mask[b1];
+    if (b2 >= 0)
+      used |= mask[b2];
+
+    int c = 0;
+    while (c < kMaxColors && (used & ((uint64_t)1 << c)))
+      ++c;
+
+    if (c < kMaxColors)
+    {
+      mask[b1] |= (uint64_t)1 << c;
+      if (b2 >= 0)
+        mask[b2] |= (uint64_t)1 << c;
+    }
+    color[i] = c;
+    ++count[c];
+  }
+}
+
+// copy the rows order[begin, end) into rows[begin, end), one parallel
+// segment per large color followed by a segment with everything else.
+static void PackRows (const IndexError *order, int begin, int end,
+  const int *color, const int *count, bool friction,
+  dRealPtr J, dRealPtr iMJ, const int *jb, const int *findex,
+  dRealPtr lo, dRealPtr hi, dRealPtr Ad, dRealPtr Adcfm,
+  dRealPtr rhs, dRealPtr rhs_erp,
+  dxColoredRow *rows, dxColorSegment *segments, int &nsegments)
+{
+  // first position of each color, small colors share the serial segment
+  int start[kMaxColors + 1];
+  int serial = begin;
+  for (int c = 0; c < kMaxColors; ++c)
+  {
+    if (count[c] >= kMinParallelRows)
+    {
+      dxColorSegment &segment = segments[nsegments++];
+      segment.begin = serial;
+      segment.end = serial + count[c];
+      segment.parallel = true;
+      segment.friction = friction;
+      serial = segment.end;
+    }
+  }
+  if (serial < end)
+  {
+    dxColorSegment &segment = segments[nsegments++];
+    segment.begin = serial;
+    segment.end = end;
+    segment.parallel = false;
+    segment.friction = friction;
+  }
+
+  int next = begin;
+  for (int c = 0; c < kMaxColors; ++c)
+  {
+    if (count[c] >= kMinParallelRows)
+    {
+      start[c] = next;
+      next += count[c];
+    }
+  }
+  for (int c = 0; c <= kMaxColors; ++c)
+  {
+    if (c == kMaxColors || count[c] < kMinParallelRows)
+      start[c] = -1;
+  }
+
+  // keep the given order within each segment
+  for (int i = begin; i < end; ++i)
+  {
+    const int c = color[i];
+    const int pos = start[c] >= 0 ? start[c]++ : serial++;
+    const int index = order[i].index;
+
+    dxColoredRow &row = rows[pos];
+    memcpy(row.J, J + index*12, sizeof(row.J));
+    memcpy(row.iMJ, iMJ + index*12, sizeof(row.iMJ));
+    row.rhs = rhs[index];
+    row.rhs_erp = rhs_erp[index];
+    row.Adcfm = Adcfm[index];
+    // Ad is only 0 with a SOR parameter of 0, which scales the row's J,
+    // rhs and Adcfm to 0 as well. such a row adds 0 to the residual, as
+    // in PGS_LCP.
+    row.Ad2 = _dequal(Ad[index], 0.0) ? 0.0 : 1.0 / (Ad[index] * Ad[index]);
+    row.lo = lo[index];
+    row.hi = hi[index];
+    row.index = index;
+    row.findex = findex[index];
+    row.b1 = jb[index*2];
+    row.b2 = jb[index*2+1];
+  }
+}
+
+//***************************************************************************
+// sweeping
+
+static void SweepColoredRows (dxColoredSweep *sweep, int thread)
+{
+  const dxColoredRow *rows = sweep->rows;
+  dRealMutablePtr lambda = sweep->lambda;
+  dRealMutablePtr lambda_erp = sweep->lambda_erp;
+  dRealMutablePtr caccel = sweep->caccel;
+  dRealMutablePtr caccel_erp = sweep->caccel_erp;
+  dxQuickStepParameters *qs = sweep->qs;
+  const int threads = sweep->threads;
+
+  const int num_iterations = qs->num_iterations;
+  const int friction_iterations = qs->friction_iterations;
+  const dReal pgs_lcp_tolerance = qs->pgs_lcp_tolerance;
+  const Friction_Model friction_model = qs->friction_model;
+  const dReal smooth_contacts = qs->smooth_contacts;
+
+  dxRowSums local;
+  memset(&local, 0, sizeof(local));
+
+  const int total_iterations = num_iterations + friction_iterations;
+  for (int iteration = 0; iteration < total_iterations; ++iteration)
+  {
+    // during extra friction iterations only friction rows are solved, and
+    // the sums of the other rows are kept from the last full iteration
+    const bool friction_only = iteration >= num_iterations;
+    local.dlambda[2] = 0;
+    local.error[2] = 0;
+    local.count[2] = 0;
+    if (!friction_only)
+    {
+      for (int k = 0; k < 2; ++k)
+      {
+        local.dlambda[k] = 0;
+        local.error[k] = 0;
+        local.count[k] = 0;
+      }
+    }
+
+    for (int s = 0; s < sweep->nsegments; ++s)
+    {
+      const dxColorSegment &segment = sweep->segments[s];
+      if (friction_only && !segment.friction)
+        continue;
+
+      int begin = segment.begin;
+      int end = segment.end;
+      if (segment.parallel)
+      {
+        const int n = segment.end - segment.begin;
+        begin = segment.begin + n * thread / threads;
+        end = segment.begin + n * (thread + 1) / threads;
+      }
+      else if (thread != 0)
+      {
+        end = begin;
+      }
+
+      for (int p = begin; p < end; ++p)
+      {
+        const dxColoredRow &row = rows[p];
+        const int index = row.index;
+        const int constraint_index = row.findex;
+
+        if (friction_only && constraint_index < 0)
+          continue;
+
+        dRealMutablePtr caccel_ptr1 = caccel + 6*row.b1;
+        dRealMutablePtr caccel_ptr2 = row.b2 >= 0 ? caccel + 6*row.b2 : NULL;
+        dRealMutablePtr caccel_erp_ptr1 = caccel_erp + 6*row.b1;
+        dRealMutablePtr caccel_erp_ptr2 =
+          row.b2 >= 0 ? caccel_erp + 6*row.b2 : NULL;
+
+        const dReal old_lambda = lambda[index];
+        const dReal old_lambda_erp = lambda_erp[index];
+
+        dReal delta = row.rhs - old_lambda*row.Adcfm;
+        delta -= quickstep::dot6(caccel_ptr1, row.J);
+        if (caccel_ptr2)
+          delta -= quickstep::dot6(caccel_ptr2, row.J + 6);
+
+        dReal delta_erp = row.rhs_erp - old_lambda_erp*row.Adcfm;
+        delta_erp -= quickstep::dot6(caccel_erp_ptr1, row.J);
+        if (caccel_erp_ptr2)
+          delta_erp -= quickstep::dot6(caccel_erp_ptr2, row.J + 6);
+
+        // limits, as in ComputeRows. the normal row a friction row refers
+        // to shares its bodies, so it was solved in an earlier segment.
+        dReal hi_act, lo_act, hi_act_erp, lo_act_erp;
+        if (constraint_index >= 0)
+        {
+          if (index - constraint_index >= 3 ||
+              friction_model == pyramid_friction)
+          {
+            // torsional friction, or pyramid friction
+            hi_act = dFabs (row.hi * lambda[constraint_index]);
+            lo_act = -hi_act;
+            hi_act_erp = dFabs (row.hi * lambda_erp[constraint_index]);
+            lo_act_erp = -hi_act_erp;
+          }
+          else
+          {
+            // box friction, UseColoredPGS rules out cone friction
+            hi_act = row.hi;
+            lo_act = -hi_act;
+            hi_act_erp = row.hi;
+            lo_act_erp = -hi_act_erp;
+          }
+        }
+        else
+        {
+          hi_act = row.hi;
+          lo_act = row.lo;
+          hi_act_erp = row.hi;
+          lo_act_erp = row.lo;
+        }
+
+        lambda[index] = old_lambda + delta;
+        if (lambda[index] < lo_act) {
+          delta = lo_act-old_lambda;
+          lambda[index] = lo_act;
+        }
+        else if (lambda[index] > hi_act) {
+          delta = hi_act-old_lambda;
+          lambda[index] = hi_act;
+        }
+
+        lambda_erp[index] = old_lambda_erp + delta_erp;
+        if (lambda_erp[index] < lo_act_erp) {
+          delta_erp = lo_act_erp-old_lambda_erp;
+          lambda_erp[index] = lo_act_erp;
+        }
+        else if (lambda_erp[index] > hi_act_erp) {
+          delta_erp = hi_act_erp-old_lambda_erp;
+          lambda_erp[index] = hi_act_erp;
+        }
+
+#ifdef SMOOTH_LAMBDA
+        if (constraint_index != -1)
+        {
+          lambda[index] = (1.0 - smooth_contacts)*lambda[index]
+            + smooth_contacts*old_lambda;
+        }
+#endif
+
+        quickstep::sum6(caccel_ptr1, delta, row.iMJ);
+        if (caccel_ptr2)
+          quickstep::sum6(caccel_ptr2, delta, row.iMJ + 6);
+        quickstep::sum6(caccel_erp_ptr1, delta_erp, row.iMJ);
+        if (caccel_erp_ptr2)
+          quickstep::sum6(caccel_erp_ptr2, delta_erp, row.iMJ + 6);
+
+        const int type = constraint_index == -1 ? 0 :
+          (constraint_index == -2 ? 1 : 2);
+        const dReal delta2 = delta*delta;
+        local.dlambda[type] += delta2;
+        local.error[type] += delta2*row.Ad2;
+        local.count[type]++;
+      }
+
+      sweep->barrier->Wait();
+    }
+
+    // every thread adds up the sums in the same order, so all of them
+    // take the same decision to stop
+    dxRowSums *sums = sweep->sums + (iteration & 1) * threads;
+    sums[thread] = local;
+    sweep->barrier->Wait();
+
+    dReal rms_dlambda[3] = {0, 0, 0};
+    dReal rms_error[3] = {0, 0, 0};
+    int m_rms_dlambda[3] = {0, 0, 0};
+    for (int t = 0; t < threads; ++t)
+    {
+      for (int k = 0; k < 3; ++k)
+      {
+        rms_dlambda[k] += sums[t].dlambda[k];
+        rms_error[k] += sums[t].error[k];
+        m_rms_dlambda[k] += sums[t].count[k];
+      }
+    }
+
+    const int m_total = m_rms_dlambda[0] + m_rms_dlambda[1] + m_rms_dlambda[2];
+    dReal dlambda_mean[4] = {0, 0, 0, 0};
+    dReal residual_mean[4] = {0, 0, 0, 0};
+    for (int k = 0; k < 3; ++k)
+    {
+      if (m_rms_dlambda[k] > 0)
+      {
+        dlambda_mean[k] = rms_dlambda[k]/(dReal)m_rms_dlambda[k];
+        residual_mean[k] = rms_error[k]/(dReal)m_rms_dlambda[k];
+      }
+    }
+    if (rms_dlambda[0] + rms_dlambda[1] + rms_dlambda[2] > 0)
+      dlambda_mean[3] = (rms_dlambda[0] + rms_dlambda[1] + rms_dlambda[2])/
+        (dReal)m_total;
+    if (rms_error[0] + rms_error[1] + rms_error[2] > 0)
+      residual_mean[3] = (rms_error[0] + rms_error[1] + rms_error[2])/
+        (dReal)m_total;
+
+    if (thread == 0)
+    {
+      for (int k = 0; k < 4; ++k)
+      {
+        qs->rms_dlambda[k] = sqrt(dlambda_mean[k]);
+        qs->rms_constraint_residual[k] = sqrt(residual_mean[k]);
+      }
+      qs->num_contacts = m_rms_dlambda[1];
+    }
+
+    // option to stop when tolerance has been met
+    if (sqrt(residual_mean[3]) < pgs_lcp_tolerance)
+      break;
+  }
+}
+
+static void SweepColoredTeam (void *data, int thread, int /*threads*/)
+{
+  SweepColoredRows(static_cast<dxColoredSweep *>(data), thread);
+}
+
+//***************************************************************************
+
+bool quickstep::UseColoredPGS(const dxQuickStepParameters *qs)
+{
+  return qs->row_coloring_threads > 0 && qs->precon_iterations <= 0 &&
+    !qs->thread_position_correction && qs->friction_model != cone_friction;
+}
+
+void quickstep::ColoredPGS_LCP(dxWorldProcessContext *context,
+    const int m, const int nb, dRealPtr J, dRealPtr iMJ, const int *jb,
+    const IndexError *order, const int *findex, dRealPtr lo, dRealPtr hi,
+    dRealPtr Ad, dRealPtr Adcfm, dRealPtr rhs, dRealPtr rhs_erp,
+    dRealMutablePtr lambda, dRealMutablePtr lambda_erp,
+    dRealMutablePtr caccel, dRealMutablePtr caccel_erp,
+    dxQuickStepParameters *qs, dxIslandScheduler *scheduler)
+{
+  int threads = m / kRowsPerThread;
+  if (threads > qs->row_coloring_threads)
+    threads = qs->row_coloring_threads;
+  if (threads < 1)
+    threads = 1;
+
+  // rows with findex < 0 come first in order, and are solved before the
+  // friction rows that read their lambda
+  int split = 0;
+  while (split < m && findex[order[split].index] < 0)
+    ++split;
+
+  uint64_t *mask = context->AllocateArray<uint64_t> (nb);
+  int *color = context->AllocateArray<int> (m);
+  int count[kMaxColors + 1];
+  dxColoredRow *rows = context->AllocateArray<dxColoredRow> (m);
+  dxColorSegment *segments =
+    context->AllocateArray<dxColorSegment> (2 * (kMaxColors + 1));
+  int nsegments = 0;
+
+  IFTIMING (dTimerNow ("color rows"));
+  ColorRows(order, 0, split, jb, nb, mask, color, count);
+  PackRows(order, 0, split, color, count, false, J, iMJ, jb, findex,
+    lo, hi, Ad, Adcfm, rhs, rhs_erp, rows, segments, nsegments);
+  ColorRows(order, split, m, jb, nb, mask, color, count);
+  PackRows(order, split, m, color, count, true, J, iMJ, jb, findex,
+    lo, hi, Ad, Adcfm, rhs, rhs_erp, rows, segments, nsegments);
+
+  // the sweep runs on idle workers of the island scheduler, which keeps
+  // at most a hardware thread each, so the barriers never wait on threads
+  // that are not running
+  threads = scheduler->ReserveTeam(threads);
+
+  dxRowBarrier barrier(threads);
+  dxColoredSweep sweep;
+  sweep.rows = rows;
+  sweep.segments = segments;
+  sweep.nsegments = nsegments;
+  sweep.lambda = lambda;
+  sweep.lambda_erp = lambda_erp;
+  sweep.caccel = caccel;
+  sweep.caccel_erp = caccel_erp;
+  sweep.qs = qs;
+  sweep.threads = threads;
+  sweep.sums = context->AllocateArray<dxRowSums> (2 * threads);
+  sweep.barrier = &barrier;
+
+  IFTIMING (dTimerNow ("start colored pgs rows"));
+  scheduler->RunTeam(threads, SweepColoredTeam, &sweep);
+  IFTIMING (dTimerNow ("colored pgs rows done"));
+}
+
+size_t quickstep::EstimateColoredPGS_LCPMemoryRequirements(int m, int nb)
+{
+  size_t res = dEFFICIENT_SIZE(sizeof(uint64_t) * nb); // for mask
+  res += dEFFICIENT_SIZE(sizeof(int) * m); // for color
+  res += dEFFICIENT_SIZE(sizeof(dxColoredRow) * m); // for rows
+  res += dEFFICIENT_SIZE(sizeof(dxColorSegment) * 2 * (kMaxColors + 1)); // for segments
+  res += dEFFICIENT_SIZE(sizeof(dxRowSums) * 2 * (m / kRowsPerThread + 1)); // for sums
+  return res;
+}
@@ -1190,6 +1190,16 @@ void quickstep::PGS_LCP (dxWorldProcessContext *context,
     }
 #endif
 
+#if !defined(REORDER_CONSTRAINTS) && !defined(PENETRATION_JVERROR_CORRECTION)
+  if (quickstep::UseColoredPGS(qs))
+  {
+    quickstep::ColoredPGS_LCP(context, m, nb, J, iMJ, jb, order, findex,
+      lo, hi, Ad, Adcfm, rhs, rhs_erp, lambda, lambda_erp, caccel, caccel_erp,
+      qs, body[0]->world->island_scheduler);
+    return;
+  }
+#endif
+
 #ifdef REORDER_CONSTRAINTS
   // the lambda computed at the previous iteration.
   // this is used to measure error for when we are reordering the indexes.
@@ -1569,7 +1579,8 @@ void quickstep::dxConeFrictionModel(dReal& lo_act, dReal& hi_act, dReal& lo_act_
   } // if-else (abs(v)< eps)
 }
 
-size_t quickstep::EstimatePGS_LCPMemoryRequirements(int m,int /*nb*/)
+size_t quickstep::EstimatePGS_LCPMemoryRequirements(int m,int nb,
+    const dxQuickStepParameters *qs)
 {
   size_t res = dEFFICIENT_SIZE(sizeof(dReal) * 12 * m); // for iMJ
   res += dEFFICIENT_SIZE(sizeof(dReal) * m); // for Ad
@@ -1585,6 +1596,10 @@ size_t quickstep::EstimatePGS_LCPMemoryRequirements(int m,int /*nb*/)
   res += dEFFICIENT_SIZE(sizeof(dxPGSLCPParameters) * m); // for params_erp
   res += dEFFICIENT_SIZE(sizeof(dxPGSLCPParameters) * m); // for params
   res += dEFFICIENT_SIZE(sizeof(boost::recursive_mutex)); // for mutex
+#if !defined(REORDER_CONSTRAINTS) && !defined(PENETRATION_JVERROR_CORRECTION)
+  if (qs && UseColoredPGS(qs))
+    res += EstimateColoredPGS_LCPMemoryRequirements(m, nb); // for ColoredPGS_LCP
+#endif
   return res;
 }
 
@@ -74,7 +74,41 @@ void dxConeFrictionModel(dReal& lo_act, dReal& hi_act, dReal& lo_act_erp, dReal&
     int nRows, const int nb, dxBody * const *body, int i, const IndexError *order,
     const int *findex, dRealPtr lo, dRealPtr hi, dRealMutablePtr lambda, dRealMutablePtr lambda_erp);
 
-size_t EstimatePGS_LCPMemoryRequirements(int m,int /*nb*/);
+/// \brief Memory PGS_LCP takes from the world process context.
+/// \param[in] qs Solver parameters, the colored sweep is only counted if
+/// they enable it. NULL counts the plain sweep.
+size_t EstimatePGS_LCPMemoryRequirements(int m,int nb,
+    const dxQuickStepParameters *qs);
+
+/// \brief Whether the graph colored sweep supports the solver parameters.
+/// It needs row_coloring_threads > 0 and does not support preconditioning,
+/// threaded position correction or the cone friction model.
+/// \param[in] qs Solver parameters
+bool UseColoredPGS(const dxQuickStepParameters *qs);
+
+/// \brief PGS sweeps with rows graph colored by body, so that the rows of
+/// a color can be solved in parallel. Rows are copied in color order into
+/// packed records before iterating. Takes over from PGS_LCP once J, iMJ,
+/// rhs and Adcfm are scaled and the solving order is known.
+/// \param[in] order      Solving order, with findex < 0 rows first
+/// \param[in] Ad         Row scales, used for the residual
+/// \param[in] Adcfm      Row cfm scaled by Ad
+/// \param[in,out] lambda Constraint force
+/// \param[in,out] lambda_erp The erp-version of constraint force
+/// \param[in,out] caccel Constraint acceleration
+/// \param[in,out] caccel_erp The erp-version of constraint acceleration
+/// \param[in,out] qs     Solver parameters, receives the rms errors
+/// \param[in] scheduler  Island scheduler of the world, lends its idle
+/// workers to the sweep
+void ColoredPGS_LCP(dxWorldProcessContext *context,
+    const int m, const int nb, dRealPtr J, dRealPtr iMJ, const int *jb,
+    const IndexError *order, const int *findex, dRealPtr lo, dRealPtr hi,
+    dRealPtr Ad, dRealPtr Adcfm, dRealPtr rhs, dRealPtr rhs_erp,
+    dRealMutablePtr lambda, dRealMutablePtr lambda_erp,
+    dRealMutablePtr caccel, dRealMutablePtr caccel_erp,
+    dxQuickStepParameters *qs, dxIslandScheduler *scheduler);
+
+size_t EstimateColoredPGS_LCPMemoryRequirements(int m, int nb);
 
     } // namespace quickstep
 } // namespace ode
@@ -20,11 +20,13 @@
  *                                                                       *
  *************************************************************************/
 
+#include <algorithm>
 #include <gazebo/ode/ode.h>
 #include "config.h"
 #include "objects.h"
 #include "joints/joint.h"
 #include "util.h"
+#include "island_scheduler.h"
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/bind.hpp>
 #include <gazebo/ode/timer.h>
@@ -593,10 +595,36 @@ void dxProcessOneIsland(dxWorldProcessContext *island_context, dxWorld *world, d
 #endif
 }
 
-void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
+// what the island threads need to step an island
+struct dxIslandStepJob
 {
-  const int sizeelements = 2;
+  dxWorld *world;
+  dReal stepsize;
+  dstepper_fn_t stepper;
+  dxBody *const *body;
+  dxJoint *const *joint;
+};
+
+static void dxProcessScheduledIsland(void *data, int thread,
+                                     int bodyofs, int bcount,
+                                     int jointofs, int jcount)
+{
+  dxIslandStepJob *job = (dxIslandStepJob *)data;
+
+  // random numbers drawn while stepping come from the world's own seed
+  dxRandSeedScope rand_scope(&job->world->rand_seed);
 
+  // each island thread keeps its own working memory between steps
+  dxStepWorkingMemory *island_wmem = job->world->island_thread_wmems[thread];
+  dIASSERT(island_wmem != NULL);
+  dxWorldProcessContext *island_context = island_wmem->GetWorldProcessingContext();
+
+  dxProcessOneIsland(island_context, job->world, job->stepsize, job->stepper,
+                     job->body + bodyofs, bcount, job->joint + jointofs, jcount);
+}
+
+void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
+{
   dxStepWorkingMemory *wmem = world->wmem;
   dIASSERT(wmem != NULL);
 
@@ -609,12 +637,7 @@ void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
   dxJoint *const *joint;
   context->RetrievePreallocations(islandcount, islandsizes, body, joint, islandreqs);
 
-  dxBody *const *bodystart = body;
-  dxJoint *const *jointstart = joint;
-
   IFTIMING(dTimerStart("preprocessing islands"));
-  int island_index = 0;
-  int const *const sizesend = islandsizes + islandcount * sizeelements;
 
 #ifdef REPORT_THREAD_TIMING
   struct timeval tv;
@@ -624,35 +647,18 @@ void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
   printf(">>>>>>>>>>>> start island spawn threads at time %f\n",cur_time);
 #endif
 
-  for (int const *sizescurr = islandsizes; sizescurr != sizesend; sizescurr += sizeelements) {
-    int bcount = sizescurr[0];
-    int jcount = sizescurr[1];
-
-    // get working memory for each island
-    dxStepWorkingMemory *island_wmem = world->island_wmems[island_index++];
-    dIASSERT(island_wmem != NULL);
-    dxWorldProcessContext *island_context = island_wmem->GetWorldProcessingContext();
-
-#define USE_TPISLAND
-#ifdef USE_TPISLAND
-    IFTIMING(dTimerNow("scheduling island"));
-    //printf("debug opende tp %d\n",world->threadpool->size());
-    if (world->threadpool && world->threadpool->size() > 0)
-      world->threadpool->schedule(boost::bind(dxProcessOneIsland,island_context, world, stepsize, stepper,bodystart, bcount, jointstart, jcount));
-    else //automatically skip threadpool if only 1 thread allocated
-      dxProcessOneIsland(island_context, world, stepsize, stepper,bodystart, bcount, jointstart, jcount);
-#else
-    dxProcessOneIsland(island_context, world, stepsize, stepper,bodystart, bcount, jointstart, jcount);
-#endif
+  dxIslandStepJob job;
+  job.world = world;
+  job.stepsize = stepsize;
+  job.stepper = stepper;
+  job.body = body;
+  job.joint = joint;
+
+  // the stepper's memory estimate doubles as the cost of an island
+  IFTIMING(dTimerNow("scheduling islands"));
+  world->island_scheduler->Run(islandcount, islandsizes, islandreqs,
+                               &dxProcessScheduledIsland, &job);
 
-    bodystart += bcount;
-    jointstart += jcount;
-  }
-#ifdef USE_TPISLAND
-  IFTIMING(dTimerNow("islands wait"));
-  if (world->threadpool && world->threadpool->size() > 0)
-    world->threadpool->wait();
-#endif
   IFTIMING(dTimerEnd());
   IFTIMING(dTimerReport (stdout,1));
 
@@ -663,9 +669,10 @@ void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper)
   printf("<<<<<<<<<<<< all island threads stopped at time %f with duration %f\n",end_time,end_time - cur_time);
 #endif
 
-  for (auto &m : world->island_wmems)
+  for (auto &m : world->island_thread_wmems)
   {
-    m->GetWorldProcessingContext()->CleanupContext();
+    if (m && m->GetWorldProcessingContext())
+      m->GetWorldProcessingContext()->CleanupContext();
   }
 
   context->CleanupContext();
@@ -865,23 +872,21 @@ bool dxReallocateWorldProcessContext (dxWorld *world,
     dxJoint *const *joint;
     context->RetrievePreallocations(islandcount, islandsizes, body, joint, islandreqs);
 
-    if (static_cast<size_t>(islandcount) > world->island_wmems.size())
-      world->island_wmems.resize(islandcount);
-
+    // any island thread may get any island, so each one needs enough
+    // memory for the largest island. the memory is kept between steps.
+    size_t maxislandreq = 0;
     for (int jj = 0; jj < islandcount; jj++)
-    {
-      dxStepWorkingMemory *island_wmem = NULL;
+      maxislandreq = std::max(maxislandreq, islandreqs[jj]);
 
-      // for individual islands
-      // this is starting a new instance of dxStepWorkingMemory
-      if (!world->island_wmems[jj])
-      {
-        island_wmem = new dxStepWorkingMemory();
-        world->island_wmems[jj] = island_wmem;
-      }
-      else
-        island_wmem = world->island_wmems[jj];
+    const size_t threadcount = world->island_scheduler->GetSlotCount();
+    for (size_t jj = threadcount; jj < world->island_thread_wmems.size(); jj++)
+      world->island_thread_wmems[jj]->Release();
+    world->island_thread_wmems.resize(threadcount, NULL);
 
+    for (size_t jj = 0; islandcount > 0 && jj < threadcount; jj++)
+    {
+      // this is starting a new instance of dxStepWorkingMemory
+      dxStepWorkingMemory *island_wmem = AllocateOnDemand(world->island_thread_wmems[jj]);
       if (!island_wmem) return false;
 
       dxWorldProcessContext *island_oldcontext = island_wmem->GetWorldProcessingContext();
@@ -893,7 +898,7 @@ bool dxReallocateWorldProcessContext (dxWorld *world,
       dxWorldProcessContext *island_context = island_oldcontext;
 
       // this is where islandreqs is used, to MakeArenaSize
-      island_context = InternalReallocateWorldProcessContext(island_context, islandreqs[jj], island_memmgr, island_reserveinfo->m_fReserveFactor, island_reserveinfo->m_uiReserveMinimum);
+      island_context = InternalReallocateWorldProcessContext(island_context, maxislandreq, island_memmgr, island_reserveinfo->m_fReserveFactor, island_reserveinfo->m_uiReserveMinimum);
       island_wmem->SetWorldProcessingContext(island_context); // set dxStepWorkingMemory to context
     }
   }
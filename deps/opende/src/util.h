@@ -226,6 +226,19 @@ typedef void (*dstepper_fn_t) (dxWorldProcessContext *context,  // put island st
 
 void dxProcessIslands (dxWorld *world, dReal stepsize, dstepper_fn_t stepper);
 
+// While alive, dRand() and the functions built on it use the given seed on
+// the calling thread, such as the seed of the world being stepped, instead
+// of the global one.
+class dxRandSeedScope
+{
+public:
+  explicit dxRandSeedScope(unsigned long *seed);
+  ~dxRandSeedScope();
+
+private:
+  unsigned long *previous;
+};
+
 
 typedef size_t (*dmemestimate_fn_t) (dxBody * const *body, int nb,
   dxJoint * const *_joint, int _nj);
@@ -2,7 +2,7 @@
 #define CUDA_TIMER_H
 
 #include <cuda.h>
-#include <ode/timer.h>
+#include <gazebo/ode/timer.h>
 
 class CUDAODETimer
 {
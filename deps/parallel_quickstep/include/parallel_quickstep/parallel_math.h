@@ -466,9 +466,13 @@ inline dxHost dxDevice void operator-=(float4 &a, float4 b)
 }
 
 // multiply
-template <typename T> inline dxHost dxDevice typename vec4<T>::Type operator*(typename vec4<T>::Type a, T s)
+inline dxHost dxDevice float4 operator*(float4 a, float s)
 {
-  return make_vec4(a.x * s, a.y * s, a.z * s, a.w * s);
+  return make_float4(a.x * s, a.y * s, a.z * s, a.w * s);
+}
+inline dxHost dxDevice double4 operator*(double4 a, double s)
+{
+  return make_double4(a.x * s, a.y * s, a.z * s, a.w * s);
 }
 inline dxHost dxDevice float4 operator*(float s, float4 a)
 {
@@ -44,7 +44,7 @@ namespace parallel_utils
 #define alignSize(offset,alignment)     (((offset) + (alignment) - 1) & ~ ((alignment) - 1))
 #define alignDefaultSize(offset)        alignSize(offset,ParallelOptions::DEFAULTALIGN)
 #define alignOffset(offset,alignment)   (offset) = alignSize(offset,alignment)
-#define align(offset)                   alignOffset(offset,ParallelOptions::DEFAULTALIGN)
+#define alignDefault(offset)            alignOffset(offset,ParallelOptions::DEFAULTALIGN)
 
 /////////////////////////////////////////////////////////////////////////
 
@@ -54,7 +54,7 @@ inline int __alignedSize( VectorType<int>& vectorToAlign )
   for( size_t i = 0; i < vectorToAlign.size(); i++ )
   {
     totalSize += vectorToAlign[i];
-    align(totalSize);
+    alignDefault(totalSize);
   }
   return totalSize;
 }
@@ -119,7 +119,9 @@ inline void permuteVector( VectorType<T>& vectorToPermute )
 {
   for( size_t i = 0; i < vectorToPermute.size(); i++ )
   {
-    size_t j = rand() % (i + 1);
+    // dRandInt draws from the seed of the world being stepped, rand()
+    // would interleave the sequences of worlds stepped in parallel
+    size_t j = dRandInt( static_cast<int>( i + 1 ) );
     T temp = vectorToPermute[ j ];
     vectorToPermute[ j ] = vectorToPermute[ i ];
     vectorToPermute[ i ] = temp;
@@ -14,6 +14,7 @@ int dWorldParallelQuickStep (dWorldID w, dReal stepsize)
 
   bool result = false;
 
+  dxRandSeedScope rand_scope(&w->rand_seed);
   if( dxReallocateParallelWorldProcessContext (w, stepsize, &dxEstimateParallelStepMemoryRequirements) ) {
     dxParallelProcessIslands (w, stepsize, &dxParallelQuickStepper);
     result = true;
@@ -1,11 +1,11 @@
-#include <ode/objects.h>
-#include <ode/ode.h>
-#include <ode/odemath.h>
-#include <ode/rotation.h>
-#include <ode/timer.h>
-#include <ode/error.h>
-#include <ode/matrix.h>
-#include <ode/misc.h>
+#include <gazebo/ode/objects.h>
+#include <gazebo/ode/ode.h>
+#include <gazebo/ode/odemath.h>
+#include <gazebo/ode/rotation.h>
+#include <gazebo/ode/timer.h>
+#include <gazebo/ode/error.h>
+#include <gazebo/ode/matrix.h>
+#include <gazebo/ode/misc.h>
 #include "objects.h"
 #include "config.h"
 #include "joints/joint.h"
@@ -32,7 +32,9 @@ typedef parallel_ode::OpenMPPGSSolver<dReal> SolverType;
 #endif
 
 #if PARALLEL_ENABLED
-static SolverType parallelSolver;
+// The solver only keeps buffers between steps, one per thread lets worlds
+// be stepped in parallel
+static thread_local SolverType parallelSolver;
 #endif
 
 typedef const dReal *dRealPtr;
@@ -577,6 +579,7 @@ void dxParallelQuickStepper( dxWorldProcessContext *context,
 
   if (m > 0) {
     dReal *cfm, *lo, *hi, *rhs, *Jcopy;
+    dReal *c_v_max;
     int *findex;
 
     {
@@ -592,6 +595,11 @@ void dxParallelQuickStepper( dxWorldProcessContext *context,
       cfm = context->AllocateArray<dReal> (mlocal);
       dSetValue (cfm,mlocal,world->global_cfm);
 
+      // init all to the world's maximum correcting velocity, contacts may
+      // lower it per row
+      c_v_max = context->AllocateArray<dReal> (mlocal);
+      dSetValue (c_v_max,mlocal,world->contactp.max_vel);
+
       lo = context->AllocateArray<dReal> (mlocal);
       dSetValue (lo,mlocal,-dInfinity);
 
@@ -646,6 +654,7 @@ void dxParallelQuickStepper( dxWorldProcessContext *context,
           Jinfo.J2a = Jrow + 9;
           Jinfo.c = c + ofsi;
           Jinfo.cfm = cfm + ofsi;
+          Jinfo.c_v_max = c_v_max + ofsi;
           Jinfo.lo = lo + ofsi;
           Jinfo.hi = hi + ofsi;
           Jinfo.findex = findex + ofsi;
@@ -718,8 +727,13 @@ void dxParallelQuickStepper( dxWorldProcessContext *context,
         multiply_J (m,J,jb,tmp1,rhs);
       } END_STATE_SAVE(context, tmp1state);
 
-      // complete rhs
-      for (int i=0; i<m; i++) rhs[i] = c[i]*stepsize1 - rhs[i];
+      // complete rhs, limiting the correcting velocity as quickstep does
+      for (int i=0; i<m; i++) {
+        if (dFabs(c[i]) > c_v_max[i])
+          rhs[i] = c_v_max[i]*stepsize1 - rhs[i];
+        else
+          rhs[i] = c[i]*stepsize1 - rhs[i];
+      }
 
       // scale CFM
       for (int j=0; j<m; j++) cfm[j] *= stepsize1;
@@ -918,7 +932,7 @@ size_t dxEstimateParallelStepMemoryRequirements (
     size_t sub1_res2 = dEFFICIENT_SIZE(sizeof(dJointWithInfo1) * nj); // for shrunk jointiinfos
     if (m > 0) {
       sub1_res2 += dEFFICIENT_SIZE(sizeof(dReal) * 12 * m); // for J
-      sub1_res2 += 4 * dEFFICIENT_SIZE(sizeof(dReal) * m); // for cfm, lo, hi, rhs
+      sub1_res2 += 5 * dEFFICIENT_SIZE(sizeof(dReal) * m); // for cfm, c_v_max, lo, hi, rhs
       sub1_res2 += dEFFICIENT_SIZE(sizeof(int) * 12 * m); // for jb            FIXME: shoulbe be 2 not 12?
       sub1_res2 += dEFFICIENT_SIZE(sizeof(int) * m); // for findex
       sub1_res2 += dEFFICIENT_SIZE(sizeof(dReal) * 12 * mfb); // for Jcopy
@@ -935,6 +949,8 @@ size_t dxEstimateParallelStepMemoryRequirements (
 
         size_t sub2_res2 = dEFFICIENT_SIZE(sizeof(dReal) * m); // for lambda
         sub2_res2 += dEFFICIENT_SIZE(sizeof(dReal) * 6 * nb); // for cforce
+        sub2_res2 += dEFFICIENT_SIZE(sizeof(dReal) * 12 * m); // for iMJ
+        sub2_res2 += dEFFICIENT_SIZE(sizeof(dReal) * m); // for Ad
         {
           size_t sub3_res1 = EstimateParallelSOR_LCPMemoryRequirements(m,nj); // for SOR_LCP
           size_t sub3_res2 = 0;
@@ -24,7 +24,9 @@
 
 #include <stdio.h>
 #include <signal.h>
+#include <algorithm>
 #include <mutex>
+#include <string>
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/lexical_cast.hpp>
@@ -169,6 +171,10 @@ bool Server::ParseArgs(int _argc, char **_argv)
     ("record_resources", "Recording with model meshes and materials.")
     ("seed",  po::value<double>(), "Start with a given random number seed.")
     ("iters",  po::value<unsigned int>(), "Number of iterations to simulate.")
+    ("worlds", po::value<unsigned int>(),
+     "Number of copies of the world to load. Each copy is named "
+     "<world>_<index> and steps in its own thread. Not supported with "
+     "--record.")
     ("minimal_comms", "Reduce the TCP/IP traffic output by gzserver")
     ("server-plugin,s", po::value<std::vector<std::string> >(),
      "Load a plugin.")
@@ -287,6 +293,25 @@ bool Server::ParseArgs(int _argc, char **_argv)
     }
   }
 
+  // LogRecord is a singleton that the first world to finish stops, so it
+  // can't record several worlds
+  if (this->dataPtr->vm.count("worlds") && this->dataPtr->vm.count("record"))
+  {
+    gzerr << "--worlds can't be combined with --record, log recording "
+          << "supports a single world\n";
+    return false;
+  }
+
+  if (this->dataPtr->vm.count("worlds") && this->dataPtr->vm.count("play"))
+  {
+    gzwarn << "Log playback loads a single world, ignoring --worlds\n";
+  }
+  else if (this->dataPtr->vm.count("worlds"))
+  {
+    this->dataPtr->params["worlds"] = boost::lexical_cast<std::string>(
+        this->dataPtr->vm["worlds"].as<unsigned int>());
+  }
+
   if (this->dataPtr->vm.count("lockstep"))
   {
     this->dataPtr->lockstep = true;
@@ -358,7 +383,8 @@ bool Server::ParseArgs(int _argc, char **_argv)
       std::string profileName = this->dataPtr->vm["profile"].as<std::string>();
       if (physics::get_world()->PresetMgr()->HasProfile(profileName))
       {
-        physics::get_world()->PresetMgr()->CurrentProfile(profileName);
+        for (auto const &world : physics::get_worlds())
+          world->PresetMgr()->CurrentProfile(profileName);
         gzmsg << "Setting physics profile to [" << profileName << "]."
               << std::endl;
       }
@@ -466,19 +492,38 @@ bool Server::LoadImpl(sdf::ElementPtr _elem,
     }
   }
 
+  unsigned int copies = 1;
+  common::StrStr_M::iterator piter = this->dataPtr->params.find("worlds");
+  if (piter != this->dataPtr->params.end())
+    copies = std::max(1u, boost::lexical_cast<unsigned int>(piter->second));
+
   sdf::ElementPtr worldElem = _elem->GetElement("world");
   if (worldElem)
   {
-    physics::WorldPtr world = physics::create_world();
-
-    // Create the world
-    try
-    {
-      physics::load_world(world, worldElem);
-    }
-    catch(common::Exception &e)
+    const std::string worldName = worldElem->Get<std::string>("name");
+    for (unsigned int i = 0; i < copies; ++i)
     {
-      gzthrow("Failed to load the World\n"  << e);
+      // Each copy gets its own SDF, since a world edits its description,
+      // and its own name, which namespaces its topics.
+      sdf::ElementPtr elem = worldElem;
+      if (copies > 1)
+      {
+        elem = worldElem->Clone();
+        elem->GetAttribute("name")->Set(
+            worldName + "_" + std::to_string(i));
+      }
+
+      physics::WorldPtr world = physics::create_world();
+
+      // Create the world
+      try
+      {
+        physics::load_world(world, elem);
+      }
+      catch(common::Exception &e)
+      {
+        gzthrow("Failed to load the World\n"  << e);
+      }
     }
   }
 
@@ -0,0 +1,226 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
+#include "gazebo/common/CallbackAccounting.hh"
+
+using namespace gazebo;
+using namespace event;
+
+namespace
+{
+  /// \brief Read the initial enabled state from the environment.
+  /// \return True if GAZEBO_CALLBACK_ACCOUNTING is set to a non-zero value.
+  bool EnabledFromEnv()
+  {
+    const char *env = std::getenv("GAZEBO_CALLBACK_ACCOUNTING");
+    return env && std::string(env) != "0" && std::string(env) != "";
+  }
+
+  /// \brief Whether accounting is enabled.
+  std::atomic<bool> g_enabled(EnabledFromEnv());
+
+  /// \brief Stats of all labels.
+  std::map<std::string, std::shared_ptr<CallbackStats>> g_stats;
+
+  /// \brief Protects g_stats.
+  std::mutex g_statsMutex;
+
+  /// \brief Owner of the connections made on this thread.
+  thread_local std::string t_owner;
+
+  /// \brief Nanoseconds to seconds.
+  const double kNsToSec = 1e-9;
+}
+
+/// \brief Private data for CallbackStats.
+class gazebo::event::CallbackStatsPrivate
+{
+  /// \brief Label of the callbacks.
+  public: std::string name;
+
+  /// \brief Ring buffer of the last execution times in nanoseconds.
+  public: std::array<std::atomic<uint64_t>, CallbackStats::WindowSize>
+          samples;
+
+  /// \brief Number of executions.
+  public: std::atomic<uint64_t> count{0};
+
+  /// \brief Longest execution time in nanoseconds.
+  public: std::atomic<uint64_t> max{0};
+
+  /// \brief Copy the samples in the rolling window.
+  /// \return Samples, in no particular order.
+  public: std::vector<uint64_t> Window() const
+  {
+    const uint64_t n = std::min<uint64_t>(
+        this->count.load(std::memory_order_relaxed), CallbackStats::WindowSize);
+    std::vector<uint64_t> result(n);
+    for (uint64_t i = 0; i < n; ++i)
+      result[i] = this->samples[i].load(std::memory_order_relaxed);
+    return result;
+  }
+};
+
+//////////////////////////////////////////////////
+CallbackStats::CallbackStats(const std::string &_name)
+  : dataPtr(new CallbackStatsPrivate)
+{
+  this->dataPtr->name = _name;
+  for (auto &sample : this->dataPtr->samples)
+    sample.store(0, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+CallbackStats::~CallbackStats()
+{
+}
+
+//////////////////////////////////////////////////
+void CallbackStats::Add(const uint64_t _ns)
+{
+  // Relaxed atomics are enough: readers only need each sample to be
+  // either the old or the new value.
+  const uint64_t index =
+    this->dataPtr->count.fetch_add(1, std::memory_order_relaxed);
+  this->dataPtr->samples[index % WindowSize].store(
+      _ns, std::memory_order_relaxed);
+
+  uint64_t max = this->dataPtr->max.load(std::memory_order_relaxed);
+  while (_ns > max && !this->dataPtr->max.compare_exchange_weak(
+        max, _ns, std::memory_order_relaxed))
+  {
+  }
+}
+
+//////////////////////////////////////////////////
+const std::string &CallbackStats::Name() const
+{
+  return this->dataPtr->name;
+}
+
+//////////////////////////////////////////////////
+uint64_t CallbackStats::Count() const
+{
+  return this->dataPtr->count.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+double CallbackStats::Mean() const
+{
+  const std::vector<uint64_t> window = this->dataPtr->Window();
+  if (window.empty())
+    return 0;
+
+  uint64_t sum = 0;
+  for (const uint64_t sample : window)
+    sum += sample;
+  return kNsToSec * static_cast<double>(sum) / window.size();
+}
+
+//////////////////////////////////////////////////
+double CallbackStats::Percentile(const double _p) const
+{
+  std::vector<uint64_t> window = this->dataPtr->Window();
+  if (window.empty())
+    return 0;
+
+  const double p = std::max(0.0, std::min(1.0, _p));
+  const size_t rank = std::min(window.size() - 1,
+      static_cast<size_t>(p * window.size()));
+  std::nth_element(window.begin(), window.begin() + rank, window.end());
+  return kNsToSec * window[rank];
+}
+
+//////////////////////////////////////////////////
+double CallbackStats::Max() const
+{
+  return kNsToSec * this->dataPtr->max.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+bool CallbackAccounting::Enabled()
+{
+  return g_enabled.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void CallbackAccounting::SetEnabled(const bool _enabled)
+{
+  g_enabled = _enabled;
+}
+
+//////////////////////////////////////////////////
+std::shared_ptr<CallbackStats> CallbackAccounting::Stats(
+    const std::string &_label)
+{
+  std::lock_guard<std::mutex> lock(g_statsMutex);
+  auto &stats = g_stats[_label];
+  if (!stats)
+    stats.reset(new CallbackStats(_label));
+  return stats;
+}
+
+//////////////////////////////////////////////////
+std::vector<std::shared_ptr<CallbackStats>> CallbackAccounting::AllStats()
+{
+  std::lock_guard<std::mutex> lock(g_statsMutex);
+  std::vector<std::shared_ptr<CallbackStats>> result;
+  result.reserve(g_stats.size());
+  for (auto const &stats : g_stats)
+    result.push_back(stats.second);
+  return result;
+}
+
+//////////////////////////////////////////////////
+const std::string &CallbackAccounting::Owner()
+{
+  return t_owner;
+}
+
+//////////////////////////////////////////////////
+void CallbackAccounting::PluginCall(const std::string &_owner,
+    const std::string &_function, const std::function<void()> &_call)
+{
+  if (!Enabled())
+  {
+    _call();
+    return;
+  }
+
+  std::shared_ptr<CallbackStats> stats = Stats(_owner + "/" + _function);
+  CallbackTimer timer(*stats);
+  _call();
+}
+
+//////////////////////////////////////////////////
+ScopedCallbackOwner::ScopedCallbackOwner(const std::string &_owner)
+  : previous(t_owner)
+{
+  t_owner = _owner;
+}
+
+//////////////////////////////////////////////////
+ScopedCallbackOwner::~ScopedCallbackOwner()
+{
+  t_owner = this->previous;
+}
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_COMMON_CALLBACKACCOUNTING_HH_
+#define GAZEBO_COMMON_CALLBACKACCOUNTING_HH_
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace event
+  {
+    /// \addtogroup gazebo_event
+    /// \{
+
+    class CallbackStatsPrivate;
+
+    /// \class CallbackStats CallbackAccounting.hh common/common.hh
+    /// \brief Execution time statistics of all the callbacks sharing a
+    /// label. The last samples are kept in a ring buffer, from which a
+    /// rolling mean and percentiles are computed on demand.
+    class GZ_COMMON_VISIBLE CallbackStats
+    {
+      /// \brief Number of samples kept in the rolling window.
+      public: static const unsigned int WindowSize = 1024;
+
+      /// \brief Constructor.
+      /// \param[in] _name Label of the callbacks.
+      public: explicit CallbackStats(const std::string &_name);
+
+      /// \brief Destructor.
+      public: ~CallbackStats();
+
+      /// \brief Record one callback execution. Safe to call from any
+      /// thread.
+      /// \param[in] _ns Execution time in nanoseconds.
+      public: void Add(const uint64_t _ns);
+
+      /// \brief Get the label of the callbacks.
+      /// \return The label.
+      public: const std::string &Name() const;
+
+      /// \brief Get the number of executions since the stats were created.
+      /// \return Number of executions.
+      public: uint64_t Count() const;
+
+      /// \brief Get the mean execution time over the rolling window.
+      /// \return Mean execution time in seconds.
+      public: double Mean() const;
+
+      /// \brief Get a percentile of the execution time over the rolling
+      /// window.
+      /// \param[in] _p Percentile in the range [0, 1], e.g. 0.99.
+      /// \return Execution time in seconds.
+      public: double Percentile(const double _p) const;
+
+      /// \brief Get the longest execution time since the stats were
+      /// created.
+      /// \return Execution time in seconds.
+      public: double Max() const;
+
+      /// \internal
+      /// \brief Private data pointer.
+      private: std::unique_ptr<CallbackStatsPrivate> dataPtr;
+    };
+
+    /// \class CallbackAccounting CallbackAccounting.hh common/common.hh
+    /// \brief Attributes CPU time to event callbacks.
+    ///
+    /// When enabled, every callback connected to a named event, or
+    /// connected while a plugin is loading, is wrapped with a timer that
+    /// feeds a CallbackStats instance. Accounting is disabled by default,
+    /// in which case callbacks are not wrapped and cost nothing extra. It
+    /// can be enabled by setting the GAZEBO_CALLBACK_ACCOUNTING environment
+    /// variable to 1, or with SetEnabled. Only connections made while
+    /// enabled are accounted for.
+    class GZ_COMMON_VISIBLE CallbackAccounting
+    {
+      /// \brief Get whether accounting is enabled.
+      /// \return True if enabled.
+      public: static bool Enabled();
+
+      /// \brief Enable or disable accounting for new connections.
+      /// \param[in] _enabled True to enable.
+      public: static void SetEnabled(const bool _enabled);
+
+      /// \brief Get the stats of a label, creating them if needed.
+      /// \param[in] _label Label of the callbacks.
+      /// \return Stats of the label.
+      public: static std::shared_ptr<CallbackStats> Stats(
+                  const std::string &_label);
+
+      /// \brief Get the stats of all labels.
+      /// \return Stats sorted by label.
+      public: static std::vector<std::shared_ptr<CallbackStats>> AllStats();
+
+      /// \brief Get the owner of the connections made on this thread, set
+      /// by ScopedCallbackOwner.
+      /// \return Owner label, empty if none.
+      public: static const std::string &Owner();
+
+      /// \brief Call a function of a plugin, such as Load or Init. If
+      /// accounting is enabled, its duration is added to the stats of the
+      /// label "<owner>/<function>", also when it throws.
+      /// \param[in] _owner Owner label of the plugin, e.g.
+      /// "model/box/my_plugin".
+      /// \param[in] _function Name of the function, e.g. "Load".
+      /// \param[in] _call Calls the function.
+      public: static void PluginCall(const std::string &_owner,
+                  const std::string &_function,
+                  const std::function<void()> &_call);
+    };
+
+    /// \class ScopedCallbackOwner CallbackAccounting.hh common/common.hh
+    /// \brief Attributes the connections made on the current thread to an
+    /// owner, such as a plugin instance, for the lifetime of the object.
+    class GZ_COMMON_VISIBLE ScopedCallbackOwner
+    {
+      /// \brief Constructor.
+      /// \param[in] _owner Owner label, e.g. "model/box/my_plugin".
+      public: explicit ScopedCallbackOwner(const std::string &_owner);
+
+      /// \brief Destructor. Restores the previous owner.
+      public: ~ScopedCallbackOwner();
+
+      /// \brief Owner active before this one.
+      private: std::string previous;
+    };
+
+    /// \brief Measures the time until it goes out of scope and adds it to
+    /// a CallbackStats instance.
+    class CallbackTimer
+    {
+      /// \brief Constructor.
+      /// \param[in] _stats Stats to add the measured time to.
+      public: explicit CallbackTimer(CallbackStats &_stats)
+              : stats(_stats), start(std::chrono::steady_clock::now())
+      {
+      }
+
+      /// \brief Destructor.
+      public: ~CallbackTimer()
+      {
+        this->stats.Add(std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now() - this->start).count());
+      }
+
+      /// \brief Stats to add the measured time to.
+      private: CallbackStats &stats;
+
+      /// \brief Start time.
+      private: std::chrono::steady_clock::time_point start;
+    };
+
+    /// \brief Wraps callbacks of a given signature with a CallbackTimer.
+    template<typename T>
+    class AccountedCallback;
+
+    /// \brief Wraps callbacks of a given signature with a CallbackTimer.
+    template<typename R, typename... Args>
+    class AccountedCallback<R(Args...)>
+    {
+      /// \brief Wrap a callback.
+      /// \param[in] _callback Callback to wrap.
+      /// \param[in] _stats Stats the callback is accounted to.
+      /// \return Wrapped callback.
+      public: static std::function<R(Args...)> Wrap(
+                  const std::function<R(Args...)> &_callback,
+                  std::shared_ptr<CallbackStats> _stats)
+      {
+        return [_callback, _stats](Args... _args) -> R
+        {
+          CallbackTimer timer(*_stats);
+          return _callback(std::forward<Args>(_args)...);
+        };
+      }
+    };
+    /// \}
+  }
+}
+#endif
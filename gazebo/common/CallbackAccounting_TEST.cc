@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <gazebo/common/CallbackAccounting.hh>
+#include <gazebo/common/Event.hh>
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class CallbackAccountingTest : public gazebo::testing::AutoLogFixture { };
+
+/////////////////////////////////////////////////
+TEST_F(CallbackAccountingTest, Stats)
+{
+  event::CallbackStats stats("test");
+  EXPECT_EQ(stats.Name(), "test");
+  EXPECT_EQ(stats.Count(), 0u);
+  EXPECT_DOUBLE_EQ(stats.Mean(), 0.0);
+  EXPECT_DOUBLE_EQ(stats.Percentile(0.99), 0.0);
+
+  // 1..100 microseconds
+  for (uint64_t i = 1; i <= 100; ++i)
+    stats.Add(i * 1000);
+
+  EXPECT_EQ(stats.Count(), 100u);
+  EXPECT_NEAR(stats.Mean(), 50.5e-6, 1e-12);
+  EXPECT_NEAR(stats.Percentile(0.99), 100e-6, 1e-12);
+  EXPECT_NEAR(stats.Percentile(0.5), 51e-6, 1e-12);
+  EXPECT_NEAR(stats.Max(), 100e-6, 1e-12);
+
+  // Fill the window with a constant, the max is kept
+  for (unsigned int i = 0; i < event::CallbackStats::WindowSize; ++i)
+    stats.Add(2000);
+  EXPECT_NEAR(stats.Mean(), 2e-6, 1e-12);
+  EXPECT_NEAR(stats.Percentile(0.99), 2e-6, 1e-12);
+  EXPECT_NEAR(stats.Max(), 100e-6, 1e-12);
+}
+
+/////////////////////////////////////////////////
+TEST_F(CallbackAccountingTest, Owner)
+{
+  EXPECT_TRUE(event::CallbackAccounting::Owner().empty());
+  {
+    event::ScopedCallbackOwner outer("world/outer");
+    EXPECT_EQ(event::CallbackAccounting::Owner(), "world/outer");
+    {
+      event::ScopedCallbackOwner inner("model/box/inner");
+      EXPECT_EQ(event::CallbackAccounting::Owner(), "model/box/inner");
+    }
+    EXPECT_EQ(event::CallbackAccounting::Owner(), "world/outer");
+  }
+  EXPECT_TRUE(event::CallbackAccounting::Owner().empty());
+}
+
+/////////////////////////////////////////////////
+TEST_F(CallbackAccountingTest, PluginCall)
+{
+  auto hasStats = [](const std::string &_label)
+  {
+    for (auto const &stats : event::CallbackAccounting::AllStats())
+    {
+      if (stats->Name() == _label)
+        return true;
+    }
+    return false;
+  };
+
+  // Disabled, the function is called without stats
+  event::CallbackAccounting::SetEnabled(false);
+  int calls = 0;
+  event::CallbackAccounting::PluginCall("system/disabled", "Load",
+      [&calls] { ++calls; });
+  EXPECT_EQ(calls, 1);
+  EXPECT_FALSE(hasStats("system/disabled/Load"));
+
+  event::CallbackAccounting::SetEnabled(true);
+  for (const std::string kind : {"world", "model", "sensor", "visual",
+      "system"})
+  {
+    const std::string owner = kind + "/scope/plugin";
+    event::CallbackAccounting::PluginCall(owner, "Load",
+        [&calls] { ++calls; });
+    event::CallbackAccounting::PluginCall(owner, "Init",
+        [&calls] { ++calls; });
+    EXPECT_EQ(event::CallbackAccounting::Stats(owner + "/Load")->Count(), 1u);
+    EXPECT_EQ(event::CallbackAccounting::Stats(owner + "/Init")->Count(), 1u);
+  }
+  EXPECT_EQ(calls, 11);
+
+  // A throwing function is accounted for, and the exception passed on
+  EXPECT_THROW(event::CallbackAccounting::PluginCall("model/box/throws",
+      "Load", [] { throw std::runtime_error("load failed"); }),
+      std::runtime_error);
+  EXPECT_EQ(
+      event::CallbackAccounting::Stats("model/box/throws/Load")->Count(), 1u);
+  event::CallbackAccounting::SetEnabled(false);
+}
+
+/////////////////////////////////////////////////
+TEST_F(CallbackAccountingTest, EventConnections)
+{
+  event::EventT<void (int)> named("named");
+  event::EventT<void (int)> unnamed;
+  int sum = 0;
+  auto cb = [&sum](int _v) { sum += _v; };
+
+  // Disabled: nothing is accounted
+  event::CallbackAccounting::SetEnabled(false);
+  event::ConnectionPtr c1 = named.Connect(cb);
+  named(1);
+  EXPECT_EQ(sum, 1);
+  EXPECT_EQ(event::CallbackAccounting::Stats("core/named")->Count(), 0u);
+
+  event::CallbackAccounting::SetEnabled(true);
+
+  // Named event without owner
+  event::ConnectionPtr c2 = named.Connect(cb);
+  named(1);
+  EXPECT_EQ(sum, 3);
+  EXPECT_EQ(event::CallbackAccounting::Stats("core/named")->Count(), 1u);
+
+  // Unnamed event without owner is not wrapped
+  event::ConnectionPtr c3 = unnamed.Connect(cb);
+
+  // Connections made by a plugin are accounted to it
+  event::ConnectionPtr c4, c5;
+  {
+    event::ScopedCallbackOwner owner("model/box/plugin");
+    c4 = named.Connect(cb);
+    c5 = unnamed.Connect(cb);
+  }
+  named(1);
+  unnamed(1);
+  EXPECT_EQ(sum, 8);
+  EXPECT_EQ(event::CallbackAccounting::Stats("core/named")->Count(), 2u);
+  EXPECT_EQ(
+      event::CallbackAccounting::Stats("model/box/plugin/named")->Count(), 1u);
+  EXPECT_EQ(
+      event::CallbackAccounting::Stats("model/box/plugin/event")->Count(), 1u);
+
+  bool found = false;
+  for (auto const &stats : event::CallbackAccounting::AllStats())
+    found = found || stats->Name() == "model/box/plugin/named";
+  EXPECT_TRUE(found);
+
+  event::CallbackAccounting::SetEnabled(false);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
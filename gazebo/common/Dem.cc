@@ -49,8 +49,6 @@ Dem::Dem()
 //////////////////////////////////////////////////
 Dem::~Dem()
 {
-  this->dataPtr->demData.clear();
-
   if (this->dataPtr->dataSet)
     GDALClose(reinterpret_cast<GDALDataset *>(this->dataPtr->dataSet));
 
@@ -139,9 +137,24 @@ int Dem::Load(const std::string &_filename)
 
   this->dataPtr->side = std::max(width, height);
 
-  // Preload the DEM's data
-  if (this->LoadData() != 0)
-    return -1;
+  // Scale the terrain keeping the same ratio between width and height
+  float ratio;
+  if (xSize > ySize)
+  {
+    ratio = static_cast<float>(xSize) / static_cast<float>(ySize);
+    this->dataPtr->destWidth = this->dataPtr->side;
+    // The decimal part is discarted for interpret the result as pixels
+    this->dataPtr->destHeight =
+        static_cast<float>(this->dataPtr->destWidth) / ratio;
+  }
+  else
+  {
+    ratio = static_cast<float>(ySize) / static_cast<float>(xSize);
+    this->dataPtr->destHeight = this->dataPtr->side;
+    // The decimal part is discarted for interpret the result as pixels
+    this->dataPtr->destWidth =
+        static_cast<float>(this->dataPtr->destHeight) / ratio;
+  }
 
   // Check for nodata value in dem data. This is used when computing the
   // min elevation. If nodata value is not defined, we assume it will be one
@@ -154,14 +167,24 @@ int Dem::Load(const std::string &_filename)
   if (validNoData <= 0)
     noDataValue = defaultNoDataValue;
 
+  // The raster is scanned in bands of rows, so it is never held in memory
+  // as a whole
   double min = ignition::math::MAX_D;
   double max = -ignition::math::MAX_D;
-  for (auto d : this->dataPtr->demData)
+  const unsigned int bandRows = 256;
+  std::vector<float> rows;
+  for (unsigned int y = 0; y < this->dataPtr->side; y += bandRows)
   {
-    if (d < min && d > noDataValue)
-      min = d;
-    if (d > max && d > noDataValue)
-      max = d;
+    if (this->ReadRows(y, bandRows, rows) != 0)
+      return -1;
+
+    for (auto d : rows)
+    {
+      if (d < min && d > noDataValue)
+        min = d;
+      if (d > max && d > noDataValue)
+        max = d;
+    }
   }
   if (ignition::math::equal(min, ignition::math::MAX_D) ||
       ignition::math::equal(max, -ignition::math::MAX_D))
@@ -183,7 +206,11 @@ double Dem::GetElevation(double _x, double _y)
            " x " << this->GetHeight() << "]\n");
   }
 
-  return this->dataPtr->demData.at(_y * this->GetWidth() + _x);
+  std::vector<float> row;
+  if (this->ReadRows(static_cast<unsigned int>(_y), 1, row) != 0)
+    return 0.0;
+
+  return row.at(static_cast<unsigned int>(_x));
 }
 
 //////////////////////////////////////////////////
@@ -265,6 +292,17 @@ void Dem::FillHeightMap(int _subSampling, unsigned int _vertSize,
     const ignition::math::Vector3d &_size,
     const ignition::math::Vector3d &_scale,
     bool _flipY, std::vector<float> &_heights)
+{
+  this->FillHeightMapRows(_subSampling, _vertSize, _size, _scale, _flipY,
+      0, _vertSize, _heights);
+}
+
+//////////////////////////////////////////////////
+void Dem::FillHeightMapRows(int _subSampling, unsigned int _vertSize,
+    const ignition::math::Vector3d &_size,
+    const ignition::math::Vector3d &_scale, bool _flipY,
+    unsigned int _firstRow, unsigned int _rowCount,
+    std::vector<float> &_heights)
 {
   if (_subSampling <= 0)
   {
@@ -272,34 +310,63 @@ void Dem::FillHeightMap(int _subSampling, unsigned int _vertSize,
     return;
   }
 
+  _rowCount = std::min(_rowCount, _vertSize - std::min(_firstRow, _vertSize));
+
   // Resize the vector to match the size of the vertices.
-  _heights.resize(_vertSize * _vertSize);
+  _heights.resize(_rowCount * _vertSize);
+  if (_rowCount == 0)
+    return;
 
-  // Iterate over all the vertices
-  for (unsigned int y = 0; y < _vertSize; ++y)
+  // Vertices stored in the requested rows
+  unsigned int yMin = _firstRow;
+  unsigned int yMax = _firstRow + _rowCount - 1;
+  if (_flipY)
   {
+    yMin = _vertSize - yMax - 1;
+    yMax = _vertSize - _firstRow - 1;
+  }
+
+  // Read only the raster rows those vertices are interpolated from
+  const unsigned int side = this->dataPtr->side;
+  const unsigned int firstDataRow = yMin / _subSampling;
+  const unsigned int lastDataRow = std::min(side - 1, static_cast<unsigned int>(
+      ceil(yMax / static_cast<double>(_subSampling))));
+  std::vector<float> data;
+  if (this->ReadRows(firstDataRow, lastDataRow - firstDataRow + 1, data) != 0)
+    return;
+
+  // Iterate over the vertices of the requested rows
+  for (unsigned int row = 0; row < _rowCount; ++row)
+  {
+    // Row of the lookup table, and the vertex it stores
+    unsigned int y = _firstRow + row;
+    if (_flipY)
+      y = _vertSize - y - 1;
+
     double yf = y / static_cast<double>(_subSampling);
     unsigned int y1 = floor(yf);
     unsigned int y2 = ceil(yf);
-    if (y2 >= this->dataPtr->side)
-      y2 = this->dataPtr->side - 1;
+    if (y2 >= side)
+      y2 = side - 1;
     double dy = yf - y1;
+    y1 -= firstDataRow;
+    y2 -= firstDataRow;
 
     for (unsigned int x = 0; x < _vertSize; ++x)
     {
       double xf = x / static_cast<double>(_subSampling);
       unsigned int x1 = floor(xf);
       unsigned int x2 = ceil(xf);
-      if (x2 >= this->dataPtr->side)
-        x2 = this->dataPtr->side - 1;
+      if (x2 >= side)
+        x2 = side - 1;
       double dx = xf - x1;
 
-      double px1 = this->dataPtr->demData[y1 * this->dataPtr->side + x1];
-      double px2 = this->dataPtr->demData[y1 * this->dataPtr->side + x2];
+      double px1 = data[y1 * side + x1];
+      double px2 = data[y1 * side + x2];
       float h1 = (px1 - ((px1 - px2) * dx));
 
-      double px3 = this->dataPtr->demData[y2 * this->dataPtr->side + x1];
-      double px4 = this->dataPtr->demData[y2 * this->dataPtr->side + x2];
+      double px3 = data[y2 * side + x1];
+      double px4 = data[y2 * side + x2];
       float h2 = (px3 - ((px3 - px4) * dx));
 
       float h = this->dataPtr->minElevation +
@@ -316,69 +383,88 @@ void Dem::FillHeightMap(int _subSampling, unsigned int _vertSize,
         h = this->dataPtr->minElevation;
 
       // Store the height for future use
-      if (!_flipY)
-        _heights[y * _vertSize + x] = h;
-      else
-        _heights[(_vertSize - y - 1) * _vertSize + x] = h;
+      _heights[row * _vertSize + x] = h;
     }
   }
 }
 
 //////////////////////////////////////////////////
-int Dem::LoadData()
+int Dem::ReadRows(unsigned int _firstRow, unsigned int _rowCount,
+    std::vector<float> &_rows) const
 {
-    unsigned int destWidth;
-    unsigned int destHeight;
-    unsigned int nXSize = this->dataPtr->dataSet->GetRasterXSize();
-    unsigned int nYSize = this->dataPtr->dataSet->GetRasterYSize();
-    float ratio;
-    std::vector<float> buffer;
-
-    if (nXSize == 0 || nYSize == 0)
-    {
-      gzerr << "Illegal size loading a DEM file (" << nXSize << ","
-            << nYSize << ")\n";
-      return -1;
-    }
+  const unsigned int side = this->dataPtr->side;
+  const unsigned int destWidth = this->dataPtr->destWidth;
+  const unsigned int destHeight = this->dataPtr->destHeight;
+  const unsigned int nXSize = this->dataPtr->dataSet->GetRasterXSize();
+  const unsigned int nYSize = this->dataPtr->dataSet->GetRasterYSize();
 
-    // Scale the terrain keeping the same ratio between width and height
-    if (nXSize > nYSize)
-    {
-      ratio = static_cast<float>(nXSize) / static_cast<float>(nYSize);
-      destWidth = this->dataPtr->side;
-      // The decimal part is discarted for interpret the result as pixels
-      destHeight = static_cast<float>(destWidth) / static_cast<float>(ratio);
-    }
-    else
-    {
-      ratio = static_cast<float>(nYSize) / static_cast<float>(nXSize);
-      destHeight = this->dataPtr->side;
-      // The decimal part is discarted for interpret the result as pixels
-      destWidth = static_cast<float>(destHeight) / static_cast<float>(ratio);
-    }
+  if (nXSize == 0 || nYSize == 0 || destWidth == 0 || destHeight == 0)
+  {
+    gzerr << "Illegal size loading a DEM file (" << nXSize << ","
+          << nYSize << ")\n";
+    return -1;
+  }
+
+  _rowCount = std::min(_rowCount, side - std::min(_firstRow, side));
+
+  // All the points not contained in the raster are extra padding, set to 0
+  _rows.assign(_rowCount * side, 0.0f);
+
+  // Rows of the scaled raster, the remaining rows are padding
+  const unsigned int rasterRows =
+      std::min(_firstRow + _rowCount, destHeight) -
+      std::min(_firstRow, destHeight);
+  if (rasterRows == 0)
+    return 0;
 
-    // Read the whole raster data and convert it to a GDT_Float32 array.
-    // In this step the DEM is scaled to destWidth x destHeight
-    buffer.resize(destWidth * destHeight);
-    if (this->dataPtr->band->RasterIO(GF_Read, 0, 0, nXSize, nYSize, &buffer[0],
-                         destWidth, destHeight, GDT_Float32, 0, 0) != CE_None)
+#if GDAL_VERSION_MAJOR < 2
+  // Read the whole raster once, scaled to destWidth x destHeight and
+  // converted to GDT_Float32
+  std::vector<float> &demData = this->dataPtr->demData;
+  if (demData.empty())
+  {
+    demData.resize(destWidth * destHeight);
+    if (this->dataPtr->band->RasterIO(GF_Read, 0, 0, nXSize, nYSize,
+          &demData[0], destWidth, destHeight, GDT_Float32, 0, 0) != CE_None)
     {
       gzerr << "Failure calling RasterIO while loading a DEM file\n";
+      demData.clear();
       return -1;
     }
+  }
 
-    // Copy and align 'buffer' into the target vector. The destination vector is
-    // initialized to 0, so all the points not contained in 'buffer' will be
-    // extra padding
-    this->dataPtr->demData.resize(this->GetWidth() * this->GetHeight());
-    for (unsigned int y = 0; y < destHeight; ++y)
-    {
-        std::copy(&buffer[destWidth * y], &buffer[destWidth * y] + destWidth,
-                  this->dataPtr->demData.begin() + this->GetWidth() * y);
-    }
-    buffer.clear();
+  for (unsigned int y = 0; y < rasterRows; ++y)
+  {
+    const float *row = &demData[destWidth * (_firstRow + y)];
+    std::copy(row, row + destWidth, _rows.begin() + side * y);
+  }
+#else
+  // Read the raster window covering the rows, scaled to destWidth columns
+  // and converted to GDT_Float32. The floating point window samples the
+  // same source pixels as a read of the whole raster.
+  const double rowScale = nYSize / static_cast<double>(destHeight);
+  GDALRasterIOExtraArg extraArg;
+  INIT_RASTERIO_EXTRA_ARG(extraArg);
+  extraArg.bFloatingPointWindowValidity = TRUE;
+  extraArg.dfXOff = 0;
+  extraArg.dfYOff = _firstRow * rowScale;
+  extraArg.dfXSize = nXSize;
+  extraArg.dfYSize = rasterRows * rowScale;
+
+  const unsigned int yOff = static_cast<unsigned int>(extraArg.dfYOff);
+  const unsigned int yEnd = std::min(nYSize, static_cast<unsigned int>(
+      ceil(extraArg.dfYOff + extraArg.dfYSize)));
+
+  if (this->dataPtr->band->RasterIO(GF_Read, 0, yOff, nXSize, yEnd - yOff,
+        &_rows[0], destWidth, rasterRows, GDT_Float32, 0,
+        sizeof(float) * side, &extraArg) != CE_None)
+  {
+    gzerr << "Failure calling RasterIO while loading a DEM file\n";
+    return -1;
+  }
+#endif
 
-    return 0;
+  return 0;
 }
 
 #endif
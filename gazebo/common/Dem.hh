@@ -118,6 +118,26 @@ namespace gazebo
                   const bool _flipY,
                   std::vector<float> &_heights);
 
+      /// \brief Fill a range of rows of the lookup table created by
+      /// FillHeightMap, reading only the raster window they cover. Called by
+      /// HeightmapData::FillHeightMapRows.
+      /// \param[in] _subsampling Multiplier used to increase the resolution.
+      /// \param[in] _vertSize Number of points per row.
+      /// \param[in] _size Real dimmensions of the terrain.
+      /// \param[in] _scale Vector3 used to scale the height.
+      /// \param[in] _flipY If true, it inverts the order in which the vector
+      /// is filled.
+      /// \param[in] _firstRow First row of the lookup table to fill.
+      /// \param[in] _rowCount Number of rows to fill.
+      /// \param[out] _heights _rowCount rows of _vertSize heights each.
+      public: void FillHeightMapRows(int _subSampling,
+                  unsigned int _vertSize,
+                  const ignition::math::Vector3d &_size,
+                  const ignition::math::Vector3d &_scale,
+                  bool _flipY, unsigned int _firstRow,
+                  unsigned int _rowCount,
+                  std::vector<float> &_heights);
+
       /// \brief Get the georeferenced coordinates (lat, long) of a terrain's
       /// pixel in WGS84.
       /// \param[in] _x X coordinate of the terrain.
@@ -128,11 +148,17 @@ namespace gazebo
                                     ignition::math::Angle &_latitude,
                                     ignition::math::Angle &_longitude) const;
 
-      /// \brief Get the terrain file as a data array. Due to the Ogre
-      /// constrains, the data might be stored in a bigger vector representing
-      /// a squared terrain with padding.
-      /// \return 0 when the operation succeeds to open a file.
-      private: int LoadData();
+      /// \brief Read rows of the terrain file as a data array. Due to the
+      /// Ogre constrains, the data is read as part of a bigger array
+      /// representing a squared terrain with padding. Only the raster
+      /// window covering the rows is read, so large files are never held in
+      /// memory as a whole.
+      /// \param[in] _firstRow First row of the squared terrain.
+      /// \param[in] _rowCount Number of rows.
+      /// \param[out] _rows Rows of GetWidth() elevations each.
+      /// \return 0 when the operation succeeds to read the file.
+      private: int ReadRows(unsigned int _firstRow, unsigned int _rowCount,
+                           std::vector<float> &_rows) const;
 
       /// internal
       /// \brief Pointer to the private data.
@@ -57,8 +57,20 @@ namespace gazebo
       /// \brief Maximum elevation in meters.
       public: double maxElevation;
 
-      /// \brief DEM data converted to be OGRE-compatible.
+      /// \brief Width of the raster scaled to the terrain's side, the
+      /// remaining columns are padding.
+      public: unsigned int destWidth = 0;
+
+      /// \brief Height of the raster scaled to the terrain's side, the
+      /// remaining rows are padding.
+      public: unsigned int destHeight = 0;
+
+#if GDAL_VERSION_MAJOR < 2
+      /// \brief The raster scaled to destWidth x destHeight. GDAL 1 can't
+      /// read a window with floating point bounds, so the raster is read
+      /// whole on first use.
       public: std::vector<float> demData;
+#endif
     };
     /// \}
   }
@@ -15,12 +15,21 @@
  *
  */
 
+#include <string>
+
 #include "gazebo/common/Console.hh"
 #include "gazebo/common/Event.hh"
 
 using namespace gazebo;
 using namespace event;
 
+namespace
+{
+  /// \brief World of the connections made and the events signaled on this
+  /// thread.
+  thread_local std::string t_world;
+}
+
 //////////////////////////////////////////////////
 Event::Event()
   : signaled(false)
@@ -75,3 +84,22 @@ int Connection::Id() const
 {
   return this->id;
 }
+
+//////////////////////////////////////////////////
+ScopedEventWorld::ScopedEventWorld(const std::string &_world)
+  : previous(t_world)
+{
+  t_world = _world;
+}
+
+//////////////////////////////////////////////////
+ScopedEventWorld::~ScopedEventWorld()
+{
+  t_world = this->previous;
+}
+
+//////////////////////////////////////////////////
+const std::string &ScopedEventWorld::Current()
+{
+  return t_world;
+}
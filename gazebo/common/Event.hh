@@ -17,14 +17,16 @@
 #ifndef GAZEBO_COMMON_EVENT_HH_
 #define GAZEBO_COMMON_EVENT_HH_
 
+#include <algorithm>
 #include <atomic>
 #include <functional>
-#include <list>
-#include <map>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <vector>
 
 #include "gazebo/gazebo_config.h"
+#include "gazebo/common/CallbackAccounting.hh"
 #include "gazebo/common/Time.hh"
 #include "gazebo/common/CommonTypes.hh"
 #include "gazebo/util/system.hh"
@@ -66,6 +68,32 @@ namespace gazebo
       private: bool signaled;
     };
 
+    /// \class ScopedEventWorld Event.hh common/common.hh
+    /// \brief Ties the connections made, and the events signaled, on the
+    /// current thread to a world for the lifetime of the object.
+    ///
+    /// A callback connected under a world is only called by signals emitted
+    /// under the same world, or under no world. Callbacks connected under no
+    /// world are called by every signal. This keeps apart the plugins of
+    /// worlds stepped in the same process, which share the events of
+    /// event::Events.
+    class GZ_COMMON_VISIBLE ScopedEventWorld
+    {
+      /// \brief Constructor.
+      /// \param[in] _world Name of the world.
+      public: explicit ScopedEventWorld(const std::string &_world);
+
+      /// \brief Destructor. Restores the previous world.
+      public: ~ScopedEventWorld();
+
+      /// \brief Get the world of the current thread.
+      /// \return Name of the world, empty if none.
+      public: static const std::string &Current();
+
+      /// \brief World active before this one.
+      private: std::string previous;
+    };
+
     /// \brief A class that encapsulates a connection.
     class GZ_COMMON_VISIBLE Connection
     {
@@ -101,6 +129,11 @@ namespace gazebo
       /// \brief Constructor.
       public: EventT();
 
+      /// \brief Constructor.
+      /// \param[in] _name Name of the event, used to label the callbacks
+      /// connected to it when callback accounting is enabled.
+      public: explicit EventT(const std::string &_name);
+
       /// \brief Destructor.
       public: virtual ~EventT();
 
@@ -272,15 +305,15 @@ namespace gazebo
       {
         IGN_PROFILE("Event::Signal");
 
-        this->Cleanup();
-
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback0");
-            iter.second->callback();
+            conn->callback();
             IGN_PROFILE_END();
           }
         }
@@ -293,15 +326,15 @@ namespace gazebo
       {
         IGN_PROFILE("Event::Signal");
 
-        this->Cleanup();
-
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback1");
-            iter.second->callback(_p);
+            conn->callback(_p);
             IGN_PROFILE_END();
           }
         }
@@ -315,15 +348,15 @@ namespace gazebo
       {
         IGN_PROFILE("Event::Signal");
 
-        this->Cleanup();
-
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback2");
-            iter.second->callback(_p1, _p2);
+            conn->callback(_p1, _p2);
             IGN_PROFILE_END();
           }
         }
@@ -338,15 +371,15 @@ namespace gazebo
       {
         IGN_PROFILE("Event::Signal");
 
-        this->Cleanup();
-
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback3");
-            iter.second->callback(_p1, _p2, _p3);
+            conn->callback(_p1, _p2, _p3);
             IGN_PROFILE_END();
           }
         }
@@ -363,15 +396,15 @@ namespace gazebo
       {
         IGN_PROFILE("Event::Signal");
 
-        this->Cleanup();
-
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback4");
-            iter.second->callback(_p1, _p2, _p3, _p4);
+            conn->callback(_p1, _p2, _p3, _p4);
             IGN_PROFILE_END();
           }
         }
@@ -390,15 +423,15 @@ namespace gazebo
       {
         IGN_PROFILE("Event::Signal");
 
-        this->Cleanup();
-
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback5");
-            iter.second->callback(_p1, _p2, _p3, _p4, _p5);
+            conn->callback(_p1, _p2, _p3, _p4, _p5);
             IGN_PROFILE_END();
           }
         }
@@ -418,15 +451,15 @@ namespace gazebo
       {
         IGN_PROFILE("Event::Signal");
 
-        this->Cleanup();
-
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback6");
-            iter.second->callback(_p1, _p2, _p3, _p4, _p5, _p6);
+            conn->callback(_p1, _p2, _p3, _p4, _p5, _p6);
             IGN_PROFILE_END();
           }
         }
@@ -447,15 +480,15 @@ namespace gazebo
       {
         IGN_PROFILE("Event::Signal");
 
-        this->Cleanup();
-
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback7");
-            iter.second->callback(_p1, _p2, _p3, _p4, _p5, _p6, _p7);
+            conn->callback(_p1, _p2, _p3, _p4, _p5, _p6, _p7);
             IGN_PROFILE_END();
           }
         }
@@ -478,15 +511,15 @@ namespace gazebo
       {
         IGN_PROFILE("Event::Signal");
 
-        this->Cleanup();
-
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback8");
-            iter.second->callback(_p1, _p2, _p3, _p4, _p5, _p6, _p7, _p8);
+            conn->callback(_p1, _p2, _p3, _p4, _p5, _p6, _p7, _p8);
             IGN_PROFILE_END();
           }
         }
@@ -511,15 +544,15 @@ namespace gazebo
       {
         IGN_PROFILE("Event::Signal");
 
-        this->Cleanup();
-
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback9");
-            iter.second->callback(
+            conn->callback(
                 _p1, _p2, _p3, _p4, _p5, _p6, _p7, _p8, _p9);
             IGN_PROFILE_END();
           }
@@ -544,66 +577,133 @@ namespace gazebo
                   const P4 &_p4, const P5 &_p5, const P6 &_p6, const P7 &_p7,
                   const P8 &_p8, const P9 &_p9, const P10 &_p10)
       {
-        this->Cleanup();
+        IGN_PROFILE("Event::Signal");
 
         this->SetSignaled(true);
-        for (const auto &iter: this->connections)
+        SignalGuard guard(*this);
+        const std::string &world = ScopedEventWorld::Current();
+        for (const auto &conn : *guard.subscribers)
         {
-          IGN_PROFILE("Event::Signal");
-
-          if (iter.second->on)
+          if (conn->on && conn->Reaches(world))
           {
             IGN_PROFILE_BEGIN("callback10");
-            iter.second->callback(
+            conn->callback(
                 _p1, _p2, _p3, _p4, _p5, _p6, _p7, _p8, _p9, _p10);
             IGN_PROFILE_END();
           }
         }
       }
 
-      /// \internal
-      /// \brief Removes queued connections.
-      /// We assume that this function is called from a Signal function.
-      private: void Cleanup();
-
       /// \brief A private helper class used in maintaining connections.
       private: class EventConnection
       {
         /// \brief Constructor
-        public: EventConnection(const bool _on, const std::function<T> &_cb)
-                : callback(_cb)
+        /// \param[in] _on Initial on/off value.
+        /// \param[in] _cb Callback function.
+        /// \param[in] _id Unique id of the connection.
+        public: EventConnection(const bool _on, const std::function<T> &_cb,
+                    const int _id)
+                : callback(_cb), id(_id), world(ScopedEventWorld::Current())
         {
           // Windows Visual Studio 2012 does not have atomic_bool constructor,
           // so we have to set "on" using operator=
           this->on = _on;
         }
 
+        /// \brief Get whether a signal emitted under a world calls this
+        /// connection.
+        /// \param[in] _world World of the signal, empty if none.
+        /// \return True if the connection and the signal share the world,
+        /// or if either has none.
+        public: bool Reaches(const std::string &_world) const
+        {
+          return this->world.empty() || _world.empty() ||
+              this->world == _world;
+        }
+
         /// \brief On/off value for the event callback
         public: std::atomic_bool on;
 
         /// \brief Callback function
         public: std::function<T> callback;
+
+        /// \brief Unique id of the connection.
+        public: int id;
+
+        /// \brief World the connection was made under, empty if none.
+        public: std::string world;
       };
 
-      /// \def EvtConnectionMap
-      /// \brief Event Connection map typedef.
-      typedef std::map<int, std::unique_ptr<EventConnection>> EvtConnectionMap;
+      /// \def EvtSubscribers
+      /// \brief Immutable array of subscribers. A new array is published
+      /// every time a subscriber connects or disconnects.
+      typedef std::vector<std::shared_ptr<EventConnection>> EvtSubscribers;
 
-      /// \brief Array of connection callbacks.
-      private: EvtConnectionMap connections;
+      /// \brief Holds the current subscriber array for the duration of a
+      /// Signal call. Signaling threads are counted, so that writers only
+      /// free replaced arrays when no Signal call can still be reading them.
+      private: class SignalGuard
+      {
+        /// \brief Constructor
+        /// \param[in] _event Event being signaled.
+        public: explicit SignalGuard(EventT<T> &_event)
+                : event(_event)
+        {
+          ++this->event.activeSignals;
+          this->subscribers = this->event.subscribers.load();
+        }
+
+        /// \brief Destructor
+        public: ~SignalGuard()
+        {
+          --this->event.activeSignals;
+        }
 
-      /// \brief A thread lock.
-      private: std::mutex mutex;
+        /// \brief Event being signaled.
+        private: EventT<T> &event;
+
+        /// \brief Subscribers to call.
+        public: const EvtSubscribers *subscribers;
+      };
+
+      /// \internal
+      /// \brief Replace the subscriber array, and free replaced arrays
+      /// if no Signal call is in progress. Must be called with mutex held.
+      /// \param[in] _subscribers New subscriber array.
+      private: void Publish(const EvtSubscribers *_subscribers);
 
-      /// \brief List of connections to remove
-      private: std::list<typename EvtConnectionMap::const_iterator>
-              connectionsToRemove;
+      /// \brief Current subscriber array. Read without locking by Signal.
+      private: std::atomic<const EvtSubscribers *> subscribers;
+
+      /// \brief Subscriber arrays replaced while a Signal call was in
+      /// progress, waiting to be freed.
+      private: std::vector<const EvtSubscribers *> retired;
+
+      /// \brief Number of Signal calls in progress.
+      private: std::atomic<int> activeSignals;
+
+      /// \brief Id of the next connection.
+      private: int nextId = 0;
+
+      /// \brief Serializes Connect and Disconnect.
+      private: mutable std::mutex mutex;
+
+      /// \brief Name of the event, may be empty.
+      private: std::string name;
     };
 
     /// \brief Constructor.
     template<typename T>
     EventT<T>::EventT()
-    : Event()
+    : Event(), subscribers(new EvtSubscribers()), activeSignals(0)
+    {
+    }
+
+    /// \brief Constructor.
+    template<typename T>
+    EventT<T>::EventT(const std::string &_name)
+    : Event(), subscribers(new EvtSubscribers()), activeSignals(0),
+      name(_name)
     {
     }
 
@@ -611,7 +711,9 @@ namespace gazebo
     template<typename T>
     EventT<T>::~EventT()
     {
-      this->connections.clear();
+      delete this->subscribers.load();
+      for (auto const &old : this->retired)
+        delete old;
     }
 
     /// \brief Adds a connection.
@@ -619,13 +721,28 @@ namespace gazebo
     template<typename T>
     ConnectionPtr EventT<T>::Connect(const std::function<T> &_subscriber)
     {
-      int index = 0;
-      if (!this->connections.empty())
+      // Wrap the callback with a timer only if accounting is enabled and the
+      // callback can be attributed, so there is no overhead otherwise.
+      std::function<T> callback = _subscriber;
+      const std::string &owner = CallbackAccounting::Owner();
+      if (CallbackAccounting::Enabled() &&
+          (!owner.empty() || !this->name.empty()))
       {
-        auto const &iter = this->connections.rbegin();
-        index = iter->first + 1;
+        const std::string label = (owner.empty() ? "core" : owner) + "/" +
+          (this->name.empty() ? "event" : this->name);
+        callback = AccountedCallback<T>::Wrap(_subscriber,
+            CallbackAccounting::Stats(label));
       }
-      this->connections[index].reset(new EventConnection(true, _subscriber));
+
+      std::lock_guard<std::mutex> lock(this->mutex);
+      const int index = this->nextId++;
+
+      EvtSubscribers *next = new EvtSubscribers();
+      next->reserve(this->subscribers.load()->size() + 1);
+      *next = *this->subscribers.load();
+      next->emplace_back(new EventConnection(true, callback, index));
+      this->Publish(next);
+
       return ConnectionPtr(new Connection(this, index));
     }
 
@@ -634,7 +751,8 @@ namespace gazebo
     template<typename T>
     unsigned int EventT<T>::ConnectionCount() const
     {
-      return this->connections.size();
+      std::lock_guard<std::mutex> lock(this->mutex);
+      return this->subscribers.load()->size();
     }
 
     /// \brief Removes a connection.
@@ -642,25 +760,45 @@ namespace gazebo
     template<typename T>
     void EventT<T>::Disconnect(int _id)
     {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      const EvtSubscribers *current = this->subscribers.load();
+
       // Find the connection
-      auto const &it = this->connections.find(_id);
+      auto it = std::find_if(current->begin(), current->end(),
+          [_id](const std::shared_ptr<EventConnection> &_conn)
+          {
+            return _conn->id == _id;
+          });
 
-      if (it != this->connections.end())
+      if (it != current->end())
       {
-        it->second->on = false;
-        this->connectionsToRemove.push_back(it);
+        // Signal calls still iterating over the current array skip the
+        // connection from now on.
+        (*it)->on = false;
+
+        EvtSubscribers *next = new EvtSubscribers();
+        next->reserve(current->size() - 1);
+        next->insert(next->end(), current->begin(), it);
+        next->insert(next->end(), it + 1, current->end());
+        this->Publish(next);
       }
     }
 
     /////////////////////////////////////////////
     template<typename T>
-    void EventT<T>::Cleanup()
+    void EventT<T>::Publish(const EvtSubscribers *_subscribers)
     {
-      std::lock_guard<std::mutex> lock(this->mutex);
-      // Remove all queue connections.
-      for (auto &conn : this->connectionsToRemove)
-        this->connections.erase(conn);
-      this->connectionsToRemove.clear();
+      this->retired.push_back(this->subscribers.exchange(_subscribers));
+
+      // A Signal call increments activeSignals before loading the array, so
+      // once the new array is published and no call is active, nobody can
+      // be reading a retired array.
+      if (this->activeSignals == 0)
+      {
+        for (auto const &old : this->retired)
+          delete old;
+        this->retired.clear();
+      }
     }
     /// \}
   }
@@ -15,7 +15,10 @@
  *
 */
 
+#include <atomic>
 #include <functional>
+#include <thread>
+#include <vector>
 #include <gtest/gtest.h>
 #include <gazebo/common/Time.hh>
 #include <gazebo/common/Event.hh>
@@ -220,6 +223,109 @@ TEST_F(EventTest, ManyChanges)
   EXPECT_EQ(g_callback1, 2);
 }
 
+/////////////////////////////////////////////////
+TEST_F(EventTest, ConnectionCount)
+{
+  event::EventT<void ()> evt;
+  EXPECT_EQ(evt.ConnectionCount(), 0u);
+
+  event::ConnectionPtr conn = evt.Connect(std::bind(&callback));
+  event::ConnectionPtr conn1 = evt.Connect(std::bind(&callback1));
+  EXPECT_EQ(evt.ConnectionCount(), 2u);
+
+  // Disconnected subscribers are removed right away
+  conn.reset();
+  EXPECT_EQ(evt.ConnectionCount(), 1u);
+
+  // Ids are not reused
+  conn = evt.Connect(std::bind(&callback));
+  EXPECT_NE(conn->Id(), conn1->Id());
+  EXPECT_EQ(evt.ConnectionCount(), 2u);
+}
+
+/////////////////////////////////////////////////
+// Connect and disconnect from another thread while signaling.
+TEST_F(EventTest, ConcurrentConnect)
+{
+  std::atomic<int> count(0);
+  event::EventT<void (int)> evt;
+  event::ConnectionPtr conn = evt.Connect(
+      [&count](int _value) {count += _value;});
+
+  std::atomic<bool> done(false);
+  std::vector<event::ConnectionPtr> conns;
+  std::thread writer([&]()
+  {
+    for (unsigned int i = 0; i < 1000; ++i)
+    {
+      conns.push_back(evt.Connect([](int) {}));
+      if (i % 2)
+        conns.erase(conns.begin());
+    }
+    done = true;
+  });
+
+  int signals = 0;
+  while (!done)
+  {
+    evt(1);
+    ++signals;
+  }
+  writer.join();
+
+  // The first subscriber was connected the whole time
+  EXPECT_EQ(count, signals);
+  EXPECT_EQ(evt.ConnectionCount(), 501u);
+}
+
+/////////////////////////////////////////////////
+// Connections made under a world are only signaled by that world.
+TEST_F(EventTest, ScopedEventWorld)
+{
+  int counts[3] = {0, 0, 0};
+  event::EventT<void ()> evt;
+
+  EXPECT_TRUE(event::ScopedEventWorld::Current().empty());
+  event::ConnectionPtr conns[3];
+  {
+    event::ScopedEventWorld scoped("world_0");
+    EXPECT_EQ(event::ScopedEventWorld::Current(), "world_0");
+    conns[0] = evt.Connect([&counts]() {++counts[0];});
+    {
+      event::ScopedEventWorld nested("world_1");
+      conns[1] = evt.Connect([&counts]() {++counts[1];});
+    }
+    EXPECT_EQ(event::ScopedEventWorld::Current(), "world_0");
+  }
+  EXPECT_TRUE(event::ScopedEventWorld::Current().empty());
+  conns[2] = evt.Connect([&counts]() {++counts[2];});
+
+  {
+    event::ScopedEventWorld scoped("world_0");
+    evt();
+  }
+  EXPECT_EQ(counts[0], 1);
+  EXPECT_EQ(counts[1], 0);
+  EXPECT_EQ(counts[2], 1);
+
+  // The scope is per thread
+  std::thread other([&evt]()
+  {
+    event::ScopedEventWorld scoped("world_1");
+    evt();
+  });
+  other.join();
+  EXPECT_EQ(counts[0], 1);
+  EXPECT_EQ(counts[1], 1);
+  EXPECT_EQ(counts[2], 2);
+
+  // Signals emitted under no world reach every connection
+  evt();
+  EXPECT_EQ(counts[0], 2);
+  EXPECT_EQ(counts[1], 2);
+  EXPECT_EQ(counts[2], 3);
+}
+
 /////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
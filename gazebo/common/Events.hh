@@ -17,6 +17,7 @@
 #ifndef _EVENTS_HH_
 #define _EVENTS_HH_
 
+#include <functional>
 #include <string>
 #include <sdf/sdf.hh>
 
@@ -106,7 +107,24 @@ namespace gazebo
       /// \return a connection
       public: template<typename T>
               static ConnectionPtr ConnectWorldUpdateBegin(T _subscriber)
-              { return worldUpdateBegin.Connect(_subscriber); }
+              { return ConnectWorldUpdateBeginImpl(_subscriber); }
+
+      /// \def WorldUpdateBeginConnector
+      /// \brief Function that connects world update start subscribers in
+      /// place of the worldUpdateBegin event.
+      public: typedef std::function<ConnectionPtr (
+                  const std::function<void (const common::UpdateInfo &)> &)>
+              WorldUpdateBeginConnector;
+
+      //////////////////////////////////////////////////////////////////////////
+      /// \brief Redirect the ConnectWorldUpdateBegin calls made on the
+      /// calling thread to another function. This is used to run the
+      /// callbacks of model-local plugins in a parallel phase.
+      /// \param[in] _connector Function to use, empty to connect to the
+      /// worldUpdateBegin event again.
+      /// \return The previous function, to restore it afterwards.
+      public: static WorldUpdateBeginConnector SetWorldUpdateBeginConnector(
+                  const WorldUpdateBeginConnector &_connector);
 
       //////////////////////////////////////////////////////////////////////////
       /// \brief Connect a callback to the before physics update signal
@@ -294,6 +312,14 @@ namespace gazebo
                   const std::string &,
                   const std::string &,
                   const uint32_t)> createSensor;
+
+      /// \brief Connect a callback to the world update start signal, or to
+      /// the connector set on the calling thread.
+      /// \param[in] _subscriber the subscriber to this event
+      /// \return a connection
+      private: static ConnectionPtr ConnectWorldUpdateBeginImpl(
+                   const std::function<void (const common::UpdateInfo &)>
+                   &_subscriber);
     };
     /// \}
   }
@@ -15,6 +15,7 @@
  *
 */
 
+#include <algorithm>
 #include <gazebo/gazebo_config.h>
 
 #ifdef HAVE_GDAL
@@ -34,6 +35,39 @@
 using namespace gazebo;
 using namespace common;
 
+//////////////////////////////////////////////////
+void HeightmapData::FillHeightMapRows(int _subSampling,
+    unsigned int _vertSize, const ignition::math::Vector3d &_size,
+    const ignition::math::Vector3d &_scale, bool _flipY,
+    unsigned int _firstRow, unsigned int _rowCount,
+    std::vector<float> &_heights)
+{
+  // Not virtual, to keep the layout of the class
+  if (auto image = dynamic_cast<ImageHeightmap *>(this))
+  {
+    image->FillHeightMapRows(_subSampling, _vertSize, _size, _scale, _flipY,
+        _firstRow, _rowCount, _heights);
+    return;
+  }
+#ifdef HAVE_GDAL
+  if (auto dem = dynamic_cast<Dem *>(this))
+  {
+    dem->FillHeightMapRows(_subSampling, _vertSize, _size, _scale, _flipY,
+        _firstRow, _rowCount, _heights);
+    return;
+  }
+#endif
+
+  _rowCount = std::min(_rowCount, _vertSize - std::min(_firstRow, _vertSize));
+
+  std::vector<float> heights;
+  this->FillHeightMap(_subSampling, _vertSize, _size, _scale, _flipY,
+      heights);
+
+  _heights.assign(heights.begin() + _firstRow * _vertSize,
+      heights.begin() + (_firstRow + _rowCount) * _vertSize);
+}
+
 //////////////////////////////////////////////////
 HeightmapData *HeightmapDataLoader::LoadImageAsTerrain(
     const std::string &_filename)
@@ -56,6 +56,26 @@ namespace gazebo
           const ignition::math::Vector3d &_scale, bool _flipY,
           std::vector<float> &_heights) = 0;
 
+      /// \brief Fill a range of rows of the lookup table created by
+      /// FillHeightMap, so large terrains can be processed in bands without
+      /// holding the whole table in memory. ImageHeightmap and Dem fill only
+      /// the requested rows. Other implementations fill the whole table and
+      /// the rows are copied out of it.
+      /// \param[in] _subsampling Multiplier used to increase the resolution.
+      /// \param[in] _vertSize Number of points per row.
+      /// \param[in] _size Real dimmensions of the terrain.
+      /// \param[in] _scale Vector3 used to scale the height.
+      /// \param[in] _flipY If true, it inverts the order in which the vector
+      /// is filled.
+      /// \param[in] _firstRow First row of the lookup table to fill.
+      /// \param[in] _rowCount Number of rows to fill.
+      /// \param[out] _heights _rowCount rows of _vertSize heights each.
+      public: void FillHeightMapRows(int _subSampling,
+          unsigned int _vertSize, const ignition::math::Vector3d &_size,
+          const ignition::math::Vector3d &_scale, bool _flipY,
+          unsigned int _firstRow, unsigned int _rowCount,
+          std::vector<float> &_heights);
+
       /// \brief Get the terrain's height.
       /// \return The terrain's height.
       public: virtual unsigned int GetHeight() const = 0;
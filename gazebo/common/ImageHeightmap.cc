@@ -14,6 +14,7 @@
  * limitations under the License.
  *
  */
+#include <algorithm>
 
 #include "gazebo/common/Assert.hh"
 #include "gazebo/common/Console.hh"
@@ -45,8 +46,21 @@ void ImageHeightmap::FillHeightMap(int _subSampling,
     const ignition::math::Vector3d &_scale, bool _flipY,
     std::vector<float> &_heights)
 {
+  this->FillHeightMapRows(_subSampling, _vertSize, _size, _scale, _flipY,
+      0, _vertSize, _heights);
+}
+
+//////////////////////////////////////////////////
+void ImageHeightmap::FillHeightMapRows(int _subSampling,
+    unsigned int _vertSize, const ignition::math::Vector3d &_size,
+    const ignition::math::Vector3d &_scale, bool _flipY,
+    unsigned int _firstRow, unsigned int _rowCount,
+    std::vector<float> &_heights)
+{
+  _rowCount = std::min(_rowCount, _vertSize - std::min(_firstRow, _vertSize));
+
   // Resize the vector to match the size of the vertices.
-  _heights.resize(_vertSize * _vertSize);
+  _heights.resize(_rowCount * _vertSize);
 
   int imgHeight = this->GetHeight();
   int imgWidth = this->GetWidth();
@@ -63,9 +77,14 @@ void ImageHeightmap::FillHeightMap(int _subSampling,
   unsigned int count;
   this->img.GetData(&data, count);
 
-  // Iterate over all the vertices
-  for (unsigned int y = 0; y < _vertSize; ++y)
+  // Iterate over the vertices of the requested rows
+  for (unsigned int row = 0; row < _rowCount; ++row)
   {
+    // Row of the lookup table, and the vertex it stores
+    unsigned int y = _firstRow + row;
+    if (_flipY)
+      y = _vertSize - y - 1;
+
     // yf ranges between 0 and 4
     double yf = y / static_cast<double>(_subSampling);
     int y1 = floor(yf);
@@ -100,10 +119,7 @@ void ImageHeightmap::FillHeightMap(int _subSampling,
         h = 1.0 - h;
 
       // Store the height for future use
-      if (!_flipY)
-        _heights[y * _vertSize + x] = h;
-      else
-        _heights[(_vertSize - y - 1) * _vertSize + x] = h;
+      _heights[row * _vertSize + x] = h;
     }
   }
 
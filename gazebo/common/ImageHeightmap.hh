@@ -53,6 +53,24 @@ namespace gazebo
           const ignition::math::Vector3d &_scale, bool _flipY,
           std::vector<float> &_heights);
 
+      /// \brief Fill a range of rows of the lookup table created by
+      /// FillHeightMap, sampling only the image rows they need. Called by
+      /// HeightmapData::FillHeightMapRows.
+      /// \param[in] _subsampling Multiplier used to increase the resolution.
+      /// \param[in] _vertSize Number of points per row.
+      /// \param[in] _size Real dimmensions of the terrain.
+      /// \param[in] _scale Vector3 used to scale the height.
+      /// \param[in] _flipY If true, it inverts the order in which the vector
+      /// is filled.
+      /// \param[in] _firstRow First row of the lookup table to fill.
+      /// \param[in] _rowCount Number of rows to fill.
+      /// \param[out] _heights _rowCount rows of _vertSize heights each.
+      public: void FillHeightMapRows(int _subSampling,
+          unsigned int _vertSize, const ignition::math::Vector3d &_size,
+          const ignition::math::Vector3d &_scale, bool _flipY,
+          unsigned int _firstRow, unsigned int _rowCount,
+          std::vector<float> &_heights);
+
       /// \brief Get the full filename of the image
       /// \return The filename used to load the image
       public: std::string GetFilename() const;
@@ -0,0 +1,489 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#else
+  #include <process.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ignition/common/Profiler.hh"
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/common/TerrainTiles.hh"
+
+using namespace gazebo;
+using namespace common;
+
+namespace gazebo
+{
+  namespace common
+  {
+    /// \internal
+    /// \brief Header of a terrain tiles file. It is followed by the tiles
+    /// of each level, from the full resolution one, in row major order.
+    struct TerrainTilesHeader
+    {
+      /// \brief File magic, "GZTILE1".
+      char magic[8];
+
+      /// \brief Key passed to TerrainTiles::Build.
+      uint64_t key;
+
+      /// \brief Number of points per row of the lookup table.
+      uint32_t vertSize;
+
+      /// \brief Heights per tile side.
+      uint32_t tileSize;
+
+      /// \brief Number of resolution levels.
+      uint32_t levels;
+
+      /// \brief Minimum height.
+      float minHeight;
+
+      /// \brief Maximum height.
+      float maxHeight;
+
+      /// \brief Unused, keeps the header size a multiple of 8.
+      uint32_t reserved;
+    };
+
+    /// \internal
+    /// \brief Private data for TerrainTiles.
+    class TerrainTilesPrivate
+    {
+      /// \brief Compute the level layout.
+      /// \param[in] _vertSize Number of points per row.
+      /// \param[in] _tileSize Heights per tile side.
+      /// \param[in] _levels Number of levels, 0 to use all of them.
+      public: void Layout(const unsigned int _vertSize,
+                  const unsigned int _tileSize, unsigned int _levels)
+      {
+        this->vertSizes.clear();
+        this->tileCounts.clear();
+        this->offsets.clear();
+
+        this->shift = 0;
+        while ((1u << this->shift) < _tileSize)
+          ++this->shift;
+
+        size_t offset = 0;
+        for (unsigned int l = 0; _levels == 0 || l < _levels; ++l)
+        {
+          const unsigned int n = ((_vertSize - 1) >> l) + 1;
+          const unsigned int tiles = (n + _tileSize - 1) >> this->shift;
+          this->vertSizes.push_back(n);
+          this->tileCounts.push_back(tiles);
+          this->offsets.push_back(offset);
+          offset += static_cast<size_t>(tiles) * tiles * _tileSize * _tileSize;
+
+          // The last level fits in a single tile
+          if (_levels == 0 && (n <= _tileSize || n <= 2))
+            break;
+        }
+        this->heightCount = offset;
+      }
+
+      /// \brief Release the mapped file.
+      public: void Unload()
+      {
+#ifndef _WIN32
+        if (this->mapped)
+          munmap(this->mapped, this->mappedSize);
+#endif
+        this->mapped = nullptr;
+        this->mappedSize = 0;
+        this->buffer.clear();
+        this->data = nullptr;
+      }
+
+      /// \brief File header.
+      public: TerrainTilesHeader header;
+
+      /// \brief Number of points per row at each level.
+      public: std::vector<unsigned int> vertSizes;
+
+      /// \brief Number of tiles per side at each level.
+      public: std::vector<unsigned int> tileCounts;
+
+      /// \brief Offset of each level's first tile, in heights.
+      public: std::vector<size_t> offsets;
+
+      /// \brief Total number of heights in the file.
+      public: size_t heightCount = 0;
+
+      /// \brief log2 of the tile size.
+      public: unsigned int shift = 0;
+
+      /// \brief Heights of all levels, nullptr if nothing is loaded.
+      public: const float *data = nullptr;
+
+      /// \brief Start of the memory mapping.
+      public: void *mapped = nullptr;
+
+      /// \brief Size of the memory mapping.
+      public: size_t mappedSize = 0;
+
+      /// \brief File contents, on platforms without mmap.
+      public: std::vector<char> buffer;
+    };
+  }
+}
+
+//////////////////////////////////////////////////
+TerrainTiles::TerrainTiles()
+  : dataPtr(new TerrainTilesPrivate)
+{
+}
+
+//////////////////////////////////////////////////
+TerrainTiles::~TerrainTiles()
+{
+  this->dataPtr->Unload();
+}
+
+//////////////////////////////////////////////////
+/// \brief Name of a temporary file next to a terrain tiles file, unique
+/// to this process and call, so that processes building the same file
+/// don't write to the same temporary file.
+/// \param[in] _filename Terrain tiles file.
+/// \return Temporary file name.
+static std::string TemporaryFilename(const std::string &_filename)
+{
+#ifdef _WIN32
+  const int pid = _getpid();
+#else
+  const int pid = getpid();
+#endif
+  std::random_device random;
+  std::ostringstream stream;
+  stream << _filename << "." << pid << "." << std::hex << random() << ".tmp";
+  return stream.str();
+}
+
+//////////////////////////////////////////////////
+bool TerrainTiles::Build(HeightmapData &_data, int _subSampling,
+    unsigned int _vertSize, const ignition::math::Vector3d &_size,
+    const ignition::math::Vector3d &_scale, bool _flipY, uint64_t _key,
+    const std::string &_filename, unsigned int _tileSize)
+{
+  IGN_PROFILE("TerrainTiles::Build");
+
+  if (_vertSize < 2)
+  {
+    gzerr << "Illegal terrain size (" << _vertSize << ")\n";
+    return false;
+  }
+  if (_tileSize < 2 || (_tileSize & (_tileSize - 1)) != 0)
+  {
+    gzerr << "Terrain tile size must be a power of 2 (" << _tileSize << ")\n";
+    return false;
+  }
+
+  TerrainTilesPrivate layout;
+  layout.Layout(_vertSize, _tileSize, 0);
+  const unsigned int levels = layout.vertSizes.size();
+
+  // Write to a temporary file first, so an interrupted build never leaves
+  // a file that looks valid
+  const std::string tmpFilename = TemporaryFilename(_filename);
+  std::ofstream file(tmpFilename, std::ios::binary | std::ios::trunc);
+  if (!file)
+  {
+    gzerr << "Unable to create terrain tiles [" << tmpFilename << "]\n";
+    return false;
+  }
+
+  TerrainTilesHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::strncpy(header.magic, "GZTILE1", sizeof(header.magic));
+  header.key = _key;
+  header.vertSize = _vertSize;
+  header.tileSize = _tileSize;
+  header.levels = levels;
+  header.minHeight = std::numeric_limits<float>::max();
+  header.maxHeight = -std::numeric_limits<float>::max();
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  // One band of tile rows per level. Each level keeps every other row of
+  // the previous one, so all levels fill as the full resolution rows are
+  // streamed in.
+  std::vector<std::vector<float>> bands(levels);
+  for (unsigned int l = 0; l < levels; ++l)
+    bands[l].resize(static_cast<size_t>(_tileSize) * layout.vertSizes[l]);
+
+  std::vector<float> tile(static_cast<size_t>(_tileSize) * _tileSize);
+  auto flush = [&](const unsigned int _level, const unsigned int _tileRow,
+      const unsigned int _rows)
+  {
+    const unsigned int n = layout.vertSizes[_level];
+    const std::vector<float> &band = bands[_level];
+    for (unsigned int tx = 0; tx < layout.tileCounts[_level]; ++tx)
+    {
+      for (unsigned int j = 0; j < _tileSize; ++j)
+      {
+        const float *row = &band[std::min(j, _rows - 1) * n];
+        for (unsigned int i = 0; i < _tileSize; ++i)
+        {
+          tile[j * _tileSize + i] =
+              row[std::min(tx * _tileSize + i, n - 1)];
+        }
+      }
+
+      const size_t offset = layout.offsets[_level] +
+          (static_cast<size_t>(_tileRow) * layout.tileCounts[_level] + tx) *
+          tile.size();
+      file.seekp(sizeof(header) + offset * sizeof(float));
+      file.write(reinterpret_cast<const char *>(tile.data()),
+          tile.size() * sizeof(float));
+    }
+  };
+
+  std::vector<float> rows;
+  for (unsigned int y0 = 0; y0 < _vertSize; y0 += _tileSize)
+  {
+    _data.FillHeightMapRows(_subSampling, _vertSize, _size, _scale, _flipY,
+        y0, _tileSize, rows);
+    const unsigned int rowCount = std::min(_tileSize, _vertSize - y0);
+    if (rows.size() != static_cast<size_t>(rowCount) * _vertSize)
+    {
+      gzerr << "Unable to read terrain rows [" << y0 << "]\n";
+      return false;
+    }
+
+    for (float h : rows)
+    {
+      header.minHeight = std::min(header.minHeight, h);
+      header.maxHeight = std::max(header.maxHeight, h);
+    }
+
+    for (unsigned int r = 0; r < rowCount; ++r)
+    {
+      const unsigned int y = y0 + r;
+      const float *row = &rows[static_cast<size_t>(r) * _vertSize];
+      for (unsigned int l = 0; l < levels; ++l)
+      {
+        if (y & ((1u << l) - 1))
+          break;
+
+        const unsigned int n = layout.vertSizes[l];
+        const unsigned int ly = y >> l;
+        if (ly >= n)
+          break;
+
+        float *dest = &bands[l][(ly & (_tileSize - 1)) * n];
+        for (unsigned int x = 0; x < n; ++x)
+          dest[x] = row[std::min(x << l, _vertSize - 1)];
+
+        if ((ly & (_tileSize - 1)) == _tileSize - 1 || ly == n - 1)
+          flush(l, ly >> layout.shift, (ly & (_tileSize - 1)) + 1);
+      }
+    }
+  }
+
+  file.seekp(0);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.close();
+  if (!file)
+  {
+    gzerr << "Unable to write terrain tiles [" << tmpFilename << "]\n";
+    std::remove(tmpFilename.c_str());
+    return false;
+  }
+
+  // rename replaces an existing file atomically, except on Windows where
+  // it fails instead
+#ifdef _WIN32
+  std::remove(_filename.c_str());
+#endif
+  if (std::rename(tmpFilename.c_str(), _filename.c_str()) != 0)
+  {
+    gzerr << "Unable to write terrain tiles [" << _filename << "]\n";
+    std::remove(tmpFilename.c_str());
+    return false;
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool TerrainTiles::Load(const std::string &_filename)
+{
+  this->dataPtr->Unload();
+
+  const char *bytes = nullptr;
+  size_t size = 0;
+#ifndef _WIN32
+  int fd = open(_filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0)
+  {
+    size = static_cast<size_t>(st.st_size);
+    void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (addr != MAP_FAILED)
+    {
+      this->dataPtr->mapped = addr;
+      this->dataPtr->mappedSize = size;
+      bytes = static_cast<const char *>(addr);
+    }
+  }
+  close(fd);
+#else
+  std::ifstream file(_filename, std::ios::binary);
+  if (!file)
+    return false;
+  this->dataPtr->buffer.assign(std::istreambuf_iterator<char>(file),
+      std::istreambuf_iterator<char>());
+  bytes = this->dataPtr->buffer.data();
+  size = this->dataPtr->buffer.size();
+#endif
+  if (!bytes || size < sizeof(TerrainTilesHeader))
+  {
+    gzerr << "Unable to read terrain tiles [" << _filename << "]\n";
+    this->dataPtr->Unload();
+    return false;
+  }
+
+  TerrainTilesHeader header;
+  std::memcpy(&header, bytes, sizeof(header));
+  if (std::strncmp(header.magic, "GZTILE1", sizeof(header.magic)) != 0 ||
+      header.vertSize < 2 || header.tileSize < 2 ||
+      (header.tileSize & (header.tileSize - 1)) != 0 ||
+      header.levels == 0 || header.levels > 32)
+  {
+    gzerr << "Terrain tiles [" << _filename << "] have an invalid header\n";
+    this->dataPtr->Unload();
+    return false;
+  }
+
+  this->dataPtr->Layout(header.vertSize, header.tileSize, header.levels);
+  if (size != sizeof(header) + this->dataPtr->heightCount * sizeof(float))
+  {
+    gzerr << "Terrain tiles [" << _filename << "] size does not match its "
+          << "header\n";
+    this->dataPtr->Unload();
+    return false;
+  }
+
+  this->dataPtr->header = header;
+  this->dataPtr->data = reinterpret_cast<const float *>(bytes + sizeof(header));
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool TerrainTiles::Valid() const
+{
+  return this->dataPtr->data != nullptr;
+}
+
+//////////////////////////////////////////////////
+uint64_t TerrainTiles::Key() const
+{
+  return this->Valid() ? this->dataPtr->header.key : 0;
+}
+
+//////////////////////////////////////////////////
+unsigned int TerrainTiles::VertSize() const
+{
+  return this->Valid() ? this->dataPtr->header.vertSize : 0;
+}
+
+//////////////////////////////////////////////////
+unsigned int TerrainTiles::TileSize() const
+{
+  return this->Valid() ? this->dataPtr->header.tileSize : 0;
+}
+
+//////////////////////////////////////////////////
+unsigned int TerrainTiles::LevelCount() const
+{
+  return this->Valid() ? this->dataPtr->header.levels : 0;
+}
+
+//////////////////////////////////////////////////
+unsigned int TerrainTiles::LevelVertSize(const unsigned int _level) const
+{
+  if (!this->Valid() || _level >= this->dataPtr->vertSizes.size())
+    return 0;
+  return this->dataPtr->vertSizes[_level];
+}
+
+//////////////////////////////////////////////////
+unsigned int TerrainTiles::TileCount(const unsigned int _level) const
+{
+  if (!this->Valid() || _level >= this->dataPtr->tileCounts.size())
+    return 0;
+  return this->dataPtr->tileCounts[_level];
+}
+
+//////////////////////////////////////////////////
+float TerrainTiles::Height(const unsigned int _x, const unsigned int _y) const
+{
+  const TerrainTilesPrivate &d = *this->dataPtr;
+  if (!d.data || _x >= d.header.vertSize || _y >= d.header.vertSize)
+    return 0;
+
+  const unsigned int mask = d.header.tileSize - 1;
+  const size_t tile = static_cast<size_t>(_y >> d.shift) * d.tileCounts[0] +
+      (_x >> d.shift);
+  const size_t row = (tile << d.shift) + (_y & mask);
+  return d.data[(row << d.shift) + (_x & mask)];
+}
+
+//////////////////////////////////////////////////
+const float *TerrainTiles::Tile(const unsigned int _level,
+    const unsigned int _x, const unsigned int _y) const
+{
+  const TerrainTilesPrivate &d = *this->dataPtr;
+  if (!d.data || _level >= d.tileCounts.size() ||
+      _x >= d.tileCounts[_level] || _y >= d.tileCounts[_level])
+  {
+    return nullptr;
+  }
+
+  const size_t tile = static_cast<size_t>(_y) * d.tileCounts[_level] + _x;
+  return d.data + d.offsets[_level] +
+      tile * d.header.tileSize * d.header.tileSize;
+}
+
+//////////////////////////////////////////////////
+float TerrainTiles::MinHeight() const
+{
+  return this->Valid() ? this->dataPtr->header.minHeight : 0;
+}
+
+//////////////////////////////////////////////////
+float TerrainTiles::MaxHeight() const
+{
+  return this->Valid() ? this->dataPtr->header.maxHeight : 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_COMMON_TERRAINTILES_HH_
+#define GAZEBO_COMMON_TERRAINTILES_HH_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <ignition/math/Vector3.hh>
+
+#include "gazebo/common/HeightmapData.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace common
+  {
+    // Forward declare private data.
+    class TerrainTilesPrivate;
+
+    /// \addtogroup gazebo_common Common
+    /// \{
+
+    /// \class TerrainTiles TerrainTiles.hh common/common.hh
+    /// \brief Memory mapped, multi-resolution cache of a terrain's height
+    /// lookup table (see HeightmapData::FillHeightMap).
+    ///
+    /// The cache file is built once from the terrain data, one band of
+    /// rows at a time, and then mapped into memory so heights are paged in
+    /// lazily when they are sampled. The table is split into square tiles
+    /// of TileSize() heights per side. Level 0 holds every vertex, and
+    /// each following level holds every other vertex of the previous one,
+    /// down to a level that fits in a single tile. Tiles on the border are
+    /// padded by repeating the last vertex.
+    class GZ_COMMON_VISIBLE TerrainTiles
+    {
+      /// \brief Constructor.
+      public: TerrainTiles();
+
+      /// \brief Destructor.
+      public: ~TerrainTiles();
+
+      /// \brief Build a cache file from terrain data. The parameters match
+      /// HeightmapData::FillHeightMap.
+      /// \param[in] _data Terrain data.
+      /// \param[in] _subsampling Multiplier used to increase the resolution.
+      /// \param[in] _vertSize Number of points per row.
+      /// \param[in] _size Real dimmensions of the terrain.
+      /// \param[in] _scale Vector3 used to scale the height.
+      /// \param[in] _flipY If true, it inverts the order in which the table
+      /// is filled.
+      /// \param[in] _key Value stored in the file, used by the caller to
+      /// detect stale caches. See Key().
+      /// \param[in] _filename Path of the file to write.
+      /// \param[in] _tileSize Heights per tile side, a power of two.
+      /// \return True on success.
+      public: static bool Build(HeightmapData &_data, int _subSampling,
+                  unsigned int _vertSize,
+                  const ignition::math::Vector3d &_size,
+                  const ignition::math::Vector3d &_scale, bool _flipY,
+                  uint64_t _key, const std::string &_filename,
+                  unsigned int _tileSize = 256);
+
+      /// \brief Map a cache file created by Build.
+      /// \param[in] _filename Path of the file.
+      /// \return True on success.
+      public: bool Load(const std::string &_filename);
+
+      /// \brief Get whether a cache file is loaded.
+      /// \return True if a cache file is loaded.
+      public: bool Valid() const;
+
+      /// \brief Get the key the cache file was built with.
+      /// \return Key passed to Build.
+      public: uint64_t Key() const;
+
+      /// \brief Get the number of points per row of the lookup table.
+      /// \return Number of points.
+      public: unsigned int VertSize() const;
+
+      /// \brief Get the number of heights per tile side.
+      /// \return Tile size.
+      public: unsigned int TileSize() const;
+
+      /// \brief Get the number of resolution levels.
+      /// \return Number of levels.
+      public: unsigned int LevelCount() const;
+
+      /// \brief Get the number of points per row at a level.
+      /// \param[in] _level Resolution level.
+      /// \return Number of points, 0 if the level does not exist.
+      public: unsigned int LevelVertSize(const unsigned int _level) const;
+
+      /// \brief Get the number of tiles per side at a level.
+      /// \param[in] _level Resolution level.
+      /// \return Number of tiles, 0 if the level does not exist.
+      public: unsigned int TileCount(const unsigned int _level) const;
+
+      /// \brief Get a height of the full resolution lookup table.
+      /// \param[in] _x Column of the table.
+      /// \param[in] _y Row of the table.
+      /// \return Height, 0 outside of the table.
+      public: float Height(const unsigned int _x,
+                  const unsigned int _y) const;
+
+      /// \brief Get the heights of a tile, without copying them.
+      /// \param[in] _level Resolution level.
+      /// \param[in] _x Tile column.
+      /// \param[in] _y Tile row.
+      /// \return TileSize() rows of TileSize() heights each, or nullptr if
+      /// the tile does not exist. Valid until the cache is destroyed or
+      /// loaded again.
+      public: const float *Tile(const unsigned int _level,
+                  const unsigned int _x, const unsigned int _y) const;
+
+      /// \brief Get the minimum height of the table.
+      /// \return Minimum height.
+      public: float MinHeight() const;
+
+      /// \brief Get the maximum height of the table.
+      /// \return Maximum height.
+      public: float MaxHeight() const;
+
+      /// \internal
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<TerrainTilesPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
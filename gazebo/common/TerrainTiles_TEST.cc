@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <gtest/gtest.h>
+
+#include "gazebo/common/ImageHeightmap.hh"
+#include "gazebo/common/TerrainTiles.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class TerrainTilesTest : public gazebo::testing::AutoLogFixture { };
+
+/////////////////////////////////////////////////
+TEST_F(TerrainTilesTest, FillHeightMapRows)
+{
+  common::ImageHeightmap img;
+  EXPECT_EQ(0, img.Load("file://media/materials/textures/heightmap_bowl.png"));
+
+  const int subSampling = 2;
+  const unsigned int vertSize = img.GetWidth() * subSampling - subSampling + 1;
+  const ignition::math::Vector3d size(10, 10, 10);
+  const ignition::math::Vector3d scale(1, 1, 10);
+
+  for (const bool flipY : {false, true})
+  {
+    std::vector<float> heights;
+    img.FillHeightMap(subSampling, vertSize, size, scale, flipY, heights);
+    ASSERT_EQ(heights.size(), vertSize * vertSize);
+
+    // Bands of rows match the whole table
+    std::vector<float> rows;
+    for (unsigned int y = 0; y < vertSize; y += 100)
+    {
+      img.FillHeightMapRows(subSampling, vertSize, size, scale, flipY, y,
+          100, rows);
+      const unsigned int count = std::min(100u, vertSize - y);
+      ASSERT_EQ(rows.size(), count * vertSize);
+      for (unsigned int i = 0; i < rows.size(); ++i)
+        EXPECT_FLOAT_EQ(rows[i], heights[y * vertSize + i]);
+    }
+
+    // Rows past the end are empty
+    img.FillHeightMapRows(subSampling, vertSize, size, scale, flipY,
+        vertSize, 10, rows);
+    EXPECT_TRUE(rows.empty());
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(TerrainTilesTest, BuildLoad)
+{
+  common::ImageHeightmap img;
+  EXPECT_EQ(0, img.Load("file://media/materials/textures/heightmap_bowl.png"));
+
+  const int subSampling = 2;
+  const unsigned int vertSize = img.GetWidth() * subSampling - subSampling + 1;
+  const ignition::math::Vector3d size(10, 10, 10);
+  const ignition::math::Vector3d scale(1, 1, 10);
+  std::vector<float> heights;
+  img.FillHeightMap(subSampling, vertSize, size, scale, false, heights);
+
+  const boost::filesystem::path dir =
+    boost::filesystem::temp_directory_path() / "gazebo_terrain_tiles_test";
+  boost::filesystem::create_directories(dir);
+  const std::string filename = (dir / "bowl.tiles").string();
+
+  // Invalid tile size
+  EXPECT_FALSE(common::TerrainTiles::Build(img, subSampling, vertSize, size,
+      scale, false, 1, filename, 100));
+
+  common::TerrainTiles tiles;
+  EXPECT_FALSE(tiles.Valid());
+  EXPECT_FALSE(tiles.Load(filename));
+  EXPECT_FLOAT_EQ(tiles.Height(0, 0), 0);
+  EXPECT_EQ(tiles.Tile(0, 0, 0), nullptr);
+
+  const unsigned int tileSize = 64;
+  ASSERT_TRUE(common::TerrainTiles::Build(img, subSampling, vertSize, size,
+      scale, false, 1234, filename, tileSize));
+  ASSERT_TRUE(tiles.Load(filename));
+  EXPECT_TRUE(tiles.Valid());
+  EXPECT_EQ(tiles.Key(), 1234u);
+  EXPECT_EQ(tiles.VertSize(), vertSize);
+  EXPECT_EQ(tiles.TileSize(), tileSize);
+
+  // 257, 129, 65 and 33 points per side
+  ASSERT_EQ(tiles.LevelCount(), 4u);
+  EXPECT_EQ(tiles.LevelVertSize(0), vertSize);
+  EXPECT_EQ(tiles.TileCount(0), 5u);
+  EXPECT_EQ(tiles.LevelVertSize(3), 33u);
+  EXPECT_EQ(tiles.TileCount(3), 1u);
+  EXPECT_EQ(tiles.TileCount(4), 0u);
+
+  // Full resolution heights match the lookup table
+  float min = heights[0];
+  float max = heights[0];
+  for (unsigned int y = 0; y < vertSize; ++y)
+  {
+    for (unsigned int x = 0; x < vertSize; ++x)
+    {
+      const float h = heights[y * vertSize + x];
+      EXPECT_FLOAT_EQ(tiles.Height(x, y), h);
+      min = std::min(min, h);
+      max = std::max(max, h);
+    }
+  }
+  EXPECT_FLOAT_EQ(tiles.MinHeight(), min);
+  EXPECT_FLOAT_EQ(tiles.MaxHeight(), max);
+  EXPECT_FLOAT_EQ(tiles.Height(vertSize, 0), 0);
+
+  // Coarse levels keep every other point, border tiles are padded
+  for (unsigned int level = 1; level < tiles.LevelCount(); ++level)
+  {
+    const unsigned int n = tiles.LevelVertSize(level);
+    for (unsigned int ty = 0; ty < tiles.TileCount(level); ++ty)
+    {
+      for (unsigned int tx = 0; tx < tiles.TileCount(level); ++tx)
+      {
+        const float *tile = tiles.Tile(level, tx, ty);
+        ASSERT_NE(tile, nullptr);
+        for (unsigned int j = 0; j < tileSize; ++j)
+        {
+          for (unsigned int i = 0; i < tileSize; ++i)
+          {
+            const unsigned int x = std::min(tx * tileSize + i, n - 1);
+            const unsigned int y = std::min(ty * tileSize + j, n - 1);
+            EXPECT_FLOAT_EQ(tile[j * tileSize + i],
+                heights[(y << level) * vertSize + (x << level)]);
+          }
+        }
+      }
+    }
+  }
+
+  // A truncated file is rejected
+  boost::filesystem::resize_file(filename,
+      boost::filesystem::file_size(filename) - 4);
+  EXPECT_FALSE(tiles.Load(filename));
+  EXPECT_FALSE(tiles.Valid());
+
+  boost::filesystem::remove_all(dir);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -14,7 +14,11 @@
  * limitations under the License.
  *
 */
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
+#include <vector>
 #include <stdio.h>
 #include <gazebo/gazebo_config.h>
 
@@ -58,9 +62,120 @@ using namespace common;
 #define AV_ERROR_MAX_STRING_SIZE 64
 #endif
 
+namespace
+{
+  /// \brief Number of frames that can wait to be encoded.
+  const size_t kFrameQueueSize = 8;
+
+  /// \brief An input frame waiting to be encoded.
+  class VideoFrame
+  {
+    /// \brief RGB24 image. The buffer is reused by later frames.
+    public: std::vector<unsigned char> data;
+
+    /// \brief Image width.
+    public: unsigned int width = 0;
+
+    /// \brief Image height.
+    public: unsigned int height = 0;
+
+    /// \brief Time the frame was queued.
+    public: std::chrono::steady_clock::time_point queued;
+
+    /// \brief Presentation timestamp, in frame periods.
+    public: int64_t pts = 0;
+  };
+
+  /// \brief Ring of frames between AddFrame and the encoding thread.
+  /// AddFrame fills it while holding VideoEncoderPrivate::mutex, which also
+  /// serializes concurrent callers. The encoding thread empties it without
+  /// taking that mutex, synchronized by the atomic indices.
+  class VideoFrameQueue
+  {
+    /// \brief Constructor.
+    /// \param[in] _capacity Maximum number of queued frames.
+    public: explicit VideoFrameQueue(const size_t _capacity)
+            : slots(_capacity + 1)
+    {
+    }
+
+    /// \brief Get the slot to fill with the next frame. Producer only.
+    /// \return The slot, or null if the queue is full.
+    public: VideoFrame *Back()
+    {
+      const size_t tail = this->tail.load(std::memory_order_relaxed);
+      if ((tail + 1) % this->slots.size() ==
+          this->head.load(std::memory_order_acquire))
+      {
+        return nullptr;
+      }
+      return &this->slots[tail];
+    }
+
+    /// \brief Publish the slot returned by Back. Producer only.
+    public: void Push()
+    {
+      const size_t tail = this->tail.load(std::memory_order_relaxed);
+      this->tail.store((tail + 1) % this->slots.size(),
+          std::memory_order_release);
+    }
+
+    /// \brief Get the oldest frame. Consumer only.
+    /// \return The frame, or null if the queue is empty.
+    public: VideoFrame *Front()
+    {
+      const size_t head = this->head.load(std::memory_order_relaxed);
+      if (head == this->tail.load(std::memory_order_acquire))
+        return nullptr;
+      return &this->slots[head];
+    }
+
+    /// \brief Release the frame returned by Front. Consumer only.
+    public: void Pop()
+    {
+      const size_t head = this->head.load(std::memory_order_relaxed);
+      this->head.store((head + 1) % this->slots.size(),
+          std::memory_order_release);
+    }
+
+    /// \brief Get the number of queued frames.
+    /// \return Number of frames.
+    public: size_t Size() const
+    {
+      const size_t head = this->head.load(std::memory_order_acquire);
+      const size_t tail = this->tail.load(std::memory_order_acquire);
+      return (tail + this->slots.size() - head) % this->slots.size();
+    }
+
+    /// \brief Frame slots, one is always empty.
+    private: std::vector<VideoFrame> slots;
+
+    /// \brief Index of the oldest frame.
+    private: std::atomic<size_t> head{0};
+
+    /// \brief Index of the next slot to fill.
+    private: std::atomic<size_t> tail{0};
+  };
+}
+
 // Private data class
 class gazebo::common::VideoEncoderPrivate
 {
+  /// \brief Encoding thread loop.
+  public: void Run();
+
+#ifdef HAVE_FFMPEG
+  /// \brief Convert and encode a frame.
+  /// \param[in] _frame Input frame.
+  /// \return True on success.
+  public: bool Encode(const VideoFrame &_frame);
+
+  /// \brief Send a frame to the encoder and write the resulting packets.
+  /// \param[in] _frame Frame to encode, or null to flush the encoder.
+  /// \return True on success.
+  public: bool WritePackets(AVFrame *_frame);
+#endif
+
   /// \brief Name of the file which stores the video while it is being
   ///        recorded.
   public: std::string filename;
@@ -75,16 +190,9 @@ class gazebo::common::VideoEncoderPrivate
   /// \brief libav format I/O context
   public: AVFormatContext *formatCtx = nullptr;
 
-  /// \brief libav output video frame
+  /// \brief libav output video frame, reused by every encoded frame.
   public: AVFrame *avOutFrame = nullptr;
 
-  /// \brief libav input image data
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 24, 1)
-  public: AVPicture *avInFrame = nullptr;
-#else
-  public: AVFrame *avInFrame = nullptr;
-#endif
-
   /// \brief Software scaling context
   public: SwsContext *swsCtx = nullptr;
 #endif
@@ -110,13 +218,86 @@ class gazebo::common::VideoEncoderPrivate
   /// \brief Previous time when the frame is added.
   public: std::chrono::steady_clock::time_point timePrev;
 
-  /// \brief Number of frames in the video
-  public: uint64_t frameCount = 0;
+  /// \brief Number of frames accepted by AddFrame, including the dropped
+  /// ones, used as the presentation timestamp of the next frame. Dropped
+  /// frames leave a gap, so the video keeps the timing of the input.
+  public: int64_t frameCount = 0;
 
   /// \brief Mutex for thread safety.
   public: std::mutex mutex;
+
+  /// \brief Frames waiting to be encoded.
+  public: VideoFrameQueue queue{kFrameQueueSize};
+
+  /// \brief Converts and encodes queued frames.
+  public: std::thread thread;
+
+  /// \brief True while the encoding thread must run.
+  public: std::atomic<bool> running{false};
+
+  /// \brief Used to wake up the encoding thread.
+  public: std::mutex wakeMutex;
+
+  /// \brief Signaled when a frame is queued or the thread must stop.
+  public: std::condition_variable wake;
+
+  /// \brief Number of frames encoded.
+  public: std::atomic<uint64_t> encodedFrames{0};
+
+  /// \brief Number of frames dropped because the queue was full.
+  public: std::atomic<uint64_t> droppedFrames{0};
+
+  /// \brief Sum of the encode latencies, in nanoseconds.
+  public: std::atomic<uint64_t> latencySum{0};
+
+  /// \brief Maximum encode latency, in nanoseconds.
+  public: std::atomic<uint64_t> latencyMax{0};
 };
 
+/////////////////////////////////////////////////
+void VideoEncoderPrivate::Run()
+{
+  while (true)
+  {
+    VideoFrame *frame = this->queue.Front();
+    if (!frame)
+    {
+      if (!this->running)
+        break;
+
+      std::unique_lock<std::mutex> lock(this->wakeMutex);
+      this->wake.wait(lock, [this]
+          {
+            return !this->running || this->queue.Size() > 0;
+          });
+      continue;
+    }
+
+#ifdef HAVE_FFMPEG
+    if (this->Encode(*frame))
+    {
+      const uint64_t latency =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - frame->queued).count();
+      this->latencySum += latency;
+      uint64_t max = this->latencyMax;
+      while (latency > max &&
+             !this->latencyMax.compare_exchange_weak(max, latency))
+      {
+      }
+      ++this->encodedFrames;
+    }
+#endif
+    this->queue.Pop();
+  }
+
+#ifdef HAVE_FFMPEG
+  // Write the frames delayed by the encoder
+  if (this->codecCtx)
+    this->WritePackets(nullptr);
+#endif
+}
+
 /////////////////////////////////////////////////
 VideoEncoder::VideoEncoder()
 : dataPtr(new VideoEncoderPrivate)
@@ -159,8 +340,8 @@ bool VideoEncoder::Start(const std::string &_format,
 
   // This will be true if Stop has been called, but not reset. We will reset
   // automatically to prevent any errors.
-  if (this->dataPtr->formatCtx || this->dataPtr->avInFrame ||
-      this->dataPtr->avOutFrame || this->dataPtr->swsCtx)
+  if (this->dataPtr->formatCtx || this->dataPtr->avOutFrame ||
+      this->dataPtr->swsCtx)
   {
     this->Reset();
   }
@@ -370,7 +551,10 @@ bool VideoEncoder::Start(const std::string &_format,
   this->dataPtr->codecCtx->gop_size = 10;
   this->dataPtr->codecCtx->max_b_frames = 1;
   this->dataPtr->codecCtx->pix_fmt = AV_PIX_FMT_YUV420P;
-  this->dataPtr->codecCtx->thread_count = 5;
+  // Let libav pick the number of threads, and split the work of each frame
+  // as well as encode several frames at once when the codec supports it
+  this->dataPtr->codecCtx->thread_count = 0;
+  this->dataPtr->codecCtx->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
 
   // Set the codec id
   this->dataPtr->codecCtx->codec_id =
@@ -496,6 +680,14 @@ bool VideoEncoder::Start(const std::string &_format,
     return false;
   }
 
+  this->dataPtr->encodedFrames = 0;
+  this->dataPtr->droppedFrames = 0;
+  this->dataPtr->latencySum = 0;
+  this->dataPtr->latencyMax = 0;
+  this->dataPtr->running = true;
+  this->dataPtr->thread = std::thread(&VideoEncoderPrivate::Run,
+      this->dataPtr.get());
+
   this->dataPtr->encoding = true;
   return true;
 }
@@ -553,115 +745,127 @@ bool VideoEncoder::AddFrame(const unsigned char *_frame,
     return false;
 
   this->dataPtr->timePrev = _timestamp;
+  const int64_t pts = this->dataPtr->frameCount++;
 
-  // Cause the sws to be recreated on image resize
-  if (this->dataPtr->swsCtx &&
-      (this->dataPtr->inWidth != _width || this->dataPtr->inHeight != _height))
+  // Drop the frame rather than stall the caller if the encoder is behind
+  VideoFrame *frame = this->dataPtr->queue.Back();
+  if (!frame)
   {
-    sws_freeContext(this->dataPtr->swsCtx);
-    this->dataPtr->swsCtx = nullptr;
-
-    if (this->dataPtr->avInFrame)
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 24, 1)
-      av_free(this->dataPtr->avInFrame);
-#else
-      av_frame_free(&this->dataPtr->avInFrame);
-#endif
-    this->dataPtr->avInFrame = nullptr;
+    if (++this->dataPtr->droppedFrames == 1)
+    {
+      gzwarn << "Video encoding is slower than the frame rate, "
+             << "dropping frames\n";
+    }
+    return false;
   }
 
-  if (!this->dataPtr->swsCtx)
+  frame->data.assign(_frame, _frame + _width * _height * 3);
+  frame->width = _width;
+  frame->height = _height;
+  frame->queued = std::chrono::steady_clock::now();
+  frame->pts = pts;
+  this->dataPtr->queue.Push();
+
   {
-    this->dataPtr->inWidth = _width;
-    this->dataPtr->inHeight = _height;
+    std::lock_guard<std::mutex> wakeLock(this->dataPtr->wakeMutex);
+  }
+  this->dataPtr->wake.notify_one();
+  return true;
+}
 
-    if (!this->dataPtr->avInFrame)
-    {
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 24, 1)
-      this->dataPtr->avInFrame = new AVPicture;
-      avpicture_alloc(this->dataPtr->avInFrame,
-          AV_PIX_FMT_RGB24, this->dataPtr->inWidth,
-          this->dataPtr->inHeight);
-#else
-      this->dataPtr->avInFrame = av_frame_alloc();
+/////////////////////////////////////////////////
+bool VideoEncoderPrivate::Encode(const VideoFrame &_frame)
+{
+  // Cause the sws to be recreated on image resize
+  if (this->swsCtx &&
+      (this->inWidth != _frame.width || this->inHeight != _frame.height))
+  {
+    sws_freeContext(this->swsCtx);
+    this->swsCtx = nullptr;
+  }
 
-      av_image_alloc(this->dataPtr->avInFrame->data,
-          this->dataPtr->avInFrame->linesize,
-          this->dataPtr->inWidth, this->dataPtr->inHeight,
-          AV_PIX_FMT_RGB24, 1);
-#endif
-    }
+  if (!this->swsCtx)
+  {
+    this->inWidth = _frame.width;
+    this->inHeight = _frame.height;
 
-    this->dataPtr->swsCtx = sws_getContext(
-        this->dataPtr->inWidth,
-        this->dataPtr->inHeight,
+    this->swsCtx = sws_getContext(
+        this->inWidth,
+        this->inHeight,
         AV_PIX_FMT_RGB24,
-        this->dataPtr->codecCtx->width,
-        this->dataPtr->codecCtx->height,
-        this->dataPtr->codecCtx->pix_fmt,
+        this->codecCtx->width,
+        this->codecCtx->height,
+        this->codecCtx->pix_fmt,
         SWS_BICUBIC, nullptr, nullptr, nullptr);
 
-    if (this->dataPtr->swsCtx == nullptr)
+    if (this->swsCtx == nullptr)
     {
       gzerr << "Error while calling sws_getContext\n";
       return false;
     }
   }
 
-  // encode
-  memcpy(this->dataPtr->avInFrame->data[0], _frame,
-         this->dataPtr->inWidth * this->dataPtr->inHeight * 3);
+  // Convert straight from the queued buffer
+  const uint8_t *srcData[4] = {_frame.data.data(), nullptr, nullptr, nullptr};
+  const int srcStride[4] = {static_cast<int>(_frame.width * 3), 0, 0, 0};
+  sws_scale(this->swsCtx, srcData, srcStride, 0, this->inHeight,
+      this->avOutFrame->data, this->avOutFrame->linesize);
 
-  sws_scale(this->dataPtr->swsCtx,
-      this->dataPtr->avInFrame->data,
-      this->dataPtr->avInFrame->linesize,
-      0, this->dataPtr->inHeight,
-      this->dataPtr->avOutFrame->data,
-      this->dataPtr->avOutFrame->linesize);
+  this->avOutFrame->pts = _frame.pts;
 
-  this->dataPtr->avOutFrame->pts = this->dataPtr->frameCount++;
+  return this->WritePackets(this->avOutFrame);
+}
 
+/////////////////////////////////////////////////
+bool VideoEncoderPrivate::WritePackets(AVFrame *_frame)
+{
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 40, 101)
   int gotOutput = 0;
-  AVPacket avPacket;
-  av_init_packet(&avPacket);
-  avPacket.data = nullptr;
-  avPacket.size = 0;
-
-  int ret = avcodec_encode_video2(this->dataPtr->codecCtx, &avPacket,
-      this->dataPtr->avOutFrame, &gotOutput);
-
-  if (ret >= 0 && gotOutput == 1)
+  do
   {
-    avPacket.stream_index = this->dataPtr->videoStream->index;
+    AVPacket avPacket;
+    av_init_packet(&avPacket);
+    avPacket.data = nullptr;
+    avPacket.size = 0;
 
-    // Scale timestamp appropriately.
-    if (avPacket.pts != static_cast<int64_t>(AV_NOPTS_VALUE))
-    {
-      avPacket.pts = av_rescale_q(avPacket.pts,
-          this->dataPtr->codecCtx->time_base,
-          this->dataPtr->videoStream->time_base);
-    }
+    int ret = avcodec_encode_video2(this->codecCtx, &avPacket, _frame,
+        &gotOutput);
+    if (ret < 0)
+      return false;
 
-    if (avPacket.dts != static_cast<int64_t>(AV_NOPTS_VALUE))
+    if (gotOutput == 1)
     {
-      avPacket.dts = av_rescale_q(
-          avPacket.dts,
-          this->dataPtr->codecCtx->time_base,
-          this->dataPtr->videoStream->time_base);
-    }
+      avPacket.stream_index = this->videoStream->index;
 
-    // Write frame to disk
-    ret = av_interleaved_write_frame(this->dataPtr->formatCtx, &avPacket);
+      // Scale timestamp appropriately.
+      if (avPacket.pts != static_cast<int64_t>(AV_NOPTS_VALUE))
+      {
+        avPacket.pts = av_rescale_q(avPacket.pts,
+            this->codecCtx->time_base,
+            this->videoStream->time_base);
+      }
 
-    if (ret < 0)
-    {
-      gzerr << "Error writing frame" << std::endl;
-      return false;
+      if (avPacket.dts != static_cast<int64_t>(AV_NOPTS_VALUE))
+      {
+        avPacket.dts = av_rescale_q(
+            avPacket.dts,
+            this->codecCtx->time_base,
+            this->videoStream->time_base);
+      }
+
+      // Write frame to disk
+      ret = av_interleaved_write_frame(this->formatCtx, &avPacket);
+      av_packet_unref(&avPacket);
+
+      if (ret < 0)
+      {
+        gzerr << "Error writing frame" << std::endl;
+        return false;
+      }
     }
   }
-
-  av_packet_unref(&avPacket);
+  // A null frame flushes the encoder, one packet at a time
+  while (!_frame && gotOutput == 1);
 
 // #else for libavcodec version check
 #else
@@ -672,43 +876,40 @@ bool VideoEncoder::AddFrame(const unsigned char *_frame,
   avPacket->data = nullptr;
   avPacket->size = 0;
 
-  int ret = avcodec_send_frame(this->dataPtr->codecCtx,
-                               this->dataPtr->avOutFrame);
+  int ret = avcodec_send_frame(this->codecCtx, _frame);
 
   // This loop will retrieve and write available packets
   while (ret >= 0)
   {
-    ret = avcodec_receive_packet(this->dataPtr->codecCtx, avPacket);
+    ret = avcodec_receive_packet(this->codecCtx, avPacket);
 
-    // Potential performance improvement: Queue the packets and write in
-    // a separate thread.
     if (ret >= 0)
     {
-      avPacket->stream_index = this->dataPtr->videoStream->index;
+      avPacket->stream_index = this->videoStream->index;
 
       // Scale timestamp appropriately.
       if (avPacket->pts != static_cast<int64_t>(AV_NOPTS_VALUE))
       {
         avPacket->pts = av_rescale_q(avPacket->pts,
-            this->dataPtr->codecCtx->time_base,
-            this->dataPtr->videoStream->time_base);
+            this->codecCtx->time_base,
+            this->videoStream->time_base);
       }
 
       if (avPacket->dts != static_cast<int64_t>(AV_NOPTS_VALUE))
       {
         avPacket->dts = av_rescale_q(
             avPacket->dts,
-            this->dataPtr->codecCtx->time_base,
-            this->dataPtr->videoStream->time_base);
+            this->codecCtx->time_base,
+            this->videoStream->time_base);
       }
 
       // Write frame to disk
-      if (av_interleaved_write_frame(this->dataPtr->formatCtx, avPacket) < 0)
+      if (av_interleaved_write_frame(this->formatCtx, avPacket) < 0)
         gzerr << "Error writing frame" << std::endl;
     }
   }
 
-  av_packet_unref(avPacket);
+  av_packet_free(&avPacket);
 #endif
   return true;
 }
@@ -729,8 +930,26 @@ bool VideoEncoder::AddFrame(const unsigned char */*_frame*/,
 /////////////////////////////////////////////////
 bool VideoEncoder::Stop()
 {
+  bool wasEncoding;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    wasEncoding = this->dataPtr->encoding;
+    this->dataPtr->encoding = false;
+  }
+
+  // Encode the queued frames and wait for the encoding thread
+  if (this->dataPtr->thread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(this->dataPtr->wakeMutex);
+      this->dataPtr->running = false;
+    }
+    this->dataPtr->wake.notify_one();
+    this->dataPtr->thread.join();
+  }
+
 #ifdef HAVE_FFMPEG
-  if (this->dataPtr->encoding && this->dataPtr->formatCtx)
+  if (wasEncoding && this->dataPtr->formatCtx)
     av_write_trailer(this->dataPtr->formatCtx);
 
 #if LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(57, 24, 1)
@@ -739,14 +958,6 @@ bool VideoEncoder::Stop()
 #endif
   this->dataPtr->codecCtx = nullptr;
 
-  if (this->dataPtr->avInFrame)
-#if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 24, 1)
-    av_free(this->dataPtr->avInFrame);
-#else
-    av_frame_free(&this->dataPtr->avInFrame);
-#endif
-  this->dataPtr->avInFrame = nullptr;
-
   if (this->dataPtr->avOutFrame)
 #if LIBAVCODEC_VERSION_INT < AV_VERSION_INT(57, 24, 1)
     av_free(this->dataPtr->avOutFrame);
@@ -765,11 +976,11 @@ bool VideoEncoder::Stop()
   this->dataPtr->formatCtx = nullptr;
   this->dataPtr->videoStream = nullptr;
 
-  this->dataPtr->encoding = false;
   return true;
-#endif
-  this->dataPtr->encoding = false;
+#else
+  (void) wasEncoding;
   return false;
+#endif
 }
 
 /////////////////////////////////////////////////
@@ -803,6 +1014,39 @@ bool VideoEncoder::SaveToFile(const std::string &_filename)
 #endif
 }
 
+/////////////////////////////////////////////////
+unsigned int VideoEncoder::QueueDepth() const
+{
+  return this->dataPtr->queue.Size();
+}
+
+/////////////////////////////////////////////////
+uint64_t VideoEncoder::EncodedFrames() const
+{
+  return this->dataPtr->encodedFrames;
+}
+
+/////////////////////////////////////////////////
+uint64_t VideoEncoder::DroppedFrames() const
+{
+  return this->dataPtr->droppedFrames;
+}
+
+/////////////////////////////////////////////////
+double VideoEncoder::EncodeLatency() const
+{
+  const uint64_t count = this->dataPtr->encodedFrames;
+  if (count == 0)
+    return 0;
+  return this->dataPtr->latencySum / static_cast<double>(count) * 1e-9;
+}
+
+/////////////////////////////////////////////////
+double VideoEncoder::MaxEncodeLatency() const
+{
+  return this->dataPtr->latencyMax * 1e-9;
+}
+
 /////////////////////////////////////////////////
 void VideoEncoder::Reset()
 {
@@ -18,6 +18,7 @@
 #define GAZEBO_COMMON_VIDEOENCODER_HH_
 
 #include <chrono>
+#include <cstdint>
 #include <string>
 #include <memory>
 #include <gazebo/util/system.hh>
@@ -43,6 +44,10 @@ namespace gazebo
     /// \class VideoEncoder VideoEncoder.hh common/common.hh
     /// \brief The VideoEncoder class supports encoding a series of images
     /// to a video format, and then writing the video to disk.
+    ///
+    /// Frames are copied into a queue and converted and encoded on a
+    /// separate thread, so AddFrame does not block the caller. Frames added
+    /// while the queue is full are dropped.
     class GZ_COMMON_VISIBLE VideoEncoder
     {
       /// \brief Constructor
@@ -89,7 +94,8 @@ namespace gazebo
       /// \param[in] _frame Image buffer to be encoded
       /// \param[in] _width Input frame width
       /// \param[in] _height Input frame height
-      /// \return True on success
+      /// \return True if the frame was queued. False if it was skipped to
+      /// match the frame rate, or dropped because the queue is full.
       public: bool AddFrame(const unsigned char *_frame,
                             const unsigned int _width,
                             const unsigned int _height);
@@ -99,7 +105,9 @@ namespace gazebo
       /// \param[in] _width Input frame width
       /// \param[in] _height Input frame height
       /// \param[in] _timestamp Timestamp of the image frame
-      /// \return True on success.
+      /// \return True if the frame was queued. False if it was skipped to
+      /// match the frame rate, or dropped because the queue is full. A
+      /// dropped frame still takes its place in the video timeline.
       public: bool AddFrame(const unsigned char *_frame,
                   const unsigned int _width,
                   const unsigned int _height,
@@ -118,6 +126,29 @@ namespace gazebo
       /// \return Bit rate
       public: unsigned int BitRate() const;
 
+      /// \brief Get the number of frames waiting to be encoded.
+      /// \return Number of frames.
+      public: unsigned int QueueDepth() const;
+
+      /// \brief Get the number of frames encoded since Start.
+      /// \return Number of frames.
+      public: uint64_t EncodedFrames() const;
+
+      /// \brief Get the number of frames dropped since Start because the
+      /// queue was full.
+      /// \return Number of frames.
+      public: uint64_t DroppedFrames() const;
+
+      /// \brief Get the mean time between a frame being added and its
+      /// encoding being done, since Start.
+      /// \return Latency in seconds.
+      public: double EncodeLatency() const;
+
+      /// \brief Get the maximum time between a frame being added and its
+      /// encoding being done, since Start.
+      /// \return Latency in seconds.
+      public: double MaxEncodeLatency() const;
+
       /// \brief Reset to default video properties and clean up allocated
       /// memory. This will also delete any temporary files.
       public: void Reset();
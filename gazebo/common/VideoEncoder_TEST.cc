@@ -15,7 +15,26 @@
 */
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gazebo/gazebo_config.h>
+
+#ifdef HAVE_FFMPEG
+extern "C"
+{
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+#endif
+
 #include "gazebo/common/CommonIface.hh"
+#include "gazebo/common/Console.hh"
 #include "gazebo/common/VideoEncoder.hh"
 #include "test/util.hh"
 
@@ -24,6 +43,48 @@ using namespace common;
 
 class VideoEncoderTest : public gazebo::testing::AutoLogFixture { };
 
+#ifdef HAVE_FFMPEG
+/////////////////////////////////////////////////
+/// \brief Read the presentation timestamps of the frames of a video.
+/// \param[in] _filename Video file.
+/// \param[in] _fps Frame rate of the video.
+/// \return Timestamps in frame periods, sorted.
+std::vector<int64_t> FramePts(const std::string &_filename,
+    const unsigned int _fps)
+{
+  std::vector<int64_t> pts;
+  AVFormatContext *formatCtx = nullptr;
+  if (avformat_open_input(&formatCtx, _filename.c_str(), nullptr,
+        nullptr) < 0)
+  {
+    return pts;
+  }
+
+  if (avformat_find_stream_info(formatCtx, nullptr) >= 0)
+  {
+    AVPacket packet;
+    av_init_packet(&packet);
+    packet.data = nullptr;
+    packet.size = 0;
+    while (av_read_frame(formatCtx, &packet) >= 0)
+    {
+      if (packet.pts != static_cast<int64_t>(AV_NOPTS_VALUE))
+      {
+        const AVStream *stream = formatCtx->streams[packet.stream_index];
+        pts.push_back(std::llround(
+              packet.pts * av_q2d(stream->time_base) * _fps));
+      }
+      av_packet_unref(&packet);
+    }
+  }
+  avformat_close_input(&formatCtx);
+
+  // Packets are stored in decoding order
+  std::sort(pts.begin(), pts.end());
+  return pts;
+}
+#endif
+
 /////////////////////////////////////////////////
 TEST_F(VideoEncoderTest, StartStop)
 {
@@ -75,3 +136,122 @@ TEST_F(VideoEncoderTest, Exists)
   EXPECT_FALSE(common::exists(common::cwd() + "/TMP_RECORDING.mp4"));
 #endif
 }
+
+/////////////////////////////////////////////////
+TEST_F(VideoEncoderTest, Throughput)
+{
+  VideoEncoder video;
+  EXPECT_EQ(video.QueueDepth(), 0u);
+  EXPECT_EQ(video.EncodedFrames(), 0u);
+
+#ifdef HAVE_FFMPEG
+  const unsigned int width = 1280;
+  const unsigned int height = 720;
+  const unsigned int fps = 25;
+  ASSERT_TRUE(video.Start("mp4", "", width, height, fps));
+
+  // Synthetic frames, spaced by the frame period so none is skipped
+  const unsigned int count = 100;
+  std::vector<unsigned char> frame(width * height * 3);
+  auto timestamp = std::chrono::steady_clock::now();
+  double addTime = 0;
+  unsigned int queued = 0;
+  uint64_t encoded = 0;
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    for (unsigned int p = 0; p < frame.size(); ++p)
+      frame[p] = static_cast<unsigned char>(p + i * 4);
+
+    timestamp += std::chrono::milliseconds(1000 / fps);
+    auto start = std::chrono::steady_clock::now();
+    if (video.AddFrame(frame.data(), width, height, timestamp))
+      ++queued;
+    addTime += std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    EXPECT_LE(video.QueueDepth(), 8u);
+
+    // Frames are encoded in the order they were queued, so the count
+    // only grows and never passes the queued frames
+    EXPECT_GE(video.EncodedFrames(), encoded);
+    encoded = video.EncodedFrames();
+    EXPECT_LE(encoded, queued);
+
+    // A frame older than the last one is skipped, not queued or dropped
+    if (i == count / 2)
+    {
+      const uint64_t dropped = video.DroppedFrames();
+      EXPECT_FALSE(video.AddFrame(frame.data(), width, height,
+            timestamp - std::chrono::milliseconds(1000 / fps)));
+      EXPECT_EQ(video.DroppedFrames(), dropped);
+    }
+
+    // Leave the encoder some time, as a camera would
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000 / fps));
+  }
+  EXPECT_TRUE(video.Stop());
+  EXPECT_EQ(video.QueueDepth(), 0u);
+
+  // Every frame was either encoded or dropped
+  EXPECT_EQ(video.EncodedFrames(), queued);
+  EXPECT_EQ(video.EncodedFrames() + video.DroppedFrames(), count);
+  EXPECT_GT(video.EncodedFrames(), 0u);
+  EXPECT_GT(video.EncodeLatency(), 0.0);
+  EXPECT_GE(video.MaxEncodeLatency(), video.EncodeLatency());
+
+  // Timing depends on the machine, so it is only reported
+  gzdbg << "Frames [" << count << "] encoded [" << video.EncodedFrames()
+        << "] dropped [" << video.DroppedFrames() << "]\n"
+        << "Mean AddFrame time [" << addTime / count * 1e3 << " ms]\n"
+        << "Mean encode latency [" << video.EncodeLatency() * 1e3
+        << " ms] max [" << video.MaxEncodeLatency() * 1e3 << " ms]\n";
+
+  video.Reset();
+#endif
+}
+
+/////////////////////////////////////////////////
+TEST_F(VideoEncoderTest, DroppedFramesKeepTimeline)
+{
+#ifdef HAVE_FFMPEG
+  VideoEncoder video;
+  const unsigned int width = 1280;
+  const unsigned int height = 720;
+  const unsigned int fps = 25;
+  ASSERT_TRUE(video.Start("mp4", "", width, height, fps));
+
+  // Frames spaced by the frame period, added without waiting so that the
+  // encoder falls behind and drops some of them
+  const unsigned int count = 100;
+  std::vector<unsigned char> frame(width * height * 3);
+  auto timestamp = std::chrono::steady_clock::now();
+  std::vector<int64_t> queued;
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    std::fill(frame.begin(), frame.end(), static_cast<unsigned char>(i * 2));
+    timestamp += std::chrono::milliseconds(1000 / fps);
+    if (video.AddFrame(frame.data(), width, height, timestamp))
+      queued.push_back(i);
+  }
+  EXPECT_TRUE(video.Stop());
+  EXPECT_EQ(video.EncodedFrames(), queued.size());
+  EXPECT_EQ(video.EncodedFrames() + video.DroppedFrames(), count);
+  gzdbg << "Frames [" << count << "] dropped [" << video.DroppedFrames()
+        << "]\n";
+
+  const std::string filename = common::cwd() + "/TMP_TIMELINE.mp4";
+  ASSERT_TRUE(video.SaveToFile(filename));
+
+  // Every encoded frame keeps the position it had in the input, so the
+  // timestamps increase and leave a gap for each dropped frame
+  std::vector<int64_t> pts = FramePts(filename, fps);
+  ASSERT_EQ(pts.size(), queued.size());
+  for (unsigned int i = 0; i < pts.size(); ++i)
+  {
+    EXPECT_EQ(pts[i] - pts[0], queued[i] - queued[0]);
+    if (i > 0)
+      EXPECT_LT(pts[i - 1], pts[i]);
+  }
+
+  std::remove(filename.c_str());
+#endif
+}
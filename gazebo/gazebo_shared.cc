@@ -17,6 +17,7 @@
 #include <sdf/sdf.hh>
 
 #include "gazebo/transport/TransportIface.hh"
+#include "gazebo/common/CallbackAccounting.hh"
 #include "gazebo/common/Plugin.hh"
 #include "gazebo/common/CommonIface.hh"
 #include "gazebo/common/ModelDatabase.hh"
@@ -69,7 +70,10 @@ bool gazebo_shared::setup(const std::string &_prefix, int _argc, char **_argv,
   for (std::vector<gazebo::SystemPluginPtr>::iterator iter =
        _plugins.begin(); iter != _plugins.end(); ++iter)
   {
-    (*iter)->Load(_argc, _argv);
+    const std::string owner = "system/" + (*iter)->GetHandle();
+    gazebo::event::ScopedCallbackOwner scopedOwner(owner);
+    gazebo::event::CallbackAccounting::PluginCall(owner, "Load",
+        [&iter, _argc, _argv] { (*iter)->Load(_argc, _argv); });
   }
 
   if (!gazebo::transport::init())
@@ -88,7 +92,10 @@ bool gazebo_shared::setup(const std::string &_prefix, int _argc, char **_argv,
   for (std::vector<gazebo::SystemPluginPtr>::iterator iter = _plugins.begin();
        iter != _plugins.end(); ++iter)
   {
-    (*iter)->Init();
+    const std::string owner = "system/" + (*iter)->GetHandle();
+    gazebo::event::ScopedCallbackOwner scopedOwner(owner);
+    gazebo::event::CallbackAccounting::PluginCall(owner, "Init",
+        [&iter] { (*iter)->Init(); });
   }
 
   return true;
@@ -14,6 +14,12 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
 #include <boost/algorithm/string.hpp>
 
 #include "gazebo/transport/Node.hh"
@@ -23,6 +29,7 @@
 #include "gazebo/common/Time.hh"
 
 #include "gazebo/physics/World.hh"
+#include "gazebo/physics/Link.hh"
 #include "gazebo/physics/Collision.hh"
 #include "gazebo/physics/Contact.hh"
 #include "gazebo/physics/ContactManager.hh"
@@ -30,8 +37,191 @@
 using namespace gazebo;
 using namespace physics;
 
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \internal
+    /// \brief Compact index from links and collisions to the contacts
+    /// that involve them. All ranges point into a single flat array.
+    class ContactManagerIndex
+    {
+      /// \brief An [offset, offset + count) range into entries.
+      public: using Range = std::pair<std::size_t, std::size_t>;
+
+      /// \brief Rebuild the index from the first _count contacts.
+      /// \param[in] _contacts Contacts owned by the contact manager.
+      /// \param[in] _count Number of valid contacts.
+      public: void Build(const std::vector<Contact *> &_contacts,
+                         const unsigned int _count);
+
+      /// \brief Contact pointers grouped by link, then by collision.
+      public: std::vector<Contact *> entries;
+
+      /// \brief Ranges into entries for each link.
+      public: std::unordered_map<const Link *, Range> linkRanges;
+
+      /// \brief Ranges into entries for each collision.
+      public: std::unordered_map<const Collision *, Range> collisionRanges;
+
+      /// \brief Links of each valid contact, cached between the two
+      /// passes of Build().
+      public: std::vector<std::pair<const Link *, const Link *>> links;
+
+      /// \brief True when the contacts changed since the last Build().
+      public: std::atomic<bool> dirty{true};
+
+      /// \brief Protects lazy rebuilding from concurrent queries.
+      public: std::mutex mutex;
+    };
+  }
+}
+
+/////////////////////////////////////////////////
+void ContactManagerIndex::Build(const std::vector<Contact *> &_contacts,
+    const unsigned int _count)
+{
+  this->linkRanges.clear();
+  this->collisionRanges.clear();
+  this->links.resize(_count);
+
+  // First pass: count the contacts of each link and collision.
+  for (unsigned int i = 0; i < _count; ++i)
+  {
+    const Contact *contact = _contacts[i];
+    const Link *link1 = contact->collision1->GetLink().get();
+    const Link *link2 = contact->collision2->GetLink().get();
+    this->links[i] = std::make_pair(link1, link2);
+
+    ++this->linkRanges[link1].second;
+    if (link2 != link1)
+      ++this->linkRanges[link2].second;
+
+    ++this->collisionRanges[contact->collision1].second;
+    if (contact->collision2 != contact->collision1)
+      ++this->collisionRanges[contact->collision2].second;
+  }
+
+  // Turn counts into offsets, reusing the count as a fill cursor.
+  std::size_t offset = 0;
+  for (auto &range : this->linkRanges)
+  {
+    range.second.first = offset;
+    offset += range.second.second;
+    range.second.second = 0;
+  }
+  for (auto &range : this->collisionRanges)
+  {
+    range.second.first = offset;
+    offset += range.second.second;
+    range.second.second = 0;
+  }
+  this->entries.resize(offset);
+
+  // Second pass: scatter the contacts into their ranges.
+  for (unsigned int i = 0; i < _count; ++i)
+  {
+    Contact *contact = _contacts[i];
+
+    Range &r1 = this->linkRanges[this->links[i].first];
+    this->entries[r1.first + r1.second++] = contact;
+    if (this->links[i].second != this->links[i].first)
+    {
+      Range &r2 = this->linkRanges[this->links[i].second];
+      this->entries[r2.first + r2.second++] = contact;
+    }
+
+    Range &c1 = this->collisionRanges[contact->collision1];
+    this->entries[c1.first + c1.second++] = contact;
+    if (contact->collision2 != contact->collision1)
+    {
+      Range &c2 = this->collisionRanges[contact->collision2];
+      this->entries[c2.first + c2.second++] = contact;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void ContactWrenchBuffer::Resize(const std::vector<Contact *> &_contacts,
+    const unsigned int _count)
+{
+  this->offsets.resize(_count + 1);
+  for (unsigned int i = 0; i < _count; ++i)
+    this->offsets[i + 1] = this->offsets[i] + _contacts[i]->count;
+  this->contactCount = _count;
+
+  const std::size_t points = this->offsets[_count];
+  if (points > this->capacity)
+  {
+    this->capacity = std::max(points, 2 * this->capacity);
+    this->data.resize(COMPONENT_COUNT * this->capacity);
+  }
+}
+
+/////////////////////////////////////////////////
+void ContactWrenchBuffer::Clear()
+{
+  this->contactCount = 0;
+}
+
+/////////////////////////////////////////////////
+std::size_t ContactWrenchBuffer::ContactCount() const
+{
+  return this->contactCount;
+}
+
+/////////////////////////////////////////////////
+std::size_t ContactWrenchBuffer::PointCount() const
+{
+  return this->offsets[this->contactCount];
+}
+
+/////////////////////////////////////////////////
+std::size_t ContactWrenchBuffer::Offset(const std::size_t _contact) const
+{
+  return this->offsets[_contact];
+}
+
+/////////////////////////////////////////////////
+const double *ContactWrenchBuffer::Data(const Component _component) const
+{
+  return this->data.data() + _component * this->capacity;
+}
+
+/////////////////////////////////////////////////
+void ContactWrenchBuffer::Set(const std::size_t _point,
+    const JointWrench &_wrench)
+{
+  double *values = this->data.data() + _point;
+  const std::size_t stride = this->capacity;
+  for (const auto *v : {&_wrench.body1Force, &_wrench.body1Torque,
+        &_wrench.body2Force, &_wrench.body2Torque})
+  {
+    values[0] = v->X();
+    values[stride] = v->Y();
+    values[2 * stride] = v->Z();
+    values += 3 * stride;
+  }
+}
+
+/////////////////////////////////////////////////
+JointWrench ContactWrenchBuffer::Wrench(const std::size_t _point) const
+{
+  const double *values = this->data.data() + _point;
+  const std::size_t stride = this->capacity;
+  JointWrench wrench;
+  for (auto *v : {&wrench.body1Force, &wrench.body1Torque,
+        &wrench.body2Force, &wrench.body2Torque})
+  {
+    v->Set(values[0], values[stride], values[2 * stride]);
+    values += 3 * stride;
+  }
+  return wrench;
+}
+
 /////////////////////////////////////////////////
 ContactManager::ContactManager()
+  : index(new ContactManagerIndex)
 {
   this->contactIndex = 0;
   this->customMutex = new boost::recursive_mutex();
@@ -228,6 +418,8 @@ Contact *ContactManager::NewContact(Collision *_collision1,
   if (!result)
     return result;
 
+  this->index->dirty = true;
+
   result->count = 0;
   result->collision1 = _collision1;
   result->collision2 = _collision2;
@@ -258,10 +450,65 @@ const std::vector<Contact*> &ContactManager::GetContacts() const
   return this->contacts;
 }
 
+/////////////////////////////////////////////////
+void ContactManager::UpdateIndex() const
+{
+  if (!this->index->dirty)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->index->mutex);
+  if (this->index->dirty)
+  {
+    this->index->Build(this->contacts, this->contactIndex);
+    this->index->dirty = false;
+  }
+}
+
+/////////////////////////////////////////////////
+ContactSpan ContactManager::LinkContacts(const Link *_link) const
+{
+  this->UpdateIndex();
+
+  auto iter = this->index->linkRanges.find(_link);
+  if (iter == this->index->linkRanges.end())
+    return ContactSpan();
+
+  return ContactSpan(this->index->entries.data() + iter->second.first,
+      iter->second.second);
+}
+
+/////////////////////////////////////////////////
+ContactSpan ContactManager::CollisionContacts(
+    const Collision *_collision) const
+{
+  this->UpdateIndex();
+
+  auto iter = this->index->collisionRanges.find(_collision);
+  if (iter == this->index->collisionRanges.end())
+    return ContactSpan();
+
+  return ContactSpan(this->index->entries.data() + iter->second.first,
+      iter->second.second);
+}
+
 /////////////////////////////////////////////////
 void ContactManager::ResetCount()
 {
   this->contactIndex = 0;
+  this->index->dirty = true;
+  this->wrenches.Clear();
+}
+
+/////////////////////////////////////////////////
+const ContactWrenchBuffer &ContactManager::Wrenches() const
+{
+  return this->wrenches;
+}
+
+/////////////////////////////////////////////////
+ContactWrenchBuffer &ContactManager::Wrenches()
+{
+  return this->wrenches;
 }
 
 /////////////////////////////////////////////////
@@ -280,6 +527,8 @@ void ContactManager::Clear()
 
   // Reset the contact count to zero.
   this->contactIndex = 0;
+  this->index->dirty = true;
+  this->wrenches.Clear();
 }
 
 /////////////////////////////////////////////////
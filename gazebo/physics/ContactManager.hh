@@ -18,6 +18,8 @@
 #ifndef GAZEBO_PHYSICS_CONTACTMANAGER_HH_
 #define GAZEBO_PHYSICS_CONTACTMANAGER_HH_
 
+#include <cstddef>
+#include <memory>
 #include <vector>
 #include <string>
 #include <map>
@@ -63,9 +65,137 @@ namespace gazebo
       public: ignition::transport::Node::Publisher publisherIgn;
     };
 
+    // Forward declare private index data
+    class ContactManagerIndex;
+
     /// \addtogroup gazebo_physics
     /// \{
 
+    /// \class ContactSpan ContactManager.hh physics/physics.hh
+    /// \brief A non-owning view over a contiguous range of contact
+    /// pointers stored inside the ContactManager. A span is only valid
+    /// until the contact manager's contacts are reset, which normally
+    /// happens at the start of the next collision update.
+    class GZ_PHYSICS_VISIBLE ContactSpan
+    {
+      /// \brief Constructor for an empty span.
+      public: ContactSpan() = default;
+
+      /// \brief Constructor.
+      /// \param[in] _data Pointer to the first contact pointer.
+      /// \param[in] _size Number of contact pointers in the span.
+      public: ContactSpan(Contact *const *_data, const std::size_t _size)
+              : data(_data), count(_size) {}
+
+      /// \brief Iterator to the first contact.
+      /// \return Pointer to the first element of the span.
+      public: Contact *const *begin() const
+              { return this->data; }
+
+      /// \brief Iterator past the last contact.
+      /// \return Pointer one past the last element of the span.
+      public: Contact *const *end() const
+              { return this->data + this->count; }
+
+      /// \brief Number of contacts in the span.
+      /// \return Number of contacts.
+      public: std::size_t size() const
+              { return this->count; }
+
+      /// \brief Check if the span is empty.
+      /// \return True if the span has no contacts.
+      public: bool empty() const
+              { return this->count == 0u; }
+
+      /// \brief Get a contact by index. No bounds checking is done.
+      /// \param[in] _index Index of the contact, less than size().
+      /// \return Pointer to the contact.
+      public: Contact *operator[](const std::size_t _index) const
+              { return this->data[_index]; }
+
+      /// \brief Pointer to the first contact pointer.
+      private: Contact *const *data = nullptr;
+
+      /// \brief Number of contact pointers.
+      private: std::size_t count = 0u;
+    };
+
+    /// \class ContactWrenchBuffer ContactManager.hh physics/physics.hh
+    /// \brief Wrenches of the points of the valid contacts in link frames,
+    /// stored as a flat structure of arrays: one array of doubles for each
+    /// wrench component. The points of contact i, in the order of
+    /// ContactManager::GetContacts(), are [Offset(i), Offset(i + 1)). The
+    /// storage only grows, so laying out the points of every step does not
+    /// allocate once it is large enough.
+    class GZ_PHYSICS_VISIBLE ContactWrenchBuffer
+    {
+      /// \brief Wrench components, each stored in its own array.
+      public: enum Component
+      {
+        BODY1_FORCE_X, BODY1_FORCE_Y, BODY1_FORCE_Z,
+        BODY1_TORQUE_X, BODY1_TORQUE_Y, BODY1_TORQUE_Z,
+        BODY2_FORCE_X, BODY2_FORCE_Y, BODY2_FORCE_Z,
+        BODY2_TORQUE_X, BODY2_TORQUE_Y, BODY2_TORQUE_Z,
+
+        /// \brief Number of components.
+        COMPONENT_COUNT
+      };
+
+      /// \brief Lay out the points of the valid contacts. The wrenches are
+      /// not initialized.
+      /// \param[in] _contacts Contacts owned by the contact manager.
+      /// \param[in] _count Number of valid contacts.
+      public: void Resize(const std::vector<Contact *> &_contacts,
+                          const unsigned int _count);
+
+      /// \brief Remove all the contacts, keeping the storage.
+      public: void Clear();
+
+      /// \brief Number of contacts laid out.
+      /// \return Number of contacts.
+      public: std::size_t ContactCount() const;
+
+      /// \brief Number of points of all the contacts.
+      /// \return Number of points.
+      public: std::size_t PointCount() const;
+
+      /// \brief Index of the first point of a contact. No bounds checking
+      /// is done.
+      /// \param[in] _contact Index of the contact, up to ContactCount().
+      /// \return Index of the first point, PointCount() for
+      /// ContactCount().
+      public: std::size_t Offset(const std::size_t _contact) const;
+
+      /// \brief Array of a wrench component.
+      /// \param[in] _component The component.
+      /// \return PointCount() values of the component.
+      public: const double *Data(const Component _component) const;
+
+      /// \brief Set the wrench of a point. Different points can be set
+      /// from different threads.
+      /// \param[in] _point Index of the point, less than PointCount().
+      /// \param[in] _wrench Wrench in link frames.
+      public: void Set(const std::size_t _point, const JointWrench &_wrench);
+
+      /// \brief Get the wrench of a point.
+      /// \param[in] _point Index of the point, less than PointCount().
+      /// \return Wrench in link frames.
+      public: JointWrench Wrench(const std::size_t _point) const;
+
+      /// \brief Index of the first point of each contact, and the point
+      /// count at the end.
+      private: std::vector<std::size_t> offsets = {0u};
+
+      /// \brief Number of contacts laid out.
+      private: std::size_t contactCount = 0u;
+
+      /// \brief Component arrays, each of capacity values.
+      private: std::vector<double> data;
+
+      /// \brief Number of points each component array can hold.
+      private: std::size_t capacity = 0u;
+    };
+
     /// \class ContactManager ContactManager.hh physics/physics.hh
     /// \brief Aggregates all the contact information generated by the
     /// collision detection engine.
@@ -156,6 +286,37 @@ namespace gazebo
       /// \return Vector of contact pointers.
       public: const std::vector<Contact *> &GetContacts() const;
 
+      /// \brief Get the valid contacts that involve a link.
+      ///
+      /// The first query after the contacts change builds a compact index
+      /// from links and collisions to their contacts, so repeated queries
+      /// during the same step cost a single hash lookup and no copies.
+      /// The returned span is invalidated by the next collision update.
+      /// \param[in] _link Link to query.
+      /// \return Contacts where either collision belongs to _link.
+      public: ContactSpan LinkContacts(const Link *_link) const;
+
+      /// \brief Get the valid contacts that involve a collision.
+      ///
+      /// See LinkContacts() for the lifetime of the returned span.
+      /// \param[in] _collision Collision to query.
+      /// \return Contacts where _collision is either collision1 or
+      /// collision2.
+      public: ContactSpan CollisionContacts(
+                  const Collision *_collision) const;
+
+      /// \brief Get the wrenches of the points of the valid contacts as a
+      /// flat structure of arrays. The ODE engine fills it every step with
+      /// the same wrenches as Contact::wrench, other engines leave it empty.
+      /// The wrenches are valid until the next collision update.
+      /// \return The wrenches.
+      public: const ContactWrenchBuffer &Wrenches() const;
+
+      /// \brief Get the wrenches of the points of the valid contacts, for
+      /// physics engines to fill.
+      /// \return The wrenches.
+      public: ContactWrenchBuffer &Wrenches();
+
       /// \brief Clear all stored contacts.
       public: void Clear();
 
@@ -215,10 +376,21 @@ namespace gazebo
                        Collision *_collision2, const bool _getOnlyConnected,
                        std::vector<ContactPublisher*> &_publishers);
 
+      /// \brief Rebuild the link and collision index if the contacts
+      /// changed since it was last built.
+      private: void UpdateIndex() const;
+
       private: std::vector<Contact*> contacts;
 
       private: unsigned int contactIndex;
 
+      /// \brief Index from links and collisions to contact ranges, built
+      /// lazily by UpdateIndex().
+      private: std::unique_ptr<ContactManagerIndex> index;
+
+      /// \brief Wrenches of the points of the valid contacts.
+      private: ContactWrenchBuffer wrenches;
+
       /// \brief Node for communication.
       private: transport::NodePtr node;
 
@@ -194,6 +194,140 @@ TEST_F(ContactManagerTest, NeverDropContacts)
   }
 }
 
+/////////////////////////////////////////////////
+TEST_F(ContactManagerTest, LinkContacts)
+{
+  Load("test/worlds/box.world", true);
+
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+
+  physics::ContactManager *manager = physics->GetContactManager();
+  ASSERT_TRUE(manager != nullptr);
+  manager->SetNeverDropContacts(true);
+
+  physics::ModelPtr model = world->ModelByName("box");
+  ASSERT_TRUE(model != nullptr);
+  physics::LinkPtr link = model->GetLink("link");
+  ASSERT_TRUE(link != nullptr);
+  physics::CollisionPtr collision = link->GetCollision("collision");
+  ASSERT_TRUE(collision != nullptr);
+
+  // No contacts yet, so the queries return empty spans
+  EXPECT_TRUE(manager->LinkContacts(link.get()).empty());
+  EXPECT_TRUE(manager->CollisionContacts(collision.get()).empty());
+
+  world->Step(1);
+  ASSERT_GT(manager->GetContactCount(), 0u);
+
+  // Compare the indexed queries against a full scan
+  unsigned int linkCount = 0;
+  unsigned int collisionCount = 0;
+  for (unsigned int i = 0; i < manager->GetContactCount(); ++i)
+  {
+    physics::Contact *contact = manager->GetContact(i);
+    if (contact->collision1->GetLink() == link ||
+        contact->collision2->GetLink() == link)
+    {
+      ++linkCount;
+    }
+    if (contact->collision1 == collision.get() ||
+        contact->collision2 == collision.get())
+    {
+      ++collisionCount;
+    }
+  }
+  EXPECT_GT(linkCount, 0u);
+
+  physics::ContactSpan linkContacts = manager->LinkContacts(link.get());
+  EXPECT_EQ(linkContacts.size(), linkCount);
+  for (auto contact : linkContacts)
+  {
+    EXPECT_TRUE(contact->collision1->GetLink() == link ||
+        contact->collision2->GetLink() == link);
+  }
+
+  physics::ContactSpan collisionContacts =
+      manager->CollisionContacts(collision.get());
+  EXPECT_EQ(collisionContacts.size(), collisionCount);
+  for (unsigned int i = 0; i < collisionContacts.size(); ++i)
+  {
+    EXPECT_TRUE(collisionContacts[i]->collision1 == collision.get() ||
+        collisionContacts[i]->collision2 == collision.get());
+  }
+
+  // Unknown links have no contacts
+  EXPECT_TRUE(manager->LinkContacts(nullptr).empty());
+
+  // Resetting the contacts invalidates the index
+  manager->ResetCount();
+  EXPECT_TRUE(manager->LinkContacts(link.get()).empty());
+  EXPECT_TRUE(manager->CollisionContacts(collision.get()).empty());
+}
+
+/////////////////////////////////////////////////
+TEST_F(ContactManagerTest, Wrenches)
+{
+  Load("test/worlds/box.world", true);
+
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+  if (physics->GetType() != "ode")
+  {
+    gzerr << "Only the ODE engine fills the contact wrench buffer\n";
+    return;
+  }
+
+  physics::ContactManager *manager = physics->GetContactManager();
+  ASSERT_TRUE(manager != nullptr);
+
+  // Nothing is stored when no one listens to contacts
+  world->Step(1);
+  EXPECT_EQ(manager->GetContactCount(), 0u);
+  EXPECT_EQ(manager->Wrenches().ContactCount(), 0u);
+  EXPECT_EQ(manager->Wrenches().PointCount(), 0u);
+
+  manager->SetNeverDropContacts(true);
+  world->Step(10);
+  ASSERT_GT(manager->GetContactCount(), 0u);
+
+  // The buffer holds the wrenches of every point of every contact
+  const physics::ContactWrenchBuffer &wrenches = manager->Wrenches();
+  ASSERT_EQ(wrenches.ContactCount(), manager->GetContactCount());
+  std::size_t points = 0;
+  for (unsigned int i = 0; i < manager->GetContactCount(); ++i)
+  {
+    physics::Contact *contact = manager->GetContact(i);
+    ASSERT_EQ(wrenches.Offset(i), points);
+    for (int j = 0; j < contact->count; ++j)
+    {
+      const physics::JointWrench wrench = wrenches.Wrench(points + j);
+      EXPECT_EQ(wrench.body1Force, contact->wrench[j].body1Force);
+      EXPECT_EQ(wrench.body1Torque, contact->wrench[j].body1Torque);
+      EXPECT_EQ(wrench.body2Force, contact->wrench[j].body2Force);
+      EXPECT_EQ(wrench.body2Torque, contact->wrench[j].body2Torque);
+      EXPECT_DOUBLE_EQ(
+          wrenches.Data(physics::ContactWrenchBuffer::BODY1_FORCE_Z)[
+          points + j], contact->wrench[j].body1Force.Z());
+    }
+    points += contact->count;
+  }
+  EXPECT_GT(points, 0u);
+  EXPECT_EQ(wrenches.PointCount(), points);
+  EXPECT_EQ(wrenches.Offset(wrenches.ContactCount()), points);
+
+  // Resetting the contacts empties the buffer
+  manager->ResetCount();
+  EXPECT_EQ(wrenches.ContactCount(), 0u);
+  EXPECT_EQ(wrenches.PointCount(), 0u);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -33,6 +33,7 @@
 #include "gazebo/physics/RayShape.hh"
 #include "gazebo/physics/Collision.hh"
 #include "gazebo/physics/Model.hh"
+#include "gazebo/physics/ModelLocalUpdateGroup.hh"
 #include "gazebo/physics/Light.hh"
 #include "gazebo/physics/Link.hh"
 #include "gazebo/physics/World.hh"
@@ -269,6 +270,8 @@ void Entity::SetRelativePose(const ignition::math::Pose3d &_pose,
 void Entity::SetWorldTwist(const ignition::math::Vector3d &_linear,
     const ignition::math::Vector3d &_angular, const bool _updateChildren)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->HasType(LINK) || this->HasType(MODEL))
   {
     if (this->HasType(LINK))
@@ -482,6 +485,8 @@ void Entity::SetWorldPoseDefault(const ignition::math::Pose3d &_pose,
 void Entity::SetWorldPose(const ignition::math::Pose3d &_pose,
     const bool _notify, const bool _publish)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   {
     std::lock_guard<std::mutex> lock(this->GetWorld()->WorldPoseMutex());
     (*this.*setWorldPoseFunc)(_pose, _notify, _publish);
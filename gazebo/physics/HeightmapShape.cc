@@ -16,7 +16,15 @@
 */
 #include <algorithm>
 #include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <string>
+#include <boost/filesystem.hpp>
 #include <ignition/math/Helpers.hh>
 #include <gazebo/gazebo_config.h>
 
@@ -25,6 +33,7 @@
 #include "gazebo/common/Image.hh"
 #include "gazebo/common/CommonIface.hh"
 #include "gazebo/common/SphericalCoordinates.hh"
+#include "gazebo/common/SystemPaths.hh"
 #include "gazebo/physics/HeightmapShape.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/transport/transport.hh"
@@ -32,6 +41,42 @@
 using namespace gazebo;
 using namespace physics;
 
+namespace
+{
+  /// \brief Heightmaps with more vertices per side are tiled, if the
+  /// physics engine supports it. A lookup table of this size takes 64MB.
+  const unsigned int tilesMinVertSize = 4097;
+
+  // TODO added here for ABI compatibility
+  // move to HeightmapShape.hh as protected members when merging forward
+  /// \brief Tile cache state of a heightmap shape.
+  struct HeightmapTiles
+  {
+    /// \brief True if the physics engine samples the heights through
+    /// GetHeight, so large heightmaps can be tiled.
+    bool support = false;
+
+    /// \brief Tile cache of the heights, nullptr if the shape holds the
+    /// lookup table.
+    std::unique_ptr<common::TerrainTiles> cache;
+  };
+
+  /// \brief Tile cache states of all heightmap shapes.
+  std::map<const HeightmapShape *, HeightmapTiles> heightmapTiles;
+
+  /// \brief Protects heightmapTiles.
+  std::mutex heightmapTilesMutex;
+
+  /// \brief Get the tile cache state of a heightmap shape, creating it if
+  /// needed.
+  /// \param[in] _shape The shape.
+  /// \return The state.
+  HeightmapTiles &TileState(const HeightmapShape *_shape)
+  {
+    std::lock_guard<std::mutex> lock(heightmapTilesMutex);
+    return heightmapTiles[_shape];
+  }
+}
 
 //////////////////////////////////////////////////
 HeightmapShape::HeightmapShape(CollisionPtr _parent)
@@ -53,6 +98,9 @@ HeightmapShape::~HeightmapShape()
   if (this->node)
     this->node->Fini();
   this->node.reset();
+
+  std::lock_guard<std::mutex> lock(heightmapTilesMutex);
+  heightmapTiles.erase(this);
 }
 
 //////////////////////////////////////////////////
@@ -74,6 +122,56 @@ void HeightmapShape::OnRequest(ConstRequestPtr &_msg)
     std::string *serializedData = response.mutable_serialized_data();
     msg.SerializeToString(serializedData);
 
+    this->responsePub->Publish(response);
+  }
+  else if (_msg->request() == "heightmap_tile")
+  {
+    msgs::Response response;
+    response.set_id(_msg->id());
+    response.set_request(_msg->request());
+
+    // The request data holds the level and the tile column and row
+    unsigned int level = 0;
+    unsigned int x = 0;
+    unsigned int y = 0;
+    std::istringstream data(_msg->data());
+    data >> level >> x >> y;
+
+    const common::TerrainTiles *tiles = this->Tiles();
+    const float *tile = nullptr;
+    if (tiles && data)
+      tile = tiles->Tile(level, x, y);
+
+    if (!tile)
+    {
+      response.set_response("error");
+      this->responsePub->Publish(response);
+      return;
+    }
+
+    msgs::Geometry msg;
+    this->FillMsg(msg);
+
+    const unsigned int tileSize = tiles->TileSize();
+    msgs::HeightmapGeom *heightmapMsg = msg.mutable_heightmap();
+    heightmapMsg->set_width(tileSize);
+    heightmapMsg->set_height(tileSize);
+    heightmapMsg->mutable_heights()->Reserve(tileSize * tileSize);
+    for (unsigned int i = 0; i < tileSize * tileSize; ++i)
+      heightmapMsg->add_heights(tile[i]);
+
+    msgs::HeightmapGeom::Tile *tileMsg = heightmapMsg->mutable_tile();
+    tileMsg->set_level(level);
+    tileMsg->set_x(x);
+    tileMsg->set_y(y);
+    tileMsg->set_level_count(tiles->LevelCount());
+    tileMsg->set_tile_count(tiles->TileCount(level));
+    tileMsg->set_vert_size(tiles->LevelVertSize(level));
+
+    response.set_response("success");
+    response.set_type(msg.GetTypeName());
+    msg.SerializeToString(response.mutable_serialized_data());
+
     this->responsePub->Publish(response);
   }
 }
@@ -190,6 +288,24 @@ void HeightmapShape::Load(sdf::ElementPtr _sdf)
   }
 }
 
+//////////////////////////////////////////////////
+bool HeightmapShape::Tiled() const
+{
+  return this->Tiles() != nullptr;
+}
+
+//////////////////////////////////////////////////
+const common::TerrainTiles *HeightmapShape::Tiles() const
+{
+  return TileState(this).cache.get();
+}
+
+//////////////////////////////////////////////////
+void HeightmapShape::SetTileSupport(const bool _support)
+{
+  TileState(this).support = _support;
+}
+
 //////////////////////////////////////////////////
 int HeightmapShape::GetSubSampling() const
 {
@@ -245,10 +361,71 @@ void HeightmapShape::Init()
   else
     this->scale.Z() = fabs(terrainSize.Z()) / heightmapSizeZ;
 
+  // Large heightmaps are sampled from a memory mapped tile cache, so the
+  // lookup table is never held in memory
+  HeightmapTiles &tiles = TileState(this);
+  tiles.cache.reset();
+  bool useTiles = this->vertSize > tilesMinVertSize;
+  const char *tilesEnv = std::getenv("GAZEBO_HEIGHTMAP_TILES");
+  if (tilesEnv)
+    useTiles = std::string(tilesEnv) == "1";
+
+  if (tiles.support && useTiles && this->LoadTiles())
+    return;
+
   // Construct the heightmap lookup table
   this->FillHeightfield(this->heights);
 }
 
+//////////////////////////////////////////////////
+bool HeightmapShape::LoadTiles()
+{
+  const std::string filename = common::find_file(this->GetURI());
+  const boost::filesystem::path path(filename);
+
+  // The cache depends on the source file and on every parameter the
+  // heights are computed from
+  boost::system::error_code ec;
+  std::ostringstream source;
+  source << filename << " "
+         << boost::filesystem::last_write_time(path, ec) << " "
+         << boost::filesystem::file_size(path, ec) << " "
+         << this->subSampling << " " << this->vertSize << " "
+         << this->Size() << " " << this->scale << " " << this->flipY;
+  const uint64_t key = std::hash<std::string>()(source.str());
+
+  std::ostringstream cacheName;
+  cacheName << path.stem().string() << "_" << std::hex << std::setw(16)
+            << std::setfill('0') << key << ".tiles";
+  const boost::filesystem::path cacheDir =
+      boost::filesystem::path(common::SystemPaths::Instance()->GetLogPath()) /
+      "terrain_tiles";
+  const std::string cache = (cacheDir / cacheName.str()).string();
+
+  std::unique_ptr<common::TerrainTiles> &tiles = TileState(this).cache;
+  tiles.reset(new common::TerrainTiles());
+  if (boost::filesystem::exists(cache, ec) && tiles->Load(cache) &&
+      tiles->Key() == key && tiles->VertSize() == this->vertSize)
+  {
+    return true;
+  }
+
+  gzmsg << "Building terrain tiles [" << cache << "] for heightmap ["
+        << filename << "]" << std::endl;
+  boost::filesystem::create_directories(cacheDir, ec);
+  if (!common::TerrainTiles::Build(*this->heightmapData, this->subSampling,
+        this->vertSize, this->Size(), this->scale, this->flipY, key, cache) ||
+      !tiles->Load(cache))
+  {
+    gzerr << "Unable to build terrain tiles for heightmap [" << filename
+          << "], using a lookup table instead" << std::endl;
+    tiles.reset();
+    return false;
+  }
+
+  return true;
+}
+
 //////////////////////////////////////////////////
 void HeightmapShape::SetScale(const ignition::math::Vector3d &_scale)
 {
@@ -294,10 +471,18 @@ void HeightmapShape::FillMsg(msgs::Geometry &_msg)
 //////////////////////////////////////////////////
 void HeightmapShape::FillHeights(msgs::Geometry &_msg) const
 {
+  const common::TerrainTiles *tiles = this->Tiles();
   for (unsigned int y = 0; y < this->vertSize; ++y)
   {
     for (unsigned int x = 0; x < this->vertSize; ++x)
     {
+      if (tiles)
+      {
+        _msg.mutable_heightmap()->add_heights(
+            tiles->Height(x, this->vertSize - y - 1));
+        continue;
+      }
+
       int index = (this->vertSize - y - 1) * this->vertSize + x;
       _msg.mutable_heightmap()->add_heights(this->heights[index]);
     }
@@ -319,6 +504,15 @@ ignition::math::Vector2i HeightmapShape::VertexCount() const
 /////////////////////////////////////////////////
 HeightmapShape::HeightType HeightmapShape::GetHeight(int _x, int _y) const
 {
+  // Tiled heights leave the lookup table empty
+  if (this->heights.empty())
+  {
+    const common::TerrainTiles *tiles = this->Tiles();
+    if (!tiles || _x < 0 || _y < 0)
+      return 0.0;
+    return tiles->Height(_x, _y);
+  }
+
   int index =  _y * this->vertSize + _x;
   if (_x < 0 || _y < 0 || index >= static_cast<int>(this->heights.size()))
     return 0.0;
@@ -329,6 +523,9 @@ HeightmapShape::HeightType HeightmapShape::GetHeight(int _x, int _y) const
 /////////////////////////////////////////////////
 HeightmapShape::HeightType HeightmapShape::GetMaxHeight() const
 {
+  if (const common::TerrainTiles *tiles = this->Tiles())
+    return tiles->MaxHeight();
+
   HeightType max = -std::numeric_limits<HeightType>::max();
   for (unsigned int i = 0; i < this->heights.size(); ++i)
   {
@@ -342,6 +539,9 @@ HeightmapShape::HeightType HeightmapShape::GetMaxHeight() const
 /////////////////////////////////////////////////
 HeightmapShape::HeightType HeightmapShape::GetMinHeight() const
 {
+  if (const common::TerrainTiles *tiles = this->Tiles())
+    return tiles->MinHeight();
+
   HeightType min = std::numeric_limits<HeightType>::max();
   for (unsigned int i = 0; i < this->heights.size(); ++i)
   {
@@ -26,6 +26,7 @@
 #include "gazebo/common/ImageHeightmap.hh"
 #include "gazebo/common/HeightmapData.hh"
 #include "gazebo/common/Dem.hh"
+#include "gazebo/common/TerrainTiles.hh"
 #include "gazebo/transport/TransportTypes.hh"
 #include "gazebo/physics/PhysicsTypes.hh"
 #include "gazebo/physics/Shape.hh"
@@ -42,6 +43,13 @@ namespace gazebo
     /// \brief HeightmapShape collision shape builds a heightmap from
     /// an image.  The supplied image must be square with
     /// N*N+1 pixels per side, where N is an integer.
+    ///
+    /// Large heightmaps are sampled from a memory mapped tile cache (see
+    /// common::TerrainTiles) instead of a lookup table held in memory, when
+    /// the physics engine supports it. The cache is built on first use in
+    /// ~/.gazebo/terrain_tiles. The environment variable
+    /// GAZEBO_HEIGHTMAP_TILES set to "1" or "0" forces or disables the
+    /// cache for all heightmaps.
     class GZ_PHYSICS_VISIBLE HeightmapShape : public Shape
     {
       /// \brief height field type, float or double
@@ -119,6 +127,15 @@ namespace gazebo
       /// \return The minimum height.
       public: HeightType GetMinHeight() const;
 
+      /// \brief Get whether the heights are sampled from a tile cache
+      /// instead of a lookup table held in memory.
+      /// \return True if the heights are tiled.
+      public: bool Tiled() const;
+
+      /// \brief Get the tile cache of the heights.
+      /// \return The tile cache, nullptr if the heights are not tiled.
+      public: const common::TerrainTiles *Tiles() const;
+
       /// \brief Get the amount of subsampling.
       /// \return Amount of subsampling.
       public: int GetSubSampling() const;
@@ -140,6 +157,16 @@ namespace gazebo
       /// \param[in] _msg The request message.
       private: void OnRequest(ConstRequestPtr &_msg);
 
+      /// \brief Map the tile cache of the heights, building it if needed.
+      /// \return True on success.
+      private: bool LoadTiles();
+
+      /// \brief Set whether the physics engine samples the heights through
+      /// GetHeight, so large heightmaps can be tiled. Called by the engine's
+      /// constructor. Defaults to false.
+      /// \param[in] _support True if the engine supports tiled heights.
+      protected: void SetTileSupport(const bool _support);
+
       /// \brief Fills the heightmap data (float) into the vector
       /// by calling HeightmapData::FillHeightMap with \e heights
       /// \param[in] heights height field to fill with data.
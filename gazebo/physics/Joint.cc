@@ -27,6 +27,7 @@
 #include "gazebo/physics/PhysicsEngine.hh"
 #include "gazebo/physics/Link.hh"
 #include "gazebo/physics/Model.hh"
+#include "gazebo/physics/ModelLocalUpdateGroup.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/physics/Joint.hh"
 
@@ -718,6 +719,8 @@ bool Joint::SetPositionMaximal(
     const unsigned int _index, double _position,
     const bool _preserveWorldVelocity)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   // check if index is within bounds
   if (_index >= this->DOF())
   {
@@ -837,6 +840,8 @@ bool Joint::SetPositionMaximal(
 //////////////////////////////////////////////////
 bool Joint::SetVelocityMaximal(unsigned int _index, double _velocity)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   // check if index is within bounds
   if (_index >= this->DOF())
   {
@@ -936,6 +941,8 @@ void Joint::SetState(const JointState &_state)
 //////////////////////////////////////////////////
 double Joint::CheckAndTruncateForce(unsigned int _index, double _effort)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (_index >= this->DOF())
   {
     gzerr << "Calling Joint::SetForce with an index ["
@@ -91,14 +91,18 @@ class gazebo::physics::LinkPrivate
   /// \brief Vector of wrench messages to be processed.
   public: std::vector<msgs::Wrench> wrenchMsgs;
 
-  /// \brief Mutex to protect the wrenchMsgs variable.
+  /// \brief Mutex to protect the wrenchMsgs and finalized variables.
   public: std::mutex wrenchMsgMutex;
 
+  /// \brief True once Fini has started, after which wrench messages are
+  /// dropped.
+  public: bool finalized = false;
+
   /// \brief Wind velocity.
   public: ignition::math::Vector3d windLinearVel;
 
-  /// \brief Update connection to calculate wind velocity.
-  public: event::ConnectionPtr updateConnection;
+  /// \brief True if the wind velocity is computed on every update.
+  public: bool windEnabled = false;
 
   /// \brief All the attached batteries.
   public: std::vector<common::BatteryPtr> batteries;
@@ -295,10 +299,8 @@ void Link::Load(sdf::ElementPtr _sdf)
   this->sdf->GetElement("enable_wind")->GetValue()->SetUpdateFunc(
       std::bind(&Link::WindMode, this));
 
-  this->connections.push_back(event::Events::ConnectWorldUpdateBegin(
-      std::bind(
-      static_cast<void(Link::*)(const common::UpdateInfo &)>(&Link::Update),
-      this, std::placeholders::_1)));
+  // Join the world's active links only if there is something to update
+  this->UpdateActive();
 
   this->SetStatic(this->IsStatic());
 }
@@ -338,13 +340,30 @@ void Link::Init()
   if (this->WindMode() && this->world->WindEnabled())
     this->SetWindEnabled(true);
 
+  this->world->_SetLinkIndexed(this, true);
+
   this->initialized = true;
 }
 
 //////////////////////////////////////////////////
 void Link::Fini()
 {
-  this->dataPtr->updateConnection.reset();
+  // Stop the wrench messages first, so a late one can not make the link
+  // active again once it is removed from the world
+  this->dataPtr->wrenchSub.reset();
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->wrenchMsgMutex);
+    this->dataPtr->finalized = true;
+    this->dataPtr->wrenchMsgs.clear();
+  }
+
+  this->dataPtr->windEnabled = false;
+  if (this->world)
+  {
+    this->world->_SetLinkActive(this, false);
+    this->world->_SetLinkWind(this, false);
+    this->world->_SetLinkIndexed(this, false);
+  }
 
   this->dataPtr->attachedModels.clear();
   this->dataPtr->parentJoints.clear();
@@ -407,8 +426,6 @@ void Link::Fini()
   {
     this->dataPtr->dataPub.reset();
     this->visPub.reset();
-
-    this->dataPtr->wrenchSub.reset();
   }
   this->connections.clear();
 
@@ -584,7 +601,7 @@ void Link::SetLaserRetro(float _retro)
 }
 
 //////////////////////////////////////////////////
-void Link::Update(const common::UpdateInfo & /*_info*/)
+void Link::Update(const common::UpdateInfo &/*_info*/)
 {
 #ifdef HAVE_OPENAL
   if (this->dataPtr->audioSink)
@@ -610,19 +627,25 @@ void Link::Update(const common::UpdateInfo & /*_info*/)
      this->dataPtr->enabledSignal(this->dataPtr->enabled);
    }*/
 
-  if (!this->IsStatic() && !this->dataPtr->wrenchMsgs.empty())
+  if (!this->dataPtr->wrenchMsgs.empty())
   {
     std::vector<msgs::Wrench> messages;
     {
       std::lock_guard<std::mutex> lock(this->dataPtr->wrenchMsgMutex);
-      messages = this->dataPtr->wrenchMsgs;
-      this->dataPtr->wrenchMsgs.clear();
+      messages.swap(this->dataPtr->wrenchMsgs);
     }
 
-    for (auto it : messages)
+    // Static links drop the wrenches queued before they became static
+    if (!this->IsStatic())
     {
-      this->ProcessWrenchMsg(it);
+      for (auto it : messages)
+      {
+        this->ProcessWrenchMsg(it);
+      }
     }
+
+    // Leave the active links if the queue was the only reason to be there
+    this->UpdateActive();
   }
 
   // Update the batteries.
@@ -632,12 +655,38 @@ void Link::Update(const common::UpdateInfo & /*_info*/)
   }
 }
 
+//////////////////////////////////////////////////
+void Link::UpdateActive()
+{
+  if (!this->world)
+    return;
+
+  bool active = !this->dataPtr->batteries.empty();
+#ifdef HAVE_OPENAL
+  active = active || this->dataPtr->audioSink ||
+    !this->dataPtr->audioSources.empty();
+#endif
+
+  // Hold the lock, so a wrench message arriving now is not missed
+  std::lock_guard<std::mutex> lock(this->dataPtr->wrenchMsgMutex);
+  if (this->dataPtr->finalized)
+    return;
+  active = active || !this->dataPtr->wrenchMsgs.empty();
+  this->world->_SetLinkActive(this, active);
+}
+
 //////////////////////////////////////////////////
 void Link::UpdateWind(const common::UpdateInfo & /*_info*/)
 {
   this->dataPtr->windLinearVel = this->world->Wind().WorldLinearVel(this);
 }
 
+//////////////////////////////////////////////////
+void Link::_SetWorldWindLinearVel(const ignition::math::Vector3d &_vel)
+{
+  this->dataPtr->windLinearVel = _vel;
+}
+
 /////////////////////////////////////////////////
 Joint_V Link::GetParentJoints() const
 {
@@ -842,26 +891,23 @@ void Link::SetWindMode(const bool _mode)
 {
   this->sdf->GetElement("enable_wind")->Set(_mode);
 
-  if (!this->WindMode() && this->dataPtr->updateConnection)
+  if (!this->WindMode() && this->dataPtr->windEnabled)
     this->SetWindEnabled(false);
-  else if (this->WindMode() && !this->dataPtr->updateConnection)
+  else if (this->WindMode() && !this->dataPtr->windEnabled)
     this->SetWindEnabled(true);
 }
 
 /////////////////////////////////////////////////
 void Link::SetWindEnabled(const bool _enable)
 {
-  if (_enable)
-  {
-    this->dataPtr->updateConnection = event::Events::ConnectWorldUpdateBegin(
-        std::bind(&Link::UpdateWind, this, std::placeholders::_1));
-  }
-  else
+  this->dataPtr->windEnabled = _enable;
+  if (!_enable)
   {
-    this->dataPtr->updateConnection.reset();
     // Make sure wind velocity is null
     this->dataPtr->windLinearVel.Set(0, 0, 0);
   }
+  if (this->world)
+    this->world->_SetLinkWind(this, _enable);
 }
 
 //////////////////////////////////////////////////
@@ -1161,6 +1207,9 @@ void Link::DetachAllStaticModels()
 //////////////////////////////////////////////////
 void Link::OnPoseChange()
 {
+  if (this->world)
+    this->world->_SetLinkIndexDirty(this);
+
   ignition::math::Pose3d p;
   for (unsigned int i = 0; i < this->dataPtr->attachedModels.size(); i++)
   {
@@ -1800,7 +1849,10 @@ void Link::OnWrenchMsg(ConstWrenchPtr &_msg)
   }
 
   std::lock_guard<std::mutex> lock(this->dataPtr->wrenchMsgMutex);
+  if (this->dataPtr->finalized)
+    return;
   this->dataPtr->wrenchMsgs.push_back(*_msg);
+  this->world->_SetLinkActive(this, true);
 }
 
 //////////////////////////////////////////////////
@@ -1833,6 +1885,7 @@ void Link::LoadBattery(sdf::ElementPtr _sdf)
   common::BatteryPtr battery(new common::Battery());
   battery->Load(_sdf);
   this->dataPtr->batteries.push_back(battery);
+  this->UpdateActive();
 }
 
 /////////////////////////////////////////////////
@@ -79,7 +79,9 @@ namespace gazebo
       /// \param[in] _sdf SDF values to load from.
       public: virtual void UpdateParameters(sdf::ElementPtr _sdf) override;
 
-      /// \brief Update the collision.
+      /// \brief Update audio, queued wrench messages and batteries.
+      /// Called by the World only while the link is active, see
+      /// World::_SetLinkActive.
       /// \param[in] _info Update information.
       public: void Update(const common::UpdateInfo &_info);
       using Base::Update;
@@ -574,6 +576,12 @@ namespace gazebo
       /// \param[in] _info Update information.
       public: void UpdateWind(const common::UpdateInfo &_info);
 
+      /// \internal
+      /// \brief Set the wind velocity of this link, in the world frame.
+      /// Only Wind::UpdateLinks should call this function.
+      /// \param[in] _vel Wind velocity.
+      public: void _SetWorldWindLinearVel(const ignition::math::Vector3d &_vel);
+
       /// \brief Get a battery by name.
       /// \param[in] _name Name of the battery to get.
       /// \return Pointer to the battery, NULL if the name is invalid.
@@ -672,6 +680,10 @@ namespace gazebo
       /// \param[in] _sdf SDF parameter.
       private: void LoadBattery(const sdf::ElementPtr _sdf);
 
+      /// \brief Add the link to the world's active links if it has audio,
+      /// queued wrench messages or batteries, otherwise remove it.
+      private: void UpdateActive();
+
       /// \brief Register items in the introspection service.
       protected: virtual void RegisterIntrospectionItems() override;
 
@@ -25,10 +25,13 @@
 #include <ignition/math/Pose3.hh>
 #include <ignition/math/SemanticVersion.hh>
 #include <ignition/msgs/plugin_v.pb.h>
+#include <functional>
+#include <memory>
 #include <sstream>
 
 #include "gazebo/common/KeyFrame.hh"
 #include "gazebo/common/Animation.hh"
+#include "gazebo/common/CallbackAccounting.hh"
 #include "gazebo/common/Plugin.hh"
 #include "gazebo/common/Events.hh"
 #include "gazebo/common/Exception.hh"
@@ -56,6 +59,37 @@
 using namespace gazebo;
 using namespace physics;
 
+namespace
+{
+  /// \brief Redirects the worldUpdateBegin connections made on the calling
+  /// thread to the model-local updates of the world, for the lifetime of
+  /// the object.
+  class ScopedModelLocalConnector
+  {
+    /// \brief Constructor.
+    /// \param[in] _model Model the connections are local to.
+    public: explicit ScopedModelLocalConnector(ModelPtr _model)
+    {
+      WorldPtr world = _model->GetWorld();
+      this->previous = event::Events::SetWorldUpdateBeginConnector(
+          [world, _model](
+            const std::function<void (const common::UpdateInfo &)> &_cb)
+          {
+            return world->ConnectModelLocalUpdate(_model, _cb);
+          });
+    }
+
+    /// \brief Destructor. Restores the previous connector.
+    public: ~ScopedModelLocalConnector()
+    {
+      event::Events::SetWorldUpdateBeginConnector(this->previous);
+    }
+
+    /// \brief Connector active before this one.
+    private: event::Events::WorldUpdateBeginConnector previous;
+  };
+}
+
 //////////////////////////////////////////////////
 Model::Model(BasePtr _parent)
   : Entity(_parent)
@@ -1103,9 +1137,22 @@ void Model::LoadPlugin(sdf::ElementPtr _sdf)
 
     ModelPtr myself = boost::static_pointer_cast<Model>(shared_from_this());
 
+    // Attribute the callbacks connected by the plugin to it, and the time
+    // spent in its Load and Init functions
+    const std::string owner =
+        "model/" + this->GetScopedName() + "/" + pluginName;
+    event::ScopedCallbackOwner scopedOwner(owner);
+
+    // Model-local plugins update in parallel with the other model-local
+    // plugins, see World::ConnectModelLocalUpdate
+    std::unique_ptr<ScopedModelLocalConnector> modelLocal;
+    if (_sdf->HasElement("model_local") && _sdf->Get<bool>("model_local"))
+      modelLocal.reset(new ScopedModelLocalConnector(myself));
+
     try
     {
-      plugin->Load(myself, _sdf);
+      event::CallbackAccounting::PluginCall(owner, "Load",
+          [&plugin, &myself, &_sdf] { plugin->Load(myself, _sdf); });
     }
     catch(...)
     {
@@ -1123,7 +1170,8 @@ void Model::LoadPlugin(sdf::ElementPtr _sdf)
 
     try
     {
-      plugin->Init();
+      event::CallbackAccounting::PluginCall(owner, "Init",
+          [&plugin] { plugin->Init(); });
     }
     catch(...)
     {
@@ -0,0 +1,246 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ignition/common/Profiler.hh"
+
+#include "gazebo/common/CallbackAccounting.hh"
+#include "gazebo/common/Console.hh"
+#include "gazebo/physics/Base.hh"
+#include "gazebo/physics/Model.hh"
+#include "gazebo/physics/ModelLocalUpdateGroup.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+namespace
+{
+  /// \brief Model whose callbacks are running on this thread.
+  thread_local const Base *t_model = nullptr;
+
+  /// \brief Entity pairs already reported by CheckAccess.
+  std::set<std::pair<std::string, std::string>> g_reported;
+
+  /// \brief Protects g_reported.
+  std::mutex g_reportedMutex;
+}
+
+/// \brief Private data for ModelLocalUpdateGroup.
+class gazebo::physics::ModelLocalUpdateGroupPrivate
+{
+  /// \brief A connected callback.
+  public: class Callback
+  {
+    /// \brief Connection id.
+    public: int id;
+
+    /// \brief False once disconnected.
+    public: std::atomic_bool on;
+
+    /// \brief Callback function.
+    public: std::function<void (const common::UpdateInfo &)> callback;
+  };
+
+  /// \brief Callbacks of one model, run in order by a single worker.
+  public: class Bucket
+  {
+    /// \brief The model.
+    public: const Model *model;
+
+    /// \brief Callbacks of the model.
+    public: std::vector<std::shared_ptr<Callback>> callbacks;
+  };
+
+  /// \def Buckets
+  /// \brief Immutable array of buckets. A new array is published every time
+  /// a callback connects or disconnects, so Run does not need to lock.
+  public: typedef std::vector<Bucket> Buckets;
+
+  /// \brief Current buckets, accessed with std::atomic_load and
+  /// std::atomic_store.
+  public: std::shared_ptr<const Buckets> buckets;
+
+  /// \brief Id of the next connection.
+  public: int nextId = 0;
+
+  /// \brief Serializes Connect and Disconnect.
+  public: mutable std::mutex mutex;
+};
+
+//////////////////////////////////////////////////
+ModelLocalUpdateGroup::ModelLocalUpdateGroup()
+  : dataPtr(new ModelLocalUpdateGroupPrivate)
+{
+  this->dataPtr->buckets =
+    std::make_shared<const ModelLocalUpdateGroupPrivate::Buckets>();
+}
+
+//////////////////////////////////////////////////
+ModelLocalUpdateGroup::~ModelLocalUpdateGroup()
+{
+}
+
+//////////////////////////////////////////////////
+event::ConnectionPtr ModelLocalUpdateGroup::Connect(ModelPtr _model,
+    const std::function<void (const common::UpdateInfo &)> &_subscriber)
+{
+  if (!_model)
+  {
+    gzerr << "Unable to connect a model-local update without a model\n";
+    return event::ConnectionPtr();
+  }
+
+  auto callback = std::make_shared<ModelLocalUpdateGroupPrivate::Callback>();
+  callback->on = true;
+  callback->callback = _subscriber;
+
+  // Same attribution as callbacks connected to event::Events
+  const std::string &owner = event::CallbackAccounting::Owner();
+  if (event::CallbackAccounting::Enabled())
+  {
+    callback->callback =
+      event::AccountedCallback<void (const common::UpdateInfo &)>::Wrap(
+        _subscriber, event::CallbackAccounting::Stats(
+          (owner.empty() ? "core" : owner) + "/modelLocalUpdate"));
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  callback->id = this->dataPtr->nextId++;
+
+  auto next = std::make_shared<ModelLocalUpdateGroupPrivate::Buckets>(
+      *std::atomic_load(&this->dataPtr->buckets));
+  auto bucket = std::find_if(next->begin(), next->end(),
+      [&_model](const ModelLocalUpdateGroupPrivate::Bucket &_bucket)
+      {
+        return _bucket.model == _model.get();
+      });
+  if (bucket == next->end())
+  {
+    next->push_back(ModelLocalUpdateGroupPrivate::Bucket());
+    bucket = next->end() - 1;
+    bucket->model = _model.get();
+  }
+  bucket->callbacks.push_back(callback);
+  std::atomic_store(&this->dataPtr->buckets,
+      std::shared_ptr<const ModelLocalUpdateGroupPrivate::Buckets>(next));
+
+  return event::ConnectionPtr(new event::Connection(this, callback->id));
+}
+
+//////////////////////////////////////////////////
+void ModelLocalUpdateGroup::Disconnect(int _id)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  auto next = std::make_shared<ModelLocalUpdateGroupPrivate::Buckets>(
+      *std::atomic_load(&this->dataPtr->buckets));
+  for (auto bucket = next->begin(); bucket != next->end(); ++bucket)
+  {
+    auto &callbacks = bucket->callbacks;
+    auto it = std::find_if(callbacks.begin(), callbacks.end(),
+        [_id](const std::shared_ptr<ModelLocalUpdateGroupPrivate::Callback>
+          &_callback)
+        {
+          return _callback->id == _id;
+        });
+    if (it == callbacks.end())
+      continue;
+
+    // A Run call still using the previous buckets skips the callback.
+    (*it)->on = false;
+    callbacks.erase(it);
+    if (callbacks.empty())
+      next->erase(bucket);
+
+    std::atomic_store(&this->dataPtr->buckets,
+        std::shared_ptr<const ModelLocalUpdateGroupPrivate::Buckets>(next));
+    return;
+  }
+}
+
+//////////////////////////////////////////////////
+unsigned int ModelLocalUpdateGroup::ConnectionCount() const
+{
+  auto buckets = std::atomic_load(&this->dataPtr->buckets);
+  unsigned int count = 0;
+  for (auto const &bucket : *buckets)
+    count += bucket.callbacks.size();
+  return count;
+}
+
+//////////////////////////////////////////////////
+void ModelLocalUpdateGroup::Run(const common::UpdateInfo &_info)
+{
+  IGN_PROFILE("ModelLocalUpdateGroup::Run");
+
+  auto buckets = std::atomic_load(&this->dataPtr->buckets);
+  if (buckets->empty())
+    return;
+
+  this->SetSignaled(true);
+
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, buckets->size(), 1),
+      [&buckets, &_info](const tbb::blocked_range<size_t> &_r)
+      {
+        for (size_t i = _r.begin(); i != _r.end(); ++i)
+        {
+          const ModelLocalUpdateGroupPrivate::Bucket &bucket = (*buckets)[i];
+          t_model = bucket.model;
+          for (auto const &callback : bucket.callbacks)
+          {
+            if (callback->on)
+              callback->callback(_info);
+          }
+          t_model = nullptr;
+        }
+      });
+}
+
+//////////////////////////////////////////////////
+void ModelLocalUpdateGroup::CheckAccess(const Base *_entity)
+{
+  const Base *model = t_model;
+  if (!model || !_entity || _entity == model)
+    return;
+
+  for (BasePtr parent = _entity->GetParent(); parent;
+       parent = parent->GetParent())
+  {
+    if (parent.get() == model)
+      return;
+  }
+
+  const std::string modelName = model->GetScopedName();
+  const std::string entityName = _entity->GetScopedName();
+  std::lock_guard<std::mutex> lock(g_reportedMutex);
+  if (g_reported.insert(std::make_pair(modelName, entityName)).second)
+  {
+    gzerr << "A model-local update of model [" << modelName
+          << "] modified entity [" << entityName << "], which belongs to "
+          << "another model. Remove <model_local> from the plugin, or "
+          << "connect it to the worldUpdateBegin event instead.\n";
+  }
+}
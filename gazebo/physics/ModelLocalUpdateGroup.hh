@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_MODELLOCALUPDATEGROUP_HH_
+#define GAZEBO_PHYSICS_MODELLOCALUPDATEGROUP_HH_
+
+#include <functional>
+#include <memory>
+
+#include "gazebo/common/Event.hh"
+#include "gazebo/common/UpdateInfo.hh"
+#include "gazebo/physics/PhysicsTypes.hh"
+#include "gazebo/util/system.hh"
+
+/// \def GZ_CHECK_MODEL_LOCAL
+/// \brief Report an error if a model-local update callback running on the
+/// current thread modifies an entity of another model. Compiled out in
+/// release builds.
+#ifndef NDEBUG
+#define GZ_CHECK_MODEL_LOCAL(_entity) \
+  gazebo::physics::ModelLocalUpdateGroup::CheckAccess(_entity)
+#else
+#define GZ_CHECK_MODEL_LOCAL(_entity) ((void) 0)
+#endif
+
+namespace gazebo
+{
+  namespace physics
+  {
+    class ModelLocalUpdateGroupPrivate;
+
+    /// \addtogroup gazebo_physics
+    /// \{
+
+    /// \class ModelLocalUpdateGroup ModelLocalUpdateGroup.hh
+    /// physics/physics.hh
+    /// \brief Update callbacks that only touch their own model.
+    ///
+    /// Callbacks are grouped by model. On every world update, after the
+    /// worldUpdateBegin event and before physics, the groups run
+    /// concurrently on the TBB worker pool while the callbacks of a given
+    /// model run in connection order. Callbacks that touch the whole world
+    /// must connect to event::Events::ConnectWorldUpdateBegin instead.
+    ///
+    /// In debug builds, entities modified by a callback are checked to
+    /// belong to the callback's model, see GZ_CHECK_MODEL_LOCAL.
+    class GZ_PHYSICS_VISIBLE ModelLocalUpdateGroup : public event::Event
+    {
+      /// \brief Constructor.
+      public: ModelLocalUpdateGroup();
+
+      /// \brief Destructor.
+      public: virtual ~ModelLocalUpdateGroup();
+
+      /// \brief Connect a model-local callback.
+      /// \param[in] _model Model the callback is local to.
+      /// \param[in] _subscriber Callback.
+      /// \return Connection, the callback is disconnected when it goes out
+      /// of scope.
+      public: event::ConnectionPtr Connect(ModelPtr _model,
+                  const std::function<void (const common::UpdateInfo &)>
+                  &_subscriber);
+
+      // Documentation inherited
+      public: virtual void Disconnect(int _id);
+
+      /// \brief Get the number of connected callbacks.
+      /// \return Number of callbacks.
+      public: unsigned int ConnectionCount() const;
+
+      /// \brief Run all the callbacks.
+      /// \param[in] _info World update information.
+      public: void Run(const common::UpdateInfo &_info);
+
+      /// \brief Report an error if a model-local callback running on the
+      /// current thread modifies an entity that does not belong to its
+      /// model. Use through GZ_CHECK_MODEL_LOCAL.
+      /// \param[in] _entity Entity being modified.
+      public: static void CheckAccess(const Base *_entity);
+
+      /// \internal
+      /// \brief Private data pointer.
+      private: std::unique_ptr<ModelLocalUpdateGroupPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
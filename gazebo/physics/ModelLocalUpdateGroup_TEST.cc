@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <vector>
+
+#include "gazebo/physics/ModelLocalUpdateGroup.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+
+class ModelLocalUpdateGroupTest : public ServerFixture
+{
+};
+
+/////////////////////////////////////////////////
+TEST_F(ModelLocalUpdateGroupTest, Connect)
+{
+  physics::ModelLocalUpdateGroup group;
+  EXPECT_EQ(group.ConnectionCount(), 0u);
+
+  // A model is required
+  event::ConnectionPtr conn = group.Connect(nullptr,
+      [](const common::UpdateInfo &) {});
+  EXPECT_TRUE(conn == nullptr);
+  EXPECT_EQ(group.ConnectionCount(), 0u);
+
+  // Running without callbacks does nothing
+  group.Run(common::UpdateInfo());
+  EXPECT_FALSE(group.Signaled());
+}
+
+/////////////////////////////////////////////////
+TEST_F(ModelLocalUpdateGroupTest, Run)
+{
+  Load("worlds/empty.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  SpawnBox("box_0", ignition::math::Vector3d::One,
+      ignition::math::Vector3d(0, 0, 0.5));
+  SpawnBox("box_1", ignition::math::Vector3d::One,
+      ignition::math::Vector3d(2, 0, 0.5));
+  physics::ModelPtr box0 = world->ModelByName("box_0");
+  physics::ModelPtr box1 = world->ModelByName("box_1");
+  ASSERT_TRUE(box0 != nullptr);
+  ASSERT_TRUE(box1 != nullptr);
+
+  // Two callbacks on the same model run in connection order
+  std::vector<int> order;
+  std::atomic<int> count1(0);
+  event::ConnectionPtr c0a = world->ConnectModelLocalUpdate(box0,
+      [&order](const common::UpdateInfo &) { order.push_back(0); });
+  event::ConnectionPtr c0b = world->ConnectModelLocalUpdate(box0,
+      [&order](const common::UpdateInfo &) { order.push_back(1); });
+  event::ConnectionPtr c1 = world->ConnectModelLocalUpdate(box1,
+      [&count1, box1](const common::UpdateInfo &)
+      {
+        box1->GetLink()->AddForce(ignition::math::Vector3d(1, 0, 0));
+        ++count1;
+      });
+
+  world->Step(10);
+  ASSERT_EQ(order.size(), 20u);
+  for (unsigned int i = 0; i < order.size(); ++i)
+    EXPECT_EQ(order[i], static_cast<int>(i % 2));
+  EXPECT_EQ(count1, 10);
+
+  // Disconnect
+  c1.reset();
+  c0b.reset();
+  world->Step(10);
+  EXPECT_EQ(order.size(), 30u);
+  EXPECT_EQ(count1, 10);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
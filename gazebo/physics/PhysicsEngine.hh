@@ -20,6 +20,7 @@
 #include <boost/thread/recursive_mutex.hpp>
 #include <boost/any.hpp>
 #include <string>
+#include <vector>
 #include <ignition/transport/Node.hh>
 
 #include "gazebo/transport/TransportTypes.hh"
@@ -61,6 +62,23 @@ namespace gazebo
       /// \brief Rest the physics engine.
       public: virtual void Reset() {}
 
+      /// \brief Save the engine's own simulation state, including values
+      /// carried from one step to the next that the entity API does not
+      /// expose, such as solver warm start values. See World::Snapshot.
+      /// \param[out] _state Opaque state of the engine.
+      /// \return False if the engine does not support snapshots.
+      public: virtual bool SaveSnapshot(std::vector<uint8_t> &/*_state*/)
+              {return false;}
+
+      /// \brief Restore a state saved by SaveSnapshot, while the world has
+      /// the same entities. The engine must update the poses of the links
+      /// as it does after a step, e.g. by adding them to the world's dirty
+      /// poses. See World::Restore.
+      /// \param[in] _state State saved by SaveSnapshot.
+      /// \return False if the state does not match the engine.
+      public: virtual bool RestoreSnapshot(
+                  const std::vector<uint8_t> &/*_state*/) {return false;}
+
       /// \brief Init the engine for threads.
       public: virtual void InitForThread() = 0;
 
@@ -18,6 +18,7 @@
 #define _PHYSICSIFACE_HH_
 
 #include <string>
+#include <vector>
 #include <sdf/sdf.hh>
 
 #include "gazebo/physics/PhysicsTypes.hh"
@@ -61,6 +62,11 @@ namespace gazebo
     GZ_PHYSICS_VISIBLE
     bool has_world(const std::string &_name = "");
 
+    /// \brief Get all the worlds of this process.
+    /// \return Pointers to the worlds, in the order they were created.
+    GZ_PHYSICS_VISIBLE
+    std::vector<WorldPtr> get_worlds();
+
     /// \brief Load world from sdf::Element pointer.
     /// \param[in] _world Pointer to a world.
     /// \param[in] _sdf SDF values to load from.
@@ -52,6 +52,8 @@ namespace gazebo
     class UserCmdManager;
     class PhysicsEngine;
     class Wind;
+    class SpatialIndex;
+    class StepBuffers;
     class Atmosphere;
     class Mass;
     class Road;
@@ -72,6 +74,7 @@ namespace gazebo
     class LinkState;
     class JointState;
     class TrajectoryInfo;
+    class WorldSnapshot;
 
     /// \def BasePtr
     /// \brief Boost shared pointer to a Base object
@@ -137,6 +140,10 @@ namespace gazebo
     /// \brief Shared pointer to a UserCmdManager object
     typedef std::shared_ptr<UserCmdManager> UserCmdManagerPtr;
 
+    /// \def  WorldSnapshotPtr
+    /// \brief Shared pointer to a WorldSnapshot object
+    typedef std::shared_ptr<WorldSnapshot> WorldSnapshotPtr;
+
     /// \def ShapePtr
     /// \brief Boost shared pointer to a Shape object
     typedef boost::shared_ptr<Shape> ShapePtr;
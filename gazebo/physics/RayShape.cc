@@ -14,6 +14,7 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
 #include <vector>
 #include <list>
 #include <string>
@@ -109,6 +110,32 @@ void RayShape::GlobalPoints(ignition::math::Vector3d &_posA,
   _posB = this->globalEndPos;
 }
 
+//////////////////////////////////////////////////
+void RayShape::Intersections(
+    const std::vector<ignition::math::Vector3d> &_starts,
+    const std::vector<ignition::math::Vector3d> &_ends,
+    std::vector<double> &_dists, std::vector<std::string> &_entities)
+{
+  const size_t count = std::min(_starts.size(), _ends.size());
+  _dists.resize(count);
+  _entities.resize(count);
+
+  const ignition::math::Vector3d start = this->relativeStartPos;
+  const ignition::math::Vector3d end = this->relativeEndPos;
+  const CollisionPtr parent = this->collisionParent;
+
+  // Segments are in the world frame
+  this->collisionParent.reset();
+  for (size_t i = 0; i < count; ++i)
+  {
+    this->SetPoints(_starts[i], _ends[i]);
+    this->GetIntersection(_dists[i], _entities[i]);
+  }
+
+  this->collisionParent = parent;
+  this->SetPoints(start, end);
+}
+
 //////////////////////////////////////////////////
 void RayShape::SetLength(double _len)
 {
@@ -18,6 +18,9 @@
 #define GAZEBO_PHYSICS_RAYSHAPE_HH_
 
 #include <string>
+#include <vector>
+#include <ignition/math/Vector3.hh>
+
 
 #include "gazebo/physics/PhysicsTypes.hh"
 #include "gazebo/physics/Shape.hh"
@@ -92,6 +95,24 @@ namespace gazebo
       public: virtual void GetIntersection(double &_dist,
                                            std::string &_entity) = 0;
 
+      /// \brief Get the nearest intersections of many segments at once.
+      /// The segments are in the world frame, and the points of this ray
+      /// are left unchanged. The caller should hold the physics update
+      /// mutex, see PhysicsEngine::GetPhysicsUpdateMutex, so the world does
+      /// not move during the batch. Engines may test the segments in
+      /// parallel.
+      /// \param[in] _starts Start of each segment.
+      /// \param[in] _ends End of each segment, one per start.
+      /// \param[out] _dists Distance to the nearest intersection of each
+      /// segment, see GetIntersection.
+      /// \param[out] _entities Name of the entity each segment intersected
+      /// with, empty if none.
+      public: virtual void Intersections(
+                  const std::vector<ignition::math::Vector3d> &_starts,
+                  const std::vector<ignition::math::Vector3d> &_ends,
+                  std::vector<double> &_dists,
+                  std::vector<std::string> &_entities);
+
       /// \brief Set the retro-reflectivness detected by this ray.
       /// \param[in] _retro Retro reflectance value.
       public: void SetRetro(float _retro);
@@ -0,0 +1,1003 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <ignition/common/Profiler.hh>
+#include <ignition/math/Helpers.hh>
+
+#include "gazebo/physics/Link.hh"
+#include "gazebo/physics/Model.hh"
+#include "gazebo/physics/SpatialIndex.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+namespace
+{
+  /// \brief Margin added around the boxes stored in the tree, in meters.
+  const double fatMargin = 0.1;
+
+  /// \brief Bound of the boxes stored in the tree, which keeps the boxes
+  /// of infinite shapes, such as planes, finite.
+  const double maxExtent = 1e12;
+
+  /// \brief Index of a missing node.
+  const int nullNode = -1;
+
+  /// \brief Axis aligned box, without the validity bookkeeping of
+  /// ignition::math::AxisAlignedBox.
+  struct Box
+  {
+    /// \brief Minimum corner.
+    ignition::math::Vector3d min;
+
+    /// \brief Maximum corner.
+    ignition::math::Vector3d max;
+  };
+
+  /// \brief Get the smallest box containing two boxes.
+  /// \param[in] _a First box.
+  /// \param[in] _b Second box.
+  /// \return The union.
+  Box Union(const Box &_a, const Box &_b)
+  {
+    Box result;
+    result.min.Set(std::min(_a.min.X(), _b.min.X()),
+        std::min(_a.min.Y(), _b.min.Y()), std::min(_a.min.Z(), _b.min.Z()));
+    result.max.Set(std::max(_a.max.X(), _b.max.X()),
+        std::max(_a.max.Y(), _b.max.Y()), std::max(_a.max.Z(), _b.max.Z()));
+    return result;
+  }
+
+  /// \brief Get the surface area of a box, the cost used to build the tree.
+  /// \param[in] _box The box.
+  /// \return Surface area.
+  double Area(const Box &_box)
+  {
+    const ignition::math::Vector3d d = _box.max - _box.min;
+    return 2.0 * (d.X() * d.Y() + d.Y() * d.Z() + d.Z() * d.X());
+  }
+
+  /// \brief Check whether a box contains another one.
+  /// \param[in] _outer Outer box.
+  /// \param[in] _inner Inner box.
+  /// \return True if _inner is inside _outer.
+  bool Contains(const Box &_outer, const Box &_inner)
+  {
+    return _outer.min.X() <= _inner.min.X() &&
+           _outer.min.Y() <= _inner.min.Y() &&
+           _outer.min.Z() <= _inner.min.Z() &&
+           _outer.max.X() >= _inner.max.X() &&
+           _outer.max.Y() >= _inner.max.Y() &&
+           _outer.max.Z() >= _inner.max.Z();
+  }
+
+  /// \brief Check whether two boxes overlap. Touching boxes overlap.
+  /// \param[in] _a First box.
+  /// \param[in] _b Second box.
+  /// \return True if the boxes overlap.
+  bool Overlaps(const Box &_a, const Box &_b)
+  {
+    return _a.min.X() <= _b.max.X() && _a.max.X() >= _b.min.X() &&
+           _a.min.Y() <= _b.max.Y() && _a.max.Y() >= _b.min.Y() &&
+           _a.min.Z() <= _b.max.Z() && _a.max.Z() >= _b.min.Z();
+  }
+
+  /// \brief Check whether a box overlaps a sphere.
+  /// \param[in] _box The box.
+  /// \param[in] _center Center of the sphere.
+  /// \param[in] _radius Radius of the sphere.
+  /// \return True if they overlap.
+  bool OverlapsSphere(const Box &_box, const ignition::math::Vector3d &_center,
+      const double _radius)
+  {
+    double dist2 = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+      double d = 0;
+      if (_center[i] < _box.min[i])
+        d = _box.min[i] - _center[i];
+      else if (_center[i] > _box.max[i])
+        d = _center[i] - _box.max[i];
+      dist2 += d * d;
+    }
+    return dist2 <= _radius * _radius;
+  }
+
+  /// \brief Intersect a segment with a box.
+  /// \param[in] _box The box.
+  /// \param[in] _start Start of the segment.
+  /// \param[in] _dir End of the segment minus its start.
+  /// \param[out] _t Fraction of the segment where it enters the box, 0 if
+  /// it starts inside.
+  /// \return True if the segment intersects the box.
+  bool IntersectsSegment(const Box &_box,
+      const ignition::math::Vector3d &_start,
+      const ignition::math::Vector3d &_dir, double &_t)
+  {
+    double tMin = 0;
+    double tMax = 1;
+    for (int i = 0; i < 3; ++i)
+    {
+      if (std::abs(_dir[i]) < 1e-12)
+      {
+        if (_start[i] < _box.min[i] || _start[i] > _box.max[i])
+          return false;
+        continue;
+      }
+
+      double t1 = (_box.min[i] - _start[i]) / _dir[i];
+      double t2 = (_box.max[i] - _start[i]) / _dir[i];
+      if (t1 > t2)
+        std::swap(t1, t2);
+      tMin = std::max(tMin, t1);
+      tMax = std::min(tMax, t2);
+      if (tMin > tMax)
+        return false;
+    }
+    _t = tMin;
+    return true;
+  }
+
+  /// \brief Convert a bounding box, clamped to the bounds of the tree.
+  /// \param[in] _box Bounding box.
+  /// \param[in] _margin Margin added on each side.
+  /// \return The box.
+  Box ToBox(const ignition::math::AxisAlignedBox &_box, const double _margin)
+  {
+    Box result;
+    for (int i = 0; i < 3; ++i)
+    {
+      result.min[i] = ignition::math::clamp(_box.Min()[i] - _margin,
+          -maxExtent, maxExtent);
+      result.max[i] = ignition::math::clamp(_box.Max()[i] + _margin,
+          -maxExtent, maxExtent);
+    }
+    return result;
+  }
+
+  /// \brief Check whether a bounding box is valid. The boxes of links
+  /// without collisions are inverted.
+  /// \param[in] _box Bounding box.
+  /// \return True if the box is valid.
+  bool IsValid(const ignition::math::AxisAlignedBox &_box)
+  {
+    // Comparisons with NaN are false
+    return _box.Min().X() <= _box.Max().X() &&
+           _box.Min().Y() <= _box.Max().Y() &&
+           _box.Min().Z() <= _box.Max().Z();
+  }
+
+  /// \brief Dynamic AABB tree. Leaves hold enlarged boxes of the entries,
+  /// internal nodes the union of their children, and insertions pick the
+  /// sibling that grows the tree's surface area the least. The tree is kept
+  /// balanced with rotations.
+  class Tree
+  {
+    /// \brief Node of the tree.
+    private: struct Node
+    {
+      /// \brief Enlarged box of a leaf, union of the children otherwise.
+      Box box;
+
+      /// \brief Parent node, or next free node.
+      int parent = nullNode;
+
+      /// \brief First child, nullNode for leaves.
+      int child1 = nullNode;
+
+      /// \brief Second child.
+      int child2 = nullNode;
+
+      /// \brief Height of the subtree, 0 for leaves, -1 for free nodes.
+      int height = -1;
+
+      /// \brief Data of a leaf.
+      void *data = nullptr;
+    };
+
+    /// \brief Insert a leaf.
+    /// \param[in] _box Enlarged box of the leaf.
+    /// \param[in] _data Data of the leaf.
+    /// \return Index of the leaf.
+    public: int Insert(const Box &_box, void *_data)
+    {
+      const int leaf = this->Allocate();
+      this->nodes[leaf].box = _box;
+      this->nodes[leaf].data = _data;
+      this->nodes[leaf].height = 0;
+      this->InsertLeaf(leaf);
+      return leaf;
+    }
+
+    /// \brief Remove a leaf.
+    /// \param[in] _leaf Index of the leaf.
+    public: void Remove(const int _leaf)
+    {
+      this->RemoveLeaf(_leaf);
+      this->Free(_leaf);
+    }
+
+    /// \brief Move a leaf, if its box no longer contains the entry.
+    /// \param[in] _leaf Index of the leaf.
+    /// \param[in] _tight Box of the entry.
+    /// \param[in] _fat Enlarged box of the entry.
+    public: void Move(const int _leaf, const Box &_tight, const Box &_fat)
+    {
+      if (Contains(this->nodes[_leaf].box, _tight))
+        return;
+
+      this->RemoveLeaf(_leaf);
+      this->nodes[_leaf].box = _fat;
+      this->InsertLeaf(_leaf);
+    }
+
+    /// \brief Visit the leaves whose ancestors all pass a test.
+    /// \param[in] _test Test of the box of a node.
+    /// \param[in] _visit Called with the data of each leaf found.
+    public: template<typename Test, typename Visit>
+            void Query(const Test &_test, const Visit &_visit) const
+    {
+      if (this->root == nullNode)
+        return;
+
+      std::vector<int> &stack = this->stack;
+      stack.clear();
+      stack.push_back(this->root);
+      while (!stack.empty())
+      {
+        const Node &node = this->nodes[stack.back()];
+        stack.pop_back();
+
+        if (!_test(node.box))
+          continue;
+
+        if (node.child1 == nullNode)
+        {
+          _visit(node.data);
+        }
+        else
+        {
+          stack.push_back(node.child1);
+          stack.push_back(node.child2);
+        }
+      }
+    }
+
+    /// \brief Get a free node.
+    /// \return Index of the node.
+    private: int Allocate()
+    {
+      if (this->freeList == nullNode)
+      {
+        this->nodes.emplace_back();
+        return static_cast<int>(this->nodes.size()) - 1;
+      }
+
+      const int index = this->freeList;
+      this->freeList = this->nodes[index].parent;
+      this->nodes[index] = Node();
+      return index;
+    }
+
+    /// \brief Return a node to the free list.
+    /// \param[in] _index Index of the node.
+    private: void Free(const int _index)
+    {
+      this->nodes[_index].parent = this->freeList;
+      this->nodes[_index].height = -1;
+      this->nodes[_index].data = nullptr;
+      this->freeList = _index;
+    }
+
+    /// \brief Link a leaf into the tree.
+    /// \param[in] _leaf Index of the leaf.
+    private: void InsertLeaf(const int _leaf)
+    {
+      if (this->root == nullNode)
+      {
+        this->root = _leaf;
+        this->nodes[_leaf].parent = nullNode;
+        return;
+      }
+
+      // Find the best sibling
+      const Box leafBox = this->nodes[_leaf].box;
+      int index = this->root;
+      while (this->nodes[index].child1 != nullNode)
+      {
+        const Node &node = this->nodes[index];
+        const double area = Area(node.box);
+        const double combinedArea = Area(Union(node.box, leafBox));
+
+        // Cost of creating a new parent for this node and the leaf
+        const double cost = 2.0 * combinedArea;
+
+        // Minimum cost of pushing the leaf further down the tree
+        const double inheritanceCost = 2.0 * (combinedArea - area);
+
+        double cost1 = this->DescendCost(node.child1, leafBox) +
+          inheritanceCost;
+        double cost2 = this->DescendCost(node.child2, leafBox) +
+          inheritanceCost;
+
+        if (cost < cost1 && cost < cost2)
+          break;
+
+        index = cost1 < cost2 ? node.child1 : node.child2;
+      }
+      const int sibling = index;
+
+      // Create a new parent
+      const int oldParent = this->nodes[sibling].parent;
+      const int newParent = this->Allocate();
+      Node &parent = this->nodes[newParent];
+      parent.parent = oldParent;
+      parent.box = Union(leafBox, this->nodes[sibling].box);
+      parent.height = this->nodes[sibling].height + 1;
+      parent.child1 = sibling;
+      parent.child2 = _leaf;
+      this->nodes[sibling].parent = newParent;
+      this->nodes[_leaf].parent = newParent;
+
+      if (oldParent == nullNode)
+      {
+        this->root = newParent;
+      }
+      else if (this->nodes[oldParent].child1 == sibling)
+      {
+        this->nodes[oldParent].child1 = newParent;
+      }
+      else
+      {
+        this->nodes[oldParent].child2 = newParent;
+      }
+
+      this->Refit(this->nodes[_leaf].parent);
+    }
+
+    /// \brief Get the cost of inserting a box below a node.
+    /// \param[in] _index Index of the node.
+    /// \param[in] _box Box to insert.
+    /// \return Cost.
+    private: double DescendCost(const int _index, const Box &_box) const
+    {
+      const Node &node = this->nodes[_index];
+      const double combinedArea = Area(Union(node.box, _box));
+      if (node.child1 == nullNode)
+        return combinedArea;
+      return combinedArea - Area(node.box);
+    }
+
+    /// \brief Unlink a leaf from the tree, without freeing it.
+    /// \param[in] _leaf Index of the leaf.
+    private: void RemoveLeaf(const int _leaf)
+    {
+      if (_leaf == this->root)
+      {
+        this->root = nullNode;
+        return;
+      }
+
+      const int parent = this->nodes[_leaf].parent;
+      const int grandParent = this->nodes[parent].parent;
+      const int sibling = this->nodes[parent].child1 == _leaf ?
+        this->nodes[parent].child2 : this->nodes[parent].child1;
+
+      if (grandParent == nullNode)
+      {
+        this->root = sibling;
+        this->nodes[sibling].parent = nullNode;
+        this->Free(parent);
+        return;
+      }
+
+      if (this->nodes[grandParent].child1 == parent)
+        this->nodes[grandParent].child1 = sibling;
+      else
+        this->nodes[grandParent].child2 = sibling;
+      this->nodes[sibling].parent = grandParent;
+      this->Free(parent);
+
+      this->Refit(grandParent);
+    }
+
+    /// \brief Balance and update the boxes of a node and its ancestors.
+    /// \param[in] _index Index of the first node.
+    private: void Refit(int _index)
+    {
+      while (_index != nullNode)
+      {
+        _index = this->Balance(_index);
+
+        Node &node = this->nodes[_index];
+        const Node &child1 = this->nodes[node.child1];
+        const Node &child2 = this->nodes[node.child2];
+        node.height = 1 + std::max(child1.height, child2.height);
+        node.box = Union(child1.box, child2.box);
+
+        _index = node.parent;
+      }
+    }
+
+    /// \brief Rotate a node up if its subtree is unbalanced.
+    /// \param[in] _a Index of the node.
+    /// \return Index of the node now at the position of _a.
+    private: int Balance(const int _a)
+    {
+      Node &a = this->nodes[_a];
+      if (a.child1 == nullNode || a.height < 2)
+        return _a;
+
+      const int b = a.child1;
+      const int c = a.child2;
+      const int balance = this->nodes[c].height - this->nodes[b].height;
+
+      if (balance > 1)
+        return this->Rotate(_a, c, b);
+      if (balance < -1)
+        return this->Rotate(_a, b, c);
+      return _a;
+    }
+
+    /// \brief Rotate the taller child of a node up.
+    /// \param[in] _a Index of the node.
+    /// \param[in] _up Index of the taller child.
+    /// \param[in] _other Index of the other child.
+    /// \return Index of the node now at the position of _a.
+    private: int Rotate(const int _a, const int _up, const int _other)
+    {
+      Node &a = this->nodes[_a];
+      Node &up = this->nodes[_up];
+      const int f = up.child1;
+      const int g = up.child2;
+
+      // Swap A and its child
+      up.child1 = _a;
+      up.parent = a.parent;
+      a.parent = _up;
+
+      if (up.parent == nullNode)
+        this->root = _up;
+      else if (this->nodes[up.parent].child1 == _a)
+        this->nodes[up.parent].child1 = _up;
+      else
+        this->nodes[up.parent].child2 = _up;
+
+      // Keep the taller grandchild below the rotated child
+      int keep = f;
+      int move = g;
+      if (this->nodes[f].height < this->nodes[g].height)
+        std::swap(keep, move);
+
+      up.child2 = keep;
+      if (a.child1 == _up)
+        a.child1 = move;
+      else
+        a.child2 = move;
+      this->nodes[move].parent = _a;
+
+      const Node &other = this->nodes[_other];
+      const Node &moved = this->nodes[move];
+      a.box = Union(other.box, moved.box);
+      a.height = 1 + std::max(other.height, moved.height);
+      up.box = Union(a.box, this->nodes[keep].box);
+      up.height = 1 + std::max(a.height, this->nodes[keep].height);
+
+      return _up;
+    }
+
+    /// \brief All nodes, including free ones.
+    private: std::vector<Node> nodes;
+
+    /// \brief Root node.
+    private: int root = nullNode;
+
+    /// \brief First free node.
+    private: int freeList = nullNode;
+
+    /// \brief Stack reused by queries.
+    private: mutable std::vector<int> stack;
+  };
+
+  /// \brief A link or a model in the index.
+  struct Entry
+  {
+    /// \brief The link or model.
+    Entity *entity = nullptr;
+
+    /// \brief Model entry of a link, nullptr for models.
+    Entry *model = nullptr;
+
+    /// \brief Link entries of a model.
+    std::vector<Entry *> links;
+
+    /// \brief Bounding box.
+    Box box;
+
+    /// \brief Exact bounding box, tested by the frustum queries.
+    ignition::math::AxisAlignedBox aabb;
+
+    /// \brief True if the entity has a bounding box.
+    bool valid = false;
+
+    /// \brief Leaf of the entity, nullNode if it is not in the tree.
+    int leaf = nullNode;
+
+    /// \brief True if the bounding box must be refreshed.
+    bool dirty = false;
+
+    /// \brief Order in which the entry was added.
+    uint64_t seq = 0;
+  };
+}
+
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \internal
+    /// \brief Private data for SpatialIndex.
+    class SpatialIndexPrivate
+    {
+      /// \brief Mark a link entry dirty.
+      /// \param[in] _entry Link entry.
+      public: void MarkDirty(Entry &_entry)
+      {
+        if (!_entry.dirty)
+        {
+          _entry.dirty = true;
+          this->dirtyLinks.push_back(&_entry);
+        }
+      }
+
+      /// \brief Mark a model entry dirty.
+      /// \param[in] _entry Model entry.
+      public: void MarkModelDirty(Entry &_entry)
+      {
+        if (!_entry.dirty)
+        {
+          _entry.dirty = true;
+          this->dirtyModels.push_back(&_entry);
+        }
+      }
+
+      /// \brief Insert, move or remove the leaf of an entry after its box
+      /// changed.
+      /// \param[in] _tree Tree of the entry.
+      /// \param[in] _entry The entry.
+      public: void UpdateLeaf(Tree &_tree, Entry &_entry)
+      {
+        if (!_entry.valid)
+        {
+          if (_entry.leaf != nullNode)
+          {
+            _tree.Remove(_entry.leaf);
+            _entry.leaf = nullNode;
+          }
+          return;
+        }
+
+        const Box fat = ToBox(_entry.aabb, fatMargin);
+        if (_entry.leaf == nullNode)
+          _entry.leaf = _tree.Insert(fat, &_entry);
+        else
+          _tree.Move(_entry.leaf, _entry.box, fat);
+      }
+
+      /// \brief Refresh the boxes of the dirty entries. Called with the
+      /// mutex locked, before each query.
+      public: void Flush()
+      {
+        IGN_PROFILE("SpatialIndex::Flush");
+        if (!this->queried)
+        {
+          // Boxes are not tracked until the first query
+          this->queried = true;
+          for (auto &link : this->links)
+            this->MarkDirty(link.second);
+        }
+
+        for (Entry *entry : this->dirtyLinks)
+        {
+          entry->dirty = false;
+          entry->aabb = entry->entity->BoundingBox();
+          entry->valid = IsValid(entry->aabb);
+          if (entry->valid)
+            entry->box = ToBox(entry->aabb, 0);
+          this->UpdateLeaf(this->linkTree, *entry);
+          this->MarkModelDirty(*entry->model);
+        }
+        this->dirtyLinks.clear();
+
+        for (Entry *entry : this->dirtyModels)
+        {
+          entry->dirty = false;
+          entry->valid = false;
+          for (const Entry *link : entry->links)
+          {
+            if (!link->valid)
+              continue;
+
+            if (!entry->valid)
+              entry->aabb = link->aabb;
+            else
+              entry->aabb += link->aabb;
+            entry->valid = true;
+          }
+          if (entry->valid)
+          {
+            entry->box = ToBox(entry->aabb, 0);
+            this->boxlessModels.erase(entry);
+          }
+          else
+          {
+            this->boxlessModels.insert(entry);
+          }
+          this->UpdateLeaf(this->modelTree, *entry);
+        }
+        this->dirtyModels.clear();
+      }
+
+      /// \brief Find the entries of a tree that pass a test. The mutex must
+      /// be locked.
+      /// \param[in] _tree The tree.
+      /// \param[in] _test Test of a box.
+      /// \return Entries, in the order they were added.
+      public: template<typename Test>
+              std::vector<Entry *> Query(const Tree &_tree, const Test &_test)
+      {
+        this->Flush();
+
+        std::vector<Entry *> result;
+        _tree.Query(_test, [&](void *_data)
+            {
+              Entry *entry = static_cast<Entry *>(_data);
+              if (_test(entry->box))
+                result.push_back(entry);
+            });
+        std::sort(result.begin(), result.end(),
+            [](const Entry *_a, const Entry *_b)
+            {
+              return _a->seq < _b->seq;
+            });
+        return result;
+      }
+
+      /// \brief Get the models of entries.
+      /// \param[in] _entries Model entries.
+      /// \return The models.
+      public: static Model_V ToModels(const std::vector<Entry *> &_entries)
+      {
+        Model_V models;
+        models.reserve(_entries.size());
+        for (const Entry *entry : _entries)
+        {
+          models.push_back(boost::static_pointer_cast<Model>(
+                entry->entity->shared_from_this()));
+        }
+        return models;
+      }
+
+      /// \brief Get the links of entries.
+      /// \param[in] _entries Link entries.
+      /// \return The links.
+      public: static Link_V ToLinks(const std::vector<Entry *> &_entries)
+      {
+        Link_V links;
+        links.reserve(_entries.size());
+        for (const Entry *entry : _entries)
+        {
+          links.push_back(boost::static_pointer_cast<Link>(
+                entry->entity->shared_from_this()));
+        }
+        return links;
+      }
+
+      /// \brief Link entries.
+      public: std::unordered_map<const Entity *, Entry> links;
+
+      /// \brief Model entries.
+      public: std::unordered_map<const Entity *, Entry> models;
+
+      /// \brief Tree of the link entries.
+      public: Tree linkTree;
+
+      /// \brief Tree of the model entries.
+      public: Tree modelTree;
+
+      /// \brief Link entries to refresh.
+      public: std::vector<Entry *> dirtyLinks;
+
+      /// \brief Model entries to refresh.
+      public: std::vector<Entry *> dirtyModels;
+
+      /// \brief Model entries without a bounding box.
+      public: std::unordered_set<Entry *> boxlessModels;
+
+      /// \brief Order of the next entry.
+      public: uint64_t seq = 0;
+
+      /// \brief True once the index has been queried. Until then, moved
+      /// entities are not tracked.
+      public: std::atomic<bool> queried{false};
+
+      /// \brief Protects all the members.
+      public: std::mutex mutex;
+    };
+  }
+}
+
+//////////////////////////////////////////////////
+SpatialIndex::SpatialIndex()
+  : dataPtr(new SpatialIndexPrivate)
+{
+}
+
+//////////////////////////////////////////////////
+SpatialIndex::~SpatialIndex()
+{
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::AddLink(Link *_link)
+{
+  Model *model = _link->GetModel().get();
+  if (!model)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (this->dataPtr->links.count(_link))
+    return;
+
+  auto modelIter = this->dataPtr->models.find(model);
+  if (modelIter == this->dataPtr->models.end())
+  {
+    Entry &entry = this->dataPtr->models[model];
+    entry.entity = model;
+    entry.seq = this->dataPtr->seq++;
+    modelIter = this->dataPtr->models.find(model);
+  }
+
+  Entry &entry = this->dataPtr->links[_link];
+  entry.entity = _link;
+  entry.model = &modelIter->second;
+  entry.seq = this->dataPtr->seq++;
+  modelIter->second.links.push_back(&entry);
+
+  // The box is computed by the next query
+  this->dataPtr->MarkDirty(entry);
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::RemoveLink(Link *_link)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto iter = this->dataPtr->links.find(_link);
+  if (iter == this->dataPtr->links.end())
+    return;
+
+  Entry &entry = iter->second;
+  Entry &model = *entry.model;
+
+  if (entry.leaf != nullNode)
+    this->dataPtr->linkTree.Remove(entry.leaf);
+  if (entry.dirty)
+  {
+    auto &dirty = this->dataPtr->dirtyLinks;
+    dirty.erase(std::find(dirty.begin(), dirty.end(), &entry));
+  }
+  model.links.erase(std::find(model.links.begin(), model.links.end(),
+        &entry));
+  this->dataPtr->links.erase(iter);
+
+  if (!model.links.empty())
+  {
+    this->dataPtr->MarkModelDirty(model);
+    return;
+  }
+
+  // Remove the model with its last link
+  if (model.leaf != nullNode)
+    this->dataPtr->modelTree.Remove(model.leaf);
+  if (model.dirty)
+  {
+    auto &dirty = this->dataPtr->dirtyModels;
+    dirty.erase(std::find(dirty.begin(), dirty.end(), &model));
+  }
+  this->dataPtr->boxlessModels.erase(&model);
+  this->dataPtr->models.erase(model.entity);
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::MarkDirty(Entity *_entity)
+{
+  if (!this->dataPtr->queried)
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto iter = this->dataPtr->links.find(_entity);
+  if (iter != this->dataPtr->links.end())
+    this->dataPtr->MarkDirty(iter->second);
+}
+
+//////////////////////////////////////////////////
+void SpatialIndex::MarkDirty(const std::list<Entity *> &_entities)
+{
+  if (!this->dataPtr->queried || _entities.empty())
+    return;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  for (Entity *entity : _entities)
+  {
+    auto iter = this->dataPtr->links.find(entity);
+    if (iter != this->dataPtr->links.end())
+      this->dataPtr->MarkDirty(iter->second);
+  }
+}
+
+//////////////////////////////////////////////////
+unsigned int SpatialIndex::LinkCount() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->links.size();
+}
+
+//////////////////////////////////////////////////
+Model_V SpatialIndex::ModelsInFrustum(const ignition::math::Frustum &_frustum)
+{
+  IGN_PROFILE("SpatialIndex::ModelsInFrustum");
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  // Frustum::Contains is true for boxes that intersect the frustum.
+  // Leaves are tested with the exact bounding box of the model.
+  std::vector<Entry *> entries;
+  this->dataPtr->Flush();
+  this->dataPtr->modelTree.Query(
+      [&](const Box &_box)
+      {
+        return _frustum.Contains(
+            ignition::math::AxisAlignedBox(_box.min, _box.max));
+      },
+      [&](void *_data)
+      {
+        Entry *entry = static_cast<Entry *>(_data);
+        if (_frustum.Contains(entry->aabb))
+          entries.push_back(entry);
+      });
+  std::sort(entries.begin(), entries.end(),
+      [](const Entry *_a, const Entry *_b)
+      {
+        return _a->seq < _b->seq;
+      });
+
+  return SpatialIndexPrivate::ToModels(entries);
+}
+
+//////////////////////////////////////////////////
+Model_V SpatialIndex::ModelsInBox(const ignition::math::AxisAlignedBox &_box)
+{
+  IGN_PROFILE("SpatialIndex::ModelsInBox");
+  const Box box = ToBox(_box, 0);
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return SpatialIndexPrivate::ToModels(this->dataPtr->Query(
+        this->dataPtr->modelTree,
+        [&](const Box &_b) {return Overlaps(_b, box);}));
+}
+
+//////////////////////////////////////////////////
+Model_V SpatialIndex::ModelsInSphere(const ignition::math::Vector3d &_center,
+    const double _radius)
+{
+  IGN_PROFILE("SpatialIndex::ModelsInSphere");
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return SpatialIndexPrivate::ToModels(this->dataPtr->Query(
+        this->dataPtr->modelTree,
+        [&](const Box &_b) {return OverlapsSphere(_b, _center, _radius);}));
+}
+
+//////////////////////////////////////////////////
+Model_V SpatialIndex::ModelsWithoutBox()
+{
+  IGN_PROFILE("SpatialIndex::ModelsWithoutBox");
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->Flush();
+
+  std::vector<Entry *> entries(this->dataPtr->boxlessModels.begin(),
+      this->dataPtr->boxlessModels.end());
+  std::sort(entries.begin(), entries.end(),
+      [](const Entry *_a, const Entry *_b)
+      {
+        return _a->seq < _b->seq;
+      });
+
+  return SpatialIndexPrivate::ToModels(entries);
+}
+
+//////////////////////////////////////////////////
+Link_V SpatialIndex::LinksInBox(const ignition::math::AxisAlignedBox &_box)
+{
+  IGN_PROFILE("SpatialIndex::LinksInBox");
+  const Box box = ToBox(_box, 0);
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return SpatialIndexPrivate::ToLinks(this->dataPtr->Query(
+        this->dataPtr->linkTree,
+        [&](const Box &_b) {return Overlaps(_b, box);}));
+}
+
+//////////////////////////////////////////////////
+Link_V SpatialIndex::LinksInSphere(const ignition::math::Vector3d &_center,
+    const double _radius)
+{
+  IGN_PROFILE("SpatialIndex::LinksInSphere");
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return SpatialIndexPrivate::ToLinks(this->dataPtr->Query(
+        this->dataPtr->linkTree,
+        [&](const Box &_b) {return OverlapsSphere(_b, _center, _radius);}));
+}
+
+//////////////////////////////////////////////////
+Link_V SpatialIndex::LinksOnRay(const ignition::math::Vector3d &_start,
+    const ignition::math::Vector3d &_end)
+{
+  IGN_PROFILE("SpatialIndex::LinksOnRay");
+  const ignition::math::Vector3d dir = _end - _start;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->Flush();
+
+  std::vector<std::pair<double, Entry *>> hits;
+  this->dataPtr->linkTree.Query(
+      [&](const Box &_box)
+      {
+        double t;
+        return IntersectsSegment(_box, _start, dir, t);
+      },
+      [&](void *_data)
+      {
+        Entry *entry = static_cast<Entry *>(_data);
+        double t;
+        if (IntersectsSegment(entry->box, _start, dir, t))
+          hits.push_back(std::make_pair(t, entry));
+      });
+  std::sort(hits.begin(), hits.end(),
+      [](const std::pair<double, Entry *> &_a,
+         const std::pair<double, Entry *> &_b)
+      {
+        if (_a.first != _b.first)
+          return _a.first < _b.first;
+        return _a.second->seq < _b.second->seq;
+      });
+
+  std::vector<Entry *> entries;
+  entries.reserve(hits.size());
+  for (const auto &hit : hits)
+    entries.push_back(hit.second);
+  return SpatialIndexPrivate::ToLinks(entries);
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_SPATIALINDEX_HH_
+#define GAZEBO_PHYSICS_SPATIALINDEX_HH_
+
+#include <list>
+#include <memory>
+#include <ignition/math/AxisAlignedBox.hh>
+#include <ignition/math/Frustum.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "gazebo/physics/PhysicsTypes.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace physics
+  {
+    // Forward declare private data.
+    class SpatialIndexPrivate;
+
+    /// \addtogroup gazebo_physics
+    /// \{
+
+    /// \class SpatialIndex SpatialIndex.hh physics/physics.hh
+    /// \brief Dynamic AABB tree of the bounding boxes of a world's links
+    /// and models, used to find the entities in a region without testing
+    /// every entity of the world. See World::SpatialIndex.
+    ///
+    /// Links are added and removed by the World as they are initialized and
+    /// finalized. Moved links are marked dirty by the World, from its list
+    /// of poses updated by the physics engine and from pose changes made
+    /// through the API. Their boxes are refreshed by the next query, so an
+    /// unused index costs nothing. The tree stores enlarged boxes, so small
+    /// motions do not change its structure.
+    ///
+    /// The bounding box of a model is the union of the bounding boxes of its
+    /// links, see Model::BoundingBox. Nested models are separate entries.
+    /// Entities without collisions have no bounding box and are never
+    /// returned by the region queries, see ModelsWithoutBox. Results are in
+    /// the order the entities were added.
+    ///
+    /// Queries refresh the boxes through the physics engine, so callers
+    /// outside the world update must hold the physics update mutex, see
+    /// PhysicsEngine::GetPhysicsUpdateMutex.
+    class GZ_PHYSICS_VISIBLE SpatialIndex
+    {
+      /// \brief Constructor.
+      public: SpatialIndex();
+
+      /// \brief Destructor.
+      public: ~SpatialIndex();
+
+      /// \brief Get the models whose bounding box intersects a frustum.
+      /// \param[in] _frustum Frustum.
+      /// \return The models.
+      public: Model_V ModelsInFrustum(
+                  const ignition::math::Frustum &_frustum);
+
+      /// \brief Get the models whose bounding box intersects a box.
+      /// \param[in] _box Axis aligned box.
+      /// \return The models.
+      public: Model_V ModelsInBox(const ignition::math::AxisAlignedBox &_box);
+
+      /// \brief Get the models whose bounding box intersects a sphere.
+      /// \param[in] _center Center of the sphere.
+      /// \param[in] _radius Radius of the sphere.
+      /// \return The models.
+      public: Model_V ModelsInSphere(const ignition::math::Vector3d &_center,
+                  const double _radius);
+
+      /// \brief Get the models that have links but no bounding box, because
+      /// none of their links has a collision. The region queries never
+      /// return them, so callers can test their poses instead.
+      /// \return The models.
+      public: Model_V ModelsWithoutBox();
+
+      /// \brief Get the links whose bounding box intersects a box.
+      /// \param[in] _box Axis aligned box.
+      /// \return The links.
+      public: Link_V LinksInBox(const ignition::math::AxisAlignedBox &_box);
+
+      /// \brief Get the links whose bounding box intersects a sphere.
+      /// \param[in] _center Center of the sphere.
+      /// \param[in] _radius Radius of the sphere.
+      /// \return The links.
+      public: Link_V LinksInSphere(const ignition::math::Vector3d &_center,
+                  const double _radius);
+
+      /// \brief Get the links whose bounding box intersects a segment.
+      /// Only the boxes are tested, the segment may miss the links'
+      /// collisions.
+      /// \param[in] _start Start of the segment.
+      /// \param[in] _end End of the segment.
+      /// \return The links, sorted by the distance from _start to their
+      /// bounding box.
+      public: Link_V LinksOnRay(const ignition::math::Vector3d &_start,
+                  const ignition::math::Vector3d &_end);
+
+      /// \brief Get the number of links in the index.
+      /// \return Number of links.
+      public: unsigned int LinkCount() const;
+
+      /// \internal
+      /// \brief Add a link. Only World should call this function.
+      /// Thread safe.
+      /// \param[in] _link The link.
+      public: void AddLink(Link *_link);
+
+      /// \internal
+      /// \brief Remove a link. Only World should call this function.
+      /// Thread safe.
+      /// \param[in] _link The link.
+      public: void RemoveLink(Link *_link);
+
+      /// \internal
+      /// \brief Mark an entity's bounding box as outdated. Entities that are
+      /// not links of the index are ignored. Only World should call this
+      /// function. Thread safe.
+      /// \param[in] _entity The entity that moved.
+      public: void MarkDirty(Entity *_entity);
+
+      /// \internal
+      /// \brief Mark the bounding boxes of entities as outdated, see
+      /// MarkDirty(Entity *). Only World should call this function.
+      /// Thread safe.
+      /// \param[in] _entities The entities that moved.
+      public: void MarkDirty(const std::list<Entity *> &_entities);
+
+      /// \internal
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<SpatialIndexPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <set>
+#include <string>
+#include <ignition/math/Frustum.hh>
+
+#include "gazebo/physics/physics.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+
+class SpatialIndexTest : public ServerFixture
+{
+};
+
+/////////////////////////////////////////////////
+/// \brief Get the names of models.
+/// \param[in] _models The models.
+/// \return Scoped names.
+std::set<std::string> Names(const physics::Model_V &_models)
+{
+  std::set<std::string> names;
+  for (auto const &model : _models)
+    names.insert(model->GetScopedName());
+  return names;
+}
+
+/////////////////////////////////////////////////
+TEST_F(SpatialIndexTest, Queries)
+{
+  Load("worlds/shapes.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::SpatialIndex &index = world->SpatialIndex();
+
+  // ground_plane, box, sphere and cylinder have one link each
+  EXPECT_EQ(index.LinkCount(), 4u);
+  EXPECT_TRUE(index.ModelsWithoutBox().empty());
+
+  // The ground plane is infinite
+  const ignition::math::AxisAlignedBox far(
+      ignition::math::Vector3d(1000, 1000, -1),
+      ignition::math::Vector3d(1001, 1001, 0));
+  EXPECT_EQ(Names(index.ModelsInBox(far)),
+      std::set<std::string>({"ground_plane"}));
+
+  // Boxes match Model::BoundingBox
+  for (auto const &name : {"box", "sphere", "cylinder"})
+  {
+    physics::ModelPtr model = world->ModelByName(name);
+    ASSERT_TRUE(model != nullptr);
+
+    const ignition::math::Vector3d center = model->BoundingBox().Center();
+    auto models = index.ModelsInSphere(center + ignition::math::Vector3d(
+          0, 0, 10), 0.1);
+    EXPECT_TRUE(models.empty());
+
+    models = index.ModelsInSphere(center, 0.1);
+    EXPECT_EQ(Names(models), std::set<std::string>({name}));
+
+    // The model rests on the ground plane
+    auto links = index.LinksInBox(model->BoundingBox());
+    EXPECT_EQ(links.size(), 2u);
+  }
+
+  // Rays return the closest link first
+  physics::ModelPtr box = world->ModelByName("box");
+  const ignition::math::Vector3d boxCenter = box->BoundingBox().Center();
+  auto links = index.LinksOnRay(boxCenter + ignition::math::Vector3d(0, 0, 5),
+      boxCenter - ignition::math::Vector3d(0, 0, 5));
+  ASSERT_EQ(links.size(), 2u);
+  EXPECT_EQ(links[0]->GetModel()->GetName(), "box");
+  EXPECT_EQ(links[1]->GetModel()->GetName(), "ground_plane");
+
+  links = index.LinksOnRay(ignition::math::Vector3d(0, 0, 10),
+      ignition::math::Vector3d(1, 1, 10));
+  EXPECT_TRUE(links.empty());
+
+  // Frustums find the models whose bounding box they contain
+  ignition::math::Frustum frustum;
+  frustum.SetNear(0.1);
+  frustum.SetFar(20);
+  frustum.SetFOV(1.0);
+  frustum.SetAspectRatio(1.0);
+  for (unsigned int i = 0; i < 36; ++i)
+  {
+    frustum.SetPose(ignition::math::Pose3d(0, 0, 2, 0, 0.2, i * 0.175));
+    std::set<std::string> expected;
+    for (auto const &model : world->Models())
+    {
+      if (frustum.Contains(model->BoundingBox()))
+        expected.insert(model->GetScopedName());
+    }
+    EXPECT_EQ(Names(index.ModelsInFrustum(frustum)), expected) << i;
+  }
+
+  // Moved models are found at their new position
+  const ignition::math::Vector3d target(50, 50, 0.5);
+  box->SetWorldPose(ignition::math::Pose3d(target, {}));
+  EXPECT_TRUE(Names(index.ModelsInSphere(boxCenter, 0.1)).count("box") == 0);
+  EXPECT_TRUE(Names(index.ModelsInSphere(target, 0.1)).count("box") == 1);
+
+  // Dropped models are found where physics moved them
+  box->SetWorldPose(ignition::math::Pose3d(target +
+        ignition::math::Vector3d(0, 0, 10), {}));
+  world->Step(2000);
+  EXPECT_TRUE(Names(index.ModelsInSphere(target, 0.1)).count("box") == 1);
+
+  // Removed models leave the index
+  world->RemoveModel("box");
+  EXPECT_EQ(index.LinkCount(), 3u);
+  EXPECT_TRUE(Names(index.ModelsInSphere(target, 0.1)).count("box") == 0);
+}
+
+/////////////////////////////////////////////////
+TEST_F(SpatialIndexTest, EntityBelowPoint)
+{
+  Load("worlds/shapes.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  physics::ModelPtr box = world->ModelByName("box");
+  ASSERT_TRUE(box != nullptr);
+  const ignition::math::Vector3d boxCenter = box->BoundingBox().Center();
+
+  physics::ModelPtr model = world->ModelBelowPoint(boxCenter +
+      ignition::math::Vector3d(0, 0, 5));
+  ASSERT_TRUE(model != nullptr);
+  EXPECT_EQ(model->GetName(), "box");
+
+  model = world->ModelBelowPoint(ignition::math::Vector3d(100, 100, 5));
+  ASSERT_TRUE(model != nullptr);
+  EXPECT_EQ(model->GetName(), "ground_plane");
+
+  EXPECT_TRUE(world->ModelBelowPoint(
+        ignition::math::Vector3d(100, 100, -5)) == nullptr);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,549 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/weak_ptr.hpp>
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/physics/Collision.hh"
+#include "gazebo/physics/ContactManager.hh"
+#include "gazebo/physics/Joint.hh"
+#include "gazebo/physics/Link.hh"
+#include "gazebo/physics/PhysicsEngine.hh"
+#include "gazebo/physics/StepBuffers.hh"
+#include "gazebo/physics/World.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+namespace
+{
+  /// \brief Name of the contact filter that keeps the contacts of the
+  /// observed links.
+  const char kContactFilter[] = "step_buffers";
+
+  /// \brief Kind of a buffer entry.
+  enum class EntryKind
+  {
+    LINK_POSE,
+    LINK_VELOCITY,
+    JOINT_POSITION,
+    JOINT_VELOCITY,
+    JOINT_EFFORT,
+    CONTACT,
+    JOINT_FORCE_COMMAND,
+    JOINT_VELOCITY_COMMAND
+  };
+
+  /// \brief An observed or commanded quantity.
+  struct Entry
+  {
+    /// \brief Kind of quantity.
+    EntryKind kind;
+
+    /// \brief Link, for link entries. The entry doesn't keep a removed
+    /// link alive.
+    boost::weak_ptr<Link> link;
+
+    /// \brief Joint, for joint entries. The entry doesn't keep a removed
+    /// joint alive.
+    boost::weak_ptr<Joint> joint;
+
+    /// \brief Joint axis.
+    unsigned int axis;
+
+    /// \brief Offset of the first value in the array.
+    std::size_t offset;
+
+    /// \brief Number of values.
+    std::size_t count;
+  };
+}
+
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \internal
+    /// \brief Private data for StepBuffers.
+    class StepBuffersPrivate
+    {
+      /// \brief Add an entry.
+      /// \param[in] _entries Observations or actions.
+      /// \param[in,out] _size Size of the array of the entries.
+      /// \param[in] _entry Entry to add, its offset is set.
+      /// \param[in] _count Number of values of the entry.
+      /// \return Offset of the entry.
+      public: int Add(std::vector<Entry> &_entries, std::size_t &_size,
+                  Entry _entry, const std::size_t _count);
+
+      /// \brief Create an entry of a joint.
+      /// \param[in] _kind Kind of entry.
+      /// \param[in] _joint Joint.
+      /// \param[in] _axis Axis of the joint.
+      /// \param[out] _entry The entry.
+      /// \return False if _joint is null or _axis is invalid.
+      public: static bool JointEntry(const EntryKind _kind,
+                  const JointPtr &_joint, const unsigned int _axis,
+                  Entry &_entry);
+
+      /// \brief Recreate the contact filter with the collisions of the
+      /// observed links.
+      public: void UpdateContactFilter();
+
+      /// \brief Protects everything below.
+      public: std::mutex mutex;
+
+      /// \brief Observed quantities.
+      public: std::vector<Entry> observations;
+
+      /// \brief Commanded quantities.
+      public: std::vector<Entry> actions;
+
+      /// \brief Number of observed values.
+      public: std::size_t observationSize = 0;
+
+      /// \brief Number of commanded values.
+      public: std::size_t actionSize = 0;
+
+      /// \brief Array the observations are written to.
+      public: double *observationData = nullptr;
+
+      /// \brief Number of elements of the observation array.
+      public: std::size_t observationCapacity = 0;
+
+      /// \brief Array the commands are read from.
+      public: const double *actionData = nullptr;
+
+      /// \brief Number of elements of the action array.
+      public: std::size_t actionCapacity = 0;
+
+      /// \brief Links whose contacts are observed.
+      public: std::vector<boost::weak_ptr<Link>> contactLinks;
+
+      /// \brief Contact manager holding the contact filter.
+      public: ContactManager *contactManager = nullptr;
+    };
+  }
+}
+
+/////////////////////////////////////////////////
+int StepBuffersPrivate::Add(std::vector<Entry> &_entries, std::size_t &_size,
+    Entry _entry, const std::size_t _count)
+{
+  _entry.offset = _size;
+  _entry.count = _count;
+  _entries.push_back(_entry);
+  _size += _count;
+  return static_cast<int>(_entry.offset);
+}
+
+/////////////////////////////////////////////////
+bool StepBuffersPrivate::JointEntry(const EntryKind _kind,
+    const JointPtr &_joint, const unsigned int _axis, Entry &_entry)
+{
+  if (!_joint)
+  {
+    gzerr << "Null joint\n";
+    return false;
+  }
+
+  if (_axis >= _joint->DOF())
+  {
+    gzerr << "Invalid axis [" << _axis << "] of joint ["
+          << _joint->GetScopedName() << "]\n";
+    return false;
+  }
+
+  _entry.kind = _kind;
+  _entry.joint = _joint;
+  _entry.axis = _axis;
+  return true;
+}
+
+/////////////////////////////////////////////////
+void StepBuffersPrivate::UpdateContactFilter()
+{
+  if (this->contactManager &&
+      this->contactManager->HasFilter(kContactFilter))
+  {
+    this->contactManager->RemoveFilter(kContactFilter);
+  }
+
+  this->contactManager = nullptr;
+  if (this->contactLinks.empty())
+    return;
+
+  WorldPtr world;
+  std::map<std::string, CollisionPtr> collisions;
+  for (auto const &weakLink : this->contactLinks)
+  {
+    LinkPtr link = weakLink.lock();
+    if (!link)
+      continue;
+
+    world = link->GetWorld();
+    for (auto const &collision : link->GetCollisions())
+      collisions[collision->GetScopedName()] = collision;
+  }
+
+  if (!world || !world->Physics())
+    return;
+
+  this->contactManager = world->Physics()->GetContactManager();
+  this->contactManager->CreateFilter(kContactFilter, collisions);
+}
+
+/////////////////////////////////////////////////
+StepBuffers::StepBuffers()
+  : dataPtr(new StepBuffersPrivate)
+{
+}
+
+/////////////////////////////////////////////////
+StepBuffers::~StepBuffers()
+{
+}
+
+/////////////////////////////////////////////////
+int StepBuffers::AddLinkPose(const LinkPtr &_link)
+{
+  if (!_link)
+  {
+    gzerr << "Null link\n";
+    return -1;
+  }
+
+  Entry entry;
+  entry.kind = EntryKind::LINK_POSE;
+  entry.link = _link;
+  entry.axis = 0;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->Add(this->dataPtr->observations,
+      this->dataPtr->observationSize, entry, PoseSize);
+}
+
+/////////////////////////////////////////////////
+int StepBuffers::AddLinkVelocity(const LinkPtr &_link)
+{
+  if (!_link)
+  {
+    gzerr << "Null link\n";
+    return -1;
+  }
+
+  Entry entry;
+  entry.kind = EntryKind::LINK_VELOCITY;
+  entry.link = _link;
+  entry.axis = 0;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->Add(this->dataPtr->observations,
+      this->dataPtr->observationSize, entry, VelocitySize);
+}
+
+/////////////////////////////////////////////////
+int StepBuffers::AddJointPosition(const JointPtr &_joint,
+    const unsigned int _axis)
+{
+  Entry entry;
+  if (!StepBuffersPrivate::JointEntry(EntryKind::JOINT_POSITION, _joint,
+        _axis, entry))
+  {
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->Add(this->dataPtr->observations,
+      this->dataPtr->observationSize, entry, 1);
+}
+
+/////////////////////////////////////////////////
+int StepBuffers::AddJointVelocity(const JointPtr &_joint,
+    const unsigned int _axis)
+{
+  Entry entry;
+  if (!StepBuffersPrivate::JointEntry(EntryKind::JOINT_VELOCITY, _joint,
+        _axis, entry))
+  {
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->Add(this->dataPtr->observations,
+      this->dataPtr->observationSize, entry, 1);
+}
+
+/////////////////////////////////////////////////
+int StepBuffers::AddJointEffort(const JointPtr &_joint,
+    const unsigned int _axis)
+{
+  Entry entry;
+  if (!StepBuffersPrivate::JointEntry(EntryKind::JOINT_EFFORT, _joint,
+        _axis, entry))
+  {
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->Add(this->dataPtr->observations,
+      this->dataPtr->observationSize, entry, 1);
+}
+
+/////////////////////////////////////////////////
+int StepBuffers::AddContact(const LinkPtr &_link)
+{
+  if (!_link)
+  {
+    gzerr << "Null link\n";
+    return -1;
+  }
+
+  Entry entry;
+  entry.kind = EntryKind::CONTACT;
+  entry.link = _link;
+  entry.axis = 0;
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->contactLinks.push_back(_link);
+  this->dataPtr->UpdateContactFilter();
+  return this->dataPtr->Add(this->dataPtr->observations,
+      this->dataPtr->observationSize, entry, 1);
+}
+
+/////////////////////////////////////////////////
+int StepBuffers::AddJointForceCommand(const JointPtr &_joint,
+    const unsigned int _axis)
+{
+  Entry entry;
+  if (!StepBuffersPrivate::JointEntry(EntryKind::JOINT_FORCE_COMMAND, _joint,
+        _axis, entry))
+  {
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->Add(this->dataPtr->actions,
+      this->dataPtr->actionSize, entry, 1);
+}
+
+/////////////////////////////////////////////////
+int StepBuffers::AddJointVelocityCommand(const JointPtr &_joint,
+    const unsigned int _axis)
+{
+  Entry entry;
+  if (!StepBuffersPrivate::JointEntry(EntryKind::JOINT_VELOCITY_COMMAND,
+        _joint, _axis, entry))
+  {
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->Add(this->dataPtr->actions,
+      this->dataPtr->actionSize, entry, 1);
+}
+
+/////////////////////////////////////////////////
+std::size_t StepBuffers::ObservationSize() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->observationSize;
+}
+
+/////////////////////////////////////////////////
+std::size_t StepBuffers::ActionSize() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->actionSize;
+}
+
+/////////////////////////////////////////////////
+bool StepBuffers::SetObservationArray(double *_data, const std::size_t _size)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (_data && _size < this->dataPtr->observationSize)
+  {
+    gzerr << "Observation array of size [" << _size << "] is smaller than "
+          << "the number of observed values [" << this->dataPtr->observationSize
+          << "]\n";
+    return false;
+  }
+
+  this->dataPtr->observationData = _data;
+  this->dataPtr->observationCapacity = _data ? _size : 0;
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool StepBuffers::SetActionArray(const double *_data,
+    const std::size_t _size)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (_data && _size < this->dataPtr->actionSize)
+  {
+    gzerr << "Action array of size [" << _size << "] is smaller than "
+          << "the number of commanded values [" << this->dataPtr->actionSize
+          << "]\n";
+    return false;
+  }
+
+  this->dataPtr->actionData = _data;
+  this->dataPtr->actionCapacity = _data ? _size : 0;
+  return true;
+}
+
+/////////////////////////////////////////////////
+void StepBuffers::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->observations.clear();
+  this->dataPtr->actions.clear();
+  this->dataPtr->observationSize = 0;
+  this->dataPtr->actionSize = 0;
+  this->dataPtr->observationData = nullptr;
+  this->dataPtr->observationCapacity = 0;
+  this->dataPtr->actionData = nullptr;
+  this->dataPtr->actionCapacity = 0;
+  this->dataPtr->contactLinks.clear();
+  this->dataPtr->UpdateContactFilter();
+}
+
+/////////////////////////////////////////////////
+void StepBuffers::ApplyActions()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  const double *data = this->dataPtr->actionData;
+  if (!data)
+    return;
+
+  for (auto const &entry : this->dataPtr->actions)
+  {
+    // An array set before the last entries were added may be too small
+    if (entry.offset + entry.count > this->dataPtr->actionCapacity)
+      break;
+
+    // Commands of removed joints are dropped
+    const JointPtr joint = entry.joint.lock();
+    if (!joint)
+      continue;
+
+    const double value = data[entry.offset];
+    switch (entry.kind)
+    {
+      case EntryKind::JOINT_FORCE_COMMAND:
+        joint->SetForce(entry.axis, value);
+        break;
+      case EntryKind::JOINT_VELOCITY_COMMAND:
+        joint->SetVelocity(entry.axis, value);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+void StepBuffers::WriteObservations()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  double *data = this->dataPtr->observationData;
+  if (!data)
+    return;
+
+  bool expiredContact = false;
+  for (auto const &entry : this->dataPtr->observations)
+  {
+    if (entry.offset + entry.count > this->dataPtr->observationCapacity)
+      break;
+
+    // Values of removed links and joints are no longer written. Each
+    // entry has either a link or a joint.
+    const LinkPtr link = entry.link.lock();
+    const JointPtr joint = entry.joint.lock();
+    if (!link && !joint)
+    {
+      expiredContact = expiredContact || entry.kind == EntryKind::CONTACT;
+      continue;
+    }
+
+    double *value = data + entry.offset;
+    switch (entry.kind)
+    {
+      case EntryKind::LINK_POSE:
+      {
+        const ignition::math::Pose3d &pose = link->WorldPose();
+        value[0] = pose.Pos().X();
+        value[1] = pose.Pos().Y();
+        value[2] = pose.Pos().Z();
+        value[3] = pose.Rot().W();
+        value[4] = pose.Rot().X();
+        value[5] = pose.Rot().Y();
+        value[6] = pose.Rot().Z();
+        break;
+      }
+      case EntryKind::LINK_VELOCITY:
+      {
+        const ignition::math::Vector3d linear = link->WorldLinearVel();
+        const ignition::math::Vector3d angular = link->WorldAngularVel();
+        value[0] = linear.X();
+        value[1] = linear.Y();
+        value[2] = linear.Z();
+        value[3] = angular.X();
+        value[4] = angular.Y();
+        value[5] = angular.Z();
+        break;
+      }
+      case EntryKind::JOINT_POSITION:
+        *value = joint->Position(entry.axis);
+        break;
+      case EntryKind::JOINT_VELOCITY:
+        *value = joint->GetVelocity(entry.axis);
+        break;
+      case EntryKind::JOINT_EFFORT:
+        // The commanded effort, see AddJointEffort
+        *value = joint->GetForce(entry.axis);
+        break;
+      case EntryKind::CONTACT:
+        *value = this->dataPtr->contactManager &&
+            !this->dataPtr->contactManager->LinkContacts(
+              link.get()).empty() ? 1.0 : 0.0;
+        break;
+      default:
+        break;
+    }
+  }
+
+  // The contact filter holds the collisions of removed links by address
+  if (expiredContact)
+  {
+    auto &links = this->dataPtr->contactLinks;
+    const auto expired = std::remove_if(links.begin(), links.end(),
+        [](const boost::weak_ptr<Link> &_link) { return _link.expired(); });
+    if (expired != links.end())
+    {
+      links.erase(expired, links.end());
+      this->dataPtr->UpdateContactFilter();
+    }
+  }
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_STEPBUFFERS_HH_
+#define GAZEBO_PHYSICS_STEPBUFFERS_HH_
+
+#include <cstddef>
+#include <memory>
+
+#include "gazebo/physics/PhysicsTypes.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace physics
+  {
+    class StepBuffersPrivate;
+
+    /// \addtogroup gazebo_physics
+    /// \{
+
+    /// \class StepBuffers StepBuffers.hh physics/physics.hh
+    /// \brief Batched observations and actions for embedding a world in a
+    /// control or learning loop.
+    ///
+    /// The quantities to observe and the joints to command are registered
+    /// once. On every world update, commands are read from a caller-owned
+    /// action array right before the physics update, and observations are
+    /// written to a caller-owned observation array after the contacts are
+    /// published. Both arrays are plain contiguous doubles, so they can be
+    /// wrapped by numpy or any other array library without copies, and no
+    /// memory is allocated while stepping.
+    ///
+    /// Each Add function returns the offset of its first value in its
+    /// array. Registering entries or setting the arrays is safe while the
+    /// world is running; the arrays must stay valid until they are
+    /// replaced or cleared.
+    ///
+    /// Entries don't keep their links and joints alive. Once a link or
+    /// joint is removed from the world, its values are no longer written,
+    /// keeping the last ones, and its commands are ignored. The offsets
+    /// of the other entries don't change.
+    class GZ_PHYSICS_VISIBLE StepBuffers
+    {
+      /// \brief Number of values of a link pose: the position x, y, z
+      /// followed by the orientation w, x, y, z.
+      public: static const std::size_t PoseSize = 7;
+
+      /// \brief Number of values of a link velocity: the linear velocity
+      /// followed by the angular velocity, in the world frame.
+      public: static const std::size_t VelocitySize = 6;
+
+      /// \brief Constructor.
+      public: StepBuffers();
+
+      /// \brief Destructor.
+      public: virtual ~StepBuffers();
+
+      /// \brief Observe the world pose of a link.
+      /// \param[in] _link Link to observe.
+      /// \return Offset of the PoseSize values, -1 if _link is null.
+      public: int AddLinkPose(const LinkPtr &_link);
+
+      /// \brief Observe the world velocity of a link.
+      /// \param[in] _link Link to observe.
+      /// \return Offset of the VelocitySize values, -1 if _link is null.
+      public: int AddLinkVelocity(const LinkPtr &_link);
+
+      /// \brief Observe the position of a joint axis.
+      /// \param[in] _joint Joint to observe.
+      /// \param[in] _axis Index of the axis.
+      /// \return Offset of the value, -1 if _joint is null or _axis is
+      /// invalid.
+      public: int AddJointPosition(const JointPtr &_joint,
+                  const unsigned int _axis = 0);
+
+      /// \brief Observe the velocity of a joint axis.
+      /// \param[in] _joint Joint to observe.
+      /// \param[in] _axis Index of the axis.
+      /// \return Offset of the value, -1 if _joint is null or _axis is
+      /// invalid.
+      public: int AddJointVelocity(const JointPtr &_joint,
+                  const unsigned int _axis = 0);
+
+      /// \brief Observe the force or torque commanded on a joint axis for
+      /// the last step, as returned by Joint::GetForce. This is the sum of
+      /// the SetForce calls, not the constraint wrench the physics engine
+      /// applied, which needs Joint::GetForceTorque and joint feedback.
+      /// \param[in] _joint Joint to observe.
+      /// \param[in] _axis Index of the axis.
+      /// \return Offset of the value, -1 if _joint is null or _axis is
+      /// invalid.
+      public: int AddJointEffort(const JointPtr &_joint,
+                  const unsigned int _axis = 0);
+
+      /// \brief Observe whether a link is in contact. The value is 1 if
+      /// any collision of the link touched another collision during the
+      /// last step, 0 otherwise. Contacts are generated for the link's
+      /// collisions even if nothing else subscribes to them.
+      /// \param[in] _link Link to observe.
+      /// \return Offset of the value, -1 if _link is null.
+      public: int AddContact(const LinkPtr &_link);
+
+      /// \brief Command the force or torque of a joint axis. The command is
+      /// applied before every step, until the entries are cleared.
+      /// \param[in] _joint Joint to command.
+      /// \param[in] _axis Index of the axis.
+      /// \return Offset of the value, -1 if _joint is null or _axis is
+      /// invalid.
+      public: int AddJointForceCommand(const JointPtr &_joint,
+                  const unsigned int _axis = 0);
+
+      /// \brief Command the velocity of a joint axis. The command is
+      /// applied before every step, until the entries are cleared.
+      /// \param[in] _joint Joint to command.
+      /// \param[in] _axis Index of the axis.
+      /// \return Offset of the value, -1 if _joint is null or _axis is
+      /// invalid.
+      public: int AddJointVelocityCommand(const JointPtr &_joint,
+                  const unsigned int _axis = 0);
+
+      /// \brief Get the number of observed values.
+      /// \return Minimum size of the observation array.
+      public: std::size_t ObservationSize() const;
+
+      /// \brief Get the number of commanded values.
+      /// \return Minimum size of the action array.
+      public: std::size_t ActionSize() const;
+
+      /// \brief Set the array the observations are written to.
+      /// \param[in] _data First element of the array, nullptr to stop
+      /// writing observations.
+      /// \param[in] _size Number of elements of the array.
+      /// \return False if the array is smaller than ObservationSize(), in
+      /// which case the previous array is kept.
+      public: bool SetObservationArray(double *_data, const std::size_t _size);
+
+      /// \brief Set the array the commands are read from.
+      /// \param[in] _data First element of the array, nullptr to stop
+      /// applying commands.
+      /// \param[in] _size Number of elements of the array.
+      /// \return False if the array is smaller than ActionSize(), in which
+      /// case the previous array is kept.
+      public: bool SetActionArray(const double *_data,
+                  const std::size_t _size);
+
+      /// \brief Remove all the entries and forget both arrays.
+      public: void Clear();
+
+      /// \brief Apply the commands of the action array. Called by the world
+      /// right before the physics update.
+      public: void ApplyActions();
+
+      /// \brief Write the observations to the observation array. Called by
+      /// the world at the end of its update.
+      public: void WriteObservations();
+
+      /// \internal
+      /// \brief Private data pointer.
+      private: std::unique_ptr<StepBuffersPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gazebo/physics/physics.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+
+class StepBuffersTest : public ServerFixture
+{
+  /// \brief Spawn a box resting on the ground and a pendulum hinged to
+  /// the world.
+  /// \return The world.
+  public: physics::WorldPtr LoadWorld();
+};
+
+/////////////////////////////////////////////////
+physics::WorldPtr StepBuffersTest::LoadWorld()
+{
+  Load("worlds/empty.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  if (!world)
+    return world;
+
+  SpawnBox("box", ignition::math::Vector3d::One,
+      ignition::math::Vector3d(0, 0, 0.5));
+
+  std::ostringstream sdf;
+  sdf << "<sdf version='" << SDF_VERSION << "'>"
+      << "<model name='pendulum'>"
+      << "  <pose>0 2 2 0 0 0</pose>"
+      << "  <link name='arm'>"
+      << "    <pose>0 0.5 0 0 0 0</pose>"
+      << "    <collision name='collision'>"
+      << "      <geometry><box><size>0.1 1 0.1</size></box></geometry>"
+      << "    </collision>"
+      << "  </link>"
+      << "  <joint name='hinge' type='revolute'>"
+      << "    <parent>world</parent>"
+      << "    <child>arm</child>"
+      << "    <pose>0 -0.5 0 0 0 0</pose>"
+      << "    <axis><xyz>1 0 0</xyz></axis>"
+      << "  </joint>"
+      << "</model>"
+      << "</sdf>";
+  SpawnSDF(sdf.str());
+  WaitUntilEntitySpawn("pendulum", 100, 50);
+
+  return world;
+}
+
+/////////////////////////////////////////////////
+TEST_F(StepBuffersTest, Entries)
+{
+  physics::WorldPtr world = this->LoadWorld();
+  ASSERT_TRUE(world != nullptr);
+  physics::ModelPtr box = world->ModelByName("box");
+  physics::ModelPtr pendulum = world->ModelByName("pendulum");
+  ASSERT_TRUE(box != nullptr);
+  ASSERT_TRUE(pendulum != nullptr);
+  physics::JointPtr hinge = pendulum->GetJoint("hinge");
+  ASSERT_TRUE(hinge != nullptr);
+
+  physics::StepBuffers buffers;
+  EXPECT_EQ(buffers.ObservationSize(), 0u);
+  EXPECT_EQ(buffers.ActionSize(), 0u);
+
+  // Invalid entries
+  EXPECT_EQ(buffers.AddLinkPose(nullptr), -1);
+  EXPECT_EQ(buffers.AddContact(nullptr), -1);
+  EXPECT_EQ(buffers.AddJointPosition(nullptr), -1);
+  EXPECT_EQ(buffers.AddJointPosition(hinge, 1), -1);
+  EXPECT_EQ(buffers.AddJointForceCommand(hinge, 3), -1);
+  EXPECT_EQ(buffers.ObservationSize(), 0u);
+  EXPECT_EQ(buffers.ActionSize(), 0u);
+
+  // Entries are packed in registration order
+  EXPECT_EQ(buffers.AddLinkPose(box->GetLink()), 0);
+  EXPECT_EQ(buffers.AddLinkVelocity(box->GetLink()), 7);
+  EXPECT_EQ(buffers.AddJointPosition(hinge), 13);
+  EXPECT_EQ(buffers.AddJointVelocity(hinge), 14);
+  EXPECT_EQ(buffers.AddJointEffort(hinge), 15);
+  EXPECT_EQ(buffers.AddContact(box->GetLink()), 16);
+  EXPECT_EQ(buffers.ObservationSize(), 17u);
+
+  EXPECT_EQ(buffers.AddJointForceCommand(hinge), 0);
+  EXPECT_EQ(buffers.AddJointVelocityCommand(hinge), 1);
+  EXPECT_EQ(buffers.ActionSize(), 2u);
+
+  // Arrays must fit all the values
+  std::vector<double> observations(16);
+  std::vector<double> actions(1);
+  EXPECT_FALSE(buffers.SetObservationArray(observations.data(),
+        observations.size()));
+  EXPECT_FALSE(buffers.SetActionArray(actions.data(), actions.size()));
+  observations.resize(17);
+  actions.resize(2);
+  EXPECT_TRUE(buffers.SetObservationArray(observations.data(),
+        observations.size()));
+  EXPECT_TRUE(buffers.SetActionArray(actions.data(), actions.size()));
+  EXPECT_TRUE(buffers.SetObservationArray(nullptr, 0));
+  EXPECT_TRUE(buffers.SetActionArray(nullptr, 0));
+
+  physics::ContactManager *contactManager =
+      world->Physics()->GetContactManager();
+  EXPECT_TRUE(contactManager->HasFilter("step_buffers"));
+
+  buffers.Clear();
+  EXPECT_EQ(buffers.ObservationSize(), 0u);
+  EXPECT_EQ(buffers.ActionSize(), 0u);
+  EXPECT_FALSE(contactManager->HasFilter("step_buffers"));
+}
+
+/////////////////////////////////////////////////
+TEST_F(StepBuffersTest, Step)
+{
+  physics::WorldPtr world = this->LoadWorld();
+  ASSERT_TRUE(world != nullptr);
+  physics::LinkPtr box = world->ModelByName("box")->GetLink();
+  physics::ModelPtr pendulum = world->ModelByName("pendulum");
+  physics::LinkPtr arm = pendulum->GetLink("arm");
+  physics::JointPtr hinge = pendulum->GetJoint("hinge");
+  ASSERT_TRUE(box != nullptr);
+  ASSERT_TRUE(arm != nullptr);
+  ASSERT_TRUE(hinge != nullptr);
+
+  physics::StepBuffers &buffers = world->StepBuffers();
+  const int armPose = buffers.AddLinkPose(arm);
+  const int armVel = buffers.AddLinkVelocity(arm);
+  const int position = buffers.AddJointPosition(hinge);
+  const int velocity = buffers.AddJointVelocity(hinge);
+  const int effort = buffers.AddJointEffort(hinge);
+  const int boxContact = buffers.AddContact(box);
+  const int armContact = buffers.AddContact(arm);
+  const int force = buffers.AddJointForceCommand(hinge);
+
+  std::vector<double> observations(buffers.ObservationSize(), -1.0);
+  std::vector<double> actions(buffers.ActionSize(), 0.0);
+  ASSERT_TRUE(buffers.SetObservationArray(observations.data(),
+        observations.size()));
+  ASSERT_TRUE(buffers.SetActionArray(actions.data(), actions.size()));
+
+  for (int i = 0; i < 50; ++i)
+  {
+    actions[force] = 2.5;
+    world->Step(1);
+
+    // Observations match the state at the end of the step
+    const ignition::math::Pose3d pose = arm->WorldPose();
+    EXPECT_DOUBLE_EQ(observations[armPose + 0], pose.Pos().X());
+    EXPECT_DOUBLE_EQ(observations[armPose + 1], pose.Pos().Y());
+    EXPECT_DOUBLE_EQ(observations[armPose + 2], pose.Pos().Z());
+    EXPECT_DOUBLE_EQ(observations[armPose + 3], pose.Rot().W());
+    EXPECT_DOUBLE_EQ(observations[armPose + 4], pose.Rot().X());
+    EXPECT_DOUBLE_EQ(observations[armPose + 5], pose.Rot().Y());
+    EXPECT_DOUBLE_EQ(observations[armPose + 6], pose.Rot().Z());
+    EXPECT_DOUBLE_EQ(observations[armVel + 0], arm->WorldLinearVel().X());
+    EXPECT_DOUBLE_EQ(observations[armVel + 5], arm->WorldAngularVel().Z());
+    EXPECT_DOUBLE_EQ(observations[position], hinge->Position(0));
+    EXPECT_DOUBLE_EQ(observations[velocity], hinge->GetVelocity(0));
+
+    // The command was applied before the step
+    EXPECT_DOUBLE_EQ(observations[effort], 2.5);
+  }
+
+  // The box rests on the ground, the pendulum swings in the air
+  EXPECT_DOUBLE_EQ(observations[boxContact], 1.0);
+  EXPECT_DOUBLE_EQ(observations[armContact], 0.0);
+  EXPECT_GT(std::abs(observations[velocity]), 0.0);
+
+  // Without an array, nothing is written
+  ASSERT_TRUE(buffers.SetObservationArray(nullptr, 0));
+  observations[position] = -1.0;
+  world->Step(1);
+  EXPECT_DOUBLE_EQ(observations[position], -1.0);
+
+  buffers.Clear();
+}
+
+/////////////////////////////////////////////////
+TEST_F(StepBuffersTest, RemovedEntities)
+{
+  physics::WorldPtr world = this->LoadWorld();
+  ASSERT_TRUE(world != nullptr);
+
+  physics::StepBuffers &buffers = world->StepBuffers();
+  int armPose, position, armContact, force;
+  {
+    physics::ModelPtr pendulum = world->ModelByName("pendulum");
+    ASSERT_TRUE(pendulum != nullptr);
+    armPose = buffers.AddLinkPose(pendulum->GetLink("arm"));
+    position = buffers.AddJointPosition(pendulum->GetJoint("hinge"));
+    armContact = buffers.AddContact(pendulum->GetLink("arm"));
+    force = buffers.AddJointForceCommand(pendulum->GetJoint("hinge"));
+  }
+  physics::LinkPtr box = world->ModelByName("box")->GetLink();
+  const int boxPose = buffers.AddLinkPose(box);
+  const int boxContact = buffers.AddContact(box);
+
+  std::vector<double> observations(buffers.ObservationSize(), -1.0);
+  std::vector<double> actions(buffers.ActionSize(), 2.5);
+  ASSERT_TRUE(buffers.SetObservationArray(observations.data(),
+        observations.size()));
+  ASSERT_TRUE(buffers.SetActionArray(actions.data(), actions.size()));
+  world->Step(1);
+  EXPECT_DOUBLE_EQ(observations[armContact], 0.0);
+
+  // The buffers don't keep the pendulum alive, its entries are skipped
+  // and the others keep their offsets
+  world->RemoveModel("pendulum");
+  EXPECT_TRUE(world->ModelByName("pendulum") == nullptr);
+  observations.assign(observations.size(), -1.0);
+  for (int i = 0; i < 10; ++i)
+    world->Step(1);
+
+  EXPECT_DOUBLE_EQ(observations[armPose], -1.0);
+  EXPECT_DOUBLE_EQ(observations[position], -1.0);
+  EXPECT_DOUBLE_EQ(observations[armContact], -1.0);
+  EXPECT_NEAR(observations[boxPose + 2], 0.5, 1e-2);
+  EXPECT_DOUBLE_EQ(observations[boxContact], 1.0);
+
+  buffers.Clear();
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -15,16 +15,34 @@
  *
 */
 
+#ifndef _WIN32
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
 #include <functional>
+#include <string>
+#include <vector>
 #include <boost/lexical_cast.hpp>
 #include <sdf/sdf.hh>
 
 #include <ignition/math/Vector3.hh>
 
+#include "gazebo/common/CommonIface.hh"
+#include "gazebo/common/Console.hh"
 #include "gazebo/transport/Node.hh"
 #include "gazebo/transport/TransportTypes.hh"
 
 #include "gazebo/physics/Entity.hh"
+#include "gazebo/physics/Link.hh"
 #include "gazebo/physics/PhysicsTypes.hh"
 #include "gazebo/physics/Wind.hh"
 #include "gazebo/physics/World.hh"
@@ -33,6 +51,239 @@ namespace gazebo
 {
   namespace physics
   {
+    /// \internal
+    /// \brief Header of a wind grid file, see Wind::LoadGrid.
+    struct WindGridHeader
+    {
+      /// \brief File magic, "GZWIND1".
+      char magic[8];
+
+      /// \brief Number of samples along x, y, z and time.
+      uint32_t size[4];
+
+      /// \brief World position of the first sample.
+      double origin[3];
+
+      /// \brief Distance between samples along x, y and z.
+      double spacing[3];
+
+      /// \brief Sim time of the first sample.
+      double t0;
+
+      /// \brief Time between samples.
+      double dt;
+    };
+    static_assert(sizeof(WindGridHeader) == 88,
+        "Unexpected wind grid header padding");
+
+    /// \internal
+    /// \brief Interpolation of one grid axis.
+    struct WindGridAxis
+    {
+      /// \brief Index of the sample below the position.
+      size_t i0 = 0;
+
+      /// \brief Index of the sample above the position.
+      size_t i1 = 0;
+
+      /// \brief Weight of sample i1.
+      double w = 0;
+
+      /// \brief Compute the samples surrounding a position, clamped to the
+      /// grid.
+      /// \param[in] _x Position along the axis.
+      /// \param[in] _origin Position of the first sample.
+      /// \param[in] _spacing Distance between samples.
+      /// \param[in] _n Number of samples.
+      public: void Set(const double _x, const double _origin,
+                  const double _spacing, const size_t _n)
+      {
+        if (_n < 2)
+        {
+          this->i0 = this->i1 = 0;
+          this->w = 0;
+          return;
+        }
+
+        const double f = ignition::math::clamp((_x - _origin) / _spacing,
+            0.0, static_cast<double>(_n - 1));
+        this->i0 = std::min(static_cast<size_t>(f), _n - 2);
+        this->i1 = this->i0 + 1;
+        this->w = f - this->i0;
+      }
+    };
+
+    /// \internal
+    /// \brief Memory mapped wind grid, see Wind::LoadGrid.
+    class WindGrid
+    {
+      /// \brief Destructor.
+      public: ~WindGrid()
+      {
+#ifndef _WIN32
+        if (this->mapped)
+          munmap(this->mapped, this->mappedSize);
+#endif
+      }
+
+      /// \brief Load a grid file.
+      /// \param[in] _filename Path to the file.
+      /// \return True on success.
+      public: bool Load(const std::string &_filename)
+      {
+        const char *bytes = nullptr;
+        size_t size = 0;
+#ifndef _WIN32
+        int fd = open(_filename.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+          gzerr << "Unable to open wind grid [" << _filename << "]\n";
+          return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+          size = static_cast<size_t>(st.st_size);
+          void *addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (addr != MAP_FAILED)
+          {
+            this->mapped = addr;
+            this->mappedSize = size;
+            bytes = static_cast<const char *>(addr);
+          }
+        }
+        close(fd);
+#else
+        std::ifstream file(_filename, std::ios::binary);
+        if (!file)
+        {
+          gzerr << "Unable to open wind grid [" << _filename << "]\n";
+          return false;
+        }
+        this->buffer.assign(std::istreambuf_iterator<char>(file),
+            std::istreambuf_iterator<char>());
+        bytes = this->buffer.data();
+        size = this->buffer.size();
+#endif
+        if (!bytes || size < sizeof(WindGridHeader))
+        {
+          gzerr << "Unable to read wind grid [" << _filename << "]\n";
+          return false;
+        }
+
+        WindGridHeader header;
+        std::memcpy(&header, bytes, sizeof(header));
+        if (std::strncmp(header.magic, "GZWIND1", sizeof(header.magic)) != 0)
+        {
+          gzerr << "Wind grid [" << _filename << "] has an invalid header\n";
+          return false;
+        }
+
+        uint64_t samples = 1;
+        for (unsigned int i = 0; i < 4; ++i)
+        {
+          if (header.size[i] == 0)
+          {
+            gzerr << "Wind grid [" << _filename << "] is empty\n";
+            return false;
+          }
+          samples *= header.size[i];
+        }
+        for (unsigned int i = 0; i < 3; ++i)
+        {
+          if (header.size[i] > 1 && !(header.spacing[i] > 0))
+          {
+            gzerr << "Wind grid [" << _filename << "] spacing must be "
+                  << "positive\n";
+            return false;
+          }
+        }
+        if (header.size[3] > 1 && !(header.dt > 0))
+        {
+          gzerr << "Wind grid [" << _filename << "] period must be "
+                << "positive\n";
+          return false;
+        }
+        if (samples > (size - sizeof(header)) / (3 * sizeof(float)) ||
+            size != sizeof(header) + samples * 3 * sizeof(float))
+        {
+          gzerr << "Wind grid [" << _filename << "] size does not match its "
+                << "header\n";
+          return false;
+        }
+
+        this->header = header;
+        this->data = reinterpret_cast<const float *>(bytes + sizeof(header));
+        return true;
+      }
+
+      /// \brief Sample the grid at many positions and a single time.
+      /// \param[in] _count Number of positions.
+      /// \param[in] _x X coordinates.
+      /// \param[in] _y Y coordinates.
+      /// \param[in] _z Z coordinates.
+      /// \param[in] _t Sim time in seconds.
+      /// \param[out] _vel Wind velocity at each position.
+      public: void Sample(const size_t _count, const double *_x,
+                  const double *_y, const double *_z, const double _t,
+                  ignition::math::Vector3d *_vel) const
+      {
+        const size_t nx = this->header.size[0];
+        const size_t ny = this->header.size[1];
+        const size_t nz = this->header.size[2];
+
+        // Time is shared by all positions
+        WindGridAxis t;
+        t.Set(_t, this->header.t0, this->header.dt, this->header.size[3]);
+        const float *frame0 = this->data + t.i0 * nx * ny * nz * 3;
+        const float *frame1 = this->data + t.i1 * nx * ny * nz * 3;
+
+        WindGridAxis ax, ay, az;
+        for (size_t n = 0; n < _count; ++n)
+        {
+          ax.Set(_x[n], this->header.origin[0], this->header.spacing[0], nx);
+          ay.Set(_y[n], this->header.origin[1], this->header.spacing[1], ny);
+          az.Set(_z[n], this->header.origin[2], this->header.spacing[2], nz);
+
+          double v[3] = {0, 0, 0};
+          for (unsigned int c = 0; c < 8; ++c)
+          {
+            const size_t ix = (c & 1) ? ax.i1 : ax.i0;
+            const size_t iy = (c & 2) ? ay.i1 : ay.i0;
+            const size_t iz = (c & 4) ? az.i1 : az.i0;
+            const double w = ((c & 1) ? ax.w : 1 - ax.w) *
+                             ((c & 2) ? ay.w : 1 - ay.w) *
+                             ((c & 4) ? az.w : 1 - az.w);
+            if (w == 0)
+              continue;
+
+            const size_t cell = ((iz * ny + iy) * nx + ix) * 3;
+            for (unsigned int k = 0; k < 3; ++k)
+            {
+              v[k] += w * ((1 - t.w) * frame0[cell + k] +
+                  t.w * frame1[cell + k]);
+            }
+          }
+          _vel[n].Set(v[0], v[1], v[2]);
+        }
+      }
+
+      /// \brief File header.
+      private: WindGridHeader header;
+
+      /// \brief Velocities, 3 per sample.
+      private: const float *data = nullptr;
+
+      /// \brief Start of the memory mapping.
+      private: void *mapped = nullptr;
+
+      /// \brief Size of the memory mapping.
+      private: size_t mappedSize = 0;
+
+      /// \brief File contents, on platforms without mmap.
+      private: std::vector<char> buffer;
+    };
+
     /// \internal
     /// \brief Private data for the Wind class
     class WindPrivate
@@ -57,6 +308,28 @@ namespace gazebo
       public: std::function< ignition::math::Vector3d (
                   const Wind *, const Entity *)> linearVelFunc;
 
+      /// \brief True if linearVelFunc was set with SetLinearVelFunc.
+      public: bool customLinearVelFunc = false;
+
+      /// \brief Wind grid, accessed with std::atomic_load and
+      /// std::atomic_store so it can be replaced during an update.
+      public: std::shared_ptr<const WindGrid> grid;
+
+      /// \brief Path of the loaded wind grid.
+      public: std::string gridFile;
+
+      /// \brief Link x coordinates, reused by UpdateLinks.
+      public: std::vector<double> xs;
+
+      /// \brief Link y coordinates, reused by UpdateLinks.
+      public: std::vector<double> ys;
+
+      /// \brief Link z coordinates, reused by UpdateLinks.
+      public: std::vector<double> zs;
+
+      /// \brief Link wind velocities, reused by UpdateLinks.
+      public: std::vector<ignition::math::Vector3d> vels;
+
       // Transport is declared last.
       /// \brief Node for communication.
       public: transport::NodePtr node;
@@ -93,8 +366,8 @@ Wind::Wind(World &_world, sdf::ElementPtr _sdf)
   this->dataPtr->requestSub = this->dataPtr->node->Subscribe("~/request",
                                            &Wind::OnRequest, this);
 
-  this->SetLinearVelFunc(std::bind(&Wind::LinearVelDefault, this,
-        std::placeholders::_1, std::placeholders::_2));
+  this->dataPtr->linearVelFunc = std::bind(&Wind::LinearVelDefault, this,
+        std::placeholders::_1, std::placeholders::_2);
 }
 
 //////////////////////////////////////////////////
@@ -109,9 +382,90 @@ Wind::~Wind()
 
 //////////////////////////////////////////////////
 ignition::math::Vector3d Wind::LinearVelDefault(
-    const Wind *_wind, const Entity */*_entity*/)
+    const Wind *_wind, const Entity *_entity)
+{
+  auto grid = std::atomic_load(&_wind->dataPtr->grid);
+  if (!grid || !_entity)
+    return _wind->LinearVel();
+
+  const ignition::math::Vector3d &pos = _entity->WorldPose().Pos();
+  const double x = pos.X();
+  const double y = pos.Y();
+  const double z = pos.Z();
+  ignition::math::Vector3d vel;
+  grid->Sample(1, &x, &y, &z, _wind->dataPtr->world.SimTime().Double(), &vel);
+  return vel;
+}
+
+//////////////////////////////////////////////////
+bool Wind::LoadGrid(const std::string &_filename)
+{
+  std::string filename = common::find_file(_filename);
+  if (filename.empty())
+    filename = _filename;
+
+  auto grid = std::make_shared<WindGrid>();
+  if (!grid->Load(filename))
+    return false;
+
+  std::atomic_store(&this->dataPtr->grid,
+      std::shared_ptr<const WindGrid>(grid));
+  this->dataPtr->gridFile = _filename;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void Wind::ClearGrid()
 {
-  return _wind->LinearVel();
+  std::atomic_store(&this->dataPtr->grid, std::shared_ptr<const WindGrid>());
+  this->dataPtr->gridFile.clear();
+}
+
+//////////////////////////////////////////////////
+bool Wind::HasGrid() const
+{
+  return std::atomic_load(&this->dataPtr->grid) != nullptr;
+}
+
+//////////////////////////////////////////////////
+void Wind::UpdateLinks(const std::vector<Link *> &_links)
+{
+  if (this->dataPtr->customLinearVelFunc)
+  {
+    for (Link *link : _links)
+      link->_SetWorldWindLinearVel(this->dataPtr->linearVelFunc(this, link));
+    return;
+  }
+
+  auto grid = std::atomic_load(&this->dataPtr->grid);
+  if (!grid)
+  {
+    const ignition::math::Vector3d vel = this->LinearVel();
+    for (Link *link : _links)
+      link->_SetWorldWindLinearVel(vel);
+    return;
+  }
+
+  // Gather positions into flat arrays and sample the grid in one pass
+  const size_t count = _links.size();
+  this->dataPtr->xs.resize(count);
+  this->dataPtr->ys.resize(count);
+  this->dataPtr->zs.resize(count);
+  this->dataPtr->vels.resize(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    const ignition::math::Vector3d &pos = _links[i]->WorldPose().Pos();
+    this->dataPtr->xs[i] = pos.X();
+    this->dataPtr->ys[i] = pos.Y();
+    this->dataPtr->zs[i] = pos.Z();
+  }
+
+  grid->Sample(count, this->dataPtr->xs.data(), this->dataPtr->ys.data(),
+      this->dataPtr->zs.data(), this->dataPtr->world.SimTime().Double(),
+      this->dataPtr->vels.data());
+
+  for (size_t i = 0; i < count; ++i)
+    _links[i]->_SetWorldWindLinearVel(this->dataPtr->vels[i]);
 }
 
 //////////////////////////////////////////////////
@@ -151,6 +505,14 @@ bool Wind::SetParam(const std::string &_key,
           boost::any_cast<ignition::math::Vector3d>(_value);
       this->SetLinearVel(vel);
     }
+    else if (_key == "grid_file")
+    {
+      const std::string filename = boost::any_cast<std::string>(_value);
+      if (filename.empty())
+        this->ClearGrid();
+      else if (!this->LoadGrid(filename))
+        return false;
+    }
     else
     {
       gzwarn << "SetParam failed for [" << _key << "] in wind " << std::endl;
@@ -186,6 +548,8 @@ bool Wind::Param(const std::string &_key,
 {
   if (_key == "linear_velocity")
     _value = this->LinearVel();
+  else if (_key == "grid_file")
+    _value = this->dataPtr->gridFile;
   else
   {
     gzwarn << "Param failed for [" << _key << "] in wind " << std::endl;
@@ -239,4 +603,5 @@ void Wind::SetLinearVelFunc(std::function< ignition::math::Vector3d (
     const Wind *, const Entity *_entity) > _linearVelFunc)
 {
   this->dataPtr->linearVelFunc = _linearVelFunc;
+  this->dataPtr->customLinearVelFunc = true;
 }
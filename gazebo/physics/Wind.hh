@@ -20,6 +20,7 @@
 #include <string>
 #include <functional>
 #include <memory>
+#include <vector>
 #include <boost/any.hpp>
 
 #include "gazebo/msgs/msgs.hh"
@@ -57,6 +58,7 @@ namespace gazebo
       /// \param[in] _key String key
       /// Below is a list of _key parameter definitions:
       ///       -# "linear_vel" (Vector3d) - wind linear velocity
+      ///       -# "grid_file" (std::string) - wind grid file, see LoadGrid
       ///
       /// \param[in] _value The value to set to
       /// \return true if SetParam is successful, false if operation fails.
@@ -114,6 +116,42 @@ namespace gazebo
       public: void SetLinearVelFunc(std::function< ignition::math::Vector3d (
           const Wind *_wind, const Entity *_entity) > _linearVelFunc);
 
+      /// \brief Load a gridded, optionally time-varying, wind velocity
+      /// field. Once loaded, the default wind velocity function returns
+      /// the velocity of the grid at the entity's position, interpolated
+      /// trilinearly in space and linearly in time, instead of the global
+      /// wind velocity. Positions and times outside of the grid are clamped
+      /// to its boundary.
+      ///
+      /// The file is memory mapped. It is a little-endian binary file made
+      /// of a header followed by the velocities:
+      ///   - char[8] magic "GZWIND1" (null terminated)
+      ///   - uint32 nx, ny, nz, nt: number of samples along x, y, z and
+      ///     time, all at least 1
+      ///   - float64 origin x, y, z: world position of the first sample
+      ///   - float64 spacing x, y, z: distance between samples
+      ///   - float64 t0, dt: sim time of the first sample and period
+      ///   - float32 velocities, 3 per sample, in [t][z][y][x] order
+      /// \param[in] _filename Path to the grid file.
+      /// \return True if the grid was loaded.
+      public: bool LoadGrid(const std::string &_filename);
+
+      /// \brief Unload the wind grid, if any.
+      public: void ClearGrid();
+
+      /// \brief Get whether a wind grid is loaded.
+      /// \return True if a grid is loaded.
+      public: bool HasGrid() const;
+
+      /// \brief Compute the wind velocity of many links in one pass and
+      /// store it in each link, see Link::WorldWindLinearVel. When the
+      /// default wind velocity function is used, positions are gathered
+      /// into flat arrays and the grid, if any, is sampled in a single
+      /// loop. A custom function set with SetLinearVelFunc is called once
+      /// per link.
+      /// \param[in] _links Links to update.
+      public: void UpdateLinks(const std::vector<Link *> &_links);
+
       /// \brief Get the global wind velocity, ignoring the entity.
       /// \param[in] _wind Reference to the wind.
       /// \param[in] _entity Pointer to an entity at which location the wind
@@ -14,7 +14,12 @@
  * limitations under the License.
  *
 */
+#include <cstdint>
+#include <fstream>
 #include <memory>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
 
 #include "gazebo/test/ServerFixture.hh"
 #include "gazebo/msgs/msgs.hh"
@@ -44,6 +49,12 @@ class WindTest : public ServerFixture
   /// \brief Test setting up function to compute the wind.
   public: void WindSetLinearVelFunc();
 
+  /// \brief Test the gridded wind field.
+  public: void WindGrid();
+
+  /// \brief Test turning the wind of a link on and off.
+  public: void WindMode();
+
   /// \brief Incoming wind message.
   public: static msgs::Wind windPubMsg;
 
@@ -221,6 +232,158 @@ TEST_F(WindTest, WindSetLinearVelFunc)
   WindSetLinearVelFunc();
 }
 
+/////////////////////////////////////////////////
+/// \brief Write a wind grid file, see physics::Wind::LoadGrid.
+/// \param[in] _filename Path of the file.
+/// \param[in] _size Number of samples along x, y, z and time.
+/// \param[in] _spacing Distance between samples, on all axes.
+/// \param[in] _dt Time between samples.
+/// \param[in] _vel Velocities, 3 per sample.
+void WriteWindGrid(const std::string &_filename, const uint32_t _size[4],
+    const double _spacing, const double _dt, const std::vector<float> &_vel)
+{
+  std::ofstream file(_filename, std::ios::binary);
+  const char magic[8] = "GZWIND1";
+  const double origin[3] = {0, 0, 0};
+  const double spacing[3] = {_spacing, _spacing, _spacing};
+  const double t0 = 0;
+  file.write(magic, sizeof(magic));
+  file.write(reinterpret_cast<const char *>(_size), 4 * sizeof(uint32_t));
+  file.write(reinterpret_cast<const char *>(origin), sizeof(origin));
+  file.write(reinterpret_cast<const char *>(spacing), sizeof(spacing));
+  file.write(reinterpret_cast<const char *>(&t0), sizeof(t0));
+  file.write(reinterpret_cast<const char *>(&_dt), sizeof(_dt));
+  file.write(reinterpret_cast<const char *>(_vel.data()),
+      _vel.size() * sizeof(float));
+}
+
+/////////////////////////////////////////////////
+void WindTest::WindGrid()
+{
+  Load("worlds/empty.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != NULL);
+
+  physics::Wind &wind = world->Wind();
+  wind.SetLinearVel(ignition::math::Vector3d(1, 2, 3));
+  EXPECT_FALSE(wind.HasGrid());
+
+  const boost::filesystem::path dir =
+    boost::filesystem::temp_directory_path() / "gazebo_wind_test";
+  boost::filesystem::create_directories(dir);
+  const std::string filename = (dir / "grid.bin").string();
+
+  // 2x2x1 grid with 2 time samples, vx = x, vy = y, vz = 10 * t
+  const uint32_t size[4] = {2, 2, 1, 2};
+  std::vector<float> vel;
+  for (unsigned int t = 0; t < 2; ++t)
+  {
+    for (unsigned int y = 0; y < 2; ++y)
+    {
+      for (unsigned int x = 0; x < 2; ++x)
+      {
+        vel.push_back(x * 10.0f);
+        vel.push_back(y * 10.0f);
+        vel.push_back(t * 10.0f);
+      }
+    }
+  }
+  WriteWindGrid(filename, size, 10, 100, vel);
+
+  // Invalid files
+  EXPECT_FALSE(wind.LoadGrid((dir / "missing.bin").string()));
+  vel.pop_back();
+  WriteWindGrid((dir / "short.bin").string(), size, 10, 100, vel);
+  EXPECT_FALSE(wind.LoadGrid((dir / "short.bin").string()));
+  EXPECT_FALSE(wind.HasGrid());
+
+  EXPECT_TRUE(wind.SetParam("grid_file", filename));
+  EXPECT_TRUE(wind.HasGrid());
+  EXPECT_EQ(boost::any_cast<std::string>(wind.Param("grid_file")), filename);
+
+  SpawnBox("box", ignition::math::Vector3d::One,
+      ignition::math::Vector3d(2.5, 5, 0.5));
+  physics::ModelPtr model = world->ModelByName("box");
+  ASSERT_TRUE(model != NULL);
+  physics::LinkPtr link = model->GetLink();
+  ASSERT_TRUE(link != NULL);
+
+  // Interpolated inside the grid, at the start of the simulation
+  ignition::math::Vector3d expected(2.5, 5, world->SimTime().Double() / 10);
+  EXPECT_EQ(wind.WorldLinearVel(model.get()), expected);
+
+  // Batched update
+  link->SetWindMode(true);
+  world->SetWindEnabled(true);
+  world->Step(1);
+  expected.Z(world->SimTime().Double() / 10);
+  EXPECT_EQ(link->WorldWindLinearVel(), expected);
+
+  // Clamped outside of the grid
+  model->SetWorldPose(ignition::math::Pose3d(-5, 20, 0.5, 0, 0, 0));
+  expected.Set(0, 10, world->SimTime().Double() / 10);
+  EXPECT_EQ(wind.WorldLinearVel(model.get()), expected);
+
+  // Back to the global velocity
+  EXPECT_TRUE(wind.SetParam("grid_file", std::string()));
+  EXPECT_FALSE(wind.HasGrid());
+  EXPECT_EQ(wind.WorldLinearVel(model.get()),
+      ignition::math::Vector3d(1, 2, 3));
+
+  boost::filesystem::remove_all(dir);
+}
+
+/////////////////////////////////////////////////
+TEST_F(WindTest, WindGrid)
+{
+  WindGrid();
+}
+
+/////////////////////////////////////////////////
+void WindTest::WindMode()
+{
+  Load("worlds/empty.world", true);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != NULL);
+
+  physics::Wind &wind = world->Wind();
+  wind.SetLinearVel(ignition::math::Vector3d(1, 2, 3));
+
+  SpawnBox("box", ignition::math::Vector3d::One,
+      ignition::math::Vector3d(0, 0, 0.5));
+  physics::ModelPtr model = world->ModelByName("box");
+  ASSERT_TRUE(model != NULL);
+  physics::LinkPtr link = model->GetLink();
+  ASSERT_TRUE(link != NULL);
+
+  // Links without wind are not updated
+  world->Step(1);
+  EXPECT_EQ(link->WorldWindLinearVel(), ignition::math::Vector3d::Zero);
+
+  link->SetWindMode(true);
+  world->SetWindEnabled(true);
+  world->Step(1);
+  EXPECT_EQ(link->WorldWindLinearVel(), ignition::math::Vector3d(1, 2, 3));
+
+  // Turning the wind off stops the updates
+  wind.SetLinearVel(ignition::math::Vector3d(4, 5, 6));
+  link->SetWindMode(false);
+  EXPECT_EQ(link->WorldWindLinearVel(), ignition::math::Vector3d::Zero);
+  world->Step(10);
+  EXPECT_EQ(link->WorldWindLinearVel(), ignition::math::Vector3d::Zero);
+
+  // And turning it back on resumes them
+  link->SetWindMode(true);
+  world->Step(1);
+  EXPECT_EQ(link->WorldWindLinearVel(), ignition::math::Vector3d(4, 5, 6));
+}
+
+/////////////////////////////////////////////////
+TEST_F(WindTest, WindMode)
+{
+  WindMode();
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
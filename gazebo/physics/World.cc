@@ -23,9 +23,13 @@
 #include <sdf/sdf.hh>
 
 #include <deque>
+#include <functional>
 #include <list>
+#include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <boost/algorithm/string/predicate.hpp>
@@ -48,6 +52,7 @@
 #include "gazebo/util/LogPlay.hh"
 
 #include "gazebo/common/ModelDatabase.hh"
+#include "gazebo/common/CallbackAccounting.hh"
 #include "gazebo/common/CommonIface.hh"
 #include "gazebo/common/Events.hh"
 #include "gazebo/common/Exception.hh"
@@ -79,6 +84,7 @@
 #include "gazebo/physics/Actor.hh"
 #include "gazebo/physics/Wind.hh"
 #include "gazebo/physics/WorldPrivate.hh"
+#include "gazebo/physics/WorldSnapshot.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/common/SphericalCoordinates.hh"
 
@@ -107,6 +113,33 @@ class ModelUpdate_TBB
   private: Model_V *models;
 };
 
+/// \brief Add a link to, or remove it from, a dense list of links.
+/// \param[in] _link The link.
+/// \param[in] _member True to add the link, false to remove it.
+/// \param[in,out] _links The list.
+/// \param[in,out] _index Index of each link in _links.
+static void SetLinkMember(Link *_link, const bool _member,
+    std::vector<Link *> &_links,
+    std::unordered_map<const Link *, size_t> &_index)
+{
+  auto iter = _index.find(_link);
+  if (_member && iter == _index.end())
+  {
+    _index[_link] = _links.size();
+    _links.push_back(_link);
+  }
+  else if (!_member && iter != _index.end())
+  {
+    // Swap with the last link to keep the list dense
+    const size_t index = iter->second;
+    Link *last = _links.back();
+    _links[index] = last;
+    _index[last] = index;
+    _links.pop_back();
+    _index.erase(_link);
+  }
+}
+
 //////////////////////////////////////////////////
 World::World(const std::string &_name)
   : dataPtr(new WorldPrivate)
@@ -155,12 +188,6 @@ World::World(const std::string &_name)
   this->dataPtr->logLastStatePlayedRealTime = common::Time(0);
   this->dataPtr->logPlayRealTimeFactor = 0.0;
 
-  this->dataPtr->connections.push_back(
-     event::Events::ConnectStep(std::bind(&World::OnStep, this)));
-  this->dataPtr->connections.push_back(
-     event::Events::ConnectPause(
-       std::bind(&World::SetPaused, this, std::placeholders::_1)));
-
   this->dataPtr->waitForSensors = nullptr;
 
   // Make sure dbs are initialized
@@ -201,6 +228,15 @@ void World::Load(sdf::ElementPtr _sdf)
   else
     this->dataPtr->name = this->dataPtr->sdf->Get<std::string>("name");
 
+  // The connections made while loading belong to this world
+  event::ScopedEventWorld scopedWorld(this->Name());
+
+  this->dataPtr->connections.push_back(
+     event::Events::ConnectStep(std::bind(&World::OnStep, this)));
+  this->dataPtr->connections.push_back(
+     event::Events::ConnectPause(
+       std::bind(&World::SetPaused, this, std::placeholders::_1)));
+
 #ifdef HAVE_OPENAL
   util::OpenAL::Instance()->Load(this->dataPtr->sdf->GetElement("audio"));
 #endif
@@ -260,6 +296,12 @@ void World::Load(sdf::ElementPtr _sdf)
   this->dataPtr->statPub =
     this->dataPtr->node->Advertise<msgs::WorldStatistics>(
         "~/world_stats", 100, 5);
+  if (event::CallbackAccounting::Enabled())
+  {
+    this->dataPtr->callbackStatsPub =
+      this->dataPtr->node->Advertise<msgs::CallbackStatistics>(
+          "~/diagnostics/callbacks");
+  }
   this->dataPtr->modelPub = this->dataPtr->node->Advertise<msgs::Model>(
       "~/model/info");
   this->dataPtr->lightPub = this->dataPtr->node->Advertise<msgs::Light>(
@@ -299,6 +341,11 @@ void World::Load(sdf::ElementPtr _sdf)
 
   this->dataPtr->wind->Load(windElem);
 
+  // Links add themselves to the spatial index as they are initialized
+  this->dataPtr->spatialIndex.reset(new physics::SpatialIndex());
+
+  this->dataPtr->stepBuffers.reset(new physics::StepBuffers());
+
   // This should come after loading physics engine
   sdf::ElementPtr atmosphereElem = this->dataPtr->sdf->GetElement("atmosphere");
 
@@ -415,6 +462,8 @@ void World::Init(UpdateScenePosesFunc _func)
     return;
   }
 
+  event::ScopedEventWorld scopedWorld(this->Name());
+
   // Initialize all the entities (i.e. Model)
   for (unsigned int i = 0; i < this->dataPtr->rootElement->GetChildCount(); ++i)
     this->dataPtr->rootElement->GetChild(i)->Init();
@@ -513,6 +562,8 @@ void World::Stop()
 {
   this->dataPtr->stop = true;
 
+  event::ScopedEventWorld scopedWorld(this->Name());
+
   // Make sure that the thread does not try to join with itself
   if (this->dataPtr->thread &&
      this->dataPtr->thread->get_id() != std::this_thread::get_id())
@@ -584,6 +635,8 @@ void World::RunLoop()
 //////////////////////////////////////////////////
 void World::LogStep()
 {
+  event::ScopedEventWorld scopedWorld(this->Name());
+
   {
     std::lock_guard<std::recursive_mutex> lk(this->dataPtr->worldUpdateMutex);
 
@@ -676,6 +729,9 @@ void World::SetSensorWaitFunc(std::function<void(double, double)> _func)
 //////////////////////////////////////////////////
 void World::Step()
 {
+  // Plugins loaded and events signaled while stepping belong to this world
+  event::ScopedEventWorld scopedWorld(this->Name());
+
   DIAG_TIMER_START("World::Step");
 
   IGN_PROFILE("World::Step");
@@ -830,6 +886,31 @@ void World::Update()
   IGN_PROFILE_END();
   DIAG_TIMER_LAP("World::Update", "Events::worldUpdateBegin");
 
+  IGN_PROFILE_BEGIN("activeLinks");
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->activeLinksMutex);
+    this->dataPtr->activeLinksUpdate = this->dataPtr->activeLinks;
+  }
+  for (Link *link : this->dataPtr->activeLinksUpdate)
+    link->Update(this->dataPtr->updateInfo);
+  IGN_PROFILE_END();
+  DIAG_TIMER_LAP("World::Update", "Link::Update");
+
+  IGN_PROFILE_BEGIN("wind");
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->activeLinksMutex);
+    this->dataPtr->windLinksUpdate = this->dataPtr->windLinks;
+  }
+  if (!this->dataPtr->windLinksUpdate.empty())
+    this->dataPtr->wind->UpdateLinks(this->dataPtr->windLinksUpdate);
+  IGN_PROFILE_END();
+  DIAG_TIMER_LAP("World::Update", "Wind::UpdateLinks");
+
+  IGN_PROFILE_BEGIN("modelLocalUpdates");
+  this->dataPtr->modelLocalUpdates.Run(this->dataPtr->updateInfo);
+  IGN_PROFILE_END();
+  DIAG_TIMER_LAP("World::Update", "ModelLocalUpdateGroup::Run");
+
   IGN_PROFILE_BEGIN("Update");
   // Update all the models
   (*this.*dataPtr->modelUpdateFunc)();
@@ -869,6 +950,10 @@ void World::Update()
   // Update the physics engine
   if (this->dataPtr->enablePhysicsEngine && this->dataPtr->physicsEngine)
   {
+    IGN_PROFILE_BEGIN("StepBuffers::ApplyActions");
+    this->dataPtr->stepBuffers->ApplyActions();
+    IGN_PROFILE_END();
+
     IGN_PROFILE_BEGIN("UpdatePhysics");
     // This must be called directly after PhysicsEngine::UpdateCollision.
     this->dataPtr->physicsEngine->UpdatePhysics();
@@ -879,20 +964,9 @@ void World::Update()
     // do this after physics update as
     //   ode --> MoveCallback sets the dirtyPoses
     //           and we need to propagate it into Entity::worldPose
-    {
-      IGN_PROFILE_BEGIN("SetWorldPose(dirtyPoses)");
-      // block any other pose updates (e.g. Joint::SetPosition)
-      boost::recursive_mutex::scoped_lock plock(
-          *this->Physics()->GetPhysicsUpdateMutex());
-
-      for (auto &dirtyEntity : this->dataPtr->dirtyPoses)
-      {
-        dirtyEntity->SetWorldPose(dirtyEntity->DirtyPose(), false);
-      }
-
-      this->dataPtr->dirtyPoses.clear();
-      IGN_PROFILE_END();
-    }
+    IGN_PROFILE_BEGIN("SetWorldPose(dirtyPoses)");
+    this->UpdateDirtyPoses();
+    IGN_PROFILE_END();
 
     DIAG_TIMER_LAP("World::Update", "SetWorldPose(dirtyPoses)");
   }
@@ -911,6 +985,11 @@ void World::Update()
   IGN_PROFILE_END();
   DIAG_TIMER_LAP("World::Update", "ContactManager::PublishContacts");
 
+  IGN_PROFILE_BEGIN("StepBuffers::WriteObservations");
+  this->dataPtr->stepBuffers->WriteObservations();
+  IGN_PROFILE_END();
+  DIAG_TIMER_LAP("World::Update", "StepBuffers::WriteObservations");
+
   event::Events::worldUpdateEnd();
 
   gazebo::util::IntrospectionManager::Instance()->Update();
@@ -943,6 +1022,7 @@ void World::Fini()
     this->dataPtr->guiPub.reset();
     this->dataPtr->responsePub.reset();
     this->dataPtr->statPub.reset();
+    this->dataPtr->callbackStatsPub.reset();
     this->dataPtr->modelPub.reset();
     this->dataPtr->lightPub.reset();
     this->dataPtr->lightFactoryPub.reset();
@@ -1012,6 +1092,8 @@ void World::Fini()
 
   this->dataPtr->atmosphere.reset();
   this->dataPtr->wind.reset();
+  this->dataPtr->spatialIndex.reset();
+  this->dataPtr->stepBuffers.reset();
 
   // Engine shouldn't outlive world
   if (this->dataPtr->physicsEngine)
@@ -1081,6 +1163,18 @@ Wind &World::Wind() const
   return *this->dataPtr->wind;
 }
 
+//////////////////////////////////////////////////
+SpatialIndex &World::SpatialIndex() const
+{
+  return *this->dataPtr->spatialIndex;
+}
+
+//////////////////////////////////////////////////
+StepBuffers &World::StepBuffers() const
+{
+  return *this->dataPtr->stepBuffers;
+}
+
 //////////////////////////////////////////////////
 Atmosphere &World::Atmosphere() const
 {
@@ -1377,6 +1471,7 @@ void World::ResetTime()
 
   // Signal a reset has occurred. The SensorManager listens to this event
   // to reset each sensor's last update time.
+  event::ScopedEventWorld scopedWorld(this->Name());
   event::Events::timeReset();
 }
 
@@ -1407,12 +1502,93 @@ void World::Reset()
     this->dataPtr->physicsEngine->Reset();
 
     // Signal a reset has occurred
+    event::ScopedEventWorld scopedWorld(this->Name());
     event::Events::worldReset();
   }
 
   this->SetPaused(currentlyPaused);
 }
 
+//////////////////////////////////////////////////
+void World::UpdateDirtyPoses()
+{
+  // block any other pose updates (e.g. Joint::SetPosition)
+  boost::recursive_mutex::scoped_lock plock(
+      *this->Physics()->GetPhysicsUpdateMutex());
+
+  for (auto &dirtyEntity : this->dataPtr->dirtyPoses)
+  {
+    dirtyEntity->SetWorldPose(dirtyEntity->DirtyPose(), false);
+  }
+  this->dataPtr->spatialIndex->MarkDirty(this->dataPtr->dirtyPoses);
+
+  this->dataPtr->dirtyPoses.clear();
+}
+
+//////////////////////////////////////////////////
+WorldSnapshotPtr World::Snapshot()
+{
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->worldUpdateMutex);
+
+  std::vector<uint8_t> engineState;
+  if (!this->dataPtr->physicsEngine->SaveSnapshot(engineState))
+  {
+    gzerr << "Unable to take a snapshot of world [" << this->Name()
+          << "] with the " << this->dataPtr->physicsEngine->GetType()
+          << " physics engine\n";
+    return nullptr;
+  }
+
+  return std::make_shared<WorldSnapshot>(this->Name(),
+      this->dataPtr->physicsEngine->GetType(), this->dataPtr->simTime,
+      this->dataPtr->iterations, ignition::math::Rand::Seed(),
+      std::move(engineState));
+}
+
+//////////////////////////////////////////////////
+bool World::Restore(const WorldSnapshotPtr &_snapshot)
+{
+  if (!_snapshot)
+  {
+    gzerr << "Null snapshot\n";
+    return false;
+  }
+
+  if (_snapshot->WorldName() != this->Name() ||
+      _snapshot->EngineType() != this->dataPtr->physicsEngine->GetType())
+  {
+    gzerr << "Snapshot of world [" << _snapshot->WorldName() << "] with the "
+          << _snapshot->EngineType() << " physics engine can not be restored "
+          << "into world [" << this->Name() << "] with the "
+          << this->dataPtr->physicsEngine->GetType() << " physics engine\n";
+    return false;
+  }
+
+  std::lock_guard<std::recursive_mutex> lock(this->dataPtr->worldUpdateMutex);
+
+  if (!this->dataPtr->physicsEngine->RestoreSnapshot(
+        _snapshot->EngineState()))
+  {
+    return false;
+  }
+
+  // Contacts of the last step no longer exist
+  this->dataPtr->physicsEngine->GetContactManager()->Clear();
+  this->UpdateDirtyPoses();
+
+  // Restart the random sequence, as Reset does
+  ignition::math::Rand::Seed(_snapshot->RandSeed());
+
+  this->dataPtr->simTime = _snapshot->SimTime();
+  this->dataPtr->iterations = _snapshot->Iterations();
+
+  // Sensors reset their last update time, as after ResetTime
+  event::ScopedEventWorld scopedWorld(this->Name());
+  event::Events::timeReset();
+
+  return true;
+}
+
 //////////////////////////////////////////////////
 void World::OnStep()
 {
@@ -1501,6 +1677,7 @@ void World::SetPaused(const bool _p)
       this->dataPtr->pauseStartTime;
   }
 
+  event::ScopedEventWorld scopedWorld(this->Name());
   event::Events::pause(_p);
 }
 
@@ -1733,11 +1910,21 @@ void World::LoadPlugin(const std::string &_filename,
             << "Plugin filename[" << _filename << "] name[" << _name << "]\n";
       return;
     }
-    plugin->Load(shared_from_this(), _sdf);
+    // Attribute the callbacks connected by the plugin to it, and the time
+    // spent in its Load and Init functions
+    const std::string owner = "world/" + _name;
+    event::ScopedCallbackOwner scopedOwner(owner);
+
+    WorldPtr myself = shared_from_this();
+    event::CallbackAccounting::PluginCall(owner, "Load",
+        [&plugin, &myself, &_sdf] { plugin->Load(myself, _sdf); });
     this->dataPtr->plugins.push_back(plugin);
 
     if (this->dataPtr->initialized)
-      plugin->Init();
+    {
+      event::CallbackAccounting::PluginCall(owner, "Init",
+          [&plugin] { plugin->Init(); });
+    }
   }
 }
 
@@ -1755,6 +1942,13 @@ void World::RemovePlugin(const std::string &_name)
   }
 }
 
+//////////////////////////////////////////////////
+event::ConnectionPtr World::ConnectModelLocalUpdate(ModelPtr _model,
+    const std::function<void (const common::UpdateInfo &)> &_subscriber)
+{
+  return this->dataPtr->modelLocalUpdates.Connect(_model, _subscriber);
+}
+
 //////////////////////////////////////////////////
 void World::LoadPlugin(sdf::ElementPtr _sdf)
 {
@@ -2318,6 +2512,18 @@ EntityPtr World::EntityBelowPoint(const ignition::math::Vector3d &_pt) const
   end = _pt;
   end.Z() -= 1000;
 
+  // The query refreshes the bounding boxes through the physics engine
+  boost::recursive_mutex::scoped_lock plock(
+      *this->dataPtr->physicsEngine->GetPhysicsUpdateMutex());
+
+  // Skip the ray test when no bounding box lies below the point. Only ODE
+  // reports the bounding boxes of collisions in the world frame.
+  if (this->dataPtr->physicsEngine->GetType() == "ode" &&
+      this->dataPtr->spatialIndex->LinksOnRay(_pt, end).empty())
+  {
+    return EntityPtr();
+  }
+
   this->dataPtr->physicsEngine->InitForThread();
   this->dataPtr->testRay->SetPoints(_pt, end);
   this->dataPtr->testRay->GetIntersection(dist, entityName);
@@ -2888,6 +3094,28 @@ void World::PublishWorldStats()
   if (this->dataPtr->statPub && this->dataPtr->statPub->HasConnections())
     this->dataPtr->statPub->Publish(this->dataPtr->worldStatsMsg);
   this->dataPtr->prevStatTime = common::Time::GetWallTime();
+
+  // Callback statistics are computed over a rolling window, once per second
+  // is enough.
+  if (this->dataPtr->callbackStatsPub &&
+      this->dataPtr->callbackStatsPub->HasConnections() &&
+      this->dataPtr->prevStatTime - this->dataPtr->prevCallbackStatsTime >=
+      common::Time(1, 0))
+  {
+    msgs::CallbackStatistics msg;
+    msgs::Set(msg.mutable_sim_time(), this->SimTime());
+    for (auto const &stats : event::CallbackAccounting::AllStats())
+    {
+      msgs::CallbackStatistics::Callback *callback = msg.add_callback();
+      callback->set_name(stats->Name());
+      callback->set_count(stats->Count());
+      callback->set_mean(stats->Mean());
+      callback->set_p99(stats->Percentile(0.99));
+      callback->set_max(stats->Max());
+    }
+    this->dataPtr->callbackStatsPub->Publish(msg);
+    this->dataPtr->prevCallbackStatsTime = this->dataPtr->prevStatTime;
+  }
 }
 
 //////////////////////////////////////////////////
@@ -3227,6 +3455,50 @@ void World::_AddDirty(Entity *_entity)
   this->dataPtr->dirtyPoses.push_back(_entity);
 }
 
+/////////////////////////////////////////////////
+void World::_SetLinkActive(Link *_link, const bool _active)
+{
+  GZ_ASSERT(_link != nullptr, "_link is nullptr");
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->activeLinksMutex);
+  SetLinkMember(_link, _active, this->dataPtr->activeLinks,
+      this->dataPtr->activeLinkIndex);
+}
+
+/////////////////////////////////////////////////
+void World::_SetLinkWind(Link *_link, const bool _enable)
+{
+  GZ_ASSERT(_link != nullptr, "_link is nullptr");
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->activeLinksMutex);
+  SetLinkMember(_link, _enable, this->dataPtr->windLinks,
+      this->dataPtr->windLinkIndex);
+}
+
+/////////////////////////////////////////////////
+void World::_SetLinkIndexed(Link *_link, const bool _indexed)
+{
+  GZ_ASSERT(_link != nullptr, "_link is nullptr");
+
+  // Links are finalized with their model, after the index in World::Fini
+  if (!this->dataPtr->spatialIndex)
+    return;
+
+  if (_indexed)
+    this->dataPtr->spatialIndex->AddLink(_link);
+  else
+    this->dataPtr->spatialIndex->RemoveLink(_link);
+}
+
+/////////////////////////////////////////////////
+void World::_SetLinkIndexDirty(Link *_link)
+{
+  GZ_ASSERT(_link != nullptr, "_link is nullptr");
+
+  if (this->dataPtr->spatialIndex)
+    this->dataPtr->spatialIndex->MarkDirty(_link);
+}
+
 /////////////////////////////////////////////////
 void World::ResetPhysicsStates()
 {
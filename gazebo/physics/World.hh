@@ -40,6 +40,8 @@
 #include "gazebo/physics/Base.hh"
 #include "gazebo/physics/PhysicsTypes.hh"
 #include "gazebo/physics/WorldState.hh"
+#include "gazebo/physics/SpatialIndex.hh"
+#include "gazebo/physics/StepBuffers.hh"
 #include "gazebo/physics/Wind.hh"
 #include "gazebo/util/system.hh"
 
@@ -155,6 +157,17 @@ namespace gazebo
       /// \return Reference to the wind.
       public: physics::Wind &Wind() const;
 
+      /// \brief Get the index of the bounding boxes of the world's links
+      /// and models, used to find the entities in a region of the world.
+      /// Hold the physics update mutex while querying it.
+      /// \return Reference to the spatial index.
+      public: physics::SpatialIndex &SpatialIndex() const;
+
+      /// \brief Get the batched observation and action buffers, which are
+      /// read before and written after every physics update.
+      /// \return Reference to the step buffers.
+      public: physics::StepBuffers &StepBuffers() const;
+
       /// \brief Return the spherical coordinates converter.
       /// \return Pointer to the spherical coordinates converter.
       public: common::SphericalCoordinatesPtr SphericalCoords() const;
@@ -297,6 +310,26 @@ namespace gazebo
       /// \param _state The state to set the World to.
       public: void SetState(const WorldState &_state);
 
+      /// \brief Take a snapshot of the world, e.g. to reset training
+      /// episodes quickly with Restore. Unlike WorldState, the snapshot holds
+      /// the physics engine's own state, such as the solver's warm start
+      /// values. Restoring it and stepping again gives the same results as
+      /// the first time with ODE, including its contact cache, and DART.
+      /// Bullet contacts restart without warm start values, the same way
+      /// after every restore. Simbody does not support snapshots. The state
+      /// of plugins and sensors is not part of the snapshot.
+      /// \return The snapshot, null and an error is logged if the physics
+      /// engine does not support snapshots.
+      public: WorldSnapshotPtr Snapshot();
+
+      /// \brief Restore a snapshot taken by Snapshot, without going through
+      /// SDF or messages. The world must have the same entities as when the
+      /// snapshot was taken. The simulation time is restored and the random
+      /// number generator is seeded again, as by Reset.
+      /// \param[in] _snapshot Snapshot of this world.
+      /// \return True if the snapshot was restored.
+      public: bool Restore(const WorldSnapshotPtr &_snapshot);
+
       /// \brief Insert a model from an SDF file.
       /// Spawns a model into the world base on and SDF file.
       /// \param[in] _sdfFilename The name of the SDF file (including path).
@@ -343,6 +376,20 @@ namespace gazebo
       /// \param[in] _name The unique name of the plugin to remove.
       public: void RemovePlugin(const std::string &_name);
 
+      /// \brief Connect an update callback that only modifies the entities
+      /// of one model. Model-local callbacks run concurrently on a worker
+      /// pool after the worldUpdateBegin event and before physics. A
+      /// ModelPlugin with <model_local>true</model_local> in its SDF has its
+      /// worldUpdateBegin connections made through this function.
+      /// \param[in] _model Model the callback is local to.
+      /// \param[in] _subscriber Callback.
+      /// \return Connection, the callback is disconnected when it goes out
+      /// of scope.
+      /// \sa ModelLocalUpdateGroup
+      public: event::ConnectionPtr ConnectModelLocalUpdate(ModelPtr _model,
+                  const std::function<void (const common::UpdateInfo &)>
+                  &_subscriber);
+
       /// \brief Get the set world pose mutex.
       /// \return Reference to the mutex.
       public: std::mutex &WorldPoseMutex() const;
@@ -438,6 +485,37 @@ namespace gazebo
       /// \param[in] _entity Entity that has moved.
       public: void _AddDirty(Entity *_entity);
 
+      /// \internal
+      /// \brief Add a link to, or remove it from, the links updated on
+      /// every world update. Links are only active while they have audio,
+      /// queued wrench messages or batteries. Only Link should
+      /// call this function. Thread safe.
+      /// \param[in] _link The link.
+      /// \param[in] _active True to add the link, false to remove it.
+      public: void _SetLinkActive(Link *_link, const bool _active);
+
+      /// \internal
+      /// \brief Add a link to, or remove it from, the links whose wind
+      /// velocity is computed on every world update, in a single
+      /// Wind::UpdateLinks pass. Only Link should call this function.
+      /// Thread safe.
+      /// \param[in] _link The link.
+      /// \param[in] _enable True if wind is enabled for the link.
+      public: void _SetLinkWind(Link *_link, const bool _enable);
+
+      /// \internal
+      /// \brief Add a link to, or remove it from, the spatial index.
+      /// Only Link should call this function. Thread safe.
+      /// \param[in] _link The link.
+      /// \param[in] _indexed True to add the link, false to remove it.
+      public: void _SetLinkIndexed(Link *_link, const bool _indexed);
+
+      /// \internal
+      /// \brief Inform the spatial index that a link was moved outside of
+      /// a physics update. Only Link should call this function. Thread safe.
+      /// \param[in] _link The link.
+      public: void _SetLinkIndexDirty(Link *_link);
+
       /// \brief Get whether sensors have been initialized.
       /// \return True if sensors have been initialized.
       public: bool SensorsInitialized() const;
@@ -520,6 +598,10 @@ namespace gazebo
       /// \brief Update the world.
       private: void Update();
 
+      /// \brief Update the world poses of the entities moved by the physics
+      /// engine.
+      private: void UpdateDirtyPoses();
+
       /// \brief Pause callback.
       /// \param[in] _p True if paused.
       private: void OnPause(bool _p);
@@ -27,6 +27,7 @@
 #include <string>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <condition_variable>
 
 #include <ignition/transport.hh>
@@ -39,6 +40,7 @@
 
 #include "gazebo/transport/TransportTypes.hh"
 
+#include "gazebo/physics/ModelLocalUpdateGroup.hh"
 #include "gazebo/physics/PhysicsTypes.hh"
 #include "gazebo/physics/WorldState.hh"
 
@@ -58,6 +60,12 @@ namespace gazebo
       /// \brief Unique pointer the wind. The world owns this pointer.
       public: std::unique_ptr<Wind> wind;
 
+      /// \brief Index of the bounding boxes of links and models.
+      public: std::unique_ptr<SpatialIndex> spatialIndex;
+
+      /// \brief Batched observations and actions.
+      public: std::unique_ptr<StepBuffers> stepBuffers;
+
       /// \brief Unique pointer the atmosphere model.
       /// The world owns this pointer.
       public: std::unique_ptr<Atmosphere> atmosphere;
@@ -101,6 +109,36 @@ namespace gazebo
       /// \brief Publisher for world statistics messages.
       public: transport::PublisherPtr statPub;
 
+      /// \brief Links to update on every world update, see
+      /// World::_SetLinkActive.
+      public: std::vector<Link *> activeLinks;
+
+      /// \brief Index of each link in activeLinks.
+      public: std::unordered_map<const Link *, size_t> activeLinkIndex;
+
+      /// \brief Copy of activeLinks iterated during the update, so links
+      /// can join or leave while being updated.
+      public: std::vector<Link *> activeLinksUpdate;
+
+      /// \brief Links with wind enabled, see World::_SetLinkWind.
+      public: std::vector<Link *> windLinks;
+
+      /// \brief Index of each link in windLinks.
+      public: std::unordered_map<const Link *, size_t> windLinkIndex;
+
+      /// \brief Copy of windLinks used during the update.
+      public: std::vector<Link *> windLinksUpdate;
+
+      /// \brief Protects activeLinks, windLinks and their indices.
+      public: std::mutex activeLinksMutex;
+
+      /// \brief Model-local update callbacks, run in parallel.
+      public: ModelLocalUpdateGroup modelLocalUpdates;
+
+      /// \brief Publisher for callback statistics messages. Only
+      /// advertised when callback accounting is enabled.
+      public: transport::PublisherPtr callbackStatsPub;
+
       /// \brief Publisher for request response messages.
       public: transport::PublisherPtr responsePub;
 
@@ -161,6 +199,9 @@ namespace gazebo
       /// \brief Last time a world statistics message was sent.
       public: common::Time prevStatTime;
 
+      /// \brief Last time a callback statistics message was sent.
+      public: common::Time prevCallbackStatsTime;
+
       /// \brief Time at which pause started.
       public: common::Time pauseStartTime;
 
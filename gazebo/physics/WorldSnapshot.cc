@@ -0,0 +1,108 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <utility>
+
+#include "gazebo/physics/WorldSnapshot.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+/// \brief Private data for WorldSnapshot.
+class gazebo::physics::WorldSnapshotPrivate
+{
+  /// \brief Name of the world.
+  public: std::string worldName;
+
+  /// \brief Type of the physics engine.
+  public: std::string engineType;
+
+  /// \brief Simulation time.
+  public: common::Time simTime;
+
+  /// \brief Number of iterations.
+  public: uint64_t iterations = 0;
+
+  /// \brief Seed of the random number generator.
+  public: uint32_t randSeed = 0;
+
+  /// \brief State saved by the physics engine.
+  public: std::vector<uint8_t> engineState;
+};
+
+//////////////////////////////////////////////////
+WorldSnapshot::WorldSnapshot(const std::string &_worldName,
+    const std::string &_engineType, const common::Time &_simTime,
+    const uint64_t _iterations, const uint32_t _randSeed,
+    std::vector<uint8_t> &&_engineState)
+  : dataPtr(new WorldSnapshotPrivate)
+{
+  this->dataPtr->worldName = _worldName;
+  this->dataPtr->engineType = _engineType;
+  this->dataPtr->simTime = _simTime;
+  this->dataPtr->iterations = _iterations;
+  this->dataPtr->randSeed = _randSeed;
+  this->dataPtr->engineState = std::move(_engineState);
+}
+
+//////////////////////////////////////////////////
+WorldSnapshot::~WorldSnapshot()
+{
+}
+
+//////////////////////////////////////////////////
+const std::string &WorldSnapshot::WorldName() const
+{
+  return this->dataPtr->worldName;
+}
+
+//////////////////////////////////////////////////
+const std::string &WorldSnapshot::EngineType() const
+{
+  return this->dataPtr->engineType;
+}
+
+//////////////////////////////////////////////////
+const common::Time &WorldSnapshot::SimTime() const
+{
+  return this->dataPtr->simTime;
+}
+
+//////////////////////////////////////////////////
+uint64_t WorldSnapshot::Iterations() const
+{
+  return this->dataPtr->iterations;
+}
+
+//////////////////////////////////////////////////
+uint32_t WorldSnapshot::RandSeed() const
+{
+  return this->dataPtr->randSeed;
+}
+
+//////////////////////////////////////////////////
+const std::vector<uint8_t> &WorldSnapshot::EngineState() const
+{
+  return this->dataPtr->engineState;
+}
+
+//////////////////////////////////////////////////
+size_t WorldSnapshot::Size() const
+{
+  return sizeof(*this) + sizeof(WorldSnapshotPrivate) +
+    this->dataPtr->engineState.size();
+}
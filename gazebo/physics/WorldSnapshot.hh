@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_WORLDSNAPSHOT_HH_
+#define GAZEBO_PHYSICS_WORLDSNAPSHOT_HH_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gazebo/common/Time.hh"
+#include "gazebo/physics/PhysicsTypes.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace physics
+  {
+    // Forward declare private data.
+    class WorldSnapshotPrivate;
+
+    /// \addtogroup gazebo_physics
+    /// \{
+
+    /// \class WorldSnapshot WorldSnapshot.hh physics/physics.hh
+    /// \brief In-memory state of a world, taken by World::Snapshot and
+    /// restored by World::Restore.
+    ///
+    /// Unlike WorldState, a snapshot holds the physics engine's own state,
+    /// such as the solver's warm start values, so that restoring it and
+    /// stepping again gives the same result as the first time. The engine
+    /// state is opaque: it can only be restored into the world it was taken
+    /// from, while that world has the same entities.
+    class GZ_PHYSICS_VISIBLE WorldSnapshot
+    {
+      /// \brief Constructor.
+      /// \param[in] _worldName Name of the world.
+      /// \param[in] _engineType Type of the physics engine,
+      /// see PhysicsEngine::GetType.
+      /// \param[in] _simTime Simulation time.
+      /// \param[in] _iterations Number of iterations.
+      /// \param[in] _randSeed Seed of the random number generator.
+      /// \param[in] _engineState State saved by the physics engine.
+      public: WorldSnapshot(const std::string &_worldName,
+                  const std::string &_engineType,
+                  const common::Time &_simTime, const uint64_t _iterations,
+                  const uint32_t _randSeed,
+                  std::vector<uint8_t> &&_engineState);
+
+      /// \brief Destructor.
+      public: ~WorldSnapshot();
+
+      /// \brief Get the name of the world the snapshot was taken from.
+      /// \return Name of the world.
+      public: const std::string &WorldName() const;
+
+      /// \brief Get the type of the physics engine that saved the snapshot.
+      /// \return Type of the physics engine.
+      public: const std::string &EngineType() const;
+
+      /// \brief Get the simulation time of the snapshot.
+      /// \return Simulation time.
+      public: const common::Time &SimTime() const;
+
+      /// \brief Get the number of iterations of the snapshot.
+      /// \return Number of iterations.
+      public: uint64_t Iterations() const;
+
+      /// \brief Get the seed of the random number generator.
+      /// \return Seed.
+      public: uint32_t RandSeed() const;
+
+      /// \brief Get the state saved by the physics engine.
+      /// \return Opaque state of the physics engine.
+      public: const std::vector<uint8_t> &EngineState() const;
+
+      /// \brief Get the size of the snapshot.
+      /// \return Size in bytes.
+      public: size_t Size() const;
+
+      /// \internal
+      /// \brief Private data pointer.
+      private: std::unique_ptr<WorldSnapshotPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
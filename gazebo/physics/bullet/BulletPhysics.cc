@@ -15,8 +15,17 @@
  *
 */
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
 #include <algorithm>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
 #include <ignition/math/Rand.hh>
@@ -67,6 +76,157 @@ using namespace physics;
 
 GZ_REGISTER_PHYSICS_ENGINE("bullet", BulletPhysics)
 
+namespace
+{
+  /// \brief Number of btScalars saved per rigid body: the world and
+  /// interpolation transforms as OpenGL matrices, the velocities, the
+  /// interpolation velocities, the activation state and the deactivation
+  /// time.
+  const size_t kBodyStateSize = 16 + 16 + 4 * 3 + 2;
+
+  /// \brief Save a vector.
+  /// \param[in] _v Vector.
+  /// \param[out] _state Position in the state, moved past the vector.
+  void SaveVector(const btVector3 &_v, btScalar *&_state)
+  {
+    *_state++ = _v.x();
+    *_state++ = _v.y();
+    *_state++ = _v.z();
+  }
+
+  /// \brief Load a vector.
+  /// \param[in,out] _state Position in the state, moved past the vector.
+  /// \return Vector.
+  btVector3 LoadVector(const btScalar *&_state)
+  {
+    btVector3 v(_state[0], _state[1], _state[2]);
+    _state += 3;
+    return v;
+  }
+
+  /// \brief Minimum number of contact manifolds converted to contact
+  /// feedback by each task.
+  const size_t kManifoldsPerTask = 32;
+
+  /// \brief Contact manifold converted to contact feedback.
+  struct ManifoldFeedback
+  {
+    /// \brief The manifold.
+    const btPersistentManifold *manifold;
+
+    /// \brief Link of the first body.
+    BulletLink *link1;
+
+    /// \brief Link of the second body.
+    BulletLink *link2;
+
+    /// \brief Contact filled from the points of the manifold.
+    Contact *contact;
+  };
+
+  // TODO added here for ABI compatibility
+  // move to a private data class when merging forward
+  /// \brief Threading state of a Bullet world.
+  struct BulletThreading
+  {
+    /// \brief Pool of constraint solvers of a multi-threaded world, one
+    /// per thread, null for the single-threaded world.
+    btConstraintSolver *solverPool = nullptr;
+
+    /// \brief Bullet task scheduler of a multi-threaded world, null for
+    /// the single-threaded world.
+    btITaskScheduler *scheduler = nullptr;
+
+    /// \brief Number of threads stepping the world.
+    int threads = 1;
+
+    /// \brief Arena that keeps the parallel contact feedback to the
+    /// number of threads, null when the world steps on one thread.
+    std::unique_ptr<tbb::task_arena> contactArena;
+
+    /// \brief Name of the Bullet task scheduler.
+    std::string taskScheduler = "default";
+  };
+
+  /// \brief Threading state of each Bullet world.
+  std::map<const BulletPhysics *, std::unique_ptr<BulletThreading>>
+      threadingStates;
+
+  /// \brief Protects threadingStates.
+  std::mutex threadingStatesMutex;
+
+  /// \brief Get the threading state of a Bullet world, creating it if
+  /// needed.
+  /// \param[in] _physics The physics engine.
+  /// \return The threading state, which lives until the engine is
+  /// destroyed.
+  BulletThreading &Threading(const BulletPhysics *_physics)
+  {
+    std::lock_guard<std::mutex> lock(threadingStatesMutex);
+    std::unique_ptr<BulletThreading> &state = threadingStates[_physics];
+    if (!state)
+      state.reset(new BulletThreading);
+    return *state;
+  }
+
+  /// \brief Bullet has one task scheduler for the whole process. This
+  /// guards it, and has the multi-threaded worlds of the process step one
+  /// at a time, each with its own thread count.
+  std::mutex schedulerMutex;
+
+  /// \brief Check the name of a Bullet task scheduler.
+  /// \param[in] _name Name of the scheduler.
+  /// \return True if the name is known.
+  bool IsTaskScheduler(const std::string &_name)
+  {
+    return _name == "default" || _name == "openmp" || _name == "tbb" ||
+        _name == "ppl";
+  }
+
+#ifdef LIBBULLET_VERSION_GE_288
+  /// \brief Name of the task scheduler used by the process, empty until
+  /// the first multi-threaded world is created.
+  std::string activeScheduler;
+
+  /// \brief Minimum number of overlapping pairs handled by each task of
+  /// btCollisionDispatcherMt, Bullet's default.
+  const int kDispatcherGrainSize = 40;
+
+  /// \brief Create a Bullet task scheduler.
+  /// \param[in] _name Name of the scheduler.
+  /// \return The scheduler, which lives until the process exits. Null if
+  /// Bullet was built without it.
+  btITaskScheduler *CreateTaskScheduler(const std::string &_name)
+  {
+    if (_name == "openmp")
+      return btGetOpenMPTaskScheduler();
+    if (_name == "tbb")
+      return btGetTBBTaskScheduler();
+    if (_name == "ppl")
+      return btGetPPLTaskScheduler();
+    return btCreateDefaultTaskScheduler();
+  }
+#endif
+
+  /// \brief Lock the task scheduler for a step of a multi-threaded world.
+  /// \param[in] _scheduler The scheduler.
+  /// \param[in] _threads Number of threads stepping the world.
+  /// \return The lock.
+  std::unique_lock<std::mutex> LockScheduler(btITaskScheduler *_scheduler,
+      const int _threads)
+  {
+    std::unique_lock<std::mutex> lock(schedulerMutex);
+#ifdef LIBBULLET_VERSION_GE_288
+    if (_scheduler->getNumThreads() != _threads)
+      _scheduler->setNumThreads(_threads);
+#else
+    (void)_scheduler;
+    (void)_threads;
+#endif
+    return lock;
+  }
+}
+
 extern ContactAddedCallback gContactAddedCallback;
 extern ContactProcessedCallback gContactProcessedCallback;
 
@@ -132,16 +292,21 @@ struct CollisionFilter : public btOverlapFilterCallback
 // Gets the contact information in the current state of
 // the world, updates the contact manager and
 // and sets the contact feedback information.
-void UpdateContacts(btDynamicsWorld *_world, btScalar _timeStep)
+void BulletPhysics::UpdateContacts(const btScalar _timeStep)
 {
-  int numManifolds = _world->getDispatcher()->getNumManifolds();
+  btDynamicsWorld *world = this->dynamicsWorld;
+  ContactManager *contactManager = this->contactManager;
+
+  // The contact manager is not thread safe, so the contacts are created
+  // first, then filled from their manifolds in parallel.
+  std::vector<ManifoldFeedback> feedback;
+  int numManifolds = world->getDispatcher()->getNumManifolds();
   for (int i = 0; i < numManifolds; ++i)
   {
     btPersistentManifold *contactManifold =
-        _world->getDispatcher()->getManifoldByIndexInternal(i);
+        world->getDispatcher()->getManifoldByIndexInternal(i);
 
-    const int numContacts = contactManifold->getNumContacts();
-    if (0 == numContacts)
+    if (0 == contactManifold->getNumContacts())
       continue;
 
     const btCollisionObject *obA =
@@ -149,9 +314,6 @@ void UpdateContacts(btDynamicsWorld *_world, btScalar _timeStep)
     const btCollisionObject *obB =
         static_cast<const btCollisionObject *>(contactManifold->getBody1());
 
-    const btRigidBody *rbA = btRigidBody::upcast(obA);
-    const btRigidBody *rbB = btRigidBody::upcast(obB);
-
     BulletLink *link1 = static_cast<BulletLink *>(
         obA->getUserPointer());
     GZ_ASSERT(link1 != nullptr, "Link1 in collision pair is null");
@@ -167,31 +329,42 @@ void UpdateContacts(btDynamicsWorld *_world, btScalar _timeStep)
     if (!collisionPtr1 || !collisionPtr2)
       continue;
 
-    PhysicsEnginePtr engine = collisionPtr1->GetWorld()->Physics();
-    BulletPhysicsPtr bulletPhysics =
-          boost::static_pointer_cast<BulletPhysics>(engine);
-
     // Add a new contact to the manager. This will return nullptr if no one is
     // listening for contact information.
-    Contact *contactFeedback = bulletPhysics->GetContactManager()->NewContact(
+    Contact *contactFeedback = contactManager->NewContact(
         collisionPtr1.get(), collisionPtr2.get(),
         collisionPtr1->GetWorld()->SimTime());
 
     if (!contactFeedback)
       continue;
 
-    auto body1Pose = link1->WorldPose();
-    auto body2Pose = link2->WorldPose();
-    ignition::math::Vector3d localForce1;
-    ignition::math::Vector3d localForce2;
-    ignition::math::Vector3d localTorque1;
-    ignition::math::Vector3d localTorque2;
+    feedback.push_back({contactManifold, link1, link2, contactFeedback});
+  }
 
-    for (int j = 0; j < numContacts; ++j)
+  auto fillContacts = [&](const tbb::blocked_range<size_t> &_r)
+  {
+    for (size_t i = _r.begin(); i != _r.end(); ++i)
     {
-      btManifoldPoint &pt = contactManifold->getContactPoint(j);
-      if (pt.getDistance() <= 0.f)
+      const btPersistentManifold *contactManifold = feedback[i].manifold;
+      BulletLink *link1 = feedback[i].link1;
+      BulletLink *link2 = feedback[i].link2;
+      Contact *contactFeedback = feedback[i].contact;
+
+      const btRigidBody *rbA = btRigidBody::upcast(
+          static_cast<const btCollisionObject *>(contactManifold->getBody0()));
+      const btRigidBody *rbB = btRigidBody::upcast(
+          static_cast<const btCollisionObject *>(contactManifold->getBody1()));
+
+      auto body1Pose = link1->WorldPose();
+      auto body2Pose = link2->WorldPose();
+
+      const int numContacts = contactManifold->getNumContacts();
+      for (int j = 0; j < numContacts; ++j)
       {
+        const btManifoldPoint &pt = contactManifold->getContactPoint(j);
+        if (pt.getDistance() > 0.f)
+          continue;
+
         const btVector3 &ptB = pt.getPositionWorldOnB();
         const btVector3 &normalOnB = pt.m_normalWorldOnB;
         btVector3 impulse = pt.m_appliedImpulse * normalOnB;
@@ -203,39 +376,63 @@ void UpdateContacts(btDynamicsWorld *_world, btScalar _timeStep)
         btVector3 torqueA = (ptB-rbA->getCenterOfMassPosition()).cross(force);
         btVector3 torqueB = (ptB-rbB->getCenterOfMassPosition()).cross(-force);
 
+        // Points that are not touching are skipped, so the contact is
+        // filled up to its count
+        const int k = contactFeedback->count;
+        contactFeedback->positions[k] = BulletTypes::ConvertVector3Ign(ptB);
+        contactFeedback->normals[k] = BulletTypes::ConvertVector3Ign(normalOnB);
+        contactFeedback->depths[k] = -pt.getDistance();
+
         // Convert from world to link frame
-        localForce1 = body1Pose.Rot().RotateVectorReverse(
-            BulletTypes::ConvertVector3Ign(force));
-        localForce2 = body2Pose.Rot().RotateVectorReverse(
-            BulletTypes::ConvertVector3Ign(-force));
-        localTorque1 = body1Pose.Rot().RotateVectorReverse(
-            BulletTypes::ConvertVector3Ign(torqueA));
-        localTorque2 = body2Pose.Rot().RotateVectorReverse(
-            BulletTypes::ConvertVector3Ign(torqueB));
-
-        contactFeedback->positions[j] = BulletTypes::ConvertVector3Ign(ptB);
-        contactFeedback->normals[j] = BulletTypes::ConvertVector3Ign(normalOnB);
-        contactFeedback->depths[j] = -pt.getDistance();
         if (!link1->IsStatic())
         {
-          contactFeedback->wrench[j].body1Force = localForce1;
-          contactFeedback->wrench[j].body1Torque = localTorque1;
+          contactFeedback->wrench[k].body1Force =
+              body1Pose.Rot().RotateVectorReverse(
+                  BulletTypes::ConvertVector3Ign(force));
+          contactFeedback->wrench[k].body1Torque =
+              body1Pose.Rot().RotateVectorReverse(
+                  BulletTypes::ConvertVector3Ign(torqueA));
         }
         if (!link2->IsStatic())
         {
-          contactFeedback->wrench[j].body2Force = localForce2;
-          contactFeedback->wrench[j].body2Torque = localTorque2;
+          contactFeedback->wrench[k].body2Force =
+              body2Pose.Rot().RotateVectorReverse(
+                  BulletTypes::ConvertVector3Ign(-force));
+          contactFeedback->wrench[k].body2Torque =
+              body2Pose.Rot().RotateVectorReverse(
+                  BulletTypes::ConvertVector3Ign(torqueB));
         }
         contactFeedback->count++;
       }
     }
+  };
+
+  // Each task fills its own contacts, and only reads the links. The arena
+  // keeps the tasks to the configured number of threads.
+  tbb::task_arena *contactArena = Threading(this).contactArena.get();
+  if (contactArena && feedback.size() > kManifoldsPerTask)
+  {
+    contactArena->execute([&]
+    {
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, feedback.size(), kManifoldsPerTask),
+          fillContacts);
+    });
+  }
+  else
+  {
+    fillContacts(tbb::blocked_range<size_t>(0, feedback.size()));
   }
 }
 
 //////////////////////////////////////////////////
-void InternalTickCallback(btDynamicsWorld *_world, btScalar _timeStep)
+void BulletPhysics::InternalTickCallback(btDynamicsWorld *_world,
+    btScalar _timeStep)
 {
-  UpdateContacts(_world, _timeStep);
+  BulletPhysics *bulletPhysics =
+      static_cast<BulletPhysics *>(_world->getWorldUserInfo());
+  GZ_ASSERT(bulletPhysics != nullptr, "Bullet world has no physics engine");
+  bulletPhysics->UpdateContacts(_timeStep);
 }
 
 //////////////////////////////////////////////////
@@ -316,6 +513,9 @@ BulletPhysics::BulletPhysics(WorldPtr _world)
 BulletPhysics::~BulletPhysics()
 {
   this->Fini();
+
+  std::lock_guard<std::mutex> lock(threadingStatesMutex);
+  threadingStates.erase(this);
 }
 
 //////////////////////////////////////////////////
@@ -325,6 +525,17 @@ void BulletPhysics::Load(sdf::ElementPtr _sdf)
 
   sdf::ElementPtr bulletElem = this->sdf->GetElement("bullet");
 
+  // The <bullet> schema lives in sdformat, so the optional threading
+  // elements are read when present. The world is still empty here, so it
+  // can become multi-threaded.
+  if (bulletElem->HasElement("task_scheduler"))
+  {
+    this->SetParam("task_scheduler",
+        bulletElem->Get<std::string>("task_scheduler"));
+  }
+  if (bulletElem->HasElement("threads"))
+    this->SetParam("threads", bulletElem->Get<int>("threads"));
+
   auto g = this->world->Gravity();
   // ODEPhysics checks this, so we will too.
   if (g == ignition::math::Vector3d::Zero)
@@ -505,13 +716,17 @@ void BulletPhysics::UpdateCollision()
     // this->dynamicsWorld->performDiscreteCollisionDetection().
 
     IGN_PROFILE_BEGIN("performDiscreteCollisionDetection");
+    const BulletThreading &threading = Threading(this);
+    std::unique_lock<std::mutex> schedulerLock;
+    if (threading.scheduler)
+      schedulerLock = LockScheduler(threading.scheduler, threading.threads);
     this->dynamicsWorld->performDiscreteCollisionDetection();
     IGN_PROFILE_END();
 
     // In addition, the contacts have to be updated in the contact
     // manager and for the feedback.
     IGN_PROFILE_BEGIN("UpdateContacts");
-    UpdateContacts(this->dynamicsWorld, this->maxStepSize);
+    this->UpdateContacts(this->maxStepSize);
     IGN_PROFILE_END();
   }
 }
@@ -525,6 +740,10 @@ void BulletPhysics::UpdatePhysics()
   boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
 
   IGN_PROFILE_BEGIN("stepSimulation");
+  const BulletThreading &threading = Threading(this);
+  std::unique_lock<std::mutex> schedulerLock;
+  if (threading.scheduler)
+    schedulerLock = LockScheduler(threading.scheduler, threading.threads);
   this->dynamicsWorld->stepSimulation(
     this->maxStepSize, 1, this->maxStepSize);
   IGN_PROFILE_END();
@@ -542,6 +761,14 @@ void BulletPhysics::Fini()
     delete this->solver;
   this->solver = nullptr;
 
+  BulletThreading &threading = Threading(this);
+  if (threading.solverPool)
+    delete threading.solverPool;
+  threading.solverPool = nullptr;
+  threading.scheduler = nullptr;
+  threading.threads = 1;
+  threading.contactArena.reset();
+
   if (this->broadPhase)
     delete this->broadPhase;
   this->broadPhase = nullptr;
@@ -567,6 +794,105 @@ void BulletPhysics::Reset()
 }
 
 //////////////////////////////////////////////////
+bool BulletPhysics::SaveSnapshot(std::vector<uint8_t> &_state)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+
+  const btCollisionObjectArray &objects =
+    this->dynamicsWorld->getCollisionObjectArray();
+
+  std::vector<btScalar> state;
+  state.reserve(objects.size() * kBodyStateSize);
+  for (int i = 0; i < objects.size(); ++i)
+  {
+    const btRigidBody *body = btRigidBody::upcast(objects[i]);
+    if (!body)
+      continue;
+
+    state.resize(state.size() + kBodyStateSize);
+    btScalar *values = state.data() + state.size() - kBodyStateSize;
+    body->getWorldTransform().getOpenGLMatrix(values);
+    body->getInterpolationWorldTransform().getOpenGLMatrix(values + 16);
+    values += 32;
+    SaveVector(body->getLinearVelocity(), values);
+    SaveVector(body->getAngularVelocity(), values);
+    SaveVector(body->getInterpolationLinearVelocity(), values);
+    SaveVector(body->getInterpolationAngularVelocity(), values);
+    *values++ = body->getActivationState();
+    *values++ = body->getDeactivationTime();
+  }
+
+  const uint64_t seed = this->solver->getRandSeed();
+  _state.resize(sizeof(seed) + state.size() * sizeof(btScalar));
+  std::memcpy(_state.data(), &seed, sizeof(seed));
+  std::memcpy(_state.data() + sizeof(seed), state.data(),
+      state.size() * sizeof(btScalar));
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool BulletPhysics::RestoreSnapshot(const std::vector<uint8_t> &_state)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+
+  const btCollisionObjectArray &objects =
+    this->dynamicsWorld->getCollisionObjectArray();
+
+  size_t bodyCount = 0;
+  for (int i = 0; i < objects.size(); ++i)
+  {
+    if (btRigidBody::upcast(objects[i]))
+      ++bodyCount;
+  }
+
+  uint64_t seed = 0;
+  if (_state.size() !=
+      sizeof(seed) + bodyCount * kBodyStateSize * sizeof(btScalar))
+  {
+    gzerr << "The links of the world changed since the snapshot\n";
+    return false;
+  }
+  std::memcpy(&seed, _state.data(), sizeof(seed));
+  std::vector<btScalar> state(bodyCount * kBodyStateSize);
+  std::memcpy(state.data(), _state.data() + sizeof(seed),
+      state.size() * sizeof(btScalar));
+
+  const btScalar *values = state.data();
+  for (int i = 0; i < objects.size(); ++i)
+  {
+    btRigidBody *body = btRigidBody::upcast(objects[i]);
+    if (!body)
+      continue;
+
+    btTransform transform;
+    transform.setFromOpenGLMatrix(values);
+    body->setWorldTransform(transform);
+    transform.setFromOpenGLMatrix(values + 16);
+    body->setInterpolationWorldTransform(transform);
+    values += 32;
+    body->setLinearVelocity(LoadVector(values));
+    body->setAngularVelocity(LoadVector(values));
+    body->setInterpolationLinearVelocity(LoadVector(values));
+    body->setInterpolationAngularVelocity(LoadVector(values));
+    body->forceActivationState(static_cast<int>(*values++));
+    body->setDeactivationTime(*values++);
+    body->clearForces();
+    this->dynamicsWorld->updateSingleAabb(body);
+
+    // Update the link, as synchronizeMotionStates does after a step
+    if (body->getMotionState())
+      body->getMotionState()->setWorldTransform(body->getWorldTransform());
+  }
+
+  // Contact manifolds hold the impulses that warm start the solver. Bullet
+  // cannot restore them, so the restored contacts start cold, the same way
+  // after every restore.
+  for (int i = 0; i < this->dispatcher->getNumManifolds(); ++i)
+    this->dispatcher->getManifoldByIndexInternal(i)->clearManifold();
+
+  this->solver->setRandSeed(seed);
+  return true;
+}
 
 //////////////////////////////////////////////////
 void BulletPhysics::SetSORPGSIters(unsigned int _iters)
@@ -580,6 +906,111 @@ void BulletPhysics::SetSORPGSIters(unsigned int _iters)
       "solver")->GetElement("iters")->Set(_iters);
 }
 
+//////////////////////////////////////////////////
+bool BulletPhysics::SetThreads(const int _threads)
+{
+  if (_threads < 1)
+  {
+    gzerr << "threads must be positive\n";
+    return false;
+  }
+
+#ifdef LIBBULLET_VERSION_GE_288
+  BulletThreading &threading = Threading(this);
+  if (threading.scheduler)
+  {
+    threading.threads =
+        std::min(_threads, threading.scheduler->getMaxNumThreads());
+    threading.contactArena.reset(threading.threads > 1 ?
+        new tbb::task_arena(threading.threads) : nullptr);
+    return true;
+  }
+
+  if (_threads == 1)
+    return true;
+
+  if (this->dynamicsWorld->getNumCollisionObjects() > 0 ||
+      this->dynamicsWorld->getNumConstraints() > 0)
+  {
+    gzerr << "The Bullet world can only become multi-threaded before links "
+          << "are added. Set <threads> in the <bullet> element.\n";
+    return false;
+  }
+
+  btITaskScheduler *taskScheduler = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(schedulerMutex);
+
+    // The first multi-threaded world chooses the scheduler of the process
+    if (activeScheduler.empty())
+    {
+      taskScheduler = CreateTaskScheduler(threading.taskScheduler);
+      if (!taskScheduler)
+      {
+        gzwarn << "Bullet task scheduler[" << threading.taskScheduler
+               << "] is not available, Bullet may have been built without "
+               << "BT_THREADSAFE. The world steps on one thread.\n";
+        return false;
+      }
+      btSetTaskScheduler(taskScheduler);
+      activeScheduler = threading.taskScheduler;
+    }
+    else
+    {
+      if (activeScheduler != threading.taskScheduler)
+      {
+        gzwarn << "Bullet task scheduler[" << activeScheduler
+               << "] is already used by this process, not ["
+               << threading.taskScheduler << "]\n";
+        threading.taskScheduler = activeScheduler;
+      }
+      taskScheduler = btGetTaskScheduler();
+    }
+  }
+
+  // Keep the broadphase, which holds the collision filter, and the solver
+  // settings of the single-threaded world
+  const btContactSolverInfo info = this->dynamicsWorld->getSolverInfo();
+  const btVector3 gravity = this->dynamicsWorld->getGravity();
+
+  delete this->dynamicsWorld;
+  delete this->solver;
+  delete this->dispatcher;
+
+  this->dispatcher = new btCollisionDispatcherMt(this->collisionConfig,
+      kDispatcherGrainSize);
+  btGImpactCollisionAlgorithm::registerAlgorithm(this->dispatcher);
+
+  // Small islands are solved in parallel by the solvers of the pool, one
+  // per thread. Large islands are solved by a multi-threaded solver.
+  btConstraintSolverPoolMt *pool =
+      new btConstraintSolverPoolMt(taskScheduler->getMaxNumThreads());
+  threading.solverPool = pool;
+  this->solver = new btSequentialImpulseConstraintSolverMt();
+
+  this->dynamicsWorld = new btDiscreteDynamicsWorldMt(this->dispatcher,
+      this->broadPhase, pool, this->solver, this->collisionConfig);
+  this->dynamicsWorld->getSolverInfo() = info;
+  this->dynamicsWorld->setGravity(gravity);
+  this->dynamicsWorld->setInternalTickCallback(
+      InternalTickCallback, static_cast<void *>(this));
+
+  threading.scheduler = taskScheduler;
+  threading.threads = std::min(_threads, taskScheduler->getMaxNumThreads());
+  threading.contactArena.reset(threading.threads > 1 ?
+      new tbb::task_arena(threading.threads) : nullptr);
+  return true;
+#else
+  if (_threads > 1)
+  {
+    gzwarn << "Multi-threaded Bullet worlds need Bullet 2.88 or later. The "
+           << "world steps on one thread.\n";
+    return false;
+  }
+  return true;
+#endif
+}
+
 //////////////////////////////////////////////////
 bool BulletPhysics::SetParam(const std::string &_key, const boost::any &_value)
 {
@@ -659,6 +1090,30 @@ bool BulletPhysics::SetParam(const std::string &_key, const boost::any &_value)
       double value = any_cast<double>(_value);
       bulletElem->GetElement("solver")->GetElement("min_step_size")->Set(value);
     }
+    else if (_key == "threads")
+    {
+      const int value = any_cast<int>(_value);
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      return this->SetThreads(value);
+    }
+    else if (_key == "task_scheduler")
+    {
+      const std::string value = any_cast<std::string>(_value);
+      if (!IsTaskScheduler(value))
+      {
+        gzerr << "Unknown Bullet task scheduler[" << value
+              << "], expected default, openmp, tbb or ppl\n";
+        return false;
+      }
+      BulletThreading &threading = Threading(this);
+      if (threading.scheduler && value != threading.taskScheduler)
+      {
+        gzerr << "The task scheduler of a multi-threaded world cannot "
+              << "change\n";
+        return false;
+      }
+      threading.taskScheduler = value;
+    }
     else
     {
       return PhysicsEngine::SetParam(_key, _value);
@@ -721,6 +1176,10 @@ bool BulletPhysics::GetParam(const std::string &_key, boost::any &_value) const
     _value = this->sdf->GetElement("max_contacts")->Get<int>();
   else if (_key == "min_step_size")
     _value = bulletElem->GetElement("solver")->Get<double>("min_step_size");
+  else if (_key == "threads")
+    _value = Threading(this).threads;
+  else if (_key == "task_scheduler")
+    _value = Threading(this).taskScheduler;
   else
   {
     return PhysicsEngine::GetParam(_key, _value);
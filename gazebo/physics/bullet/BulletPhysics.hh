@@ -22,6 +22,7 @@
 #ifndef BULLETPHYSICS_HH
 #define BULLETPHYSICS_HH
 #include <string>
+#include <vector>
 
 #include <boost/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -92,6 +93,13 @@ namespace gazebo
       // Documentation inherited
       public: virtual void Reset();
 
+      // Documentation inherited
+      public: virtual bool SaveSnapshot(std::vector<uint8_t> &_state);
+
+      // Documentation inherited
+      public: virtual bool RestoreSnapshot(
+                  const std::vector<uint8_t> &_state);
+
       // Documentation inherited
       public: virtual void InitForThread();
 
@@ -172,6 +180,27 @@ namespace gazebo
       // Documentation inherited
       public: virtual void SetSORPGSIters(unsigned int iters);
 
+      /// \brief Set the number of threads stepping the world. The first
+      /// count above one replaces the single-threaded dynamics world with a
+      /// btDiscreteDynamicsWorldMt, which only works while the world is
+      /// empty because links and joints keep a pointer to it.
+      /// \param[in] _threads Number of threads.
+      /// \return True if the count was set.
+      private: bool SetThreads(const int _threads);
+
+      /// \brief Add the contacts of the manifolds of the world to the
+      /// contact manager and fill their feedback.
+      /// \param[in] _timeStep Step size, to turn impulses into forces.
+      private: void UpdateContacts(const btScalar _timeStep);
+
+      /// \brief Bullet internal tick callback, which updates the contacts
+      /// after each internal step.
+      /// \param[in] _world The Bullet world, whose user info is the
+      /// physics engine.
+      /// \param[in] _timeStep Internal step size.
+      private: static void InternalTickCallback(btDynamicsWorld *_world,
+                   btScalar _timeStep);
+
       private: btBroadphaseInterface *broadPhase;
       private: btDefaultCollisionConfiguration *collisionConfig;
       private: btCollisionDispatcher *dispatcher;
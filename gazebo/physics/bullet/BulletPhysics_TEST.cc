@@ -178,6 +178,24 @@ TEST_F(BulletPhysics_TEST, PhysicsParam)
   value = bulletPhysics->GetParam("max_step_size");
   maxStepSizeRet = boost::any_cast<double>(value);
   EXPECT_DOUBLE_EQ(maxStepSize, maxStepSizeRet);
+
+  // The world is single-threaded by default, and has links already, so it
+  // cannot become multi-threaded
+  EXPECT_EQ(boost::any_cast<int>(bulletPhysics->GetParam("threads")), 1);
+  EXPECT_EQ(boost::any_cast<std::string>(
+      bulletPhysics->GetParam("task_scheduler")), "default");
+  EXPECT_TRUE(bulletPhysics->SetParam("threads", 1));
+  EXPECT_FALSE(bulletPhysics->SetParam("threads", 0));
+  EXPECT_FALSE(bulletPhysics->SetParam("threads", 4));
+  EXPECT_EQ(boost::any_cast<int>(bulletPhysics->GetParam("threads")), 1);
+
+  EXPECT_TRUE(bulletPhysics->SetParam("task_scheduler", std::string("tbb")));
+  EXPECT_EQ(boost::any_cast<std::string>(
+      bulletPhysics->GetParam("task_scheduler")), "tbb");
+  EXPECT_FALSE(bulletPhysics->SetParam("task_scheduler",
+      std::string("fibers")));
+  EXPECT_EQ(boost::any_cast<std::string>(
+      bulletPhysics->GetParam("task_scheduler")), "tbb");
 }
 
 /////////////////////////////////////////////////
@@ -267,6 +285,53 @@ TEST_F(BulletPhysics_TEST, PhysicsMsgParam)
   PhysicsMsgParam();
 }
 
+/////////////////////////////////////////////////
+/// Test that piles of boxes rest on the ground with any number of threads
+TEST_F(BulletPhysics_TEST, Threads)
+{
+  // The world asks for 4 threads
+  Load("test/worlds/bullet_threads.world", true, "bullet");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+
+  const int maxThreads = boost::any_cast<int>(physics->GetParam("threads"));
+  if (maxThreads == 1)
+  {
+    gzdbg << "Bullet cannot step on several threads, skipping\n";
+    return;
+  }
+  EXPECT_LE(maxThreads, 4);
+
+  // Extract the contacts every step, as a contact sensor would
+  physics->GetContactManager()->SetNeverDropContacts(true);
+
+  WorldSnapshotPtr snapshot = world->Snapshot();
+  ASSERT_TRUE(snapshot != nullptr);
+
+  for (const int threads : {1, maxThreads})
+  {
+    ASSERT_TRUE(world->Restore(snapshot));
+    EXPECT_TRUE(physics->SetParam("threads", threads));
+    EXPECT_EQ(boost::any_cast<int>(physics->GetParam("threads")), threads);
+
+    world->Step(1000);
+    EXPECT_GT(physics->GetContactManager()->GetContactCount(), 0u);
+
+    // No box falls through the ground
+    for (auto const &model : world->Models())
+    {
+      if (!model->IsStatic())
+      {
+        EXPECT_GT(model->WorldPose().Pos().Z(), 0.2)
+            << model->GetName() << " with " << threads << " threads";
+      }
+    }
+  }
+}
+
 /////////////////////////////////////////////////
 /// Main
 int main(int argc, char **argv)
@@ -15,6 +15,10 @@
  *
 */
 
+#include <cstring>
+#include <string>
+#include <vector>
+
 // required for HAVE_DART_BULLET define
 #include <gazebo/gazebo_config.h>
 
@@ -451,6 +455,18 @@ void DARTPhysics::UpdatePhysics()
   this->dataPtr->dtWorld->step(
         this->dataPtr->resetAllForcesAfterSimulationStep);
 
+  this->UpdateLinkPoses();
+
+  RetrieveDARTCollisions(
+        this,
+        &(this->dataPtr->dtWorld->getLastCollisionResult()),
+        this->GetContactManager());
+  IGN_PROFILE_END();
+}
+
+//////////////////////////////////////////////////
+void DARTPhysics::UpdateLinkPoses()
+{
   // Update all the transformation of DART's links to gazebo's links
   // TODO: How to visit all the links in the world?
   unsigned int modelCount = this->world->ModelCount();
@@ -471,12 +487,86 @@ void DARTPhysics::UpdatePhysics()
       dartLinkItr->updateDirtyPoseFromDARTTransformation();
     }
   }
+}
 
-  RetrieveDARTCollisions(
-        this,
-        &(this->dataPtr->dtWorld->getLastCollisionResult()),
-        this->GetContactManager());
-  IGN_PROFILE_END();
+//////////////////////////////////////////////////
+bool DARTPhysics::SaveSnapshot(std::vector<uint8_t> &_state)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+
+  // The time, then for each skeleton its number of degrees of freedom,
+  // positions, velocities, accelerations and forces. DART's solver is not
+  // warm started, so this is all the state carried between steps.
+  std::vector<double> state;
+  state.push_back(this->dataPtr->dtWorld->getTime());
+  for (size_t i = 0; i < this->dataPtr->dtWorld->getNumSkeletons(); ++i)
+  {
+    dart::dynamics::SkeletonPtr skeleton =
+      this->dataPtr->dtWorld->getSkeleton(i);
+    state.push_back(static_cast<double>(skeleton->getNumDofs()));
+    for (const Eigen::VectorXd &values : {skeleton->getPositions(),
+          skeleton->getVelocities(), skeleton->getAccelerations(),
+          skeleton->getForces()})
+    {
+      state.insert(state.end(), values.data(), values.data() + values.size());
+    }
+  }
+
+  _state.resize(state.size() * sizeof(double));
+  std::memcpy(_state.data(), state.data(), _state.size());
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool DARTPhysics::RestoreSnapshot(const std::vector<uint8_t> &_state)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+
+  size_t size = 1;
+  for (size_t i = 0; i < this->dataPtr->dtWorld->getNumSkeletons(); ++i)
+    size += 1 + 4 * this->dataPtr->dtWorld->getSkeleton(i)->getNumDofs();
+
+  if (_state.size() != size * sizeof(double))
+  {
+    gzerr << "The models of the world changed since the snapshot\n";
+    return false;
+  }
+  std::vector<double> state(size);
+  std::memcpy(state.data(), _state.data(), _state.size());
+
+  const double *values = state.data() + 1;
+  for (size_t i = 0; i < this->dataPtr->dtWorld->getNumSkeletons(); ++i)
+  {
+    if (static_cast<size_t>(*values++) !=
+        this->dataPtr->dtWorld->getSkeleton(i)->getNumDofs())
+    {
+      gzerr << "The models of the world changed since the snapshot\n";
+      return false;
+    }
+    values += 4 * this->dataPtr->dtWorld->getSkeleton(i)->getNumDofs();
+  }
+
+  this->dataPtr->dtWorld->setTime(state[0]);
+  values = state.data() + 1;
+  for (size_t i = 0; i < this->dataPtr->dtWorld->getNumSkeletons(); ++i)
+  {
+    dart::dynamics::SkeletonPtr skeleton =
+      this->dataPtr->dtWorld->getSkeleton(i);
+    const size_t dofs = skeleton->getNumDofs();
+    ++values;
+    skeleton->setPositions(Eigen::Map<const Eigen::VectorXd>(values, dofs));
+    values += dofs;
+    skeleton->setVelocities(Eigen::Map<const Eigen::VectorXd>(values, dofs));
+    values += dofs;
+    skeleton->setAccelerations(
+        Eigen::Map<const Eigen::VectorXd>(values, dofs));
+    values += dofs;
+    skeleton->setForces(Eigen::Map<const Eigen::VectorXd>(values, dofs));
+    values += dofs;
+  }
+
+  this->UpdateLinkPoses();
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -19,6 +19,7 @@
 #define _GAZEBO_DARTPHYSICS_HH_
 
 #include <string>
+#include <vector>
 
 #include <boost/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -93,6 +94,13 @@ namespace gazebo
       // Documentation inherited
       public: virtual void Reset();
 
+      // Documentation inherited
+      public: virtual bool SaveSnapshot(std::vector<uint8_t> &_state);
+
+      // Documentation inherited
+      public: virtual bool RestoreSnapshot(
+                  const std::vector<uint8_t> &_state);
+
       // Documentation inherited
       public: virtual void InitForThread();
 
@@ -171,6 +179,9 @@ namespace gazebo
       private: DARTLinkPtr FindDARTLink(
           const dart::dynamics::BodyNode *_dtBodyNode);
 
+      /// \brief Update the poses of the links from their DART body nodes.
+      private: void UpdateLinkPoses();
+
       /// \internal
       /// \brief Pointer to private data.
       private: DARTPhysicsPrivate *dataPtr = nullptr;
@@ -0,0 +1,453 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#include "gazebo/physics/ode/ODEContactCache.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+namespace
+{
+  /// \brief New contacts closer than this to a contact of the previous
+  /// step inherit its multipliers. Bullet keeps contact points in its
+  /// manifolds up to the same distance.
+  const double kMatchDistance = 0.02;
+
+  /// \brief Smallest cosine of the angle between the normals of matching
+  /// contacts.
+  const double kMatchCos = 0.95;
+
+  /// \brief Rotate a vector by the transpose of a rotation.
+  /// \param[in] _rot Rotation.
+  /// \param[in] _v Vector.
+  /// \param[out] _out Rotated vector.
+  void RotateReverse(const dReal *_rot, const dReal *_v, dReal *_out)
+  {
+    for (int i = 0; i < 3; ++i)
+      _out[i] = _rot[i] * _v[0] + _rot[4 + i] * _v[1] + _rot[8 + i] * _v[2];
+  }
+
+  /// \brief Rotate a vector.
+  /// \param[in] _rot Rotation.
+  /// \param[in] _v Vector.
+  /// \param[out] _out Rotated vector.
+  void Rotate(const dReal *_rot, const dReal *_v, dReal *_out)
+  {
+    for (int i = 0; i < 3; ++i)
+    {
+      _out[i] = _rot[4 * i] * _v[0] + _rot[4 * i + 1] * _v[1] +
+          _rot[4 * i + 2] * _v[2];
+    }
+  }
+
+  /// \brief Append a value to a snapshot.
+  /// \param[in,out] _state Snapshot.
+  /// \param[in] _value Value.
+  template<typename T>
+  void Append(std::vector<uint8_t> &_state, const T &_value)
+  {
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(&_value);
+    _state.insert(_state.end(), bytes, bytes + sizeof(T));
+  }
+
+  /// \brief Read a value from a snapshot.
+  /// \param[in] _state Snapshot.
+  /// \param[in,out] _offset Offset of the value, moved past it.
+  /// \param[out] _value Value.
+  /// \return False if the snapshot is too short.
+  template<typename T>
+  bool Read(const std::vector<uint8_t> &_state, size_t &_offset, T &_value)
+  {
+    if (_offset + sizeof(T) > _state.size())
+      return false;
+    std::memcpy(&_value, _state.data() + _offset, sizeof(T));
+    _offset += sizeof(T);
+    return true;
+  }
+}
+
+//////////////////////////////////////////////////
+size_t ODEContactCache::PairHash::operator()(
+    const std::pair<dGeomID, dGeomID> &_key) const
+{
+  const size_t h1 = std::hash<dGeomID>()(_key.first);
+  const size_t h2 = std::hash<dGeomID>()(_key.second);
+  return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::SetEnabled(const bool _enabled)
+{
+  if (_enabled && !this->enabled)
+  {
+    this->totalHits = 0;
+    this->totalMisses = 0;
+  }
+  this->enabled = _enabled;
+  this->Clear();
+}
+
+//////////////////////////////////////////////////
+bool ODEContactCache::Enabled() const
+{
+  return this->enabled;
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::SetLinearTolerance(const double _tolerance)
+{
+  this->linearTolerance = _tolerance;
+}
+
+//////////////////////////////////////////////////
+double ODEContactCache::LinearTolerance() const
+{
+  return this->linearTolerance;
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::SetAngularTolerance(const double _tolerance)
+{
+  this->angularTolerance = _tolerance;
+}
+
+//////////////////////////////////////////////////
+double ODEContactCache::AngularTolerance() const
+{
+  return this->angularTolerance;
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::BeginStep()
+{
+  for (auto iter = this->pairs.begin(); iter != this->pairs.end();)
+  {
+    if (!iter->second.touched)
+    {
+      iter = this->pairs.erase(iter);
+      continue;
+    }
+
+    // The joints of the previous step are gone
+    iter->second.touched = false;
+    for (auto &contact : iter->second.contacts)
+      contact.joint = nullptr;
+    ++iter;
+  }
+  this->hits = 0;
+  this->misses = 0;
+}
+
+//////////////////////////////////////////////////
+ODEContactCache::Pair &ODEContactCache::Find(dGeomID _geom1, dGeomID _geom2)
+{
+  Pair &pair = this->pairs[std::make_pair(_geom1, _geom2)];
+  pair.touched = true;
+  return pair;
+}
+
+//////////////////////////////////////////////////
+int ODEContactCache::Reuse(const Pair &_pair, dGeomID _geom1,
+    dGeomID _geom2, const unsigned int _maxContacts,
+    dContactGeom *_contacts)
+{
+  bool hit = _pair.valid && _pair.maxContacts == _maxContacts;
+  if (hit)
+  {
+    dVector3 pos;
+    dMatrix3 rot;
+    RelativePose(_geom1, _geom2, pos, rot);
+
+    double distance = 0;
+    for (int i = 0; i < 3; ++i)
+      distance += (pos[i] - _pair.relPos[i]) * (pos[i] - _pair.relPos[i]);
+
+    // The trace of the rotation between the two relative rotations is
+    // 1 + 2 cos(angle)
+    double trace = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+      for (int k = 0; k < 3; ++k)
+        trace += _pair.relRot[4 * k + i] * rot[4 * k + i];
+    }
+
+    hit = distance <= this->linearTolerance * this->linearTolerance &&
+        trace >= 1 + 2 * std::cos(this->angularTolerance);
+  }
+
+  if (!hit)
+  {
+    ++this->misses;
+    ++this->totalMisses;
+    return -1;
+  }
+  ++this->hits;
+  ++this->totalHits;
+
+  // The contacts move with geom1
+  dVector3 pos1;
+  dMatrix3 rot1;
+  GeomPose(_geom1, pos1, rot1);
+  for (size_t i = 0; i < _pair.contacts.size(); ++i)
+  {
+    const dContactGeom &cached = _pair.contacts[i].geom;
+    _contacts[i] = cached;
+    Rotate(rot1, cached.pos, _contacts[i].pos);
+    for (int k = 0; k < 3; ++k)
+      _contacts[i].pos[k] += pos1[k];
+    Rotate(rot1, cached.normal, _contacts[i].normal);
+  }
+  return static_cast<int>(_pair.contacts.size());
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::Update(Pair &_pair, dGeomID _geom1, dGeomID _geom2,
+    const unsigned int _maxContacts, const dContactGeom *_contacts,
+    const int *_indices, const unsigned int _count)
+{
+  RelativePose(_geom1, _geom2, _pair.relPos, _pair.relRot);
+  _pair.maxContacts = _maxContacts;
+  _pair.valid = true;
+
+  dVector3 pos1;
+  dMatrix3 rot1;
+  GeomPose(_geom1, pos1, rot1);
+
+  this->previous.swap(_pair.contacts);
+  _pair.contacts.resize(_count);
+  for (unsigned int i = 0; i < _count; ++i)
+  {
+    CachedContact &contact = _pair.contacts[i];
+    contact.geom = _contacts[_indices[i]];
+    dVector3 offset;
+    for (int k = 0; k < 3; ++k)
+      offset[k] = contact.geom.pos[k] - pos1[k];
+    RotateReverse(rot1, offset, contact.geom.pos);
+    RotateReverse(rot1, _contacts[_indices[i]].normal, contact.geom.normal);
+    contact.joint = nullptr;
+
+    // Inherit the multipliers of the closest old contact
+    const CachedContact *match = nullptr;
+    double best = kMatchDistance * kMatchDistance;
+    for (auto const &old : this->previous)
+    {
+      double distance = 0;
+      double dot = 0;
+      for (int k = 0; k < 3; ++k)
+      {
+        const double d = old.geom.pos[k] - contact.geom.pos[k];
+        distance += d * d;
+        dot += old.geom.normal[k] * contact.geom.normal[k];
+      }
+      if (distance <= best && dot >= kMatchCos)
+      {
+        best = distance;
+        match = &old;
+      }
+    }
+
+    if (match)
+    {
+      std::memcpy(contact.lambda, match->lambda, sizeof(contact.lambda));
+      std::memcpy(contact.lambdaErp, match->lambdaErp,
+          sizeof(contact.lambdaErp));
+    }
+    else
+    {
+      std::fill(contact.lambda, contact.lambda + 6, 0);
+      std::fill(contact.lambdaErp, contact.lambdaErp + 6, 0);
+    }
+  }
+  this->previous.clear();
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::WarmStart(Pair &_pair, const unsigned int _index,
+    dJointID _joint)
+{
+  CachedContact &contact = _pair.contacts[_index];
+  dJointSetLambda(_joint, contact.lambda, contact.lambdaErp);
+  contact.joint = _joint;
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::SaveLambdas()
+{
+  for (auto &pair : this->pairs)
+  {
+    if (!pair.second.touched)
+      continue;
+    for (auto &contact : pair.second.contacts)
+    {
+      if (contact.joint)
+        dJointGetLambda(contact.joint, contact.lambda, contact.lambdaErp);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::Clear()
+{
+  this->pairs.clear();
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::Save(std::vector<uint8_t> &_state) const
+{
+  Append(_state, static_cast<uint64_t>(this->pairs.size()));
+  for (const auto &entry : this->pairs)
+  {
+    const Pair &pair = entry.second;
+    Append(_state, entry.first.first);
+    Append(_state, entry.first.second);
+    Append(_state, pair.relPos);
+    Append(_state, pair.relRot);
+    Append(_state, static_cast<uint32_t>(pair.maxContacts));
+    Append(_state, static_cast<uint8_t>(pair.valid));
+    Append(_state, static_cast<uint8_t>(pair.touched));
+    Append(_state, static_cast<uint64_t>(pair.contacts.size()));
+    for (const auto &contact : pair.contacts)
+    {
+      Append(_state, contact.geom);
+      Append(_state, contact.lambda);
+      Append(_state, contact.lambdaErp);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+bool ODEContactCache::Restore(const std::vector<uint8_t> &_state,
+    size_t &_offset, const std::unordered_set<dGeomID> &_geoms)
+{
+  uint64_t pairCount = 0;
+  if (!Read(_state, _offset, pairCount))
+    return false;
+
+  std::unordered_map<std::pair<dGeomID, dGeomID>, Pair, PairHash> restored;
+  for (uint64_t i = 0; i < pairCount; ++i)
+  {
+    std::pair<dGeomID, dGeomID> key;
+    Pair pair;
+    uint32_t maxContacts = 0;
+    uint8_t valid = 0;
+    uint8_t touched = 0;
+    uint64_t contactCount = 0;
+    if (!Read(_state, _offset, key.first) ||
+        !Read(_state, _offset, key.second) ||
+        !_geoms.count(key.first) || !_geoms.count(key.second) ||
+        !Read(_state, _offset, pair.relPos) ||
+        !Read(_state, _offset, pair.relRot) ||
+        !Read(_state, _offset, maxContacts) ||
+        !Read(_state, _offset, valid) ||
+        !Read(_state, _offset, touched) ||
+        !Read(_state, _offset, contactCount) || contactCount > maxContacts)
+    {
+      return false;
+    }
+    pair.maxContacts = maxContacts;
+    pair.valid = valid != 0;
+    pair.touched = touched != 0;
+
+    // The contact joints of the step the snapshot was taken after are gone
+    pair.contacts.resize(contactCount);
+    for (auto &contact : pair.contacts)
+    {
+      if (!Read(_state, _offset, contact.geom) ||
+          !Read(_state, _offset, contact.lambda) ||
+          !Read(_state, _offset, contact.lambdaErp))
+      {
+        return false;
+      }
+      contact.joint = nullptr;
+    }
+    restored[key] = std::move(pair);
+  }
+
+  this->pairs.swap(restored);
+  return true;
+}
+
+//////////////////////////////////////////////////
+unsigned int ODEContactCache::Hits() const
+{
+  return this->hits;
+}
+
+//////////////////////////////////////////////////
+unsigned int ODEContactCache::Misses() const
+{
+  return this->misses;
+}
+
+//////////////////////////////////////////////////
+double ODEContactCache::HitRate() const
+{
+  const uint64_t total = this->totalHits + this->totalMisses;
+  return total ? static_cast<double>(this->totalHits) / total : 0.0;
+}
+
+//////////////////////////////////////////////////
+size_t ODEContactCache::Size() const
+{
+  return this->pairs.size();
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::GeomPose(dGeomID _geom, dVector3 _pos,
+    dMatrix3 _rot)
+{
+  if (dGeomGetClass(_geom) == dPlaneClass)
+  {
+    dSetZero(_pos, 4);
+    dRSetIdentity(_rot);
+    return;
+  }
+  std::memcpy(_pos, dGeomGetPosition(_geom), sizeof(dVector3));
+  std::memcpy(_rot, dGeomGetRotation(_geom), sizeof(dMatrix3));
+}
+
+//////////////////////////////////////////////////
+void ODEContactCache::RelativePose(dGeomID _geom1, dGeomID _geom2,
+    dVector3 _pos, dMatrix3 _rot)
+{
+  dVector3 pos1, pos2;
+  dMatrix3 rot1, rot2;
+  GeomPose(_geom1, pos1, rot1);
+  GeomPose(_geom2, pos2, rot2);
+
+  dVector3 offset;
+  for (int k = 0; k < 3; ++k)
+    offset[k] = pos2[k] - pos1[k];
+  RotateReverse(rot1, offset, _pos);
+  _pos[3] = 0;
+
+  // rot1^T * rot2
+  for (int i = 0; i < 3; ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      _rot[4 * i + j] = rot1[i] * rot2[j] + rot1[4 + i] * rot2[4 + j] +
+          rot1[8 + i] * rot2[8 + j];
+    }
+    _rot[4 * i + 3] = 0;
+  }
+}
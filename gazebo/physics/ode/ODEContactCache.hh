@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PHYSICS_ODE_ODECONTACTCACHE_HH_
+#define GAZEBO_PHYSICS_ODE_ODECONTACTCACHE_HH_
+
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gazebo/physics/Contact.hh"
+#include "gazebo/physics/ode/ode_inc.h"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace physics
+  {
+    /// \internal
+    /// \brief Contacts of each pair of geoms from earlier steps. They stand
+    /// in for the narrowphase while the geoms of a pair keep their relative
+    /// pose, and carry the constraint forces of the contacts over to the
+    /// next step to warm start the quickstep solver, which otherwise starts
+    /// every contact from zero because contact joints are recreated every
+    /// step.
+    class GZ_PHYSICS_VISIBLE ODEContactCache
+    {
+      /// \brief A cached contact.
+      public: class CachedContact
+      {
+        /// \brief Contact, with position and normal in the frame of geom1.
+        public: dContactGeom geom;
+
+        /// \brief Constraint multipliers after the last step.
+        public: dReal lambda[6];
+
+        /// \brief Position correction multipliers after the last step.
+        public: dReal lambdaErp[6];
+
+        /// \brief Contact joint created this step, or null.
+        public: dJointID joint;
+      };
+
+      /// \brief Cached contacts of a pair of geoms.
+      public: class Pair
+      {
+        /// \brief Position of geom2 in the frame of geom1 when the
+        /// contacts were generated.
+        public: dVector3 relPos;
+
+        /// \brief Rotation of geom2 in the frame of geom1 when the
+        /// contacts were generated.
+        public: dMatrix3 relRot;
+
+        /// \brief Largest number of contacts the contacts were chosen for.
+        public: unsigned int maxContacts = 0;
+
+        /// \brief True once the narrowphase ran for the pair.
+        public: bool valid = false;
+
+        /// \brief True if the pair collided this step.
+        public: bool touched = false;
+
+        /// \brief Contacts.
+        public: std::vector<CachedContact> contacts;
+      };
+
+      /// \brief Enable or disable the cache. Disabling clears it.
+      /// \param[in] _enabled True to enable.
+      public: void SetEnabled(const bool _enabled);
+
+      /// \brief Get whether the cache is enabled.
+      /// \return True if enabled.
+      public: bool Enabled() const;
+
+      /// \brief Set how far geom2 may move relative to geom1 before the
+      /// contacts of a pair are generated again.
+      /// \param[in] _tolerance Distance in meters.
+      public: void SetLinearTolerance(const double _tolerance);
+
+      /// \brief Get the linear tolerance.
+      /// \return Distance in meters.
+      public: double LinearTolerance() const;
+
+      /// \brief Set how far geom2 may turn relative to geom1 before the
+      /// contacts of a pair are generated again.
+      /// \param[in] _tolerance Angle in radians.
+      public: void SetAngularTolerance(const double _tolerance);
+
+      /// \brief Get the angular tolerance.
+      /// \return Angle in radians.
+      public: double AngularTolerance() const;
+
+      /// \brief Start a step: forget the pairs that did not collide in the
+      /// previous step.
+      public: void BeginStep();
+
+      /// \brief Get the entry of a pair of geoms, creating it if needed.
+      /// The order of the geoms matters, the normals of the contacts point
+      /// from geom2 to geom1.
+      /// \param[in] _geom1 First geom.
+      /// \param[in] _geom2 Second geom.
+      /// \return The entry, valid until the next call to BeginStep.
+      public: Pair &Find(dGeomID _geom1, dGeomID _geom2);
+
+      /// \brief Get the cached contacts of a pair if its geoms kept their
+      /// relative pose.
+      /// \param[in] _pair Entry of the pair.
+      /// \param[in] _geom1 First geom.
+      /// \param[in] _geom2 Second geom.
+      /// \param[in] _maxContacts Largest number of contacts.
+      /// \param[out] _contacts Receives the contacts in the world frame.
+      /// \return Number of contacts, -1 if the narrowphase has to run.
+      public: int Reuse(const Pair &_pair, dGeomID _geom1, dGeomID _geom2,
+                  const unsigned int _maxContacts, dContactGeom *_contacts);
+
+      /// \brief Store the contacts the narrowphase generated for a pair.
+      /// New contacts close to an old one inherit its multipliers.
+      /// \param[in,out] _pair Entry of the pair.
+      /// \param[in] _geom1 First geom.
+      /// \param[in] _geom2 Second geom.
+      /// \param[in] _maxContacts Largest number of contacts.
+      /// \param[in] _contacts Contacts in the world frame.
+      /// \param[in] _indices Indices of the chosen contacts in _contacts.
+      /// \param[in] _count Number of chosen contacts.
+      public: void Update(Pair &_pair, dGeomID _geom1, dGeomID _geom2,
+                  const unsigned int _maxContacts,
+                  const dContactGeom *_contacts, const int *_indices,
+                  const unsigned int _count);
+
+      /// \brief Warm start the contact joint of a cached contact.
+      /// \param[in,out] _pair Entry of the pair.
+      /// \param[in] _index Index of the contact.
+      /// \param[in] _joint The contact joint.
+      public: void WarmStart(Pair &_pair, const unsigned int _index,
+                  dJointID _joint);
+
+      /// \brief Save the multipliers of the contact joints after a step,
+      /// before the joints are destroyed.
+      public: void SaveLambdas();
+
+      /// \brief Forget all pairs, e.g. after the world state jumped.
+      public: void Clear();
+
+      /// \brief Append the pairs and their multipliers to a snapshot of
+      /// the world. Must be called between steps. The settings and the hit
+      /// statistics are not saved.
+      /// \param[in,out] _state Snapshot.
+      public: void Save(std::vector<uint8_t> &_state) const;
+
+      /// \brief Replace the pairs with the ones appended by Save. The
+      /// pairs are left unchanged if the snapshot is invalid.
+      /// \param[in] _state Snapshot.
+      /// \param[in,out] _offset Offset of the pairs, moved past them.
+      /// \param[in] _geoms Geoms of the world. The snapshot is invalid if
+      /// a pair refers to another geom.
+      /// \return False if the snapshot is invalid.
+      public: bool Restore(const std::vector<uint8_t> &_state,
+                  size_t &_offset, const std::unordered_set<dGeomID> &_geoms);
+
+      /// \brief Get the number of pairs whose narrowphase was skipped in
+      /// the current step.
+      /// \return Number of hits.
+      public: unsigned int Hits() const;
+
+      /// \brief Get the number of pairs whose narrowphase ran in the
+      /// current step.
+      /// \return Number of misses.
+      public: unsigned int Misses() const;
+
+      /// \brief Get the fraction of the pairs whose narrowphase was skipped
+      /// since the cache was enabled.
+      /// \return Hit rate between 0 and 1.
+      public: double HitRate() const;
+
+      /// \brief Get the number of cached pairs.
+      /// \return Number of pairs.
+      public: size_t Size() const;
+
+      /// \brief Get the pose of a geom. Planes have none and are at the
+      /// origin.
+      /// \param[in] _geom The geom.
+      /// \param[out] _pos Position.
+      /// \param[out] _rot Rotation.
+      private: static void GeomPose(dGeomID _geom, dVector3 _pos,
+                   dMatrix3 _rot);
+
+      /// \brief Get the pose of geom2 in the frame of geom1.
+      /// \param[in] _geom1 First geom.
+      /// \param[in] _geom2 Second geom.
+      /// \param[out] _pos Position.
+      /// \param[out] _rot Rotation.
+      private: static void RelativePose(dGeomID _geom1, dGeomID _geom2,
+                   dVector3 _pos, dMatrix3 _rot);
+
+      /// \brief Hash of a pair of geoms.
+      private: class PairHash
+      {
+        /// \brief Hash a pair of geoms.
+        /// \param[in] _key The pair.
+        /// \return Hash.
+        public: size_t operator()(const std::pair<dGeomID, dGeomID> &_key)
+                    const;
+      };
+
+      /// \brief Entries by pair of geoms.
+      private: std::unordered_map<std::pair<dGeomID, dGeomID>, Pair,
+               PairHash> pairs;
+
+      /// \brief Contacts of the previous step while a pair is updated,
+      /// kept to reuse its memory.
+      private: std::vector<CachedContact> previous;
+
+      /// \brief True if enabled.
+      private: bool enabled = false;
+
+      /// \brief Linear tolerance in meters.
+      private: double linearTolerance = 1e-4;
+
+      /// \brief Angular tolerance in radians.
+      private: double angularTolerance = 1e-3;
+
+      /// \brief Hits in the current step.
+      private: unsigned int hits = 0;
+
+      /// \brief Misses in the current step.
+      private: unsigned int misses = 0;
+
+      /// \brief Hits since the cache was enabled.
+      private: uint64_t totalHits = 0;
+
+      /// \brief Misses since the cache was enabled.
+      private: uint64_t totalMisses = 0;
+    };
+  }
+}
+#endif
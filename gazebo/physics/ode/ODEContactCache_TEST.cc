@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "gazebo/physics/ode/ODEContactCache.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+using namespace physics;
+
+class ODEContactCache_TEST : public gazebo::testing::AutoLogFixture
+{
+  /// \brief Create a plane and a unit box sinking 1 cm into it.
+  public: void SetUp() override
+  {
+    gazebo::testing::AutoLogFixture::SetUp();
+    dInitODE2(0);
+    this->plane = dCreatePlane(0, 0, 0, 1, 0);
+    this->box = dCreateBox(0, 1, 1, 1);
+    dGeomSetPosition(this->box, 0, 0, 0.49);
+  }
+
+  /// \brief Destroy the geoms.
+  public: void TearDown() override
+  {
+    dGeomDestroy(this->box);
+    dGeomDestroy(this->plane);
+    dCloseODE();
+    gazebo::testing::AutoLogFixture::TearDown();
+  }
+
+  /// \brief Run the narrowphase for the plane and the box and store its
+  /// contacts.
+  /// \param[in] _cache The cache.
+  /// \return Number of contacts.
+  public: int Collide(ODEContactCache &_cache)
+  {
+    int indices[MAX_CONTACT_JOINTS];
+    for (int i = 0; i < MAX_CONTACT_JOINTS; ++i)
+      indices[i] = i;
+    const int count = dCollide(this->plane, this->box, MAX_CONTACT_JOINTS,
+        this->contacts, sizeof(this->contacts[0]));
+    _cache.Update(_cache.Find(this->plane, this->box), this->plane,
+        this->box, 10, this->contacts, indices, count);
+    return count;
+  }
+
+  /// \brief Look the plane and the box up in the cache.
+  /// \param[in] _cache The cache.
+  /// \return Number of reused contacts, -1 on a miss.
+  public: int Reuse(ODEContactCache &_cache)
+  {
+    return _cache.Reuse(_cache.Find(this->plane, this->box), this->plane,
+        this->box, 10, this->reused);
+  }
+
+  /// \brief Ground plane.
+  public: dGeomID plane;
+
+  /// \brief Box on the plane.
+  public: dGeomID box;
+
+  /// \brief Contacts from the narrowphase.
+  public: dContactGeom contacts[MAX_CONTACT_JOINTS];
+
+  /// \brief Contacts from the cache.
+  public: dContactGeom reused[MAX_CONTACT_JOINTS];
+};
+
+/////////////////////////////////////////////////
+TEST_F(ODEContactCache_TEST, Params)
+{
+  ODEContactCache cache;
+  EXPECT_FALSE(cache.Enabled());
+  EXPECT_DOUBLE_EQ(cache.LinearTolerance(), 1e-4);
+  EXPECT_DOUBLE_EQ(cache.AngularTolerance(), 1e-3);
+
+  cache.SetEnabled(true);
+  cache.SetLinearTolerance(1e-3);
+  cache.SetAngularTolerance(1e-2);
+  EXPECT_TRUE(cache.Enabled());
+  EXPECT_DOUBLE_EQ(cache.LinearTolerance(), 1e-3);
+  EXPECT_DOUBLE_EQ(cache.AngularTolerance(), 1e-2);
+  EXPECT_DOUBLE_EQ(cache.HitRate(), 0.0);
+}
+
+/////////////////////////////////////////////////
+TEST_F(ODEContactCache_TEST, Reuse)
+{
+  ODEContactCache cache;
+  cache.SetEnabled(true);
+
+  // Nothing cached yet
+  cache.BeginStep();
+  EXPECT_EQ(this->Reuse(cache), -1);
+  const int count = this->Collide(cache);
+  ASSERT_GT(count, 0);
+  EXPECT_EQ(cache.Hits(), 0u);
+  EXPECT_EQ(cache.Misses(), 1u);
+
+  // Same pose, same contacts
+  cache.BeginStep();
+  ASSERT_EQ(this->Reuse(cache), count);
+  for (int i = 0; i < count; ++i)
+  {
+    for (int k = 0; k < 3; ++k)
+    {
+      EXPECT_NEAR(this->reused[i].pos[k], this->contacts[i].pos[k], 1e-12);
+      EXPECT_NEAR(this->reused[i].normal[k], this->contacts[i].normal[k],
+          1e-12);
+    }
+    EXPECT_DOUBLE_EQ(this->reused[i].depth, this->contacts[i].depth);
+  }
+  EXPECT_EQ(cache.Hits(), 1u);
+  EXPECT_EQ(cache.Misses(), 0u);
+  EXPECT_DOUBLE_EQ(cache.HitRate(), 0.5);
+
+  // Within the tolerances
+  dGeomSetPosition(this->box, 5e-5, 0, 0.49);
+  cache.BeginStep();
+  EXPECT_EQ(this->Reuse(cache), count);
+
+  // Moved too far
+  dGeomSetPosition(this->box, 1e-3, 0, 0.49);
+  cache.BeginStep();
+  EXPECT_EQ(this->Reuse(cache), -1);
+  this->Collide(cache);
+
+  // Turned too far
+  dMatrix3 rot;
+  dRFromAxisAndAngle(rot, 0, 0, 1, 0.01);
+  dGeomSetRotation(this->box, rot);
+  cache.BeginStep();
+  EXPECT_EQ(this->Reuse(cache), -1);
+
+  // A different maximum number of contacts
+  this->Collide(cache);
+  cache.BeginStep();
+  EXPECT_EQ(cache.Reuse(cache.Find(this->plane, this->box), this->plane,
+        this->box, 2, this->reused), -1);
+}
+
+/////////////////////////////////////////////////
+TEST_F(ODEContactCache_TEST, Evict)
+{
+  ODEContactCache cache;
+  cache.SetEnabled(true);
+  cache.BeginStep();
+  this->Collide(cache);
+  EXPECT_EQ(cache.Size(), 1u);
+
+  // The pair collided in the previous step
+  cache.BeginStep();
+  EXPECT_EQ(cache.Size(), 1u);
+
+  // But not anymore
+  cache.BeginStep();
+  EXPECT_EQ(cache.Size(), 0u);
+
+  this->Collide(cache);
+  EXPECT_EQ(cache.Size(), 1u);
+  cache.SetEnabled(false);
+  EXPECT_EQ(cache.Size(), 0u);
+}
+
+/////////////////////////////////////////////////
+TEST_F(ODEContactCache_TEST, WarmStart)
+{
+  dWorldID world = dWorldCreate();
+  dJointGroupID group = dJointGroupCreate(0);
+
+  ODEContactCache cache;
+  cache.SetEnabled(true);
+  cache.BeginStep();
+  const int count = this->Collide(cache);
+  ASSERT_GT(count, 0);
+
+  // Pretend the solver found forces for the contact joints
+  ODEContactCache::Pair &pair = cache.Find(this->plane, this->box);
+  dReal lambda[6] = {1, 2, 3, 0, 0, 0};
+  dReal lambdaErp[6] = {4, 5, 6, 0, 0, 0};
+  for (int i = 0; i < count; ++i)
+  {
+    dContact contact;
+    contact.geom = this->contacts[i];
+    dJointID joint = dJointCreateContact(world, group, &contact);
+    cache.WarmStart(pair, i, joint);
+
+    // New contacts start from zero
+    dReal start[6], startErp[6];
+    dJointGetLambda(joint, start, startErp);
+    EXPECT_DOUBLE_EQ(start[0], 0);
+    dJointSetLambda(joint, lambda, lambdaErp);
+  }
+  cache.SaveLambdas();
+  dJointGroupEmpty(group);
+
+  // Contacts that barely moved inherit the forces
+  dGeomSetPosition(this->box, 1e-3, 0, 0.49);
+  cache.BeginStep();
+  this->Collide(cache);
+  for (int i = 0; i < count; ++i)
+  {
+    dContact contact;
+    contact.geom = this->contacts[i];
+    dJointID joint = dJointCreateContact(world, group, &contact);
+    cache.WarmStart(pair, i, joint);
+
+    dReal start[6], startErp[6];
+    dJointGetLambda(joint, start, startErp);
+    EXPECT_DOUBLE_EQ(start[0], 1);
+    EXPECT_DOUBLE_EQ(start[2], 3);
+    EXPECT_DOUBLE_EQ(startErp[1], 5);
+  }
+  cache.SaveLambdas();
+  dJointGroupEmpty(group);
+
+  // Contacts far from the old ones start from zero
+  dGeomSetPosition(this->box, 0.2, 0, 0.49);
+  cache.BeginStep();
+  this->Collide(cache);
+  for (int i = 0; i < count; ++i)
+  {
+    dContact contact;
+    contact.geom = this->contacts[i];
+    dJointID joint = dJointCreateContact(world, group, &contact);
+    cache.WarmStart(pair, i, joint);
+
+    dReal start[6], startErp[6];
+    dJointGetLambda(joint, start, startErp);
+    EXPECT_DOUBLE_EQ(start[0], 0);
+  }
+
+  dJointGroupDestroy(group);
+  dWorldDestroy(world);
+}
+
+/////////////////////////////////////////////////
+TEST_F(ODEContactCache_TEST, SaveRestore)
+{
+  ODEContactCache cache;
+  cache.SetEnabled(true);
+  cache.BeginStep();
+  const int count = this->Collide(cache);
+  ASSERT_GT(count, 0);
+
+  std::vector<uint8_t> state;
+  cache.Save(state);
+  EXPECT_FALSE(state.empty());
+
+  // Another world's geoms, or a truncated snapshot, leave the cache as is
+  ODEContactCache restored;
+  restored.SetEnabled(true);
+  size_t offset = 0;
+  EXPECT_FALSE(restored.Restore(state, offset, {this->plane}));
+  EXPECT_EQ(restored.Size(), 0u);
+  std::vector<uint8_t> truncated(state.begin(), state.end() - 1);
+  offset = 0;
+  EXPECT_FALSE(restored.Restore(truncated, offset, {this->plane, this->box}));
+  EXPECT_EQ(restored.Size(), 0u);
+
+  offset = 0;
+  ASSERT_TRUE(restored.Restore(state, offset, {this->plane, this->box}));
+  EXPECT_EQ(offset, state.size());
+  EXPECT_EQ(restored.Size(), 1u);
+
+  // The restored pair stands in for the narrowphase like the original
+  restored.BeginStep();
+  ASSERT_EQ(this->Reuse(restored), count);
+  for (int i = 0; i < count; ++i)
+  {
+    for (int k = 0; k < 3; ++k)
+    {
+      EXPECT_DOUBLE_EQ(this->reused[i].pos[k], this->contacts[i].pos[k]);
+      EXPECT_DOUBLE_EQ(this->reused[i].normal[k],
+          this->contacts[i].normal[k]);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -26,6 +26,7 @@ ODEHeightmapShape::ODEHeightmapShape(CollisionPtr _parent)
     : HeightmapShape(_parent)
 {
   this->flipY = false;
+  this->SetTileSupport(true);
 }
 
 //////////////////////////////////////////////////
@@ -40,6 +41,16 @@ dReal ODEHeightmapShape::GetHeightCallback(void *_data, int _x, int _y)
   return static_cast<ODEHeightmapShape*>(_data)->GetHeight(_x, _y);
 }
 
+//////////////////////////////////////////////////
+// samples the tile cache of a tiled heightmap, without looking the cache up
+// on every call
+static dReal getTiledHeightCallback(void *_data, int _x, int _y)
+{
+  if (_x < 0 || _y < 0)
+    return 0.0;
+  return static_cast<const common::TerrainTiles *>(_data)->Height(_x, _y);
+}
+
 
 //////////////////////////////////////////////////
 // creates the ODE height field. Only enabled if the height data type is float.
@@ -110,19 +121,39 @@ void ODEHeightmapShape::Init()
 
 
   // Step 3: Setup a callback method for ODE
-  setOdeHeightfieldDetails(
-      this->odeData,
-      this->heights.data(),
-      // in meters
-      this->Size().X(),
-      // in meters
-      this->Size().Y(),
-      // number of vertices
-      this->vertSize,
-      // vertical (z-axis) offset
-      this->Pos().Z(),
-      // vertical thickness for closing the height map mesh
-      1.0);
+  if (this->Tiled())
+  {
+    // Heights are sampled lazily from the tile cache, only the tiles
+    // touched by collisions are paged in
+    dGeomHeightfieldDataBuildCallback(
+        this->odeData,
+        const_cast<common::TerrainTiles *>(this->Tiles()),
+        &getTiledHeightCallback,
+        this->Size().X(),   // width (in meters)
+        this->Size().Y(),   // height (in meters)
+        this->vertSize,     // width (sampling size)
+        this->vertSize,     // height (sampling size)
+        1.0,                // vertical (z-axis) scaling
+        this->Pos().Z(),    // vertical (z-axis) offset
+        1.0,                // vertical thickness for closing the mesh
+        0);                 // wrap mode
+  }
+  else
+  {
+    setOdeHeightfieldDetails(
+        this->odeData,
+        this->heights.data(),
+        // in meters
+        this->Size().X(),
+        // in meters
+        this->Size().Y(),
+        // number of vertices
+        this->vertSize,
+        // vertical (z-axis) offset
+        this->Pos().Z(),
+        // vertical thickness for closing the height map mesh
+        1.0);
+  }
 
   // Step 4: Restrict the bounds of the AABB to improve efficiency
   dGeomHeightfieldDataSetBounds(this->odeData, this->GetMinHeight(),
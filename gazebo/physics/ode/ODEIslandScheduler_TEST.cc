@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "deps/opende/src/island_scheduler.h"
+
+/// \brief Islands of a Run, and what the scheduler did with them.
+class Islands
+{
+  /// \brief Constructor.
+  /// \param[in] _costs Cost of each island. Island i has one body and
+  /// i % 3 joints.
+  public: explicit Islands(const std::vector<size_t> &_costs)
+          : costs(_costs), calls(_costs.size()), threads(_costs.size(), -1),
+            jointOffsets(_costs.size(), -1)
+  {
+    for (size_t i = 0; i < _costs.size(); ++i)
+    {
+      this->sizes.push_back(1);
+      this->sizes.push_back(static_cast<int>(i % 3));
+    }
+  }
+
+  /// \brief Run the islands.
+  /// \param[in] _scheduler The scheduler.
+  public: void Run(dxIslandScheduler &_scheduler)
+  {
+    for (auto &count : this->calls)
+      count = 0;
+    this->done = 0;
+    _scheduler.Run(static_cast<int>(this->costs.size()), this->sizes.data(),
+        this->costs.data(), &Islands::Step, this);
+  }
+
+  /// \brief Check that every island ran once with its offsets, on a thread
+  /// of the scheduler.
+  /// \param[in] _slots Number of threads of the scheduler.
+  public: void Expect(const int _slots) const
+  {
+    int jointofs = 0;
+    for (size_t i = 0; i < this->costs.size(); ++i)
+    {
+      EXPECT_EQ(this->calls[i], 1) << "island " << i;
+      EXPECT_EQ(this->jointOffsets[i], jointofs) << "island " << i;
+      EXPECT_GE(this->threads[i], 0) << "island " << i;
+      EXPECT_LT(this->threads[i], _slots) << "island " << i;
+      jointofs += this->sizes[2 * i + 1];
+    }
+  }
+
+  /// \brief Island callback of the scheduler.
+  private: static void Step(void *_data, int _thread, int _bodyofs,
+               int _bcount, int _jointofs, int /*_jcount*/)
+  {
+    Islands *islands = static_cast<Islands *>(_data);
+    EXPECT_EQ(_bcount, 1);
+    if (_bodyofs == 0 && islands->stall)
+    {
+      // Hold this thread until every other island ran, which only
+      // happens if the batches queued behind this one are stolen
+      std::unique_lock<std::mutex> lock(islands->mutex);
+      islands->stolen = islands->doneCondition.wait_for(lock,
+          std::chrono::seconds(10), [islands]
+          {
+            return islands->done + 1 == islands->costs.size();
+          });
+    }
+
+    islands->calls[_bodyofs]++;
+    islands->threads[_bodyofs] = _thread;
+    islands->jointOffsets[_bodyofs] = _jointofs;
+
+    std::lock_guard<std::mutex> lock(islands->mutex);
+    ++islands->done;
+    islands->doneCondition.notify_all();
+  }
+
+  /// \brief True to hold the thread running island 0 until the others ran.
+  public: bool stall = false;
+
+  /// \brief True if the other islands ran while island 0 was held.
+  public: bool stolen = false;
+
+  /// \brief Cost of each island.
+  private: std::vector<size_t> costs;
+
+  /// \brief Body and joint count of each island.
+  private: std::vector<int> sizes;
+
+  /// \brief Number of times each island ran.
+  private: std::vector<std::atomic<int>> calls;
+
+  /// \brief Thread that ran each island.
+  private: std::vector<int> threads;
+
+  /// \brief Joint offset each island ran with.
+  private: std::vector<int> jointOffsets;
+
+  /// \brief Protects done.
+  private: std::mutex mutex;
+
+  /// \brief Notified when an island is done.
+  private: std::condition_variable doneCondition;
+
+  /// \brief Number of islands done.
+  private: size_t done = 0;
+};
+
+/////////////////////////////////////////////////
+TEST(ODEIslandScheduler_TEST, NoThreads)
+{
+  dxIslandScheduler scheduler(0);
+  EXPECT_EQ(scheduler.GetThreadCount(), 0);
+  EXPECT_EQ(scheduler.GetSlotCount(), 1);
+
+  // Without islands nothing runs
+  Islands none({});
+  none.Run(scheduler);
+  EXPECT_DOUBLE_EQ(scheduler.GetUtilization(), 0.0);
+
+  // The calling thread runs all the islands
+  Islands islands(std::vector<size_t>(20, 10));
+  islands.Run(scheduler);
+  islands.Expect(1);
+  EXPECT_DOUBLE_EQ(scheduler.GetUtilization(), 1.0);
+
+  // Negative counts also run on the calling thread
+  scheduler.SetThreadCount(-2);
+  EXPECT_EQ(scheduler.GetThreadCount(), 0);
+  EXPECT_EQ(scheduler.GetSlotCount(), 1);
+  islands.Run(scheduler);
+  islands.Expect(1);
+}
+
+/////////////////////////////////////////////////
+TEST(ODEIslandScheduler_TEST, ThreadCountChanges)
+{
+  std::vector<size_t> costs;
+  for (size_t i = 0; i < 200; ++i)
+    costs.push_back(1 + (i * 7919) % 500);
+  Islands islands(costs);
+
+  dxIslandScheduler scheduler(2);
+  for (const int threads : {2, 4, 4, 1, 0, 3, 8, 2})
+  {
+    // Workers are started and stopped between steps
+    scheduler.SetThreadCount(threads);
+    EXPECT_EQ(scheduler.GetThreadCount(), threads);
+    const int slots = std::max(threads, 1);
+    EXPECT_EQ(scheduler.GetSlotCount(), slots);
+
+    for (int step = 0; step < 3; ++step)
+    {
+      islands.Run(scheduler);
+      islands.Expect(slots);
+      EXPECT_GE(scheduler.GetUtilization(), 0.0);
+      EXPECT_LE(scheduler.GetUtilization(), 1.0);
+    }
+  }
+}
+
+/////////////////////////////////////////////////
+TEST(ODEIslandScheduler_TEST, WorkStealing)
+{
+  // Island 0 is expensive enough to get a batch of its own, the others
+  // are packed into batches that are dealt to every thread, including
+  // the one that ends up running island 0
+  std::vector<size_t> costs(64, 1);
+  costs[0] = 16;
+  Islands islands(costs);
+  islands.stall = true;
+
+  dxIslandScheduler scheduler(4);
+  for (int step = 0; step < 10; ++step)
+  {
+    islands.stolen = false;
+    islands.Run(scheduler);
+    islands.Expect(4);
+    EXPECT_TRUE(islands.stolen) << "step " << step;
+  }
+}
+
+/// \brief Team of a RunTeam, and what its threads did.
+class Team
+{
+  /// \brief Reserve and run a team.
+  /// \param[in] _scheduler The scheduler.
+  /// \param[in] _threads Number of threads to ask for.
+  public: void Run(dxIslandScheduler &_scheduler, const int _threads)
+  {
+    this->threads = _scheduler.ReserveTeam(_threads);
+    this->calls.assign(this->threads, 0);
+    this->arrived = 0;
+    this->together = true;
+    _scheduler.RunTeam(this->threads, &Team::Sweep, this);
+  }
+
+  /// \brief Check that every thread of the team ran once.
+  public: void Expect() const
+  {
+    for (int i = 0; i < this->threads; ++i)
+      EXPECT_EQ(this->calls[i], 1) << "thread " << i;
+    EXPECT_TRUE(this->together);
+  }
+
+  /// \brief Team callback of the scheduler. Waits for the whole team, as
+  /// the colored PGS sweep does at its barriers.
+  private: static void Sweep(void *_data, int _thread, int _threads)
+  {
+    Team *team = static_cast<Team *>(_data);
+    std::unique_lock<std::mutex> lock(team->mutex);
+    EXPECT_EQ(_threads, team->threads);
+    ASSERT_GE(_thread, 0);
+    ASSERT_LT(_thread, _threads);
+    team->calls[_thread]++;
+
+    ++team->arrived;
+    team->arrivedCondition.notify_all();
+    if (!team->arrivedCondition.wait_for(lock, std::chrono::seconds(10),
+          [team] { return team->arrived == team->threads; }))
+    {
+      team->together = false;
+    }
+  }
+
+  /// \brief Size of the team.
+  public: int threads = 0;
+
+  /// \brief Number of times each thread of the team ran.
+  private: std::vector<int> calls;
+
+  /// \brief Number of threads that reached the barrier.
+  private: int arrived = 0;
+
+  /// \brief False if a thread gave up waiting for the others.
+  private: bool together = true;
+
+  /// \brief Protects the members.
+  private: std::mutex mutex;
+
+  /// \brief Notified when a thread reaches the barrier.
+  private: std::condition_variable arrivedCondition;
+};
+
+/////////////////////////////////////////////////
+TEST(ODEIslandScheduler_TEST, Teams)
+{
+  const int hardware = static_cast<int>(std::thread::hardware_concurrency());
+  const int limit = hardware > 0 ? std::min(hardware, 4) : 4;
+
+  // Without team threads the calling thread is the team
+  dxIslandScheduler scheduler(0);
+  Team team;
+  team.Run(scheduler, 4);
+  EXPECT_EQ(team.threads, 1);
+  team.Expect();
+
+  // Team threads are capped at the hardware threads
+  scheduler.SetTeamThreadCount(1000);
+  if (hardware > 0)
+    EXPECT_EQ(scheduler.GetTeamThreadCount(), hardware);
+  scheduler.SetTeamThreadCount(-1);
+  EXPECT_EQ(scheduler.GetTeamThreadCount(), 0);
+
+  // Workers kept for teams do not step islands
+  scheduler.SetTeamThreadCount(limit);
+  EXPECT_EQ(scheduler.GetTeamThreadCount(), limit);
+  EXPECT_EQ(scheduler.GetSlotCount(), 1);
+  Islands islands(std::vector<size_t>(20, 10));
+  islands.Run(scheduler);
+  islands.Expect(1);
+
+  // A team only gets the idle workers, which may still be starting, and
+  // all of its threads run at once
+  for (int step = 0; step < 20; ++step)
+  {
+    team.Run(scheduler, 8);
+    EXPECT_GE(team.threads, 1);
+    EXPECT_LE(team.threads, limit);
+    team.Expect();
+  }
+
+  // Fewer team threads stop the extra workers
+  scheduler.SetTeamThreadCount(1);
+  team.Run(scheduler, 4);
+  EXPECT_EQ(team.threads, 1);
+  team.Expect();
+}
+
+/////////////////////////////////////////////////
+TEST(ODEIslandScheduler_TEST, TeamsInIslands)
+{
+  dxIslandScheduler scheduler(2);
+  scheduler.SetTeamThreadCount(4);
+  const int limit = std::max(scheduler.GetTeamThreadCount(), 1);
+
+  /// \brief Islands that each run a team.
+  struct TeamIslands
+  {
+    dxIslandScheduler *scheduler;
+    std::vector<Team> teams;
+  };
+  TeamIslands data;
+  data.scheduler = &scheduler;
+  data.teams = std::vector<Team>(16);
+  std::vector<int> sizes(2 * data.teams.size(), 0);
+  std::vector<size_t> costs(data.teams.size(), 1);
+  for (size_t i = 0; i < data.teams.size(); ++i)
+    sizes[2 * i] = 1;
+
+  // Islands running at once share the idle workers between their teams,
+  // and the island threads are not idle
+  for (int step = 0; step < 10; ++step)
+  {
+    scheduler.Run(static_cast<int>(data.teams.size()), sizes.data(),
+        costs.data(), [](void *_data, int /*_thread*/, int _bodyofs,
+          int /*_bcount*/, int /*_jointofs*/, int /*_jcount*/)
+        {
+          TeamIslands *islands = static_cast<TeamIslands *>(_data);
+          islands->teams[_bodyofs].Run(*islands->scheduler, 4);
+        }, &data);
+
+    for (auto &team : data.teams)
+    {
+      team.Expect();
+      EXPECT_LE(team.threads, limit);
+    }
+  }
+}
@@ -25,6 +25,7 @@
 #include "gazebo/physics/World.hh"
 #include "gazebo/physics/WorldPrivate.hh"
 #include "gazebo/physics/Model.hh"
+#include "gazebo/physics/ModelLocalUpdateGroup.hh"
 #include "gazebo/physics/ode/ODECollision.hh"
 #include "gazebo/physics/ode/ODESurfaceParams.hh"
 #include "gazebo/physics/ode/ODEPhysics.hh"
@@ -422,6 +423,8 @@ void ODELink::UpdateMass()
 //////////////////////////////////////////////////
 void ODELink::SetLinearVel(const ignition::math::Vector3d &_vel)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     dBodySetLinearVel(this->linkId, _vel.X(), _vel.Y(), _vel.Z());
@@ -509,6 +512,8 @@ ignition::math::Vector3d ODELink::WorldCoGLinearVel() const
 //////////////////////////////////////////////////
 void ODELink::SetAngularVel(const ignition::math::Vector3d &_vel)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     dBodySetAngularVel(this->linkId, _vel.X(), _vel.Y(), _vel.Z());
@@ -544,6 +549,8 @@ ignition::math::Vector3d ODELink::WorldAngularVel() const
 //////////////////////////////////////////////////
 void ODELink::SetForce(const ignition::math::Vector3d &_force)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     this->SetEnabled(true);
@@ -557,6 +564,8 @@ void ODELink::SetForce(const ignition::math::Vector3d &_force)
 //////////////////////////////////////////////////
 void ODELink::SetTorque(const ignition::math::Vector3d &_torque)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     this->SetEnabled(true);
@@ -570,6 +579,8 @@ void ODELink::SetTorque(const ignition::math::Vector3d &_torque)
 //////////////////////////////////////////////////
 void ODELink::AddForce(const ignition::math::Vector3d &_force)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     this->SetEnabled(true);
@@ -583,6 +594,8 @@ void ODELink::AddForce(const ignition::math::Vector3d &_force)
 /////////////////////////////////////////////////
 void ODELink::AddRelativeForce(const ignition::math::Vector3d &_force)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     this->SetEnabled(true);
@@ -598,6 +611,8 @@ void ODELink::AddForceAtRelativePosition(
     const ignition::math::Vector3d &_force,
     const ignition::math::Vector3d &_relpos)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     this->SetEnabled(true);
@@ -617,6 +632,8 @@ void ODELink::AddForceAtWorldPosition(
     const ignition::math::Vector3d &_force,
     const ignition::math::Vector3d &_pos)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     this->SetEnabled(true);
@@ -636,6 +653,8 @@ void ODELink::AddLinkForce(
     const ignition::math::Vector3d &_force,
     const ignition::math::Vector3d &_offset)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     // Force vector represents a direction only, so it should be rotated but
@@ -663,6 +682,8 @@ void ODELink::AddLinkForce(
 /////////////////////////////////////////////////
 void ODELink::AddTorque(const ignition::math::Vector3d &_torque)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     this->SetEnabled(true);
@@ -676,6 +697,8 @@ void ODELink::AddTorque(const ignition::math::Vector3d &_torque)
 /////////////////////////////////////////////////
 void ODELink::AddRelativeTorque(const ignition::math::Vector3d &_torque)
 {
+  GZ_CHECK_MODEL_LOCAL(this);
+
   if (this->linkId)
   {
     this->SetEnabled(true);
@@ -21,15 +21,21 @@
 #include <sdf/sdf.hh>
 
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <map>
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include <ignition/math/Matrix3.hh>
 #include <ignition/math/Rand.hh>
+#include <ignition/math/Vector2.hh>
 #include <ignition/math/Vector3.hh>
 #include <ignition/common/Profiler.hh>
 
+#include "gazebo/gazebo_config.h"
 #include "gazebo/util/Diagnostics.hh"
 #include "gazebo/common/Assert.hh"
 #include "gazebo/common/Console.hh"
@@ -75,11 +81,336 @@
 
 #include "gazebo/physics/ode/ODEPhysicsPrivate.hh"
 
+#ifdef HAVE_PARALLEL_QUICKSTEP
+#include <parallel_quickstep/parallel_quickstep.h>
+#endif
+
 using namespace gazebo;
 using namespace physics;
 
 GZ_REGISTER_PHYSICS_ENGINE("ode", ODEPhysics)
 
+namespace
+{
+  /// \brief Number of contact feedbacks converted by each task.
+  constexpr unsigned int kFeedbacksPerTask = 64;
+
+  /// \brief Append values to a snapshot.
+  /// \param[in,out] _state Snapshot.
+  /// \param[in] _values Values to append.
+  /// \param[in] _count Number of values.
+  template<typename T>
+  void AppendSnapshot(std::vector<uint8_t> &_state, const T *_values,
+      const size_t _count)
+  {
+    const uint8_t *bytes = reinterpret_cast<const uint8_t *>(_values);
+    _state.insert(_state.end(), bytes, bytes + _count * sizeof(T));
+  }
+
+  /// \brief Read values from a snapshot.
+  /// \param[in] _state Snapshot.
+  /// \param[in,out] _offset Offset of the values, moved past them.
+  /// \param[out] _values Values read.
+  /// \param[in] _count Number of values.
+  /// \return False if the snapshot is too short.
+  template<typename T>
+  bool ReadSnapshot(const std::vector<uint8_t> &_state, size_t &_offset,
+      T *_values, const size_t _count)
+  {
+    const size_t size = _count * sizeof(T);
+    if (_offset + size > _state.size())
+      return false;
+    std::memcpy(_values, _state.data() + _offset, size);
+    _offset += size;
+    return true;
+  }
+
+  /// \brief Get the step function of a step type.
+  /// \param[in] _type Step type.
+  /// \return The step function, nullptr if the type is unknown or not
+  /// available in this build.
+  int (*StepFunction(const std::string &_type))(dxWorld *, dReal)
+  {
+    if (_type == "quick")
+      return &dWorldQuickStep;
+    if (_type == "world")
+      return &dWorldStep;
+#ifdef HAVE_PARALLEL_QUICKSTEP
+    // Projected Gauss-Seidel on batches of independent constraint rows,
+    // for large islands that island threads can't split
+    if (_type == "parallel_quick")
+      return &dWorldParallelQuickStep;
+#endif
+    return nullptr;
+  }
+
+  /// \brief Log why a step type can not be used.
+  /// \param[in] _type Step type.
+  void StepTypeError(const std::string &_type)
+  {
+    if (_type == "parallel_quick")
+    {
+      gzerr << "Step type[parallel_quick] is not available, Gazebo was "
+            << "built without OpenMP" << std::endl;
+    }
+    else
+    {
+      gzerr << "Invalid step type[" << _type << "]" << std::endl;
+    }
+  }
+
+  /// \brief Add geoms to a space so that dSpaceGetGeom returns them in
+  /// the given order.
+  /// \param[in] _space Space.
+  /// \param[in] _geoms Geoms, which must not be in a space.
+  void AddInOrder(dSpaceID _space, const std::vector<dGeomID> &_geoms)
+  {
+    // The sweep and prune and bvh spaces append geoms, the other spaces
+    // add them to the front of their list
+    const int spaceClass = dSpaceGetClass(_space);
+    if (spaceClass == dSweepAndPruneSpaceClass ||
+        spaceClass == dBVHSpaceClass)
+    {
+      for (auto geom : _geoms)
+        dSpaceAdd(_space, geom);
+    }
+    else
+    {
+      for (auto geom = _geoms.rbegin(); geom != _geoms.rend(); ++geom)
+        dSpaceAdd(_space, *geom);
+    }
+  }
+
+  /// \brief Convert sort axes such as "zxy" to a dSAP_AXES value.
+  /// \param[in] _axes Three distinct axes out of x, y and z.
+  /// \param[out] _order The dSAP_AXES value.
+  /// \return False if _axes is not valid.
+  bool ConvertSapAxes(const std::string &_axes, int &_order)
+  {
+    if (_axes.size() != 3)
+      return false;
+
+    _order = 0;
+    int used = 0;
+    for (int i = 0; i < 3; ++i)
+    {
+      const int axis = _axes[i] - 'x';
+      if (axis < 0 || axis > 2 || (used & (1 << axis)))
+        return false;
+      used |= 1 << axis;
+      _order |= axis << (2 * i);
+    }
+    return true;
+  }
+
+  /// \brief Check the name of a broadphase.
+  /// \param[in] _type Name of the broadphase.
+  /// \return True if ODEPhysics supports it.
+  bool IsBroadphase(const std::string &_type)
+  {
+    return _type == "hash" || _type == "auto" || _type == "simple" ||
+        _type == "sap" || _type == "quadtree" || _type == "bvh";
+  }
+
+  /// \brief Create a top-level space with the configured broadphase.
+  /// \param[in] _data Broadphase settings.
+  /// \return The new space.
+  dSpaceID CreateSpace(const ODEPhysicsPrivate &_data)
+  {
+    if (_data.broadphase == "simple")
+      return dSimpleSpaceCreate(0);
+
+    if (_data.broadphase == "sap")
+    {
+      int order = dSAP_AXES_XYZ;
+      ConvertSapAxes(_data.sapAxes, order);
+      return dSweepAndPruneSpaceCreate(0, order);
+    }
+
+    if (_data.broadphase == "quadtree")
+    {
+      dVector3 center = {_data.quadtreeCenter.X(), _data.quadtreeCenter.Y(),
+          _data.quadtreeCenter.Z(), 0};
+      dVector3 extents = {_data.quadtreeExtents.X(),
+          _data.quadtreeExtents.Y(), _data.quadtreeExtents.Z(), 0};
+      return dQuadTreeSpaceCreate(0, center, extents, _data.quadtreeDepth);
+    }
+
+    if (_data.broadphase == "bvh")
+    {
+      dSpaceID space = dBVHSpaceCreate(0);
+      dBVHSpaceSetMargin(space, _data.bvhMargin);
+      return space;
+    }
+
+    // "hash", and "auto" which adapts the levels of a hash space
+    dSpaceID space = dHashSpaceCreate(0);
+    dHashSpaceSetLevels(space, _data.hashLevels.X(), _data.hashLevels.Y());
+    return space;
+  }
+
+  /// \brief Replace the top-level space with one of the configured
+  /// broadphase. The geoms move to the new space in the same order.
+  /// \param[in,out] _data Engine data.
+  void RebuildSpace(ODEPhysicsPrivate &_data)
+  {
+    dSpaceID space = CreateSpace(_data);
+
+    const int count = dSpaceGetNumGeoms(_data.spaceId);
+    std::vector<dGeomID> geoms(count);
+    for (int i = 0; i < count; ++i)
+      geoms[i] = dSpaceGetGeom(_data.spaceId, i);
+    for (auto geom : geoms)
+      dSpaceRemove(_data.spaceId, geom);
+    AddInOrder(space, geoms);
+
+    dSpaceSetCleanup(_data.spaceId, 0);
+    dSpaceDestroy(_data.spaceId);
+    _data.spaceId = space;
+    _data.autoGeomCount = -1;
+  }
+
+  /// \brief Choose the levels of a hash space from the sizes of its geoms.
+  /// \param[in] _space Hash space, with up to date geom AABBs.
+  /// \param[out] _levels Smallest and largest level.
+  /// \return False if the space has no finite geoms.
+  bool ChooseHashLevels(dSpaceID _space, ignition::math::Vector2i &_levels)
+  {
+    // Level of each geom, as the hash space computes it
+    std::vector<int> levels;
+    const int count = dSpaceGetNumGeoms(_space);
+    for (int i = 0; i < count; ++i)
+    {
+      dReal aabb[6];
+      dGeomGetAABB(dSpaceGetGeom(_space, i), aabb);
+      double size = 0;
+      bool finite = true;
+      for (int j = 0; j < 6; j += 2)
+      {
+        finite = finite && aabb[j] > -dInfinity && aabb[j + 1] < dInfinity;
+        size = std::max(size, static_cast<double>(aabb[j + 1] - aabb[j]));
+      }
+      if (!finite || size <= 0)
+        continue;
+      int level;
+      std::frexp(size, &level);
+      levels.push_back(level);
+    }
+    if (levels.empty())
+      return false;
+    std::sort(levels.begin(), levels.end());
+
+    // Every geom up to the largest level looks for neighbors in up to 8
+    // cells at each level from its own to the largest one, and every geom
+    // above it is tested against all the others. A few large geoms, such
+    // as the ground, are cheaper to test against everything than to make
+    // all the small geoms walk up to their level.
+    const size_t n = levels.size();
+    double best = -1;
+    size_t levelSum = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+      levelSum += levels[i] - levels.front();
+      if (i + 1 < n && levels[i + 1] == levels[i])
+        continue;
+
+      const int maxLevel = levels[i];
+      const size_t hashed = i + 1;
+      const double cost = 8.0 * (hashed * (maxLevel - levels.front() + 1) -
+          levelSum) + static_cast<double>(n - hashed) * n;
+      if (best < 0 || cost < best)
+      {
+        best = cost;
+        _levels.Set(levels.front(), maxLevel);
+      }
+    }
+    return true;
+  }
+
+  /// \brief Save the order of the geoms of a space and of its sub-spaces.
+  /// Spaces test their geoms in list order, which changes as geoms move,
+  /// and the order of the contacts changes the solution of the solver.
+  /// \param[in] _space Space.
+  /// \param[in,out] _order For each space, depth first, its number of
+  /// geoms followed by its geoms.
+  void SaveSpaceOrder(dSpaceID _space, std::vector<uintptr_t> &_order)
+  {
+    const int count = dSpaceGetNumGeoms(_space);
+    _order.push_back(count);
+    const size_t start = _order.size();
+    for (int i = 0; i < count; ++i)
+      _order.push_back(reinterpret_cast<uintptr_t>(dSpaceGetGeom(_space, i)));
+
+    for (int i = 0; i < count; ++i)
+    {
+      dGeomID geom = reinterpret_cast<dGeomID>(_order[start + i]);
+      if (dGeomIsSpace(geom))
+        SaveSpaceOrder(reinterpret_cast<dSpaceID>(geom), _order);
+    }
+  }
+
+  /// \brief Restore the order of the geoms saved by SaveSpaceOrder.
+  /// \param[in] _space Space.
+  /// \param[in] _order Saved order.
+  /// \param[in,out] _index Index of the space in _order, moved past its
+  /// sub-spaces.
+  /// \param[in] _apply False to only check that every space still has
+  /// the saved geoms.
+  /// \return False if the geoms of a space changed.
+  bool RestoreSpaceOrder(dSpaceID _space, const std::vector<uintptr_t> &_order,
+      size_t &_index, const bool _apply)
+  {
+    if (_index >= _order.size())
+      return false;
+    const size_t count = _order[_index++];
+    if (count != static_cast<size_t>(dSpaceGetNumGeoms(_space)) ||
+        _index + count > _order.size())
+    {
+      return false;
+    }
+    const size_t start = _index;
+    _index += count;
+
+    if (_apply)
+    {
+      std::vector<dGeomID> geoms(count);
+      for (size_t i = 0; i < count; ++i)
+      {
+        geoms[i] = reinterpret_cast<dGeomID>(_order[start + i]);
+        dSpaceRemove(_space, geoms[i]);
+      }
+      AddInOrder(_space, geoms);
+    }
+    else
+    {
+      // Compare pointers only, saved geoms may have been destroyed
+      std::vector<uintptr_t> saved(_order.begin() + start,
+          _order.begin() + start + count);
+      std::vector<uintptr_t> current(count);
+      for (size_t i = 0; i < count; ++i)
+      {
+        current[i] = reinterpret_cast<uintptr_t>(
+            dSpaceGetGeom(_space, static_cast<int>(i)));
+      }
+      std::sort(saved.begin(), saved.end());
+      std::sort(current.begin(), current.end());
+      if (saved != current)
+        return false;
+    }
+
+    for (size_t i = start; i < start + count; ++i)
+    {
+      dGeomID geom = reinterpret_cast<dGeomID>(_order[i]);
+      if (dGeomIsSpace(geom) && !RestoreSpaceOrder(
+            reinterpret_cast<dSpaceID>(geom), _order, _index, _apply))
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
 /*
 class ContactUpdate_TBB
 {
@@ -144,8 +475,14 @@ ODEPhysics::ODEPhysics(WorldPtr _world)
 
   this->dataPtr->worldId = dWorldCreate();
 
-  this->dataPtr->spaceId = dHashSpaceCreate(0);
-  dHashSpaceSetLevels(this->dataPtr->spaceId, -2, 8);
+  this->dataPtr->broadphase = "hash";
+  this->dataPtr->hashLevels.Set(-2, 8);
+  this->dataPtr->sapAxes = "xyz";
+  this->dataPtr->quadtreeExtents.Set(100, 100, 100);
+  this->dataPtr->quadtreeDepth = 6;
+  this->dataPtr->bvhMargin = 0.05;
+  this->dataPtr->autoGeomCount = -1;
+  this->dataPtr->spaceId = CreateSpace(*this->dataPtr);
 
   this->dataPtr->contactGroup = dJointGroupCreate(0);
 
@@ -230,12 +567,69 @@ void ODEPhysics::Load(sdf::ElementPtr _sdf)
     this->GetSORPGSIters());
   dWorldSetQuickStepW(this->dataPtr->worldId, this->GetSORPGSW());
 
+  if (odeElem->HasElement("broadphase"))
+    this->LoadBroadphase(odeElem->GetElement("broadphase"));
+
   // Set the physics update function
   this->SetStepType(this->dataPtr->stepType);
   if (this->dataPtr->physicsStepFunc == nullptr)
     gzthrow(std::string("Invalid step type[") + this->dataPtr->stepType);
 }
 
+/////////////////////////////////////////////////
+void ODEPhysics::LoadBroadphase(sdf::ElementPtr _sdf)
+{
+  // Every child is optional. The settings go through SetParam, which
+  // checks them and creates the space once the type is known.
+  if (_sdf->HasElement("hash"))
+  {
+    sdf::ElementPtr hashElem = _sdf->GetElement("hash");
+    ignition::math::Vector2i levels = this->dataPtr->hashLevels;
+    if (hashElem->HasElement("min_level"))
+      levels.X(hashElem->Get<int>("min_level"));
+    if (hashElem->HasElement("max_level"))
+      levels.Y(hashElem->Get<int>("max_level"));
+    this->SetParam("broadphase_hash_levels", levels);
+  }
+
+  if (_sdf->HasElement("sap") &&
+      _sdf->GetElement("sap")->HasElement("axes"))
+  {
+    this->SetParam("broadphase_sap_axes",
+        _sdf->GetElement("sap")->Get<std::string>("axes"));
+  }
+
+  if (_sdf->HasElement("quadtree"))
+  {
+    sdf::ElementPtr quadtreeElem = _sdf->GetElement("quadtree");
+    if (quadtreeElem->HasElement("center"))
+    {
+      this->SetParam("broadphase_quadtree_center",
+          quadtreeElem->Get<ignition::math::Vector3d>("center"));
+    }
+    if (quadtreeElem->HasElement("extents"))
+    {
+      this->SetParam("broadphase_quadtree_extents",
+          quadtreeElem->Get<ignition::math::Vector3d>("extents"));
+    }
+    if (quadtreeElem->HasElement("depth"))
+    {
+      this->SetParam("broadphase_quadtree_depth",
+          quadtreeElem->Get<int>("depth"));
+    }
+  }
+
+  if (_sdf->HasElement("bvh") &&
+      _sdf->GetElement("bvh")->HasElement("margin"))
+  {
+    this->SetParam("broadphase_bvh_margin",
+        _sdf->GetElement("bvh")->Get<double>("margin"));
+  }
+
+  if (_sdf->HasElement("type"))
+    this->SetParam("broadphase", _sdf->Get<std::string>("type"));
+}
+
 /////////////////////////////////////////////////
 void ODEPhysics::OnRequest(ConstRequestPtr &_msg)
 {
@@ -366,6 +760,7 @@ void ODEPhysics::UpdateCollision()
 
   boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
   dJointGroupEmpty(this->dataPtr->contactGroup);
+  this->dataPtr->contactCache.BeginStep();
 
   unsigned int i = 0;
   this->dataPtr->collidersCount = 0;
@@ -377,9 +772,26 @@ void ODEPhysics::UpdateCollision()
 
   // Do collision detection; this will add contacts to the contact group
   dSpaceCollide(this->dataPtr->spaceId, this, CollisionCallback);
-  DIAG_TIMER_LAP("ODEPhysics::UpdateCollision", "dSpaceCollide");
+  DIAG_TIMER_LAP("ODEPhysics::UpdateCollision", "broadphase");
   IGN_PROFILE_END();
 
+  // The "auto" broadphase chooses its hash levels again when models come
+  // or go. dSpaceCollide has just updated the AABBs it needs.
+  const int geomCount = dSpaceGetNumGeoms(this->dataPtr->spaceId);
+  if (this->dataPtr->broadphase == "auto" &&
+      geomCount != this->dataPtr->autoGeomCount)
+  {
+    IGN_PROFILE_BEGIN("broadphaseTuning");
+    this->dataPtr->autoGeomCount = geomCount;
+    if (ChooseHashLevels(this->dataPtr->spaceId, this->dataPtr->hashLevels))
+    {
+      dHashSpaceSetLevels(this->dataPtr->spaceId,
+          this->dataPtr->hashLevels.X(), this->dataPtr->hashLevels.Y());
+    }
+    DIAG_TIMER_LAP("ODEPhysics::UpdateCollision", "broadphaseTuning");
+    IGN_PROFILE_END();
+  }
+
   IGN_PROFILE_BEGIN("collideShapes");
   // Generate non-trimesh collisions.
   for (i = 0; i < this->dataPtr->collidersCount; ++i)
@@ -420,35 +832,64 @@ void ODEPhysics::UpdatePhysics()
     (*(this->dataPtr->physicsStepFunc))
       (this->dataPtr->worldId, this->maxStepSize);
 
-    ignition::math::Vector3d f1, f2, t1, t2;
+    // Keep the contact forces to warm start the next step
+    if (this->dataPtr->contactCache.Enabled())
+      this->dataPtr->contactCache.SaveLambdas();
 
-    // Set the joint contact feedback for each contact.
-    for (unsigned int i = 0; i < this->dataPtr->jointFeedbackIndex; ++i)
+    // Set the joint contact feedback for each contact. Nothing is
+    // stored for contacts no one listens to.
+    const unsigned int feedbackCount = this->dataPtr->jointFeedbackIndex;
+    if (feedbackCount > 0)
     {
-      Contact *contactFeedback = this->dataPtr->jointFeedbacks[i]->contact;
-      Collision *col1 = contactFeedback->collision1;
-      Collision *col2 = contactFeedback->collision2;
-
-      GZ_ASSERT(col1 != nullptr, "Collision 1 is null");
-      GZ_ASSERT(col2 != nullptr, "Collision 2 is null");
+      ContactWrenchBuffer &wrenches = this->contactManager->Wrenches();
+      wrenches.Resize(this->contactManager->GetContacts(),
+          this->contactManager->GetContactCount());
 
-      for (int j = 0; j < this->dataPtr->jointFeedbacks[i]->count; ++j)
+      // Each contact only writes its own wrenches, so the contacts can be
+      // converted in parallel
+      auto convert = [&](const tbb::blocked_range<unsigned int> &_r)
+      {
+        for (unsigned int i = _r.begin(); i != _r.end(); ++i)
+        {
+          const ODEJointFeedback *feedback = this->dataPtr->jointFeedbacks[i];
+          GZ_ASSERT(feedback->link1 != nullptr, "Link 1 is null");
+          GZ_ASSERT(feedback->link2 != nullptr, "Link 2 is null");
+
+          // Rotations from world to link frames, shared by all the points
+          const ignition::math::Matrix3d rot1(
+              feedback->link1->WorldPose().Rot().Inverse());
+          const ignition::math::Matrix3d rot2(
+              feedback->link2->WorldPose().Rot().Inverse());
+          const std::size_t offset = wrenches.Offset(feedback->contactIndex);
+
+          for (int j = 0; j < feedback->count; ++j)
+          {
+            const dJointFeedback &fb = feedback->feedbacks[j];
+            JointWrench &wrench = feedback->contact->wrench[j];
+
+            // set force torque in link frame
+            wrench.body1Force =
+                rot1 * ignition::math::Vector3d(fb.f1[0], fb.f1[1], fb.f1[2]);
+            wrench.body2Force =
+                rot2 * ignition::math::Vector3d(fb.f2[0], fb.f2[1], fb.f2[2]);
+            wrench.body1Torque =
+                rot1 * ignition::math::Vector3d(fb.t1[0], fb.t1[1], fb.t1[2]);
+            wrench.body2Torque =
+                rot2 * ignition::math::Vector3d(fb.t2[0], fb.t2[1], fb.t2[2]);
+
+            wrenches.Set(offset + j, wrench);
+          }
+        }
+      };
+
+      if (feedbackCount > kFeedbacksPerTask)
+      {
+        tbb::parallel_for(tbb::blocked_range<unsigned int>(
+              0, feedbackCount, kFeedbacksPerTask), convert);
+      }
+      else
       {
-        dJointFeedback fb = this->dataPtr->jointFeedbacks[i]->feedbacks[j];
-        f1.Set(fb.f1[0], fb.f1[1], fb.f1[2]);
-        f2.Set(fb.f2[0], fb.f2[1], fb.f2[2]);
-        t1.Set(fb.t1[0], fb.t1[1], fb.t1[2]);
-        t2.Set(fb.t2[0], fb.t2[1], fb.t2[2]);
-
-        // set force torque in link frame
-        this->dataPtr->jointFeedbacks[i]->contact->wrench[j].body1Force =
-             col1->GetLink()->WorldPose().Rot().RotateVectorReverse(f1);
-        this->dataPtr->jointFeedbacks[i]->contact->wrench[j].body2Force =
-             col2->GetLink()->WorldPose().Rot().RotateVectorReverse(f2);
-        this->dataPtr->jointFeedbacks[i]->contact->wrench[j].body1Torque =
-             col1->GetLink()->WorldPose().Rot().RotateVectorReverse(t1);
-        this->dataPtr->jointFeedbacks[i]->contact->wrench[j].body2Torque =
-             col2->GetLink()->WorldPose().Rot().RotateVectorReverse(t2);
+        convert(tbb::blocked_range<unsigned int>(0, feedbackCount));
       }
     }
   }
@@ -494,6 +935,102 @@ void ODEPhysics::Reset()
   boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
   // Very important to clear out the contact group
   dJointGroupEmpty(this->dataPtr->contactGroup);
+  this->dataPtr->contactCache.Clear();
+}
+
+//////////////////////////////////////////////////
+bool ODEPhysics::SaveSnapshot(std::vector<uint8_t> &_state)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+
+  const uint64_t seed = dWorldGetRandSeed(this->dataPtr->worldId);
+  const int32_t worldSize = dWorldGetStateSize(this->dataPtr->worldId);
+  std::vector<dReal> worldState(worldSize);
+  dWorldGetState(this->dataPtr->worldId, worldState.data());
+
+  std::vector<uintptr_t> order;
+  SaveSpaceOrder(this->dataPtr->spaceId, order);
+  const uint64_t orderSize = order.size();
+
+  _state.clear();
+  _state.reserve(sizeof(seed) + sizeof(worldSize) +
+      worldSize * sizeof(dReal) + sizeof(orderSize) +
+      orderSize * sizeof(uintptr_t));
+  AppendSnapshot(_state, &seed, 1);
+  AppendSnapshot(_state, &worldSize, 1);
+  AppendSnapshot(_state, worldState.data(), worldState.size());
+  AppendSnapshot(_state, &orderSize, 1);
+  AppendSnapshot(_state, order.data(), order.size());
+
+  // Warm start values of the contacts, the next step reuses them
+  this->dataPtr->contactCache.Save(_state);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool ODEPhysics::RestoreSnapshot(const std::vector<uint8_t> &_state)
+{
+  boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+
+  size_t offset = 0;
+  uint64_t seed = 0;
+  int32_t worldSize = 0;
+  bool valid = ReadSnapshot(_state, offset, &seed, 1) &&
+      ReadSnapshot(_state, offset, &worldSize, 1) && worldSize >= 0 &&
+      static_cast<size_t>(worldSize) <=
+      (_state.size() - offset) / sizeof(dReal);
+
+  std::vector<dReal> worldState(valid ? worldSize : 0);
+  uint64_t orderSize = 0;
+  valid = valid &&
+      ReadSnapshot(_state, offset, worldState.data(), worldState.size()) &&
+      ReadSnapshot(_state, offset, &orderSize, 1) &&
+      orderSize <= (_state.size() - offset) / sizeof(uintptr_t);
+
+  std::vector<uintptr_t> order(valid ? orderSize : 0);
+  valid = valid && ReadSnapshot(_state, offset, order.data(), order.size());
+
+  // The order also holds the geom counts of the spaces, which never match
+  // a geom
+  std::unordered_set<dGeomID> geoms;
+  for (auto value : order)
+    geoms.insert(reinterpret_cast<dGeomID>(value));
+  valid = valid &&
+      this->dataPtr->contactCache.Restore(_state, offset, geoms) &&
+      offset == _state.size();
+  if (!valid)
+  {
+    gzerr << "Invalid ODE snapshot\n";
+    this->dataPtr->contactCache.Clear();
+    return false;
+  }
+
+  size_t index = 0;
+  if (!RestoreSpaceOrder(this->dataPtr->spaceId, order, index, false) ||
+      index != order.size())
+  {
+    gzerr << "The collisions of the world changed since the snapshot\n";
+    this->dataPtr->contactCache.Clear();
+    return false;
+  }
+
+  // Contact joints of the last step are not part of the state, the cache
+  // keeps their multipliers
+  dJointGroupEmpty(this->dataPtr->contactGroup);
+
+  // This calls ODELink::MoveCallback for every body, adding the links to
+  // the world's dirty poses
+  if (!dWorldSetState(this->dataPtr->worldId, worldState.data(), worldSize))
+  {
+    gzerr << "The links and joints of the world changed since the snapshot\n";
+    this->dataPtr->contactCache.Clear();
+    return false;
+  }
+  dWorldSetRandSeed(this->dataPtr->worldId, seed);
+
+  index = 0;
+  RestoreSpaceOrder(this->dataPtr->spaceId, order, index, true);
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -922,18 +1459,27 @@ std::string ODEPhysics::GetStepType() const
 //////////////////////////////////////////////////
 void ODEPhysics::SetStepType(const std::string &_type)
 {
+  std::string type = _type;
+  int (*stepFunc)(dxWorld *, dReal) = StepFunction(type);
+  if (!stepFunc)
+  {
+    StepTypeError(type);
+
+    // Keep the current step type. A world asking for parallel_quick in a
+    // build without it still loads, with quick.
+    if (this->dataPtr->physicsStepFunc || type != "parallel_quick")
+      return;
+    gzwarn << "Using step type[quick] instead" << std::endl;
+    type = "quick";
+    stepFunc = &dWorldQuickStep;
+  }
+
   sdf::ElementPtr elem = this->sdf->GetElement("ode")->GetElement("solver");
-  elem->GetElement("type")->Set(_type);
-  this->dataPtr->stepType = _type;
+  elem->GetElement("type")->Set(type);
+  this->dataPtr->stepType = type;
 
   // Set the physics update function
-  if (this->dataPtr->stepType == "quick")
-    this->dataPtr->physicsStepFunc = &dWorldQuickStep;
-  else if (this->dataPtr->stepType == "world")
-    this->dataPtr->physicsStepFunc = &dWorldStep;
-  else
-    gzerr << "Invalid step type[" << this->dataPtr->stepType
-          << "]" << std::endl;
+  this->dataPtr->physicsStepFunc = stepFunc;
 }
 
 //////////////////////////////////////////////////
@@ -1062,35 +1608,64 @@ void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
   if (_collision2->GetMaxContacts() < maxCollide)
     maxCollide = _collision2->GetMaxContacts();
 
-  // Generate the contacts
-  numc = dCollide(_collision1->GetCollisionId(), _collision2->GetCollisionId(),
-      MAX_COLLIDE_RETURNS, _contactCollisions, sizeof(_contactCollisions[0]));
+  dGeomID geom1 = _collision1->GetCollisionId();
+  dGeomID geom2 = _collision2->GetCollisionId();
 
-  // Return if no contacts.
-  if (numc == 0)
-    return;
+  // Reuse the contacts of the previous steps if the pair kept its
+  // relative pose
+  ODEContactCache &cache = this->dataPtr->contactCache;
+  ODEContactCache::Pair *cached = nullptr;
+  int cachedCount = -1;
+  if (cache.Enabled())
+  {
+    cached = &cache.Find(geom1, geom2);
+    cachedCount = cache.Reuse(*cached, geom1, geom2, maxCollide,
+        _contactCollisions);
+  }
 
   // Store the indices of the contacts.
   for (int i = 0; i < MAX_CONTACT_JOINTS; i++)
     this->dataPtr->indices[i] = i;
 
-  // Choose only the best contacts if too many were generated.
-  if (maxCollide > 0 && numc > maxCollide)
+  if (cachedCount >= 0)
+  {
+    // The cached contacts are already the best ones
+    numc = cachedCount;
+  }
+  else
   {
-    double max = _contactCollisions[maxCollide-1].depth;
-    for (unsigned int i = maxCollide; i < numc; ++i)
+    // Generate the contacts
+    numc = dCollide(geom1, geom2, MAX_COLLIDE_RETURNS, _contactCollisions,
+        sizeof(_contactCollisions[0]));
+
+    // Choose only the best contacts if too many were generated.
+    if (maxCollide > 0 && numc > maxCollide)
     {
-      if (_contactCollisions[i].depth > max)
+      double max = _contactCollisions[maxCollide-1].depth;
+      for (unsigned int i = maxCollide; i < numc; ++i)
       {
-        max = _contactCollisions[i].depth;
-        this->dataPtr->indices[maxCollide-1] = i;
+        if (_contactCollisions[i].depth > max)
+        {
+          max = _contactCollisions[i].depth;
+          this->dataPtr->indices[maxCollide-1] = i;
+        }
       }
+
+      // Make sure numc has the valid number of contacts.
+      numc = maxCollide;
     }
 
-    // Make sure numc has the valid number of contacts.
-    numc = maxCollide;
+    if (cached)
+    {
+      cache.Update(*cached, geom1, geom2, maxCollide, _contactCollisions,
+          this->dataPtr->indices, numc);
+    }
   }
 
+  // Return if no contacts.
+  if (numc == 0)
+    return;
+
   // Set the contact surface parameter flags.
   contact.surface.mode = dContactBounce |
                          dContactMu2 |
@@ -1259,8 +1834,8 @@ void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
              surf2->bounceThreshold);
 
   // Get the ODE body IDs
-  dBodyID b1 = dGeomGetBody(_collision1->GetCollisionId());
-  dBodyID b2 = dGeomGetBody(_collision2->GetCollisionId());
+  dBodyID b1 = dGeomGetBody(geom1);
+  dBodyID b2 = dGeomGetBody(geom2);
 
   // Add a new contact to the manager. This will return nullptr if no one is
   // listening for contact information.
@@ -1285,6 +1860,9 @@ void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
     this->dataPtr->jointFeedbackIndex++;
     jointFeedback->count = 0;
     jointFeedback->contact = contactFeedback;
+    jointFeedback->contactIndex = this->contactManager->GetContactCount() - 1;
+    jointFeedback->link1 = _collision1->GetLink().get();
+    jointFeedback->link2 = _collision2->GetLink().get();
   }
 
   // Create a joint for each contact
@@ -1297,6 +1875,10 @@ void ODEPhysics::Collide(ODECollision *_collision1, ODECollision *_collision2,
     dJointID contactJoint = dJointCreateContact(this->dataPtr->worldId,
       this->dataPtr->contactGroup, &contact);
 
+    // Start from the forces of the matching contact of the last step
+    if (cached)
+      cache.WarmStart(*cached, j, contactJoint);
+
     // Store contact information.
     if (contactFeedback && jointFeedback)
     {
@@ -1414,7 +1996,7 @@ void ODEPhysics::DebugPrint() const
 /////////////////////////////////////////////////
 void ODEPhysics::SetSeed(uint32_t _seed)
 {
-  dRandSetSeed(_seed);
+  dWorldSetRandSeed(this->dataPtr->worldId, _seed);
 }
 
 //////////////////////////////////////////////////
@@ -1427,7 +2009,13 @@ bool ODEPhysics::SetParam(const std::string &_key, const boost::any &_value)
   {
     if (_key == "solver_type")
     {
-      this->SetStepType(any_cast<std::string>(_value));
+      const std::string value = any_cast<std::string>(_value);
+      if (!StepFunction(value))
+      {
+        StepTypeError(value);
+        return false;
+      }
+      this->SetStepType(value);
     }
     else if (_key == "cfm")
     {
@@ -1531,6 +2119,13 @@ bool ODEPhysics::SetParam(const std::string &_key, const boost::any &_value)
       dWorldSetQuickStepExperimentalRowReordering(this->dataPtr->worldId,
         any_cast<bool>(_value));
     }
+    else if (_key == "row_coloring_threads")
+    {
+      // The island scheduler starts or stops the workers the sweep borrows
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      dWorldSetQuickStepRowColoringThreads(this->dataPtr->worldId,
+        any_cast<int>(_value));
+    }
     else if (_key == "warm_start_factor")
     {
       dWorldSetQuickStepWarmStartFactor(this->dataPtr->worldId,
@@ -1553,8 +2148,112 @@ bool ODEPhysics::SetParam(const std::string &_key, const boost::any &_value)
         gzerr << "boost any_cast error:" << e.what() << "\n";
         return false;
       }
+      // Changing the thread count stops workers and resizes the per-thread
+      // working memory, so it must not happen during a step
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
       dWorldSetIslandThreads(this->dataPtr->worldId, value);
     }
+    else if (_key == "broadphase")
+    {
+      const std::string value = any_cast<std::string>(_value);
+      if (!IsBroadphase(value))
+      {
+        gzerr << "Unknown broadphase [" << value << "], use hash, auto, "
+              << "simple, sap, quadtree or bvh\n";
+        return false;
+      }
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      this->dataPtr->broadphase = value;
+      RebuildSpace(*this->dataPtr);
+    }
+    else if (_key == "broadphase_hash_levels")
+    {
+      const auto value = any_cast<ignition::math::Vector2i>(_value);
+      if (value.X() > value.Y())
+      {
+        gzerr << "broadphase_hash_levels min level [" << value.X()
+              << "] is larger than max level [" << value.Y() << "]\n";
+        return false;
+      }
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      this->dataPtr->hashLevels = value;
+      if (dSpaceGetClass(this->dataPtr->spaceId) == dHashSpaceClass)
+        dHashSpaceSetLevels(this->dataPtr->spaceId, value.X(), value.Y());
+    }
+    else if (_key == "broadphase_sap_axes")
+    {
+      const std::string value = any_cast<std::string>(_value);
+      int order;
+      if (!ConvertSapAxes(value, order))
+      {
+        gzerr << "Invalid broadphase_sap_axes [" << value
+              << "], use an order of x, y and z such as xyz\n";
+        return false;
+      }
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      this->dataPtr->sapAxes = value;
+      if (this->dataPtr->broadphase == "sap")
+        RebuildSpace(*this->dataPtr);
+    }
+    else if (_key == "broadphase_quadtree_center" ||
+             _key == "broadphase_quadtree_extents")
+    {
+      const auto value = any_cast<ignition::math::Vector3d>(_value);
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      if (_key == "broadphase_quadtree_center")
+        this->dataPtr->quadtreeCenter = value;
+      else
+        this->dataPtr->quadtreeExtents = value;
+      if (this->dataPtr->broadphase == "quadtree")
+        RebuildSpace(*this->dataPtr);
+    }
+    else if (_key == "broadphase_quadtree_depth")
+    {
+      const int value = any_cast<int>(_value);
+      if (value < 0)
+      {
+        gzerr << "broadphase_quadtree_depth must not be negative\n";
+        return false;
+      }
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      this->dataPtr->quadtreeDepth = value;
+      if (this->dataPtr->broadphase == "quadtree")
+        RebuildSpace(*this->dataPtr);
+    }
+    else if (_key == "broadphase_bvh_margin")
+    {
+      const double value = any_cast<double>(_value);
+      if (value < 0)
+      {
+        gzerr << "broadphase_bvh_margin must not be negative\n";
+        return false;
+      }
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      this->dataPtr->bvhMargin = value;
+      if (this->dataPtr->broadphase == "bvh")
+        dBVHSpaceSetMargin(this->dataPtr->spaceId, value);
+    }
+    else if (_key == "contact_cache")
+    {
+      const bool value = any_cast<bool>(_value);
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      this->dataPtr->contactCache.SetEnabled(value);
+    }
+    else if (_key == "contact_cache_linear_tolerance" ||
+             _key == "contact_cache_angular_tolerance")
+    {
+      const double value = any_cast<double>(_value);
+      if (value < 0)
+      {
+        gzerr << _key << " must not be negative\n";
+        return false;
+      }
+      boost::recursive_mutex::scoped_lock lock(*this->physicsUpdateMutex);
+      if (_key == "contact_cache_linear_tolerance")
+        this->dataPtr->contactCache.SetLinearTolerance(value);
+      else
+        this->dataPtr->contactCache.SetAngularTolerance(value);
+    }
     else if (_key == "ode_quiet")
     {
       bool odeQuiet = any_cast<bool>(_value);
@@ -1654,6 +2353,8 @@ bool ODEPhysics::GetParam(const std::string &_key, boost::any &_value) const
     _value = dWorldGetQuickStepExperimentalRowReordering
         (this->dataPtr->worldId);
   }
+  else if (_key == "row_coloring_threads")
+    _value = dWorldGetQuickStepRowColoringThreads(this->dataPtr->worldId);
   else if (_key == "warm_start_factor")
     _value = dWorldGetQuickStepWarmStartFactor(this->dataPtr->worldId);
   else if (_key == "extra_friction_iterations")
@@ -1662,6 +2363,37 @@ bool ODEPhysics::GetParam(const std::string &_key, boost::any &_value) const
     _value = this->GetFrictionModel();
   else if (_key == "island_threads")
     _value = dWorldGetIslandThreads(this->dataPtr->worldId);
+  else if (_key == "island_thread_utilization")
+  {
+    _value = static_cast<double>(
+        dWorldGetIslandThreadUtilization(this->dataPtr->worldId));
+  }
+  else if (_key == "broadphase")
+    _value = this->dataPtr->broadphase;
+  else if (_key == "broadphase_hash_levels")
+    _value = this->dataPtr->hashLevels;
+  else if (_key == "broadphase_sap_axes")
+    _value = this->dataPtr->sapAxes;
+  else if (_key == "broadphase_quadtree_center")
+    _value = this->dataPtr->quadtreeCenter;
+  else if (_key == "broadphase_quadtree_extents")
+    _value = this->dataPtr->quadtreeExtents;
+  else if (_key == "broadphase_quadtree_depth")
+    _value = this->dataPtr->quadtreeDepth;
+  else if (_key == "broadphase_bvh_margin")
+    _value = this->dataPtr->bvhMargin;
+  else if (_key == "contact_cache")
+    _value = this->dataPtr->contactCache.Enabled();
+  else if (_key == "contact_cache_linear_tolerance")
+    _value = this->dataPtr->contactCache.LinearTolerance();
+  else if (_key == "contact_cache_angular_tolerance")
+    _value = this->dataPtr->contactCache.AngularTolerance();
+  else if (_key == "contact_cache_hits")
+    _value = static_cast<int>(this->dataPtr->contactCache.Hits());
+  else if (_key == "contact_cache_misses")
+    _value = static_cast<int>(this->dataPtr->contactCache.Misses());
+  else if (_key == "contact_cache_hit_rate")
+    _value = this->dataPtr->contactCache.HitRate();
   else if (_key == "ode_quiet")
     _value = dGetMessageHandler() != 0;
   else if (_key == "world_step_solver")
@@ -21,6 +21,7 @@
 #include <tbb/concurrent_vector.h>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <boost/thread/thread.hpp>
 
@@ -108,6 +109,13 @@ namespace gazebo
       // Documentation inherited
       public: virtual void Reset();
 
+      // Documentation inherited
+      public: virtual bool SaveSnapshot(std::vector<uint8_t> &_state);
+
+      // Documentation inherited
+      public: virtual bool RestoreSnapshot(
+                  const std::vector<uint8_t> &_state);
+
       // Documentation inherited
       public: virtual void InitForThread();
 
@@ -271,12 +279,15 @@ namespace gazebo
       public: static World_Solver_Type
               ConvertWorldStepSolverType(const std::string &_solverType);
 
-      /// \brief Get the step type (quick, world).
+      /// \brief Get the step type (quick, world, parallel_quick).
       /// \return The step type.
       public: virtual std::string GetStepType() const;
 
-      /// \brief Set the step type (quick, world).
-      /// \param[in] _type The step type (quick or world).
+      /// \brief Set the step type (quick, world, parallel_quick).
+      /// parallel_quick is only available when Gazebo was built with
+      /// OpenMP. An unavailable step type logs an error and keeps the
+      /// current one, or falls back to quick while the world loads.
+      /// \param[in] _type The step type (quick, world or parallel_quick).
       public: virtual void SetStepType(const std::string &_type);
 
 
@@ -315,6 +326,24 @@ namespace gazebo
       private: void AddCollider(ODECollision *_collision1,
                                 ODECollision *_collision2);
 
+      /// \brief Load the optional <broadphase> element of <ode>. Its
+      /// children set the physics params of the top-level space:
+      ///   -# <type>: "broadphase" (string), one of "hash" (default),
+      ///      "auto", "simple", "sap", "quadtree" and "bvh". "auto" is a
+      ///      hash space that chooses its levels from the sizes of the
+      ///      models whenever models are added or removed.
+      ///   -# <hash><min_level>, <hash><max_level>:
+      ///      "broadphase_hash_levels" (ignition::math::Vector2i).
+      ///   -# <sap><axes>: "broadphase_sap_axes" (string), e.g. "xyz".
+      ///   -# <quadtree><center>, <quadtree><extents>, <quadtree><depth>:
+      ///      "broadphase_quadtree_center", "broadphase_quadtree_extents"
+      ///      (ignition::math::Vector3d) and "broadphase_quadtree_depth"
+      ///      (int).
+      ///   -# <bvh><margin>: "broadphase_bvh_margin" (double), how far
+      ///      a geom moves before the bvh space reinserts it.
+      /// \param[in] _sdf The <broadphase> element.
+      private: void LoadBroadphase(sdf::ElementPtr _sdf);
+
       /// \internal
       /// \brief Private data pointer.
       private: ODEPhysicsPrivate *dataPtr;
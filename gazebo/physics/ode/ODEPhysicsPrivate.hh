@@ -23,7 +23,11 @@
 #include <vector>
 #include <utility>
 
+#include <ignition/math/Vector2.hh>
+#include <ignition/math/Vector3.hh>
+
 #include "gazebo/physics/Contact.hh"
+#include "gazebo/physics/ode/ODEContactCache.hh"
 #include "gazebo/physics/ode/ODETypes.hh"
 
 namespace gazebo
@@ -33,11 +37,21 @@ namespace gazebo
     /// \brief Data structure for contact feedbacks
     class ODEJointFeedback
     {
-      public: ODEJointFeedback() : contact(nullptr), count(0) {}
+      public: ODEJointFeedback() : contact(nullptr), contactIndex(0),
+                                   link1(nullptr), link2(nullptr), count(0) {}
 
       /// \brief Contact information.
       public: Contact *contact;
 
+      /// \brief Index of the contact in the contact manager.
+      public: unsigned int contactIndex;
+
+      /// \brief Link of the first collision of the contact.
+      public: const Link *link1;
+
+      /// \brief Link of the second collision of the contact.
+      public: const Link *link2;
+
       /// \brief Number of elements in feedbacks array.
       public: int count;
 
@@ -92,6 +106,36 @@ namespace gazebo
 
       /// \brief Maximum number of contact points per collision pair.
       public: unsigned int maxContacts;
+
+      /// \brief Broadphase of the top-level space: "hash", "auto",
+      /// "simple", "sap", "quadtree" or "bvh".
+      public: std::string broadphase;
+
+      /// \brief Smallest and largest cell levels of the hash space, a
+      /// level l cell is 2^l meters wide.
+      public: ignition::math::Vector2i hashLevels;
+
+      /// \brief Sort axes of the sweep and prune space, e.g. "xyz".
+      public: std::string sapAxes;
+
+      /// \brief Center of the quadtree space.
+      public: ignition::math::Vector3d quadtreeCenter;
+
+      /// \brief Extents of the quadtree space.
+      public: ignition::math::Vector3d quadtreeExtents;
+
+      /// \brief Depth of the quadtree space.
+      public: int quadtreeDepth;
+
+      /// \brief Margin added to the geom AABBs in the bvh space.
+      public: double bvhMargin;
+
+      /// \brief Contacts of the previous steps by pair of geoms.
+      public: ODEContactCache contactCache;
+
+      /// \brief Number of top-level geoms when the "auto" broadphase last
+      /// chose its hash levels, -1 to choose them at the next collision.
+      public: int autoGeomCount;
     };
   }
 }
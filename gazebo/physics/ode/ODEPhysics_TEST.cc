@@ -17,12 +17,27 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gazebo/gazebo_config.h"
 #include "gazebo/physics/physics.hh"
 #include "gazebo/physics/PhysicsEngine.hh"
 #include "gazebo/physics/ode/ODEPhysics.hh"
 #include "gazebo/physics/ode/ODETypes.hh"
 #include "gazebo/test/ServerFixture.hh"
 
+#ifdef HAVE_PARALLEL_QUICKSTEP
+#include <parallel_quickstep/parallel_quickstep.h>
+#endif
+
 using namespace gazebo;
 using namespace physics;
 
@@ -66,6 +81,7 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
   double contactSorScale = 1.0;
   bool threadPositionCorrection = true;
   bool experimentalRowReordering = true;
+  int rowColoringThreads = 4;
   double warmStartFactor = 1.0;
   int extraFrictionIterations = 15;
 
@@ -88,6 +104,8 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
                                     threadPositionCorrection));
   EXPECT_TRUE(odePhysics->SetParam("experimental_row_reordering",
                                     experimentalRowReordering));
+  EXPECT_TRUE(odePhysics->SetParam("row_coloring_threads",
+                                    rowColoringThreads));
   EXPECT_TRUE(odePhysics->SetParam("warm_start_factor",
                                     warmStartFactor));
   EXPECT_TRUE(odePhysics->SetParam("extra_friction_iterations",
@@ -130,6 +148,9 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
   value = odePhysics->GetParam("experimental_row_reordering");
   bool experimentalRowReorderingRet = boost::any_cast<bool>(value);
   EXPECT_EQ(experimentalRowReordering, experimentalRowReorderingRet);
+  value = odePhysics->GetParam("row_coloring_threads");
+  int rowColoringThreadsRet = boost::any_cast<int>(value);
+  EXPECT_EQ(rowColoringThreads, rowColoringThreadsRet);
   value = odePhysics->GetParam("warm_start_factor");
   double warmStartFactorRet = boost::any_cast<double>(value);
   EXPECT_DOUBLE_EQ(warmStartFactor, warmStartFactorRet);
@@ -162,6 +183,7 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
   contactSorScale = 0.9;
   threadPositionCorrection = false;
   experimentalRowReordering = false;
+  rowColoringThreads = 0;
   warmStartFactor = 0.9;
   extraFrictionIterations = 14;
 
@@ -183,6 +205,8 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
                                     threadPositionCorrection));
   EXPECT_TRUE(odePhysics->SetParam("experimental_row_reordering",
                                     experimentalRowReordering));
+  EXPECT_TRUE(odePhysics->SetParam("row_coloring_threads",
+                                    rowColoringThreads));
   EXPECT_TRUE(odePhysics->SetParam("warm_start_factor",
                                     warmStartFactor));
   EXPECT_TRUE(odePhysics->SetParam("extra_friction_iterations",
@@ -224,6 +248,9 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
   value = odePhysics->GetParam("experimental_row_reordering");
   experimentalRowReorderingRet = boost::any_cast<bool>(value);
   EXPECT_EQ(experimentalRowReordering, experimentalRowReorderingRet);
+  value = odePhysics->GetParam("row_coloring_threads");
+  rowColoringThreadsRet = boost::any_cast<int>(value);
+  EXPECT_EQ(rowColoringThreads, rowColoringThreadsRet);
   value = odePhysics->GetParam("warm_start_factor");
   warmStartFactorRet = boost::any_cast<double>(value);
   EXPECT_DOUBLE_EQ(warmStartFactor, warmStartFactorRet);
@@ -372,6 +399,524 @@ TEST_F(ODEPhysics_TEST, PhysicsParam)
       odePhysics->GetParam("world_step_solver")));
     EXPECT_EQ(param, worldSolverType);
   }
+
+  // Test broadphase params
+  {
+    // A hash space with levels -2 to 8 by default
+    std::string broadphase;
+    EXPECT_NO_THROW(broadphase = boost::any_cast<std::string>(
+      odePhysics->GetParam("broadphase")));
+    EXPECT_EQ(broadphase, "hash");
+    EXPECT_EQ(dSpaceGetClass(odePhysics->GetSpaceId()), dHashSpaceClass);
+    ignition::math::Vector2i levels;
+    EXPECT_NO_THROW(levels = boost::any_cast<ignition::math::Vector2i>(
+      odePhysics->GetParam("broadphase_hash_levels")));
+    EXPECT_EQ(levels, ignition::math::Vector2i(-2, 8));
+
+    EXPECT_TRUE(odePhysics->SetParam("broadphase_hash_levels",
+        ignition::math::Vector2i(-4, 6)));
+    EXPECT_EQ(boost::any_cast<ignition::math::Vector2i>(
+      odePhysics->GetParam("broadphase_hash_levels")),
+      ignition::math::Vector2i(-4, 6));
+    EXPECT_FALSE(odePhysics->SetParam("broadphase_hash_levels",
+        ignition::math::Vector2i(3, 2)));
+
+    EXPECT_TRUE(odePhysics->SetParam("broadphase_sap_axes",
+        std::string("zxy")));
+    EXPECT_EQ(boost::any_cast<std::string>(
+      odePhysics->GetParam("broadphase_sap_axes")), "zxy");
+    EXPECT_FALSE(odePhysics->SetParam("broadphase_sap_axes",
+        std::string("xxy")));
+
+    EXPECT_TRUE(odePhysics->SetParam("broadphase_quadtree_depth", 4));
+    EXPECT_EQ(boost::any_cast<int>(
+      odePhysics->GetParam("broadphase_quadtree_depth")), 4);
+    EXPECT_TRUE(odePhysics->SetParam("broadphase_quadtree_extents",
+        ignition::math::Vector3d(20, 20, 5)));
+    EXPECT_EQ(boost::any_cast<ignition::math::Vector3d>(
+      odePhysics->GetParam("broadphase_quadtree_extents")),
+      ignition::math::Vector3d(20, 20, 5));
+
+    EXPECT_TRUE(odePhysics->SetParam("broadphase_bvh_margin", 0.1));
+    EXPECT_DOUBLE_EQ(boost::any_cast<double>(
+      odePhysics->GetParam("broadphase_bvh_margin")), 0.1);
+    EXPECT_FALSE(odePhysics->SetParam("broadphase_bvh_margin", -1.0));
+
+    // Each type creates its space, and keeps the geoms of the old one
+    const int geomCount = dSpaceGetNumGeoms(odePhysics->GetSpaceId());
+    const std::map<std::string, int> classes = {
+        {"simple", dSimpleSpaceClass}, {"sap", dSweepAndPruneSpaceClass},
+        {"quadtree", dQuadTreeSpaceClass}, {"bvh", dBVHSpaceClass},
+        {"auto", dHashSpaceClass}, {"hash", dHashSpaceClass}};
+    for (auto const &type : classes)
+    {
+      EXPECT_TRUE(odePhysics->SetParam("broadphase", type.first));
+      EXPECT_EQ(boost::any_cast<std::string>(
+        odePhysics->GetParam("broadphase")), type.first);
+      EXPECT_EQ(dSpaceGetClass(odePhysics->GetSpaceId()), type.second);
+      EXPECT_EQ(dSpaceGetNumGeoms(odePhysics->GetSpaceId()), geomCount);
+    }
+    EXPECT_FALSE(odePhysics->SetParam("broadphase", std::string("octree")));
+    EXPECT_EQ(boost::any_cast<std::string>(
+      odePhysics->GetParam("broadphase")), "hash");
+  }
+
+  // Test contact cache params
+  {
+    EXPECT_FALSE(boost::any_cast<bool>(
+      odePhysics->GetParam("contact_cache")));
+    EXPECT_TRUE(odePhysics->SetParam("contact_cache", true));
+    EXPECT_TRUE(boost::any_cast<bool>(
+      odePhysics->GetParam("contact_cache")));
+
+    EXPECT_TRUE(odePhysics->SetParam("contact_cache_linear_tolerance",
+        2e-4));
+    EXPECT_DOUBLE_EQ(boost::any_cast<double>(
+      odePhysics->GetParam("contact_cache_linear_tolerance")), 2e-4);
+    EXPECT_FALSE(odePhysics->SetParam("contact_cache_linear_tolerance",
+        -1.0));
+    EXPECT_TRUE(odePhysics->SetParam("contact_cache_angular_tolerance",
+        2e-3));
+    EXPECT_DOUBLE_EQ(boost::any_cast<double>(
+      odePhysics->GetParam("contact_cache_angular_tolerance")), 2e-3);
+    EXPECT_FALSE(odePhysics->SetParam("contact_cache_angular_tolerance",
+        -1.0));
+
+    EXPECT_EQ(boost::any_cast<int>(
+      odePhysics->GetParam("contact_cache_hits")), 0);
+    EXPECT_EQ(boost::any_cast<int>(
+      odePhysics->GetParam("contact_cache_misses")), 0);
+    EXPECT_DOUBLE_EQ(boost::any_cast<double>(
+      odePhysics->GetParam("contact_cache_hit_rate")), 0.0);
+    EXPECT_TRUE(odePhysics->SetParam("contact_cache", false));
+  }
+}
+
+/////////////////////////////////////////////////
+/// Test that a resting box reuses its cached contacts
+TEST_F(ODEPhysics_TEST, ContactCache)
+{
+  Load("worlds/empty.world", true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  ODEPhysicsPtr odePhysics =
+      boost::dynamic_pointer_cast<ODEPhysics>(world->Physics());
+  ASSERT_TRUE(odePhysics != nullptr);
+
+  SpawnBox("box", ignition::math::Vector3d::One,
+      ignition::math::Vector3d(0, 0, 0.6));
+  ModelPtr model = world->ModelByName("box");
+  ASSERT_TRUE(model != nullptr);
+
+  // Let the box settle before caching its contacts
+  world->Step(1000);
+  EXPECT_TRUE(odePhysics->SetParam("contact_cache", true));
+  world->Step(1000);
+
+  EXPECT_NEAR(model->WorldPose().Pos().Z(), 0.5, 0.01);
+  EXPECT_GT(boost::any_cast<double>(
+    odePhysics->GetParam("contact_cache_hit_rate")), 0.5);
+  EXPECT_EQ(boost::any_cast<int>(
+    odePhysics->GetParam("contact_cache_hits")) +
+    boost::any_cast<int>(odePhysics->GetParam("contact_cache_misses")), 1);
+
+  // Pushing the box invalidates its contacts, which are then rebuilt
+  model->SetLinearVel(ignition::math::Vector3d(1, 0, 0));
+  world->Step(1);
+  EXPECT_EQ(boost::any_cast<int>(
+    odePhysics->GetParam("contact_cache_misses")), 1);
+  world->Step(1000);
+  EXPECT_NEAR(model->WorldPose().Pos().Z(), 0.5, 0.01);
+  EXPECT_GT(model->WorldPose().Pos().X(), 0.0);
+}
+
+/////////////////////////////////////////////////
+/// Test the parallel_quick step type, or its fallback in builds without it
+TEST_F(ODEPhysics_TEST, ParallelQuickStep)
+{
+  // The world asks for parallel_quick
+  Load("test/worlds/parallel_quickstep.world", true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  ODEPhysicsPtr odePhysics =
+      boost::dynamic_pointer_cast<ODEPhysics>(world->Physics());
+  ASSERT_TRUE(odePhysics != nullptr);
+  ModelPtr model = world->ModelByName("box");
+  ASSERT_TRUE(model != nullptr);
+
+#ifdef HAVE_PARALLEL_QUICKSTEP
+  const std::string expected = "parallel_quick";
+  EXPECT_TRUE(odePhysics->SetParam("solver_type", std::string("quick")));
+  EXPECT_EQ(odePhysics->GetStepType(), "quick");
+  EXPECT_TRUE(odePhysics->SetParam("solver_type", expected));
+#else
+  // The world loaded with quick, and parallel_quick is refused
+  const std::string expected = "quick";
+  EXPECT_EQ(odePhysics->GetStepType(), expected);
+  EXPECT_FALSE(odePhysics->SetParam("solver_type",
+      std::string("parallel_quick")));
+#endif
+  EXPECT_EQ(odePhysics->GetStepType(), expected);
+  EXPECT_EQ(boost::any_cast<std::string>(
+      odePhysics->GetParam("solver_type")), expected);
+
+  // Unknown step types are refused and the current one is kept
+  EXPECT_FALSE(odePhysics->SetParam("solver_type", std::string("unknown")));
+  EXPECT_EQ(odePhysics->GetStepType(), expected);
+
+  world->Step(1000);
+  EXPECT_NEAR(model->WorldPose().Pos().Z(), 0.5, 0.01);
+}
+
+#ifdef HAVE_PARALLEL_QUICKSTEP
+/////////////////////////////////////////////////
+/// \brief Step a hanging chain of 40 bodies with parallel_quick.
+/// \param[in] _seed Random seed of the world.
+/// \return Positions of the bodies after 500 steps.
+static std::vector<dReal> StepParallelChain(const unsigned long _seed)
+{
+  dAllocateODEDataForThread(dAllocateMaskAll);
+  dWorldID world = dWorldCreate();
+  dWorldSetGravity(world, 0, 0, -9.8);
+  dWorldSetQuickStepNumIterations(world, 30);
+  dWorldSetRandSeed(world, _seed);
+
+  std::vector<dBodyID> bodies;
+  dBodyID previous = nullptr;
+  for (int i = 0; i < 40; ++i)
+  {
+    dBodyID body = dBodyCreate(world);
+    dMass mass;
+    dMassSetBox(&mass, 1, 0.1, 0.1, 0.1);
+    dBodySetMass(body, &mass);
+    dBodySetPosition(body, 0.1 * (i + 1), 0.01 * i, 0);
+    dJointID joint = dJointCreateBall(world, nullptr);
+    dJointAttach(joint, body, previous);
+    dJointSetBallAnchor(joint, 0.1 * i, 0.01 * i, 0);
+    bodies.push_back(body);
+    previous = body;
+  }
+
+  for (int i = 0; i < 500; ++i)
+    dWorldParallelQuickStep(world, 0.001);
+
+  std::vector<dReal> positions;
+  for (auto body : bodies)
+  {
+    const dReal *pos = dBodyGetPosition(body);
+    positions.insert(positions.end(), pos, pos + 3);
+  }
+  dWorldDestroy(world);
+  return positions;
+}
+
+/////////////////////////////////////////////////
+/// Test that worlds stepped with parallel_quick from several threads, as
+/// with gzserver --worlds, give the same results as stepped alone. The
+/// solver buffers are per thread and the batch order is drawn from the
+/// seed of each world.
+TEST_F(ODEPhysics_TEST, ParallelQuickStepThreads)
+{
+  dInitODE2(0);
+  const std::vector<dReal> alone = StepParallelChain(1);
+  EXPECT_EQ(StepParallelChain(1), alone);
+
+  std::vector<dReal> first, second;
+  std::thread firstThread([&first] { first = StepParallelChain(1); });
+  std::thread secondThread([&second] { second = StepParallelChain(2); });
+  firstThread.join();
+  secondThread.join();
+  EXPECT_EQ(first, alone);
+  EXPECT_NE(second, alone);
+  dCloseODE();
+}
+#endif
+
+/////////////////////////////////////////////////
+/// Test that boxes dropped on the ground rest on it with each broadphase
+TEST_F(ODEPhysics_TEST, Broadphase)
+{
+  Load("worlds/empty.world", true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  ODEPhysicsPtr odePhysics =
+      boost::dynamic_pointer_cast<ODEPhysics>(world->Physics());
+  ASSERT_TRUE(odePhysics != nullptr);
+
+  const std::vector<std::string> types =
+      {"hash", "auto", "simple", "sap", "quadtree", "bvh"};
+  for (unsigned int i = 0; i < types.size(); ++i)
+  {
+    const std::string name = "box_" + types[i];
+    SpawnBox(name, ignition::math::Vector3d::One,
+        ignition::math::Vector3d(2.0 * i, 0, 2));
+    ModelPtr model = world->ModelByName(name);
+    ASSERT_TRUE(model != nullptr);
+
+    // Switch with models in the space
+    EXPECT_TRUE(odePhysics->SetParam("broadphase", types[i]));
+    world->Step(1000);
+
+    for (unsigned int j = 0; j <= i; ++j)
+    {
+      model = world->ModelByName("box_" + types[j]);
+      ASSERT_TRUE(model != nullptr);
+      EXPECT_NEAR(model->WorldPose().Pos().Z(), 0.5, 0.01)
+          << types[j] << " with broadphase " << types[i];
+    }
+  }
+
+  // The auto broadphase sized its levels for the 1 m boxes, the ground
+  // plane is infinite
+  EXPECT_TRUE(odePhysics->SetParam("broadphase", std::string("auto")));
+  world->Step(1);
+  ignition::math::Vector2i levels;
+  EXPECT_NO_THROW(levels = boost::any_cast<ignition::math::Vector2i>(
+    odePhysics->GetParam("broadphase_hash_levels")));
+  EXPECT_EQ(levels.X(), levels.Y());
+  EXPECT_GE(levels.X(), 0);
+  EXPECT_LE(levels.Y(), 1);
+}
+
+/////////////////////////////////////////////////
+/// \brief Pairs reported by a broadphase, each stored with the lower
+/// geom first.
+typedef std::set<std::pair<dGeomID, dGeomID>> GeomPairs;
+
+/////////////////////////////////////////////////
+/// \brief Broadphase callback that stores the pairs.
+/// \param[in] _data The GeomPairs.
+/// \param[in] _o1 First geom.
+/// \param[in] _o2 Second geom.
+static void StorePair(void *_data, dGeomID _o1, dGeomID _o2)
+{
+  GeomPairs *pairs = static_cast<GeomPairs *>(_data);
+  pairs->insert(std::make_pair(std::min(_o1, _o2), std::max(_o1, _o2)));
+}
+
+/////////////////////////////////////////////////
+/// \brief Pairs of a space whose AABBs overlap, which is what every
+/// broadphase must report at least.
+/// \param[in] _space The space.
+/// \return The pairs.
+static GeomPairs OverlappingPairs(dSpaceID _space)
+{
+  GeomPairs pairs;
+  dSpaceCollide(_space, &pairs, &StorePair);
+
+  GeomPairs result;
+  for (auto const &pair : pairs)
+  {
+    dReal a[6], b[6];
+    dGeomGetAABB(pair.first, a);
+    dGeomGetAABB(pair.second, b);
+    if (a[0] <= b[1] && b[0] <= a[1] && a[2] <= b[3] && b[2] <= a[3] &&
+        a[4] <= b[5] && b[4] <= a[5])
+    {
+      result.insert(pair);
+    }
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////
+/// Test that the bvh broadphase finds the same overlapping pairs as the
+/// simple space while geoms move, including geoms moved from several
+/// threads at once as the island threads do
+TEST_F(ODEPhysics_TEST, BroadphaseMovingGeoms)
+{
+  dInitODE2(0);
+  dSpaceID bvh = dBVHSpaceCreate(0);
+  dSpaceID simple = dSimpleSpaceCreate(0);
+
+  const unsigned int count = 200;
+  std::vector<dGeomID> bvhGeoms;
+  std::vector<dGeomID> simpleGeoms;
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    const dReal size = 0.2 + 0.1 * (i % 5);
+    bvhGeoms.push_back(dCreateBox(bvh, size, size, size));
+    simpleGeoms.push_back(dCreateBox(simple, size, size, size));
+  }
+
+  // Geoms with the same index have the same pose in both spaces
+  auto move = [&](const unsigned int _begin, const unsigned int _end,
+      const unsigned int _step)
+  {
+    for (unsigned int i = _begin; i < _end; ++i)
+    {
+      const double t = 0.05 * _step + i;
+      const dReal x = 5.0 * std::sin(0.7 * t);
+      const dReal y = 5.0 * std::cos(1.3 * t);
+      const dReal z = 2.0 * std::sin(0.3 * t + i);
+      dGeomSetPosition(bvhGeoms[i], x, y, z);
+      dGeomSetPosition(simpleGeoms[i], x, y, z);
+    }
+  };
+
+  // The simple space pairs are indexed by the bvh geoms
+  std::map<dGeomID, dGeomID> toBvh;
+  for (unsigned int i = 0; i < count; ++i)
+    toBvh[simpleGeoms[i]] = bvhGeoms[i];
+
+  const unsigned int threads = 4;
+  for (unsigned int step = 0; step < 100; ++step)
+  {
+    if (step % 2 == 0)
+    {
+      move(0, count, step);
+    }
+    else
+    {
+      std::vector<std::thread> workers;
+      for (unsigned int t = 0; t < threads; ++t)
+      {
+        workers.emplace_back(move, t * count / threads,
+            (t + 1) * count / threads, step);
+      }
+      for (auto &worker : workers)
+        worker.join();
+    }
+
+    GeomPairs expected;
+    for (auto const &pair : OverlappingPairs(simple))
+    {
+      const dGeomID o1 = toBvh[pair.first];
+      const dGeomID o2 = toBvh[pair.second];
+      expected.insert(std::make_pair(std::min(o1, o2), std::max(o1, o2)));
+    }
+    EXPECT_EQ(OverlappingPairs(bvh), expected) << "step " << step;
+  }
+  EXPECT_FALSE(OverlappingPairs(bvh).empty());
+
+  dSpaceDestroy(bvh);
+  dSpaceDestroy(simple);
+  dCloseODE();
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the world position of every dynamic link.
+/// \param[in] _world The world.
+/// \return Positions.
+static std::vector<ignition::math::Vector3d> LinkPositions(WorldPtr _world)
+{
+  std::vector<ignition::math::Vector3d> positions;
+  for (auto const &model : _world->Models())
+  {
+    if (model->IsStatic())
+      continue;
+    for (auto const &link : model->GetLinks())
+      positions.push_back(link->WorldPose().Pos());
+  }
+  return positions;
+}
+
+/////////////////////////////////////////////////
+/// Test that stacks of boxes settle in the same place with the sequential
+/// PGS sweep and the graph colored sweep, whatever its number of threads
+TEST_F(ODEPhysics_TEST, RowColoring)
+{
+  Load("worlds/stacks.world", true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  ODEPhysicsPtr odePhysics =
+      boost::dynamic_pointer_cast<ODEPhysics>(world->Physics());
+  ASSERT_TRUE(odePhysics != nullptr);
+  EXPECT_TRUE(odePhysics->SetParam("solver_type", std::string("quick")));
+
+  WorldSnapshotPtr snapshot = world->Snapshot();
+  ASSERT_TRUE(snapshot != nullptr);
+
+  // 0 is the sequential sweep
+  std::vector<std::vector<ignition::math::Vector3d>> positions;
+  for (const int threads : {0, 1, 4})
+  {
+    ASSERT_TRUE(world->Restore(snapshot));
+    EXPECT_TRUE(odePhysics->SetParam("row_coloring_threads", threads));
+    EXPECT_EQ(boost::any_cast<int>(
+        odePhysics->GetParam("row_coloring_threads")), threads);
+
+    world->Step(1000);
+    positions.push_back(LinkPositions(world));
+    ASSERT_EQ(positions.back().size(), positions.front().size());
+  }
+  ASSERT_FALSE(positions[0].empty());
+
+  for (unsigned int i = 0; i < positions[0].size(); ++i)
+  {
+    // Nothing falls through the ground
+    EXPECT_TRUE(positions[1][i].IsFinite());
+    EXPECT_GT(positions[1][i].Z(), 0.0);
+
+    // Rows of a color do not share bodies, so the thread count does not
+    // change the result
+    EXPECT_DOUBLE_EQ(positions[1][i].X(), positions[2][i].X());
+    EXPECT_DOUBLE_EQ(positions[1][i].Y(), positions[2][i].Y());
+    EXPECT_DOUBLE_EQ(positions[1][i].Z(), positions[2][i].Z());
+
+    EXPECT_LT(positions[0][i].Distance(positions[1][i]), 0.01);
+  }
+}
+
+/////////////////////////////////////////////////
+/// Test the contact wrenches of a step with more contacts than a task of
+/// the parallel conversion holds
+TEST_F(ODEPhysics_TEST, ContactWrenches)
+{
+  Load("worlds/empty.world", true, "ode");
+  WorldPtr world = get_world("default");
+  ASSERT_TRUE(world != nullptr);
+
+  // A model with a 10 x 10 grid of boxes, each touching the ground
+  const unsigned int side = 10;
+  std::ostringstream sdf;
+  sdf << "<sdf version='1.6'><model name='grid'>";
+  for (unsigned int i = 0; i < side * side; ++i)
+  {
+    sdf << "<link name='link_" << i << "'>"
+        << "<pose>" << (i % side) * 2.0 << " " << (i / side) * 2.0
+        << " 0.5 0 0 0</pose>"
+        << "<inertial><mass>1</mass></inertial>"
+        << "<collision name='collision'>"
+        << "<geometry><box><size>1 1 1</size></box></geometry>"
+        << "</collision></link>";
+  }
+  sdf << "</model></sdf>";
+  SpawnSDF(sdf.str());
+  ModelPtr model = world->ModelByName("grid");
+  ASSERT_TRUE(model != nullptr);
+
+  ContactManager *manager = world->Physics()->GetContactManager();
+  ASSERT_TRUE(manager != nullptr);
+  manager->SetNeverDropContacts(true);
+
+  // Let the boxes settle
+  world->Step(500);
+  ASSERT_EQ(manager->GetContactCount(), side * side);
+
+  // The buffer holds the wrenches of every contact, and the ground holds
+  // the weight of each box
+  const ContactWrenchBuffer &wrenches = manager->Wrenches();
+  ASSERT_EQ(wrenches.ContactCount(), manager->GetContactCount());
+  const double gravity = world->Gravity().Length();
+  for (unsigned int i = 0; i < manager->GetContactCount(); ++i)
+  {
+    Contact *contact = manager->GetContact(i);
+    double force = 0;
+    for (int j = 0; j < contact->count; ++j)
+    {
+      const JointWrench wrench = wrenches.Wrench(wrenches.Offset(i) + j);
+      EXPECT_EQ(wrench.body1Force, contact->wrench[j].body1Force);
+      EXPECT_EQ(wrench.body2Force, contact->wrench[j].body2Force);
+      force += contact->collision1->GetModel() == model ?
+          wrench.body1Force.Z() : wrench.body2Force.Z();
+    }
+    EXPECT_NEAR(force, gravity, 0.1 * gravity);
+  }
 }
 
 /////////////////////////////////////////////////
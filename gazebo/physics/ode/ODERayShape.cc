@@ -19,6 +19,15 @@
  * Date: 14 Oct 2009
  */
 
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <ignition/math/Helpers.hh>
+
 #include "gazebo/common/Assert.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/physics/Link.hh"
@@ -30,6 +39,122 @@
 using namespace gazebo;
 using namespace physics;
 
+namespace
+{
+  /// \brief Depth reported when a ray hits nothing, see
+  /// ODERayShape::GetIntersection.
+  const double noHitDepth = 1000;
+
+  /// \brief Number of segments tested by a task of a batch.
+  const size_t segmentsPerTask = 64;
+
+  /// \brief A geom tested by the segments of a batch.
+  struct Candidate
+  {
+    /// \brief The geom.
+    dGeomID geom;
+
+    /// \brief Collision of the geom.
+    ODECollision *collision;
+
+    /// \brief Bounding box of the geom, as returned by dGeomGetAABB.
+    dReal aabb[6];
+  };
+
+  /// \brief Check whether a segment intersects a bounding box.
+  /// \param[in] _aabb Box, as returned by dGeomGetAABB.
+  /// \param[in] _start Start of the segment.
+  /// \param[in] _end End of the segment.
+  /// \return True if they intersect.
+  bool SegmentHitsBox(const dReal *_aabb,
+      const ignition::math::Vector3d &_start,
+      const ignition::math::Vector3d &_end)
+  {
+    double tMin = 0;
+    double tMax = 1;
+    for (int i = 0; i < 3; ++i)
+    {
+      const double d = _end[i] - _start[i];
+      const double lo = _aabb[i * 2];
+      const double hi = _aabb[i * 2 + 1];
+      if (std::abs(d) < 1e-12)
+      {
+        if (_start[i] < lo || _start[i] > hi)
+          return false;
+        continue;
+      }
+
+      double t1 = (lo - _start[i]) / d;
+      double t2 = (hi - _start[i]) / d;
+      if (t1 > t2)
+        std::swap(t1, t2);
+      tMin = std::max(tMin, t1);
+      tMax = std::min(tMax, t2);
+      if (tMin > tMax)
+        return false;
+    }
+    return true;
+  }
+
+  /// \brief Gather the geoms of a space a ray collides with, the way
+  /// dSpaceCollide2 would visit them. Their bounding boxes are updated, so
+  /// the geoms are only read while the segments are tested.
+  /// \param[in] _space Space to gather.
+  /// \param[in] _ray The ray.
+  /// \param[out] _candidates The geoms.
+  /// \param[out] _serial Set to true if a geom is not safe to collide
+  /// from several threads.
+  void Gather(dSpaceID _space, dGeomID _ray,
+      std::vector<Candidate> &_candidates, bool &_serial)
+  {
+    const int count = dSpaceGetNumGeoms(_space);
+    for (int i = 0; i < count; ++i)
+    {
+      dGeomID geom = dSpaceGetGeom(_space, i);
+      if (!dGeomIsEnabled(geom))
+        continue;
+
+      if (!(dGeomGetCategoryBits(_ray) & dGeomGetCollideBits(geom)) &&
+          !(dGeomGetCategoryBits(geom) & dGeomGetCollideBits(_ray)))
+      {
+        continue;
+      }
+
+      if (dGeomIsSpace(geom))
+      {
+        Gather(reinterpret_cast<dSpaceID>(geom), _ray, _candidates, _serial);
+        continue;
+      }
+
+      const int geomClass = dGeomGetClass(geom);
+      if (geomClass == dRayClass)
+        continue;
+
+      Candidate candidate;
+      candidate.geom = geom;
+      if (geomClass == dGeomTransformClass)
+      {
+        candidate.collision = static_cast<ODECollision*>(
+            dGeomGetData(dGeomTransformGetGeom(geom)));
+      }
+      else
+      {
+        candidate.collision = static_cast<ODECollision*>(dGeomGetData(geom));
+      }
+      if (!candidate.collision)
+        continue;
+
+      dGeomGetAABB(geom, candidate.aabb);
+      _candidates.push_back(candidate);
+
+      // Heightfields collide through buffers stored in the geom, and
+      // transforms update their child geom
+      if (geomClass == dHeightfieldClass || geomClass == dGeomTransformClass)
+        _serial = true;
+    }
+  }
+}
+
 //////////////////////////////////////////////////
 ODERayShape::ODERayShape(PhysicsEnginePtr _physicsEngine)
   : RayShape(_physicsEngine)
@@ -145,6 +270,110 @@ void ODERayShape::GetIntersection(double &_dist, std::string &_entity)
   }
 }
 
+//////////////////////////////////////////////////
+void ODERayShape::Intersections(
+    const std::vector<ignition::math::Vector3d> &_starts,
+    const std::vector<ignition::math::Vector3d> &_ends,
+    std::vector<double> &_dists, std::vector<std::string> &_entities)
+{
+  const size_t count = std::min(_starts.size(), _ends.size());
+  _dists.assign(count, noHitDepth);
+  _entities.assign(count, std::string());
+  if (count == 0 || !this->physicsEngine)
+    return;
+
+  boost::recursive_mutex::scoped_lock lock(
+      *this->physicsEngine->GetPhysicsUpdateMutex());
+
+  std::vector<Candidate> candidates;
+  bool serial = false;
+  Gather(this->physicsEngine->GetSpaceId(), this->geomId, candidates,
+      serial);
+
+  std::vector<ODECollision *> hits(count, nullptr);
+
+  auto testSegments = [&](const tbb::blocked_range<size_t> &_r)
+  {
+    // Each thread needs its own ODE collider caches and ray
+    dAllocateODEDataForThread(dAllocateMaskAll);
+    dGeomID ray = dCreateRay(0, 1.0);
+    dGeomSetCategoryBits(ray, dGeomGetCategoryBits(this->geomId));
+    dGeomSetCollideBits(ray, dGeomGetCollideBits(this->geomId));
+    dGeomRaySetParams(ray, 0, 0);
+    dGeomRaySetClosestHit(ray, 1);
+
+    // Keep the geoms near the segments of this task
+    ignition::math::Vector3d min(ignition::math::MAX_D,
+        ignition::math::MAX_D, ignition::math::MAX_D);
+    ignition::math::Vector3d max(-ignition::math::MAX_D,
+        -ignition::math::MAX_D, -ignition::math::MAX_D);
+    for (size_t i = _r.begin(); i != _r.end(); ++i)
+    {
+      min.Min(_starts[i]);
+      min.Min(_ends[i]);
+      max.Max(_starts[i]);
+      max.Max(_ends[i]);
+    }
+
+    std::vector<const Candidate *> near;
+    for (const Candidate &candidate : candidates)
+    {
+      const dReal *aabb = candidate.aabb;
+      if (aabb[0] <= max.X() && aabb[1] >= min.X() &&
+          aabb[2] <= max.Y() && aabb[3] >= min.Y() &&
+          aabb[4] <= max.Z() && aabb[5] >= min.Z())
+      {
+        near.push_back(&candidate);
+      }
+    }
+
+    dContactGeom contact;
+    for (size_t i = _r.begin(); i != _r.end(); ++i)
+    {
+      ignition::math::Vector3d dir = _ends[i] - _starts[i];
+      const double length = dir.Length();
+      if (ignition::math::equal(length, 0.0))
+        continue;
+      dir /= length;
+
+      dGeomRaySet(ray, _starts[i].X(), _starts[i].Y(), _starts[i].Z(),
+          dir.X(), dir.Y(), dir.Z());
+      dGeomRaySetLength(ray, length);
+
+      for (const Candidate *candidate : near)
+      {
+        if (!SegmentHitsBox(candidate->aabb, _starts[i], _ends[i]))
+          continue;
+
+        if (dCollide(ray, candidate->geom, 1, &contact,
+              sizeof(contact)) > 0 && contact.depth < _dists[i])
+        {
+          _dists[i] = contact.depth;
+          hits[i] = candidate->collision;
+        }
+      }
+    }
+
+    dGeomDestroy(ray);
+  };
+
+  if (serial)
+  {
+    testSegments(tbb::blocked_range<size_t>(0, count));
+  }
+  else
+  {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, count, segmentsPerTask),
+        testSegments);
+  }
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (hits[i])
+      _entities[i] = hits[i]->GetScopedName();
+  }
+}
+
 //////////////////////////////////////////////////
 void ODERayShape::SetPoints(const ignition::math::Vector3d &_posStart,
                             const ignition::math::Vector3d &_posEnd)
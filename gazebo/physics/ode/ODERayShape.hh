@@ -18,6 +18,7 @@
 #define GAZEBO_PHYSICS_ODE_ODERAYSHAPE_HH_
 
 #include <string>
+#include <vector>
 
 #include "gazebo/physics/RayShape.hh"
 #include "gazebo/physics/Shape.hh"
@@ -57,6 +58,23 @@ namespace gazebo
       /// \param[out] _entity Name of the entity that was hit.
       public: virtual void GetIntersection(double &_dist, std::string &_entity);
 
+      /// \brief Get the nearest intersections of many segments at once.
+      /// The collisions of the world are gathered once, then the segments
+      /// are tested against them in parallel, each thread with its own ray.
+      /// Worlds with heightmaps are tested on the calling thread, because
+      /// ODE heightfields are not safe to collide concurrently.
+      /// \param[in] _starts Start of each segment.
+      /// \param[in] _ends End of each segment, one per start.
+      /// \param[out] _dists Distance to the nearest intersection of each
+      /// segment.
+      /// \param[out] _entities Name of the entity each segment intersected
+      /// with, empty if none.
+      public: virtual void Intersections(
+                  const std::vector<ignition::math::Vector3d> &_starts,
+                  const std::vector<ignition::math::Vector3d> &_ends,
+                  std::vector<double> &_dists,
+                  std::vector<std::string> &_entities);
+
       /// \brief Set the ray based on starting and ending points relative to
       ///        the body
       /// \param[in] _posStart Start position, relative the body
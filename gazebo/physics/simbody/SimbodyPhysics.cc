@@ -16,6 +16,7 @@
 */
 
 #include <string>
+#include <vector>
 
 #include <ignition/common/Profiler.hh>
 
@@ -257,6 +258,21 @@ void SimbodyPhysics::Reset()
   this->SetGravity(this->world->Gravity());
 }
 
+//////////////////////////////////////////////////
+bool SimbodyPhysics::SaveSnapshot(std::vector<uint8_t> &/*_state*/)
+{
+  gzerr << "Snapshots are not supported by the simbody physics engine, "
+        << "use WorldState instead\n";
+  return false;
+}
+
+//////////////////////////////////////////////////
+bool SimbodyPhysics::RestoreSnapshot(const std::vector<uint8_t> &/*_state*/)
+{
+  gzerr << "Snapshots are not supported by the simbody physics engine\n";
+  return false;
+}
+
 //////////////////////////////////////////////////
 void SimbodyPhysics::Init()
 {
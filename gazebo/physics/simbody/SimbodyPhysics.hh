@@ -18,6 +18,7 @@
 #ifndef GAZEBO_PHYSICS_SIMBODY_SIMBODYPHYSICS_HH
 #define GAZEBO_PHYSICS_SIMBODY_SIMBODYPHYSICS_HH
 #include <string>
+#include <vector>
 
 #include <boost/thread/thread.hpp>
 #include <boost/thread/mutex.hpp>
@@ -56,6 +57,18 @@ namespace gazebo
       // Documentation inherited
       public: virtual void Reset();
 
+      /// \brief Not supported, logs an error. The integrator owns the
+      /// SimTK::State, which has no serialized form.
+      /// \param[out] _state Unused.
+      /// \return False.
+      public: virtual bool SaveSnapshot(std::vector<uint8_t> &_state);
+
+      /// \brief Not supported, logs an error.
+      /// \param[in] _state Unused.
+      /// \return False.
+      public: virtual bool RestoreSnapshot(
+                  const std::vector<uint8_t> &_state);
+
       /// \brief Add a Model to the Simbody system.
       /// \param[in] _model Pointer to the model to add into Simbody.
       public: void InitModel(const physics::ModelPtr _model);
@@ -45,6 +45,7 @@
 #include "gazebo/rendering/Conversions.hh"
 #include "gazebo/rendering/Scene.hh"
 #include "gazebo/rendering/Distortion.hh"
+#include "gazebo/rendering/FrameWriter.hh"
 #include "gazebo/rendering/CameraPrivate.hh"
 #include "gazebo/rendering/Camera.hh"
 #include "gazebo/rendering/RenderEvents.hh"
@@ -675,10 +676,12 @@ void Camera::PostRender()
       this->dataPtr->videoEncoder.AddFrame(buffer, width, height);
     }
 
+    // Encode and write off the rendering thread
     if (this->sdf->HasElement("save") &&
         this->sdf->GetElement("save")->Get<bool>("enabled"))
     {
-      this->SaveFrame(this->FrameFilename());
+      FrameWriter::Instance()->Write(this->saveFrameBuffer, width, height,
+          this->ImageDepth(), this->ImageFormat(), this->FrameFilename());
     }
 
     // do last minute conversion if Bayer pattern is requested, go from R8G8B8
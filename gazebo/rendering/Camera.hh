@@ -393,7 +393,8 @@ namespace gazebo
       /// \return Far clip distance
       public: double FarClip() const;
 
-      /// \brief Enable or disable saving
+      /// \brief Enable or disable saving. Frames are written in the
+      /// background by FrameWriter.
       /// \param[in] _enable Set to True to enable saving of frames
       public: void EnableSaveFrame(const bool _enable);
 
@@ -0,0 +1,339 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ignition/common/Profiler.hh"
+
+#include "gazebo/common/Console.hh"
+#include "gazebo/rendering/Camera.hh"
+#include "gazebo/rendering/FrameWriter.hh"
+
+using namespace gazebo;
+using namespace rendering;
+
+/// \brief Private data for FrameWriter.
+class gazebo::rendering::FrameWriterPrivate
+{
+  /// \brief A queued frame.
+  public: class Frame
+  {
+    /// \brief Copy of the image.
+    public: std::vector<unsigned char> data;
+
+    /// \brief Image width.
+    public: unsigned int width = 0;
+
+    /// \brief Image height.
+    public: unsigned int height = 0;
+
+    /// \brief Image depth.
+    public: int depth = 0;
+
+    /// \brief Image format.
+    public: std::string format;
+
+    /// \brief File to write.
+    public: std::string filename;
+  };
+
+  /// \brief Worker thread loop.
+  public: void Run();
+
+  /// \brief Return a frame's buffer to the pool.
+  /// \param[in] _frame Frame that is no longer needed.
+  public: void Recycle(Frame &_frame);
+
+  /// \brief Queued frames.
+  public: std::deque<Frame> queue;
+
+  /// \brief Buffers of written frames, reused by Write so frames of the
+  /// same size do not allocate.
+  public: std::vector<std::vector<unsigned char>> pool;
+
+  /// \brief Worker threads.
+  public: std::vector<std::thread> workers;
+
+  /// \brief Number of frames being encoded.
+  public: unsigned int busy = 0;
+
+  /// \brief True while the workers must run.
+  public: bool running = false;
+
+  /// \brief Maximum number of queued frames.
+  public: unsigned int capacity = 64;
+
+  /// \brief Overflow policy.
+  public: FrameWriter::OverflowPolicy policy = FrameWriter::BLOCK;
+
+  /// \brief Number of frames written.
+  public: std::atomic<uint64_t> written{0};
+
+  /// \brief Number of frames dropped.
+  public: std::atomic<uint64_t> dropped{0};
+
+  /// \brief Protects all members except the counters.
+  public: mutable std::mutex mutex;
+
+  /// \brief Signaled when a frame is queued or the workers must stop.
+  public: std::condition_variable queued;
+
+  /// \brief Signaled when a frame is taken from the queue or written.
+  public: std::condition_variable done;
+};
+
+//////////////////////////////////////////////////
+void FrameWriterPrivate::Run()
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (true)
+  {
+    this->queued.wait(lock, [this]
+        {
+          return !this->running || !this->queue.empty();
+        });
+    if (this->queue.empty())
+      return;
+
+    Frame frame = std::move(this->queue.front());
+    this->queue.pop_front();
+    ++this->busy;
+    this->done.notify_all();
+    lock.unlock();
+
+    {
+      IGN_PROFILE("FrameWriter::Encode");
+      if (Camera::SaveFrame(frame.data.data(), frame.width, frame.height,
+            frame.depth, frame.format, frame.filename))
+      {
+        ++this->written;
+      }
+    }
+
+    lock.lock();
+    this->Recycle(frame);
+    --this->busy;
+    this->done.notify_all();
+  }
+}
+
+//////////////////////////////////////////////////
+void FrameWriterPrivate::Recycle(Frame &_frame)
+{
+  if (this->pool.size() < this->capacity + this->workers.size())
+    this->pool.push_back(std::move(_frame.data));
+}
+
+//////////////////////////////////////////////////
+FrameWriter::FrameWriter()
+  : dataPtr(new FrameWriterPrivate)
+{
+  const char *capacity = std::getenv("GAZEBO_FRAME_WRITER_QUEUE");
+  if (capacity && std::atoi(capacity) > 0)
+    this->dataPtr->capacity = std::atoi(capacity);
+
+  const char *policy = std::getenv("GAZEBO_FRAME_WRITER_POLICY");
+  if (policy)
+  {
+    const std::string value = policy;
+    if (value == "block")
+      this->dataPtr->policy = BLOCK;
+    else if (value == "drop_newest")
+      this->dataPtr->policy = DROP_NEWEST;
+    else if (value == "drop_oldest")
+      this->dataPtr->policy = DROP_OLDEST;
+    else
+      gzerr << "Unknown GAZEBO_FRAME_WRITER_POLICY [" << value << "]\n";
+  }
+}
+
+//////////////////////////////////////////////////
+FrameWriter::~FrameWriter()
+{
+  this->Stop();
+}
+
+//////////////////////////////////////////////////
+bool FrameWriter::Write(const unsigned char *_image,
+    const unsigned int _width, const unsigned int _height, const int _depth,
+    const std::string &_format, const std::string &_filename)
+{
+  IGN_PROFILE("FrameWriter::Write");
+
+  if (!_image)
+  {
+    gzerr << "Can't save an empty image\n";
+    return false;
+  }
+
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+
+  if (!this->dataPtr->running)
+  {
+    const unsigned int threads = std::max(1u,
+        std::min(4u, std::thread::hardware_concurrency() / 2));
+    this->dataPtr->running = true;
+    for (unsigned int i = 0; i < threads; ++i)
+    {
+      this->dataPtr->workers.emplace_back(&FrameWriterPrivate::Run,
+          this->dataPtr.get());
+    }
+  }
+
+  FrameWriterPrivate::Frame frame;
+  if (!this->dataPtr->pool.empty())
+  {
+    frame.data = std::move(this->dataPtr->pool.back());
+    this->dataPtr->pool.pop_back();
+  }
+  lock.unlock();
+
+  // Copy outside of the lock, so workers are not held up
+  const size_t size = Camera::ImageByteSize(_width, _height, _format);
+  frame.data.resize(size);
+  std::memcpy(frame.data.data(), _image, size);
+  frame.width = _width;
+  frame.height = _height;
+  frame.depth = _depth;
+  frame.format = _format;
+  frame.filename = _filename;
+
+  lock.lock();
+  if (this->dataPtr->queue.size() >= this->dataPtr->capacity)
+  {
+    if (this->dataPtr->policy == BLOCK)
+    {
+      this->dataPtr->done.wait(lock, [this]
+          {
+            return this->dataPtr->queue.size() < this->dataPtr->capacity;
+          });
+    }
+    else
+    {
+      if (++this->dataPtr->dropped == 1)
+      {
+        gzwarn << "Camera frames are saved faster than they can be written, "
+               << "dropping frames. See FrameWriter::DroppedFrames.\n";
+      }
+
+      if (this->dataPtr->policy == DROP_NEWEST)
+      {
+        this->dataPtr->Recycle(frame);
+        return false;
+      }
+
+      this->dataPtr->Recycle(this->dataPtr->queue.front());
+      this->dataPtr->queue.pop_front();
+    }
+  }
+
+  this->dataPtr->queue.push_back(std::move(frame));
+  this->dataPtr->queued.notify_one();
+  return true;
+}
+
+//////////////////////////////////////////////////
+void FrameWriter::Flush()
+{
+  std::unique_lock<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->done.wait(lock, [this]
+      {
+        return this->dataPtr->queue.empty() && this->dataPtr->busy == 0;
+      });
+}
+
+//////////////////////////////////////////////////
+void FrameWriter::Stop()
+{
+  std::vector<std::thread> workers;
+  {
+    std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+    this->dataPtr->running = false;
+    workers.swap(this->dataPtr->workers);
+  }
+  if (workers.empty())
+    return;
+  this->dataPtr->queued.notify_all();
+
+  // Workers write the remaining frames before exiting
+  for (auto &worker : workers)
+    worker.join();
+
+  if (this->dataPtr->dropped > 0)
+  {
+    gzwarn << "Dropped [" << this->dataPtr->dropped << "] of ["
+           << this->dataPtr->dropped + this->dataPtr->written
+           << "] saved camera frames\n";
+  }
+}
+
+//////////////////////////////////////////////////
+void FrameWriter::SetCapacity(const unsigned int _capacity)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->capacity = std::max(1u, _capacity);
+  this->dataPtr->done.notify_all();
+}
+
+//////////////////////////////////////////////////
+unsigned int FrameWriter::Capacity() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->capacity;
+}
+
+//////////////////////////////////////////////////
+void FrameWriter::SetPolicy(const OverflowPolicy _policy)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->policy = _policy;
+}
+
+//////////////////////////////////////////////////
+FrameWriter::OverflowPolicy FrameWriter::Policy() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->policy;
+}
+
+//////////////////////////////////////////////////
+unsigned int FrameWriter::QueueDepth() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->queue.size();
+}
+
+//////////////////////////////////////////////////
+uint64_t FrameWriter::WrittenFrames() const
+{
+  return this->dataPtr->written;
+}
+
+//////////////////////////////////////////////////
+uint64_t FrameWriter::DroppedFrames() const
+{
+  return this->dataPtr->dropped;
+}
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_RENDERING_FRAMEWRITER_HH_
+#define GAZEBO_RENDERING_FRAMEWRITER_HH_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "gazebo/common/SingletonT.hh"
+#include "gazebo/util/system.hh"
+
+/// \brief Explicit instantiation for typed SingletonT.
+GZ_SINGLETON_DECLARE(GZ_RENDERING_VISIBLE, gazebo, rendering, FrameWriter)
+
+namespace gazebo
+{
+  namespace rendering
+  {
+    // Forward declare private data.
+    class FrameWriterPrivate;
+
+    /// \addtogroup gazebo_rendering
+    /// \{
+
+    /// \class FrameWriter FrameWriter.hh rendering/rendering.hh
+    /// \brief Bounded pool of threads that encode and write camera frames
+    /// to disk, so saving frames does not stall the rendering thread.
+    ///
+    /// Write copies the image into a pooled buffer and queues it. When the
+    /// queue is full, the overflow policy decides whether the caller waits
+    /// or a frame is dropped. The defaults can be set with the environment
+    /// variables GAZEBO_FRAME_WRITER_QUEUE (queue capacity, in frames) and
+    /// GAZEBO_FRAME_WRITER_POLICY ("block", "drop_newest" or
+    /// "drop_oldest").
+    class GZ_RENDERING_VISIBLE FrameWriter : public SingletonT<FrameWriter>
+    {
+      /// \enum OverflowPolicy
+      /// \brief What to do with a frame written while the queue is full.
+      public: enum OverflowPolicy
+              {
+                /// \brief Wait until a frame has been written.
+                BLOCK,
+                /// \brief Drop the frame being written.
+                DROP_NEWEST,
+                /// \brief Drop the oldest queued frame.
+                DROP_OLDEST
+              };
+
+      /// \brief Constructor.
+      private: FrameWriter();
+
+      /// \brief Destructor. Writes the queued frames.
+      private: virtual ~FrameWriter();
+
+      /// \brief Queue a frame to be written, see Camera::SaveFrame for the
+      /// parameters. The image is copied, so the caller can reuse its
+      /// buffer as soon as this function returns.
+      /// \param[in] _image Image data.
+      /// \param[in] _width Image width.
+      /// \param[in] _height Image height.
+      /// \param[in] _depth Image depth.
+      /// \param[in] _format Image format.
+      /// \param[in] _filename File to write, its extension selects the
+      /// encoder.
+      /// \return False if the frame was dropped.
+      public: bool Write(const unsigned char *_image,
+                  const unsigned int _width, const unsigned int _height,
+                  const int _depth, const std::string &_format,
+                  const std::string &_filename);
+
+      /// \brief Wait until all the queued frames are written.
+      public: void Flush();
+
+      /// \brief Write the queued frames and stop the worker threads. They
+      /// are started again by the next call to Write.
+      public: void Stop();
+
+      /// \brief Set the maximum number of queued frames.
+      /// \param[in] _capacity Queue capacity, at least 1.
+      public: void SetCapacity(const unsigned int _capacity);
+
+      /// \brief Get the maximum number of queued frames.
+      /// \return Queue capacity.
+      public: unsigned int Capacity() const;
+
+      /// \brief Set the overflow policy.
+      /// \param[in] _policy Policy.
+      public: void SetPolicy(const OverflowPolicy _policy);
+
+      /// \brief Get the overflow policy.
+      /// \return Policy.
+      public: OverflowPolicy Policy() const;
+
+      /// \brief Get the number of frames waiting to be written.
+      /// \return Queue depth.
+      public: unsigned int QueueDepth() const;
+
+      /// \brief Get the number of frames written since startup.
+      /// \return Number of frames.
+      public: uint64_t WrittenFrames() const;
+
+      /// \brief Get the number of frames dropped because the queue was
+      /// full, since startup.
+      /// \return Number of frames.
+      public: uint64_t DroppedFrames() const;
+
+      /// \brief Makes this class a singleton.
+      private: friend class SingletonT<FrameWriter>;
+
+      /// \internal
+      /// \brief Pointer to private data.
+      private: std::unique_ptr<FrameWriterPrivate> dataPtr;
+    };
+    /// \}
+  }
+}
+#endif
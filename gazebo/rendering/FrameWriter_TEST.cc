@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "gazebo/rendering/FrameWriter.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+class FrameWriter_TEST : public RenderingFixture
+{
+};
+
+/////////////////////////////////////////////////
+TEST_F(FrameWriter_TEST, Write)
+{
+  Load("worlds/empty.world");
+
+  rendering::FrameWriter *writer = rendering::FrameWriter::Instance();
+  const unsigned int capacity = writer->Capacity();
+  const rendering::FrameWriter::OverflowPolicy policy = writer->Policy();
+
+  const boost::filesystem::path dir =
+    boost::filesystem::temp_directory_path() / "gazebo_frame_writer_test";
+  boost::filesystem::create_directories(dir);
+
+  const unsigned int width = 64;
+  const unsigned int height = 48;
+  std::vector<unsigned char> image(width * height * 3, 128);
+
+  // Null images are rejected
+  EXPECT_FALSE(writer->Write(nullptr, width, height, 3, "R8G8B8",
+      (dir / "null.png").string()));
+
+  // Blocking, every frame is written
+  writer->SetPolicy(rendering::FrameWriter::BLOCK);
+  writer->SetCapacity(2);
+  EXPECT_EQ(writer->Capacity(), 2u);
+  const uint64_t written = writer->WrittenFrames();
+  const uint64_t dropped = writer->DroppedFrames();
+  for (unsigned int i = 0; i < 20; ++i)
+  {
+    // The buffer can be reused as soon as Write returns
+    image[0] = i;
+    EXPECT_TRUE(writer->Write(image.data(), width, height, 3, "R8G8B8",
+        (dir / ("frame_" + std::to_string(i) + ".png")).string()));
+  }
+  writer->Flush();
+  EXPECT_EQ(writer->QueueDepth(), 0u);
+  EXPECT_EQ(writer->WrittenFrames(), written + 20);
+  EXPECT_EQ(writer->DroppedFrames(), dropped);
+  for (unsigned int i = 0; i < 20; ++i)
+  {
+    EXPECT_TRUE(boost::filesystem::exists(
+          dir / ("frame_" + std::to_string(i) + ".png")));
+  }
+
+  // Dropping, every frame is either written or dropped
+  writer->SetPolicy(rendering::FrameWriter::DROP_NEWEST);
+  writer->SetCapacity(1);
+  for (unsigned int i = 0; i < 50; ++i)
+  {
+    writer->Write(image.data(), width, height, 3, "R8G8B8",
+        (dir / ("drop_" + std::to_string(i) + ".png")).string());
+  }
+  writer->Flush();
+  EXPECT_EQ(writer->WrittenFrames() + writer->DroppedFrames(),
+      written + dropped + 70);
+
+  writer->Stop();
+  writer->SetCapacity(capacity);
+  writer->SetPolicy(policy);
+  boost::filesystem::remove_all(dir);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
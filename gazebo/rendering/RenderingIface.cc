@@ -18,6 +18,7 @@
 #include "gazebo/common/Exception.hh"
 #include "gazebo/common/Console.hh"
 
+#include "gazebo/rendering/FrameWriter.hh"
 #include "gazebo/rendering/RenderEngine.hh"
 #include "gazebo/rendering/RenderingIface.hh"
 #include "gazebo/rendering/Scene.hh"
@@ -66,6 +67,8 @@ bool rendering::init()
 //////////////////////////////////////////////////
 bool rendering::fini()
 {
+  // Write the pending camera frames while the encoders are available
+  rendering::FrameWriter::Instance()->Stop();
   rendering::RenderEngine::Instance()->Fini();
   return true;
 }
@@ -22,6 +22,7 @@
 #include "gazebo/msgs/msgs.hh"
 
 #include "gazebo/common/Assert.hh"
+#include "gazebo/common/CallbackAccounting.hh"
 #include "gazebo/common/Event.hh"
 #include "gazebo/common/Events.hh"
 #include "gazebo/common/CommonIface.hh"
@@ -3420,7 +3421,11 @@ void Visual::LoadPlugins()
       this->dataPtr->plugins.begin();
       iter != this->dataPtr->plugins.end(); ++iter)
   {
-    (*iter)->Init();
+    const std::string owner =
+        "visual/" + this->Name() + "/" + (*iter)->GetHandle();
+    event::ScopedCallbackOwner scopedOwner(owner);
+    event::CallbackAccounting::PluginCall(owner, "Init",
+        [&iter] { (*iter)->Init(); });
   }
 }
 
@@ -3441,11 +3446,22 @@ void Visual::LoadPlugin(const std::string &_filename,
             << "Plugin filename[" << _filename << "] name[" << _name << "]\n";
       return;
     }
-    plugin->Load(shared_from_this(), _sdf);
+
+    // Attribute the callbacks connected by the plugin to it, and the time
+    // spent in its Load and Init functions
+    const std::string owner = "visual/" + this->Name() + "/" + _name;
+    event::ScopedCallbackOwner scopedOwner(owner);
+
+    VisualPtr myself = shared_from_this();
+    event::CallbackAccounting::PluginCall(owner, "Load",
+        [&plugin, &myself, &_sdf] { plugin->Load(myself, _sdf); });
     this->dataPtr->plugins.push_back(plugin);
 
     if (this->dataPtr->initialized)
-      plugin->Init();
+    {
+      event::CallbackAccounting::PluginCall(owner, "Init",
+          [&plugin] { plugin->Init(); });
+    }
   }
 }
 
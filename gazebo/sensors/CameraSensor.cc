@@ -344,25 +344,29 @@ bool CameraSensor::UpdateImpl(const bool /*_force*/)
     auto simTime = this->scene->SimTime();
     if (this->imagePub && this->imagePub->HasConnections())
     {
-      msgs::ImageStamped msg;
-      msgs::Set(msg.mutable_time(), simTime);
-      msg.mutable_image()->set_width(this->camera->ImageWidth());
-      msg.mutable_image()->set_height(this->camera->ImageHeight());
-      msg.mutable_image()->set_pixel_format(common::Image::ConvertPixelFormat(
-            this->camera->ImageFormat()));
-
-      msg.mutable_image()->set_step(this->camera->ImageWidth() *
+      // The message is not copied by the publisher, and its storage is
+      // reused once subscribers release it.
+      boost::shared_ptr<msgs::ImageStamped> msg =
+        this->dataPtr->imagePool.Acquire();
+      msgs::Set(msg->mutable_time(), simTime);
+      msg->mutable_image()->set_width(this->camera->ImageWidth());
+      msg->mutable_image()->set_height(this->camera->ImageHeight());
+      msg->mutable_image()->set_pixel_format(
+          common::Image::ConvertPixelFormat(this->camera->ImageFormat()));
+
+      msg->mutable_image()->set_step(this->camera->ImageWidth() *
           this->camera->ImageDepth());
-      msg.mutable_image()->set_data(this->camera->ImageData(),
-          msg.image().width() * this->camera->ImageDepth() *
-          msg.image().height());
+      msg->mutable_image()->mutable_data()->assign(
+          reinterpret_cast<const char *>(this->camera->ImageData()),
+          msg->image().width() * this->camera->ImageDepth() *
+          msg->image().height());
 
-      this->imagePub->Publish(msg);
+      this->imagePub->PublishShared(msg);
     }
 
     if (this->imagePubIgn.HasConnections())
     {
-      ignition::msgs::Image msg;
+      ignition::msgs::Image &msg = this->dataPtr->imageMsgIgn;
       msg.mutable_header()->mutable_stamp()->set_sec(simTime.sec);
       msg.mutable_header()->mutable_stamp()->set_nsec(simTime.nsec);
 
@@ -373,7 +377,8 @@ bool CameraSensor::UpdateImpl(const bool /*_force*/)
 
       msg.set_step(this->camera->ImageWidth() *
           this->camera->ImageDepth());
-      msg.set_data(this->camera->ImageData(),
+      msg.mutable_data()->assign(
+          reinterpret_cast<const char *>(this->camera->ImageData()),
           msg.width() * this->camera->ImageDepth() *
           msg.height());
 
@@ -18,6 +18,10 @@
 #define GAZEBO_SENSORS_CAMERASENSOR_PRIVATE_HH_
 
 #include <limits>
+#include <ignition/msgs/image.pb.h>
+
+#include "gazebo/msgs/msgs.hh"
+#include "gazebo/transport/MessagePool.hh"
 
 namespace gazebo
 {
@@ -36,6 +40,14 @@ namespace gazebo
       /// \brief Timestamp of the forthcoming rendering
       public: double nextRenderingTime
                            = std::numeric_limits<double>::quiet_NaN();
+
+      /// \brief Pool of the published images, so frames are copied once,
+      /// from the camera into the message.
+      public: transport::MessagePool<msgs::ImageStamped> imagePool;
+
+      /// \brief Image published with ignition transport. Reused, so its
+      /// data is not reallocated for every frame.
+      public: ignition::msgs::Image imageMsgIgn;
     };
   }
 }
@@ -14,7 +14,9 @@
  * limitations under the License.
  *
 */
+#include <cmath>
 #include <functional>
+#include <string>
 
 #include "ignition/common/Profiler.hh"
 
@@ -47,8 +49,6 @@ DepthCameraSensor::DepthCameraSensor()
 //////////////////////////////////////////////////
 DepthCameraSensor::~DepthCameraSensor()
 {
-  if (this->dataPtr->depthBuffer)
-    delete [] this->dataPtr->depthBuffer;
 }
 
 //////////////////////////////////////////////////
@@ -151,41 +151,50 @@ bool DepthCameraSensor::UpdateImpl(const bool /*_force*/)
       // generating point clouds instead
       this->dataPtr->depthCamera->DepthData())
   {
-    msgs::ImageStamped msg;
-    msgs::Set(msg.mutable_time(), this->scene->SimTime());
-    msg.mutable_image()->set_width(this->camera->ImageWidth());
-    msg.mutable_image()->set_height(this->camera->ImageHeight());
-    msg.mutable_image()->set_pixel_format(common::Image::R_FLOAT32);
+    // The message is not copied by the publisher, and its storage is
+    // reused once subscribers release it.
+    boost::shared_ptr<msgs::ImageStamped> msg =
+      this->dataPtr->imagePool.Acquire();
+    msgs::Set(msg->mutable_time(), this->scene->SimTime());
+    msg->mutable_image()->set_width(this->camera->ImageWidth());
+    msg->mutable_image()->set_height(this->camera->ImageHeight());
+    msg->mutable_image()->set_pixel_format(common::Image::R_FLOAT32);
 
 
-    msg.mutable_image()->set_step(this->camera->ImageWidth() *
+    msg->mutable_image()->set_step(this->camera->ImageWidth() *
         this->camera->ImageDepth());
 
-    unsigned int depthSamples = msg.image().width() * msg.image().height();
+    unsigned int depthSamples = msg->image().width() * msg->image().height();
     float f;
     // cppchecker recommends using sizeof(varname)
     unsigned int depthBufferSize = depthSamples * sizeof(f);
 
-    if (!this->dataPtr->depthBuffer)
-      this->dataPtr->depthBuffer = new float[depthSamples];
-
-    memcpy(this->dataPtr->depthBuffer, this->dataPtr->depthCamera->DepthData(),
-        depthBufferSize);
-
+    std::string *data = msg->mutable_image()->mutable_data();
+    data->resize(depthBufferSize);
+
+    const float *depth = this->dataPtr->depthCamera->DepthData();
+    float *depthBuffer = reinterpret_cast<float *>(&(*data)[0]);
+    // Float clip distances, rounded so that comparing a float depth with
+    // them gives the same result as comparing it with the double distances
+    float farClip = static_cast<float>(this->camera->FarClip());
+    if (farClip < this->camera->FarClip())
+      farClip = std::nextafter(farClip, ignition::math::INF_F);
+    float nearClip = static_cast<float>(this->camera->NearClip());
+    if (nearClip > this->camera->NearClip())
+      nearClip = std::nextafter(nearClip, -ignition::math::INF_F);
+
+    // Copy the depth data into the message, and mask ranges outside of
+    // min/max to +/- inf, as per REP 117. The loop has no branches, so it
+    // is vectorized.
     for (unsigned int i = 0; i < depthSamples; ++i)
     {
-      // Mask ranges outside of min/max to +/- inf, as per REP 117
-      if (this->dataPtr->depthBuffer[i] >= this->camera->FarClip())
-      {
-        this->dataPtr->depthBuffer[i] = ignition::math::INF_D;
-      }
-      else if (this->dataPtr->depthBuffer[i] <= this->camera->NearClip())
-      {
-        this->dataPtr->depthBuffer[i] = -ignition::math::INF_D;
-      }
+      const float d = depth[i];
+      depthBuffer[i] = d >= farClip ? ignition::math::INF_F :
+        (d <= nearClip ? -ignition::math::INF_F : d);
     }
-    msg.mutable_image()->set_data(this->dataPtr->depthBuffer, depthBufferSize);
-    this->imagePub->Publish(msg);
+
+    this->dataPtr->depthMsg = msg;
+    this->imagePub->PublishShared(msg);
   }
 
   this->SetRendered(false);
@@ -196,7 +205,11 @@ bool DepthCameraSensor::UpdateImpl(const bool /*_force*/)
 //////////////////////////////////////////////////
 const float *DepthCameraSensor::DepthData() const
 {
-  return this->dataPtr->depthBuffer;
+  if (!this->dataPtr->depthMsg)
+    return nullptr;
+
+  return reinterpret_cast<const float *>(
+      this->dataPtr->depthMsg->image().data().data());
 }
 
 //////////////////////////////////////////////////
@@ -17,7 +17,9 @@
 #ifndef _GAZEBO_SENSORS_DEPTHCAMERASENSOR_PRIVATE_HH_
 #define _GAZEBO_SENSORS_DEPTHCAMERASENSOR_PRIVATE_HH_
 
+#include "gazebo/msgs/msgs.hh"
 #include "gazebo/rendering/RenderTypes.hh"
+#include "gazebo/transport/MessagePool.hh"
 
 namespace gazebo
 {
@@ -27,8 +29,12 @@ namespace gazebo
     /// \brief Depth camera sensor private data.
     class DepthCameraSensorPrivate
     {
-      /// \brief Depth data buffer.
-      public: float *depthBuffer = nullptr;
+      /// \brief Pool of the published depth images.
+      public: transport::MessagePool<msgs::ImageStamped> imagePool;
+
+      /// \brief Last depth image, which holds the data returned by
+      /// DepthCameraSensor::DepthData.
+      public: boost::shared_ptr<msgs::ImageStamped> depthMsg;
 
       /// \brief Local pointer to the depthCamera.
       public: rendering::DepthCameraPtr depthCamera;
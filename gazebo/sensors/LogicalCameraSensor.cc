@@ -20,6 +20,8 @@
 #include "gazebo/msgs/msgs.hh"
 #include "gazebo/physics/World.hh"
 #include "gazebo/physics/Model.hh"
+#include "gazebo/physics/PhysicsEngine.hh"
+#include "gazebo/physics/SpatialIndex.hh"
 
 #include "gazebo/sensors/SensorFactory.hh"
 #include "gazebo/sensors/LogicalCameraSensorPrivate.hh"
@@ -117,9 +119,8 @@ void LogicalCameraSensorPrivate::AddVisibleModels(
   for (auto const &model : _models)
   {
     auto const &scopedName = model->GetScopedName();
-    auto const aabb = model->BoundingBox();
 
-    if (this->modelName != scopedName && this->frustum.Contains(aabb))
+    if (this->modelName != scopedName)
     {
       // Add new model msg
       msgs::LogicalCameraImage::Model *modelMsg = this->msg.add_model();
@@ -129,11 +130,6 @@ void LogicalCameraSensorPrivate::AddVisibleModels(
       msgs::Set(modelMsg->mutable_pose(),
           model->WorldPose() - _myPose);
     }
-    // Check nested models
-    // Note, the model AABB does not necessarily contain the nested model
-    // so nested models must be searched even if the frustum does not contain
-    // the parent model.
-    AddVisibleModels(_myPose, model->NestedModels());
   }
 }
 
@@ -158,8 +154,23 @@ bool LogicalCameraSensor::UpdateImpl(const bool _force)
     // Set the camera's pose in the message.
     msgs::Set(this->dataPtr->msg.mutable_pose(), myPose);
 
-    // Recursively check if models and nested models are in the frustum.
-    this->dataPtr->AddVisibleModels(myPose, this->world->Models());
+    // Find the models and nested models in the frustum. Each nested model
+    // has its own bounding box in the index, which the bounding box of its
+    // parent does not necessarily contain. Models without collisions have
+    // no bounding box, so their origin is tested instead. The queries
+    // refresh the bounding boxes through the physics engine.
+    {
+      boost::recursive_mutex::scoped_lock physicsLock(
+          *this->world->Physics()->GetPhysicsUpdateMutex());
+      physics::SpatialIndex &index = this->world->SpatialIndex();
+      physics::Model_V models = index.ModelsInFrustum(this->dataPtr->frustum);
+      for (auto const &model : index.ModelsWithoutBox())
+      {
+        if (this->dataPtr->frustum.Contains(model->WorldPose().Pos()))
+          models.push_back(model);
+      }
+      this->dataPtr->AddVisibleModels(myPose, models);
+    }
     IGN_PROFILE_END();
 
     IGN_PROFILE_BEGIN("Publish");
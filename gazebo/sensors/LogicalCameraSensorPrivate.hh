@@ -32,9 +32,10 @@ namespace gazebo
     /// \brief Logical camera sensor private data.
     class LogicalCameraSensorPrivate
     {
-      /// \brief Add models that are visible to the camera to a vector of models
+      /// \brief Add the models visible to the camera to the message
       /// \param[in] _myPose pose of the logical camera
-      /// \param[in] _models list of models to test against frustum
+      /// \param[in] _models models in the frustum, see
+      /// physics::SpatialIndex::ModelsInFrustum
       public: void AddVisibleModels(ignition::math::Pose3d &_myPose,
         const physics::Model_V &_models);
 
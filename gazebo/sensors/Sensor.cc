@@ -25,6 +25,7 @@
 #include "gazebo/physics/PhysicsEngine.hh"
 
 #include "gazebo/common/Timer.hh"
+#include "gazebo/common/CallbackAccounting.hh"
 #include "gazebo/common/Console.hh"
 #include "gazebo/common/Exception.hh"
 #include "gazebo/common/Plugin.hh"
@@ -344,8 +345,18 @@ void Sensor::LoadPlugin(sdf::ElementPtr _sdf)
     }
 
     SensorPtr myself = shared_from_this();
-    plugin->Load(myself, _sdf);
-    plugin->Init();
+
+    // Attribute the callbacks connected by the plugin, and the time spent
+    // in its Load and Init functions, to it. Its callbacks belong to the
+    // world of the sensor.
+    const std::string owner = "sensor/" + this->ScopedName() + "/" + name;
+    event::ScopedCallbackOwner scopedOwner(owner);
+    event::ScopedEventWorld scopedWorld(this->world->Name());
+
+    event::CallbackAccounting::PluginCall(owner, "Load",
+        [&plugin, &myself, &_sdf] { plugin->Load(myself, _sdf); });
+    event::CallbackAccounting::PluginCall(owner, "Init",
+        [&plugin] { plugin->Init(); });
     this->plugins.push_back(plugin);
   }
 }
@@ -80,17 +80,24 @@ void SensorManager::RunThreads()
   // sensorsContainers list are the image-based sensors, which rely on the
   // rendering engine, which in turn requires that they run in the main
   // thread.
+  boost::recursive_mutex::scoped_lock lock(this->mutex);
   for (SensorContainer_V::iterator iter = ++this->sensorContainers.begin();
        iter != this->sensorContainers.end(); ++iter)
   {
     GZ_ASSERT((*iter) != nullptr, "Sensor Constainer is null");
     (*iter)->Run();
   }
+  this->threadsRunning = true;
 }
 
 //////////////////////////////////////////////////
 void SensorManager::Stop()
 {
+  {
+    boost::recursive_mutex::scoped_lock lock(this->mutex);
+    this->threadsRunning = false;
+  }
+
   // Start all the sensor containers.
   for (SensorContainer_V::iterator iter = this->sensorContainers.begin();
        iter != this->sensorContainers.end(); ++iter)
@@ -115,16 +122,17 @@ bool SensorManager::Running() const
 }
 
 //////////////////////////////////////////////////
-void SensorManager::WaitForSensors(double _clk, double _dt)
+void SensorManager::WaitForSensors(const std::string &_worldName,
+    double _clk, double _dt)
 {
-  double tnext = this->NextRequiredTimestamp();
+  double tnext = this->NextRequiredTimestamp(_worldName);
 
   while (!std::isnan(tnext)
       && ignition::math::lessOrNearEqual(tnext - _dt / 2.0, _clk)
       && physics::worlds_running())
   {
     this->WaitForPrerendered(0.001);
-    tnext = this->NextRequiredTimestamp();
+    tnext = this->NextRequiredTimestamp(_worldName);
   }
 }
 
@@ -134,11 +142,17 @@ void SensorManager::Update(bool _force)
   {
     boost::recursive_mutex::scoped_lock lock(this->mutex);
 
-    if (this->worlds.empty() && physics::worlds_running() && this->initialized)
+    // Worlds without sensors are initialized as soon as they run
+    if (physics::worlds_running() && this->initialized)
     {
-      auto world = physics::get_world();
-      this->worlds[world->Name()] = world;
-      world->_SetSensorsInitialized(true);
+      for (auto const &world : physics::get_worlds())
+      {
+        if (this->worlds.find(world->Name()) == this->worlds.end())
+        {
+          this->worlds[world->Name()] = world;
+          world->_SetSensorsInitialized(true);
+        }
+      }
     }
 
     if (!this->initSensors.empty())
@@ -149,11 +163,13 @@ void SensorManager::Update(bool _force)
         GZ_ASSERT(sensor != nullptr, "Sensor pointer is null");
         GZ_ASSERT(sensor->Category() < 0 ||
             sensor->Category() < CATEGORY_COUNT, "Sensor category is empty");
-        GZ_ASSERT(this->sensorContainers[sensor->Category()] != nullptr,
-            "Sensor container is null");
+
+        SensorContainer *container =
+            this->Container(sensor->WorldName(), sensor->Category());
+        GZ_ASSERT(container != nullptr, "Sensor container is null");
 
         sensor->Init();
-        this->sensorContainers[sensor->Category()]->AddSensor(sensor);
+        container->AddSensor(sensor);
       }
       this->initSensors.clear();
       for (auto &worldName_worldPtr : this->worlds)
@@ -226,7 +242,7 @@ void SensorManager::ResetLastUpdateTimes()
 }
 
 //////////////////////////////////////////////////
-double SensorManager::NextRequiredTimestamp()
+double SensorManager::NextRequiredTimestamp(const std::string &_worldName)
 {
   double rv = std::numeric_limits<double>::quiet_NaN();
 
@@ -236,6 +252,9 @@ double SensorManager::NextRequiredTimestamp()
     // skip deactivated sensors
     if (!s->IsActive()) continue;
 
+    // skip the sensors of the other worlds
+    if (!_worldName.empty() && s->WorldName() != _worldName) continue;
+
     double candidate = s->NextRequiredTimestamp();
     // take the smallest valid value
     if (!std::isnan(candidate)
@@ -342,7 +361,7 @@ std::string SensorManager::CreateSensor(sdf::ElementPtr _elem,
   // Provide the wait function to the given world
   if (sensor->StrictRate())
     this->worlds[_worldName]->SetSensorWaitFunc(
-        std::bind(&SensorManager::WaitForSensors, this,
+        std::bind(&SensorManager::WaitForSensors, this, _worldName,
           std::placeholders::_1, std::placeholders::_2));
 
   // If the SensorManager has not been initialized, then it's okay to push
@@ -350,7 +369,7 @@ std::string SensorManager::CreateSensor(sdf::ElementPtr _elem,
   // initialized in SensorManager::Init
   if (!this->initialized)
   {
-    this->sensorContainers[sensor->Category()]->AddSensor(sensor);
+    this->Container(_worldName, sensor->Category())->AddSensor(sensor);
   }
   // Otherwise the SensorManager is already running, and the sensor will get
   // initialized during the next SensorManager::Update call.
@@ -471,7 +490,48 @@ void SensorManager::RemoveSensors()
 }
 
 //////////////////////////////////////////////////
-SensorManager::SensorContainer::SensorContainer()
+SensorManager::SensorContainer *SensorManager::Container(
+    const std::string &_worldName, const SensorCategory _category)
+{
+  boost::recursive_mutex::scoped_lock lock(this->mutex);
+
+  // Image sensors are rendered together in the main thread, whatever their
+  // world. The first RAY and OTHER containers belong to the first world.
+  if (_category == sensors::IMAGE || _worldName.empty() ||
+      !physics::has_world() || physics::get_world()->Name() == _worldName)
+  {
+    return this->sensorContainers[_category];
+  }
+
+  // The other worlds have their own RAY and OTHER containers, so that their
+  // threads follow the time of their world.
+  const size_t perWorld = sensors::CATEGORY_COUNT - sensors::RAY;
+  size_t index = sensors::CATEGORY_COUNT;
+  while (index < this->sensorContainers.size() &&
+         this->sensorContainers[index]->worldName != _worldName)
+  {
+    index += perWorld;
+  }
+
+  if (index == this->sensorContainers.size())
+  {
+    for (size_t i = 0; i < perWorld; ++i)
+    {
+      SensorContainer *container = new SensorContainer(_worldName);
+      if (this->initialized)
+        container->Init();
+      if (this->threadsRunning)
+        container->Run();
+      this->sensorContainers.push_back(container);
+    }
+  }
+
+  return this->sensorContainers[index + _category - sensors::RAY];
+}
+
+//////////////////////////////////////////////////
+SensorManager::SensorContainer::SensorContainer(const std::string &_worldName)
+  : worldName(_worldName)
 {
   this->stop = true;
   this->initialized = false;
@@ -554,7 +614,7 @@ void SensorManager::SensorContainer::RunLoop()
 {
   this->stop = false;
 
-  physics::WorldPtr world = physics::get_world();
+  physics::WorldPtr world = physics::get_world(this->worldName);
   GZ_ASSERT(world != nullptr, "Pointer to World is null");
 
   physics::PhysicsEnginePtr engine = world->Physics();
@@ -668,7 +728,7 @@ void SensorManager::SensorContainer::RunLoop()
     // Add an event to trigger when the appropriate simulation time has been
     // reached.
     SensorManager::Instance()->simTimeEventHandler->AddRelativeEvent(
-        eventTime, &this->runCondition);
+        eventTime, &this->runCondition, world->Name());
 
     // This if statement helps prevent deadlock on osx during teardown.
     IGN_PROFILE_BEGIN("Sleeping");
@@ -860,17 +920,19 @@ SimTimeEventHandler::~SimTimeEventHandler()
 
 /////////////////////////////////////////////////
 void SimTimeEventHandler::AddRelativeEvent(const common::Time &_time,
-                                           boost::condition_variable *_var)
+                                           boost::condition_variable *_var,
+                                           const std::string &_worldName)
 {
   boost::mutex::scoped_lock lock(this->mutex);
 
-  physics::WorldPtr world = physics::get_world();
+  physics::WorldPtr world = physics::get_world(_worldName);
   GZ_ASSERT(world != nullptr, "World pointer is null");
 
   // Create the new event.
   SimTimeEvent *event = new SimTimeEvent;
   event->time = world->SimTime() + _time;
   event->condition = _var;
+  event->worldName = world->Name();
 
   // Add the event to the list.
   this->events.push_back(event);
@@ -889,8 +951,9 @@ void SimTimeEventHandler::OnUpdate(const common::UpdateInfo &_info)
     GZ_ASSERT(*iter != nullptr, "SimTimeEvent is null");
 
     // Find events that have a time less than or equal to simulation
-    // time.
-    if ((*iter)->time <= _info.simTime)
+    // time, in the world being updated.
+    if ((*iter)->worldName == _info.worldName &&
+        (*iter)->time <= _info.simTime)
     {
       // Notify the event by triggering its condition.
       (*iter)->condition->notify_all();
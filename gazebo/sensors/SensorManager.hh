@@ -51,6 +51,9 @@ namespace gazebo
 
       /// \brief The condition to notify.
       public: boost::condition_variable *condition;
+
+      /// \brief Name of the world whose time triggers the condition.
+      public: std::string worldName;
     };
 
     /// \brief Monitors simulation time, and notifies conditions when
@@ -68,8 +71,11 @@ namespace gazebo
       /// be add to this time.
       /// \param[in] _var Condition to notify when the time has been
       /// reached.
+      /// \param[in] _worldName Name of the world whose time is used, the
+      /// first world if empty.
       public: void AddRelativeEvent(const common::Time &_time,
-                  boost::condition_variable *_var);
+                  boost::condition_variable *_var,
+                  const std::string &_worldName = "");
 
       /// \brief Called when the world is updated.
       /// \param[in] _info Update timing information.
@@ -108,8 +114,10 @@ namespace gazebo
 
       /// \brief Amongst all IMAGE sensors, returns the forthcoming timestamp
       ///          used by one (or several) sensor
+      /// \param[in] _worldName Only consider the sensors of this world, or
+      /// the sensors of all the worlds if empty.
       /// \return the timestamp
-      public: double NextRequiredTimestamp();
+      public: double NextRequiredTimestamp(const std::string &_worldName = "");
 
       /// \brief Init all the sensors
       public: void Init();
@@ -180,9 +188,11 @@ namespace gazebo
       public: void ResetLastUpdateTimes();
 
       /// \brief Block until all sensors do not need current world tick
+      /// \param[in] _worldName Name of the world that waits.
       /// \param[in] _clk simulated clock of the world
       /// \param[in] _dt world time step
-      private: void WaitForSensors(double _clk, double _dt);
+      private: void WaitForSensors(const std::string &_worldName,
+                   double _clk, double _dt);
 
       /// \brief Wait until pre-rendering phase is over.
       /// \param[in] _timeoutsec timeout expressed in seconds
@@ -202,7 +212,10 @@ namespace gazebo
       private: class SensorContainer
                {
                  /// \brief Constructor
-                 public: SensorContainer();
+                 /// \param[in] _worldName Name of the world whose time
+                 /// paces the updates, the first world if empty.
+                 public: explicit SensorContainer(
+                             const std::string &_worldName = "");
 
                  /// \brief Destructor
                  public: virtual ~SensorContainer();
@@ -258,6 +271,10 @@ namespace gazebo
                  /// \brief The set of sensors to maintain.
                  public: Sensor_V sensors;
 
+                 /// \brief Name of the world of the sensors, empty for the
+                 /// first world.
+                 public: const std::string worldName;
+
                  /// \brief Flag to inidicate when to stop the runThread.
                  private: bool stop;
 
@@ -297,6 +314,16 @@ namespace gazebo
                };
       /// \endcond
 
+      /// \brief Get the container of a category of sensors of a world. The
+      /// containers of a world other than the first one are created the
+      /// first time they are needed.
+      /// \param[in] _worldName Name of the world of the sensors.
+      /// \param[in] _category Category of the sensors.
+      /// \return The sensor container.
+      private: SensorContainer *Container(
+                   const std::string &_worldName,
+                   const SensorCategory _category);
+
       /// \brief True if SensorManager::Init has been called
       ///        i.e. SensorManager::sensors are initialized.
       private: bool initialized;
@@ -304,6 +331,9 @@ namespace gazebo
       /// \brief True removes all sensors from all sensor containers.
       private: bool removeAllSensors;
 
+      /// \brief True while the threads of the non-image containers run.
+      private: bool threadsRunning = false;
+
       /// \brief Mutex used when adding and removing sensors.
       private: mutable boost::recursive_mutex mutex;
 
@@ -316,7 +346,10 @@ namespace gazebo
       /// \brief A vector of SensorContainer pointers.
       private: typedef std::vector<SensorContainer*> SensorContainer_V;
 
-      /// \brief The sensor manager's vector of sensor containers.
+      /// \brief The sensor manager's vector of sensor containers. The
+      /// first CATEGORY_COUNT containers hold the image sensors of all the
+      /// worlds and the other sensors of the first world. They are followed
+      /// by the RAY and OTHER containers of each additional world.
       private: SensorContainer_V sensorContainers;
 
       /// \brief This is a singleton class.
@@ -14,6 +14,8 @@
  * limitations under the License.
  *
 */
+#include <memory>
+#include <vector>
 #include <ignition/common/Profiler.hh>
 #include <ignition/math/Pose3.hh>
 
@@ -24,6 +26,7 @@
 #include "gazebo/transport/Publisher.hh"
 
 #include "gazebo/sensors/WirelessReceiverPrivate.hh"
+#include "gazebo/sensors/WirelessTransceiverPrivate.hh"
 #include "gazebo/sensors/WirelessReceiver.hh"
 #include "gazebo/sensors/WirelessTransmitter.hh"
 
@@ -48,6 +51,8 @@ WirelessReceiver::~WirelessReceiver()
 void WirelessReceiver::Init()
 {
   WirelessTransceiver::Init();
+
+  this->dataPtr->testRay = CreateObstacleRay(this->world);
 }
 
 /////////////////////////////////////////////////
@@ -106,14 +111,15 @@ bool WirelessReceiver::UpdateImpl(const bool /*_force*/)
   IGN_PROFILE("WirelessReceiver::UpdateImpl");
   IGN_PROFILE_BEGIN("Update");
 
-  std::string txEssid;
   msgs::WirelessNodes msg;
-  double rxPower;
-  double txFreq;
 
   this->referencePose = this->pose + this->parentEntity.lock()->WorldPose();
 
   ignition::math::Pose3d myPos = this->referencePose;
+
+  // Discard the transmitters whose frequency is out of our frequency range
+  std::vector<std::shared_ptr<WirelessTransmitter>> transmitters;
+  std::vector<ignition::math::Vector3d> starts;
   Sensor_V sensors = SensorManager::Instance()->GetSensors();
   for (Sensor_V::iterator it = sensors.begin(); it != sensors.end(); ++it)
   {
@@ -122,26 +128,38 @@ bool WirelessReceiver::UpdateImpl(const bool /*_force*/)
       std::shared_ptr<gazebo::sensors::WirelessTransmitter> transmitter =
           std::static_pointer_cast<WirelessTransmitter>(*it);
 
-      txFreq = transmitter->Freq();
-      rxPower = transmitter->SignalStrength(myPos, this->Gain());
-
-      // Discard if the frequency received is out of our frequency range,
-      // or if the received signal strengh is lower than the sensivity
+      const double txFreq = transmitter->Freq();
       if ((txFreq < this->MinFreqFiltered()) ||
-          (txFreq > this->MaxFreqFiltered()) ||
-          (rxPower < this->Sensitivity()))
+          (txFreq > this->MaxFreqFiltered()))
       {
         continue;
       }
 
-      txEssid = transmitter->ESSID();
-
-      msgs::WirelessNode *wirelessNode = msg.add_node();
-      wirelessNode->set_essid(txEssid);
-      wirelessNode->set_frequency(txFreq);
-      wirelessNode->set_signal_level(rxPower);
+      transmitters.push_back(transmitter);
+      starts.push_back(transmitter->ReferencePose().Pos());
     }
   }
+
+  // Look for obstacles between all the transmitters and us at once
+  std::vector<bool> obstructed;
+  Obstructed(this->world, this->dataPtr->testRay, starts,
+      std::vector<ignition::math::Vector3d>(starts.size(), myPos.Pos()),
+      obstructed);
+
+  for (size_t i = 0; i < transmitters.size(); ++i)
+  {
+    const double rxPower = transmitters[i]->SignalStrength(myPos,
+        this->Gain(), obstructed[i]);
+
+    // Discard if the received signal strengh is lower than the sensivity
+    if (rxPower < this->Sensitivity())
+      continue;
+
+    msgs::WirelessNode *wirelessNode = msg.add_node();
+    wirelessNode->set_essid(transmitters[i]->ESSID());
+    wirelessNode->set_frequency(transmitters[i]->Freq());
+    wirelessNode->set_signal_level(rxPower);
+  }
   IGN_PROFILE_END();
   IGN_PROFILE_BEGIN("Publish");
   if (msg.node_size() > 0)
@@ -174,5 +192,6 @@ double WirelessReceiver::Sensitivity() const
 //////////////////////////////////////////////////
 void WirelessReceiver::Fini()
 {
+  this->dataPtr->testRay.reset();
   WirelessTransceiver::Fini();
 }
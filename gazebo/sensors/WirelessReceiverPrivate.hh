@@ -17,6 +17,8 @@
 #ifndef _GAZEBO_SENSORS_WIRELESSRECEIVER_PRIVATE_HH_
 #define _GAZEBO_SENSORS_WIRELESSRECEIVER_PRIVATE_HH_
 
+#include "gazebo/physics/PhysicsTypes.hh"
+
 namespace gazebo
 {
   namespace sensors
@@ -33,6 +35,10 @@ namespace gazebo
 
       /// \brief Antenna's sensitivity of the receiver (dBm).
       public: double sensitivity = -90.0;
+
+      /// \brief Ray used to test for obstacles between the transmitters and
+      /// the receiver.
+      public: physics::RayShapePtr testRay;
     };
   }
 }
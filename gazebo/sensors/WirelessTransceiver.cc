@@ -15,7 +15,10 @@
  *
 */
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 #include <sstream>
+#include <string>
+#include <vector>
 #include "gazebo/msgs/msgs.hh"
 #include "gazebo/sensors/SensorFactory.hh"
 #include "gazebo/sensors/SensorManager.hh"
@@ -23,6 +26,7 @@
 #include "gazebo/transport/Node.hh"
 #include "gazebo/transport/Publisher.hh"
 
+#include "gazebo/sensors/WirelessTransceiverPrivate.hh"
 #include "gazebo/sensors/WirelessTransceiver.hh"
 
 using namespace gazebo;
@@ -112,3 +116,58 @@ double WirelessTransceiver::Gain() const
 {
   return this->gain;
 }
+
+/////////////////////////////////////////////////
+ignition::math::Pose3d WirelessTransceiver::ReferencePose() const
+{
+  return this->referencePose;
+}
+
+/////////////////////////////////////////////////
+physics::RayShapePtr sensors::CreateObstacleRay(
+    const physics::WorldPtr &_world)
+{
+  return boost::dynamic_pointer_cast<physics::RayShape>(
+      _world->Physics()->CreateShape("ray", physics::CollisionPtr()));
+}
+
+/////////////////////////////////////////////////
+void sensors::Obstructed(const physics::WorldPtr &_world,
+    const physics::RayShapePtr &_ray,
+    const std::vector<ignition::math::Vector3d> &_starts,
+    const std::vector<ignition::math::Vector3d> &_ends,
+    std::vector<bool> &_obstructed)
+{
+  _obstructed.assign(_starts.size(), false);
+
+  // The batch culls the segments against the collision bounding boxes
+  // itself, see physics::RayShape::Intersections
+  const size_t count = std::min(_starts.size(), _ends.size());
+  if (count == 0)
+    return;
+
+  std::vector<ignition::math::Vector3d> ends(_ends.begin(),
+      _ends.begin() + count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    // Avoid computing the intersection of coincident points
+    // This prevents an assertion in bullet (issue #849)
+    if (_starts[i] == ends[i])
+      ends[i].Z() += 0.00001;
+  }
+  const std::vector<ignition::math::Vector3d> starts(_starts.begin(),
+      _starts.begin() + count);
+
+  std::vector<double> dists;
+  std::vector<std::string> entities;
+  {
+    // Acquire the mutex for avoiding race condition with the physics engine
+    boost::recursive_mutex::scoped_lock lock(*(
+          _world->Physics()->GetPhysicsUpdateMutex()));
+    _ray->Intersections(starts, ends, dists, entities);
+  }
+
+  // ToDo: The ray intersects with my own collision model. Fix it.
+  for (size_t i = 0; i < count; ++i)
+    _obstructed[i] = !entities[i].empty();
+}
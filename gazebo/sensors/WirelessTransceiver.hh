@@ -62,6 +62,10 @@ namespace gazebo
       /// \return Receiver power (dBm).
       public: double Power() const;
 
+      /// \brief Returns the pose of the antenna, as of the last update.
+      /// \return Pose of the antenna in the world frame.
+      public: ignition::math::Pose3d ReferencePose() const;
+
       /// \brief Publisher to publish propagation model data
       protected: transport::PublisherPtr pub;
 
@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef _GAZEBO_SENSORS_WIRELESSTRANSCEIVER_PRIVATE_HH_
+#define _GAZEBO_SENSORS_WIRELESSTRANSCEIVER_PRIVATE_HH_
+
+#include <vector>
+#include <ignition/math/Vector3.hh>
+#include "gazebo/physics/PhysicsTypes.hh"
+
+namespace gazebo
+{
+  namespace sensors
+  {
+    /// \internal
+    /// \brief Create the ray a wireless sensor tests for obstacles with.
+    /// \param[in] _world World of the sensor.
+    /// \return The ray.
+    physics::RayShapePtr CreateObstacleRay(const physics::WorldPtr &_world);
+
+    /// \internal
+    /// \brief Check which segments between antennas are blocked by
+    /// obstacles. The segments are tested in a single batch, see
+    /// physics::RayShape::Intersections.
+    /// \param[in] _world World of the antennas.
+    /// \param[in] _ray Ray created by CreateObstacleRay.
+    /// \param[in] _starts Start of each segment, in the world frame.
+    /// \param[in] _ends End of each segment, one per start.
+    /// \param[out] _obstructed True for each segment that intersects a
+    /// collision.
+    void Obstructed(const physics::WorldPtr &_world,
+        const physics::RayShapePtr &_ray,
+        const std::vector<ignition::math::Vector3d> &_starts,
+        const std::vector<ignition::math::Vector3d> &_ends,
+        std::vector<bool> &_obstructed);
+  }
+}
+#endif
@@ -14,6 +14,9 @@
  * limitations under the License.
  *
 */
+#include <cmath>
+#include <utility>
+#include <vector>
 #include <ignition/math/Rand.hh>
 
 #include "gazebo/msgs/msgs.hh"
@@ -22,6 +25,7 @@
 #include "gazebo/transport/Node.hh"
 #include "gazebo/transport/Publisher.hh"
 
+#include "gazebo/sensors/WirelessTransceiverPrivate.hh"
 #include "gazebo/sensors/WirelessTransmitterPrivate.hh"
 #include "gazebo/sensors/WirelessTransmitter.hh"
 
@@ -37,6 +41,32 @@ const double WirelessTransmitterPrivate::ModelStdDev = 6.0;
 const double WirelessTransmitterPrivate::Step = 1.0;
 const double WirelessTransmitterPrivate::MaxRadius = 10.0;
 
+namespace
+{
+  /// \brief Get the links whose bounding box is near a point, and their
+  /// poses.
+  /// \param[in] _world World of the links.
+  /// \param[in] _center Center of the region.
+  /// \param[in] _radius Radius of the region.
+  /// \return The links and their world poses.
+  std::vector<std::pair<const Link *, ignition::math::Pose3d>> NearbyLinks(
+      World &_world, const ignition::math::Vector3d &_center,
+      const double _radius)
+  {
+    // The query refreshes the bounding boxes through the physics engine
+    boost::recursive_mutex::scoped_lock lock(
+        *_world.Physics()->GetPhysicsUpdateMutex());
+
+    std::vector<std::pair<const Link *, ignition::math::Pose3d>> links;
+    for (auto const &link : _world.SpatialIndex().LinksInSphere(
+          _center, _radius))
+    {
+      links.emplace_back(link.get(), link->WorldPose());
+    }
+    return links;
+  }
+}
+
 /////////////////////////////////////////////////
 WirelessTransmitter::WirelessTransmitter()
 : WirelessTransceiver(),
@@ -79,10 +109,24 @@ void WirelessTransmitter::Init()
 {
   WirelessTransceiver::Init();
 
-  // This ray will be used in SignalStrength() for checking obstacles
-  // between the transmitter and a given point.
-  this->dataPtr->testRay = boost::dynamic_pointer_cast<RayShape>(
-      this->world->Physics()->CreateShape("ray", CollisionPtr()));
+  // This ray will be used for checking obstacles between the transmitter
+  // and the grid points or receivers
+  this->dataPtr->testRay = CreateObstacleRay(this->world);
+
+  // Iterate using a rectangular grid, but only choose the points within
+  // a circunference of radius MaxRadius
+  this->dataPtr->gridOffsets.clear();
+  for (double x = -this->dataPtr->MaxRadius;
+       x <= this->dataPtr->MaxRadius; x += this->dataPtr->Step)
+  {
+    for (double y = -this->dataPtr->MaxRadius;
+         y <= this->dataPtr->MaxRadius; y += this->dataPtr->Step)
+    {
+      if (std::hypot(x, y) <= this->dataPtr->MaxRadius)
+        this->dataPtr->gridOffsets.emplace_back(x, y, 0.0);
+    }
+  }
+  this->dataPtr->gridValid = false;
 }
 
 //////////////////////////////////////////////////
@@ -92,38 +136,55 @@ bool WirelessTransmitter::UpdateImpl(const bool /*_force*/)
 
   if (this->dataPtr->visualize)
   {
+    const std::vector<ignition::math::Vector3d> &offsets =
+      this->dataPtr->gridOffsets;
+
+    std::vector<ignition::math::Vector3d> ends;
+    ends.reserve(offsets.size());
+    for (auto const &offset : offsets)
+      ends.push_back((ignition::math::Pose3d(offset, {}) +
+            this->referencePose).Pos());
+
+    // The obstacles of the grid only change when the transmitter or the
+    // links near it move. Only ODE reports the bounding boxes of
+    // collisions in the world frame, other engines test the grid on every
+    // update.
+    const bool cacheable = this->world->Physics()->GetType() == "ode";
+    std::vector<std::pair<const Link *, ignition::math::Pose3d>> obstacles;
+    if (cacheable)
+    {
+      obstacles = NearbyLinks(*this->world, this->referencePose.Pos(),
+          this->dataPtr->MaxRadius);
+    }
+
+    if (!this->dataPtr->gridValid ||
+        this->dataPtr->gridPose != this->referencePose ||
+        this->dataPtr->gridObstacles != obstacles)
+    {
+      const std::vector<ignition::math::Vector3d> starts(ends.size(),
+          this->referencePose.Pos());
+      Obstructed(this->world, this->dataPtr->testRay, starts, ends,
+          this->dataPtr->gridObstructed);
+
+      this->dataPtr->gridPose = this->referencePose;
+      this->dataPtr->gridObstacles = std::move(obstacles);
+      this->dataPtr->gridValid = cacheable;
+    }
+
     msgs::PropagationGrid msg;
-    ignition::math::Pose3d pos;
-    ignition::math::Pose3d worldPose;
-    double strength;
-    msgs::PropagationParticle *p;
-
-    // Iterate using a rectangular grid, but only choose the points within
-    // a circunference of radius MaxRadius
-    for (double x = -this->dataPtr->MaxRadius;
-         x <= this->dataPtr->MaxRadius; x += this->dataPtr->Step)
+    for (size_t i = 0; i < offsets.size(); ++i)
     {
-      for (double y = -this->dataPtr->MaxRadius;
-           y <= this->dataPtr->MaxRadius; y += this->dataPtr->Step)
-      {
-        pos.Set(x, y, 0.0, 0, 0, 0);
-
-        worldPose = pos + this->referencePose;
-
-        if (this->referencePose.Pos().Distance(worldPose.Pos()) <=
-            this->dataPtr->MaxRadius)
-        {
-          // For the propagation model assume the receiver antenna has the same
-          // gain as the transmitter
-          strength = this->SignalStrength(worldPose, this->Gain());
-
-          // Add a new particle to the grid
-          p = msg.add_particle();
-          p->set_x(x);
-          p->set_y(y);
-          p->set_signal_level(strength);
-        }
-      }
+      // For the propagation model assume the receiver antenna has the same
+      // gain as the transmitter
+      const double strength = this->SignalStrength(
+          ignition::math::Pose3d(ends[i], this->referencePose.Rot()),
+          this->Gain(), this->dataPtr->gridObstructed[i]);
+
+      // Add a new particle to the grid
+      msgs::PropagationParticle *p = msg.add_particle();
+      p->set_x(offsets[i].X());
+      p->set_y(offsets[i].Y());
+      p->set_signal_level(strength);
     }
     this->pub->Publish(msg);
   }
@@ -148,34 +209,21 @@ double WirelessTransmitter::SignalStrength(
     const ignition::math::Pose3d &_receiver,
     const double _rxGain)
 {
-  std::string entityName;
-  double dist;
-  ignition::math::Vector3d end = _receiver.Pos();
-  ignition::math::Vector3d start = this->referencePose.Pos();
-
-  // Avoid computing the intersection of coincident points
-  // This prevents an assertion in bullet (issue #849)
-  if (start == end)
-  {
-    end.Z() += 0.00001;
-  }
+  std::vector<bool> obstructed;
+  Obstructed(this->world, this->dataPtr->testRay,
+      {this->referencePose.Pos()}, {_receiver.Pos()}, obstructed);
 
-  // Acquire the mutex for avoiding race condition with the physics engine
-  boost::recursive_mutex::scoped_lock lock(*(
-        this->world->Physics()->GetPhysicsUpdateMutex()));
+  return this->SignalStrength(_receiver, _rxGain, obstructed[0]);
+}
 
+/////////////////////////////////////////////////
+double WirelessTransmitter::SignalStrength(
+    const ignition::math::Pose3d &_receiver,
+    const double _rxGain, const bool _obstructed)
+{
   // Compute the value of n depending on the obstacles between Tx and Rx
-  double n = WirelessTransmitterPrivate::NEmpty;
-
-  // Looking for obstacles between start and end points
-  this->dataPtr->testRay->SetPoints(start, end);
-  this->dataPtr->testRay->GetIntersection(dist, entityName);
-
-  // ToDo: The ray intersects with my own collision model. Fix it.
-  if (entityName != "")
-  {
-    n = WirelessTransmitterPrivate::NObstacle;
-  }
+  const double n = _obstructed ? WirelessTransmitterPrivate::NObstacle :
+      WirelessTransmitterPrivate::NEmpty;
 
   double distance = std::max(1.0,
       this->referencePose.Pos().Distance(_receiver.Pos()));
@@ -68,6 +68,17 @@ namespace gazebo
       public: double SignalStrength(const ignition::math::Pose3d &_receiver,
           const double _rxGain);
 
+      /// \brief Returns the signal strength in a given world's point (dBm),
+      /// when the obstacles between the transmitter and the receiver are
+      /// already known, e.g. from a batch of ray tests.
+      /// \param[in] _receiver Pose of the receiver
+      /// \param[in] _rxGain Receiver gain value
+      /// \param[in] _obstructed True if there are obstacles between the
+      /// transmitter and the receiver.
+      /// \return Signal strength in a world's point (dBm).
+      public: double SignalStrength(const ignition::math::Pose3d &_receiver,
+          const double _rxGain, const bool _obstructed);
+
       /// \brief Get the std dev of the Gaussian random variable used in the
       /// propagation model.
       /// \return The standard deviation of the propagation model.
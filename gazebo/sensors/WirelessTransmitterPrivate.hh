@@ -18,6 +18,10 @@
 #define _GAZEBO_SENSORS_WIRELESSTRANSMITTER_PRIVATE_HH_
 
 #include <string>
+#include <utility>
+#include <vector>
+#include <ignition/math/Pose3.hh>
+#include <ignition/math/Vector3.hh>
 #include "gazebo/physics/PhysicsTypes.hh"
 
 namespace gazebo
@@ -57,8 +61,28 @@ namespace gazebo
       /// \brief Reception frequency (MHz).
       public: double freq = 2442.0;
 
-      // \brief Ray used to test for collisions when placing entities
+      /// \brief Ray used to test for obstacles between the transmitter and
+      /// other points.
       public: physics::RayShapePtr testRay;
+
+      /// \brief Offsets of the grid points from the transmitter, within
+      /// MaxRadius.
+      public: std::vector<ignition::math::Vector3d> gridOffsets;
+
+      /// \brief Reference pose used to compute gridObstructed.
+      public: ignition::math::Pose3d gridPose;
+
+      /// \brief Links near the transmitter and their poses, when
+      /// gridObstructed was computed.
+      public: std::vector<std::pair<const physics::Link *,
+              ignition::math::Pose3d>> gridObstacles;
+
+      /// \brief Whether each grid point is behind an obstacle.
+      public: std::vector<bool> gridObstructed;
+
+      /// \brief True when gridObstructed can be reused while the
+      /// transmitter and the links near it do not move.
+      public: bool gridValid = false;
     };
   }
 }
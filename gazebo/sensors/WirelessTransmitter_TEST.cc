@@ -157,6 +157,14 @@ void WirelessTransmitter_TEST::TestSignalStrength()
   signStrengthAvg /= samples;
 
   EXPECT_NEAR(signStrengthAvg, -62.0, this->tx->ModelStdDev());
+
+  // Obstacles between the antennas weaken the signal
+  double obstructedAvg = 0.0;
+  for (int i = 0; i < samples; ++i)
+    obstructedAvg += this->tx->SignalStrength(txPose, tx->Gain(), true);
+  obstructedAvg /= samples;
+
+  EXPECT_LT(obstructedAvg, signStrengthAvg - this->tx->ModelStdDev());
 }
 
 /////////////////////////////////////////////////
@@ -191,6 +199,10 @@ void WirelessTransmitter_TEST::TestUpdateImpl()
 
   std::lock_guard<std::mutex> lock(this->mutex);
   EXPECT_TRUE(this->receivedMsg);
+
+  // The grid covers a circle of radius 10 with a step of 1
+  ASSERT_TRUE(this->gridMsg != nullptr);
+  EXPECT_EQ(this->gridMsg->particle_size(), 317);
 }
 
 /////////////////////////////////////////////////
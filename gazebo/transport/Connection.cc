@@ -316,12 +316,15 @@ void Connection::EnqueueMsg(const std::string &_buffer,
     {
       this->writeQueue.push_back(std::string(headerBuffer) + _buffer);
       this->callbacks.push_back({std::make_pair(_cb, _id)});
+      this->writeTimes.push_back(std::chrono::steady_clock::now());
     }
     else
     {
       this->writeQueue.back() += std::string(headerBuffer) + _buffer;
       this->callbacks.back().push_back(std::make_pair(_cb, _id));
     }
+
+    this->stats.AddQueued(HEADER_LENGTH + _buffer.size());
   }
 
   if (_force)
@@ -335,6 +338,12 @@ void Connection::EnqueueMsg(const std::string &_buffer,
   }
 }
 
+/////////////////////////////////////////////////
+const ConnectionStats &Connection::Stats() const
+{
+  return this->stats;
+}
+
 /////////////////////////////////////////////////
 void Connection::ProcessWriteQueue(bool _blocking)
 {
@@ -397,6 +406,15 @@ std::string Connection::GetRemoteURI() const
 //////////////////////////////////////////////////
 void Connection::PostWrite()
 {
+  if (!this->writeQueue.empty() && !this->writeTimes.empty())
+  {
+    this->stats.AddWritten(
+        this->callbacks.empty() ? 0 : this->callbacks.front().size(),
+        this->writeQueue.front().size(),
+        std::chrono::steady_clock::now() - this->writeTimes.front());
+    this->writeTimes.pop_front();
+  }
+
   // Call the callbacks, if not NULL
   if (!this->callbacks.empty())
   {
@@ -490,6 +508,8 @@ void Connection::Close()
   boost::recursive_mutex::scoped_lock lock2(this->writeMutex);
   this->writeQueue.clear();
   this->callbacks.clear();
+  this->writeTimes.clear();
+  this->stats.ClearBacklog();
 }
 
 //////////////////////////////////////////////////
@@ -26,6 +26,7 @@
 #include <boost/thread.hpp>
 #include <boost/tuple/tuple.hpp>
 
+#include <chrono>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -37,6 +38,7 @@
 #include "gazebo/common/Console.hh"
 #include "gazebo/common/Exception.hh"
 #include "gazebo/common/WeakBind.hh"
+#include "gazebo/transport/TransportStats.hh"
 #include "gazebo/util/system.hh"
 
 #define HEADER_LENGTH 8
@@ -333,6 +335,10 @@ namespace gazebo
       /// \return The connection's unique ID.
       public: unsigned int GetId() const;
 
+      /// \brief Get the counters of the outgoing data.
+      /// \return The counters.
+      public: const ConnectionStats &Stats() const;
+
       /// \brief Return true if the _ip is a valid.
       /// \param[in] _ip Dotted quad to validate.
       /// \return True if the _ip is a valid.
@@ -397,6 +403,13 @@ namespace gazebo
                std::pair<boost::function<void(uint32_t)>, uint32_t> > >
                  callbacks;
 
+      /// \brief Time at which the oldest message of each buffer in
+      /// writeQueue was queued.
+      private: std::deque<std::chrono::steady_clock::time_point> writeTimes;
+
+      /// \brief Counters of the outgoing data.
+      private: ConnectionStats stats;
+
       /// \brief Mutex to protect new connections.
       private: boost::mutex connectMutex;
 
@@ -305,9 +305,19 @@ void ConnectionManager::Run()
 
   this->stopped = false;
 
+  common::Time statsTime = common::Time::GetWallTime();
   while (!this->stop && this->masterConn && this->masterConn->IsOpen())
   {
     this->RunUpdate();
+
+    // Publish transport statistics once per second
+    common::Time now = common::Time::GetWallTime();
+    if (now - statsTime >= common::Time(1, 0))
+    {
+      statsTime = now;
+      TopicManager::Instance()->PublishStats();
+    }
+
     this->updateCondition.timed_wait(lock,
        boost::posix_time::milliseconds(100));
   }
@@ -547,6 +557,33 @@ void ConnectionManager::GetAllPublishers(std::list<msgs::Publish> &_publishers)
     _publishers.push_back(*iter);
 }
 
+//////////////////////////////////////////////////
+void ConnectionManager::FillStats(msgs::TransportStats &_msg)
+{
+  if (this->serverConn)
+  {
+    _msg.set_host(this->serverConn->GetLocalAddress());
+    _msg.set_port(this->serverConn->GetLocalPort());
+  }
+  else
+  {
+    _msg.set_host("");
+    _msg.set_port(0);
+  }
+
+  boost::recursive_mutex::scoped_lock lock(this->connectionMutex);
+  for (auto const &conn : this->connections)
+  {
+    if (!conn->IsOpen())
+      continue;
+
+    msgs::TransportStats::Connection *connMsg = _msg.add_connection();
+    connMsg->set_local_uri(conn->GetLocalURI());
+    connMsg->set_remote_uri(conn->GetRemoteURI());
+    conn->Stats().Fill(*connMsg);
+  }
+}
+
 //////////////////////////////////////////////////
 void ConnectionManager::GetTopicNamespaces(std::list<std::string> &_namespaces)
 {
@@ -125,6 +125,11 @@ namespace gazebo
       /// \param[out] _namespaces The list of namespace is written here
       public: void GetTopicNamespaces(std::list<std::string> &_namespaces);
 
+      /// \brief Fill the address of the transport server and the
+      /// statistics of the open connections.
+      /// \param[out] _msg Message to fill.
+      public: void FillStats(msgs::TransportStats &_msg);
+
       /// \brief Find a connection that matches a host and port
       /// \param[in] _host The host of the connection
       /// \param[in] _port The port of the connection
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_TRANSPORT_MESSAGEPOOL_HH_
+#define GAZEBO_TRANSPORT_MESSAGEPOOL_HH_
+
+#include <mutex>
+#include <vector>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace gazebo
+{
+  namespace transport
+  {
+    /// \addtogroup gazebo_transport
+    /// \{
+
+    /// \class MessagePool MessagePool.hh transport/transport.hh
+    /// \brief A pool of reference counted messages, used to publish large
+    /// messages, such as images, without allocating and copying them for
+    /// every publication.
+    ///
+    /// Acquire returns a message that is referenced by nobody else. Fill it
+    /// in, then publish it with Publisher::PublishShared, which hands the
+    /// message itself to the transport and to the local subscribers. Once
+    /// they all release it, the next Acquire reuses the message, and the
+    /// storage of its fields. Fields keep their previous values, so every
+    /// field must be set again.
+    template<typename M>
+    class MessagePool
+    {
+      /// \brief Constructor.
+      /// \param[in] _capacity Maximum number of pooled messages. Messages
+      /// acquired while all the pooled messages are in use are not pooled.
+      public: explicit MessagePool(const unsigned int _capacity = 4)
+              : capacity(_capacity)
+              {
+              }
+
+      /// \brief Get a message that is not referenced anywhere else. Thread
+      /// safe.
+      /// \return A pooled message if one is free, a new message otherwise.
+      public: boost::shared_ptr<M> Acquire()
+              {
+                std::lock_guard<std::mutex> lock(this->mutex);
+
+                // Messages only referenced by the pool are free.
+                for (auto const &msg : this->messages)
+                {
+                  if (msg.use_count() == 1)
+                  {
+                    ++this->reused;
+                    return msg;
+                  }
+                }
+
+                boost::shared_ptr<M> msg = boost::make_shared<M>();
+                if (this->messages.size() < this->capacity)
+                  this->messages.push_back(msg);
+                ++this->allocated;
+                return msg;
+              }
+
+      /// \brief Get the number of messages allocated by Acquire.
+      /// \return Number of allocated messages.
+      public: unsigned int Allocated() const
+              {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                return this->allocated;
+              }
+
+      /// \brief Get the number of pooled messages returned by Acquire.
+      /// \return Number of reused messages.
+      public: unsigned int Reused() const
+              {
+                std::lock_guard<std::mutex> lock(this->mutex);
+                return this->reused;
+              }
+
+      /// \brief Maximum number of pooled messages.
+      private: const unsigned int capacity;
+
+      /// \brief The pooled messages.
+      private: std::vector<boost::shared_ptr<M>> messages;
+
+      /// \brief Number of messages allocated by Acquire.
+      private: unsigned int allocated = 0;
+
+      /// \brief Number of pooled messages returned by Acquire.
+      private: unsigned int reused = 0;
+
+      /// \brief Protects the pool.
+      private: mutable std::mutex mutex;
+    };
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "gazebo/msgs/msgs.hh"
+#include "gazebo/transport/MessagePool.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class MessagePool : public gazebo::testing::AutoLogFixture { };
+
+/////////////////////////////////////////////////
+TEST_F(MessagePool, Reuse)
+{
+  transport::MessagePool<msgs::ImageStamped> pool(2);
+
+  // A released message is reused, along with the storage of its data
+  const char *data = nullptr;
+  {
+    auto msg = pool.Acquire();
+    msg->mutable_image()->mutable_data()->assign(1000, 'a');
+    data = msg->image().data().data();
+  }
+
+  auto first = pool.Acquire();
+  EXPECT_EQ(pool.Allocated(), 1u);
+  EXPECT_EQ(pool.Reused(), 1u);
+  first->mutable_image()->mutable_data()->assign(1000, 'b');
+  EXPECT_EQ(first->image().data().data(), data);
+
+  // Referenced messages are not reused
+  auto second = pool.Acquire();
+  EXPECT_NE(first, second);
+  EXPECT_EQ(pool.Allocated(), 2u);
+
+  // Messages beyond the capacity are not pooled
+  auto third = pool.Acquire();
+  EXPECT_NE(third, first);
+  EXPECT_NE(third, second);
+  EXPECT_EQ(pool.Allocated(), 3u);
+  third.reset();
+
+  // A message held by the transport is not reused
+  msgs::ImageStamped *secondPtr = second.get();
+  transport::MessagePtr published = second;
+  second.reset();
+  EXPECT_NE(pool.Acquire().get(), secondPtr);
+  EXPECT_EQ(pool.Allocated(), 4u);
+
+  // Until the transport releases it
+  published.reset();
+  EXPECT_EQ(pool.Acquire().get(), secondPtr);
+  EXPECT_EQ(pool.Allocated(), 4u);
+  EXPECT_EQ(pool.Reused(), 2u);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -15,6 +15,7 @@
  *
 */
 
+#include <chrono>
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
 #include "gazebo/common/WeakBind.hh"
@@ -320,7 +321,10 @@ int Publication::Publish(MessagePtr _msg, boost::function<void(uint32_t)> _cb,
     if (!this->callbacks.empty())
     {
       std::string data;
+      auto start = std::chrono::steady_clock::now();
       _msg->SerializeToString(&data);
+      this->stats.AddSerialized(data.size(),
+          std::chrono::steady_clock::now() - start);
       std::list<CallbackHelperPtr>::iterator cbIter;
       cbIter = this->callbacks.begin();
 
@@ -524,3 +528,39 @@ MessagePtr Publication::GetPrevMsg(uint32_t _pubId)
     return MessagePtr();
 }
 
+//////////////////////////////////////////////////
+PublicationStats &Publication::Stats()
+{
+  return this->stats;
+}
+
+//////////////////////////////////////////////////
+void Publication::FillStats(msgs::TransportStats::Publication &_msg) const
+{
+  _msg.set_topic(this->topic);
+  _msg.set_msg_type(this->msgType);
+  this->stats.Fill(_msg);
+
+  {
+    boost::mutex::scoped_lock lock(this->nodeMutex);
+    _msg.set_local_subscribers(this->nodes.size());
+  }
+
+  boost::mutex::scoped_lock lock(this->callbackMutex);
+  _msg.set_publishers(this->publishers.size());
+
+  unsigned int queueDepth = 0;
+  for (auto const &pub : this->publishers)
+    queueDepth += pub->GetOutgoingCount();
+  _msg.set_queue_depth(queueDepth);
+
+  for (auto const &callback : this->callbacks)
+  {
+    SubscriptionTransportPtr sub =
+      boost::dynamic_pointer_cast<SubscriptionTransport>(callback);
+    if (sub && sub->GetConnection())
+      _msg.add_connection(sub->GetConnection()->GetRemoteURI());
+    else if (callback->IsLocal())
+      _msg.set_local_subscribers(_msg.local_subscribers() + 1);
+  }
+}
@@ -30,6 +30,7 @@
 #include "gazebo/transport/CallbackHelper.hh"
 #include "gazebo/transport/TransportTypes.hh"
 #include "gazebo/transport/PublicationTransport.hh"
+#include "gazebo/transport/TransportStats.hh"
 #include "gazebo/util/system.hh"
 
 namespace gazebo
@@ -164,6 +165,15 @@ namespace gazebo
       /// \param[in,out] _pub Pointer to publisher object to be added
       public: void AddPublisher(PublisherPtr _pub);
 
+      /// \brief Get the counters of the publication, updated by its
+      /// publishers.
+      /// \return The counters.
+      public: PublicationStats &Stats();
+
+      /// \brief Fill a statistics message for the publication.
+      /// \param[out] _msg Message to fill.
+      public: void FillStats(msgs::TransportStats::Publication &_msg) const;
+
       /// \brief Remove nodes that have been marked for removal
       private: void RemoveNodes();
 
@@ -211,6 +221,9 @@ namespace gazebo
 
       /// \brief Publishers and their last messages.
       private: std::map<uint32_t, MessagePtr> prevMsgs;
+
+      /// \brief Counters of the publication.
+      private: PublicationStats stats;
     };
     /// \}
   }
@@ -86,6 +86,28 @@ bool Publisher::WaitForConnection(const common::Time &_timeout) const
 //////////////////////////////////////////////////
 void Publisher::PublishImpl(const google::protobuf::Message &_message,
                             bool _block)
+{
+  if (!this->ReadyToPublish(_message))
+    return;
+
+  // Save the latest message
+  MessagePtr msgPtr(_message.New());
+  msgPtr->CopyFrom(_message);
+
+  this->Enqueue(msgPtr, _block);
+}
+
+//////////////////////////////////////////////////
+void Publisher::PublishShared(const MessagePtr &_message, bool _block)
+{
+  if (!_message || !this->ReadyToPublish(*_message))
+    return;
+
+  this->Enqueue(_message, _block);
+}
+
+//////////////////////////////////////////////////
+bool Publisher::ReadyToPublish(const google::protobuf::Message &_message)
 {
   if (_message.GetTypeName() != this->msgType)
     gzthrow("Invalid message type\n");
@@ -95,7 +117,7 @@ void Publisher::PublishImpl(const google::protobuf::Message &_message,
     gzerr << "Publishing an uninitialized message on topic[" <<
       this->topic << "]. Required field [" <<
       _message.InitializationErrorString() << "] missing.\n";
-    return;
+    return false;
   }
 
   // Check if a throttling rate has been set
@@ -109,27 +131,31 @@ void Publisher::PublishImpl(const google::protobuf::Message &_message,
         (this->currentTime - this->prevPublishTime).Double() <
         this->updatePeriod)
     {
-      return;
+      this->publication->Stats().AddThrottled();
+      return false;
     }
 
     // Set the previous time a message was published
     this->prevPublishTime = this->currentTime;
   }
 
-  // Save the latest message
-  MessagePtr msgPtr(_message.New());
-  msgPtr->CopyFrom(_message);
+  return true;
+}
 
-  this->publication->SetPrevMsg(this->id, msgPtr);
+//////////////////////////////////////////////////
+void Publisher::Enqueue(const MessagePtr &_msgPtr, bool _block)
+{
+  this->publication->SetPrevMsg(this->id, _msgPtr);
 
   {
     boost::mutex::scoped_lock lock(this->mutex);
 
-    this->messages.push_back(msgPtr);
+    this->messages.push_back(_msgPtr);
 
     if (this->messages.size() > this->queueLimit)
     {
       this->messages.pop_front();
+      this->publication->Stats().AddDropped();
 
       if (!queueLimitWarned)
       {
@@ -140,6 +166,8 @@ void Publisher::PublishImpl(const google::protobuf::Message &_message,
         queueLimitWarned = true;
       }
     }
+
+    this->publication->Stats().AddPublished(this->messages.size());
   }
 
   TopicManager::Instance()->AddNodeToProcess(this->node);
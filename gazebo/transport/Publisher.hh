@@ -101,6 +101,16 @@ namespace gazebo
               void Publish(M _message, bool _block = false)
               { this->PublishImpl(_message, _block); }
 
+      /// \brief Publish a message without copying it. The publisher and
+      /// the local subscribers keep a reference to the message, so it must
+      /// not be modified once published. See MessagePool for a way to reuse
+      /// the message and its storage once they release it.
+      /// \param[in] _message Message to be published
+      /// \param[in] _block Whether to block until the message is actually
+      /// written into the local message buffer, see Publish.
+      public: void PublishShared(const MessagePtr &_message,
+                  bool _block = false);
+
       /// \brief Get the number of outgoing messages
       /// \return The number of outgoing messages
       public: unsigned int GetOutgoingCount() const;
@@ -147,6 +157,18 @@ namespace gazebo
       private: void PublishImpl(const google::protobuf::Message &_message,
                                 bool _block);
 
+      /// \brief Check a message, and apply the throttling rate.
+      /// \param[in] _message Message to be published.
+      /// \return True if the message should be published now.
+      private: bool ReadyToPublish(const google::protobuf::Message &_message);
+
+      /// \brief Queue a message for publication.
+      /// \param[in] _msgPtr Message to be published, owned by the publisher
+      /// and the subscribers from now on.
+      /// \param[in] _block Whether to block until the message is actually
+      /// written out.
+      private: void Enqueue(const MessagePtr &_msgPtr, bool _block);
+
       /// \brief Callback when a publish is completed
       /// \param[in] _id ID associated with the publication.
       private: void OnPublishComplete(uint32_t _id);
@@ -26,6 +26,8 @@
 using namespace gazebo;
 using namespace transport;
 
+const std::string TopicManager::StatsTopic = "/gazebo/transport/stats";
+
 /// \brief Class to facilitate parallel processing of nodes.
 class NodeProcess_TBB
 {
@@ -68,8 +70,11 @@ TopicManager::~TopicManager()
 //////////////////////////////////////////////////
 void TopicManager::Init()
 {
-  this->advertisedTopics.clear();
-  this->advertisedTopicsEnd = this->advertisedTopics.end();
+  {
+    boost::recursive_mutex::scoped_lock lock(this->advertisedTopicsMutex);
+    this->advertisedTopics.clear();
+    this->advertisedTopicsEnd = this->advertisedTopics.end();
+  }
   this->subscribedNodes.clear();
   this->nodes.clear();
 }
@@ -77,19 +82,28 @@ void TopicManager::Init()
 //////////////////////////////////////////////////
 void TopicManager::Fini()
 {
+  this->statsPub.reset();
+  this->statsNode.reset();
+
   // These two lines make sure that pending messages get sent out
   this->ProcessNodes(true);
   // ConnectionManager::Instance()->RunUpdate();
 
-  PublicationPtr_M::iterator iter;
-  for (iter = this->advertisedTopics.begin();
-       iter != this->advertisedTopics.end(); ++iter)
+  std::vector<std::string> topics;
   {
-    this->Unadvertise(iter->first);
+    boost::recursive_mutex::scoped_lock lock(this->advertisedTopicsMutex);
+    for (auto const &iter : this->advertisedTopics)
+      topics.push_back(iter.first);
   }
 
-  this->advertisedTopics.clear();
-  this->advertisedTopicsEnd = this->advertisedTopics.end();
+  for (auto const &topic : topics)
+    this->Unadvertise(topic);
+
+  {
+    boost::recursive_mutex::scoped_lock lock(this->advertisedTopicsMutex);
+    this->advertisedTopics.clear();
+    this->advertisedTopicsEnd = this->advertisedTopics.end();
+  }
   this->subscribedNodes.clear();
   this->nodes.clear();
 }
@@ -112,10 +126,11 @@ void TopicManager::RemoveNode(unsigned int _id)
     if ((*iter)->GetId() == _id)
     {
       // Remove the node from all publications.
-      for (PublicationPtr_M::iterator piter = this->advertisedTopics.begin();
-           piter != this->advertisedTopics.end(); ++piter)
       {
-        piter->second->RemoveSubscription(*iter);
+        boost::recursive_mutex::scoped_lock topicsLock(
+            this->advertisedTopicsMutex);
+        for (auto const &piter : this->advertisedTopics)
+          piter.second->RemoveSubscription(*iter);
       }
 
       // Remove the node from all subscriptions.
@@ -216,6 +231,7 @@ void TopicManager::Publish(const std::string &_topic, MessagePtr _message,
 //////////////////////////////////////////////////
 PublicationPtr TopicManager::FindPublication(const std::string &_topic)
 {
+  boost::recursive_mutex::scoped_lock lock(this->advertisedTopicsMutex);
   PublicationPtr_M::iterator iter = this->advertisedTopics.find(_topic);
   if (iter != this->advertisedTopicsEnd)
     return iter->second;
@@ -367,6 +383,10 @@ void TopicManager::ConnectSubToPub(const msgs::Publish &_pub)
 PublicationPtr TopicManager::UpdatePublications(const std::string &_topic,
                                                 const std::string &_msgType)
 {
+  // Finding and adding the publication is atomic, so concurrent
+  // advertisements of a topic share one publication
+  boost::recursive_mutex::scoped_lock lock(this->advertisedTopicsMutex);
+
   // Find a current publication on this topic
   PublicationPtr pub = this->FindPublication(_topic);
 
@@ -444,6 +464,7 @@ void TopicManager::GetTopicNamespaces(std::list<std::string> &_namespaces)
 //////////////////////////////////////////////////
 void TopicManager::ClearBuffers()
 {
+  boost::recursive_mutex::scoped_lock lock(this->advertisedTopicsMutex);
   for (auto iter : this->advertisedTopics)
     iter.second->ClearPrevMsgs();
 }
@@ -453,3 +474,42 @@ void TopicManager::PauseIncoming(bool _pause)
 {
   this->pauseIncoming = _pause;
 }
+
+//////////////////////////////////////////////////
+void TopicManager::PublishStats()
+{
+  if (!this->statsPub)
+  {
+    // Join an existing namespace, rather than registering one that would
+    // be mistaken for a world
+    std::list<std::string> namespaces;
+    this->GetTopicNamespaces(namespaces);
+    if (namespaces.empty())
+      return;
+
+    this->statsNode.reset(new Node());
+    this->statsNode->Init(namespaces.front());
+    this->statsPub =
+      this->statsNode->Advertise<msgs::TransportStats>(StatsTopic, 10);
+  }
+
+  // Copy the publications under the lock, so their stats are filled
+  // without blocking Advertise
+  std::vector<PublicationPtr> publications;
+  {
+    boost::recursive_mutex::scoped_lock lock(this->advertisedTopicsMutex);
+    publications.reserve(this->advertisedTopics.size());
+    for (auto const &iter : this->advertisedTopics)
+    {
+      if (iter.second->GetLocallyAdvertised())
+        publications.push_back(iter.second);
+    }
+  }
+
+  msgs::TransportStats msg;
+  ConnectionManager::Instance()->FillStats(msg);
+  for (auto const &publication : publications)
+    publication->FillStats(*msg.add_publication());
+
+  this->statsPub->Publish(msg);
+}
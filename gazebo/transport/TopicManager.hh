@@ -240,12 +240,25 @@ namespace gazebo
       /// \param[in] _ptr Node to process.
       public: void AddNodeToProcess(NodePtr _ptr);
 
+      /// \brief Publish the statistics of the publications and connections
+      /// of this process on StatsTopic. The topic is advertised on the first
+      /// call made once a topic namespace is known.
+      public: void PublishStats();
+
+      /// \brief Topic on which the transport statistics of each process
+      /// are published, as msgs::TransportStats.
+      public: static const std::string StatsTopic;
+
       /// \brief A map of string->list of Node pointers
       typedef std::map<std::string, std::list<NodePtr> > SubNodeMap;
 
       private: typedef std::map<std::string, PublicationPtr> PublicationPtr_M;
       private: PublicationPtr_M advertisedTopics;
       private: PublicationPtr_M::iterator advertisedTopicsEnd;
+
+      /// \brief Protects advertisedTopics, which Advertise modifies from
+      /// any thread.
+      private: boost::recursive_mutex advertisedTopicsMutex;
       private: SubNodeMap subscribedNodes;
       private: std::vector<NodePtr> nodes;
 
@@ -262,6 +275,12 @@ namespace gazebo
 
       private: bool pauseIncoming;
 
+      /// \brief Node used to publish the transport statistics.
+      private: NodePtr statsNode;
+
+      /// \brief Publisher of the transport statistics.
+      private: PublisherPtr statsPub;
+
       // Singleton implementation
       private: friend class SingletonT<TopicManager>;
     };
@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <algorithm>
+#include <cmath>
+
+#include "gazebo/transport/TransportStats.hh"
+
+using namespace gazebo;
+using namespace transport;
+
+namespace
+{
+  /// \brief Nanoseconds to seconds.
+  const double kNsToSec = 1e-9;
+
+  /// \brief Raise an atomic maximum.
+  /// \param[in,out] _max The maximum.
+  /// \param[in] _value New value.
+  void UpdateMax(std::atomic<uint64_t> &_max, const uint64_t _value)
+  {
+    uint64_t max = _max.load(std::memory_order_relaxed);
+    while (_value > max && !_max.compare_exchange_weak(
+          max, _value, std::memory_order_relaxed))
+    {
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+LatencyHistogram::LatencyHistogram()
+  : maxNs(0)
+{
+  for (auto &bucket : this->buckets)
+    bucket.store(0, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void LatencyHistogram::Add(
+    const std::chrono::steady_clock::duration &_duration)
+{
+  const uint64_t ns = static_cast<uint64_t>(std::max<int64_t>(0,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+          _duration).count()));
+
+  // Relaxed atomics are enough: readers only need a recent value of each
+  // counter, not a consistent snapshot of all of them.
+  this->buckets[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+  UpdateMax(this->maxNs, ns);
+}
+
+//////////////////////////////////////////////////
+unsigned int LatencyHistogram::BucketIndex(const uint64_t _ns)
+{
+  unsigned int index = 0;
+  for (uint64_t us = _ns / 1000; us > 0 && index < BucketCount - 1; us >>= 1)
+    ++index;
+  return index;
+}
+
+//////////////////////////////////////////////////
+uint64_t LatencyHistogram::Count() const
+{
+  uint64_t count = 0;
+  for (auto const &bucket : this->buckets)
+    count += bucket.load(std::memory_order_relaxed);
+  return count;
+}
+
+//////////////////////////////////////////////////
+uint64_t LatencyHistogram::Bucket(const unsigned int _index) const
+{
+  if (_index >= BucketCount)
+    return 0;
+  return this->buckets[_index].load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+double LatencyHistogram::Percentile(const double _p) const
+{
+  std::array<uint64_t, BucketCount> counts;
+  uint64_t total = 0;
+  for (unsigned int i = 0; i < BucketCount; ++i)
+  {
+    counts[i] = this->buckets[i].load(std::memory_order_relaxed);
+    total += counts[i];
+  }
+
+  if (total == 0)
+    return 0;
+
+  const double p = std::max(0.0, std::min(1.0, _p));
+  const uint64_t rank = std::max<uint64_t>(1,
+      static_cast<uint64_t>(std::ceil(p * total)));
+
+  uint64_t cumulative = 0;
+  unsigned int index = 0;
+  for (; index < BucketCount - 1; ++index)
+  {
+    cumulative += counts[index];
+    if (cumulative >= rank)
+      break;
+  }
+
+  // Bucket i ends at 2^i microseconds. The last bucket has no end.
+  const double max = this->Max();
+  if (index == BucketCount - 1)
+    return max;
+  return std::min(max, std::ldexp(1e-6, index));
+}
+
+//////////////////////////////////////////////////
+double LatencyHistogram::Max() const
+{
+  return kNsToSec * this->maxNs.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void LatencyHistogram::Fill(msgs::TransportStats::Histogram &_msg) const
+{
+  _msg.clear_bucket();
+  uint64_t count = 0;
+  for (auto const &bucket : this->buckets)
+  {
+    const uint64_t value = bucket.load(std::memory_order_relaxed);
+    _msg.add_bucket(value);
+    count += value;
+  }
+  _msg.set_count(count);
+  _msg.set_p50(this->Percentile(0.5));
+  _msg.set_p99(this->Percentile(0.99));
+  _msg.set_max(this->Max());
+}
+
+//////////////////////////////////////////////////
+PublicationStats::PublicationStats()
+  : published(0), throttled(0), dropped(0), maxQueueDepth(0),
+    serializedBytes(0)
+{
+}
+
+//////////////////////////////////////////////////
+void PublicationStats::AddPublished(const unsigned int _queueDepth)
+{
+  this->published.fetch_add(1, std::memory_order_relaxed);
+  UpdateMax(this->maxQueueDepth, _queueDepth);
+}
+
+//////////////////////////////////////////////////
+void PublicationStats::AddThrottled()
+{
+  this->throttled.fetch_add(1, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void PublicationStats::AddDropped()
+{
+  this->dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void PublicationStats::AddSerialized(const uint64_t _bytes,
+    const std::chrono::steady_clock::duration &_time)
+{
+  this->serializedBytes.fetch_add(_bytes, std::memory_order_relaxed);
+  this->serializeTime.Add(_time);
+}
+
+//////////////////////////////////////////////////
+uint64_t PublicationStats::Published() const
+{
+  return this->published.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+uint64_t PublicationStats::Dropped() const
+{
+  return this->dropped.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void PublicationStats::Fill(msgs::TransportStats::Publication &_msg) const
+{
+  _msg.set_published(this->published.load(std::memory_order_relaxed));
+  _msg.set_throttled(this->throttled.load(std::memory_order_relaxed));
+  _msg.set_dropped(this->dropped.load(std::memory_order_relaxed));
+  _msg.set_max_queue_depth(
+      this->maxQueueDepth.load(std::memory_order_relaxed));
+  _msg.set_serialized_bytes(
+      this->serializedBytes.load(std::memory_order_relaxed));
+  this->serializeTime.Fill(*_msg.mutable_serialize_time());
+}
+
+//////////////////////////////////////////////////
+ConnectionStats::ConnectionStats()
+  : messages(0), bytes(0), backlogMessages(0), backlogBytes(0),
+    maxBacklogBytes(0)
+{
+}
+
+//////////////////////////////////////////////////
+void ConnectionStats::AddQueued(const uint64_t _bytes)
+{
+  this->messages.fetch_add(1, std::memory_order_relaxed);
+  this->bytes.fetch_add(_bytes, std::memory_order_relaxed);
+  this->backlogMessages.fetch_add(1, std::memory_order_relaxed);
+  UpdateMax(this->maxBacklogBytes,
+      this->backlogBytes.fetch_add(_bytes, std::memory_order_relaxed) +
+      _bytes);
+}
+
+//////////////////////////////////////////////////
+void ConnectionStats::AddWritten(const uint64_t _messages,
+    const uint64_t _bytes, const std::chrono::steady_clock::duration &_time)
+{
+  this->backlogMessages.fetch_sub(_messages, std::memory_order_relaxed);
+  this->backlogBytes.fetch_sub(_bytes, std::memory_order_relaxed);
+  this->writeTime.Add(_time);
+}
+
+//////////////////////////////////////////////////
+void ConnectionStats::ClearBacklog()
+{
+  this->backlogMessages.store(0, std::memory_order_relaxed);
+  this->backlogBytes.store(0, std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+uint64_t ConnectionStats::BacklogBytes() const
+{
+  return this->backlogBytes.load(std::memory_order_relaxed);
+}
+
+//////////////////////////////////////////////////
+void ConnectionStats::Fill(msgs::TransportStats::Connection &_msg) const
+{
+  _msg.set_messages(this->messages.load(std::memory_order_relaxed));
+  _msg.set_bytes(this->bytes.load(std::memory_order_relaxed));
+  _msg.set_backlog_messages(
+      this->backlogMessages.load(std::memory_order_relaxed));
+  _msg.set_backlog_bytes(this->backlogBytes.load(std::memory_order_relaxed));
+  _msg.set_max_backlog_bytes(
+      this->maxBacklogBytes.load(std::memory_order_relaxed));
+  this->writeTime.Fill(*_msg.mutable_write_time());
+}
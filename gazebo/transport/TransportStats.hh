@@ -0,0 +1,194 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_TRANSPORT_TRANSPORTSTATS_HH_
+#define GAZEBO_TRANSPORT_TRANSPORTSTATS_HH_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "gazebo/msgs/msgs.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  namespace transport
+  {
+    /// \addtogroup gazebo_transport
+    /// \{
+
+    /// \class LatencyHistogram TransportStats.hh transport/transport.hh
+    /// \brief Histogram of durations with power of two buckets, updated
+    /// without locks. Bucket 0 counts durations under 1 microsecond,
+    /// bucket i durations in [2^(i-1), 2^i) microseconds, and the last
+    /// bucket all the longer durations.
+    class GZ_TRANSPORT_VISIBLE LatencyHistogram
+    {
+      /// \brief Number of buckets. The last one starts at about 4 seconds.
+      public: static const unsigned int BucketCount = 24;
+
+      /// \brief Constructor.
+      public: LatencyHistogram();
+
+      /// \brief Add a sample. Safe to call from any thread.
+      /// \param[in] _duration Duration to add.
+      public: void Add(const std::chrono::steady_clock::duration &_duration);
+
+      /// \brief Get the number of samples.
+      /// \return Number of samples.
+      public: uint64_t Count() const;
+
+      /// \brief Get the number of samples in a bucket.
+      /// \param[in] _index Index of the bucket.
+      /// \return Number of samples, 0 if the index is out of range.
+      public: uint64_t Bucket(const unsigned int _index) const;
+
+      /// \brief Get a percentile of the durations.
+      /// \param[in] _p Percentile in the range [0, 1], e.g. 0.99.
+      /// \return Upper bound of the bucket holding the percentile, capped
+      /// by the longest duration, in seconds. 0 if there are no samples.
+      public: double Percentile(const double _p) const;
+
+      /// \brief Get the longest duration.
+      /// \return Longest duration in seconds.
+      public: double Max() const;
+
+      /// \brief Fill a histogram message.
+      /// \param[out] _msg Message to fill.
+      public: void Fill(msgs::TransportStats::Histogram &_msg) const;
+
+      /// \brief Get the bucket of a duration.
+      /// \param[in] _ns Duration in nanoseconds.
+      /// \return Index of the bucket.
+      public: static unsigned int BucketIndex(const uint64_t _ns);
+
+      /// \brief Samples per bucket.
+      private: std::array<std::atomic<uint64_t>, BucketCount> buckets;
+
+      /// \brief Longest duration in nanoseconds.
+      private: std::atomic<uint64_t> maxNs;
+    };
+
+    /// \class PublicationStats TransportStats.hh transport/transport.hh
+    /// \brief Counters of a publication, updated by its publishers without
+    /// locks.
+    class GZ_TRANSPORT_VISIBLE PublicationStats
+    {
+      /// \brief Constructor.
+      public: PublicationStats();
+
+      /// \brief Count a message queued by a publisher.
+      /// \param[in] _queueDepth Number of messages in the publisher's queue,
+      /// including this one.
+      public: void AddPublished(const unsigned int _queueDepth);
+
+      /// \brief Count a message skipped by a publisher's rate limit.
+      public: void AddThrottled();
+
+      /// \brief Count a message dropped from a publisher's full queue.
+      public: void AddDropped();
+
+      /// \brief Count a message serialization.
+      /// \param[in] _bytes Size of the serialized message.
+      /// \param[in] _time Time spent serializing.
+      public: void AddSerialized(const uint64_t _bytes,
+                  const std::chrono::steady_clock::duration &_time);
+
+      /// \brief Get the number of messages queued by the publishers.
+      /// \return Number of messages.
+      public: uint64_t Published() const;
+
+      /// \brief Get the number of messages dropped from full queues.
+      /// \return Number of messages.
+      public: uint64_t Dropped() const;
+
+      /// \brief Fill the counters of a publication message.
+      /// \param[out] _msg Message to fill.
+      public: void Fill(msgs::TransportStats::Publication &_msg) const;
+
+      /// \brief Number of messages queued by the publishers.
+      private: std::atomic<uint64_t> published;
+
+      /// \brief Number of messages skipped by the rate limits.
+      private: std::atomic<uint64_t> throttled;
+
+      /// \brief Number of messages dropped from full queues.
+      private: std::atomic<uint64_t> dropped;
+
+      /// \brief Largest number of messages in a publisher's queue.
+      private: std::atomic<uint64_t> maxQueueDepth;
+
+      /// \brief Number of serialized bytes.
+      private: std::atomic<uint64_t> serializedBytes;
+
+      /// \brief Serialization times.
+      private: LatencyHistogram serializeTime;
+    };
+
+    /// \class ConnectionStats TransportStats.hh transport/transport.hh
+    /// \brief Counters of the outgoing data of a connection.
+    class GZ_TRANSPORT_VISIBLE ConnectionStats
+    {
+      /// \brief Constructor.
+      public: ConnectionStats();
+
+      /// \brief Count a message queued for writing.
+      /// \param[in] _bytes Size of the message, including its header.
+      public: void AddQueued(const uint64_t _bytes);
+
+      /// \brief Count a completed write.
+      /// \param[in] _messages Number of messages written.
+      /// \param[in] _bytes Number of bytes written.
+      /// \param[in] _time Time since the oldest message was queued.
+      public: void AddWritten(const uint64_t _messages, const uint64_t _bytes,
+                  const std::chrono::steady_clock::duration &_time);
+
+      /// \brief Forget the messages waiting to be written, when the queue
+      /// is cleared.
+      public: void ClearBacklog();
+
+      /// \brief Get the number of bytes waiting to be written.
+      /// \return Number of bytes.
+      public: uint64_t BacklogBytes() const;
+
+      /// \brief Fill the counters of a connection message.
+      /// \param[out] _msg Message to fill.
+      public: void Fill(msgs::TransportStats::Connection &_msg) const;
+
+      /// \brief Number of messages queued.
+      private: std::atomic<uint64_t> messages;
+
+      /// \brief Number of bytes queued.
+      private: std::atomic<uint64_t> bytes;
+
+      /// \brief Number of messages waiting to be written.
+      private: std::atomic<uint64_t> backlogMessages;
+
+      /// \brief Number of bytes waiting to be written.
+      private: std::atomic<uint64_t> backlogBytes;
+
+      /// \brief Largest number of bytes waiting to be written.
+      private: std::atomic<uint64_t> maxBacklogBytes;
+
+      /// \brief Write times.
+      private: LatencyHistogram writeTime;
+    };
+    /// \}
+  }
+}
+#endif
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "gazebo/transport/TransportStats.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class TransportStats : public gazebo::testing::AutoLogFixture { };
+
+/////////////////////////////////////////////////
+TEST_F(TransportStats, Buckets)
+{
+  using transport::LatencyHistogram;
+
+  EXPECT_EQ(LatencyHistogram::BucketIndex(0), 0u);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(999), 0u);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(1000), 1u);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(1999), 1u);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(2000), 2u);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(1000000), 10u);
+  EXPECT_EQ(LatencyHistogram::BucketIndex(3600000000000ull),
+      LatencyHistogram::BucketCount - 1);
+}
+
+/////////////////////////////////////////////////
+TEST_F(TransportStats, Histogram)
+{
+  transport::LatencyHistogram hist;
+  EXPECT_EQ(hist.Count(), 0u);
+  EXPECT_DOUBLE_EQ(hist.Percentile(0.5), 0.0);
+
+  // 98 samples of 3 us, 2 of 1.5 ms
+  for (int i = 0; i < 98; ++i)
+    hist.Add(std::chrono::microseconds(3));
+  hist.Add(std::chrono::microseconds(1500));
+  hist.Add(std::chrono::microseconds(1500));
+
+  EXPECT_EQ(hist.Count(), 100u);
+  EXPECT_EQ(hist.Bucket(2), 98u);
+  EXPECT_EQ(hist.Bucket(11), 2u);
+  EXPECT_EQ(hist.Bucket(transport::LatencyHistogram::BucketCount), 0u);
+
+  // Percentiles are rounded up to the end of their bucket
+  EXPECT_DOUBLE_EQ(hist.Percentile(0.5), 4e-6);
+  EXPECT_DOUBLE_EQ(hist.Percentile(0.98), 4e-6);
+
+  // But not beyond the longest duration
+  EXPECT_DOUBLE_EQ(hist.Percentile(0.99), 1.5e-3);
+  EXPECT_DOUBLE_EQ(hist.Max(), 1.5e-3);
+
+  msgs::TransportStats::Histogram msg;
+  hist.Fill(msg);
+  EXPECT_EQ(msg.bucket_size(),
+      static_cast<int>(transport::LatencyHistogram::BucketCount));
+  EXPECT_EQ(msg.count(), 100u);
+  EXPECT_EQ(msg.bucket(2), 98u);
+  EXPECT_DOUBLE_EQ(msg.p50(), 4e-6);
+  EXPECT_DOUBLE_EQ(msg.max(), 1.5e-3);
+}
+
+/////////////////////////////////////////////////
+TEST_F(TransportStats, Concurrent)
+{
+  transport::PublicationStats stats;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.push_back(std::thread([&stats, t]()
+    {
+      for (unsigned int i = 0; i < 10000; ++i)
+      {
+        stats.AddPublished(t + 1);
+        stats.AddSerialized(10, std::chrono::microseconds(5));
+      }
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(stats.Published(), 40000u);
+
+  msgs::TransportStats::Publication msg;
+  msg.set_topic("/test");
+  msg.set_msg_type("gazebo.msgs.Test");
+  msg.set_publishers(1);
+  msg.set_local_subscribers(0);
+  msg.set_queue_depth(0);
+  stats.Fill(msg);
+  EXPECT_EQ(msg.published(), 40000u);
+  EXPECT_EQ(msg.dropped(), 0u);
+  EXPECT_EQ(msg.max_queue_depth(), 4u);
+  EXPECT_EQ(msg.serialized_bytes(), 400000u);
+  EXPECT_EQ(msg.serialize_time().count(), 40000u);
+  EXPECT_TRUE(msg.IsInitialized());
+}
+
+/////////////////////////////////////////////////
+TEST_F(TransportStats, Backlog)
+{
+  transport::ConnectionStats stats;
+
+  stats.AddQueued(100);
+  stats.AddQueued(50);
+  stats.AddQueued(300);
+  EXPECT_EQ(stats.BacklogBytes(), 450u);
+
+  // The first two messages were written together
+  stats.AddWritten(2, 150, std::chrono::milliseconds(2));
+  EXPECT_EQ(stats.BacklogBytes(), 300u);
+
+  msgs::TransportStats::Connection msg;
+  msg.set_local_uri("http://localhost:1");
+  msg.set_remote_uri("http://localhost:2");
+  stats.Fill(msg);
+  EXPECT_EQ(msg.messages(), 3u);
+  EXPECT_EQ(msg.bytes(), 450u);
+  EXPECT_EQ(msg.backlog_messages(), 1u);
+  EXPECT_EQ(msg.backlog_bytes(), 300u);
+  EXPECT_EQ(msg.max_backlog_bytes(), 450u);
+  EXPECT_EQ(msg.write_time().count(), 1u);
+  EXPECT_DOUBLE_EQ(msg.write_time().max(), 2e-3);
+  EXPECT_TRUE(msg.IsInitialized());
+
+  // A closed connection has no backlog
+  stats.ClearBacklog();
+  EXPECT_EQ(stats.BacklogBytes(), 0u);
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -728,15 +728,30 @@ bool LogPlayPrivate::ChunkData(
     gzthrow("Encoding missing for a chunk in log file[" + this->filename + "]");
   }
 
-  if (this->encoding == "txt")
-    _data = _xml->GetText();
-  else if (this->encoding == "bz2")
+  if (this->encoding != "txt" && this->encoding != "bz2" &&
+      this->encoding != "zlib")
+  {
+    gzerr << "Invalid encoding[" << this->encoding << "] in log file["
+      << this->filename << "]\n";
+    return false;
+  }
+
+  const char *text = _xml->GetText();
+  return LogPlay::DecodeChunk(this->encoding, text ? text : "", _data);
+}
+
+/////////////////////////////////////////////////
+bool LogPlay::DecodeChunk(const std::string &_encoding,
+    const std::string &_data, std::string &_decoded)
+{
+  if (_encoding == "txt")
+    _decoded = _data;
+  else if (_encoding == "bz2")
   {
-    std::string data = _xml->GetText();
     std::string buffer;
 
     // Decode the base64 string
-    buffer = Base64Decode(data);
+    buffer = Base64Decode(_data);
 
     // Decompress the bz2 data
     {
@@ -745,17 +760,16 @@ bool LogPlayPrivate::ChunkData(
       in.push(boost::make_iterator_range(buffer));
 
       // Get the data
-      std::getline(in, _data, '\0');
-      _data += '\0';
+      std::getline(in, _decoded, '\0');
+      _decoded += '\0';
     }
   }
-  else if (this->encoding == "zlib")
+  else if (_encoding == "zlib")
   {
-    std::string data = _xml->GetText();
     std::string buffer;
 
     // Decode the base64 string
-    buffer = Base64Decode(data);
+    buffer = Base64Decode(_data);
 
     // Decompress the zlib data
     {
@@ -764,14 +778,13 @@ bool LogPlayPrivate::ChunkData(
       in.push(boost::make_iterator_range(buffer));
 
       // Get the data
-      std::getline(in, _data, '\0');
-      _data += '\0';
+      std::getline(in, _decoded, '\0');
+      _decoded += '\0';
     }
   }
   else
   {
-    gzerr << "Invalid encoding[" << this->encoding << "] in log file["
-      << this->filename << "]\n";
+    gzerr << "Invalid encoding[" << _encoding << "]\n";
     return false;
   }
 
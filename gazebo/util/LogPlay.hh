@@ -140,6 +140,16 @@ namespace gazebo
       /// \return True if the _index was valid.
       public: bool Chunk(const unsigned int _index, std::string &_data) const;
 
+      /// \brief Decode the data of a chunk, as it is stored in a log file.
+      /// This is what Chunk returns, but it does not need an open log, so
+      /// chunks can be decoded by other threads. Thread safe.
+      /// \param[in] _encoding Encoding of the chunk (txt, zlib or bz2).
+      /// \param[in] _data Encoded data of the chunk.
+      /// \param[out] _decoded Storage for the chunk's data.
+      /// \return True if the encoding is valid.
+      public: static bool DecodeChunk(const std::string &_encoding,
+                  const std::string &_data, std::string &_decoded);
+
       /// \brief Get the type of encoding used for current chunck in the
       /// open log file.
       /// \return The type of encoding. An empty string will be returned if
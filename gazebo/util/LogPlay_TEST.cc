@@ -17,8 +17,12 @@
 
 #include <gtest/gtest.h>
 #include <boost/filesystem.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/zlib.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
 #include <string>
 #include <thread>
+#include "gazebo/common/Base64.hh"
 #include "gazebo/common/CommonIface.hh"
 #include "gazebo/common/Time.hh"
 #include "gazebo/util/LogPlay.hh"
@@ -146,6 +150,33 @@ TEST_F(LogPlay_TEST, Chunks)
   EXPECT_FALSE(player->Chunk(player->ChunkCount(), chunk));
 }
 
+/////////////////////////////////////////////////
+/// \brief Test decoding chunks outside of LogPlay.
+TEST_F(LogPlay_TEST, DecodeChunk)
+{
+  const std::string data = "<sdf version='1.6'></sdf>";
+  std::string decoded;
+
+  EXPECT_TRUE(gazebo::util::LogPlay::DecodeChunk("txt", data, decoded));
+  EXPECT_EQ(decoded, data);
+
+  // Compressed chunks are base64 encoded and end with a null character
+  std::string compressed, encoded;
+  {
+    boost::iostreams::filtering_ostream out;
+    out.push(boost::iostreams::zlib_compressor());
+    out.push(std::back_inserter(compressed));
+    boost::iostreams::copy(boost::make_iterator_range(data), out);
+  }
+  Base64Encode(compressed.c_str(),
+      static_cast<unsigned int>(compressed.size()), encoded);
+
+  EXPECT_TRUE(gazebo::util::LogPlay::DecodeChunk("zlib", encoded, decoded));
+  EXPECT_EQ(decoded, data + '\0');
+
+  EXPECT_FALSE(gazebo::util::LogPlay::DecodeChunk("rot13", data, decoded));
+}
+
 /////////////////////////////////////////////////
 /// \brief Test Rewind().
 TEST_F(LogPlay_TEST, Rewind)
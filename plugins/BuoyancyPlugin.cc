@@ -15,15 +15,53 @@
  *
 */
 
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
 #include "ignition/common/Profiler.hh"
 #include "gazebo/common/Assert.hh"
 #include "gazebo/common/Events.hh"
 #include "plugins/BuoyancyPlugin.hh"
+#include "plugins/FluidForces.hh"
 
 using namespace gazebo;
 
 GZ_REGISTER_MODEL_PLUGIN(BuoyancyPlugin)
 
+namespace
+{
+  // TODO added here for ABI compatibility
+  // move to BuoyancyPlugin.hh as private members when merging forward
+  /// \brief Volumes a buoyancy plugin registered with the FluidForces
+  /// service.
+  struct FluidVolumes
+  {
+    /// \brief World fluid forces service the volumes are registered with.
+    std::shared_ptr<FluidForces> service;
+
+    /// \brief Volume handles, indexed by link ID.
+    std::map<int, std::size_t> handles;
+  };
+
+  /// \brief Registered volumes of all buoyancy plugins.
+  std::map<const BuoyancyPlugin *, FluidVolumes> fluidVolumes;
+
+  /// \brief Protects fluidVolumes.
+  std::mutex fluidVolumesMutex;
+
+  /// \brief Get the registered volumes of a plugin, creating them if
+  /// needed.
+  /// \param[in] _plugin Plugin to get the volumes of.
+  /// \return The registered volumes.
+  FluidVolumes &Volumes(const BuoyancyPlugin *_plugin)
+  {
+    std::lock_guard<std::mutex> lock(fluidVolumesMutex);
+    return fluidVolumes[_plugin];
+  }
+}
+
 /////////////////////////////////////////////////
 BuoyancyPlugin::BuoyancyPlugin()
   // Density of liquid water at 1 atm pressure and 15 degrees Celsius.
@@ -31,6 +69,21 @@ BuoyancyPlugin::BuoyancyPlugin()
 {
 }
 
+/////////////////////////////////////////////////
+BuoyancyPlugin::~BuoyancyPlugin()
+{
+  this->updateConnection.reset();
+
+  std::lock_guard<std::mutex> lock(fluidVolumesMutex);
+  auto volumes = fluidVolumes.find(this);
+  if (volumes == fluidVolumes.end())
+    return;
+
+  for (auto handle : volumes->second.handles)
+    volumes->second.service->RemoveVolume(handle.second);
+  fluidVolumes.erase(volumes);
+}
+
 /////////////////////////////////////////////////
 void BuoyancyPlugin::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
 {
@@ -147,6 +200,20 @@ void BuoyancyPlugin::Load(physics::ModelPtr _model, sdf::ElementPtr _sdf)
 /////////////////////////////////////////////////
 void BuoyancyPlugin::Init()
 {
+  // Get the service before connecting, so that it computes the forces of
+  // each step before OnUpdate applies them.
+  FluidVolumes &volumes = Volumes(this);
+  volumes.service = FluidForces::Instance(this->model->GetWorld());
+  for (auto link : this->model->GetLinks())
+  {
+    const int id = link->GetId();
+    if (volumes.handles.count(id) != 0)
+      continue;
+
+    volumes.handles[id] = volumes.service->AddVolume(link,
+        this->volPropsMap[id].volume, this->fluidDensity);
+  }
+
   this->updateConnection = event::Events::ConnectWorldUpdateBegin(
       std::bind(&BuoyancyPlugin::OnUpdate, this));
 }
@@ -156,25 +223,16 @@ void BuoyancyPlugin::OnUpdate()
 {
   IGN_PROFILE("BuoyancyPlugin::OnUpdate");
   IGN_PROFILE_BEGIN("Update");
+  const FluidVolumes &volumes = Volumes(this);
   for (auto link : this->model->GetLinks())
   {
-    VolumeProperties volumeProperties = this->volPropsMap[link->GetId()];
-    double volume = volumeProperties.volume;
-    GZ_ASSERT(volume > 0, "Nonpositive volume found in volume properties!");
-
-    // By Archimedes' principle,
-    // buoyancy = -(mass*gravity)*fluid_density/object_density
-    // object_density = mass/volume, so the mass term cancels.
-    // Therefore,
-    ignition::math::Vector3d buoyancy =
-        -this->fluidDensity * volume * this->model->GetWorld()->Gravity();
-
-    ignition::math::Pose3d linkFrame = link->WorldPose();
-    // rotate buoyancy into the link frame before applying the force.
-    ignition::math::Vector3d buoyancyLinkFrame =
-        linkFrame.Rot().Inverse().RotateVector(buoyancy);
-
-    link->AddLinkForce(buoyancyLinkFrame, volumeProperties.cov);
+    auto handle = volumes.handles.find(link->GetId());
+    if (handle == volumes.handles.end())
+      continue;
+
+    // The FluidForces service computed the buoyancy in the link frame.
+    link->AddLinkForce(volumes.service->VolumeForce(handle->second),
+        this->volPropsMap[link->GetId()].cov);
   }
   IGN_PROFILE_END();
 }
@@ -57,11 +57,17 @@ namespace gazebo
   /// to compute these properties from the link collision shapes. This
   /// computation will not be accurate if the object is not composed of simple
   /// collision shapes.
+  /// The forces are computed for all buoyant links of the world in a single
+  /// pass by the FluidForces service, to which this plugin registers its
+  /// volumes in Init(). OnUpdate() applies the forces of this model.
   class GZ_PLUGIN_VISIBLE BuoyancyPlugin : public ModelPlugin
   {
     /// \brief Constructor.
     public: BuoyancyPlugin();
 
+    /// \brief Destructor.
+    public: virtual ~BuoyancyPlugin();
+
     /// \brief Read the model SDF to compute volume and center of volume for
     /// each link, and store those properties in volPropsMap.
     public: virtual void Load(physics::ModelPtr _model, sdf::ElementPtr _sdf);
@@ -0,0 +1,567 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <ignition/common/Profiler.hh>
+#include <ignition/math/Pose3.hh>
+
+#include "gazebo/common/Assert.hh"
+#include "gazebo/common/Events.hh"
+#include "plugins/FluidForces.hh"
+
+using namespace gazebo;
+
+/// \brief Private data class
+class gazebo::FluidForcesPrivate
+{
+  /// \brief Gather link states for all volumes and compute buoyancy.
+  public: void UpdateVolumes();
+
+  /// \brief Gather link states for all surfaces and compute lift and drag.
+  public: void UpdateSurfaces();
+
+  /// \brief Get a free slot from a free list.
+  /// \param[in] _free Free list.
+  /// \param[in] _size Current number of slots.
+  /// \return Slot index, equal to _size if a new slot must be appended.
+  public: static std::size_t Slot(std::vector<std::size_t> &_free,
+              const std::size_t _size);
+
+  /// \brief World the service belongs to.
+  public: physics::WorldPtr world;
+
+  /// \brief Connection to the world update begin event.
+  public: event::ConnectionPtr updateConnection;
+
+  /// \brief Protects registration against concurrent updates.
+  public: std::mutex mutex;
+
+  // Buoyant volumes, one entry per slot. Removed slots have a null link.
+
+  /// \brief Links of the volumes.
+  public: std::vector<physics::LinkPtr> volLinks;
+
+  /// \brief Fluid density times volume.
+  public: std::vector<double> volRhoV;
+
+  /// \brief Link orientations, gathered every step as w, x, y, z.
+  public: std::vector<double> volQw, volQx, volQy, volQz;
+
+  /// \brief Buoyancy forces in the link frame, computed every step.
+  public: std::vector<double> volFx, volFy, volFz;
+
+  /// \brief Free volume slots.
+  public: std::vector<std::size_t> volFree;
+
+  // Lift and drag surfaces, one entry per slot. Removed slots have a null
+  // link.
+
+  /// \brief Links of the surfaces.
+  public: std::vector<physics::LinkPtr> surfLinks;
+
+  /// \brief Control joints of the surfaces, may be null.
+  public: std::vector<physics::JointPtr> surfJoints;
+
+  /// \brief Centers of pressure in the link frame.
+  public: std::vector<ignition::math::Vector3d> surfCp;
+
+  /// \brief Forward directions in the link frame.
+  public: std::vector<ignition::math::Vector3d> surfForward;
+
+  /// \brief Upward directions in the link frame.
+  public: std::vector<ignition::math::Vector3d> surfUpward;
+
+  /// \brief Lift and drag coefficients and their stall values.
+  public: std::vector<double> surfCla, surfCda, surfClaStall, surfCdaStall;
+
+  /// \brief Stall angle, initial angle of attack, density, area and control
+  /// joint gain.
+  public: std::vector<double> surfAlphaStall, surfAlpha0, surfRho, surfArea,
+                              surfControlGain;
+
+  /// \brief Radial symmetry flags.
+  public: std::vector<char> surfRadial;
+
+  /// \brief Velocities at the center of pressure, gathered every step.
+  public: std::vector<ignition::math::Vector3d> surfVel;
+
+  /// \brief Link orientations, gathered every step.
+  public: std::vector<ignition::math::Quaterniond> surfRot;
+
+  /// \brief Control joint positions, gathered every step.
+  public: std::vector<double> surfControl;
+
+  /// \brief World frame forces, computed every step.
+  public: std::vector<ignition::math::Vector3d> surfForce;
+
+  /// \brief Angles of attack, computed every step.
+  public: std::vector<double> surfAlpha;
+
+  /// \brief Angles of sweep, computed every step.
+  public: std::vector<double> surfSweep;
+
+  /// \brief Whether a surface generated a force in the last step.
+  public: std::vector<char> surfActive;
+
+  /// \brief Free surface slots.
+  public: std::vector<std::size_t> surfFree;
+
+  /// \brief Services of all worlds, indexed by world name.
+  public: static std::map<std::string, std::weak_ptr<FluidForces>> services;
+
+  /// \brief Protects services.
+  public: static std::mutex servicesMutex;
+};
+
+std::map<std::string, std::weak_ptr<FluidForces>>
+    FluidForcesPrivate::services;
+std::mutex FluidForcesPrivate::servicesMutex;
+
+/////////////////////////////////////////////////
+std::size_t FluidForcesPrivate::Slot(std::vector<std::size_t> &_free,
+    const std::size_t _size)
+{
+  if (_free.empty())
+    return _size;
+
+  std::size_t slot = _free.back();
+  _free.pop_back();
+  return slot;
+}
+
+/////////////////////////////////////////////////
+std::shared_ptr<FluidForces> FluidForces::Instance(physics::WorldPtr _world)
+{
+  GZ_ASSERT(_world != nullptr, "Received NULL world pointer");
+
+  std::lock_guard<std::mutex> lock(FluidForcesPrivate::servicesMutex);
+  auto &weak = FluidForcesPrivate::services[_world->Name()];
+  std::shared_ptr<FluidForces> service = weak.lock();
+  if (!service)
+  {
+    service.reset(new FluidForces(_world));
+    weak = service;
+  }
+  return service;
+}
+
+/////////////////////////////////////////////////
+FluidForces::FluidForces(physics::WorldPtr _world)
+  : dataPtr(new FluidForcesPrivate)
+{
+  this->dataPtr->world = _world;
+  this->dataPtr->updateConnection = event::Events::ConnectWorldUpdateBegin(
+      std::bind(&FluidForces::Update, this));
+}
+
+/////////////////////////////////////////////////
+FluidForces::~FluidForces()
+{
+  this->dataPtr->updateConnection.reset();
+}
+
+/////////////////////////////////////////////////
+std::size_t FluidForces::AddVolume(physics::LinkPtr _link,
+    const double _volume, const double _fluidDensity)
+{
+  GZ_ASSERT(_link != nullptr, "Received NULL link pointer");
+  GZ_ASSERT(_volume > 0, "Nonpositive volume found in volume properties!");
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto &d = *this->dataPtr;
+  std::size_t slot = FluidForcesPrivate::Slot(d.volFree, d.volLinks.size());
+  if (slot == d.volLinks.size())
+  {
+    const std::size_t size = slot + 1;
+    d.volLinks.resize(size);
+    d.volRhoV.resize(size);
+    d.volQw.resize(size);
+    d.volQx.resize(size);
+    d.volQy.resize(size);
+    d.volQz.resize(size);
+    d.volFx.resize(size);
+    d.volFy.resize(size);
+    d.volFz.resize(size);
+  }
+
+  d.volLinks[slot] = _link;
+  d.volRhoV[slot] = _fluidDensity * _volume;
+  d.volFx[slot] = 0;
+  d.volFy[slot] = 0;
+  d.volFz[slot] = 0;
+  return slot;
+}
+
+/////////////////////////////////////////////////
+void FluidForces::RemoveVolume(const std::size_t _handle)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (_handle >= this->dataPtr->volLinks.size() ||
+      !this->dataPtr->volLinks[_handle])
+  {
+    return;
+  }
+
+  this->dataPtr->volLinks[_handle].reset();
+  this->dataPtr->volRhoV[_handle] = 0;
+  this->dataPtr->volFree.push_back(_handle);
+}
+
+/////////////////////////////////////////////////
+std::size_t FluidForces::AddSurface(const LiftSurface &_surface)
+{
+  GZ_ASSERT(_surface.link != nullptr, "Received NULL link pointer");
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  auto &d = *this->dataPtr;
+  std::size_t slot = FluidForcesPrivate::Slot(d.surfFree, d.surfLinks.size());
+  if (slot == d.surfLinks.size())
+  {
+    const std::size_t size = slot + 1;
+    d.surfLinks.resize(size);
+    d.surfJoints.resize(size);
+    d.surfCp.resize(size);
+    d.surfForward.resize(size);
+    d.surfUpward.resize(size);
+    d.surfCla.resize(size);
+    d.surfCda.resize(size);
+    d.surfClaStall.resize(size);
+    d.surfCdaStall.resize(size);
+    d.surfAlphaStall.resize(size);
+    d.surfAlpha0.resize(size);
+    d.surfRho.resize(size);
+    d.surfArea.resize(size);
+    d.surfControlGain.resize(size);
+    d.surfRadial.resize(size);
+    d.surfVel.resize(size);
+    d.surfRot.resize(size);
+    d.surfControl.resize(size);
+    d.surfForce.resize(size);
+    d.surfAlpha.resize(size);
+    d.surfSweep.resize(size);
+    d.surfActive.resize(size);
+  }
+
+  d.surfLinks[slot] = _surface.link;
+  d.surfJoints[slot] = _surface.controlJoint;
+  d.surfCp[slot] = _surface.cp;
+  d.surfForward[slot] = _surface.forward;
+  d.surfUpward[slot] = _surface.upward;
+  d.surfCla[slot] = _surface.cla;
+  d.surfCda[slot] = _surface.cda;
+  d.surfClaStall[slot] = _surface.claStall;
+  d.surfCdaStall[slot] = _surface.cdaStall;
+  d.surfAlphaStall[slot] = _surface.alphaStall;
+  d.surfAlpha0[slot] = _surface.alpha0;
+  d.surfRho[slot] = _surface.rho;
+  d.surfArea[slot] = _surface.area;
+  d.surfControlGain[slot] = _surface.controlJointRadToCL;
+  d.surfRadial[slot] = _surface.radialSymmetry;
+  d.surfActive[slot] = false;
+  return slot;
+}
+
+/////////////////////////////////////////////////
+void FluidForces::RemoveSurface(const std::size_t _handle)
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  if (_handle >= this->dataPtr->surfLinks.size() ||
+      !this->dataPtr->surfLinks[_handle])
+  {
+    return;
+  }
+
+  this->dataPtr->surfLinks[_handle].reset();
+  this->dataPtr->surfJoints[_handle].reset();
+  this->dataPtr->surfActive[_handle] = false;
+  this->dataPtr->surfFree.push_back(_handle);
+}
+
+/////////////////////////////////////////////////
+std::size_t FluidForces::VolumeCount() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->volLinks.size() - this->dataPtr->volFree.size();
+}
+
+/////////////////////////////////////////////////
+std::size_t FluidForces::SurfaceCount() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->surfLinks.size() - this->dataPtr->surfFree.size();
+}
+
+/////////////////////////////////////////////////
+ignition::math::Vector3d FluidForces::VolumeForce(
+    const std::size_t _handle) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  const auto &d = *this->dataPtr;
+  if (_handle >= d.volLinks.size() || !d.volLinks[_handle])
+    return ignition::math::Vector3d::Zero;
+
+  return ignition::math::Vector3d(
+      d.volFx[_handle], d.volFy[_handle], d.volFz[_handle]);
+}
+
+/////////////////////////////////////////////////
+bool FluidForces::SurfaceForce(const std::size_t _handle,
+    ignition::math::Vector3d &_force, double &_alpha, double &_sweep) const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  const auto &d = *this->dataPtr;
+  if (_handle >= d.surfLinks.size() || !d.surfActive[_handle])
+    return false;
+
+  _force = d.surfForce[_handle];
+  _alpha = d.surfAlpha[_handle];
+  _sweep = d.surfSweep[_handle];
+  return true;
+}
+
+/////////////////////////////////////////////////
+void FluidForces::Update()
+{
+  IGN_PROFILE("FluidForces::Update");
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+
+  IGN_PROFILE_BEGIN("Buoyancy");
+  this->dataPtr->UpdateVolumes();
+  IGN_PROFILE_END();
+
+  IGN_PROFILE_BEGIN("LiftDrag");
+  this->dataPtr->UpdateSurfaces();
+  IGN_PROFILE_END();
+}
+
+/////////////////////////////////////////////////
+void FluidForcesPrivate::UpdateVolumes()
+{
+  const std::size_t count = this->volLinks.size();
+  if (count == 0)
+    return;
+
+  // Gather orientations. Free slots keep a zero density-volume product, so
+  // they produce a zero force.
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (!this->volLinks[i])
+      continue;
+
+    const ignition::math::Quaterniond &rot =
+        this->volLinks[i]->WorldPose().Rot();
+    this->volQw[i] = rot.W();
+    this->volQx[i] = rot.X();
+    this->volQy[i] = rot.Y();
+    this->volQz[i] = rot.Z();
+  }
+
+  // By Archimedes' principle,
+  // buoyancy = -(mass*gravity)*fluid_density/object_density
+  // object_density = mass/volume, so the mass term cancels.
+  // The force is rotated into the link frame, which is the transpose of
+  // the link rotation applied to the world frame force.
+  const ignition::math::Vector3d gravity = this->world->Gravity();
+  const double gx = gravity.X();
+  const double gy = gravity.Y();
+  const double gz = gravity.Z();
+
+  const double *qw = this->volQw.data();
+  const double *qx = this->volQx.data();
+  const double *qy = this->volQy.data();
+  const double *qz = this->volQz.data();
+  const double *rhoV = this->volRhoV.data();
+  double *fx = this->volFx.data();
+  double *fy = this->volFy.data();
+  double *fz = this->volFz.data();
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    const double w = qw[i];
+    const double x = qx[i];
+    const double y = qy[i];
+    const double z = qz[i];
+
+    const double r00 = 1.0 - 2.0 * (y * y + z * z);
+    const double r01 = 2.0 * (x * y - z * w);
+    const double r02 = 2.0 * (x * z + y * w);
+    const double r10 = 2.0 * (x * y + z * w);
+    const double r11 = 1.0 - 2.0 * (x * x + z * z);
+    const double r12 = 2.0 * (y * z - x * w);
+    const double r20 = 2.0 * (x * z - y * w);
+    const double r21 = 2.0 * (y * z + x * w);
+    const double r22 = 1.0 - 2.0 * (x * x + y * y);
+
+    const double s = -rhoV[i];
+    fx[i] = s * (r00 * gx + r10 * gy + r20 * gz);
+    fy[i] = s * (r01 * gx + r11 * gy + r21 * gz);
+    fz[i] = s * (r02 * gx + r12 * gy + r22 * gz);
+  }
+}
+
+/////////////////////////////////////////////////
+void FluidForcesPrivate::UpdateSurfaces()
+{
+  const std::size_t count = this->surfLinks.size();
+  if (count == 0)
+    return;
+
+  // Gather velocities at the center of pressure, orientations and control
+  // joint positions.
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    if (!this->surfLinks[i])
+      continue;
+
+    this->surfVel[i] = this->surfLinks[i]->WorldLinearVel(this->surfCp[i]);
+    this->surfRot[i] = this->surfLinks[i]->WorldPose().Rot();
+    this->surfControl[i] =
+        this->surfJoints[i] ? this->surfJoints[i]->Position(0) : 0.0;
+  }
+
+  const double minRatio = -1.0;
+  const double maxRatio = 1.0;
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    ignition::math::Vector3d &force = this->surfForce[i];
+    force = ignition::math::Vector3d::Zero;
+
+    const ignition::math::Vector3d &vel = this->surfVel[i];
+    this->surfActive[i] = this->surfLinks[i] && vel.Length() > 0.01;
+    if (!this->surfActive[i])
+      continue;
+
+    ignition::math::Vector3d velI = vel;
+    velI.Normalize();
+
+    const ignition::math::Quaterniond &rot = this->surfRot[i];
+
+    // rotate forward and upward vectors into inertial frame
+    const ignition::math::Vector3d forwardI =
+        rot.RotateVector(this->surfForward[i]);
+
+    ignition::math::Vector3d upwardI;
+    if (this->surfRadial[i])
+    {
+      // use inflow velocity to determine upward direction
+      // which is the component of inflow perpendicular to forward direction.
+      ignition::math::Vector3d tmp = forwardI.Cross(velI);
+      upwardI = forwardI.Cross(tmp).Normalize();
+    }
+    else
+    {
+      upwardI = rot.RotateVector(this->surfUpward[i]);
+    }
+
+    // spanwiseI: a vector normal to lift-drag-plane in inertial frame
+    ignition::math::Vector3d spanwiseI = forwardI.Cross(upwardI).Normalize();
+
+    // check sweep (angle between velI and lift-drag-plane)
+    const double sinSweepAngle = ignition::math::clamp(
+        spanwiseI.Dot(velI), minRatio, maxRatio);
+
+    // get cos from trig identity
+    const double cosSweepAngle = 1.0 - sinSweepAngle * sinSweepAngle;
+    this->surfSweep[i] = std::asin(sinSweepAngle);
+
+    // removing spanwise velocity from vel
+    const ignition::math::Vector3d velInLDPlane =
+        vel - vel.Dot(spanwiseI)*velI;
+
+    // get direction of drag
+    ignition::math::Vector3d dragDirection = -velInLDPlane;
+    dragDirection.Normalize();
+
+    // get direction of lift
+    ignition::math::Vector3d liftI = spanwiseI.Cross(velInLDPlane);
+    liftI.Normalize();
+
+    // compute angle between upwardI and liftI
+    const double cosAlpha =
+      ignition::math::clamp(liftI.Dot(upwardI), minRatio, maxRatio);
+
+    // if forwardI is in the same direction as lift, alpha is positive.
+    double alpha;
+    if (liftI.Dot(forwardI) >= 0.0)
+      alpha = this->surfAlpha0[i] + std::acos(cosAlpha);
+    else
+      alpha = this->surfAlpha0[i] - std::acos(cosAlpha);
+
+    // normalize to within +/-90 deg
+    while (std::fabs(alpha) > 0.5 * IGN_PI)
+      alpha = alpha > 0 ? alpha - IGN_PI : alpha + IGN_PI;
+    this->surfAlpha[i] = alpha;
+
+    // compute dynamic pressure
+    const double speedInLDPlane = velInLDPlane.Length();
+    const double q = 0.5 * this->surfRho[i] * speedInLDPlane * speedInLDPlane;
+
+    const double cla = this->surfCla[i];
+    const double cda = this->surfCda[i];
+    const double alphaStall = this->surfAlphaStall[i];
+    const double claStall = this->surfClaStall[i];
+    const double cdaStall = this->surfCdaStall[i];
+
+    // compute cl and cd at cp, check for stall, correct for sweep
+    double cl;
+    double cd;
+    if (alpha > alphaStall)
+    {
+      cl = (cla * alphaStall + claStall * (alpha - alphaStall))
+           * cosSweepAngle;
+      // make sure cl is still great than 0
+      cl = std::max(0.0, cl);
+      cd = (cda * alphaStall + cdaStall * (alpha - alphaStall))
+           * cosSweepAngle;
+    }
+    else if (alpha < -alphaStall)
+    {
+      cl = (-cla * alphaStall + claStall * (alpha + alphaStall))
+           * cosSweepAngle;
+      // make sure cl is still less than 0
+      cl = std::min(0.0, cl);
+      cd = (-cda * alphaStall + cdaStall * (alpha + alphaStall))
+           * cosSweepAngle;
+    }
+    else
+    {
+      cl = cla * alpha * cosSweepAngle;
+      cd = cda * alpha * cosSweepAngle;
+    }
+
+    // modify cl per control joint value
+    cl += this->surfControlGain[i] * this->surfControl[i];
+
+    // make sure drag is positive
+    cd = std::fabs(cd);
+
+    // lift and drag at cp. The pitching moment is not computed, as cm
+    // needs testing.
+    force = (cl * liftI + cd * dragDirection) * (q * this->surfArea[i]);
+
+    // Correct for nan or inf
+    force.Correct();
+  }
+}
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_PLUGINS_FLUIDFORCES_HH_
+#define GAZEBO_PLUGINS_FLUIDFORCES_HH_
+
+#include <cstddef>
+#include <memory>
+
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "gazebo/physics/physics.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  class FluidForcesPrivate;
+
+  /// \brief Parameters of a lift and drag surface registered with
+  /// FluidForces. See LiftDragPlugin for the meaning of each parameter.
+  class GZ_PLUGIN_VISIBLE LiftSurface
+  {
+    /// \brief Link the surface is attached to.
+    public: physics::LinkPtr link;
+
+    /// \brief Optional joint actuating a control surface.
+    public: physics::JointPtr controlJoint;
+
+    /// \brief Center of pressure in the link frame.
+    public: ignition::math::Vector3d cp;
+
+    /// \brief Forward direction in the link frame, normalized.
+    public: ignition::math::Vector3d forward = {1, 0, 0};
+
+    /// \brief Upward direction in the link frame, normalized.
+    public: ignition::math::Vector3d upward = {0, 0, 1};
+
+    /// \brief Coefficient of lift / alpha slope.
+    public: double cla = 1.0;
+
+    /// \brief Coefficient of drag / alpha slope.
+    public: double cda = 0.01;
+
+    /// \brief Angle of attack at which the airfoil stalls.
+    public: double alphaStall = 0.5 * IGN_PI;
+
+    /// \brief Cl-alpha rate after stall.
+    public: double claStall = 0.0;
+
+    /// \brief Cd-alpha rate after stall.
+    public: double cdaStall = 1.0;
+
+    /// \brief Initial angle of attack.
+    public: double alpha0 = 0.0;
+
+    /// \brief Fluid density.
+    public: double rho = 1.2041;
+
+    /// \brief Effective planform surface area.
+    public: double area = 1.0;
+
+    /// \brief Change of CL per radian of control joint position.
+    public: double controlJointRadToCL = 4.0;
+
+    /// \brief True if the shape is radially symmetric about the forward
+    /// direction.
+    public: bool radialSymmetry = false;
+  };
+
+  /// \class FluidForces FluidForces.hh plugins/FluidForces.hh
+  /// \brief World-level service that computes buoyancy, lift and drag.
+  ///
+  /// Plugins register buoyant volumes and lift surfaces once. The service
+  /// keeps them in structure-of-arrays buffers and, once per world update,
+  /// gathers link states and computes all fluid forces in tight loops over
+  /// the buffers. The plugins then read their own results in their OnUpdate
+  /// and apply them. The service connects to the world update begin event
+  /// when it is created, before any plugin that uses it, so its results are
+  /// always computed first.
+  class GZ_PLUGIN_VISIBLE FluidForces
+  {
+    /// \brief Get the fluid forces service of a world, creating it if
+    /// needed. The service lives as long as somebody holds a pointer to it.
+    /// \param[in] _world World to get the service for.
+    /// \return Pointer to the service.
+    public: static std::shared_ptr<FluidForces> Instance(
+                physics::WorldPtr _world);
+
+    /// \brief Destructor.
+    public: ~FluidForces();
+
+    /// \brief Register a buoyant volume.
+    /// \param[in] _link Link the buoyancy force acts on.
+    /// \param[in] _volume Volume of the link in m^3.
+    /// \param[in] _fluidDensity Density of the surrounding fluid in kg/m^3.
+    /// \return Handle used to read the force and remove the volume.
+    public: std::size_t AddVolume(physics::LinkPtr _link,
+                const double _volume, const double _fluidDensity);
+
+    /// \brief Remove a buoyant volume.
+    /// \param[in] _handle Handle returned by AddVolume.
+    public: void RemoveVolume(const std::size_t _handle);
+
+    /// \brief Register a lift and drag surface.
+    /// \param[in] _surface Surface parameters.
+    /// \return Handle used to read the force and remove the surface.
+    public: std::size_t AddSurface(const LiftSurface &_surface);
+
+    /// \brief Remove a lift and drag surface.
+    /// \param[in] _handle Handle returned by AddSurface.
+    public: void RemoveSurface(const std::size_t _handle);
+
+    /// \brief Number of registered volumes.
+    /// \return Number of active volumes.
+    public: std::size_t VolumeCount() const;
+
+    /// \brief Number of registered surfaces.
+    /// \return Number of active surfaces.
+    public: std::size_t SurfaceCount() const;
+
+    /// \brief Get the buoyancy force of a volume computed by the last
+    /// Update().
+    /// \param[in] _handle Handle returned by AddVolume.
+    /// \return Buoyancy force in the link frame, to be applied at the
+    /// center of volume. Zero for an unknown handle.
+    public: ignition::math::Vector3d VolumeForce(
+                const std::size_t _handle) const;
+
+    /// \brief Get the lift and drag force of a surface computed by the last
+    /// Update().
+    /// \param[in] _handle Handle returned by AddSurface.
+    /// \param[out] _force Lift and drag force in the world frame, to be
+    /// applied at the center of pressure.
+    /// \param[out] _alpha Angle of attack.
+    /// \param[out] _sweep Angle of sweep.
+    /// \return False if the surface moves too slowly to generate a force
+    /// or the handle is unknown, in which case the outputs are unchanged.
+    public: bool SurfaceForce(const std::size_t _handle,
+                ignition::math::Vector3d &_force, double &_alpha,
+                double &_sweep) const;
+
+    /// \brief Compute all fluid forces from the current link states.
+    /// Called on every world update.
+    public: void Update();
+
+    /// \brief Constructor, use Instance() instead.
+    /// \param[in] _world World the service belongs to.
+    private: explicit FluidForces(physics::WorldPtr _world);
+
+    /// \internal
+    /// \brief Private data pointer.
+    private: std::unique_ptr<FluidForcesPrivate> dataPtr;
+  };
+}
+#endif
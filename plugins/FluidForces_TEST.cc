@@ -0,0 +1,405 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "plugins/FluidForces.hh"
+#include "plugins/LiftDragPlugin.hh"
+#include "gazebo/test/ServerFixture.hh"
+#include "test/util.hh"
+
+using namespace gazebo;
+
+class FluidForcesTest : public ServerFixture
+{
+  public: FluidForcesTest()
+  {
+    this->Load("worlds/empty.world", true);
+    this->world = physics::get_world("default");
+  }
+
+  /// \brief Spawn a box and set its velocity.
+  /// \param[in] _name Model name.
+  /// \param[in] _pos Position of the box.
+  /// \param[in] _rpy Orientation of the box.
+  /// \param[in] _linearVel Linear velocity.
+  /// \param[in] _angularVel Angular velocity.
+  /// \return The link of the box.
+  protected: physics::LinkPtr Box(const std::string &_name,
+                 const ignition::math::Vector3d &_pos,
+                 const ignition::math::Vector3d &_rpy,
+                 const ignition::math::Vector3d &_linearVel =
+                 ignition::math::Vector3d::Zero,
+                 const ignition::math::Vector3d &_angularVel =
+                 ignition::math::Vector3d::Zero)
+  {
+    this->SpawnBox(_name, ignition::math::Vector3d::One, _pos, _rpy);
+    physics::ModelPtr model = this->world->ModelByName(_name);
+    EXPECT_TRUE(model != nullptr);
+    if (!model)
+      return physics::LinkPtr();
+
+    physics::LinkPtr link = model->GetLink("body");
+    EXPECT_TRUE(link != nullptr);
+    if (link)
+    {
+      link->SetLinearVel(_linearVel);
+      link->SetAngularVel(_angularVel);
+    }
+    return link;
+  }
+
+  protected: physics::WorldPtr world;
+};
+
+/// \brief A LiftDragPlugin that exposes its update and angles.
+class TestLiftDragPlugin : public LiftDragPlugin
+{
+  public: void Update()
+  {
+    this->OnUpdate();
+  }
+
+  public: double Alpha() const
+  {
+    return this->alpha;
+  }
+
+  public: double Sweep() const
+  {
+    return this->sweep;
+  }
+};
+
+/////////////////////////////////////////////////
+/// \brief Buoyancy in the link frame, computed link by link as
+/// BuoyancyPlugin::OnUpdate did before the forces were batched.
+ignition::math::Vector3d ReferenceBuoyancy(physics::WorldPtr _world,
+    physics::LinkPtr _link, const double _volume, const double _density)
+{
+  ignition::math::Vector3d buoyancy =
+      -_density * _volume * _world->Gravity();
+
+  ignition::math::Pose3d linkFrame = _link->WorldPose();
+  return linkFrame.Rot().Inverse().RotateVector(buoyancy);
+}
+
+/////////////////////////////////////////////////
+/// \brief Lift and drag, computed link by link as LiftDragPlugin::OnUpdate
+/// did before the forces were batched.
+/// \return False if the surface moves too slowly to generate a force.
+bool ReferenceLiftDrag(const LiftSurface &_s,
+    ignition::math::Vector3d &_force, double &_alpha, double &_sweep)
+{
+  ignition::math::Vector3d vel = _s.link->WorldLinearVel(_s.cp);
+  ignition::math::Vector3d velI = vel;
+  velI.Normalize();
+
+  if (vel.Length() <= 0.01)
+    return false;
+
+  ignition::math::Pose3d pose = _s.link->WorldPose();
+  ignition::math::Vector3d forwardI = pose.Rot().RotateVector(_s.forward);
+
+  ignition::math::Vector3d upwardI;
+  if (_s.radialSymmetry)
+  {
+    ignition::math::Vector3d tmp = forwardI.Cross(velI);
+    upwardI = forwardI.Cross(tmp).Normalize();
+  }
+  else
+  {
+    upwardI = pose.Rot().RotateVector(_s.upward);
+  }
+
+  ignition::math::Vector3d spanwiseI = forwardI.Cross(upwardI).Normalize();
+
+  double sinSweepAngle = ignition::math::clamp(spanwiseI.Dot(velI), -1.0, 1.0);
+  double cosSweepAngle = 1.0 - sinSweepAngle * sinSweepAngle;
+  _sweep = asin(sinSweepAngle);
+  while (fabs(_sweep) > 0.5 * M_PI)
+    _sweep = _sweep > 0 ? _sweep - M_PI : _sweep + M_PI;
+
+  ignition::math::Vector3d velInLDPlane = vel - vel.Dot(spanwiseI)*velI;
+
+  ignition::math::Vector3d dragDirection = -velInLDPlane;
+  dragDirection.Normalize();
+
+  ignition::math::Vector3d liftI = spanwiseI.Cross(velInLDPlane);
+  liftI.Normalize();
+
+  double cosAlpha = ignition::math::clamp(liftI.Dot(upwardI), -1.0, 1.0);
+  if (liftI.Dot(forwardI) >= 0.0)
+    _alpha = _s.alpha0 + acos(cosAlpha);
+  else
+    _alpha = _s.alpha0 - acos(cosAlpha);
+
+  while (fabs(_alpha) > 0.5 * M_PI)
+    _alpha = _alpha > 0 ? _alpha - M_PI : _alpha + M_PI;
+
+  double speedInLDPlane = velInLDPlane.Length();
+  double q = 0.5 * _s.rho * speedInLDPlane * speedInLDPlane;
+
+  double cl;
+  if (_alpha > _s.alphaStall)
+  {
+    cl = (_s.cla * _s.alphaStall + _s.claStall * (_alpha - _s.alphaStall))
+         * cosSweepAngle;
+    cl = std::max(0.0, cl);
+  }
+  else if (_alpha < -_s.alphaStall)
+  {
+    cl = (-_s.cla * _s.alphaStall + _s.claStall * (_alpha + _s.alphaStall))
+         * cosSweepAngle;
+    cl = std::min(0.0, cl);
+  }
+  else
+    cl = _s.cla * _alpha * cosSweepAngle;
+
+  if (_s.controlJoint)
+    cl = cl + _s.controlJointRadToCL * _s.controlJoint->Position(0);
+
+  ignition::math::Vector3d lift = cl * q * _s.area * liftI;
+
+  double cd;
+  if (_alpha > _s.alphaStall)
+  {
+    cd = (_s.cda * _s.alphaStall + _s.cdaStall * (_alpha - _s.alphaStall))
+         * cosSweepAngle;
+  }
+  else if (_alpha < -_s.alphaStall)
+  {
+    cd = (-_s.cda * _s.alphaStall + _s.cdaStall * (_alpha + _s.alphaStall))
+         * cosSweepAngle;
+  }
+  else
+    cd = (_s.cda * _alpha) * cosSweepAngle;
+
+  cd = fabs(cd);
+
+  ignition::math::Vector3d drag = cd * q * _s.area * dragDirection;
+
+  _force = lift + drag;
+  _force.Correct();
+  return true;
+}
+
+/////////////////////////////////////////////////
+/// \brief Expect two vectors to match to a relative tolerance.
+void ExpectNear(const ignition::math::Vector3d &_expected,
+    const ignition::math::Vector3d &_actual)
+{
+  const double tol = 1e-9 * std::max(1.0, _expected.Length());
+  EXPECT_NEAR(_expected.X(), _actual.X(), tol);
+  EXPECT_NEAR(_expected.Y(), _actual.Y(), tol);
+  EXPECT_NEAR(_expected.Z(), _actual.Z(), tol);
+}
+
+/////////////////////////////////////////////////
+TEST_F(FluidForcesTest, Buoyancy)
+{
+  std::shared_ptr<FluidForces> fluidForces =
+      FluidForces::Instance(this->world);
+  ASSERT_TRUE(fluidForces != nullptr);
+
+  const std::vector<ignition::math::Vector3d> rpys = {
+    {0, 0, 0}, {0.3, -0.2, 1.1}, {IGN_PI, 0, 0}, {-1.2, 0.7, -2.5}};
+  const std::vector<double> volumes = {1.0, 0.25, 3.5, 0.01};
+  const std::vector<double> densities = {1000.0, 999.1026, 1.2, 13500.0};
+
+  std::vector<physics::LinkPtr> links;
+  std::vector<std::size_t> handles;
+  for (std::size_t i = 0; i < rpys.size(); ++i)
+  {
+    physics::LinkPtr link = this->Box("box_" + std::to_string(i),
+        ignition::math::Vector3d(i * 2.0, 0, 1), rpys[i]);
+    ASSERT_TRUE(link != nullptr);
+    links.push_back(link);
+    handles.push_back(
+        fluidForces->AddVolume(link, volumes[i], densities[i]));
+  }
+  EXPECT_EQ(rpys.size(), fluidForces->VolumeCount());
+
+  fluidForces->Update();
+
+  for (std::size_t i = 0; i < links.size(); ++i)
+  {
+    ExpectNear(ReferenceBuoyancy(this->world, links[i], volumes[i],
+          densities[i]), fluidForces->VolumeForce(handles[i]));
+  }
+
+  // A removed volume has no force.
+  fluidForces->RemoveVolume(handles[1]);
+  fluidForces->Update();
+  EXPECT_EQ(ignition::math::Vector3d::Zero,
+      fluidForces->VolumeForce(handles[1]));
+  ExpectNear(ReferenceBuoyancy(this->world, links[2], volumes[2],
+        densities[2]), fluidForces->VolumeForce(handles[2]));
+}
+
+/////////////////////////////////////////////////
+TEST_F(FluidForcesTest, LiftDrag)
+{
+  std::shared_ptr<FluidForces> fluidForces =
+      FluidForces::Instance(this->world);
+  ASSERT_TRUE(fluidForces != nullptr);
+
+  std::vector<LiftSurface> surfaces;
+
+  // Wing with a small angle of attack and sweep.
+  LiftSurface wing;
+  wing.link = this->Box("wing", {0, 0, 1}, {0.05, 0.1, 0.2},
+      {20, 1, -1});
+  wing.cp = {0.1, 0.5, 0};
+  wing.cla = 4.75;
+  wing.cda = 0.6;
+  wing.alphaStall = 0.35;
+  wing.claStall = -3.9;
+  wing.cdaStall = -0.9;
+  wing.alpha0 = 0.05;
+  wing.area = 0.8;
+  surfaces.push_back(wing);
+
+  // Stalled surface with a positive angle of attack.
+  LiftSurface stalled = wing;
+  stalled.link = this->Box("stalled", {2, 0, 1}, {0, -0.8, 0},
+      {10, 0, 0}, {0.5, -0.2, 0.1});
+  surfaces.push_back(stalled);
+
+  // Stalled surface with a negative angle of attack.
+  LiftSurface negative = wing;
+  negative.link = this->Box("negative", {4, 0, 1}, {0, 0.8, 0},
+      {10, 0, 0});
+  surfaces.push_back(negative);
+
+  // Radially symmetric body.
+  LiftSurface radial;
+  radial.link = this->Box("radial", {6, 0, 1}, {0.2, 0.3, -0.4},
+      {3, -4, 2}, {0, 1, 0});
+  radial.radialSymmetry = true;
+  radial.forward = ignition::math::Vector3d(1, 1, 0).Normalize();
+  radial.cla = 0.1;
+  radial.cda = 0.2;
+  surfaces.push_back(radial);
+
+  // Surface moving too slowly to generate a force.
+  LiftSurface slow = wing;
+  slow.link = this->Box("slow", {8, 0, 1}, {0, 0, 0}, {0.001, 0, 0});
+  surfaces.push_back(slow);
+
+  std::vector<std::size_t> handles;
+  for (const auto &surface : surfaces)
+  {
+    ASSERT_TRUE(surface.link != nullptr);
+    handles.push_back(fluidForces->AddSurface(surface));
+  }
+  EXPECT_EQ(surfaces.size(), fluidForces->SurfaceCount());
+
+  fluidForces->Update();
+
+  for (std::size_t i = 0; i < surfaces.size(); ++i)
+  {
+    ignition::math::Vector3d expectedForce;
+    double expectedAlpha = 0;
+    double expectedSweep = 0;
+    const bool expected = ReferenceLiftDrag(surfaces[i], expectedForce,
+        expectedAlpha, expectedSweep);
+
+    ignition::math::Vector3d force;
+    double alpha = 0;
+    double sweep = 0;
+    EXPECT_EQ(expected, fluidForces->SurfaceForce(handles[i], force, alpha,
+          sweep)) << "surface " << i;
+    if (!expected)
+      continue;
+
+    ExpectNear(expectedForce, force);
+    EXPECT_NEAR(expectedAlpha, alpha, 1e-9) << "surface " << i;
+    EXPECT_NEAR(expectedSweep, sweep, 1e-9) << "surface " << i;
+  }
+}
+
+/////////////////////////////////////////////////
+TEST_F(FluidForcesTest, LiftDragPluginUpdate)
+{
+  physics::LinkPtr link = this->Box("plane", {0, 0, 1}, {0, 0.1, 0.3},
+      {15, 2, -1});
+  ASSERT_TRUE(link != nullptr);
+
+  std::ostringstream pluginStr;
+  pluginStr << "<sdf version ='" << SDF_VERSION << "'>"
+    << "<model name='plane'>"
+    << "  <plugin name='lift_drag' filename='notimportant'>"
+    << "    <a0>0.05</a0>"
+    << "    <cla>4.75</cla>"
+    << "    <cda>0.6</cda>"
+    << "    <alpha_stall>0.35</alpha_stall>"
+    << "    <cla_stall>-3.9</cla_stall>"
+    << "    <cda_stall>-0.9</cda_stall>"
+    << "    <cp>0.1 0.5 0</cp>"
+    << "    <area>0.8</area>"
+    << "    <link_name>body</link_name>"
+    << "  </plugin>"
+    << "</model>"
+    << "</sdf>";
+
+  sdf::SDFPtr pluginSDF(new sdf::SDF);
+  pluginSDF->SetFromString(pluginStr.str());
+  sdf::ElementPtr elem = pluginSDF->Root()->GetElement("model")
+      ->GetElement("plugin");
+  ASSERT_TRUE(elem != nullptr);
+
+  TestLiftDragPlugin plugin;
+  plugin.Load(link->GetModel(), elem);
+
+  LiftSurface surface;
+  surface.link = link;
+  surface.cp = {0.1, 0.5, 0};
+  surface.cla = 4.75;
+  surface.cda = 0.6;
+  surface.alphaStall = 0.35;
+  surface.claStall = -3.9;
+  surface.cdaStall = -0.9;
+  surface.alpha0 = 0.05;
+  surface.area = 0.8;
+
+  ignition::math::Vector3d expectedForce;
+  double expectedAlpha = 0;
+  double expectedSweep = 0;
+  ASSERT_TRUE(ReferenceLiftDrag(surface, expectedForce, expectedAlpha,
+        expectedSweep));
+
+  // The world is paused, so run the service and the plugin by hand in the
+  // order of a world update.
+  FluidForces::Instance(this->world)->Update();
+  const ignition::math::Vector3d forceBefore = link->WorldForce();
+  plugin.Update();
+
+  EXPECT_NEAR(expectedAlpha, plugin.Alpha(), 1e-9);
+  EXPECT_NEAR(expectedSweep, plugin.Sweep(), 1e-9);
+  ExpectNear(expectedForce, link->WorldForce() - forceBefore);
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
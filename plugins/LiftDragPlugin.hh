@@ -29,6 +29,9 @@
 namespace gazebo
 {
   /// \brief A plugin that simulates lift and drag.
+  /// The forces are computed for all lift surfaces of the world in a single
+  /// pass by the FluidForces service, to which this plugin registers its
+  /// surface in Load(). OnUpdate() applies the force of this surface.
   class GZ_PLUGIN_VISIBLE LiftDragPlugin : public ModelPlugin
   {
     /// \brief Constructor.
@@ -15,6 +15,7 @@
  *
 */
 
+#include <algorithm>
 #include <functional>
 #include <vector>
 
@@ -338,18 +339,35 @@ void SimpleTrackedVehiclePlugin::DriveTracks(
   // For each contact, compute the friction force direction and speed of
   // surface movement.
   ////////////////////////////////////////////////////////////////////////
-  size_t i = 0;
-  const auto contacts = this->contactManager->GetContacts();
   const auto model = this->body->GetModel();
 
-  for (auto contact : contacts)
+  // Only visit the contacts of our own track links, using the contact
+  // manager's per-link index instead of scanning every contact in the world.
+  // A contact between two of our tracks is listed for both links, so it is
+  // skipped when the other link has already been visited.
+  std::vector<physics::Contact *> contacts;
+  std::vector<const physics::Link *> visitedTracks;
+  for (const auto &trackSide : globalTracks.at(this->body))
   {
-    // Beware! There may be invalid contacts beyond GetContactCount()...
-    if (i == this->contactManager->GetContactCount())
-      break;
-
-    ++i;
+    for (const auto &trackLink : trackSide.second)
+    {
+      for (auto contact : this->contactManager->LinkContacts(trackLink.get()))
+      {
+        const physics::Link *link1 = contact->collision1->GetLink().get();
+        const physics::Link *other = (link1 == trackLink.get()) ?
+            contact->collision2->GetLink().get() : link1;
+        if (std::find(visitedTracks.begin(), visitedTracks.end(), other) ==
+            visitedTracks.end())
+        {
+          contacts.push_back(contact);
+        }
+      }
+      visitedTracks.push_back(trackLink.get());
+    }
+  }
 
+  for (auto contact : contacts)
+  {
     if (contact->collision1->GetSurface()->collideWithoutContact ||
       contact->collision2->GetSurface()->collideWithoutContact)
       continue;
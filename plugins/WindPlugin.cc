@@ -16,6 +16,7 @@
 */
 
 #include <functional>
+#include <string>
 
 #include <ignition/common/Profiler.hh>
 
@@ -222,8 +223,17 @@ void WindPlugin::Load(physics::WorldPtr _world, sdf::ElementPtr _sdf)
   this->dataPtr->kDir =
       period / this->dataPtr->characteristicTimeForWindOrientationChange;
 
-  wind.SetLinearVelFunc(std::bind(&WindPlugin::LinearVel, this,
-        std::placeholders::_1, std::placeholders::_2));
+  // A wind grid replaces the uniform wind model
+  if (_sdf->HasElement("grid_file"))
+  {
+    if (!wind.LoadGrid(_sdf->Get<std::string>("grid_file")))
+      return;
+  }
+  else
+  {
+    wind.SetLinearVelFunc(std::bind(&WindPlugin::LinearVel, this,
+          std::placeholders::_1, std::placeholders::_2));
+  }
 
   this->dataPtr->updateConnection = event::Events::ConnectWorldUpdateBegin(
           std::bind(&WindPlugin::OnUpdate, this));
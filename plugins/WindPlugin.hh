@@ -45,6 +45,9 @@ namespace gazebo
   //
   // - Vertical amplitude:
   //      Noise proportionnal to wind magnitude.
+  //
+  // Alternatively, <grid_file> loads a gridded wind field, see
+  // physics::Wind::LoadGrid, and the uniform model is not used.
   class GZ_PLUGIN_VISIBLE WindPlugin : public WorldPlugin
   {
     /// \brief Constructor.
@@ -15,6 +15,8 @@
  *
 */
 
+#include <sstream>
+
 #include "gazebo/common/Timer.hh"
 
 #include "gazebo/sensors/sensors.hh"
@@ -141,6 +143,54 @@ TEST_F(LogicalCameraSensor, Box)
   ASSERT_EQ(cam->Image().model_size(), 1);
 }
 
+/////////////////////////////////////////////////
+TEST_F(LogicalCameraSensor, ModelWithoutCollision)
+{
+  Load("worlds/logical_camera.world");
+
+  // Wait until the sensors have been initialized
+  while (!sensors::SensorManager::Instance()->SensorsInitialized())
+    common::Time::MSleep(1000);
+
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != NULL);
+
+  physics::ModelPtr cameraModel = world->ModelByName("box");
+  ASSERT_TRUE(cameraModel != NULL);
+
+  sensors::LogicalCameraSensorPtr cam = std::dynamic_pointer_cast<
+    sensors::LogicalCameraSensor>(sensors::get_sensor("logical_camera"));
+  ASSERT_TRUE(cam != NULL);
+
+  // Insert a model with a visual but no collision in front of the camera
+  std::ostringstream sdfStr;
+  sdfStr << "<sdf version='" << SDF_VERSION << "'>"
+    << "<model name='visual_only'>"
+    << "  <static>true</static>"
+    << "  <pose>2 0 0.5 0 0 0</pose>"
+    << "  <link name='link'>"
+    << "    <visual name='visual'>"
+    << "      <geometry><box><size>1 1 1</size></box></geometry>"
+    << "    </visual>"
+    << "  </link>"
+    << "</model>"
+    << "</sdf>";
+  SpawnSDF(sdfStr.str());
+  WaitUntilEntitySpawn("visual_only", 100, 100);
+
+  // The model has no bounding box, but its origin is in the frustum
+  cam->Update(true);
+  ASSERT_EQ(cam->Image().model_size(), 2);
+  EXPECT_EQ(cam->Image().model(0).name(), "ground_plane");
+  EXPECT_EQ(cam->Image().model(1).name(), "visual_only");
+
+  // Rotate the camera away from the model
+  cameraModel->SetWorldPose(ignition::math::Pose3d(0, 0, 0, 0, 0, 1.5707));
+  cam->Update(true);
+  ASSERT_EQ(cam->Image().model_size(), 1);
+  EXPECT_EQ(cam->Image().model(0).name(), "ground_plane");
+}
+
 /////////////////////////////////////////////////
 TEST_F(LogicalCameraSensor, NestedModels)
 {
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <mutex>
+
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+
+class ParallelWorlds : public ServerFixture
+{
+  /// \brief Callback for the counts published in the first world.
+  /// \param[in] _msg Counts.
+  public: void OnCounts0(ConstVector3dPtr &_msg)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->counts[0] = msgs::ConvertIgn(*_msg);
+  }
+
+  /// \brief Callback for the counts published in the second world.
+  /// \param[in] _msg Counts.
+  public: void OnCounts1(ConstVector3dPtr &_msg)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->counts[1] = msgs::ConvertIgn(*_msg);
+  }
+
+  /// \brief Get the last counts published in a world.
+  /// \param[in] _index Index of the world.
+  /// \return Counts.
+  public: ignition::math::Vector3d Counts(const unsigned int _index)
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->counts[_index];
+  }
+
+  /// \brief Protects counts.
+  public: std::mutex mutex;
+
+  /// \brief Last counts published in each world.
+  public: ignition::math::Vector3d counts[2];
+};
+
+/////////////////////////////////////////////////
+// A plugin loaded into each of two worlds stepped in parallel only receives
+// the events of its own world.
+TEST_F(ParallelWorlds, PluginEvents)
+{
+  this->LoadArgs("--worlds 2 worlds/world_events_test.world");
+
+  physics::WorldPtr worlds[2] = {
+    physics::get_world("world_events_0"),
+    physics::get_world("world_events_1")};
+  ASSERT_NE(worlds[0], nullptr);
+  ASSERT_NE(worlds[1], nullptr);
+
+  transport::SubscriberPtr subs[2] = {
+    this->node->Subscribe("/gazebo/world_events_0/world_events_test",
+        &ParallelWorlds::OnCounts0, this),
+    this->node->Subscribe("/gazebo/world_events_1/world_events_test",
+        &ParallelWorlds::OnCounts1, this)};
+
+  // Wait for both plugins to see a few updates
+  int sleep = 0;
+  while ((this->Counts(0).X() < 100 || this->Counts(1).X() < 100) &&
+         sleep++ < 300)
+  {
+    common::Time::MSleep(100);
+  }
+
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    EXPECT_GE(this->Counts(i).X(), 100) << worlds[i]->Name();
+    EXPECT_DOUBLE_EQ(this->Counts(i).Y(), 0) << worlds[i]->Name();
+    EXPECT_DOUBLE_EQ(this->Counts(i).Z(), 0) << worlds[i]->Name();
+  }
+
+  // Pausing one world leaves the other one running
+  worlds[0]->SetPaused(true);
+  EXPECT_TRUE(worlds[0]->IsPaused());
+  EXPECT_FALSE(worlds[1]->IsPaused());
+
+  // Resetting one world only signals its own plugin
+  worlds[0]->Reset();
+  sleep = 0;
+  while (this->Counts(0).Z() < 1 && sleep++ < 100)
+    common::Time::MSleep(100);
+  common::Time::MSleep(500);
+
+  EXPECT_DOUBLE_EQ(this->Counts(0).Z(), 1);
+  EXPECT_DOUBLE_EQ(this->Counts(1).Z(), 0);
+  EXPECT_DOUBLE_EQ(this->Counts(0).Y(), 0);
+  EXPECT_DOUBLE_EQ(this->Counts(1).Y(), 0);
+  EXPECT_FALSE(worlds[1]->IsPaused());
+}
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -15,6 +15,9 @@
  *
 */
 
+#include <string>
+#include <vector>
+
 #include "gazebo/test/ServerFixture.hh"
 #include "gazebo/physics/physics.hh"
 #include "gazebo/test/helper_physics_generator.hh"
@@ -25,6 +28,8 @@ class RayShapeTest : public ServerFixture,
                      public testing::WithParamInterface<const char*>
 {
   public: void Standalone(const std::string &_physicsEngine);
+
+  public: void Intersections(const std::string &_physicsEngine);
 };
 
 /////////////////////////////////////////////////
@@ -76,6 +81,67 @@ TEST_P(RayShapeTest, Standalone)
   Standalone(GetParam());
 }
 
+/////////////////////////////////////////////////
+void RayShapeTest::Intersections(const std::string &_physicsEngine)
+{
+  // Load the shapes world
+  Load("worlds/shapes.world", true, _physicsEngine);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != NULL);
+
+  gazebo::physics::RayShapePtr ray =
+    boost::dynamic_pointer_cast<gazebo::physics::RayShape>(
+        world->Physics()->CreateShape("ray",
+          gazebo::physics::CollisionPtr()));
+  ASSERT_TRUE(ray != NULL);
+
+  ray->SetPoints(ignition::math::Vector3d(0, 0, 5),
+                 ignition::math::Vector3d(0, 0, 6));
+
+  // Many copies of the segments of the Standalone test, so they are split
+  // between threads
+  const std::vector<ignition::math::Vector3d> starts = {
+    {-1, 0, 0.5}, {-1, 1.5, 0.5}, {-1, -1.5, 0.5}, {-1, -10.5, 0.5}};
+  const std::vector<std::string> names = {
+    "box::link::collision", "sphere::link::collision",
+    "cylinder::link::collision", ""};
+
+  std::vector<ignition::math::Vector3d> batchStarts;
+  std::vector<ignition::math::Vector3d> batchEnds;
+  for (unsigned int i = 0; i < 1000; ++i)
+  {
+    const ignition::math::Vector3d &start = starts[i % starts.size()];
+    batchStarts.push_back(start);
+    batchEnds.push_back(start + ignition::math::Vector3d(11, 0, 0));
+  }
+
+  std::vector<double> dists;
+  std::vector<std::string> entities;
+  ray->Intersections(batchStarts, batchEnds, dists, entities);
+  ASSERT_EQ(dists.size(), batchStarts.size());
+  ASSERT_EQ(entities.size(), batchStarts.size());
+
+  for (unsigned int i = 0; i < batchStarts.size(); ++i)
+  {
+    EXPECT_EQ(entities[i], names[i % names.size()]);
+    if (!entities[i].empty())
+      EXPECT_NEAR(dists[i], 0.5, 1e-4);
+  }
+
+  // The points of the ray are unchanged
+  ignition::math::Vector3d start;
+  ignition::math::Vector3d end;
+  ray->RelativePoints(start, end);
+  EXPECT_EQ(start, ignition::math::Vector3d(0, 0, 5));
+  EXPECT_EQ(end, ignition::math::Vector3d(0, 0, 6));
+}
+
+/////////////////////////////////////////////////
+TEST_P(RayShapeTest, Intersections)
+{
+  Intersections(GetParam());
+}
+
 /////////////////////////////////////////////////
 INSTANTIATE_TEST_CASE_P(PhysicsEngines, RayShapeTest,
     ::testing::Values("ode"),);  // NOLINT
@@ -146,6 +146,15 @@ void SpeedThreadIslandsTest::ThreadSpeedup(const std::string &_physicsEngine,
             << "\t Max[" << threadMaxTime << "]\n"
             << "\t Min[" << threadMinTime << "]\n";
 
+  // The island threads were busy for part of the last step
+  {
+    double utilization;
+    EXPECT_NO_THROW(utilization = boost::any_cast<double>(
+          physics->GetParam("island_thread_utilization")));
+    EXPECT_GT(utilization, 0.0);
+    EXPECT_LE(utilization, 1.0);
+  }
+
   // Expect best-case computational time to decrease
   EXPECT_LT(threadMinTime, baseMinTime);
 }
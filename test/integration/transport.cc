@@ -18,6 +18,12 @@
 #ifndef _WIN32
 #include <unistd.h>
 #endif
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "gazebo/transport/MessagePool.hh"
 #include "gazebo/test/ServerFixture.hh"
 
 using namespace gazebo;
@@ -788,6 +794,110 @@ TEST_F(TransportTest, TryInit)
   EXPECT_EQ(physics::get_world()->Name(), node->GetTopicNamespace());
 }
 
+/////////////////////////////////////////////////
+std::mutex g_transportStatsMutex;
+msgs::TransportStats g_transportStats;
+
+/////////////////////////////////////////////////
+void ReceiveTransportStats(ConstTransportStatsPtr &_msg)
+{
+  std::lock_guard<std::mutex> lock(g_transportStatsMutex);
+  g_transportStats = *_msg;
+}
+
+/////////////////////////////////////////////////
+TEST_F(TransportTest, Stats)
+{
+  Load("worlds/empty.world");
+  transport::NodePtr node = transport::NodePtr(new transport::Node());
+  node->Init("default");
+
+  transport::PublisherPtr pub =
+    node->Advertise<msgs::GzString>("~/test/stats", 5);
+  transport::SubscriberPtr stringSub =
+    node->Subscribe("~/test/stats", &ReceiveStringMsg);
+  transport::SubscriberPtr statsSub = node->Subscribe(
+      transport::TopicManager::StatsTopic, &ReceiveTransportStats);
+
+  msgs::GzString msg;
+  msg.set_data("stats");
+  for (int i = 0; i < 20; ++i)
+    pub->Publish(msg);
+
+  // Statistics are published once per second
+  bool found = false;
+  for (int i = 0; i < 30 && !found; ++i)
+  {
+    common::Time::MSleep(100);
+
+    std::lock_guard<std::mutex> lock(g_transportStatsMutex);
+    for (auto const &publication : g_transportStats.publication())
+    {
+      if (publication.topic() != "/gazebo/default/test/stats")
+        continue;
+
+      found = true;
+      EXPECT_EQ(publication.msg_type(), "gazebo.msgs.GzString");
+      EXPECT_EQ(publication.publishers(), 1u);
+      EXPECT_GE(publication.local_subscribers(), 1u);
+      EXPECT_EQ(publication.published(), 20u);
+      EXPECT_LE(publication.max_queue_depth(), 5u);
+      EXPECT_EQ(publication.serialize_time().bucket_size(),
+          static_cast<int>(transport::LatencyHistogram::BucketCount));
+    }
+  }
+  EXPECT_TRUE(found);
+
+  std::lock_guard<std::mutex> lock(g_transportStatsMutex);
+  EXPECT_FALSE(g_transportStats.host().empty());
+  EXPECT_GT(g_transportStats.port(), 0u);
+}
+
+/////////////////////////////////////////////////
+std::mutex g_sharedMutex;
+std::condition_variable g_sharedReceived;
+std::vector<const msgs::GzString *> g_sharedMsgs;
+
+/////////////////////////////////////////////////
+void ReceiveSharedMsg(ConstGzStringPtr &_msg)
+{
+  std::lock_guard<std::mutex> lock(g_sharedMutex);
+  g_sharedMsgs.push_back(_msg.get());
+  g_sharedReceived.notify_all();
+}
+
+/////////////////////////////////////////////////
+// Local subscribers get the message given to PublishShared, not a copy
+TEST_F(TransportTest, PublishShared)
+{
+  Load("worlds/empty.world");
+  transport::NodePtr node = transport::NodePtr(new transport::Node());
+  node->Init("default");
+
+  transport::PublisherPtr pub =
+    node->Advertise<msgs::GzString>("~/test/shared", 10);
+  transport::SubscriberPtr sub =
+    node->Subscribe("~/test/shared", &ReceiveSharedMsg);
+
+  transport::MessagePool<msgs::GzString> pool;
+  std::vector<const msgs::GzString *> published;
+  for (unsigned int i = 0; i < 10; ++i)
+  {
+    boost::shared_ptr<msgs::GzString> msg = pool.Acquire();
+    msg->set_data("shared_" + std::to_string(i));
+    published.push_back(msg.get());
+    pub->PublishShared(msg);
+
+    std::unique_lock<std::mutex> lock(g_sharedMutex);
+    ASSERT_TRUE(g_sharedReceived.wait_for(lock, std::chrono::seconds(5),
+          [&]() {return g_sharedMsgs.size() == i + 1;}));
+  }
+
+  std::lock_guard<std::mutex> lock(g_sharedMutex);
+  EXPECT_EQ(g_sharedMsgs, published);
+  g_sharedMsgs.clear();
+}
+
 /////////////////////////////////////////////////
 // Main
 int main(int argc, char **argv)
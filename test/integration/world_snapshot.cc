@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gazebo/common/Timer.hh"
+#include "gazebo/physics/physics.hh"
+#include "gazebo/test/ServerFixture.hh"
+#include "gazebo/test/helper_physics_generator.hh"
+
+using namespace gazebo;
+
+class WorldSnapshotTest : public ServerFixture,
+                          public ::testing::WithParamInterface<const char *>
+{
+  /// \brief Load a world with falling boxes and a falling pendulum, so that
+  /// the snapshot has contacts and joints.
+  /// \param[in] _physicsEngine Physics engine type.
+  /// \return The world.
+  public: physics::WorldPtr LoadWorld(const std::string &_physicsEngine);
+
+  /// \brief Restore a snapshot, step again, and compare the states of the
+  /// links with those of the first run.
+  /// \param[in] _physicsEngine Physics engine type.
+  public: void RestoreAndStep(const std::string &_physicsEngine);
+
+  /// \brief Check that a snapshot is not restored after a model is removed.
+  /// \param[in] _physicsEngine Physics engine type.
+  public: void ModelRemoved(const std::string &_physicsEngine);
+
+  /// \brief Get the pose and velocities of every link.
+  /// \param[in] _world The world.
+  /// \return Poses and velocities.
+  public: static std::vector<double> LinkStates(physics::WorldPtr _world);
+};
+
+/////////////////////////////////////////////////
+physics::WorldPtr WorldSnapshotTest::LoadWorld(
+    const std::string &_physicsEngine)
+{
+  Load("worlds/empty.world", true, _physicsEngine);
+  physics::WorldPtr world = physics::get_world("default");
+  if (!world)
+    return world;
+
+  // Overlapping boxes, pushed apart by contacts as they fall
+  for (int i = 0; i < 4; ++i)
+  {
+    SpawnBox("box_" + std::to_string(i),
+        ignition::math::Vector3d(0.5, 0.5, 0.5),
+        ignition::math::Vector3d(0.1 * i, 0.05 * i, 0.3 + 0.4 * i),
+        ignition::math::Vector3d(0.1 * i, 0.2 * i, 0));
+  }
+
+  std::ostringstream sdf;
+  sdf << "<sdf version='" << SDF_VERSION << "'>"
+      << "<model name='pendulum'>"
+      << "  <pose>0 2 1 0.3 0 0</pose>"
+      << "  <link name='base'>"
+      << "    <collision name='collision'>"
+      << "      <geometry><box><size>0.3 0.3 0.3</size></box></geometry>"
+      << "    </collision>"
+      << "  </link>"
+      << "  <link name='arm'>"
+      << "    <pose>0 0.5 0 0 0 0</pose>"
+      << "    <collision name='collision'>"
+      << "      <geometry><box><size>0.1 1 0.1</size></box></geometry>"
+      << "    </collision>"
+      << "  </link>"
+      << "  <joint name='hinge' type='revolute'>"
+      << "    <parent>base</parent>"
+      << "    <child>arm</child>"
+      << "    <pose>0 -0.5 0 0 0 0</pose>"
+      << "    <axis><xyz>1 0 0</xyz></axis>"
+      << "  </joint>"
+      << "</model>"
+      << "</sdf>";
+  SpawnSDF(sdf.str());
+  WaitUntilEntitySpawn("pendulum", 100, 50);
+
+  return world;
+}
+
+/////////////////////////////////////////////////
+std::vector<double> WorldSnapshotTest::LinkStates(physics::WorldPtr _world)
+{
+  std::vector<double> states;
+  for (auto const &model : _world->Models())
+  {
+    for (auto const &link : model->GetLinks())
+    {
+      const ignition::math::Pose3d pose = link->WorldPose();
+      const ignition::math::Vector3d linearVel = link->WorldLinearVel();
+      const ignition::math::Vector3d angularVel = link->WorldAngularVel();
+      states.insert(states.end(), {pose.Pos().X(), pose.Pos().Y(),
+          pose.Pos().Z(), pose.Rot().W(), pose.Rot().X(), pose.Rot().Y(),
+          pose.Rot().Z(), linearVel.X(), linearVel.Y(), linearVel.Z(),
+          angularVel.X(), angularVel.Y(), angularVel.Z()});
+    }
+  }
+  return states;
+}
+
+/////////////////////////////////////////////////
+void WorldSnapshotTest::RestoreAndStep(const std::string &_physicsEngine)
+{
+  physics::WorldPtr world = this->LoadWorld(_physicsEngine);
+  ASSERT_TRUE(world != nullptr);
+  ASSERT_TRUE(world->ModelByName("pendulum") != nullptr);
+
+  // Step until the models are falling and colliding
+  world->Step(200);
+
+  physics::WorldSnapshotPtr snapshot = world->Snapshot();
+  if (_physicsEngine == "simbody")
+  {
+    // Not supported: an error is logged and the world keeps running
+    EXPECT_TRUE(snapshot == nullptr);
+    EXPECT_FALSE(world->Restore(snapshot));
+    const uint64_t iterations = world->Iterations();
+    world->Step(10);
+    EXPECT_EQ(world->Iterations(), iterations + 10);
+    return;
+  }
+  ASSERT_TRUE(snapshot != nullptr);
+  EXPECT_GT(snapshot->Size(), 0u);
+
+  const common::Time simTime = world->SimTime();
+  const uint64_t iterations = world->Iterations();
+  const std::vector<double> start = LinkStates(world);
+
+  const unsigned int steps = 500;
+  world->Step(steps);
+  const std::vector<double> first = LinkStates(world);
+  EXPECT_NE(first, start);
+
+  common::Timer timer;
+  timer.Start();
+  ASSERT_TRUE(world->Restore(snapshot));
+  const double restoreTime = timer.GetElapsed().Double();
+
+  EXPECT_EQ(world->SimTime(), simTime);
+  EXPECT_EQ(world->Iterations(), iterations);
+  EXPECT_EQ(LinkStates(world), start);
+
+  world->Step(steps);
+  const std::vector<double> second = LinkStates(world);
+
+  // Bullet contact manifolds restart cold after a restore, so only
+  // restores are bit-exact with each other
+  if (_physicsEngine != "bullet")
+    EXPECT_EQ(second, first);
+
+  ASSERT_TRUE(world->Restore(snapshot));
+  world->Step(steps);
+  EXPECT_EQ(LinkStates(world), second);
+
+  timer.Start();
+  world->Reset();
+  const double resetTime = timer.GetElapsed().Double();
+
+  gzdbg << _physicsEngine << " snapshot [" << snapshot->Size()
+        << " bytes] restore [" << restoreTime * 1e6
+        << " us] reset [" << resetTime * 1e6 << " us]\n";
+}
+
+/////////////////////////////////////////////////
+TEST_P(WorldSnapshotTest, RestoreAndStep)
+{
+  RestoreAndStep(GetParam());
+}
+
+/////////////////////////////////////////////////
+void WorldSnapshotTest::ModelRemoved(const std::string &_physicsEngine)
+{
+  if (_physicsEngine == "simbody")
+  {
+    gzerr << "Simbody does not support snapshots, see RestoreAndStep"
+          << std::endl;
+    return;
+  }
+
+  physics::WorldPtr world = this->LoadWorld(_physicsEngine);
+  ASSERT_TRUE(world != nullptr);
+
+  world->Step(10);
+  physics::WorldSnapshotPtr snapshot = world->Snapshot();
+  ASSERT_TRUE(snapshot != nullptr);
+
+  world->RemoveModel("box_0");
+  world->Step(10);
+  const common::Time simTime = world->SimTime();
+  EXPECT_FALSE(world->Restore(snapshot));
+  EXPECT_EQ(world->SimTime(), simTime);
+  EXPECT_FALSE(world->Restore(nullptr));
+}
+
+/////////////////////////////////////////////////
+TEST_P(WorldSnapshotTest, ModelRemoved)
+{
+  ModelRemoved(GetParam());
+}
+
+/////////////////////////////////////////////////
+// The ODE contact cache carries the constraint forces of the contacts to
+// the next step, so it is part of the snapshot
+TEST_F(WorldSnapshotTest, ODEContactCache)
+{
+  physics::WorldPtr world = this->LoadWorld("ode");
+  ASSERT_TRUE(world != nullptr);
+  physics::PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+  ASSERT_TRUE(physics->SetParam("contact_cache", true));
+
+  world->Step(200);
+  physics::WorldSnapshotPtr snapshot = world->Snapshot();
+  ASSERT_TRUE(snapshot != nullptr);
+
+  world->Step(1);
+  const int hits = boost::any_cast<int>(
+      physics->GetParam("contact_cache_hits"));
+  world->Step(299);
+  const std::vector<double> first = LinkStates(world);
+
+  // Step with a cold cache, which changes the solution
+  ASSERT_TRUE(world->Restore(snapshot));
+  ASSERT_TRUE(physics->SetParam("contact_cache", false));
+  ASSERT_TRUE(physics->SetParam("contact_cache", true));
+  world->Step(300);
+  EXPECT_NE(LinkStates(world), first);
+
+  ASSERT_TRUE(world->Restore(snapshot));
+  world->Step(1);
+  EXPECT_EQ(boost::any_cast<int>(physics->GetParam("contact_cache_hits")),
+      hits);
+  world->Step(299);
+  EXPECT_EQ(LinkStates(world), first);
+}
+
+INSTANTIATE_TEST_CASE_P(PhysicsEngines, WorldSnapshotTest,
+    PHYSICS_ENGINE_VALUES,);  // NOLINT
+
+/////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+#include <boost/any.hpp>
+
+#include "gazebo/gazebo_config.h"
+#include "gazebo/common/Timer.hh"
+#include "gazebo/physics/physics.hh"
+#include "gazebo/test/ServerFixture.hh"
+
+using namespace gazebo;
+
+/// \brief A world stepped with each value of a physics parameter.
+struct StepCase
+{
+  /// \brief World file.
+  std::string world;
+
+  /// \brief Physics engine.
+  std::string engine;
+
+  /// \brief Physics parameter changed between the runs.
+  std::string param;
+
+  /// \brief Values of the parameter, each with a label for the output.
+  std::vector<std::pair<std::string, boost::any>> values;
+};
+
+/////////////////////////////////////////////////
+std::ostream &operator<<(std::ostream &_out, const StepCase &_case)
+{
+  return _out << _case.world << " [" << _case.engine << "] " << _case.param;
+}
+
+class PhysicsStepStressTest : public ServerFixture,
+                              public testing::WithParamInterface<StepCase>
+{
+};
+
+/// \brief Number of steps timed for each value.
+const unsigned int stepCount = 1000;
+
+/////////////////////////////////////////////////
+// Step the same world from the same state with each value of a physics
+// parameter, and report the wall time per step
+TEST_P(PhysicsStepStressTest, StepTime)
+{
+  const StepCase &stepCase = GetParam();
+
+  Load(stepCase.world, true, stepCase.engine);
+  physics::WorldPtr world = physics::get_world("default");
+  ASSERT_TRUE(world != nullptr);
+  physics::PhysicsEnginePtr physics = world->Physics();
+  ASSERT_TRUE(physics != nullptr);
+
+  // Plugins such as the rubble plugin insert their models while stepping
+  unsigned int stable = 0;
+  for (unsigned int i = 0; i < 500 && stable < 10; ++i)
+  {
+    const unsigned int count = world->ModelCount();
+    world->Step(1);
+    stable = world->ModelCount() == count ? stable + 1 : 0;
+  }
+
+  // Let the models settle
+  world->Step(200);
+  physics::WorldSnapshotPtr snapshot = world->Snapshot();
+  ASSERT_TRUE(snapshot != nullptr);
+
+  gzdbg << stepCase << ", models [" << world->ModelCount() << "] steps ["
+        << stepCount << "]\n";
+  for (auto const &value : stepCase.values)
+  {
+    ASSERT_TRUE(world->Restore(snapshot));
+    if (!physics->SetParam(stepCase.param, value.second))
+    {
+      gzdbg << "  [" << value.first << "] is not available, skipping\n";
+      continue;
+    }
+
+    common::Timer timer;
+    timer.Start();
+    world->Step(stepCount);
+    const double time = timer.GetElapsed().Double();
+
+    gzdbg << "  [" << value.first << "] wall time per step ["
+          << time / stepCount * 1e3 << " ms] real time factor ["
+          << stepCount * physics->GetMaxStepSize() / time << "]\n";
+  }
+}
+
+/////////////////////////////////////////////////
+/// \brief Get the worlds and parameters to time.
+/// \return The cases.
+std::vector<StepCase> StepCases()
+{
+  std::vector<StepCase> cases = {
+    {"worlds/stacks.world", "ode", "contact_cache",
+      {{"off", false}, {"on", true}}},
+    {"worlds/rubble.world", "ode", "broadphase",
+      {{"hash", std::string("hash")}, {"auto", std::string("auto")},
+       {"sap", std::string("sap")}, {"bvh", std::string("bvh")}}},
+    {"worlds/rubble.world", "ode", "solver_type",
+      {{"quick", std::string("quick")},
+       {"parallel_quick", std::string("parallel_quick")}}},
+    {"worlds/rubble.world", "ode", "row_coloring_threads",
+      {{"sequential", 0}, {"1 thread", 1}, {"4 threads", 4}}},
+    {"worlds/rubble.world", "ode", "island_threads",
+      {{"no threads", 0}, {"4 threads", 4}}}};
+
+#ifdef HAVE_BULLET
+  // The world asks for 4 threads, so it can step on fewer
+  cases.push_back({"test/worlds/bullet_threads.world", "bullet", "threads",
+      {{"1 thread", 1}, {"2 threads", 2}, {"4 threads", 4}}});
+#endif
+
+  return cases;
+}
+
+INSTANTIATE_TEST_CASE_P(Physics, PhysicsStepStressTest,
+    ::testing::ValuesIn(StepCases()));
+
+/////////////////////////////////////////////////
+/// Main
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
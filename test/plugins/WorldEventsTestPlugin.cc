@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#include "plugins/WorldEventsTestPlugin.hh"
+
+using namespace gazebo;
+
+GZ_REGISTER_WORLD_PLUGIN(WorldEventsTestPlugin)
+
+/////////////////////////////////////////////////
+WorldEventsTestPlugin::WorldEventsTestPlugin()
+{
+}
+
+/////////////////////////////////////////////////
+void WorldEventsTestPlugin::Load(physics::WorldPtr _world,
+                                 sdf::ElementPtr /*_sdf*/)
+{
+  this->world = _world;
+
+  this->node = transport::NodePtr(new transport::Node());
+  this->node->Init(this->world->Name());
+  this->countsPub =
+    this->node->Advertise<msgs::Vector3d>("~/world_events_test");
+
+  this->connections.push_back(event::Events::ConnectWorldUpdateBegin(
+      std::bind(&WorldEventsTestPlugin::OnUpdate, this,
+        std::placeholders::_1)));
+  this->connections.push_back(event::Events::ConnectWorldReset(
+      std::bind(&WorldEventsTestPlugin::OnReset, this)));
+}
+
+/////////////////////////////////////////////////
+void WorldEventsTestPlugin::OnUpdate(const common::UpdateInfo &_info)
+{
+  if (_info.worldName == this->world->Name())
+    ++this->ownUpdates;
+  else
+    ++this->otherUpdates;
+
+  this->Publish();
+}
+
+/////////////////////////////////////////////////
+void WorldEventsTestPlugin::OnReset()
+{
+  ++this->resets;
+  this->Publish();
+}
+
+/////////////////////////////////////////////////
+void WorldEventsTestPlugin::Publish()
+{
+  msgs::Vector3d msg;
+  msg.set_x(this->ownUpdates);
+  msg.set_y(this->otherUpdates);
+  msg.set_z(this->resets);
+  this->countsPub->Publish(msg);
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+#ifndef GAZEBO_TEST_PLUGINS_WORLDEVENTSTESTPLUGIN_HH_
+#define GAZEBO_TEST_PLUGINS_WORLDEVENTSTESTPLUGIN_HH_
+
+#include <vector>
+
+#include "gazebo/common/Plugin.hh"
+#include "gazebo/physics/physics.hh"
+#include "gazebo/transport/transport.hh"
+#include "gazebo/util/system.hh"
+
+namespace gazebo
+{
+  /// \brief Counts the world events its callbacks receive, and publishes
+  /// the counts on ~/world_events_test as a Vector3d: x is the number of
+  /// update events of its own world, y the number of update events of other
+  /// worlds, and z the number of reset events.
+  class GAZEBO_VISIBLE WorldEventsTestPlugin : public WorldPlugin
+  {
+    /// \brief Constructor.
+    public: WorldEventsTestPlugin();
+
+    // Documentation inherited
+    public: virtual void Load(physics::WorldPtr _world, sdf::ElementPtr _sdf);
+
+    /// \brief Called on every world update.
+    /// \param[in] _info Information about the world being updated.
+    private: void OnUpdate(const common::UpdateInfo &_info);
+
+    /// \brief Called on every world reset.
+    private: void OnReset();
+
+    /// \brief Publish the counts.
+    private: void Publish();
+
+    /// \brief World the plugin is loaded into.
+    private: physics::WorldPtr world;
+
+    /// \brief Node used to publish the counts.
+    private: transport::NodePtr node;
+
+    /// \brief Publisher of the counts.
+    private: transport::PublisherPtr countsPub;
+
+    /// \brief Update events of the plugin's world.
+    private: unsigned int ownUpdates = 0;
+
+    /// \brief Update events of other worlds.
+    private: unsigned int otherUpdates = 0;
+
+    /// \brief Reset events.
+    private: unsigned int resets = 0;
+
+    /// \brief Event connections.
+    private: std::vector<event::ConnectionPtr> connections;
+  };
+}
+#endif
@@ -900,7 +900,9 @@ StatsCommand::StatsCommand()
     ("world-name,w", po::value<std::string>(), "World name.")
     ("duration,d", po::value<uint64_t>(), "Duration (seconds) to run.")
     ("plot,p", "Output comma-separated values, useful for processing and "
-     "plotting.");
+     "plotting.")
+    ("callbacks,c", "Print per-plugin callback execution times instead. "
+     "Requires gzserver to run with GAZEBO_CALLBACK_ACCOUNTING=1.");
 }
 
 /////////////////////////////////////////////////
@@ -910,6 +912,9 @@ void StatsCommand::HelpDetailed()
     "\tPrint gzserver statics to standard out. If a name for the world, \n"
     "\toption -w, is not specified, the first world found on \n"
     "\tthe Gazebo master will be used.\n"
+    "\n"
+    "\tWith option -c, the rolling mean and 99th percentile execution\n"
+    "\ttime of the event callbacks of each plugin are printed instead.\n"
     << std::endl;
 }
 
@@ -924,8 +929,14 @@ bool StatsCommand::RunImpl()
   transport::NodePtr node(new transport::Node());
   node->Init(worldName);
 
-  transport::SubscriberPtr sub =
-    node->Subscribe("~/world_stats", &StatsCommand::CB, this);
+  transport::SubscriberPtr sub;
+  if (this->vm.count("callbacks"))
+  {
+    sub = node->Subscribe("~/diagnostics/callbacks",
+        &StatsCommand::OnCallbackStats, this);
+  }
+  else
+    sub = node->Subscribe("~/world_stats", &StatsCommand::CB, this);
 
   boost::mutex::scoped_lock lock(this->sigMutex);
   if (this->vm.count("duration"))
@@ -1002,6 +1013,48 @@ void StatsCommand::CB(ConstWorldStatisticsPtr &_msg)
         percent, simTime.Double(), realTime.Double(), paused);
 }
 
+/////////////////////////////////////////////////
+void StatsCommand::OnCallbackStats(ConstCallbackStatisticsPtr &_msg)
+{
+  GZ_ASSERT(_msg, "Invalid message received");
+
+  const bool plot = this->vm.count("plot") > 0;
+  if (plot)
+  {
+    static bool first = true;
+    if (first)
+    {
+      std::cout << "# simtime (sec), callback, count, mean (ms), "
+        << "p99 (ms), max (ms)\n";
+      first = false;
+    }
+  }
+  else
+  {
+    printf("SimTime[%4.2f]\n%-60s %10s %10s %10s %10s\n",
+        msgs::Convert(_msg->sim_time()).Double(), "Callback", "Count",
+        "Mean(ms)", "P99(ms)", "Max(ms)");
+  }
+
+  for (auto const &cb : _msg->callback())
+  {
+    if (plot)
+    {
+      printf("%16.6f, %s, %s, %f, %f, %f\n",
+          msgs::Convert(_msg->sim_time()).Double(), cb.name().c_str(),
+          std::to_string(cb.count()).c_str(), cb.mean() * 1e3,
+          cb.p99() * 1e3, cb.max() * 1e3);
+    }
+    else
+    {
+      printf("%-60s %10s %10.4f %10.4f %10.4f\n", cb.name().c_str(),
+          std::to_string(cb.count()).c_str(), cb.mean() * 1e3,
+          cb.p99() * 1e3, cb.max() * 1e3);
+    }
+  }
+  fflush(stdout);
+}
+
 /////////////////////////////////////////////////
 SDFCommand::SDFCommand()
   : Command("sdf",
@@ -195,6 +195,10 @@ namespace gazebo
     /// \param[in] _msg World statistics message.
     private: void CB(ConstWorldStatisticsPtr &_msg);
 
+    /// \brief Callback statistics callback.
+    /// \param[in] _msg Callback statistics message.
+    private: void OnCallbackStats(ConstCallbackStatisticsPtr &_msg);
+
     /// \brief Sim time buffer
     private: std::list<common::Time> simTimes;
 
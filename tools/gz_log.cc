@@ -14,6 +14,17 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
 #include <boost/algorithm/string.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/date_time/posix_time/posix_time_io.hpp>
@@ -22,7 +33,13 @@
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/copy.hpp>
 
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
 #include <ignition/math/Pose3.hh>
+#include <ignition/math/Rand.hh>
 #include <ignition/math/Vector3.hh>
 
 #include <gazebo/util/util.hh>
@@ -32,17 +49,328 @@ sdf::ElementPtr g_stateSdf;
 
 using namespace gazebo;
 
+namespace
+{
+  /// \brief A child element of the <state> element of a log frame.
+  struct StateChild
+  {
+    /// \brief Tag of the element.
+    std::string tag;
+
+    /// \brief Value of the name attribute.
+    std::string name;
+
+    /// \brief Offset of the start tag.
+    size_t begin = 0;
+
+    /// \brief Offset of the content.
+    size_t contentBegin = 0;
+
+    /// \brief Offset of the end tag.
+    size_t contentEnd = 0;
+
+    /// \brief Offset past the end of the element.
+    size_t end = 0;
+  };
+
+  /// \brief A frame of a log file.
+  struct LogFrame
+  {
+    /// \brief The frame, pruned by StateFilter::Prune.
+    std::string text;
+
+    /// \brief Simulation time of the frame.
+    common::Time simTime;
+
+    /// \brief True if the frame passed the Hz filter.
+    bool accepted = false;
+
+    /// \brief Output of StateFilter::FilterState.
+    std::string output;
+  };
+
+  /// \brief A chunk of a log file.
+  struct LogChunk
+  {
+    /// \brief Encoded data of the chunk.
+    std::string data;
+
+    /// \brief Encoding of the chunk.
+    std::string encoding;
+
+    /// \brief True if the chunk was decoded.
+    bool valid = false;
+
+    /// \brief Frames of the chunk.
+    std::vector<LogFrame> frames;
+  };
+
+  /////////////////////////////////////////////////
+  /// \brief Find the child elements of the <state> element of a log frame
+  /// by scanning its tags, which is much cheaper than parsing the frame.
+  /// \param[in] _frame The frame.
+  /// \param[out] _children The children of the <state> element. Empty if
+  /// the frame has no <state> element.
+  /// \return False if the frame is not well formed.
+  bool ScanState(const std::string &_frame,
+      std::vector<StateChild> &_children)
+  {
+    int depth = 0;
+    int stateDepth = -1;
+    StateChild child;
+
+    size_t pos = _frame.find('<');
+    while (pos != std::string::npos)
+    {
+      // Skip comments, character data and processing instructions.
+      std::string skipEnd;
+      if (_frame.compare(pos, 4, "<!--") == 0)
+        skipEnd = "-->";
+      else if (_frame.compare(pos, 9, "<![CDATA[") == 0)
+        skipEnd = "]]>";
+      else if (_frame.compare(pos, 2, "<?") == 0)
+        skipEnd = "?>";
+
+      if (!skipEnd.empty())
+      {
+        pos = _frame.find(skipEnd, pos);
+        if (pos == std::string::npos)
+          return false;
+        pos = _frame.find('<', pos + skipEnd.size());
+        continue;
+      }
+
+      // Find the end of the tag. Quoted values may contain '>'.
+      size_t tagEnd = pos + 1;
+      char quote = '\0';
+      for (; tagEnd < _frame.size(); ++tagEnd)
+      {
+        const char c = _frame[tagEnd];
+        if (quote != '\0')
+        {
+          if (c == quote)
+            quote = '\0';
+        }
+        else if (c == '\'' || c == '"')
+          quote = c;
+        else if (c == '>')
+          break;
+      }
+
+      if (tagEnd >= _frame.size())
+        return false;
+
+      if (_frame[pos + 1] == '/')
+      {
+        --depth;
+        if (stateDepth >= 0 && depth == stateDepth)
+        {
+          child.contentEnd = pos;
+          child.end = tagEnd + 1;
+          _children.push_back(child);
+        }
+        else if (stateDepth >= 0 && depth < stateDepth)
+        {
+          // End of the <state> element.
+          return true;
+        }
+      }
+      else
+      {
+        const bool empty = _frame[tagEnd - 1] == '/';
+        const std::string tag = _frame.substr(pos + 1,
+            std::min(_frame.find_first_of(" \t\r\n/>", pos + 1), tagEnd) -
+            pos - 1);
+
+        if (stateDepth >= 0 && depth == stateDepth)
+        {
+          child = StateChild();
+          child.tag = tag;
+          child.begin = pos;
+          child.contentBegin = tagEnd + 1;
+
+          const std::string startTag = _frame.substr(pos, tagEnd - pos);
+          const size_t attr = startTag.find(" name=");
+          if (attr != std::string::npos && attr + 7 < startTag.size())
+          {
+            const size_t valueEnd = startTag.find(startTag[attr + 6],
+                attr + 7);
+            if (valueEnd != std::string::npos)
+              child.name = startTag.substr(attr + 7, valueEnd - attr - 7);
+          }
+
+          if (empty)
+          {
+            child.contentEnd = tagEnd + 1;
+            child.end = tagEnd + 1;
+            _children.push_back(child);
+          }
+        }
+        else if (stateDepth < 0 && tag == "state" && !empty)
+          stateDepth = depth + 1;
+
+        if (!empty)
+          ++depth;
+      }
+
+      pos = _frame.find('<', tagEnd + 1);
+    }
+
+    return stateDepth < 0;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Find the next complete <chunk> element of a log file.
+  /// \param[in] _text Part of the log file.
+  /// \param[in] _pos Offset to search from.
+  /// \param[out] _data Content of the chunk.
+  /// \param[out] _encoding Value of the encoding attribute.
+  /// \param[out] _end Offset past the end of the chunk.
+  /// \return False if _text has no complete chunk after _pos.
+  bool FindChunk(const std::string &_text, const size_t _pos,
+      std::string &_data, std::string &_encoding, size_t &_end)
+  {
+    const std::string endTag = "</chunk>";
+
+    const size_t begin = _text.find("<chunk", _pos);
+    const size_t tagEnd = _text.find('>', begin);
+    if (begin == std::string::npos || tagEnd == std::string::npos)
+      return false;
+
+    _encoding.clear();
+    const size_t attribute = _text.find("encoding", begin);
+    const size_t quote = _text.find_first_of("'\"", attribute);
+    if (attribute < tagEnd && quote < tagEnd)
+    {
+      const size_t valueEnd = _text.find(_text[quote], quote + 1);
+      if (valueEnd < tagEnd)
+        _encoding = _text.substr(quote + 1, valueEnd - quote - 1);
+    }
+
+    // Empty element
+    if (_text[tagEnd - 1] == '/')
+    {
+      _data.clear();
+      _end = tagEnd + 1;
+      return true;
+    }
+
+    // Whitespace before a CDATA section is not part of the content, as
+    // with tinyxml2.
+    size_t close;
+    const size_t content = _text.find_first_not_of(" \t\r\n", tagEnd + 1);
+    if (content != std::string::npos &&
+        _text.compare(content, 9, "<![CDATA[") == 0)
+    {
+      const size_t cdataEnd = _text.find("]]>", content + 9);
+      close = _text.find(endTag, cdataEnd);
+      if (cdataEnd == std::string::npos || close == std::string::npos)
+        return false;
+      _data = _text.substr(content + 9, cdataEnd - content - 9);
+    }
+    else
+    {
+      close = _text.find(endTag, tagEnd + 1);
+      if (close == std::string::npos)
+        return false;
+      _data = _text.substr(tagEnd + 1, close - tagEnd - 1);
+      boost::replace_all(_data, "&lt;", "<");
+      boost::replace_all(_data, "&gt;", ">");
+      boost::replace_all(_data, "&quot;", "\"");
+      boost::replace_all(_data, "&apos;", "'");
+      boost::replace_all(_data, "&amp;", "&");
+    }
+
+    _end = close + endTag.size();
+    return true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Get the text of the first element with a tag.
+  /// \param[in] _text XML text.
+  /// \param[in] _tag Tag of the element.
+  /// \param[out] _value Text of the element.
+  /// \return False if there is no such element.
+  bool ElementText(const std::string &_text, const std::string &_tag,
+      std::string &_value)
+  {
+    const std::string startTag = "<" + _tag + ">";
+    const size_t from = _text.find(startTag);
+    const size_t to = _text.find("</" + _tag + ">", from);
+    if (from == std::string::npos || to == std::string::npos)
+      return false;
+
+    _value = _text.substr(from + startTag.size(),
+        to - from - startTag.size());
+    return true;
+  }
+
+  /////////////////////////////////////////////////
+  /// \brief Read the first or last <sim_time> of an encoded chunk, the way
+  /// util::LogPlay reads the start and end times of a log.
+  /// \param[in] _data Encoded data of the chunk.
+  /// \param[in] _encoding Encoding of the chunk.
+  /// \param[in] _last True for the last <sim_time> of the chunk.
+  /// \param[out] _time The simulation time.
+  /// \return False if the chunk has no <sim_time>.
+  bool ChunkSimTime(const std::string &_data, const std::string &_encoding,
+      const bool _last, common::Time &_time)
+  {
+    const std::string startTag = "<sim_time>";
+    const std::string endTag = "</sim_time>";
+
+    std::string chunk;
+    if (!util::LogPlay::DecodeChunk(_encoding, _data, chunk))
+      return false;
+
+    size_t from, to;
+    if (_last)
+    {
+      to = chunk.rfind(endTag);
+      from = chunk.rfind(startTag, to - 1);
+    }
+    else
+    {
+      from = chunk.find(startTag);
+      to = chunk.find(endTag, from + startTag.size());
+    }
+
+    if (from == std::string::npos || to == std::string::npos)
+      return false;
+
+    std::stringstream ss(chunk.substr(from + startTag.size(),
+          to - from - startTag.size()));
+    ss >> _time;
+    return true;
+  }
+}
+
 /////////////////////////////////////////////////
 FilterBase::FilterBase(bool _xmlOutput, const std::string &_stamp)
 : xmlOutput(_xmlOutput), stamp(_stamp)
 {
 }
 
+/////////////////////////////////////////////////
+void FilterBase::SetCsvOutput(const bool _csv)
+{
+  this->csvOutput = _csv;
+}
+
+/////////////////////////////////////////////////
+std::string FilterBase::CsvValue(const std::string &_column,
+    const double _value) const
+{
+  std::ostringstream result;
+  result << _column << "\t" << std::fixed << _value << "\n";
+  return result.str();
+}
+
 /////////////////////////////////////////////////
 std::ostringstream &FilterBase::Out(std::ostringstream &_stream,
     const gazebo::physics::State &_state)
 {
-  if (!this->xmlOutput && !this->stamp.empty())
+  if (!this->xmlOutput && !this->csvOutput && !this->stamp.empty())
   {
     std::ios_base::fmtflags flags = _stream.flags();
 
@@ -65,7 +393,8 @@ std::ostringstream &FilterBase::Out(std::ostringstream &_stream,
 std::string FilterBase::FilterPose(const ignition::math::Pose3d &_pose,
     const std::string &_xmlName,
     std::string _filter,
-    const gazebo::physics::State &_state)
+    const gazebo::physics::State &_state,
+    const std::string &_column)
 {
   std::ostringstream result;
   std::string xmlPrefix, xmlSuffix;
@@ -74,6 +403,47 @@ std::string FilterBase::FilterPose(const ignition::math::Pose3d &_pose,
   boost::erase_all(_filter, "[");
   boost::erase_all(_filter, "]");
 
+  // Output one named value per pose element, all of them by default.
+  if (this->csvOutput)
+  {
+    const std::string prefix = _column + "." + _xmlName + ".";
+    const ignition::math::Vector3d rpy = _pose.Rot().Euler();
+
+    std::list<std::string> elements;
+    boost::split(elements, _filter.empty() ? std::string("x,y,z,r,p,a") :
+        _filter, boost::is_any_of(","));
+
+    for (auto const &elem : elements)
+    {
+      switch (elem.empty() ? '\0' : std::tolower(elem[0]))
+      {
+        case 'x':
+          result << this->CsvValue(prefix + "x", _pose.Pos().X());
+          break;
+        case 'y':
+          result << this->CsvValue(prefix + "y", _pose.Pos().Y());
+          break;
+        case 'z':
+          result << this->CsvValue(prefix + "z", _pose.Pos().Z());
+          break;
+        case 'r':
+          result << this->CsvValue(prefix + "roll", rpy.X());
+          break;
+        case 'p':
+          result << this->CsvValue(prefix + "pitch", rpy.Y());
+          break;
+        case 'a':
+          result << this->CsvValue(prefix + "yaw", rpy.Z());
+          break;
+        default:
+          std::cerr << "Invalid pose value[" << elem << "]\n";
+          break;
+      }
+    }
+
+    return result.str();
+  }
+
   // Output XML tags if required.
   if (this->xmlOutput)
   {
@@ -172,7 +542,8 @@ void JointFilter::Init(const std::string &_filter)
 
 /////////////////////////////////////////////////
 std::string JointFilter::FilterParts(gazebo::physics::JointState &_state,
-              std::list<std::string>::iterator _partIter)
+              std::list<std::string>::iterator _partIter,
+              const std::string &_column)
 {
   std::ostringstream result;
   std::string part = *_partIter;
@@ -210,6 +581,8 @@ std::string JointFilter::FilterParts(gazebo::physics::JointState &_state,
           result << "<angle axis='" << *elemIter << "'>"
             << std::fixed << angle << "</angle>\n";
         }
+        else if (this->csvOutput)
+          result << this->CsvValue(_column + "." + *elemIter, angle);
         else
           this->Out(result, _state) << std::fixed << angle << " ";
       }
@@ -249,16 +622,25 @@ std::string JointFilter::Filter(gazebo::physics::ModelState &_state)
     // Filter the elements of the joint (angle).
     // If no filter parts were specified,
     // then output the whole joint state.
+    const std::string column = _state.GetName() + "::" + iter->first;
     if (partIter != this->parts.end())
     {
       if (this->xmlOutput)
         result << "<joint name='" << iter->first << "'>\n";
 
-      result << this->FilterParts(iter->second, partIter);
+      result << this->FilterParts(iter->second, partIter, column);
 
       if (this->xmlOutput)
         result << "</joint>\n";
     }
+    else if (this->csvOutput)
+    {
+      for (unsigned int i = 0; i < iter->second.GetAngleCount(); ++i)
+      {
+        result << this->CsvValue(column + "." + std::to_string(i),
+            iter->second.Position(i));
+      }
+    }
     else
     {
       if (!this->xmlOutput && iter->second.GetAngleCount() == 1)
@@ -293,7 +675,8 @@ void LinkFilter::Init(const std::string &_filter)
 
 /////////////////////////////////////////////////
 std::string LinkFilter::FilterParts(gazebo::physics::LinkState &_state,
-              std::list<std::string>::iterator _partIter)
+              std::list<std::string>::iterator _partIter,
+              const std::string &_column)
 {
   std::ostringstream result;
 
@@ -306,22 +689,23 @@ std::string LinkFilter::FilterParts(gazebo::physics::LinkState &_state,
 
   if (part == "pose")
   {
-    result << this->FilterPose(_state.Pose(), part, elemParts, _state);
+    result << this->FilterPose(_state.Pose(), part, elemParts, _state,
+        _column);
   }
   else if (part == "acceleration")
   {
     result << this->FilterPose(_state.Acceleration(), part,
-        elemParts, _state);
+        elemParts, _state, _column);
   }
   else if (part == "velocity")
   {
     result << this->FilterPose(_state.Velocity(), part, elemParts,
-        _state);
+        _state, _column);
   }
   else if (part == "wrench")
   {
     result << this->FilterPose(_state.Wrench(), part, elemParts,
-        _state);
+        _state, _column);
   }
 
   return result.str();
@@ -358,16 +742,23 @@ std::string LinkFilter::Filter(gazebo::physics::ModelState &_state)
     // Filter the elements of the link (pose, velocity,
     // acceleration, wrench). If no filter parts were specified,
     // then output the whole link state.
+    const std::string column = _state.GetName() + "::" +
+      iter->second.GetName();
     if (partIter != this->parts.end())
     {
       if (this->xmlOutput)
         result << "<link name='" << iter->second.GetName() << "'>\n";
 
-      result << this->FilterParts(iter->second, partIter);
+      result << this->FilterParts(iter->second, partIter, column);
 
       if (this->xmlOutput)
         result << "</link>\n";
     }
+    else if (this->csvOutput)
+    {
+      result << this->FilterPose(iter->second.Pose(), "pose", "",
+          iter->second, column);
+    }
     else
       result << std::fixed << iter->second << std::endl;
   }
@@ -396,6 +787,7 @@ void ModelFilter::Init(const std::string &_filter)
   this->linkFilter = NULL;
   this->jointFilter = NULL;
   this->parts.clear();
+  this->modelRegex = boost::regex();
 
   if (_filter.empty())
     return;
@@ -412,6 +804,15 @@ void ModelFilter::Init(const std::string &_filter)
       this->parts.push_back(mainParts.front());
   }
 
+  // The first element in the filter must be a model name or a star.
+  if (!this->parts.empty() && !this->parts.front().empty() &&
+      this->parts.front() != "*")
+  {
+    std::string regexStr = this->parts.front();
+    boost::replace_all(regexStr, "*", ".*");
+    this->modelRegex = boost::regex(regexStr);
+  }
+
   if (mainParts.empty())
     return;
 
@@ -421,6 +822,7 @@ void ModelFilter::Init(const std::string &_filter)
   if (!mainParts.empty() && !mainParts.front().empty())
   {
     this->linkFilter = new LinkFilter(this->xmlOutput, this->stamp);
+    this->linkFilter->SetCsvOutput(this->csvOutput);
     this->linkFilter->Init(mainParts.front());
   }
 
@@ -434,6 +836,7 @@ void ModelFilter::Init(const std::string &_filter)
   {
     this->jointFilter = new JointFilter(this->xmlOutput,
         this->stamp);
+    this->jointFilter->SetCsvOutput(this->csvOutput);
     this->jointFilter->Init(mainParts.front());
   }
 }
@@ -457,7 +860,8 @@ std::string ModelFilter::FilterParts(gazebo::physics::ModelState &_state,
       elemParts = *_partIter;
 
     // Output the filtered pose.
-    result << this->FilterPose(pose, "pose", elemParts, _state);
+    result << this->FilterPose(pose, "pose", elemParts, _state,
+        _state.GetName());
   }
   else
     std::cerr << "Invalid model state component["
@@ -474,15 +878,8 @@ std::string ModelFilter::Filter(gazebo::physics::WorldState &_state)
   gazebo::physics::ModelState_M states;
   std::list<std::string>::iterator partIter = this->parts.begin();
 
-  // The first element in the filter must be a model name or a star.
-  if (partIter != this->parts.end() && !this->parts.empty() &&
-      !(*partIter).empty() && (*partIter) != "*")
-  {
-    std::string regexStr = *partIter;
-    boost::replace_all(regexStr, "*", ".*");
-    boost::regex regex(regexStr);
-    states = _state.GetModelStates(regex);
-  }
+  if (!this->MatchesAll())
+    states = _state.GetModelStates(this->modelRegex);
   else
     states = _state.GetModelStates();
 
@@ -496,7 +893,15 @@ std::string ModelFilter::Filter(gazebo::physics::WorldState &_state)
     // whole model state.
     if (!this->linkFilter && !this->jointFilter &&
         partIter == this->parts.end())
-      result << std::fixed << iter->second;
+    {
+      if (this->csvOutput)
+      {
+        result << this->FilterPose(iter->second.Pose(), "pose", "",
+            iter->second, iter->second.GetName());
+      }
+      else
+        result << std::fixed << iter->second;
+    }
     else
     {
       if (this->xmlOutput)
@@ -522,6 +927,18 @@ std::string ModelFilter::Filter(gazebo::physics::WorldState &_state)
   return result.str();
 }
 
+/////////////////////////////////////////////////
+bool ModelFilter::Matches(const std::string &_name) const
+{
+  return this->MatchesAll() || boost::regex_match(_name, this->modelRegex);
+}
+
+/////////////////////////////////////////////////
+bool ModelFilter::MatchesAll() const
+{
+  return this->modelRegex.empty();
+}
+
 /////////////////////////////////////////////////
 StateFilter::StateFilter(bool _xmlOutput, const std::string &_stamp,
               double _hz)
@@ -532,30 +949,90 @@ StateFilter::StateFilter(bool _xmlOutput, const std::string &_stamp,
 /////////////////////////////////////////////////
 void StateFilter::Init(const std::string &_filter)
 {
+  this->filter.SetCsvOutput(this->csvOutput);
   this->filter.Init(_filter);
+  this->columns.clear();
+  this->columnsWarned = false;
 }
 
 /////////////////////////////////////////////////
 std::string StateFilter::Filter(const std::string &_stateString)
 {
-  gazebo::physics::WorldState state;
+  std::string pruned;
+  gazebo::common::Time simTime;
+  this->Prune(_stateString, pruned, simTime);
 
-  // Read and parse the state information
-  g_stateSdf->Clear();
-  sdf::readString(_stateString, g_stateSdf);
-  state.Load(g_stateSdf);
+  if (!this->Accept(simTime))
+    return std::string();
 
-  std::ostringstream result;
+  return this->Row(this->FilterState(pruned, g_stateSdf));
+}
 
-  if (this->hz > 0.0 && this->prevTime != gazebo::common::Time::Zero)
+/////////////////////////////////////////////////
+void StateFilter::Prune(const std::string &_stateString,
+    std::string &_pruned, gazebo::common::Time &_simTime) const
+{
+  _simTime = gazebo::common::Time::Zero;
+
+  std::vector<StateChild> children;
+  if (!ScanState(_stateString, children))
   {
-    if ((state.GetSimTime() - this->prevTime).Double() <
-        1.0 / this->hz)
+    // Let the sdf parser report the error
+    _pruned = _stateString;
+    return;
+  }
+
+  _pruned.clear();
+  _pruned.reserve(_stateString.size());
+
+  size_t copied = 0;
+  for (auto const &child : children)
+  {
+    if (child.tag == "sim_time")
+    {
+      std::istringstream stream(_stateString.substr(child.contentBegin,
+            child.contentEnd - child.contentBegin));
+      stream >> _simTime;
+    }
+    // Escaped names are kept, the filter matches the unescaped name.
+    else if (child.tag == "light" || (child.tag == "model" &&
+          child.name.find('&') == std::string::npos &&
+          !this->filter.Matches(child.name)))
     {
-      return result.str();
+      _pruned.append(_stateString, copied, child.begin - copied);
+      copied = child.end;
     }
   }
 
+  _pruned.append(_stateString, copied, std::string::npos);
+}
+
+/////////////////////////////////////////////////
+bool StateFilter::Accept(const gazebo::common::Time &_simTime)
+{
+  if (this->hz > 0.0 && this->prevTime != gazebo::common::Time::Zero)
+  {
+    if ((_simTime - this->prevTime).Double() < 1.0 / this->hz)
+      return false;
+  }
+
+  this->prevTime = _simTime;
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::string StateFilter::FilterState(const std::string &_stateString,
+    sdf::ElementPtr _stateSdf)
+{
+  gazebo::physics::WorldState state;
+
+  // Read and parse the state information
+  _stateSdf->Clear();
+  sdf::readString(_stateString, _stateSdf);
+  state.Load(_stateSdf);
+
+  std::ostringstream result;
+
   if (this->xmlOutput)
   {
     result << "<sdf version='" << SDF_VERSION << "'>\n"
@@ -582,15 +1059,257 @@ std::string StateFilter::Filter(const std::string &_stateString)
       result << "</deletions>" << std::endl;
   }
 
-  result << this->filter.Filter(state);
+  const std::string filtered = this->filter.Filter(state);
+
+  // Rows start with the time stamp, the simulation time by default.
+  if (this->csvOutput && !filtered.empty())
+  {
+    if (this->stamp == "real")
+      result << this->CsvValue("real_time", state.GetRealTime().Double());
+    else if (this->stamp == "wall")
+      result << this->CsvValue("wall_time", state.GetWallTime().Double());
+    else if (this->stamp == "iterations")
+      result << "iterations\t" << state.GetIterations() << "\n";
+    else
+      result << this->CsvValue("sim_time", state.GetSimTime().Double());
+  }
+
+  result << filtered;
 
   if (this->xmlOutput)
     result << "</state></sdf>\n";
 
-  this->prevTime = state.GetSimTime();
   return result.str();
 }
 
+/////////////////////////////////////////////////
+std::string StateFilter::Row(const std::string &_filtered)
+{
+  if (!this->csvOutput || _filtered.empty())
+    return _filtered;
+
+  std::vector<std::pair<std::string, std::string>> values;
+  std::istringstream stream(_filtered);
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    const size_t tab = line.find('\t');
+    if (tab != std::string::npos)
+      values.push_back(std::make_pair(line.substr(0, tab),
+            line.substr(tab + 1)));
+  }
+
+  std::ostringstream result;
+
+  // The first row sets the columns
+  if (this->columns.empty())
+  {
+    for (auto const &value : values)
+      this->columns.push_back(value.first);
+    result << boost::algorithm::join(this->columns, ",") << "\n";
+  }
+
+  std::map<std::string, std::string> row(values.begin(), values.end());
+  for (size_t i = 0; i < this->columns.size(); ++i)
+  {
+    if (i > 0)
+      result << ",";
+
+    auto value = row.find(this->columns[i]);
+    if (value != row.end())
+    {
+      result << value->second;
+      row.erase(value);
+    }
+  }
+  result << "\n";
+
+  if (!row.empty() && !this->columnsWarned)
+  {
+    std::cerr << "Column[" << row.begin()->first << "] is not in the "
+      << "first row, and is not output.\n";
+    this->columnsWarned = true;
+  }
+
+  return result.str();
+}
+
+/////////////////////////////////////////////////
+bool LogReader::Open(const std::string &_filename)
+{
+  this->file.open(_filename, std::ios::in | std::ios::binary);
+  if (!this->file.is_open())
+    return false;
+
+  // The header is small and comes before the first chunk.
+  const std::string headerEnd = "</header>";
+  size_t end;
+  while ((end = this->buffer.find(headerEnd)) == std::string::npos)
+  {
+    if (!this->Fill())
+    {
+      gzerr << "Log file has no header\n";
+      return false;
+    }
+  }
+  end += headerEnd.size();
+
+  const std::string header = this->buffer.substr(0, end);
+  this->buffer.erase(0, end);
+
+  if (header.find("<gazebo_log>") == std::string::npos)
+  {
+    gzerr << "Log file is missing the <gazebo_log> element\n";
+    return false;
+  }
+
+  this->randSeed = std::to_string(ignition::math::Rand::Seed());
+  if (!ElementText(header, "log_version", this->logVersion))
+    gzerr << "Log file header is missing the log version.\n";
+
+  if (this->logVersion != GZ_LOG_VERSION)
+  {
+    gzwarn << "Log version[" << this->logVersion << "] in file["
+           << _filename << "] does not match Gazebo's log version["
+           << GZ_LOG_VERSION << "]\n";
+  }
+  else
+  {
+    if (!ElementText(header, "gazebo_version", this->gazeboVersion))
+      gzerr << "Log file header is missing the gazebo version.\n";
+    if (!ElementText(header, "rand_seed", this->randSeed))
+      gzerr << "Log file header is missing the random number seed.\n";
+  }
+
+  // Read the start time from the first chunks, which are kept for
+  // NextChunk.
+  bool found = false;
+  for (unsigned int i = 0; i < 2u && !found; ++i)
+  {
+    std::string data, chunkEncoding;
+    if (!this->ReadChunk(data, chunkEncoding))
+      break;
+
+    if (i == 0)
+      this->encoding = chunkEncoding;
+    found = ChunkSimTime(data, chunkEncoding, false, this->logStartTime);
+    this->chunks.emplace_back(std::move(data), std::move(chunkEncoding));
+  }
+
+  if (this->chunks.empty())
+  {
+    gzerr << "Unable to find the first chunk\n";
+    return false;
+  }
+
+  if (!found)
+    gzwarn << "Unable to find <sim_time> tags in any chunk." << std::endl;
+
+  this->ReadEndTime(_filename);
+  return true;
+}
+
+/////////////////////////////////////////////////
+std::string LogReader::Header() const
+{
+  std::ostringstream stream;
+  stream << "<?xml version='1.0'?>\n"
+         << "<gazebo_log>\n"
+         << "<header>\n"
+         << "<log_version>" << this->logVersion << "</log_version>\n"
+         << "<gazebo_version>" << this->gazeboVersion
+         << "</gazebo_version>\n"
+         << "<rand_seed>" << this->randSeed << "</rand_seed>\n"
+         << "<log_start>" << this->logStartTime << "</log_start>\n"
+         << "<log_end>" << this->logEndTime << "</log_end>\n"
+         << "</header>\n";
+
+  return stream.str();
+}
+
+/////////////////////////////////////////////////
+std::string LogReader::Encoding() const
+{
+  return this->encoding;
+}
+
+/////////////////////////////////////////////////
+bool LogReader::NextChunk(std::string &_data, std::string &_encoding)
+{
+  if (this->chunks.empty())
+    return this->ReadChunk(_data, _encoding);
+
+  _data = std::move(this->chunks.front().first);
+  _encoding = std::move(this->chunks.front().second);
+  this->chunks.pop_front();
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogReader::ReadChunk(std::string &_data, std::string &_encoding)
+{
+  size_t end;
+  while (!FindChunk(this->buffer, 0, _data, _encoding, end))
+  {
+    if (!this->Fill())
+      return false;
+  }
+
+  this->buffer.erase(0, end);
+  return true;
+}
+
+/////////////////////////////////////////////////
+bool LogReader::Fill()
+{
+  std::string block(1 << 20, '\0');
+  this->file.read(&block[0], block.size());
+  const std::streamsize count = this->file.gcount();
+  this->buffer.append(block, 0, static_cast<size_t>(count));
+  return count > 0;
+}
+
+/////////////////////////////////////////////////
+void LogReader::ReadEndTime(const std::string &_filename)
+{
+  std::ifstream tail(_filename, std::ios::in | std::ios::binary);
+  tail.seekg(0, std::ios::end);
+  const std::streamoff size = tail.tellg();
+
+  // Read larger parts of the end of the file until they hold a whole
+  // chunk.
+  std::string text, data, chunkEncoding;
+  for (std::streamoff length = 1 << 16;
+       tail && static_cast<std::streamoff>(text.size()) < size; length *= 4)
+  {
+    length = std::min(length, size);
+    text.resize(static_cast<size_t>(length));
+    tail.seekg(size - length);
+    tail.read(&text[0], length);
+
+    size_t begin = text.rfind("<chunk");
+    size_t end;
+    while (begin != std::string::npos &&
+           !FindChunk(text, begin, data, chunkEncoding, end) && begin > 0)
+    {
+      begin = text.rfind("<chunk", begin - 1);
+    }
+
+    if (begin != std::string::npos &&
+        FindChunk(text, begin, data, chunkEncoding, end))
+    {
+      if (!ChunkSimTime(data, chunkEncoding, true, this->logEndTime))
+      {
+        gzwarn << "Unable to find <sim_time>...</sim_time> tags in the last "
+               << "chunk." << std::endl;
+      }
+      return;
+    }
+  }
+
+  gzerr << "Unable to jump to the last chunk of the log file\n";
+}
+
 /////////////////////////////////////////////////
 LogCommand::LogCommand()
   : Command("log", "Introspects and manipulates Gazebo log files.")
@@ -622,7 +1341,12 @@ LogCommand::LogCommand()
      "Valid in conjunction with the output command. See also the "
      "--output argument.")
     ("filter", po::value<std::string>(),
-     "Filter output. Valid only with the echo, step, and output commands");
+     "Filter output. Valid only with the echo, step, and output commands")
+    ("csv", "Output comma separated values, one row per state, with a "
+     "header row. Implies --raw. Used in conjunction with --filter.")
+    ("threads", po::value<unsigned int>(), "Number of threads used by the "
+     "echo and output commands to filter a log file. Defaults to one per "
+     "core.");
 }
 
 /////////////////////////////////////////////////
@@ -666,7 +1390,11 @@ bool LogCommand::RunImpl()
   // Get hz
   hz = this->vm.count("hz") ? this->vm["hz"].as<double>() : 0;
 
-  raw = this->vm.count("raw");
+  this->csv = this->vm.count("csv");
+  raw = this->vm.count("raw") || this->csv;
+
+  this->threads = this->vm.count("threads") ?
+    this->vm["threads"].as<unsigned int>() : 0;
 
   if (!this->vm.count("record"))
   {
@@ -681,8 +1409,17 @@ bool LogCommand::RunImpl()
       return false;
     }
 
-    // Load log file from string
-    if (!this->LoadLogFromFile(filename))
+    // Echo and output read the chunks of the log as they filter them,
+    // the other commands load the whole log.
+    if (this->vm.count("output") || this->vm.count("echo"))
+    {
+      if (!this->reader.Open(filename))
+      {
+        std::cerr << "Unable to open log file[" << filename << "]\n";
+        return false;
+      }
+    }
+    else if (!this->LoadLogFromFile(filename))
     {
       return false;
     }
@@ -830,17 +1567,10 @@ void LogCommand::Output(const std::string &_outFilename,
     return;
   }
 
-  gazebo::util::LogPlay *play = gazebo::util::LogPlay::Instance();
-  if (!play->IsOpen())
-  {
-    std::cerr << "No source log file specified. Use the -f command line "
-      << "argument.\n";
-    return;
-  }
-
-  std::string stateString, bufferString;
+  std::string bufferString;
 
-  std::string encoding = _encoding.empty() ? play->Encoding() : _encoding;
+  std::string encoding = _encoding.empty() ? this->reader.Encoding() :
+    _encoding;
   if (encoding != "txt" && encoding != "zlib" && encoding != "bz2")
   {
     std::cerr << "Invalid log file encoding[" << encoding << "]. "
@@ -852,33 +1582,40 @@ void LogCommand::Output(const std::string &_outFilename,
   // Output the header
   if (!_raw)
   {
-    std::string header = play->Header();
+    std::string header = this->reader.Header();
     outFile.write(header.c_str(), header.size());
   }
 
   StateFilter filter(!_raw, _stamp, _hz);
+  filter.SetCsvOutput(this->csv);
   filter.Init(_filter);
 
-  unsigned int i = 0;
-  while (play->Step(stateString))
-  {
-    if (i == 0 && !_raw)
-    {
-      this->OutputWriter(outFile, stateString, _raw, encoding);
-    }
-    else
-    {
-      bufferString += filter.Filter(stateString);
+  this->FilterLog(filter,
+      [&](const std::string &_world)
+      {
+        if (!_raw)
+        {
+          this->OutputWriter(outFile, _world, _raw, encoding);
+          return;
+        }
 
-      if (i%1000 == 0 && !bufferString.empty())
+        bufferString += filter.Filter(_world);
+        if (!bufferString.empty())
+        {
+          this->OutputWriter(outFile, bufferString, _raw, encoding);
+          bufferString.clear();
+        }
+      },
+      [&](const unsigned int _index, const std::string &_output)
       {
-        this->OutputWriter(outFile, bufferString, _raw, encoding);
-        bufferString.clear();
-      }
-    }
+        bufferString += _output;
 
-    ++i;
-  }
+        if (_index % 1000 == 0 && !bufferString.empty())
+        {
+          this->OutputWriter(outFile, bufferString, _raw, encoding);
+          bufferString.clear();
+        }
+      });
 
   if (!bufferString.empty())
     this->OutputWriter(outFile, bufferString, _raw, encoding);
@@ -896,37 +1633,39 @@ void LogCommand::Output(const std::string &_outFilename,
 void LogCommand::Echo(const std::string &_filter, bool _raw,
     const std::string &_stamp, double _hz)
 {
-  gazebo::util::LogPlay *play = gazebo::util::LogPlay::Instance();
-  std::string stateString;
-
   // Output the header
   if (!_raw)
-    std::cout << play->Header() << std::endl;
+    std::cout << this->reader.Header() << std::endl;
 
   StateFilter filter(!_raw, _stamp, _hz);
+  filter.SetCsvOutput(this->csv);
   filter.Init(_filter);
 
-  unsigned int i = 0;
-  while (play->Step(stateString))
+  auto echo = [&](const std::string &_output)
   {
-    if (i > 0)
-      stateString = filter.Filter(stateString);
-    else if (i == 0 && _raw)
-      stateString.clear();
+    if (_output.empty())
+      return;
 
-    if (!stateString.empty())
-    {
-      if (!_raw)
-        std::cout << "<chunk encoding='txt'><![CDATA[\n";
+    if (!_raw)
+      std::cout << "<chunk encoding='txt'><![CDATA[\n";
 
-      std::cout << stateString;
+    std::cout << _output;
 
-      if (!_raw)
-        std::cout << "]]></chunk>\n";
-    }
+    if (!_raw)
+      std::cout << "]]></chunk>\n";
+  };
 
-    ++i;
-  }
+  // The world description is only output with XML.
+  this->FilterLog(filter,
+      [&](const std::string &_world)
+      {
+        if (!_raw)
+          echo(_world);
+      },
+      [&](const unsigned int, const std::string &_output)
+      {
+        echo(_output);
+      });
 
   if (!_raw)
     std::cout << "</gazebo_log>\n";
@@ -945,6 +1684,7 @@ void LogCommand::Step(const std::string &_filter, bool _raw,
   char c = '\0';
 
   StateFilter filter(!_raw, _stamp, _hz);
+  filter.SetCsvOutput(this->csv);
   filter.Init(_filter);
 
   unsigned int i = 0;
@@ -980,6 +1720,149 @@ void LogCommand::Step(const std::string &_filter, bool _raw,
     std::cout << "</gazebo_log>\n";
 }
 
+/////////////////////////////////////////////////
+void LogCommand::FilterLog(StateFilter &_filter,
+    const std::function<void(const std::string &)> &_world,
+    const std::function<void(const unsigned int,
+      const std::string &)> &_state)
+{
+  const unsigned int threadCount = this->threads > 0 ? this->threads :
+    std::max(1u, std::thread::hardware_concurrency());
+  tbb::task_arena arena(threadCount);
+
+  // Number of chunks read from the log at once.
+  const unsigned int window = threadCount * 4;
+
+  // Each thread parses states into its own element.
+  std::mutex cloneMutex;
+  tbb::enumerable_thread_specific<sdf::ElementPtr> stateSdfs([&]()
+      {
+        std::lock_guard<std::mutex> lock(cloneMutex);
+        return g_stateSdf->Clone();
+      });
+
+  const std::string startFrame = "<sdf ";
+  const std::string endFrame = "</sdf>";
+
+  std::vector<LogChunk> chunks;
+  std::vector<LogFrame *> frames;
+  unsigned int chunkIndex = 0;
+  unsigned int frameIndex = 0;
+  bool done = false;
+
+  while (!done)
+  {
+    // Read a window of chunks, without decoding them.
+    chunks.clear();
+    while (chunks.size() < window)
+    {
+      LogChunk chunk;
+      if (!this->reader.NextChunk(chunk.data, chunk.encoding))
+      {
+        done = true;
+        break;
+      }
+      chunks.push_back(std::move(chunk));
+      ++chunkIndex;
+    }
+
+    const unsigned int firstChunk =
+      chunkIndex - static_cast<unsigned int>(chunks.size());
+
+    // Decode the chunks, split them in frames the way LogPlay::Step does,
+    // and prune the states.
+    arena.execute([&]()
+    {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size(), 1),
+        [&](const tbb::blocked_range<size_t> &_r)
+        {
+          for (size_t i = _r.begin(); i != _r.end(); ++i)
+          {
+            LogChunk &chunk = chunks[i];
+            std::string decoded;
+            chunk.valid = gazebo::util::LogPlay::DecodeChunk(chunk.encoding,
+                chunk.data, decoded);
+            chunk.data.clear();
+
+            size_t pos = 0;
+            while (chunk.valid)
+            {
+              const size_t from = decoded.find(startFrame, pos);
+              const size_t to = decoded.find(endFrame, pos);
+              if (from == std::string::npos || to == std::string::npos)
+                break;
+              pos = to + endFrame.size();
+
+              chunk.frames.push_back(LogFrame());
+              LogFrame &frame = chunk.frames.back();
+              const std::string text = decoded.substr(from, pos - from);
+
+              // The first frame is the world description
+              if (firstChunk + i == 0 && chunk.frames.size() == 1)
+                frame.text = text;
+              else
+                _filter.Prune(text, frame.text, frame.simTime);
+            }
+          }
+        });
+    });
+
+    // Stop at the first chunk without frames, as LogPlay::Step does.
+    frames.clear();
+    for (auto &chunk : chunks)
+    {
+      if (chunk.frames.empty())
+      {
+        if (chunk.valid)
+          gzerr << "Unable to find an <sdf> frame in current chunk\n";
+        done = true;
+        break;
+      }
+
+      for (auto &frame : chunk.frames)
+        frames.push_back(&frame);
+    }
+
+    // The Hz filter depends on the previous output, apply it in order.
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+      if (frameIndex + i == 0)
+        _world(frames[i]->text);
+      else
+        frames[i]->accepted = _filter.Accept(frames[i]->simTime);
+    }
+
+    arena.execute([&]()
+    {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, frames.size()),
+        [&](const tbb::blocked_range<size_t> &_r)
+        {
+          sdf::ElementPtr stateSdf = stateSdfs.local();
+          for (size_t i = _r.begin(); i != _r.end(); ++i)
+          {
+            if (frames[i]->accepted)
+            {
+              frames[i]->output = _filter.FilterState(frames[i]->text,
+                  stateSdf);
+            }
+          }
+        });
+    });
+
+    // Output in the order of the log
+    for (size_t i = 0; i < frames.size(); ++i)
+    {
+      if (frameIndex + i > 0)
+      {
+        _state(frameIndex + static_cast<unsigned int>(i),
+            frames[i]->accepted ? _filter.Row(frames[i]->output) :
+            std::string());
+      }
+    }
+    frameIndex += static_cast<unsigned int>(frames.size());
+  }
+}
+
 /////////////////////////////////////////////////
 void LogCommand::Record(bool _start)
 {
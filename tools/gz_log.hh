@@ -17,8 +17,16 @@
 #ifndef GAZEBO_TOOLS_GZLOG_HH_
 #define GAZEBO_TOOLS_GZLOG_HH_
 
+#include <deque>
+#include <fstream>
+#include <functional>
 #include <string>
 #include <list>
+#include <utility>
+#include <vector>
+
+#include <boost/regex.hpp>
+#include <sdf/sdf.hh>
 
 #include <gazebo/physics/WorldState.hh>
 #include "gz.hh"
@@ -46,15 +54,34 @@ namespace gazebo
     /// \param[in] _xmlName Name of the xml tag.
     /// \param[in] _filter The filter string [x,y,z,r,p,a].
     /// \param[in] _state Current state.
+    /// \param[in] _column Name of the entity, used to name the columns of
+    /// comma separated values.
     /// \return Filtered pose string.
     public: std::string FilterPose(const ignition::math::Pose3d &_pose,
                 const std::string &_xmlName,
                 std::string _filter,
-                const gazebo::physics::State &_state);
+                const gazebo::physics::State &_state,
+                const std::string &_column = "");
+
+    /// \brief Output comma separated values instead of text or XML. The
+    /// filters then output one "name<tab>value" line per value, which
+    /// StateFilter::Row turns into a row. Call before Init.
+    /// \param[in] _csv True to output comma separated values.
+    public: void SetCsvOutput(const bool _csv);
+
+    /// \brief Output a named value of a row of comma separated values.
+    /// \param[in] _column Name of the column.
+    /// \param[in] _value The value.
+    /// \return The value line.
+    protected: std::string CsvValue(const std::string &_column,
+                   const double _value) const;
 
     /// \brief True if XML output is requested.
     protected: bool xmlOutput;
 
+    /// \brief True if comma separated values are requested.
+    protected: bool csvOutput = false;
+
     /// \brief Time stamp type
     protected: std::string stamp;
   };
@@ -75,9 +102,12 @@ namespace gazebo
     /// \brief Filter joint parts (angle)
     /// \param[in] _state Link state to filter.
     /// \param[in] _partIter Iterator to the filtered string parts.
+    /// \param[in] _column Scoped name of the joint, used to name the
+    /// columns of comma separated values.
     /// \return Filtered joint string.
     public: std::string FilterParts(gazebo::physics::JointState &_state,
-                std::list<std::string>::iterator _partIter);
+                std::list<std::string>::iterator _partIter,
+                const std::string &_column = "");
 
     /// \brief Filter the joints in a Model state, and output the result
     /// as a string.
@@ -105,9 +135,12 @@ namespace gazebo
     /// \brief Filter link parts (pose, velocity, acceleration, wrench)
     /// \param[in] _state Link state to filter.
     /// \param[in] _partIter Iterator to the filtered string parts.
+    /// \param[in] _column Scoped name of the link, used to name the
+    /// columns of comma separated values.
     /// \return Filtered string
     public: std::string FilterParts(gazebo::physics::LinkState &_state,
-                std::list<std::string>::iterator _partIter);
+                std::list<std::string>::iterator _partIter,
+                const std::string &_column = "");
 
     /// \brief Filter the links in a Model state, and output the result
     /// as a string.
@@ -148,9 +181,22 @@ namespace gazebo
     /// \return Filtered string.
     public: std::string Filter(gazebo::physics::WorldState &_state);
 
+    /// \brief Check whether the filter selects a model. Thread safe.
+    /// \param[in] _name Name of the model.
+    /// \return True if the model is selected.
+    public: bool Matches(const std::string &_name) const;
+
+    /// \brief Check whether the filter selects every model.
+    /// \return True if every model is selected.
+    public: bool MatchesAll() const;
+
     /// \brief The list of model parts to filter.
     public: std::list<std::string> parts;
 
+    /// \brief Regular expression of the selected model names, built from
+    /// the first part. Empty when every model is selected.
+    private: boost::regex modelRegex;
+
     /// \brief Pointer to the link filter.
     public: LinkFilter *linkFilter;
 
@@ -177,6 +223,36 @@ namespace gazebo
     /// \return Filtered string
     public: std::string Filter(const std::string &_stateString);
 
+    /// \brief Get the simulation time of a state, and remove the models
+    /// the filter does not select and the lights, so fewer states are
+    /// parsed by FilterState. The state is scanned without parsing it into
+    /// sdf. Thread safe.
+    /// \param[in] _stateString The state.
+    /// \param[out] _pruned The state without the unused elements.
+    /// \param[out] _simTime Simulation time of the state.
+    public: void Prune(const std::string &_stateString, std::string &_pruned,
+                gazebo::common::Time &_simTime) const;
+
+    /// \brief Apply the Hz filter. Call in the order of the log.
+    /// \param[in] _simTime Simulation time of a state.
+    /// \return True if the state should be output.
+    public: bool Accept(const gazebo::common::Time &_simTime);
+
+    /// \brief Filter a state, without the Hz filter. Thread safe, as long
+    /// as each thread uses its own state element.
+    /// \param[in] _stateString The state, see Prune.
+    /// \param[in] _stateSdf Element used to parse the state.
+    /// \return Filtered string, see Row.
+    public: std::string FilterState(const std::string &_stateString,
+                sdf::ElementPtr _stateSdf);
+
+    /// \brief Get the output of a filtered state. Comma separated values
+    /// are aligned on the columns of the first state, which are output as
+    /// a header. Other output is unchanged. Call in the order of the log.
+    /// \param[in] _filtered Output of FilterState.
+    /// \return The output.
+    public: std::string Row(const std::string &_filtered);
+
     /// \brief Filter for a model.
     private: ModelFilter filter;
 
@@ -185,6 +261,79 @@ namespace gazebo
 
     /// \brief Previous time a state was output.
     private: gazebo::common::Time prevTime;
+
+    /// \brief Columns of the comma separated values.
+    private: std::vector<std::string> columns;
+
+    /// \brief True once a missing column has been reported.
+    private: bool columnsWarned = false;
+  };
+
+  /// \brief Reads the chunks of a log file one at a time, so that a log can
+  /// be filtered without loading the whole file in memory.
+  class LogReader
+  {
+    /// \brief Open a log file and read its header.
+    /// \param[in] _filename Name of the log file.
+    /// \return True if the file starts with a log header.
+    public: bool Open(const std::string &_filename);
+
+    /// \brief Get the header of the log, formatted like
+    /// util::LogPlay::Header.
+    /// \return The header.
+    public: std::string Header() const;
+
+    /// \brief Get the encoding of the first chunk.
+    /// \return The encoding, empty if the log has no chunk.
+    public: std::string Encoding() const;
+
+    /// \brief Read the next chunk of the log, without decoding it.
+    /// \param[out] _data Encoded data, see util::LogPlay::DecodeChunk.
+    /// \param[out] _encoding Encoding of the chunk.
+    /// \return False at the end of the log.
+    public: bool NextChunk(std::string &_data, std::string &_encoding);
+
+    /// \brief Read the next chunk from the file.
+    /// \param[out] _data Encoded data of the chunk.
+    /// \param[out] _encoding Encoding of the chunk.
+    /// \return False at the end of the file.
+    private: bool ReadChunk(std::string &_data, std::string &_encoding);
+
+    /// \brief Read the next block of the file into the buffer.
+    /// \return False at the end of the file.
+    private: bool Fill();
+
+    /// \brief Read the simulation time of the last state of the log, from
+    /// the end of the file.
+    /// \param[in] _filename Name of the log file.
+    private: void ReadEndTime(const std::string &_filename);
+
+    /// \brief The log file.
+    private: std::ifstream file;
+
+    /// \brief Part of the file read but not returned yet.
+    private: std::string buffer;
+
+    /// \brief Chunks read by Open, returned first by NextChunk.
+    private: std::deque<std::pair<std::string, std::string>> chunks;
+
+    /// \brief Log format version.
+    private: std::string logVersion;
+
+    /// \brief Gazebo version of the log.
+    private: std::string gazeboVersion;
+
+    /// \brief Random number seed of the log.
+    private: std::string randSeed;
+
+    /// \brief Simulation time of the first state.
+    private: gazebo::common::Time logStartTime;
+
+    /// \brief Simulation time of the last state.
+    private: gazebo::common::Time logEndTime;
+
+    /// \brief Encoding of the first chunk.
+    private: std::string encoding;
   };
 
   /// \brief Log command
@@ -260,6 +409,20 @@ namespace gazebo
     private: bool LoadLogFromFile(const std::string &_filename);
 
 
+    /// \brief Decode and filter the frames of the log on a pool of threads.
+    /// A window of chunks is read from the log, then decoded, pruned and
+    /// filtered in parallel, and output in the order of the log before the
+    /// next window is read.
+    /// \param[in] _filter Filter to apply.
+    /// \param[in] _world Called with the world description, the first
+    /// frame of the log.
+    /// \param[in] _state Called with the index of each following frame
+    /// and its output, which is empty if the frame was filtered out.
+    private: void FilterLog(StateFilter &_filter,
+                 const std::function<void(const std::string &)> &_world,
+                 const std::function<void(const unsigned int,
+                   const std::string &)> &_state);
+
     /// \brief Write data to a file.
     /// \param[in] _outFile Output file stream reference.
     /// \param[in] _stateString SDF state string to write
@@ -271,6 +434,15 @@ namespace gazebo
 
     /// \brief Node pointer.
     private: gazebo::transport::NodePtr node;
+
+    /// \brief Log read by Echo and Output.
+    private: LogReader reader;
+
+    /// \brief True to output comma separated values.
+    private: bool csv = false;
+
+    /// \brief Number of threads used to filter logs, 0 for one per core.
+    private: unsigned int threads = 0;
   };
 }
 #endif
@@ -14,6 +14,7 @@
  * limitations under the License.
  *
 */
+#include <algorithm>
 #include <thread>
 #include <gtest/gtest.h>
 #include <boost/lexical_cast.hpp>
@@ -331,6 +332,75 @@ TEST(gz_log, RawFilterStamp)
   EXPECT_EQ(validEcho, echo);
 }
 
+/////////////////////////////////////////////////
+/// Check comma separated values output
+TEST(gz_log, CsvFilter)
+{
+  std::string echo, validEcho;
+
+  // Selected pose elements
+  echo = custom_exec(std::string(GZ_LOG_PATH +
+        " --echo --csv --filter pr2.pose.[x,z] -f ") +
+      PROJECT_SOURCE_PATH + "/test/data/pr2_state.log");
+  boost::trim_right(echo);
+  validEcho = "sim_time,pr2.pose.x,pr2.pose.z\n"
+              "0.021344,0.000000,-0.000008\n"
+              "0.028958,0.000000,-0.000015";
+  EXPECT_EQ(validEcho, echo);
+
+  // Whole pose, stamped with the real time
+  echo = custom_exec(std::string(GZ_LOG_PATH +
+        " --echo --csv --stamp real --filter pr2 -f ") +
+      PROJECT_SOURCE_PATH + "/test/data/pr2_state.log");
+  boost::trim_right(echo);
+  validEcho = "real_time,pr2.pose.x,pr2.pose.y,pr2.pose.z,pr2.pose.roll,"
+              "pr2.pose.pitch,pr2.pose.yaw\n"
+              "0.001000,0.000000,0.000000,-0.000008,";
+  EXPECT_EQ(validEcho, echo.substr(0, validEcho.size()));
+  EXPECT_EQ(std::count(echo.begin(), echo.end(), '\n'), 2);
+
+  // No matching model
+  echo = custom_exec(std::string(GZ_LOG_PATH +
+        " --echo --csv --filter box.pose -f ") +
+      PROJECT_SOURCE_PATH + "/test/data/pr2_state.log");
+  boost::trim_right(echo);
+  EXPECT_TRUE(echo.empty());
+}
+
+/////////////////////////////////////////////////
+/// Check that the output does not depend on the number of threads
+TEST(gz_log, Threads)
+{
+  for (auto const &args : {" -e -f ", " -e -r --filter pr2/*.pose -f ",
+      " -e -r -z 100 --filter pr2.pose -f "})
+  {
+    std::string serial = custom_exec(GZ_LOG_PATH + " --threads 1" + args +
+        PROJECT_SOURCE_PATH + "/test/data/pr2_state.log");
+    std::string parallel = custom_exec(GZ_LOG_PATH + " --threads 4" + args +
+        PROJECT_SOURCE_PATH + "/test/data/pr2_state.log");
+    EXPECT_FALSE(serial.empty());
+    EXPECT_EQ(serial, parallel);
+  }
+}
+
+/////////////////////////////////////////////////
+/// Check that the header echoed from a log read chunk by chunk is the one
+/// LogPlay reads from the whole log
+TEST(gz_log, EchoHeader)
+{
+  for (auto const &log : {"state.log", "insertion_deletion.log"})
+  {
+    const std::string path =
+      std::string(PROJECT_SOURCE_PATH) + "/test/logs/" + log;
+    EXPECT_NO_THROW(gazebo::util::LogPlay::Instance()->Open(path));
+    const std::string header = gazebo::util::LogPlay::Instance()->Header();
+
+    std::string echo = custom_exec(GZ_LOG_PATH + " -e -f " + path);
+    EXPECT_EQ(header, echo.substr(0, header.size()));
+    EXPECT_NE(echo.find("<sim_time>"), std::string::npos);
+  }
+}
+
 /////////////////////////////////////////////////
 /// Check to make sure that 'gz log -s' returns correct information
 TEST(gz_log, Step)
@@ -16,6 +16,8 @@
 */
 #include <google/protobuf/text_format.h>
 
+#include <chrono>
+
 #include <gazebo/gui/qt.h>
 #include <gazebo/gui/TopicSelector.hh>
 #include <gazebo/gui/viewers/TopicView.hh>
@@ -46,7 +48,8 @@ TopicCommand::TopicCommand()
   this->visibleOptions.add_options()
     ("world-name,w", po::value<std::string>(), "World name.")
     ("list,l", "List all topics.")
-    ("info,i", po::value<std::string>(), "Get information about a topic.")
+    ("info,i", po::value<std::string>(), "Get information about a topic, "
+     "and transport statistics of its publishers.")
     ("echo,e", po::value<std::string>(), "Output topic data to screen.")
     ("view,v", po::value<std::string>()->implicit_value(""),
      "View topic data using a QT widget.")
@@ -185,6 +188,107 @@ void TopicCommand::Info(const std::string &_topic)
               << info.subscriber(i).port() << "\n";
   }
   std::cout << "\n";
+
+  this->Stats(_topic, info);
+}
+
+/////////////////////////////////////////////////
+void TopicCommand::StatsCB(ConstTransportStatsPtr &_msg)
+{
+  std::lock_guard<std::mutex> lock(this->statsMutex);
+  this->stats[_msg->host() + ":" + std::to_string(_msg->port())] = *_msg;
+  this->statsCondition.notify_all();
+}
+
+/////////////////////////////////////////////////
+void TopicCommand::Stats(const std::string &_topic,
+    const msgs::TopicInfo &_info)
+{
+  if (_info.publisher_size() == 0)
+    return;
+
+  std::vector<std::string> publishers;
+  for (auto const &pub : _info.publisher())
+    publishers.push_back(pub.host() + ":" + std::to_string(pub.port()));
+
+  transport::SubscriberPtr sub = this->node->Subscribe(
+      transport::TopicManager::StatsTopic, &TopicCommand::StatsCB, this);
+
+  // Each process publishes its statistics once per second
+  std::unique_lock<std::mutex> lock(this->statsMutex);
+  this->statsCondition.wait_for(lock, std::chrono::milliseconds(2500),
+      [&]()
+      {
+        for (auto const &pub : publishers)
+        {
+          if (this->stats.find(pub) == this->stats.end())
+            return false;
+        }
+        return true;
+      });
+
+  // Durations are printed in microseconds
+  auto printTime = [](const msgs::TransportStats::Histogram &_hist)
+  {
+    printf("p50[%.1f] p99[%.1f] max[%.1f]", _hist.p50() * 1e6,
+        _hist.p99() * 1e6, _hist.max() * 1e6);
+  };
+
+  std::cout << "Publisher statistics:\n";
+  for (auto const &pub : publishers)
+  {
+    auto statsIter = this->stats.find(pub);
+    if (statsIter == this->stats.end())
+    {
+      std::cout << "\t" << pub << "\n\t  Unavailable\n";
+      continue;
+    }
+
+    for (auto const &publication : statsIter->second.publication())
+    {
+      if (publication.topic() != _topic)
+        continue;
+
+      std::cout << "\t" << pub << "\n";
+      printf("\t  Publishers[%u] Local subscribers[%u] "
+          "Remote subscribers[%d]\n", publication.publishers(),
+          publication.local_subscribers(), publication.connection_size());
+      printf("\t  Published[%s] Throttled[%s] Dropped[%s]\n",
+          std::to_string(publication.published()).c_str(),
+          std::to_string(publication.throttled()).c_str(),
+          std::to_string(publication.dropped()).c_str());
+      printf("\t  Queue depth[%u] Max queue depth[%u]\n",
+          publication.queue_depth(), publication.max_queue_depth());
+      printf("\t  Serialized[%s bytes] Serialization (us) ",
+          std::to_string(publication.serialized_bytes()).c_str());
+      printTime(publication.serialize_time());
+      printf("\n");
+
+      // Connections to the remote subscribers of the topic
+      for (auto const &uri : publication.connection())
+      {
+        for (auto const &conn : statsIter->second.connection())
+        {
+          if (conn.remote_uri() != uri)
+            continue;
+
+          printf("\t  Connection %s\n", uri.c_str());
+          printf("\t    Queued[%s msgs, %s bytes] Backlog[%s msgs, %s bytes]"
+              " Max backlog[%s bytes]\n",
+              std::to_string(conn.messages()).c_str(),
+              std::to_string(conn.bytes()).c_str(),
+              std::to_string(conn.backlog_messages()).c_str(),
+              std::to_string(conn.backlog_bytes()).c_str(),
+              std::to_string(conn.max_backlog_bytes()).c_str());
+          printf("\t    Write (us) ");
+          printTime(conn.write_time());
+          printf("\n");
+        }
+      }
+    }
+  }
+  std::cout << "\n";
+  fflush(stdout);
 }
 
 /////////////////////////////////////////////////
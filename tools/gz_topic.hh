@@ -17,6 +17,9 @@
 #ifndef _GZ_TOPIC_HH_
 #define _GZ_TOPIC_HH_
 
+#include <condition_variable>
+#include <map>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -43,6 +46,18 @@ namespace gazebo
     /// \param[in] _topic Topic to print info about.
     private: void Info(const std::string &_topic);
 
+    /// \brief Output the transport statistics of the publishers of a
+    /// topic, published by their processes on
+    /// transport::TopicManager::StatsTopic.
+    /// \param[in] _topic Topic to print statistics about.
+    /// \param[in] _info Information about the topic.
+    private: void Stats(const std::string &_topic,
+                        const msgs::TopicInfo &_info);
+
+    /// \brief Callback used by Stats() to receive transport statistics.
+    /// \param[in] _msg Transport statistics of a process.
+    private: void StatsCB(ConstTransportStatsPtr &_msg);
+
     /// \brief Output messages from a topic.
     /// \param[in] _topic Topic to print messages from.
     private: void Echo(const std::string &_topic);
@@ -103,6 +118,16 @@ namespace gazebo
 
     /// \brief Buffer of message publish times, used by Bw().
     private: std::vector<common::Time> bwTime;
+
+    /// \brief Transport statistics received by StatsCB(), indexed by the
+    /// host:port of the process.
+    private: std::map<std::string, msgs::TransportStats> stats;
+
+    /// \brief Protects stats.
+    private: std::mutex statsMutex;
+
+    /// \brief Signals new transport statistics.
+    private: std::condition_variable statsCondition;
   };
 }
 #endif